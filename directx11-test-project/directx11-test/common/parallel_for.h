@@ -0,0 +1,28 @@
+#pragma once
+
+#include <thread>
+#include <atomic>
+
+namespace xtest {
+namespace common {
+
+	// number of threads the hardware can run concurrently, at least 1
+	uint32 HardwareThreadCount();
+
+
+	/**
+	Calls function(index) for every index in [0, count) spreading the calls over threadCount threads,
+	the calling thread takes part in the work. Indices are handed out one at a time so uneven work
+	items (e.g. shapes of different size) are balanced automatically; the call order is unspecified.
+	@param count		The number of work items.
+	@param threadCount	The maximum number of threads to use, 0 means HardwareThreadCount().
+	@param function		A callable with signature void(uint32 index), called concurrently.
+	*/
+	template <typename Function>
+	void ParallelFor(uint32 count, uint32 threadCount, const Function& function);
+
+} // common
+} // xtest
+
+#include "parallel_for.inl"
+
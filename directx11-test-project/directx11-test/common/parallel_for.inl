@@ -0,0 +1,51 @@
+#include "parallel_for.h"
+#pragma once
+
+
+inline uint32 xtest::common::HardwareThreadCount()
+{
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+
+template <typename Function>
+void xtest::common::ParallelFor(uint32 count, uint32 threadCount, const Function& function)
+{
+	if (threadCount == 0)
+	{
+		threadCount = HardwareThreadCount();
+	}
+	threadCount = std::min(threadCount, count);
+
+	if (threadCount <= 1)
+	{
+		for (uint32 index = 0; index < count; index++)
+		{
+			function(index);
+		}
+		return;
+	}
+
+	std::atomic<uint32> nextIndex(0);
+	auto worker = [&nextIndex, count, &function]()
+	{
+		for (uint32 index = nextIndex++; index < count; index = nextIndex++)
+		{
+			function(index);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+	for (uint32 threadIndex = 1; threadIndex < threadCount; threadIndex++)
+	{
+		threads.emplace_back(worker);
+	}
+
+	worker();
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "lights_demo_app.h"
 #include <file/file_utils.h>
+#include <mesh/mesh_optimizer.h>
 #include <math/math_utils.h>
 #include <service/locator.h>
 
@@ -119,6 +120,8 @@ void xtest::demo::LightsDemoApp::InitRenderable()
 	{
 		// geo
 		m_plane.mesh = mesh::GeneratePlane(50.f, 50.f, 50, 50);
+		mesh::OptimizeVertexCache(m_plane.mesh);
+		mesh::OptimizeVertexFetch(m_plane.mesh);
 
 
 		// W
@@ -176,6 +179,8 @@ void xtest::demo::LightsDemoApp::InitRenderable()
 
 		//geo
 		m_sphere.mesh = mesh::GenerateSphere(1.f, 40, 40); // mesh::GenerateBox(2, 2, 2);
+		mesh::OptimizeVertexCache(m_sphere.mesh);
+		mesh::OptimizeVertexFetch(m_sphere.mesh);
 
 
 		// W
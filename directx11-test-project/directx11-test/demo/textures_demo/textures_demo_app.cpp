@@ -1,6 +1,8 @@
 #include "stdafx.h"
 #include "textures_demo_app.h"
 #include <file/file_utils.h>
+#include <file/scene_reader.h>
+#include <mesh/mesh_optimizer.h>
 #include <math/math_utils.h>
 #include <service/locator.h>
 #include <external_libs\directxtk\WICTextureLoader.h>
@@ -22,18 +24,33 @@ TextureDemoApp::TextureDemoApp(HINSTANCE instance,
 	, m_dirLight()
 	, m_spotLight()
 	, m_pointLights()
-	, m_sphere()
-	, m_plane()
-	, m_crate()
 	, m_lightsControl()
 	, m_isLightControlDirty(true)
 	, m_stopLights(false)
+	, m_lodSettings()
+	, m_lodStatistics()
+	, m_scene()
+	, m_meshes()
+	, m_materials()
+	, m_meshIdByName()
+	, m_materialIdByName()
+	, m_occlusionCuller(256, 144)
+	, m_occludeeIndices()
+	, m_isOccluded()
+	, m_occludedCount(0)
 	, m_d3dPerFrameCB(nullptr)
 	, m_d3dRarelyChangedCB(nullptr)
 	, m_vertexShader(nullptr)
 	, m_pixelShader(nullptr)
 	, m_inputLayout(nullptr)
 	, m_rasterizerState(nullptr)
+	, m_renderBackend()
+	, m_drawQueue()
+	, m_pipelineHandle(render::kNullResource)
+	, m_perFrameCBHandle(render::kNullResource)
+	, m_rarelyChangedCBHandle(render::kNullResource)
+	, m_constantRing()
+	, m_constantRingHandle(render::kNullResource)
 {}
 
 
@@ -49,9 +66,12 @@ void TextureDemoApp::Init()
 
 	InitMatrices();
 	InitShaders();
-	InitRenderable();
 	InitLights();
 	InitRasterizerState();
+	InitRenderBackend();
+	InitMeshes();
+	InitMaterials();
+	InitScene();
 
 	service::Locator::GetMouse()->AddListener(this);
 	service::Locator::GetKeyboard()->AddListener(this, { input::Key::F, input::Key::F1, input::Key::F2, input::Key::F3, input::Key::space_bar });
@@ -129,628 +149,6 @@ void TextureDemoApp::InitShaders()
 }
 
 
-void xtest::demo::TextureDemoApp::InitRenderable()
-{
-
-	//TORUS
-	{
-		m_torus.mesh = mesh::GenerateTorus(4, 0.2f,25);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\wood\wood_color.png)").c_str(), NULL, &m_torus.diffuse_texture_view, NULL);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\wood\wood_norm.png)").c_str(), NULL, &m_torus.normal_texture_view, NULL);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\wood\wood_gloss.png)").c_str(), NULL, &m_torus.gloss_texture_view, NULL);
-
-		// W
-		XMStoreFloat4x4(&m_torus.W, XMMatrixMultiply(XMMatrixScaling(1.0f,1.0f, 1.0f), XMMatrixTranslation(0.f, 1.f, 0.f)));
-
-		// material
-		m_torus.material.ambient  = { 0.15f, 0.15f, 0.15f, 1.f };
-		m_torus.material.diffuse  = { 0.77f, 0.77f, 0.77f, 1.f };
-		m_torus.material.specular = { 0.8f, 0.8f, 0.8f, 190.0f };
-		m_torus.material.options  = { 1,0.8f,0,0 };
-
-		// perObjectCB
-		D3D11_BUFFER_DESC perObjectCBDesc;
-		perObjectCBDesc.Usage = D3D11_USAGE_DYNAMIC;
-		perObjectCBDesc.ByteWidth = sizeof(PerObjectCB);
-		perObjectCBDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		perObjectCBDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		perObjectCBDesc.MiscFlags = 0;
-		perObjectCBDesc.StructureByteStride = 0;
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&perObjectCBDesc, nullptr, &m_torus.d3dPerObjectCB));
-
-
-		// vertex buffer
-		D3D11_BUFFER_DESC vertexBufferDesc;
-		vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		vertexBufferDesc.ByteWidth = UINT(sizeof(mesh::MeshData::Vertex) * m_torus.mesh.vertices.size());
-		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		vertexBufferDesc.CPUAccessFlags = 0;
-		vertexBufferDesc.MiscFlags = 0;
-		vertexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA vertexInitData;
-		vertexInitData.pSysMem = &m_torus.mesh.vertices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexInitData, &m_torus.d3dVertexBuffer));
-
-
-		// index buffer
-		D3D11_BUFFER_DESC indexBufferDesc;
-		indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		indexBufferDesc.ByteWidth = UINT(sizeof(uint32) * m_torus.mesh.indices.size());
-		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		indexBufferDesc.CPUAccessFlags = 0;
-		indexBufferDesc.MiscFlags = 0;
-		indexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA indexInitdata;
-		indexInitdata.pSysMem = &m_torus.mesh.indices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&indexBufferDesc, &indexInitdata, &m_torus.d3dIndexBuffer));
-	}
-
-	//TORUS KNOT
-	{
-		m_torus_knot.mesh = mesh::GenerateTorusKnot(2.0f, 10, 0.05, 1000, 20, 1);
-		// W
-		XMStoreFloat4x4(&m_torus_knot.W, XMMatrixMultiply(XMMatrixRotationRollPitchYaw(55.f, 0, 0.0f), XMMatrixMultiply(XMMatrixScaling(1.0f, 1.0f, 1.0f), XMMatrixTranslation(0.f, 8.f, 0.f))));
-
-		// material
-		m_torus_knot.material.ambient = { 0.15f, 0.15f, 0.15f, 1.f };
-		m_torus_knot.material.diffuse = { 0.77f, 0.77f, 0.77f, 1.f };
-		m_torus_knot.material.specular = { 0.8f, 0.8f, 0.8f, 190.0f };
-		m_torus_knot.material.options = { 0 ,0 ,0 ,0 };
-
-		// perObjectCB
-		D3D11_BUFFER_DESC perObjectCBDesc;
-		perObjectCBDesc.Usage = D3D11_USAGE_DYNAMIC;
-		perObjectCBDesc.ByteWidth = sizeof(PerObjectCB);
-		perObjectCBDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		perObjectCBDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		perObjectCBDesc.MiscFlags = 0;
-		perObjectCBDesc.StructureByteStride = 0;
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&perObjectCBDesc, nullptr, &m_torus_knot.d3dPerObjectCB));
-
-
-		// vertex buffer
-		D3D11_BUFFER_DESC vertexBufferDesc;
-		vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		vertexBufferDesc.ByteWidth = UINT(sizeof(mesh::MeshData::Vertex) * m_torus_knot.mesh.vertices.size());
-		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		vertexBufferDesc.CPUAccessFlags = 0;
-		vertexBufferDesc.MiscFlags = 0;
-		vertexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA vertexInitData;
-		vertexInitData.pSysMem = &m_torus_knot.mesh.vertices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexInitData, &m_torus_knot.d3dVertexBuffer));
-
-
-		// index buffer
-		D3D11_BUFFER_DESC indexBufferDesc;
-		indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		indexBufferDesc.ByteWidth = UINT(sizeof(uint32) * m_torus_knot.mesh.indices.size());
-		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		indexBufferDesc.CPUAccessFlags = 0;
-		indexBufferDesc.MiscFlags = 0;
-		indexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA indexInitdata;
-		indexInitdata.pSysMem = &m_torus_knot.mesh.indices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&indexBufferDesc, &indexInitdata, &m_torus_knot.d3dIndexBuffer));
-	}
-
-	//TORUS KNOT 2
-	{
-		m_torus_knot2.mesh = mesh::GenerateTorusKnot(1.0f, 4.0f, 0.5f, 500, 11, 3);
-		
-		// W
-		XMStoreFloat4x4(&m_torus_knot2.W, XMMatrixMultiply(XMMatrixRotationRollPitchYaw(55.f, 0, 0.0f), XMMatrixMultiply(XMMatrixScaling(1.0f, 1.0f, 1.0f), XMMatrixTranslation(0.f, 8.f, 0.f))));
-
-		// material
-		m_torus_knot2.material.ambient = { 0.15f, 0.15f, 0.15f, 1.f };
-		m_torus_knot2.material.diffuse = { 0.77f, 0.77f, 0.77f, 1.f };
-		m_torus_knot2.material.specular = { 0.8f, 0.8f, 0.8f, 190.0f };
-		m_torus_knot2.material.options = { 0 , 0 , 0, 0 };
-
-		// perObjectCB
-		D3D11_BUFFER_DESC perObjectCBDesc;
-		perObjectCBDesc.Usage = D3D11_USAGE_DYNAMIC;
-		perObjectCBDesc.ByteWidth = sizeof(PerObjectCB);
-		perObjectCBDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		perObjectCBDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		perObjectCBDesc.MiscFlags = 0;
-		perObjectCBDesc.StructureByteStride = 0;
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&perObjectCBDesc, nullptr, &m_torus_knot2.d3dPerObjectCB));
-
-
-		// vertex buffer
-		D3D11_BUFFER_DESC vertexBufferDesc;
-		vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		vertexBufferDesc.ByteWidth = UINT(sizeof(mesh::MeshData::Vertex) * m_torus_knot2.mesh.vertices.size());
-		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		vertexBufferDesc.CPUAccessFlags = 0;
-		vertexBufferDesc.MiscFlags = 0;
-		vertexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA vertexInitData;
-		vertexInitData.pSysMem = &m_torus_knot2.mesh.vertices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexInitData, &m_torus_knot2.d3dVertexBuffer));
-
-
-		// index buffer
-		D3D11_BUFFER_DESC indexBufferDesc;
-		indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		indexBufferDesc.ByteWidth = UINT(sizeof(uint32) * m_torus_knot2.mesh.indices.size());
-		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		indexBufferDesc.CPUAccessFlags = 0;
-		indexBufferDesc.MiscFlags = 0;
-		indexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA indexInitdata;
-		indexInitdata.pSysMem = &m_torus_knot2.mesh.indices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&indexBufferDesc, &indexInitdata, &m_torus_knot2.d3dIndexBuffer));
-	}
-
-
-
-	// plane
-	{
-		// geo
-		m_plane.mesh = mesh::GeneratePlane(50.f, 50.f, 50, 50);
-		//CreateWICTextureFromFile(m_d3dDevice.Get(), GetRootDir().append(LR"(\3d-objects\tiles\tiles_color.png)").c_str(), NULL, &m_plane.diffuse_texture_view, NULL);
-		//CreateWICTextureFromFile(m_d3dDevice.Get(), GetRootDir().append(LR"(\3d-objects\tiles\tiles_norm.png)").c_str(), NULL, &m_plane.normal_texture_view, NULL);
-		//CreateWICTextureFromFile(m_d3dDevice.Get(), GetRootDir().append(LR"(\3d-objects\tiles\tiles_gloss.png)").c_str(), NULL, &m_plane.gloss_texture_view, NULL);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\tiles\tiles_color.png)").c_str(), NULL, &m_plane.diffuse_texture_view, NULL);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\tiles\tiles_norm.png)").c_str(), NULL, &m_plane.normal_texture_view, NULL);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\tiles\tiles_gloss.png)").c_str(), NULL, &m_plane.gloss_texture_view, NULL);
-
-
-		// W
-		XMStoreFloat4x4(&m_plane.W, XMMatrixIdentity());
-
-
-		// material
-		m_plane.material.ambient = { 0.15f, 0.15f, 0.15f, 1.f };
-		m_plane.material.diffuse = { 0.77f, 0.77f, 0.77f, 1.f };
-		m_plane.material.specular = { 0.8f, 0.8f, 0.8f, 190.0f };
-		m_plane.material.options = { 1,20,0,0 };
-
-		// perObjectCB
-		D3D11_BUFFER_DESC perObjectCBDesc;
-		perObjectCBDesc.Usage = D3D11_USAGE_DYNAMIC;
-		perObjectCBDesc.ByteWidth = sizeof(PerObjectCB);
-		perObjectCBDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		perObjectCBDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		perObjectCBDesc.MiscFlags = 0;
-		perObjectCBDesc.StructureByteStride = 0;
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&perObjectCBDesc, nullptr, &m_plane.d3dPerObjectCB));
-
-
-		// vertex buffer
-		D3D11_BUFFER_DESC vertexBufferDesc;
-		vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		vertexBufferDesc.ByteWidth = UINT(sizeof(mesh::MeshData::Vertex) * m_plane.mesh.vertices.size());
-		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		vertexBufferDesc.CPUAccessFlags = 0;
-		vertexBufferDesc.MiscFlags = 0;
-		vertexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA vertexInitData;
-		vertexInitData.pSysMem = &m_plane.mesh.vertices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexInitData, &m_plane.d3dVertexBuffer));
-
-
-		// index buffer
-		D3D11_BUFFER_DESC indexBufferDesc;
-		indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		indexBufferDesc.ByteWidth = UINT(sizeof(uint32) * m_plane.mesh.indices.size());
-		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		indexBufferDesc.CPUAccessFlags = 0;
-		indexBufferDesc.MiscFlags = 0;
-		indexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA indexInitdata;
-		indexInitdata.pSysMem = &m_plane.mesh.indices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&indexBufferDesc, &indexInitdata, &m_plane.d3dIndexBuffer));
-	}
-
-
-	// cube 1
-	{
-		// geo
-		m_box1.mesh = mesh::GenerateBox(1.0f, 10.f, 1.f);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\lizard\lizard_color.png)").c_str(), NULL, &m_box1.diffuse_texture_view, NULL);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\lizard\lizard_norm.png)").c_str(), NULL, &m_box1.normal_texture_view, NULL);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\lizard\lizard_gloss.png)").c_str(), NULL, &m_box1.gloss_texture_view, NULL);
-
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\plasma.jpg)").c_str(), NULL, &m_box1.animated_texture_view, NULL);
-
-		// W
-		XMStoreFloat4x4(&m_box1.W, XMMatrixMultiply(XMMatrixScaling(1.0f, 1.0f, 1.0f), XMMatrixTranslation(8.f, 5.f, 8.f)));
-
-		// material
-		m_box1.material.ambient = { 0.15f , 0.15f, 0.15f, 1.f };
-		m_box1.material.diffuse = { 0.77f , 0.77f, 0.77f, 1.f };
-		m_box1.material.specular = { 0.8f  , 0.8f , 0.8f , 190.0f };
-		m_box1.material.options = { 3, 1.2f, 0    , 0 };
-
-		// perObjectCB
-		D3D11_BUFFER_DESC perObjectCBDesc;
-		perObjectCBDesc.Usage = D3D11_USAGE_DYNAMIC;
-		perObjectCBDesc.ByteWidth = sizeof(PerObjectCB);
-		perObjectCBDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		perObjectCBDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		perObjectCBDesc.MiscFlags = 0;
-		perObjectCBDesc.StructureByteStride = 0;
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&perObjectCBDesc, nullptr, &m_box1.d3dPerObjectCB));
-
-
-		// vertex buffer
-		D3D11_BUFFER_DESC vertexBufferDesc;
-		vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		vertexBufferDesc.ByteWidth = UINT(sizeof(mesh::MeshData::Vertex) * m_box1.mesh.vertices.size());
-		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		vertexBufferDesc.CPUAccessFlags = 0;
-		vertexBufferDesc.MiscFlags = 0;
-		vertexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA vertexInitData;
-		vertexInitData.pSysMem = &m_box1.mesh.vertices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexInitData, &m_box1.d3dVertexBuffer));
-
-
-		// index buffer
-		D3D11_BUFFER_DESC indexBufferDesc;
-		indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		indexBufferDesc.ByteWidth = UINT(sizeof(uint32) * m_box1.mesh.indices.size());
-		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		indexBufferDesc.CPUAccessFlags = 0;
-		indexBufferDesc.MiscFlags = 0;
-		indexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA indexInitdata;
-		indexInitdata.pSysMem = &m_box1.mesh.indices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&indexBufferDesc, &indexInitdata, &m_box1.d3dIndexBuffer));
-	}
-
-	// cube 2
-	{
-		// geo
-		m_box2.mesh = mesh::GenerateBox(1.0f, 10.f, 1.f);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\lizard\lizard_color.png)").c_str(), NULL, &m_box2.diffuse_texture_view, NULL);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\lizard\lizard_norm.png)").c_str(), NULL, &m_box2.normal_texture_view, NULL);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\lizard\lizard_gloss.png)").c_str(), NULL, &m_box2.gloss_texture_view, NULL);
-
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\waves.jpg)").c_str(), NULL, &m_box2.animated_texture_view, NULL);
-
-		// W
-		XMStoreFloat4x4(&m_box2.W, XMMatrixMultiply( XMMatrixScaling(1.0f, 1.0f, 1.0f), XMMatrixTranslation(-8.f, 5.f, 8.f)));
-
-		// material
-		m_box2.material.ambient = { 0.15f, 0.15f, 0.15f, 1.f };
-		m_box2.material.diffuse = { 0.77f, 0.77f, 0.77f, 1.f };
-		m_box2.material.specular = { 0.8f, 0.8f, 0.8f, 190.0f };
-		m_box2.material.options = { 3, 1.2f, 0, 0 };
-
-		// perObjectCB
-		D3D11_BUFFER_DESC perObjectCBDesc;
-		perObjectCBDesc.Usage = D3D11_USAGE_DYNAMIC;
-		perObjectCBDesc.ByteWidth = sizeof(PerObjectCB);
-		perObjectCBDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		perObjectCBDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		perObjectCBDesc.MiscFlags = 0;
-		perObjectCBDesc.StructureByteStride = 0;
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&perObjectCBDesc, nullptr, &m_box2.d3dPerObjectCB));
-
-
-		// vertex buffer
-		D3D11_BUFFER_DESC vertexBufferDesc;
-		vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		vertexBufferDesc.ByteWidth = UINT(sizeof(mesh::MeshData::Vertex) * m_box2.mesh.vertices.size());
-		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		vertexBufferDesc.CPUAccessFlags = 0;
-		vertexBufferDesc.MiscFlags = 0;
-		vertexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA vertexInitData;
-		vertexInitData.pSysMem = &m_box2.mesh.vertices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexInitData, &m_box2.d3dVertexBuffer));
-
-
-		// index buffer
-		D3D11_BUFFER_DESC indexBufferDesc;
-		indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		indexBufferDesc.ByteWidth = UINT(sizeof(uint32) * m_box2.mesh.indices.size());
-		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		indexBufferDesc.CPUAccessFlags = 0;
-		indexBufferDesc.MiscFlags = 0;
-		indexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA indexInitdata;
-		indexInitdata.pSysMem = &m_box2.mesh.indices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&indexBufferDesc, &indexInitdata, &m_box2.d3dIndexBuffer));
-	}
-
-	// cube 3
-	{
-		// geo
-		m_box3.mesh = mesh::GenerateBox(1.0f, 10.f, 1.f);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\lizard\lizard_color.png)").c_str(), NULL, &m_box3.diffuse_texture_view, NULL);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\lizard\lizard_norm.png)").c_str(), NULL, &m_box3.normal_texture_view, NULL);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\lizard\lizard_gloss.png)").c_str(), NULL, &m_box3.gloss_texture_view, NULL);
-
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\waves.jpg)").c_str(), NULL, &m_box3.animated_texture_view, NULL);
-
-		// W
-		XMStoreFloat4x4(&m_box3.W, XMMatrixMultiply(XMMatrixScaling(1.0f, 1.0f, 1.0f), XMMatrixTranslation(-8.f, 5.f, -8.f)));
-
-		// material
-		m_box3.material.ambient = { 0.15f , 0.15f, 0.15f, 1.f };
-		m_box3.material.diffuse = { 0.77f , 0.77f, 0.77f, 1.f };
-		m_box3.material.specular = { 0.8f  , 0.8f , 0.8f , 190.0f };
-		m_box3.material.options = { 3, 1.2f, 0    , 0 };
-
-		// perObjectCB
-		D3D11_BUFFER_DESC perObjectCBDesc;
-		perObjectCBDesc.Usage = D3D11_USAGE_DYNAMIC;
-		perObjectCBDesc.ByteWidth = sizeof(PerObjectCB);
-		perObjectCBDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		perObjectCBDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		perObjectCBDesc.MiscFlags = 0;
-		perObjectCBDesc.StructureByteStride = 0;
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&perObjectCBDesc, nullptr, &m_box3.d3dPerObjectCB));
-
-
-		// vertex buffer
-		D3D11_BUFFER_DESC vertexBufferDesc;
-		vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		vertexBufferDesc.ByteWidth = UINT(sizeof(mesh::MeshData::Vertex) * m_box3.mesh.vertices.size());
-		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		vertexBufferDesc.CPUAccessFlags = 0;
-		vertexBufferDesc.MiscFlags = 0;
-		vertexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA vertexInitData;
-		vertexInitData.pSysMem = &m_box3.mesh.vertices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexInitData, &m_box3.d3dVertexBuffer));
-
-
-		// index buffer
-		D3D11_BUFFER_DESC indexBufferDesc;
-		indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		indexBufferDesc.ByteWidth = UINT(sizeof(uint32) * m_box3.mesh.indices.size());
-		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		indexBufferDesc.CPUAccessFlags = 0;
-		indexBufferDesc.MiscFlags = 0;
-		indexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA indexInitdata;
-		indexInitdata.pSysMem = &m_box3.mesh.indices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&indexBufferDesc, &indexInitdata, &m_box3.d3dIndexBuffer));
-	}
-
-	// cube 4
-	{
-		// geo
-		m_box4.mesh = mesh::GenerateBox(1.0f, 10.f, 1.f);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\lizard\lizard_color.png)").c_str(), NULL, &m_box4.diffuse_texture_view, NULL);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\lizard\lizard_norm.png)").c_str(), NULL, &m_box4.normal_texture_view, NULL);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\lizard\lizard_gloss.png)").c_str(), NULL, &m_box4.gloss_texture_view, NULL);
-
-		CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(LR"(\3d-objects\plasma.jpg)").c_str(), NULL, &m_box4.animated_texture_view, NULL);
-
-		// W
-		XMStoreFloat4x4(&m_box4.W, XMMatrixMultiply(XMMatrixScaling(1.0f, 1.0f, 1.0f), XMMatrixTranslation(8.f, 5.f, -8.f)));
-
-		// material
-		m_box4.material.ambient = { 0.15f, 0.15f, 0.15f, 1.f };
-		m_box4.material.diffuse = { 0.77f, 0.77f, 0.77f, 1.f };
-		m_box4.material.specular = { 0.8f, 0.8f, 0.8f, 190.0f };
-		m_box4.material.options = { 3, 1.2f, 0, 0 };
-
-		// perObjectCB
-		D3D11_BUFFER_DESC perObjectCBDesc;
-		perObjectCBDesc.Usage = D3D11_USAGE_DYNAMIC;
-		perObjectCBDesc.ByteWidth = sizeof(PerObjectCB);
-		perObjectCBDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		perObjectCBDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		perObjectCBDesc.MiscFlags = 0;
-		perObjectCBDesc.StructureByteStride = 0;
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&perObjectCBDesc, nullptr, &m_box4.d3dPerObjectCB));
-
-
-		// vertex buffer
-		D3D11_BUFFER_DESC vertexBufferDesc;
-		vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		vertexBufferDesc.ByteWidth = UINT(sizeof(mesh::MeshData::Vertex) * m_box4.mesh.vertices.size());
-		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		vertexBufferDesc.CPUAccessFlags = 0;
-		vertexBufferDesc.MiscFlags = 0;
-		vertexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA vertexInitData;
-		vertexInitData.pSysMem = &m_box4.mesh.vertices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexInitData, &m_box4.d3dVertexBuffer));
-
-
-		// index buffer
-		D3D11_BUFFER_DESC indexBufferDesc;
-		indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		indexBufferDesc.ByteWidth = UINT(sizeof(uint32) * m_box4.mesh.indices.size());
-		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		indexBufferDesc.CPUAccessFlags = 0;
-		indexBufferDesc.MiscFlags = 0;
-		indexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA indexInitdata;
-		indexInitdata.pSysMem = &m_box4.mesh.indices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&indexBufferDesc, &indexInitdata, &m_box4.d3dIndexBuffer));
-	}
-
-
-
-
-
-
-	// sphere
-	{
-
-		//geo
-		m_sphere.mesh = mesh::GenerateSphere(1.f, 40, 40); // mesh::GenerateBox(2, 2, 2);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), GetRootDir().append(LR"(\3d-objects\lava\lava_color.png)").c_str(), NULL, &m_sphere.diffuse_texture_view, NULL);
-		CreateWICTextureFromFile(m_d3dDevice.Get(), GetRootDir().append(LR"(\3d-objects\lava\lava_norm.png)").c_str(), NULL, &m_sphere.normal_texture_view, NULL);
-
-
-
-		// W
-		XMStoreFloat4x4(&m_sphere.W, XMMatrixTranslation(0.f, 4.f, 0.f));
-
-		// material
-		m_sphere.material.ambient = { 0.7f, 0.1f, 0.1f, 1.0f };
-		m_sphere.material.diffuse = { 1.00f, 1.00f, 1.00f, 1.0f };
-		m_sphere.material.specular = { 0.7f, 0.7f, 0.7f, 40.0f };
-		m_sphere.material.options = { 1, 2, 0, 0 };
-
-
-		// perObjectCB
-		D3D11_BUFFER_DESC perObjectCBDesc;
-		perObjectCBDesc.Usage = D3D11_USAGE_DYNAMIC;
-		perObjectCBDesc.ByteWidth = sizeof(PerObjectCB);
-		perObjectCBDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		perObjectCBDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		perObjectCBDesc.MiscFlags = 0;
-		perObjectCBDesc.StructureByteStride = 0;
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&perObjectCBDesc, nullptr, &m_sphere.d3dPerObjectCB));
-
-
-		// vertex buffer
-		D3D11_BUFFER_DESC vertexBufferDesc;
-		vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		vertexBufferDesc.ByteWidth = UINT(sizeof(mesh::MeshData::Vertex) * m_sphere.mesh.vertices.size());
-		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		vertexBufferDesc.CPUAccessFlags = 0;
-		vertexBufferDesc.MiscFlags = 0;
-		vertexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA vertexInitData;
-		vertexInitData.pSysMem = &m_sphere.mesh.vertices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexInitData, &m_sphere.d3dVertexBuffer));
-
-		// index buffer
-		D3D11_BUFFER_DESC indexBufferDesc;
-		indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		indexBufferDesc.ByteWidth = UINT(sizeof(uint32) * m_sphere.mesh.indices.size());
-		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		indexBufferDesc.CPUAccessFlags = 0;
-		indexBufferDesc.MiscFlags = 0;
-		indexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA indexInitdata;
-		indexInitdata.pSysMem = &m_sphere.mesh.indices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&indexBufferDesc, &indexInitdata, &m_sphere.d3dIndexBuffer));
-	}
-
-
-	// crate
-	{
-
-		//geo
-		std::wstring targetFile = GetRootDir().append(LR"(\3d-objects\crate.gpf)");
-
-		{
-			mesh::GPFMesh gpfMesh = file::ReadGPF(targetFile);
-			m_crate.mesh = std::move(gpfMesh);
-		}
-
-		// W
-		XMStoreFloat4x4(&m_crate.W, XMMatrixMultiply( XMMatrixRotationRollPitchYaw(0.0f, 15.0f, 0.0f), XMMatrixMultiply(XMMatrixScaling(0.01f, 0.01f, 0.01f), XMMatrixTranslation(6.f, 0.f, 6.f))));
-
-
-		//bottom material
-		Material& bottomMat = m_crate.shapeAttributeMapByName["bottom_1"].material;
-		bottomMat.ambient = { 0.8f, 0.3f, 0.1f, 1.0f };
-		bottomMat.diffuse = { 0.94f, 0.40f, 0.14f, 1.0f };
-		bottomMat.specular = { 0.94f, 0.40f, 0.14f, 30.0f };
-		bottomMat.options = { 0, 0, 0, 0 };
-
-		//top material
-		Material& topMat = m_crate.shapeAttributeMapByName["top_2"].material;
-		topMat.ambient = { 0.8f, 0.8f, 0.8f, 1.0f };
-		topMat.diffuse = { 0.9f, 0.9f, 0.9f, 1.0f };
-		topMat.specular = { 0.9f, 0.9f, 0.9f, 550.0f };
-		topMat.options = { 0, 0, 0, 0 };
-
-		//top handles material
-		Material& topHandleMat = m_crate.shapeAttributeMapByName["top_handles_4"].material;
-		topHandleMat.ambient = { 0.3f, 0.3f, 0.3f, 1.0f };
-		topHandleMat.diffuse = { 0.4f, 0.4f, 0.4f, 1.0f };
-		topHandleMat.specular = { 0.9f, 0.9f, 0.9f, 120.0f };
-		topHandleMat.options = { 0, 0, 0, 0 };
-
-		//handle material
-		Material& handleMat = m_crate.shapeAttributeMapByName["handles_8"].material;
-		handleMat.ambient = { 0.5f, 0.5f, 0.1f, 1.0f };
-		handleMat.diffuse = { 0.67f, 0.61f, 0.1f, 1.0f };
-		handleMat.specular = { 0.67f, 0.61f, 0.1f, 200.0f };
-		handleMat.options = { 0, 0, 0, 0 };
-
-		//metal material
-		Material& metalPiecesMat = m_crate.shapeAttributeMapByName["metal_pieces_3"].material;
-		metalPiecesMat.ambient = { 0.3f, 0.3f, 0.3f, 1.0f };
-		metalPiecesMat.diffuse = { 0.4f, 0.4f, 0.4f, 1.0f };
-		metalPiecesMat.specular = { 0.4f, 0.4f, 0.4f, 520.0f };
-		metalPiecesMat.options = { 0, 0, 0, 0 };
-
-
-
-		for (const auto& namePairWithDesc : m_crate.mesh.meshDescriptorMapByName)
-		{
-			ComPtr<ID3D11Buffer> d3dPerObjectCB;
-
-			// perObjectCBs
-			D3D11_BUFFER_DESC perObjectCBDesc;
-			perObjectCBDesc.Usage = D3D11_USAGE_DYNAMIC;
-			perObjectCBDesc.ByteWidth = sizeof(PerObjectCB);
-			perObjectCBDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-			perObjectCBDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-			perObjectCBDesc.MiscFlags = 0;
-			perObjectCBDesc.StructureByteStride = 0;
-			XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&perObjectCBDesc, nullptr, &d3dPerObjectCB));
-
-			m_crate.shapeAttributeMapByName[namePairWithDesc.first].d3dPerObjectCB = d3dPerObjectCB;
-		}
-
-
-		// vertex buffer
-		D3D11_BUFFER_DESC vertexBufferDesc;
-		vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		vertexBufferDesc.ByteWidth = UINT(sizeof(mesh::MeshData::Vertex) * m_crate.mesh.meshData.vertices.size());
-		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		vertexBufferDesc.CPUAccessFlags = 0;
-		vertexBufferDesc.MiscFlags = 0;
-		vertexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA vertexInitData;
-		vertexInitData.pSysMem = &m_crate.mesh.meshData.vertices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexInitData, &m_crate.d3dVertexBuffer));
-
-
-		// index buffer
-		D3D11_BUFFER_DESC indexBufferDesc;
-		indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		indexBufferDesc.ByteWidth = UINT(sizeof(uint32) * m_crate.mesh.meshData.indices.size());
-		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		indexBufferDesc.CPUAccessFlags = 0;
-		indexBufferDesc.MiscFlags = 0;
-		indexBufferDesc.StructureByteStride = 0;
-
-		D3D11_SUBRESOURCE_DATA indexInitdata;
-		indexInitdata.pSysMem = &m_crate.mesh.meshData.indices[0];
-		XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&indexBufferDesc, &indexInitdata, &m_crate.d3dIndexBuffer));
-	}
-
-}
-
-
 void TextureDemoApp::InitLights()
 {
 	m_dirLight.ambient = { 0.16f, 0.18f, 0.18f, 1.f };
@@ -835,6 +233,393 @@ void TextureDemoApp::InitRasterizerState()
 }
 
 
+void TextureDemoApp::InitRenderBackend()
+{
+	m_renderBackend = std::make_unique<render::D3D11RenderBackend>(m_d3dContext);
+
+	render::D3D11Pipeline pipeline;
+	pipeline.vertexShader = m_vertexShader;
+	pipeline.pixelShader = m_pixelShader;
+	pipeline.inputLayout = m_inputLayout;
+	pipeline.rasterizerState = m_rasterizerState;
+	pipeline.sampler = m_textureSampler;
+	pipeline.topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+	m_pipelineHandle = m_renderBackend->AddPipeline(pipeline);
+
+	m_perFrameCBHandle = m_renderBackend->AddBuffer(m_d3dPerFrameCB);
+	m_rarelyChangedCBHandle = m_renderBackend->AddBuffer(m_d3dRarelyChangedCB);
+}
+
+
+void TextureDemoApp::InitMeshes()
+{
+	// the finest levels of the torus knots have up to a million vertices, too many to optimize at every start. the
+	// levels above this keep the row by row order of the generators: about one vertex transformed per triangle
+	// instead of 0.7 once optimized, but the vertex buffer is still read sequentially. they are only drawn up close
+	const size_t maxOptimizedLevelVertexCount = 64 * 1024;
+	auto optimizeLevel = [maxOptimizedLevelVertexCount](mesh::MeshData& level, bool reduceOverdraw)
+	{
+		if (level.vertices.size() > maxOptimizedLevelVertexCount)
+		{
+			return;
+		}
+
+		mesh::OptimizeVertexCache(level);
+		if (reduceOverdraw)
+		{
+			mesh::OptimizeOverdraw(level);
+		}
+		mesh::OptimizeVertexFetch(level);
+	};
+
+	// torus
+	{
+		std::vector<mesh::MeshData> levels;
+		for (uint32 detailsCount : { 25, 13, 7 })
+		{
+			levels.push_back(mesh::GenerateTorus(4, 0.2f, detailsCount));
+			optimizeLevel(levels.back(), false);
+		}
+		AddLodMesh("torus", std::move(levels));
+	}
+
+	// torus knot
+	{
+		std::vector<mesh::MeshData> levels;
+		for (uint32 detailsCount : { 1000, 500, 250, 125 })
+		{
+			levels.push_back(mesh::GenerateTorusKnot(2.0f, 10, 0.05, detailsCount, 20, 1));
+			optimizeLevel(levels.back(), true);
+		}
+		AddLodMesh("torus_knot", std::move(levels));
+	}
+
+	// torus knot 2
+	{
+		std::vector<mesh::MeshData> levels;
+		for (uint32 detailsCount : { 500, 250, 125, 63 })
+		{
+			levels.push_back(mesh::GenerateTorusKnot(1.0f, 4.0f, 0.5f, detailsCount, 11, 3));
+			optimizeLevel(levels.back(), true);
+		}
+		AddLodMesh("torus_knot2", std::move(levels));
+	}
+
+	// sphere
+	{
+		std::vector<mesh::MeshData> levels;
+		for (uint32 sliceCount : { 40, 20, 10 })
+		{
+			levels.push_back(mesh::GenerateSphere(1.f, sliceCount, sliceCount));
+			optimizeLevel(levels.back(), false);
+		}
+		AddLodMesh("sphere", std::move(levels));
+	}
+
+	// plane
+	{
+		mesh::MeshData plane = mesh::GeneratePlane(50.f, 50.f, 50, 50);
+		optimizeLevel(plane, false);
+		AddMesh("plane", plane, false);
+	}
+
+	// the boxes hide what is behind them
+	AddMesh("box", mesh::GenerateBox(1.0f, 10.f, 1.f), true);
+
+	// crate, every shape is a mesh of its own in the same buffers
+	{
+		// the vertex and index buffers are created straight from the file mapping, only the descriptors are copied;
+		// packed, compressed or encoded vertices and indices can't go to the buffers as they are, ReadGPF decodes them
+		const std::wstring crateFilePath = GetRootDir().append(LR"(\3d-objects\crate.gpf)");
+		file::GPFView gpfView = file::MapGPF(crateFilePath);
+		if (!gpfView.IsValid())
+		{
+			return;
+		}
+
+		render::DrawPacket cratePacket;
+		std::map<std::string, mesh::GPFMesh::MeshDescriptor> meshDescriptorMapByName;
+		if (gpfView.Vertices() && gpfView.Indices())
+		{
+			cratePacket = MakeDrawPacket(gpfView.Vertices(), gpfView.VertexByteSize(), gpfView.Indices(), gpfView.IndexByteSize());
+
+			// the culling needs the bounds, a v1 file like the crate one has no bounds section
+			gpfView.ComputeMissingBounds();
+			meshDescriptorMapByName = gpfView.MeshDescriptorMapByName();
+		}
+		else
+		{
+			mesh::GPFMesh gpfMesh = file::ReadGPF(crateFilePath);
+			if (gpfMesh.meshData.vertices.empty() || gpfMesh.meshData.indices.empty())
+			{
+				return;
+			}
+
+			cratePacket = MakeDrawPacket(gpfMesh.meshData.vertices.data(), sizeof(mesh::MeshData::Vertex) * gpfMesh.meshData.vertices.size(),
+				gpfMesh.meshData.indices.data(), sizeof(uint32) * gpfMesh.meshData.indices.size());
+			meshDescriptorMapByName = std::move(gpfMesh.meshDescriptorMapByName);
+		}
+
+		for (const auto& namePairWithDesc : meshDescriptorMapByName)
+		{
+			const mesh::GPFMesh::MeshDescriptor& meshDesc = namePairWithDesc.second;
+
+			SceneMesh shape;
+			shape.drawPacket = cratePacket;
+			shape.drawPacket.indexCount = meshDesc.indexCount;
+			shape.drawPacket.startIndex = meshDesc.indexOffset;
+			shape.drawPacket.baseVertex = int32(meshDesc.vertexOffset);
+			shape.bounds = meshDesc.bounds;
+
+			m_meshIdByName["crate/" + namePairWithDesc.first] = uint32(m_meshes.size());
+			m_meshes.push_back(std::move(shape));
+		}
+	}
+}
+
+
+void TextureDemoApp::InitMaterials()
+{
+	// the textures are loaded once whatever the number of materials using them, an empty file name is no texture
+	std::map<std::wstring, render::ResourceHandle> textureByFile;
+	auto loadTexture = [this, &textureByFile](const std::wstring& fileName)
+	{
+		const auto found = textureByFile.find(fileName);
+		if (found != textureByFile.end())
+		{
+			return found->second;
+		}
+
+		ComPtr<ID3D11ShaderResourceView> textureView;
+		if (!fileName.empty())
+		{
+			CreateWICTextureFromFile(m_d3dDevice.Get(), m_d3dContext.Get(), GetRootDir().append(L"\\3d-objects\\").append(fileName).c_str(), NULL, &textureView, NULL);
+		}
+		return textureByFile[fileName] = m_renderBackend->AddTexture(textureView);
+	};
+
+	// the materials with the same textures get the same texture set, which sorts their draws next to each other
+	std::map<std::array<render::ResourceHandle, render::kTextureSlotCount>, uint32> textureSetIdByTextures;
+	auto addMaterial = [this, &loadTexture, &textureSetIdByTextures](const std::string& name, const Material& material, const std::vector<std::wstring>& textureFiles)
+	{
+		SceneMaterial sceneMaterial;
+		sceneMaterial.material = material;
+		for (size_t slot = 0; slot < textureFiles.size(); slot++)
+		{
+			sceneMaterial.textures[slot] = loadTexture(textureFiles[slot]);
+		}
+		sceneMaterial.textureSet = textureSetIdByTextures.emplace(sceneMaterial.textures, uint32(textureSetIdByTextures.size())).first->second;
+
+		m_materialIdByName[name] = uint32(m_materials.size());
+		m_materials.push_back(sceneMaterial);
+	};
+
+
+	Material material;
+	material.ambient = { 0.15f, 0.15f, 0.15f, 1.f };
+	material.diffuse = { 0.77f, 0.77f, 0.77f, 1.f };
+	material.specular = { 0.8f, 0.8f, 0.8f, 190.0f };
+
+	material.options = { 1, 0.8f, 0, 0 };
+	addMaterial("wood", material, { LR"(wood\wood_color.png)", LR"(wood\wood_norm.png)", LR"(wood\wood_gloss.png)" });
+
+	material.options = { 1, 20, 0, 0 };
+	addMaterial("tiles", material, { LR"(tiles\tiles_color.png)", LR"(tiles\tiles_norm.png)", LR"(tiles\tiles_gloss.png)" });
+
+	// the animated texture of the boxes scrolls with the texcoord matrix, see UpdateScene
+	material.options = { 3, 1.2f, 0, 0 };
+	addMaterial("lizard_plasma", material, { LR"(lizard\lizard_color.png)", LR"(lizard\lizard_norm.png)", LR"(lizard\lizard_gloss.png)", L"plasma.jpg" });
+	addMaterial("lizard_waves", material, { LR"(lizard\lizard_color.png)", LR"(lizard\lizard_norm.png)", LR"(lizard\lizard_gloss.png)", L"waves.jpg" });
+
+	// the torus knots don't sample any texture, like the crate: they get its empty texture set and sort next to it
+	material.options = { 0, 0, 0, 0 };
+	addMaterial("knot", material, { L"", L"", L"" });
+
+	material.ambient = { 0.7f, 0.1f, 0.1f, 1.0f };
+	material.diffuse = { 1.00f, 1.00f, 1.00f, 1.0f };
+	material.specular = { 0.7f, 0.7f, 0.7f, 40.0f };
+	material.options = { 1, 2, 0, 0 };
+	addMaterial("lava", material, { LR"(lava\lava_color.png)", LR"(lava\lava_norm.png)", L"" });
+
+
+	// crate
+	material.options = { 0, 0, 0, 0 };
+
+	material.ambient = { 0.8f, 0.3f, 0.1f, 1.0f };
+	material.diffuse = { 0.94f, 0.40f, 0.14f, 1.0f };
+	material.specular = { 0.94f, 0.40f, 0.14f, 30.0f };
+	addMaterial("crate_bottom", material, { L"", L"", L"" });
+
+	material.ambient = { 0.8f, 0.8f, 0.8f, 1.0f };
+	material.diffuse = { 0.9f, 0.9f, 0.9f, 1.0f };
+	material.specular = { 0.9f, 0.9f, 0.9f, 550.0f };
+	addMaterial("crate_top", material, { L"", L"", L"" });
+
+	material.ambient = { 0.3f, 0.3f, 0.3f, 1.0f };
+	material.diffuse = { 0.4f, 0.4f, 0.4f, 1.0f };
+	material.specular = { 0.9f, 0.9f, 0.9f, 120.0f };
+	addMaterial("crate_top_handles", material, { L"", L"", L"" });
+
+	material.ambient = { 0.5f, 0.5f, 0.1f, 1.0f };
+	material.diffuse = { 0.67f, 0.61f, 0.1f, 1.0f };
+	material.specular = { 0.67f, 0.61f, 0.1f, 200.0f };
+	addMaterial("crate_handles", material, { L"", L"", L"" });
+
+	material.ambient = { 0.3f, 0.3f, 0.3f, 1.0f };
+	material.diffuse = { 0.4f, 0.4f, 0.4f, 1.0f };
+	material.specular = { 0.4f, 0.4f, 0.4f, 520.0f };
+	addMaterial("crate_metal_pieces", material, { L"", L"", L"" });
+}
+
+
+void TextureDemoApp::InitScene()
+{
+	const std::wstring sceneFilePath = GetRootDir().append(LR"(\scenes\textures_demo.scene)");
+	file::SceneDesc sceneDesc;
+	bool sceneRead = file::ReadScene(sceneFilePath, &sceneDesc);
+	XTEST_ASSERT(sceneRead, L"invalid scene file:'%s'", sceneFilePath.c_str());
+	if (!sceneRead)
+	{
+		return;
+	}
+
+	// the shapes of an object share its transform, W, WVP and the inverse are computed once for all of them
+	std::vector<scene::TransformHandle> transformHandles;
+	for (const file::SceneTransformDesc& transformDesc : sceneDesc.transforms)
+	{
+		transformHandles.push_back(m_scene.AddTransform(transformDesc.World()));
+	}
+
+	for (size_t object = 0; object < sceneDesc.objects.size(); object++)
+	{
+		const file::SceneObjectDesc& objectDesc = sceneDesc.objects[object];
+		const auto meshId = m_meshIdByName.find(objectDesc.mesh);
+		const auto materialId = m_materialIdByName.find(objectDesc.material);
+		XTEST_ASSERT(meshId != m_meshIdByName.end(), L"unknown mesh of the scene object %u", uint32(object));
+		XTEST_ASSERT(materialId != m_materialIdByName.end(), L"unknown material of the scene object %u", uint32(object));
+		if (meshId == m_meshIdByName.end() || materialId == m_materialIdByName.end())
+		{
+			continue;
+		}
+
+		scene::ObjectDesc desc;
+		desc.transform = transformHandles[objectDesc.transform];
+		desc.bounds = m_meshes[meshId->second].bounds;
+		desc.mesh = meshId->second;
+		desc.material = materialId->second;
+		m_scene.Add(desc);
+	}
+
+	// room for the PerObjectCB of every object in two frames in flight, each takes 512 bytes once aligned; the
+	// ring waits for the gpu when more frames hold their space
+	const uint32 perObjectCBSize = (sizeof(PerObjectCB) + render::kConstantBufferAlignment - 1) & ~(render::kConstantBufferAlignment - 1);
+	const uint32 ringCapacity = std::max(256u * 1024u, 2 * m_scene.Count() * perObjectCBSize);
+	m_constantRing = std::make_unique<render::D3D11ConstantRing>(m_d3dDevice, m_d3dContext, ringCapacity);
+	m_constantRingHandle = m_renderBackend->AddBuffer(m_constantRing->Buffer());
+}
+
+
+render::DrawPacket TextureDemoApp::MakeDrawPacket(const void* vertices, size_t vertexByteSize, const void* indices, size_t indexByteSize)
+{
+	// vertex buffer
+	D3D11_BUFFER_DESC vertexBufferDesc;
+	vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	vertexBufferDesc.ByteWidth = UINT(vertexByteSize);
+	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	vertexBufferDesc.CPUAccessFlags = 0;
+	vertexBufferDesc.MiscFlags = 0;
+	vertexBufferDesc.StructureByteStride = 0;
+
+	D3D11_SUBRESOURCE_DATA vertexInitData;
+	vertexInitData.pSysMem = vertices;
+	ComPtr<ID3D11Buffer> d3dVertexBuffer;
+	XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexInitData, &d3dVertexBuffer));
+
+
+	// index buffer
+	D3D11_BUFFER_DESC indexBufferDesc;
+	indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	indexBufferDesc.ByteWidth = UINT(indexByteSize);
+	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	indexBufferDesc.CPUAccessFlags = 0;
+	indexBufferDesc.MiscFlags = 0;
+	indexBufferDesc.StructureByteStride = 0;
+
+	D3D11_SUBRESOURCE_DATA indexInitdata;
+	indexInitdata.pSysMem = indices;
+	ComPtr<ID3D11Buffer> d3dIndexBuffer;
+	XTEST_D3D_CHECK(m_d3dDevice->CreateBuffer(&indexBufferDesc, &indexInitdata, &d3dIndexBuffer));
+
+
+	// the per object constants are bound to the first slot of both the stages every frame, see RenderScene
+	render::DrawPacket packet;
+	packet.pipeline = m_pipelineHandle;
+	packet.vertexBuffer = m_renderBackend->AddBuffer(d3dVertexBuffer);
+	packet.vertexStride = sizeof(mesh::MeshData::Vertex);
+	packet.indexBuffer = m_renderBackend->AddBuffer(d3dIndexBuffer);
+	packet.indexCount = uint32(indexByteSize / sizeof(uint32));
+	return packet;
+}
+
+
+void TextureDemoApp::AddMesh(const std::string& name, const mesh::MeshData& meshData, bool isOccluder)
+{
+	SceneMesh sceneMesh;
+	sceneMesh.drawPacket = MakeDrawPacket(meshData.vertices.data(), sizeof(mesh::MeshData::Vertex) * meshData.vertices.size(),
+		meshData.indices.data(), sizeof(uint32) * meshData.indices.size());
+	sceneMesh.bounds = meshData.bounds;
+	if (isOccluder)
+	{
+		sceneMesh.occluderMesh = meshData;
+	}
+
+	m_meshIdByName[name] = uint32(m_meshes.size());
+	m_meshes.push_back(std::move(sceneMesh));
+}
+
+
+void TextureDemoApp::AddLodMesh(const std::string& name, std::vector<mesh::MeshData> levels)
+{
+	SceneMesh sceneMesh;
+	sceneMesh.lodSet = mesh::BuildLodSet(std::move(levels));
+
+	// all the levels go in the same buffers, every one with its own vertex and index ranges
+	std::vector<mesh::MeshData::Vertex> vertices;
+	std::vector<uint32> indices;
+	for (const mesh::LodSet::Level& level : sceneMesh.lodSet.levels)
+	{
+		mesh::GPFMesh::MeshDescriptor levelDesc;
+		levelDesc.vertexCount = uint32(level.meshData.vertices.size());
+		levelDesc.vertexOffset = uint32(vertices.size());
+		levelDesc.indexCount = uint32(level.meshData.indices.size());
+		levelDesc.indexOffset = uint32(indices.size());
+		levelDesc.bounds = level.meshData.bounds;
+		sceneMesh.levelDescriptors.push_back(levelDesc);
+
+		vertices.insert(vertices.end(), level.meshData.vertices.begin(), level.meshData.vertices.end());
+		indices.insert(indices.end(), level.meshData.indices.begin(), level.meshData.indices.end());
+	}
+
+	sceneMesh.drawPacket = MakeDrawPacket(vertices.data(), sizeof(mesh::MeshData::Vertex) * vertices.size(), indices.data(), sizeof(uint32) * indices.size());
+
+	// the bounds of the finest level, the sphere the lods are selected by
+	sceneMesh.bounds = sceneMesh.levelDescriptors[0].bounds;
+	sceneMesh.bounds.sphereCenter = sceneMesh.lodSet.boundsCenter;
+	sceneMesh.bounds.sphereRadius = sceneMesh.lodSet.boundsRadius;
+
+	m_meshIdByName[name] = uint32(m_meshes.size());
+	m_meshes.push_back(std::move(sceneMesh));
+}
+
+
+TextureDemoApp::PerObjectCB* TextureDemoApp::AllocatePerObjectCB(render::ConstantBufferBinding* binding)
+{
+	binding->buffer = m_constantRingHandle;
+	binding->size = sizeof(PerObjectCB);
+	return static_cast<PerObjectCB*>(m_constantRing->Allocate(sizeof(PerObjectCB), &binding->offset));
+}
+
+
 void TextureDemoApp::OnResized()
 {
 	application::DirectxApp::OnResized();
@@ -914,6 +699,45 @@ void TextureDemoApp::OnKeyStatusChange(input::Key key, const input::KeyStatus& s
 	}
 }
 
+
+void TextureDemoApp::CullScene(FXMMATRIX viewProjection)
+{
+	const uint32 previousVisibleCount = m_scene.VisibleCount();
+	const uint32 visibleCount = m_scene.Cull(render::ExtractFrustum(viewProjection));
+
+	const std::vector<uint32>& visibleIndices = m_scene.VisibleIndices();
+	const std::vector<uint32>& meshes = m_scene.Meshes();
+	const std::vector<mesh::MeshBounds>& bounds = m_scene.Bounds();
+	const std::vector<uint32>& transformIndices = m_scene.TransformIndices();
+	const render::WorldTransforms& worlds = m_scene.Worlds();
+
+	// only what is in view takes part in the occlusion culling
+	m_occludeeIndices.clear();
+	for (uint32 visible = 0; visible < visibleCount; visible++)
+	{
+		const uint32 index = visibleIndices[visible];
+		const SceneMesh& sceneMesh = m_meshes[meshes[index]];
+		if (!sceneMesh.occluderMesh.indices.empty())
+		{
+			m_occlusionCuller.AddOccluder(sceneMesh.occluderMesh, worlds.Get(transformIndices[index]));
+		}
+		else
+		{
+			m_occlusionCuller.AddOccludee(bounds[index], worlds.Get(transformIndices[index]));
+			m_occludeeIndices.push_back(index);
+		}
+	}
+
+	// the worker culls while the constant buffers are updated, RenderScene waits for it
+	m_occlusionCuller.Start(viewProjection);
+
+	if (visibleCount != previousVisibleCount)
+	{
+		XTEST_DEBUG_LOG(L"culling: " << visibleCount << L" of " << m_scene.Count() << L" objects visible");
+	}
+}
+
+
 float pos=0;
 float textureSpeed=0.2f;
 void TextureDemoApp::UpdateScene(float deltaSeconds)
@@ -928,250 +752,56 @@ void TextureDemoApp::UpdateScene(float deltaSeconds)
 	// create projection matrix
 	XMMATRIX P = XMLoadFloat4x4(&m_projectionMatrix);
 
+	// the lod levels are selected for the current camera, see mesh::SelectLod
+	const mesh::LodView lodView = mesh::MakeLodView(m_camera.GetPosition(), P, float(GetCurrentHeight()));
 
-
-	m_d3dAnnotation->BeginEvent(L"update-constant-buffer");
-
-
-	// plane PerObjectCB
-	{
-		XMMATRIX W = XMLoadFloat4x4(&m_plane.W);
-		XMMATRIX WVP = W * V*P;
-
-		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		ZeroMemory(&mappedResource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-
-		// disable gpu access
-		XTEST_D3D_CHECK(m_d3dContext->Map(m_plane.d3dPerObjectCB.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
-		PerObjectCB* perObjectCB = (PerObjectCB*)mappedResource.pData;
-
-		//update the data
-		XMStoreFloat4x4(&perObjectCB->W, XMMatrixTranspose(W));
-		XMStoreFloat4x4(&perObjectCB->WVP, XMMatrixTranspose(WVP));
-		XMStoreFloat4x4(&perObjectCB->W_inverseTraspose, XMMatrixInverse(nullptr, W));
-		perObjectCB->material = m_plane.material;
-
-		// enable gpu access
-		m_d3dContext->Unmap(m_plane.d3dPerObjectCB.Get(), 0);
-	}
-
-	//BOX 1
-	{
-		XMMATRIX W = XMLoadFloat4x4(&m_box1.W);
-		XMMATRIX WVP = W * V * P;
-
-		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		ZeroMemory(&mappedResource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-
-		// disable gpu access
-		XTEST_D3D_CHECK(m_d3dContext->Map(m_box1.d3dPerObjectCB.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
-		PerObjectCB* perObjectCB = (PerObjectCB*)mappedResource.pData;
-
-		//update the data
-		XMStoreFloat4x4(&perObjectCB->W, XMMatrixTranspose(W));
-		XMStoreFloat4x4(&perObjectCB->WVP, XMMatrixTranspose(WVP));
-		XMStoreFloat4x4(&perObjectCB->W_inverseTraspose, XMMatrixInverse(nullptr, W));
-
-		XMStoreFloat4x4(&perObjectCB->TexcoordMatrix, XMMatrixTranspose(XMMatrixMultiply(XMMatrixScaling(1.f, 1.f, 1.f), XMMatrixTranslation(pos, pos, 0.0f))));
-
-		perObjectCB->material = m_box1.material;
-
-		// enable gpu access
-		m_d3dContext->Unmap(m_box1.d3dPerObjectCB.Get(), 0);
-	}
-	//BOX 2
-	{
-		XMMATRIX W = XMLoadFloat4x4(&m_box2.W);
-		XMMATRIX WVP = W * V * P;
-
-		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		ZeroMemory(&mappedResource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-
-		// disable gpu access
-		XTEST_D3D_CHECK(m_d3dContext->Map(m_box2.d3dPerObjectCB.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
-		PerObjectCB* perObjectCB = (PerObjectCB*)mappedResource.pData;
-
-		//update the data
-		XMStoreFloat4x4(&perObjectCB->W, XMMatrixTranspose(W));
-		XMStoreFloat4x4(&perObjectCB->WVP, XMMatrixTranspose(WVP));
-		XMStoreFloat4x4(&perObjectCB->W_inverseTraspose, XMMatrixInverse(nullptr, W));
-		XMStoreFloat4x4(&perObjectCB->TexcoordMatrix, XMMatrixTranspose(XMMatrixMultiply(XMMatrixScaling(1.f, 1.f, 1.f), XMMatrixTranslation(pos, pos, 0.0f))));
-
-		perObjectCB->material = m_box2.material;
-
-		// enable gpu access
-		m_d3dContext->Unmap(m_box2.d3dPerObjectCB.Get(), 0);
-	}
-
-
-	//BOX 3
-	{
-		XMMATRIX W = XMLoadFloat4x4(&m_box3.W);
-		XMMATRIX WVP = W * V * P;
-
-		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		ZeroMemory(&mappedResource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-
-		// disable gpu access
-		XTEST_D3D_CHECK(m_d3dContext->Map(m_box3.d3dPerObjectCB.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
-		PerObjectCB* perObjectCB = (PerObjectCB*)mappedResource.pData;
-
-		//update the data
-		XMStoreFloat4x4(&perObjectCB->W, XMMatrixTranspose(W));
-		XMStoreFloat4x4(&perObjectCB->WVP, XMMatrixTranspose(WVP));
-		XMStoreFloat4x4(&perObjectCB->W_inverseTraspose, XMMatrixInverse(nullptr, W));
-
-		XMStoreFloat4x4(&perObjectCB->TexcoordMatrix, XMMatrixTranspose(XMMatrixMultiply(XMMatrixScaling(1.f, 1.f, 1.f), XMMatrixTranslation(pos, pos, 0.0f))));
-
-		perObjectCB->material = m_box3.material;
-
-		// enable gpu access
-		m_d3dContext->Unmap(m_box3.d3dPerObjectCB.Get(), 0);
-	}
-	//BOX 4
-	{
-		XMMATRIX W = XMLoadFloat4x4(&m_box4.W);
-		XMMATRIX WVP = W * V * P;
-
-		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		ZeroMemory(&mappedResource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-
-		// disable gpu access
-		XTEST_D3D_CHECK(m_d3dContext->Map(m_box4.d3dPerObjectCB.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
-		PerObjectCB* perObjectCB = (PerObjectCB*)mappedResource.pData;
-
-		//update the data
-		XMStoreFloat4x4(&perObjectCB->W, XMMatrixTranspose(W));
-		XMStoreFloat4x4(&perObjectCB->WVP, XMMatrixTranspose(WVP));
-		XMStoreFloat4x4(&perObjectCB->W_inverseTraspose, XMMatrixInverse(nullptr, W));
-		XMStoreFloat4x4(&perObjectCB->TexcoordMatrix, XMMatrixTranspose(XMMatrixMultiply(XMMatrixScaling(1.f, 1.f, 1.f), XMMatrixTranslation(pos, pos, 0.0f))));
-
-		perObjectCB->material = m_box4.material;
-
-		// enable gpu access
-		m_d3dContext->Unmap(m_box4.d3dPerObjectCB.Get(), 0);
-	}
-
-
-	// sphere PerObjectCB
-	{
-		XMMATRIX W = XMLoadFloat4x4(&m_sphere.W);
-		XMMATRIX WVP = W * V*P;
-
-		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		ZeroMemory(&mappedResource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-
-		// disable gpu access
-		XTEST_D3D_CHECK(m_d3dContext->Map(m_sphere.d3dPerObjectCB.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
-		PerObjectCB* perObjectCB = (PerObjectCB*)mappedResource.pData;
-
-		//update the data
-		XMStoreFloat4x4(&perObjectCB->W, XMMatrixTranspose(W));
-		XMStoreFloat4x4(&perObjectCB->WVP, XMMatrixTranspose(WVP));
-		XMStoreFloat4x4(&perObjectCB->W_inverseTraspose, XMMatrixInverse(nullptr, W));
-		perObjectCB->material = m_sphere.material;
-
-		// enable gpu access
-		m_d3dContext->Unmap(m_sphere.d3dPerObjectCB.Get(), 0);
-	}
-
-
-	// torus PerObjectCB
-	{
-		XMMATRIX W = XMLoadFloat4x4(&m_torus.W);
-		XMMATRIX WVP = W * V*P;
-
-		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		ZeroMemory(&mappedResource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-
-		// disable gpu access
-		XTEST_D3D_CHECK(m_d3dContext->Map(m_torus.d3dPerObjectCB.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
-		PerObjectCB* perObjectCB = (PerObjectCB*)mappedResource.pData;
-
-		//update the data
-		XMStoreFloat4x4(&perObjectCB->W, XMMatrixTranspose(W));
-		XMStoreFloat4x4(&perObjectCB->WVP, XMMatrixTranspose(WVP));
-		XMStoreFloat4x4(&perObjectCB->W_inverseTraspose, XMMatrixInverse(nullptr, W));
-		perObjectCB->material = m_torus.material;
-
-		// enable gpu access
-		m_d3dContext->Unmap(m_torus.d3dPerObjectCB.Get(), 0);
-	}
-
-
-	// torus knot PerObjectCB
-	{
-		XMMATRIX W = XMLoadFloat4x4(&m_torus_knot.W);
-		XMMATRIX WVP = W * V * P;
-
-		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		ZeroMemory(&mappedResource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-
-		// disable gpu access
-		XTEST_D3D_CHECK(m_d3dContext->Map(m_torus_knot.d3dPerObjectCB.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
-		PerObjectCB* perObjectCB = (PerObjectCB*)mappedResource.pData;
-
-		//update the data
-		XMStoreFloat4x4(&perObjectCB->W, XMMatrixTranspose(W));
-		XMStoreFloat4x4(&perObjectCB->WVP, XMMatrixTranspose(WVP));
-		XMStoreFloat4x4(&perObjectCB->W_inverseTraspose, XMMatrixInverse(nullptr, W));
-		perObjectCB->material = m_torus_knot.material;
-
-		// enable gpu access
-		m_d3dContext->Unmap(m_torus_knot.d3dPerObjectCB.Get(), 0);
-	}
+	// the objects out of the view are not drawn, see RenderScene
+	CullScene(V * P);
 
 
-	// torus knot 2 PerObjectCB
-	{
-		XMMATRIX W = XMLoadFloat4x4(&m_torus_knot2.W);
-		XMMATRIX WVP = W * V * P;
 
-		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		ZeroMemory(&mappedResource, sizeof(D3D11_MAPPED_SUBRESOURCE));
+	m_d3dAnnotation->BeginEvent(L"update-constant-buffer");
 
-		// disable gpu access
-		XTEST_D3D_CHECK(m_d3dContext->Map(m_torus_knot2.d3dPerObjectCB.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
-		PerObjectCB* perObjectCB = (PerObjectCB*)mappedResource.pData;
+	// W, WVP and the inverse of W of every transform at once, the shapes of the crate share theirs
+	m_scene.ComputeTransforms(V * P);
 
-		//update the data
-		XMStoreFloat4x4(&perObjectCB->W, XMMatrixTranspose(W));
-		XMStoreFloat4x4(&perObjectCB->WVP, XMMatrixTranspose(WVP));
-		XMStoreFloat4x4(&perObjectCB->W_inverseTraspose, XMMatrixInverse(nullptr, W));
-		perObjectCB->material = m_torus_knot2.material;
+	// the texture of the animated boxes scrolls, the other materials don't read the matrix
+	XMFLOAT4X4 texcoordMatrix;
+	XMStoreFloat4x4(&texcoordMatrix, XMMatrixTranspose(XMMatrixTranslation(pos, pos, 0.0f)));
 
-		// enable gpu access
-		m_d3dContext->Unmap(m_torus_knot2.d3dPerObjectCB.Get(), 0);
-	}
+	const std::vector<uint32>& visibleIndices = m_scene.VisibleIndices();
+	const std::vector<uint32>& meshes = m_scene.Meshes();
+	const std::vector<uint32>& materials = m_scene.Materials();
+	const std::vector<render::ObjectTransforms>& transforms = m_scene.Transforms();
+	const std::vector<uint32>& transformIndices = m_scene.TransformIndices();
+	const render::WorldTransforms& worlds = m_scene.Worlds();
+	std::vector<uint32>& lodLevels = m_scene.LodLevels();
+	std::vector<render::ConstantBufferBinding>& constantBuffers = m_scene.ConstantBuffers();
 
-	// crate PerObjectCB
+	// every PerObjectCB of the frame is written in the single mapping of the constant ring, only the objects in
+	// view need one
+	m_constantRing->BeginFrame();
+	for (uint32 visible = 0; visible < m_scene.VisibleCount(); visible++)
 	{
-		XMMATRIX W = XMLoadFloat4x4(&m_crate.W);
-		XMMATRIX WVP = W * V*P;
+		const uint32 index = visibleIndices[visible];
 
-		for (const auto& namePairWithDesc : m_crate.mesh.meshDescriptorMapByName)
+		const SceneMesh& sceneMesh = m_meshes[meshes[index]];
+		if (!sceneMesh.lodSet.levels.empty())
 		{
-			const std::string& shapeName = namePairWithDesc.first;
-
-
-			D3D11_MAPPED_SUBRESOURCE mappedResource;
-			ZeroMemory(&mappedResource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-
-			// disable gpu access
-			XTEST_D3D_CHECK(m_d3dContext->Map(m_crate.shapeAttributeMapByName[shapeName].d3dPerObjectCB.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
-			PerObjectCB* perObjectCB = (PerObjectCB*)mappedResource.pData;
-
-			//update the data
-			XMStoreFloat4x4(&perObjectCB->W, XMMatrixTranspose(W));
-			XMStoreFloat4x4(&perObjectCB->WVP, XMMatrixTranspose(WVP));
-			XMStoreFloat4x4(&perObjectCB->W_inverseTraspose, XMMatrixInverse(nullptr, W));
-			perObjectCB->material = m_crate.shapeAttributeMapByName[shapeName].material;
-
-			// enable gpu access
-			m_d3dContext->Unmap(m_crate.shapeAttributeMapByName[shapeName].d3dPerObjectCB.Get(), 0);
+			lodLevels[index] = mesh::SelectLod(sceneMesh.lodSet, worlds.Get(transformIndices[index]), lodView, lodLevels[index], m_lodSettings);
+		}
 
+		// the objects the ring has no room for are not drawn, see RenderScene
+		PerObjectCB* perObjectCB = AllocatePerObjectCB(&constantBuffers[index]);
+		if (!perObjectCB)
+		{
+			continue;
 		}
+		perObjectCB->transforms = transforms[transformIndices[index]];
+		perObjectCB->TexcoordMatrix = texcoordMatrix;
+		perObjectCB->material = m_materials[materials[index]].material;
 	}
+	m_constantRing->Unmap();
 
 
 	// PerFrameCB
@@ -1226,7 +856,7 @@ void TextureDemoApp::UpdateScene(float deltaSeconds)
 			// enable gpu access
 			m_d3dContext->Unmap(m_d3dRarelyChangedCB.Get(), 0);
 
-			m_d3dContext->PSSetConstantBuffers(2, 1, m_d3dRarelyChangedCB.GetAddressOf());
+			m_renderBackend->SetConstantBuffer(render::ShaderStage::pixel, 2, { m_rarelyChangedCBHandle, 0, 0 });
 			m_isLightControlDirty = false;
 
 		}
@@ -1244,227 +874,89 @@ void TextureDemoApp::RenderScene()
 	m_d3dContext->ClearDepthStencilView(m_depthBufferView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.f, 0);
 	m_d3dContext->ClearRenderTargetView(m_backBufferView.Get(), DirectX::Colors::DarkGray);
 
-	// set the shaders and the input layout
-	m_d3dContext->RSSetState(m_rasterizerState.Get());
-	m_d3dContext->IASetInputLayout(m_inputLayout.Get());
-	m_d3dContext->VSSetShader(m_vertexShader.Get(), nullptr, 0);
-	m_d3dContext->PSSetShader(m_pixelShader.Get(), nullptr, 0);
-	m_d3dContext->PSSetSamplers(0, 1, m_textureSampler.GetAddressOf());
-
-	m_d3dContext->PSSetConstantBuffers(1, 1, m_d3dPerFrameCB.GetAddressOf());
-	m_d3dContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-
-
-	// draw torus knot
-	{
-		// bind the constant data to the vertex shader
-		m_d3dContext->VSSetConstantBuffers(0, 1, m_torus_knot.d3dPerObjectCB.GetAddressOf());
-		m_d3dContext->PSSetConstantBuffers(0, 1, m_torus_knot.d3dPerObjectCB.GetAddressOf());
-
-		// set what to draw
-		UINT stride = sizeof(mesh::MeshData::Vertex);
-		UINT offset = 0;
-		m_d3dContext->IASetVertexBuffers(0, 1, m_torus_knot.d3dVertexBuffer.GetAddressOf(), &stride, &offset);
-		m_d3dContext->IASetIndexBuffer(m_torus_knot.d3dIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-		m_d3dContext->DrawIndexed(UINT(m_torus_knot.mesh.indices.size()), 0, 0);
-	}
-
-	// draw torus knot 2
-	{
-		// bind the constant data to the vertex shader
-		m_d3dContext->VSSetConstantBuffers(0, 1, m_torus_knot2.d3dPerObjectCB.GetAddressOf());
-		m_d3dContext->PSSetConstantBuffers(0, 1, m_torus_knot2.d3dPerObjectCB.GetAddressOf());
-
-	
-		// set what to draw
-		UINT stride = sizeof(mesh::MeshData::Vertex);
-		UINT offset = 0;
-		m_d3dContext->IASetVertexBuffers(0, 1, m_torus_knot2.d3dVertexBuffer.GetAddressOf(), &stride, &offset);
-		m_d3dContext->IASetIndexBuffer(m_torus_knot2.d3dIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-		m_d3dContext->DrawIndexed(UINT(m_torus_knot2.mesh.indices.size()), 0, 0);
-	}
-	// draw torus
-	{
-		// bind the constant data to the vertex shader
-		m_d3dContext->VSSetConstantBuffers(0, 1, m_torus.d3dPerObjectCB.GetAddressOf());
-		m_d3dContext->PSSetConstantBuffers(0, 1, m_torus.d3dPerObjectCB.GetAddressOf());
-
-		m_d3dContext->PSSetShaderResources(0, 1, m_torus.diffuse_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(1, 1, m_torus.normal_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(2, 1, m_torus.gloss_texture_view.GetAddressOf());
-
+	// the per frame constants, the pipeline state is set by the first packet executed
+	m_renderBackend->SetConstantBuffer(render::ShaderStage::pixel, 1, { m_perFrameCBHandle, 0, 0 });
 
-		// set what to draw
-		UINT stride = sizeof(mesh::MeshData::Vertex);
-		UINT offset = 0;
-		m_d3dContext->IASetVertexBuffers(0, 1, m_torus.d3dVertexBuffer.GetAddressOf(), &stride, &offset);
-		m_d3dContext->IASetIndexBuffer(m_torus.d3dIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-		m_d3dContext->DrawIndexed(UINT(m_torus.mesh.indices.size()), 0, 0);
-	}
-
-	// draw plane
+	// the objects hidden behind the occluders are not drawn either
+	m_occlusionCuller.Wait();
+	m_isOccluded.assign(m_scene.Count(), false);
+	for (size_t occludee = 0; occludee < m_occludeeIndices.size(); occludee++)
 	{
-		// bind the constant data to the vertex shader
-		m_d3dContext->VSSetConstantBuffers(0, 1, m_plane.d3dPerObjectCB.GetAddressOf());
-		m_d3dContext->PSSetConstantBuffers(0, 1, m_plane.d3dPerObjectCB.GetAddressOf());
-
-		m_d3dContext->PSSetShaderResources(0, 1, m_plane.diffuse_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(1, 1, m_plane.normal_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(2, 1, m_plane.gloss_texture_view.GetAddressOf());
-
-		// set what to draw
-		UINT stride = sizeof(mesh::MeshData::Vertex);
-		UINT offset = 0;
-		m_d3dContext->IASetVertexBuffers(0, 1, m_plane.d3dVertexBuffer.GetAddressOf(), &stride, &offset);
-		m_d3dContext->IASetIndexBuffer(m_plane.d3dIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-		m_d3dContext->DrawIndexed(UINT(m_plane.mesh.indices.size()), 0, 0);
+		m_isOccluded[m_occludeeIndices[occludee]] = !m_occlusionCuller.IsVisible(uint32(occludee));
 	}
 
-
-	// draw box1
+	const render::OcclusionStatistics& occlusionStatistics = m_occlusionCuller.Statistics();
+	if (occlusionStatistics.culledCount != m_occludedCount)
 	{
-		// bind the constant data to the vertex shader
-		m_d3dContext->VSSetConstantBuffers(0, 1, m_box1.d3dPerObjectCB.GetAddressOf());
-		m_d3dContext->PSSetConstantBuffers(0, 1, m_box1.d3dPerObjectCB.GetAddressOf());
-
-		m_d3dContext->PSSetShaderResources(0, 1, m_box1.diffuse_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(1, 1, m_box1.normal_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(2, 1, m_box1.gloss_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(3, 1, m_box1.animated_texture_view.GetAddressOf());
-
-		// set what to draw
-		UINT stride = sizeof(mesh::MeshData::Vertex);
-		UINT offset = 0;
-		m_d3dContext->IASetVertexBuffers(0, 1, m_box1.d3dVertexBuffer.GetAddressOf(), &stride, &offset);
-		m_d3dContext->IASetIndexBuffer(m_box1.d3dIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-		m_d3dContext->DrawIndexed(UINT(m_box1.mesh.indices.size()), 0, 0);
+		XTEST_DEBUG_LOG(L"occlusion: " << occlusionStatistics.culledCount << L" of " << occlusionStatistics.testedCount << L" objects hidden by "
+			<< occlusionStatistics.occluderCount << L" occluders, " << occlusionStatistics.visibleCount << L" visible");
+		m_occludedCount = occlusionStatistics.culledCount;
 	}
 
+	// the statistics of the previous frame, to log them only when the lod selection changes them
+	const uint64 previousTriangleCount = m_lodStatistics.submittedTriangleCount;
+	m_lodStatistics = mesh::LodStatistics();
 
 
-	// draw box2
-	{
-		// bind the constant data to the vertex shader
-		m_d3dContext->VSSetConstantBuffers(0, 1, m_box2.d3dPerObjectCB.GetAddressOf());
-		m_d3dContext->PSSetConstantBuffers(0, 1, m_box2.d3dPerObjectCB.GetAddressOf());
-
-		m_d3dContext->PSSetShaderResources(0, 1, m_box2.diffuse_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(1, 1, m_box2.normal_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(2, 1, m_box2.gloss_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(3, 1, m_box2.animated_texture_view.GetAddressOf());
-
-		// set what to draw
-		UINT stride = sizeof(mesh::MeshData::Vertex);
-		UINT offset = 0;
-		m_d3dContext->IASetVertexBuffers(0, 1, m_box2.d3dVertexBuffer.GetAddressOf(), &stride, &offset);
-		m_d3dContext->IASetIndexBuffer(m_box2.d3dIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-		m_d3dContext->DrawIndexed(UINT(m_box2.mesh.indices.size()), 0, 0);
-	}
-
+	// queue the draws of the frame, within a texture set the nearest objects are drawn first; the depth buckets
+	// span the depth range of the projection, see OnResized
+	m_drawQueue.Clear();
+	const XMMATRIX V = XMLoadFloat4x4(&m_viewMatrix);
 
+	const std::vector<uint32>& visibleIndices = m_scene.VisibleIndices();
+	const std::vector<uint32>& meshes = m_scene.Meshes();
+	const std::vector<uint32>& materials = m_scene.Materials();
+	const std::vector<uint32>& lodLevels = m_scene.LodLevels();
+	const std::vector<render::ConstantBufferBinding>& constantBuffers = m_scene.ConstantBuffers();
+	const render::CullingSpheres& spheres = m_scene.Spheres();
 
-	// draw box3
+	for (uint32 visible = 0; visible < m_scene.VisibleCount(); visible++)
 	{
-		// bind the constant data to the vertex shader
-		m_d3dContext->VSSetConstantBuffers(0, 1, m_box3.d3dPerObjectCB.GetAddressOf());
-		m_d3dContext->PSSetConstantBuffers(0, 1, m_box3.d3dPerObjectCB.GetAddressOf());
-
-		m_d3dContext->PSSetShaderResources(0, 1, m_box3.diffuse_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(1, 1, m_box3.normal_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(2, 1, m_box3.gloss_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(3, 1, m_box3.animated_texture_view.GetAddressOf());
-
-		// set what to draw
-		UINT stride = sizeof(mesh::MeshData::Vertex);
-		UINT offset = 0;
-		m_d3dContext->IASetVertexBuffers(0, 1, m_box3.d3dVertexBuffer.GetAddressOf(), &stride, &offset);
-		m_d3dContext->IASetIndexBuffer(m_box3.d3dIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-		m_d3dContext->DrawIndexed(UINT(m_box3.mesh.indices.size()), 0, 0);
-	}
+		const uint32 index = visibleIndices[visible];
+		if (m_isOccluded[index] || constantBuffers[index].offset == render::kInvalidConstantOffset)
+		{
+			continue;
+		}
 
+		const SceneMesh& sceneMesh = m_meshes[meshes[index]];
+		const SceneMaterial& sceneMaterial = m_materials[materials[index]];
 
+		render::DrawPacket packet = sceneMesh.drawPacket;
+		packet.textures = sceneMaterial.textures;
+		packet.vertexConstantBuffers[0] = constantBuffers[index];
+		packet.pixelConstantBuffers[0] = constantBuffers[index];
+		if (!sceneMesh.lodSet.levels.empty())
+		{
+			const mesh::GPFMesh::MeshDescriptor& levelDesc = sceneMesh.levelDescriptors[lodLevels[index]];
+			packet.indexCount = levelDesc.indexCount;
+			packet.startIndex = levelDesc.indexOffset;
+			packet.baseVertex = int32(levelDesc.vertexOffset);
+			m_lodStatistics.AddDraw(sceneMesh.lodSet, lodLevels[index]);
+		}
 
-	// draw box4
-	{
-		// bind the constant data to the vertex shader
-		m_d3dContext->VSSetConstantBuffers(0, 1, m_box4.d3dPerObjectCB.GetAddressOf());
-		m_d3dContext->PSSetConstantBuffers(0, 1, m_box4.d3dPerObjectCB.GetAddressOf());
-
-		m_d3dContext->PSSetShaderResources(0, 1, m_box4.diffuse_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(1, 1, m_box4.normal_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(2, 1, m_box4.gloss_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(3, 1, m_box4.animated_texture_view.GetAddressOf());
-
-		// set what to draw
-		UINT stride = sizeof(mesh::MeshData::Vertex);
-		UINT offset = 0;
-		m_d3dContext->IASetVertexBuffers(0, 1, m_box4.d3dVertexBuffer.GetAddressOf(), &stride, &offset);
-		m_d3dContext->IASetIndexBuffer(m_box4.d3dIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-		m_d3dContext->DrawIndexed(UINT(m_box4.mesh.indices.size()), 0, 0);
+		const XMVECTOR centerW = XMVectorSet(spheres.centerX[index], spheres.centerY[index], spheres.centerZ[index], 1.f);
+		const float viewDepth = XMVectorGetZ(XMVector3Transform(centerW, V));
+		m_drawQueue.Add(render::MakeSortKey(0, packet.pipeline, sceneMaterial.textureSet, render::DepthBucket(viewDepth, 1.f, 1000.f)), packet);
 	}
 
+	const uint32 previousElidedBindCount = m_drawQueue.Statistics().elidedBindCount;
+	m_drawQueue.Sort();
+	m_drawQueue.Execute(m_renderBackend.get());
+	m_constantRing->EndFrame();
 
-
-
-	// draw sphere
+	const render::DrawQueueStatistics& drawStatistics = m_drawQueue.Statistics();
+	if (drawStatistics.elidedBindCount != previousElidedBindCount)
 	{
-		// bind the constant data to the vertex shader
-		m_d3dContext->VSSetConstantBuffers(0, 1, m_sphere.d3dPerObjectCB.GetAddressOf());
-		m_d3dContext->PSSetConstantBuffers(0, 1, m_sphere.d3dPerObjectCB.GetAddressOf());
-
-		m_d3dContext->PSSetShaderResources(0, 1, m_sphere.diffuse_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(1, 1, m_sphere.normal_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(2, 1, m_sphere.gloss_texture_view.GetAddressOf());
-
-
-		// set what to draw
-		UINT stride = sizeof(mesh::MeshData::Vertex);
-		UINT offset = 0;
-		m_d3dContext->IASetVertexBuffers(0, 1, m_sphere.d3dVertexBuffer.GetAddressOf(), &stride, &offset);
-		m_d3dContext->IASetIndexBuffer(m_sphere.d3dIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-		m_d3dContext->DrawIndexed(UINT(m_sphere.mesh.indices.size()), 0, 0);
+		XTEST_DEBUG_LOG(L"draw queue: " << drawStatistics.drawCount << L" draws, " << drawStatistics.bindCount << L" binds, "
+			<< drawStatistics.elidedBindCount << L" elided");
 	}
 
-
-
-
-
-	// draw crate
+	if (m_lodStatistics.submittedTriangleCount != previousTriangleCount)
 	{
-		// set what to draw
-		UINT stride = sizeof(mesh::MeshData::Vertex);
-		UINT offset = 0;
-		m_d3dContext->IASetVertexBuffers(0, 1, m_crate.d3dVertexBuffer.GetAddressOf(), &stride, &offset);
-		m_d3dContext->IASetIndexBuffer(m_crate.d3dIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-		m_d3dContext->PSSetShaderResources(0, 1, m_crate.diffuse_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(1, 1, m_crate.normal_texture_view.GetAddressOf());
-		m_d3dContext->PSSetShaderResources(2, 1, m_crate.gloss_texture_view.GetAddressOf());
-
-		for (const auto& namePairWithDesc : m_crate.mesh.meshDescriptorMapByName)
-		{
-			const std::string& shapeName = namePairWithDesc.first;
-			const mesh::GPFMesh::MeshDescriptor& meshDesc = m_crate.mesh.meshDescriptorMapByName[shapeName];
-
-			// bind the constant data to the vertex shader
-			m_d3dContext->VSSetConstantBuffers(0, 1, m_crate.shapeAttributeMapByName[shapeName].d3dPerObjectCB.GetAddressOf());
-			m_d3dContext->PSSetConstantBuffers(0, 1, m_crate.shapeAttributeMapByName[shapeName].d3dPerObjectCB.GetAddressOf());
-
-			// draw
-			m_d3dContext->DrawIndexed(meshDesc.indexCount, meshDesc.indexOffset, meshDesc.vertexOffset);
-		}
-
+		XTEST_DEBUG_LOG(L"lod: " << m_lodStatistics.submittedTriangleCount << L" triangles submitted in " << m_lodStatistics.drawCount
+			<< L" draws, " << m_lodStatistics.finestTriangleCount << L" at the finest levels");
 	}
 
-
-
 	XTEST_D3D_CHECK(m_swapChain->Present(0, 0));
 
 	m_d3dAnnotation->EndEvent();
@@ -6,6 +6,12 @@
 #include <camera/spherical_camera.h>
 #include <mesh/mesh_generator.h>
 #include <mesh/mesh_format.h>
+#include <mesh/mesh_lod.h>
+#include <render/occlusion_culler.h>
+#include <render/draw_queue.h>
+#include <render/d3d11_render_backend.h>
+#include <render/d3d11_constant_ring.h>
+#include <scene/scene.h>
 
 
 namespace xtest {
@@ -65,9 +71,7 @@ namespace xtest {
 
 			struct PerObjectCB
 			{
-				DirectX::XMFLOAT4X4 W;
-				DirectX::XMFLOAT4X4 W_inverseTraspose;
-				DirectX::XMFLOAT4X4 WVP;
+				render::ObjectTransforms transforms;	// W, W_inverseTraspose and WVP
 				DirectX::XMFLOAT4X4 TexcoordMatrix;
 				Material material;
 			};
@@ -90,40 +94,23 @@ namespace xtest {
 			};
 
 
-			struct Renderable
+			// the geometry the objects of the scene draw, the scene keeps its index in m_meshes
+			struct SceneMesh
 			{
-				mesh::MeshData mesh;
-				DirectX::XMFLOAT4X4 W;
-				Material material;
-				Microsoft::WRL::ComPtr<ID3D11Buffer> d3dPerObjectCB;
-				Microsoft::WRL::ComPtr<ID3D11Buffer> d3dVertexBuffer;
-				Microsoft::WRL::ComPtr<ID3D11Buffer> d3dIndexBuffer;
-
-				Microsoft::WRL::ComPtr < ID3D11ShaderResourceView> diffuse_texture_view;
-				Microsoft::WRL::ComPtr < ID3D11ShaderResourceView> normal_texture_view;
-				Microsoft::WRL::ComPtr < ID3D11ShaderResourceView> gloss_texture_view;
-				Microsoft::WRL::ComPtr < ID3D11ShaderResourceView> animated_texture_view;
+				render::DrawPacket drawPacket;	// the buffers and the draw arguments, a lod mesh takes them from the selected level
+				mesh::MeshBounds bounds;
+				mesh::LodSet lodSet;			// no levels when the mesh has no lods
+				std::vector<mesh::GPFMesh::MeshDescriptor> levelDescriptors;
+				mesh::MeshData occluderMesh;	// the objects of the meshes with triangles here hide what is behind them
 			};
 
 
-			struct GPFRenderable
+			// how the objects of the scene look, the scene keeps its index in m_materials
+			struct SceneMaterial
 			{
-				struct ShapeAttributes
-				{
-					Material material;
-					Microsoft::WRL::ComPtr<ID3D11Buffer> d3dPerObjectCB;
-				};
-
-				mesh::GPFMesh mesh;
-				std::map<std::string, ShapeAttributes> shapeAttributeMapByName;
-				DirectX::XMFLOAT4X4 W;
-				Microsoft::WRL::ComPtr<ID3D11Buffer> d3dVertexBuffer;
-				Microsoft::WRL::ComPtr<ID3D11Buffer> d3dIndexBuffer;
-
-
-				Microsoft::WRL::ComPtr < ID3D11ShaderResourceView> diffuse_texture_view;
-				Microsoft::WRL::ComPtr < ID3D11ShaderResourceView> normal_texture_view;
-				Microsoft::WRL::ComPtr < ID3D11ShaderResourceView> gloss_texture_view;
+				Material material;
+				std::array<render::ResourceHandle, render::kTextureSlotCount> textures = {};
+				uint32 textureSet = 0;
 			};
 
 
@@ -149,9 +136,17 @@ namespace xtest {
 
 			void InitMatrices();
 			void InitShaders();
-			void InitRenderable();
 			void InitLights();
 			void InitRasterizerState();
+			void InitRenderBackend();
+			void InitMeshes();
+			void InitMaterials();
+			void InitScene();
+			render::DrawPacket MakeDrawPacket(const void* vertices, size_t vertexByteSize, const void* indices, size_t indexByteSize);
+			void AddMesh(const std::string& name, const mesh::MeshData& meshData, bool isOccluder);
+			void AddLodMesh(const std::string& name, std::vector<mesh::MeshData> levels);
+			PerObjectCB* AllocatePerObjectCB(render::ConstantBufferBinding* binding);
+			void CullScene(DirectX::FXMMATRIX viewProjection);
 
 
 			DirectX::XMFLOAT4X4 m_viewMatrix;
@@ -168,18 +163,21 @@ namespace xtest {
 			bool m_isLightControlDirty;
 			bool m_stopLights;
 
-			Renderable m_sphere;
-			Renderable m_plane;
-			GPFRenderable m_crate;
-			Renderable m_torus;
-			Renderable m_torus_knot;
-			Renderable m_torus_knot2;
+			mesh::LodSelectionSettings m_lodSettings;
+			mesh::LodStatistics m_lodStatistics;
 
+			// the objects are loaded from a scene file, their meshes and materials are found by name
+			scene::Scene m_scene;
+			std::vector<SceneMesh> m_meshes;
+			std::vector<SceneMaterial> m_materials;
+			std::map<std::string, uint32> m_meshIdByName;
+			std::map<std::string, uint32> m_materialIdByName;
 
-			Renderable m_box1;
-			Renderable m_box2;
-			Renderable m_box3;
-			Renderable m_box4;
+			// the visible objects with an occluder mesh hide the others, the object index of every occludee tested
+			render::OcclusionCuller m_occlusionCuller;
+			std::vector<uint32> m_occludeeIndices;
+			std::vector<bool> m_isOccluded;
+			uint32 m_occludedCount;
 
 
 			Microsoft::WRL::ComPtr<ID3D11Buffer> m_d3dPerFrameCB;
@@ -191,6 +189,18 @@ namespace xtest {
 
 			Microsoft::WRL::ComPtr <ID3D11SamplerState> m_textureSampler;
 
+			// the draws of a frame are queued as packets sorted by pipeline, texture set and depth, then the backend
+			// makes the d3d calls skipping the resources already bound
+			std::unique_ptr<render::D3D11RenderBackend> m_renderBackend;
+			render::DrawQueue m_drawQueue;
+			render::ResourceHandle m_pipelineHandle;
+			render::ResourceHandle m_perFrameCBHandle;
+			render::ResourceHandle m_rarelyChangedCBHandle;
+
+			// the per object constants of every frame are written in a single mapping of one buffer
+			std::unique_ptr<render::D3D11ConstantRing> m_constantRing;
+			render::ResourceHandle m_constantRingHandle;
+
 		};
 
 	} // demo
@@ -1,27 +1,28 @@
 #include "stdafx.h"
 #include "file_utils.h"
-#include <iostream>
+#include <file/gpf_format.h>
+#include <file/gpf_indices.h>
+#include <mesh/vertex_codec.h>
+#include <mesh/mesh_bounds.h>
+#include <common/parallel_for.h>
 #include <fstream>
-#include <mesh/mesh_generator.h>
-#include <unordered_map>
-#include <set>
-#include <external_libs/tiny_obj_loader/tiny_obj_loader.h>
 
 
 using xtest::file::BinaryFile;
+using xtest::file::MappedFile;
+using xtest::file::GPFView;
+using xtest::file::GPFMeshHeader;
+using xtest::file::GPFLayout;
 
 
 namespace
 {
-	struct GPFMeshHeader
-	{
-		char name[24] = { 0 };
-		uint32 vertexCount = 0;
-		uint32 indexCount = 0;
-		uint32 vertexOffset = 0;
-		uint32 indexOffset = 0;
-		char unused[24] = { 0 };
-	};
+	// the name is padded with zeros, it has no terminator if it takes the whole field
+	std::string MeshName(const GPFMeshHeader& meshHeader)
+	{
+		const char* name = meshHeader.name;
+		return std::string(name, std::find(name, name + sizeof(meshHeader.name), '\0'));
+	}
 }
 
 
@@ -47,197 +48,178 @@ std::future<BinaryFile> xtest::file::ReadBinaryFile(std::wstring filePath)
 }
 
 
+MappedFile xtest::file::MapFile(const std::wstring& filePath)
+{
+	HANDLE fileHandle = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	XTEST_ASSERT(fileHandle != INVALID_HANDLE_VALUE, L"unable to open the file:'%s'", filePath.c_str());
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return MappedFile();
+	}
+
+	LARGE_INTEGER byteSize;
+	if (!GetFileSizeEx(fileHandle, &byteSize) || byteSize.QuadPart == 0)
+	{
+		// an empty file can't be mapped
+		CloseHandle(fileHandle);
+		return MappedFile();
+	}
+
+	HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	XTEST_ASSERT(mappingHandle != nullptr, L"unable to map the file:'%s'", filePath.c_str());
+	if (!mappingHandle)
+	{
+		CloseHandle(fileHandle);
+		return MappedFile();
+	}
+
+	const char* data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	XTEST_ASSERT(data != nullptr, L"unable to map a view of the file:'%s'", filePath.c_str());
+	if (!data)
+	{
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		return MappedFile();
+	}
+
+	return MappedFile(fileHandle, mappingHandle, data, uint64(byteSize.QuadPart));
+}
+
+
 xtest::mesh::GPFMesh xtest::file::ReadGPF(const std::wstring& filePath)
 {
 	std::future<file::BinaryFile> fileFuture = file::ReadBinaryFile(filePath);
 	file::BinaryFile gpf = fileFuture.get();
 	mesh::GPFMesh gpfMesh;
 
+	// both v1 and v2 files are accepted, see gpf_format.h for the layouts
+	GPFLayout layout;
+	bool parsed = ParseGPFLayout(gpf.Data(), gpf.ByteSize(), &layout);
+	XTEST_ASSERT(parsed, L"invalid gpf file:'%s'", filePath.c_str());
+	if (!parsed)
+	{
+		return gpfMesh;
+	}
 
-	// reading gpf file:
-	//
-	// 		+---------------------------------------------------------------------------------------------------------------------- - +
-	// 		| mesh  | name | vertex | index  | vertex | index  | Unused | ... |   mesh 1   | mesh 2   | ... | mesh 1  | mesh 2  | ... |
-	// 		| count |      | count  | count  | offset | offset |        |     |   Vertices | Vertices |     | Indices | Indices |     |
-	// 		+---------------------------------------------------------------------------------------------------------------------- - +
-	// 	       4b     24b      4b       4b      4b      4b        24b
-	// 			    ^                                                   ^
-	// 			    |                                                   |
-	// 			    +-------------------------------------------------- +
-	// 			                       gpfMeshHeader
-	// 			                            64b
-
-	const int32* meshCountPtr = reinterpret_cast<const int32*>(gpf.Data());
-	int32 meshCount = *meshCountPtr;
-	meshCountPtr++;
-	
-	const GPFMeshHeader* meshHeaderPtr = reinterpret_cast<const GPFMeshHeader*>(meshCountPtr);
-	uint32 totalVertexCount = 0;
-	uint32 totalIndexCount = 0;
-
-	for (int32 meshHeaderIndex = 0; meshHeaderIndex < meshCount; meshHeaderIndex++)
-	{
-		GPFMeshHeader meshHeader = *meshHeaderPtr;
-		meshHeaderPtr++;
+	for (uint32 meshHeaderIndex = 0; meshHeaderIndex < layout.meshCount; meshHeaderIndex++)
+	{
+		const GPFMeshHeader& meshHeader = layout.meshHeaders[meshHeaderIndex];
 
 		mesh::GPFMesh::MeshDescriptor meshDesc;
 		meshDesc.indexCount = meshHeader.indexCount;
 		meshDesc.vertexCount = meshHeader.vertexCount;
 		meshDesc.indexOffset = meshHeader.indexOffset;
 		meshDesc.vertexOffset = meshHeader.vertexOffset;
-		
-		gpfMesh.meshDescriptorMapByName[std::string(meshHeader.name)] = meshDesc;
-		totalVertexCount += meshDesc.vertexCount;
-		totalIndexCount += meshDesc.indexCount;
+		gpfMesh.meshDescriptorMapByName[MeshName(meshHeader)] = meshDesc;
 	}
 
-
-	gpfMesh.meshData.vertices.resize(totalVertexCount);
-	gpfMesh.meshData.indices.resize(totalIndexCount);
-	
-
-	const char* data = reinterpret_cast<const char*>(meshHeaderPtr);
-	std::memcpy(&gpfMesh.meshData.vertices[0], data, sizeof(mesh::MeshData::Vertex) * gpfMesh.meshData.vertices.size());
-
-	data += sizeof(mesh::MeshData::Vertex) * gpfMesh.meshData.vertices.size();
-	std::memcpy(&gpfMesh.meshData.indices[0], data, sizeof(int32) * gpfMesh.meshData.indices.size());
-
-	return gpfMesh;
-}
-
-
-void xtest::file::WriteGPFOnDiskFromObj(const std::wstring& inputFile, const std::wstring & outputFile)
-{
-
-	auto HashFn = [](const mesh::MeshData::Vertex& vertex) 
-	{
-		return std::hash<float>{}(vertex.position.x)
-			^ (std::hash<float>{}(vertex.position.y) << 1)
-			^ (std::hash<float>{}(vertex.position.z) << 1)
-			^ (std::hash<float>{}(vertex.normal.x) << 1)
-			^ (std::hash<float>{}(vertex.normal.y) << 1)
-			^ (std::hash<float>{}(vertex.normal.z) << 1)
-			^ (std::hash<float>{}(vertex.tangentU.x) << 1)
-			^ (std::hash<float>{}(vertex.tangentU.y) << 1)
-			^ (std::hash<float>{}(vertex.tangentU.z) << 1)
-			^ (std::hash<float>{}(vertex.uv.x) << 1)
-			^ (std::hash<float>{}(vertex.uv.y) << 1);
-	};
-	
-	typedef std::unordered_map<mesh::MeshData::Vertex, uint32, decltype(HashFn)> VertexIndexMap;
-
-
-
- 	tinyobj::attrib_t attrib;
-	std::vector<tinyobj::shape_t> shapes;
-	std::vector<tinyobj::material_t> materials;
-	std::string warn;
-	std::string err;
-
-	//workaround: tiny object doesn't support multi byte string
-	std::string inputFile_asString(inputFile.begin(), inputFile.end());
-
-	bool result = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, inputFile_asString.c_str());
-	XTEST_ASSERT(result, L"tiny object loader failed to parse the file");
-
-	if (result)
-	{
-	    mesh::MeshData meshData;
-		std::vector<GPFMeshHeader> gpfMeshHeaders;
-		uint32 gpfVertexOffset = 0;
-		uint32 gpfIndexOffset = 0;
-		
-		for (size_t shapeIndex = 0; shapeIndex < shapes.size(); shapeIndex++)
+	if (layout.vertices)
+	{
+		gpfMesh.meshData.vertices.assign(layout.vertices, layout.vertices + layout.vertexCount);
+	}
+	else if (layout.compressedVertexStride == sizeof(mesh::MeshData::Vertex))
+	{
+		// the chunks of the stream are decoded in parallel
+		gpfMesh.meshData.vertices.resize(layout.vertexCount);
+		bool decoded = mesh::DecodeVertices(layout.compressedVertices, size_t(layout.compressedVertexByteSize), gpfMesh.meshData.vertices.data(),
+			layout.vertexCount, sizeof(mesh::MeshData::Vertex), common::HardwareThreadCount());
+		XTEST_ASSERT(decoded, L"invalid vertices in the gpf file:'%s'", filePath.c_str());
+		if (!decoded)
 		{
-			VertexIndexMap indexMapByVertex(shapes[shapeIndex].mesh.indices.size(), HashFn);
-			GPFMeshHeader gpfMeshHeader;
-			uint32 gpfVertexCount = 0;
-			uint32 gpfIndexCount = 0;
-			uint32 meshDataIndex = 0;
-			
-
-			size_t tyniobjIndexOffset = 0;
-			for (size_t faceIndex = 0; faceIndex < shapes[shapeIndex].mesh.num_face_vertices.size(); faceIndex++) 
+			return mesh::GPFMesh();
+		}
+	}
+	else
+	{
+		const mesh::PackedVertex* packedVertices = layout.packedVertices;
+		std::vector<mesh::PackedVertex> decodedPackedVertices;
+		if (!packedVertices)
+		{
+			decodedPackedVertices.resize(layout.vertexCount);
+			bool decoded = mesh::DecodeVertices(layout.compressedVertices, size_t(layout.compressedVertexByteSize), decodedPackedVertices.data(),
+				layout.vertexCount, sizeof(mesh::PackedVertex), common::HardwareThreadCount());
+			XTEST_ASSERT(decoded, L"invalid vertices in the gpf file:'%s'", filePath.c_str());
+			if (!decoded)
 			{
-				const size_t faceVertexCount = shapes[shapeIndex].mesh.num_face_vertices[faceIndex];
-				for (size_t tyniobjVertexIndex = 0; tyniobjVertexIndex < faceVertexCount; tyniobjVertexIndex++) 
-				{
-					// access to vertex data
-					tinyobj::index_t idx = shapes[shapeIndex].mesh.indices[tyniobjIndexOffset + tyniobjVertexIndex];
-					tinyobj::real_t vx = attrib.vertices[3 * idx.vertex_index + 0];
-					tinyobj::real_t vy = attrib.vertices[3 * idx.vertex_index + 1];
-					tinyobj::real_t vz = attrib.vertices[3 * idx.vertex_index + 2];
-					tinyobj::real_t nx = attrib.normals[3 * idx.normal_index + 0];
-					tinyobj::real_t ny = attrib.normals[3 * idx.normal_index + 1];
-					tinyobj::real_t nz = attrib.normals[3 * idx.normal_index + 2];
-					tinyobj::real_t tx = attrib.texcoords[2 * idx.texcoord_index + 0];
-					tinyobj::real_t ty = attrib.texcoords[2 * idx.texcoord_index + 1];
-
-					// merge vertex data
-					mesh::MeshData::Vertex meshDataVertex = { { vx, vy, vz },{ nx, ny, nz },{ 0.f, 0.f, 0.f },{ tx, ty } };
-
-					// keeps vertex unique per shape, but store all vertex buffers and index buffer together
-					VertexIndexMap::iterator iter = indexMapByVertex.find(meshDataVertex);
-					if (iter == indexMapByVertex.end())
-					{
-						meshData.vertices.push_back(meshDataVertex);
-						meshData.indices.push_back(meshDataIndex);
-						indexMapByVertex[meshDataVertex] = meshDataIndex++;
-						gpfVertexCount++;
-						gpfIndexCount++;
-					}
-					else
-					{
-						meshData.indices.push_back(iter->second);
-						gpfIndexCount++;
-					}
-				}
-				tyniobjIndexOffset += faceVertexCount;
+				return mesh::GPFMesh();
 			}
+			packedVertices = decodedPackedVertices.data();
+		}
 
-			// register mesh header data
-			// fixed name width for our format (24 in total, null terminator included)
-			const char* shapeName_cstr = shapes[shapeIndex].name.c_str();
-			std::memcpy(&gpfMeshHeader.name, shapeName_cstr, std::min(sizeof(gpfMeshHeader.name) - 1, std::strlen(shapeName_cstr)));
-
-			// vertex index data
-			gpfMeshHeader.vertexCount = gpfVertexCount;
-			gpfMeshHeader.indexCount = gpfIndexCount;
-			gpfMeshHeader.vertexOffset = gpfVertexOffset;
-			gpfMeshHeader.indexOffset = gpfIndexOffset;
+		// every mesh has its own quantization
+		gpfMesh.meshData.vertices.resize(layout.vertexCount);
+		for (uint32 meshHeaderIndex = 0; meshHeaderIndex < layout.meshCount; meshHeaderIndex++)
+		{
+			const GPFMeshHeader& meshHeader = layout.meshHeaders[meshHeaderIndex];
+			mesh::UnpackVertices(packedVertices + meshHeader.vertexOffset, meshHeader.vertexCount,
+				layout.vertexQuantizations[meshHeaderIndex], gpfMesh.meshData.vertices.data() + meshHeader.vertexOffset);
+		}
+	}
 
+	// files without the bounds section get them from the vertices, the bounds of the whole file merge the ones of
+	// the meshes instead of going through all the vertices again
+	std::vector<mesh::MeshBounds> meshBounds(layout.meshCount);
+	for (uint32 meshHeaderIndex = 0; meshHeaderIndex < layout.meshCount; meshHeaderIndex++)
+	{
+		const GPFMeshHeader& meshHeader = layout.meshHeaders[meshHeaderIndex];
+		meshBounds[meshHeaderIndex] = layout.bounds
+			? layout.bounds[meshHeaderIndex]
+			: mesh::ComputeBounds(gpfMesh.meshData.vertices.data() + meshHeader.vertexOffset, meshHeader.vertexCount);
+		gpfMesh.meshDescriptorMapByName[MeshName(meshHeader)].bounds = meshBounds[meshHeaderIndex];
+	}
+	gpfMesh.meshData.bounds = mesh::MergeBounds(meshBounds.data(), layout.meshCount);
 
-			gpfMeshHeaders.push_back(gpfMeshHeader);
-			gpfVertexOffset += gpfVertexCount;
-			gpfIndexOffset += gpfIndexCount;
+	if (layout.indices)
+	{
+		gpfMesh.meshData.indices.assign(layout.indices, layout.indices + layout.indexCount);
+		for (uint32 meshHeaderIndex = 0; meshHeaderIndex < layout.meshCount; meshHeaderIndex++)
+		{
+			const GPFMeshHeader& meshHeader = layout.meshHeaders[meshHeaderIndex];
+			bool inRange = AreGPFIndicesInRange(layout.indices + meshHeader.indexOffset, meshHeader.indexCount, meshHeader.vertexCount);
+			XTEST_ASSERT(inRange, L"invalid indices in the gpf file:'%s'", filePath.c_str());
+			if (!inRange)
+			{
+				return mesh::GPFMesh();
+			}
 		}
+	}
+	else
+	{
+		gpfMesh.meshData.indices.resize(layout.indexCount);
+		for (uint32 meshHeaderIndex = 0; meshHeaderIndex < layout.meshCount; meshHeaderIndex++)
+		{
+			const GPFMeshHeader& meshHeader = layout.meshHeaders[meshHeaderIndex];
+			bool decoded = DecodeGPFIndices(layout.encodedIndices, layout.indexBlocks[meshHeaderIndex], meshHeader.indexCount, meshHeader.vertexCount,
+				gpfMesh.meshData.indices.data() + meshHeader.indexOffset);
+			XTEST_ASSERT(decoded, L"invalid indices in the gpf file:'%s'", filePath.c_str());
+			if (!decoded)
+			{
+				return mesh::GPFMesh();
+			}
+		}
+	}
 
+	return gpfMesh;
+}
 
 
-		// write gpf file on disk following this format:
-		//
-		// 		+---------------------------------------------------------------------------------------------------------------------- - +
-	    // 		| mesh  | name | vertex | index  | vertex | index  | Unused | ... |   mesh 1   | mesh 2   | ... | mesh 1  | mesh 2  | ... |
-		// 		| count |      | count  | count  | offset | offset |        |     |   Vertices | Vertices |     | Indices | Indices |     |
-		// 		+---------------------------------------------------------------------------------------------------------------------- - +
-		// 	       4b     24b      4b       4b      4b      4b        24b
-		// 			    ^                                                   ^
-		// 			    |                                                   |
-		// 			    +-------------------------------------------------- +
-		// 			                       gpfMeshHeader
-		// 			                            64b
-
-		std::ofstream outPutFile(outputFile.c_str(), std::ifstream::binary);
+GPFView xtest::file::MapGPF(const std::wstring& filePath)
+{
+	GPFView view;
+	view.m_file = MapFile(filePath);
 
-		int32 meshCount = int32(gpfMeshHeaders.size());
-		outPutFile.write(reinterpret_cast<char*>(&meshCount), sizeof(int32));
+	if (!view.m_file.IsMapped())
+	{
+		return view;
+	}
 
-		for (GPFMeshHeader& gpfMeshHeader : gpfMeshHeaders)
-		{
-			outPutFile.write(reinterpret_cast<char*>(&gpfMeshHeader), sizeof(GPFMeshHeader));
-		}
-		outPutFile.write(reinterpret_cast<char*>(&meshData.vertices[0]), sizeof(mesh::MeshData::Vertex) * meshData.vertices.size());
-		outPutFile.write(reinterpret_cast<char*>(&meshData.indices[0]), sizeof(int32) * meshData.indices.size());
+	// both v1 and v2 files are accepted, the layout points directly inside the mapping
+	bool parsed = ParseGPFLayout(view.m_file.Data(), view.m_file.ByteSize(), &view.m_layout);
+	XTEST_ASSERT(parsed, L"invalid gpf file:'%s'", filePath.c_str());
+	if (!parsed)
+	{
+		return GPFView();
 	}
-}
 
+	return view;
+}
@@ -2,6 +2,9 @@
 
 #include <future>
 #include <file/binary_file.h>
+#include <file/mapped_file.h>
+#include <file/gpf_view.h>
+#include <file/obj_baker.h>
 #include <mesh/mesh_format.h>
 
 
@@ -12,9 +15,12 @@ namespace file {
 
 	std::future<BinaryFile> ReadBinaryFile(std::wstring filePath);
 
+	MappedFile MapFile(const std::wstring& filePath);
+
 	mesh::GPFMesh ReadGPF(const std::wstring& filePath);
 
-	void WriteGPFOnDiskFromObj(const std::wstring& inputFile, const std::wstring& outputFile);
+	// maps the gpf file in memory without copying vertices and indices, see GPFView
+	GPFView MapGPF(const std::wstring& filePath);
 	
 
 } //file
@@ -0,0 +1,116 @@
+#include "stdafx.h"
+#include "gpf_benchmark.h"
+#include <file/file_utils.h>
+#include <file/gpf_bounds.h>
+#include <file/gpf_writer.h>
+#include <time/time_point.h>
+
+
+using xtest::file::GPFBenchmarkResult;
+using xtest::file::GPFMeshHeader;
+using xtest::file::GPFView;
+
+
+namespace
+{
+	const uint32 kPageByteSize = 4096;
+
+
+	// reads a byte every page, so that the OS maps them all
+	uint32 TouchPages(const char* data, uint64 byteSize)
+	{
+		uint32 sum = 0;
+		for (uint64 offset = 0; offset < byteSize; offset += kPageByteSize)
+		{
+			sum += uint8(data[offset]);
+		}
+		return sum;
+	}
+}
+
+
+GPFBenchmarkResult xtest::file::RunGPFBenchmark(const std::wstring& filePath, uint32 meshCount, uint32 verticesPerMesh)
+{
+	XTEST_ASSERT(verticesPerMesh >= 3, L"a mesh needs at least a triangle");
+
+	// every mesh is a strip of triangles over a spiral of vertices, the indices of a mesh are 1.5 times its vertices
+	GPFBenchmarkResult result;
+	{
+		std::vector<GPFMeshHeader> meshHeaders(meshCount);
+		mesh::MeshData meshData;
+		meshData.vertices.resize(uint64(meshCount) * verticesPerMesh);
+		for (uint32 meshIndex = 0; meshIndex < meshCount; meshIndex++)
+		{
+			GPFMeshHeader& meshHeader = meshHeaders[meshIndex];
+			const std::string name = "mesh_" + std::to_string(meshIndex);
+			std::copy(name.begin(), name.begin() + std::min(name.size(), sizeof(meshHeader.name) - 1), meshHeader.name);
+			meshHeader.vertexCount = verticesPerMesh;
+			meshHeader.vertexOffset = meshIndex * verticesPerMesh;
+			meshHeader.indexOffset = uint32(meshData.indices.size());
+
+			for (uint32 vertex = 0; vertex < verticesPerMesh; vertex++)
+			{
+				const float angle = float(vertex) * 0.01f;
+				mesh::MeshData::Vertex& v = meshData.vertices[meshHeader.vertexOffset + vertex];
+				v.position = { std::cos(angle) * 10.f, float(vertex) * 1e-4f, std::sin(angle) * 10.f };
+				v.normal = { std::cos(angle), 0.f, std::sin(angle) };
+				v.tangentU = { -std::sin(angle), 0.f, std::cos(angle) };
+				v.uv = { float(vertex % 1024) / 1024.f, float(meshIndex) / float(meshCount) };
+			}
+
+			for (uint32 triangle = 0; triangle + 2 < verticesPerMesh; triangle += 2)
+			{
+				meshData.indices.insert(meshData.indices.end(), { triangle, triangle + 1, triangle + 2 });
+			}
+			meshHeader.indexCount = uint32(meshData.indices.size()) - meshHeader.indexOffset;
+		}
+
+		const std::vector<mesh::MeshBounds> bounds = ComputeGPFBounds(meshHeaders, meshData);
+		GPFWriter writer(meshHeaders, meshData);
+		AddBoundsSection(bounds, &writer);
+		const bool written = writer.WriteOnDisk(filePath);
+		XTEST_ASSERT(written, L"unable to write the benchmark file:'%s'", filePath.c_str());
+		if (!written)
+		{
+			return result;
+		}
+
+		result.meshCount = meshCount;
+		result.vertexCount = uint32(meshData.vertices.size());
+		result.indexCount = uint32(meshData.indices.size());
+	}
+
+	// ReadGPF reads the whole file in memory and copies the vertices and the indices out of it
+	{
+		const time::TimePoint readStart = time::TimePoint::Now();
+		const mesh::GPFMesh gpfMesh = ReadGPF(filePath);
+		result.readMillis = (time::TimePoint::Now() - readStart).Millis();
+
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+		if (GetFileAttributesExW(filePath.c_str(), GetFileExInfoStandard, &attributes))
+		{
+			result.fileByteSize = (uint64(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+		}
+		result.readCopiedBytes = result.fileByteSize + gpfMesh.meshData.vertices.size() * sizeof(mesh::MeshData::Vertex)
+			+ gpfMesh.meshData.indices.size() * sizeof(uint32);
+	}
+
+	// MapGPF copies only the descriptors, the pages are read on first access
+	{
+		const time::TimePoint mapStart = time::TimePoint::Now();
+		GPFView view = MapGPF(filePath);
+		const std::map<std::string, mesh::GPFMesh::MeshDescriptor> descriptors = view.MeshDescriptorMapByName();
+		const time::TimePoint touchStart = time::TimePoint::Now();
+		const uint32 pageSum = TouchPages(reinterpret_cast<const char*>(view.Vertices()), view.VertexByteSize())
+			+ TouchPages(reinterpret_cast<const char*>(view.Indices()), view.IndexByteSize());
+		const time::TimePoint touchEnd = time::TimePoint::Now();
+		XTEST_UNUSED_VAR(pageSum);
+
+		result.mapMillis = (touchStart - mapStart).Millis();
+		result.mapCopiedBytes = descriptors.size() * sizeof(mesh::GPFMesh::MeshDescriptor);
+		result.mapTouchMillis = (touchEnd - touchStart).Millis();
+	}
+
+	DeleteFileW(filePath.c_str());
+	return result;
+}
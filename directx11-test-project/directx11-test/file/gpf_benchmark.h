@@ -0,0 +1,31 @@
+#pragma once
+
+
+namespace xtest {
+namespace file {
+
+	// the times of loading the same file with ReadGPF and with MapGPF, and the bytes each one copies
+	struct GPFBenchmarkResult
+	{
+		uint64 fileByteSize = 0;
+		uint32 meshCount = 0;
+		uint32 vertexCount = 0;
+		uint32 indexCount = 0;
+
+		float readMillis = 0.f;			// ReadGPF, until the mesh data is in memory
+		uint64 readCopiedBytes = 0;		// the whole file read in memory, then the vertices and the indices copied out of it
+		float mapMillis = 0.f;			// MapGPF and the mesh descriptors
+		uint64 mapCopiedBytes = 0;		// the mesh descriptors only
+		float mapTouchMillis = 0.f;		// a read of every page of the vertices and of the indices through the view
+	};
+
+
+	/**
+	Writes a synthetic gpf v2 file of meshCount meshes with verticesPerMesh plain vertices each and loads it with
+	ReadGPF and with MapGPF; the file is deleted at the end. The file was just written, so both paths mostly read
+	it from the OS cache: the times compare the copies and the page faults, not the disk.
+	*/
+	GPFBenchmarkResult RunGPFBenchmark(const std::wstring& filePath, uint32 meshCount = 16, uint32 verticesPerMesh = 512 * 1024);
+
+} // file
+} // xtest
@@ -0,0 +1,31 @@
+#include "stdafx.h"
+#include "gpf_bounds.h"
+#include <file/gpf_writer.h>
+#include <mesh/mesh_bounds.h>
+
+
+using xtest::file::GPFMeshHeader;
+using xtest::file::GPFSectionType;
+using xtest::mesh::MeshBounds;
+using xtest::mesh::MeshData;
+
+
+std::vector<MeshBounds> xtest::file::ComputeGPFBounds(const std::vector<GPFMeshHeader>& meshHeaders, const MeshData& meshData)
+{
+	std::vector<MeshBounds> bounds;
+	bounds.reserve(meshHeaders.size());
+	for (const GPFMeshHeader& meshHeader : meshHeaders)
+	{
+		XTEST_ASSERT(uint64(meshHeader.vertexOffset) + meshHeader.vertexCount <= meshData.vertices.size(), L"the mesh vertices are out of the vertex buffer");
+		bounds.push_back(mesh::ComputeBounds(meshData.vertices.data() + meshHeader.vertexOffset, meshHeader.vertexCount));
+	}
+	return bounds;
+}
+
+
+void xtest::file::AddBoundsSection(const std::vector<MeshBounds>& bounds, GPFWriter* writer)
+{
+	XTEST_ASSERT(writer);
+
+	writer->AddSection(GPFSectionType::bounds, bounds);
+}
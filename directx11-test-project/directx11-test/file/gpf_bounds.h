@@ -0,0 +1,21 @@
+#pragma once
+
+#include <file/gpf_format.h>
+
+
+namespace xtest {
+namespace file {
+
+	class GPFWriter;
+
+
+	// the bounds of every mesh, in mesh header order, see mesh::ComputeBounds
+	std::vector<mesh::MeshBounds> ComputeGPFBounds(const std::vector<GPFMeshHeader>& meshHeaders, const mesh::MeshData& meshData);
+
+	// the bounds are referenced, not copied: they must stay alive until the writer is done.
+	// readers find them in GPFLayout::bounds and in every mesh descriptor
+	void AddBoundsSection(const std::vector<mesh::MeshBounds>& bounds, GPFWriter* writer);
+
+} // file
+} // xtest
+
@@ -0,0 +1,337 @@
+#include "stdafx.h"
+#include "gpf_format.h"
+#include <mesh/index_codec.h>
+
+using xtest::file::GPFLayout;
+using xtest::file::GPFFileHeader;
+using xtest::file::GPFMeshHeader;
+using xtest::file::GPFSectionEntry;
+using xtest::file::GPFSectionType;
+using xtest::file::GPFIndexBlock;
+using xtest::file::GPFIndexEncoding;
+using xtest::mesh::MeshBounds;
+using xtest::mesh::MeshData;
+using xtest::mesh::PackedVertex;
+using xtest::mesh::VertexQuantization;
+
+
+namespace
+{
+	bool IsV2(const char* data, uint64 byteSize)
+	{
+		const GPFFileHeader referenceHeader;
+		return byteSize >= sizeof(GPFFileHeader) && std::memcmp(data, referenceHeader.magic, sizeof(referenceHeader.magic)) == 0;
+	}
+
+
+	bool ParseV1(const char* data, uint64 byteSize, GPFLayout* layout)
+	{
+		if (byteSize < sizeof(int32))
+		{
+			return false;
+		}
+
+		const int32 meshCount = *reinterpret_cast<const int32*>(data);
+		if (meshCount < 0 || byteSize < sizeof(int32) + uint64(meshCount) * sizeof(GPFMeshHeader))
+		{
+			return false;
+		}
+
+		const GPFMeshHeader* meshHeaders = reinterpret_cast<const GPFMeshHeader*>(data + sizeof(int32));
+		uint64 totalVertexCount = 0;
+		uint64 totalIndexCount = 0;
+		for (int32 meshHeaderIndex = 0; meshHeaderIndex < meshCount; meshHeaderIndex++)
+		{
+			totalVertexCount += meshHeaders[meshHeaderIndex].vertexCount;
+			totalIndexCount += meshHeaders[meshHeaderIndex].indexCount;
+		}
+
+		// the layout counts are 32 bits wide, and so the byte sizes below cannot overflow
+		if (totalVertexCount > UINT32_MAX || totalIndexCount > UINT32_MAX)
+		{
+			return false;
+		}
+
+		const uint64 headersByteSize = sizeof(int32) + uint64(meshCount) * sizeof(GPFMeshHeader);
+		const uint64 vertexByteSize = totalVertexCount * sizeof(MeshData::Vertex);
+		const uint64 indexByteSize = totalIndexCount * sizeof(uint32);
+		if (byteSize < headersByteSize + vertexByteSize + indexByteSize)
+		{
+			return false;
+		}
+
+		layout->version = 1;
+		layout->meshCount = uint32(meshCount);
+		layout->meshHeaders = meshHeaders;
+		layout->vertices = reinterpret_cast<const MeshData::Vertex*>(data + headersByteSize);
+		layout->vertexCount = uint32(totalVertexCount);
+		layout->indices = reinterpret_cast<const uint32*>(data + headersByteSize + vertexByteSize);
+		layout->indexCount = uint32(totalIndexCount);
+		layout->sections = nullptr;
+		layout->sectionCount = 0;
+
+		// every mesh must reference data inside the streams
+		for (int32 meshHeaderIndex = 0; meshHeaderIndex < meshCount; meshHeaderIndex++)
+		{
+			const GPFMeshHeader& meshHeader = meshHeaders[meshHeaderIndex];
+			if (uint64(meshHeader.vertexOffset) + meshHeader.vertexCount > layout->vertexCount
+				|| uint64(meshHeader.indexOffset) + meshHeader.indexCount > layout->indexCount)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+
+	// the file header, the section table and the sections with data don't share any byte, so that the pointers of a
+	// layout never alias each other; every range is already known to lie inside the file
+	bool AreSectionsDisjoint(const GPFFileHeader& fileHeader, const GPFSectionEntry* sections)
+	{
+		std::vector<std::pair<uint64, uint64>> ranges;
+		ranges.reserve(fileHeader.sectionCount + 2);
+		ranges.emplace_back(0, sizeof(GPFFileHeader));
+		ranges.emplace_back(fileHeader.sectionTableOffset, fileHeader.sectionTableOffset + uint64(fileHeader.sectionCount) * sizeof(GPFSectionEntry));
+		for (uint32 sectionIndex = 0; sectionIndex < fileHeader.sectionCount; sectionIndex++)
+		{
+			if (sections[sectionIndex].byteSize > 0)
+			{
+				ranges.emplace_back(sections[sectionIndex].offset, sections[sectionIndex].offset + sections[sectionIndex].byteSize);
+			}
+		}
+
+		std::sort(ranges.begin(), ranges.end());
+		for (size_t rangeIndex = 1; rangeIndex < ranges.size(); rangeIndex++)
+		{
+			if (ranges[rangeIndex].first < ranges[rangeIndex - 1].second)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	bool IsValidIndexBlock(const GPFIndexBlock& indexBlock, const GPFMeshHeader& meshHeader, uint64 sectionByteSize)
+	{
+		if (indexBlock.byteOffset > sectionByteSize || indexBlock.byteSize > sectionByteSize - indexBlock.byteOffset)
+		{
+			return false;
+		}
+
+		switch (indexBlock.encoding)
+		{
+		case GPFIndexEncoding::uint32_list:
+			return indexBlock.byteOffset % sizeof(uint32) == 0 && indexBlock.byteSize == uint64(meshHeader.indexCount) * sizeof(uint32);
+		case GPFIndexEncoding::uint16_list:
+			return indexBlock.byteOffset % sizeof(uint16) == 0 && indexBlock.byteSize == uint64(meshHeader.indexCount) * sizeof(uint16)
+				&& meshHeader.vertexCount <= xtest::mesh::kMaxNarrowIndexVertexCount;
+		case GPFIndexEncoding::fifo_codec:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+
+	bool ParseV2(const char* data, uint64 byteSize, GPFLayout* layout)
+	{
+		const GPFFileHeader* fileHeader = reinterpret_cast<const GPFFileHeader*>(data);
+		if (fileHeader->version != 2 || fileHeader->fileByteSize > byteSize)
+		{
+			return false;
+		}
+
+		// the offsets and the sizes come from the file, they are compared without adding them so that nothing wraps
+		const uint64 fileByteSize = fileHeader->fileByteSize;
+		const uint64 tableByteSize = uint64(fileHeader->sectionCount) * sizeof(GPFSectionEntry);
+		if (fileHeader->sectionTableOffset % xtest::file::kGPFSectionTableAlignment != 0 || fileHeader->sectionTableOffset < sizeof(GPFFileHeader)
+			|| fileHeader->sectionTableOffset > fileByteSize || tableByteSize > fileByteSize - fileHeader->sectionTableOffset)
+		{
+			return false;
+		}
+
+		layout->version = 2;
+		layout->meshCount = fileHeader->meshCount;
+		layout->sections = reinterpret_cast<const GPFSectionEntry*>(data + fileHeader->sectionTableOffset);
+		layout->sectionCount = fileHeader->sectionCount;
+
+		// every section must lie inside the file, unknown sections are checked too even if nobody reads them
+		for (uint32 sectionIndex = 0; sectionIndex < layout->sectionCount; sectionIndex++)
+		{
+			const GPFSectionEntry& section = layout->sections[sectionIndex];
+			if (section.offset % xtest::file::kGPFSectionAlignment != 0
+				|| section.offset > fileByteSize || section.byteSize > fileByteSize - section.offset)
+			{
+				return false;
+			}
+		}
+
+		if (!AreSectionsDisjoint(*fileHeader, layout->sections))
+		{
+			return false;
+		}
+
+		const GPFSectionEntry* headerSection = layout->FindSection(GPFSectionType::mesh_headers);
+		const GPFSectionEntry* vertexSection = layout->FindSection(GPFSectionType::vertices);
+		const GPFSectionEntry* packedVertexSection = layout->FindSection(GPFSectionType::packed_vertices);
+		const GPFSectionEntry* compressedVertexSection = layout->FindSection(GPFSectionType::compressed_vertices);
+		const GPFSectionEntry* quantizationSection = layout->FindSection(GPFSectionType::vertex_quantizations);
+		const GPFSectionEntry* indexSection = layout->FindSection(GPFSectionType::indices);
+		const GPFSectionEntry* encodedIndexSection = layout->FindSection(GPFSectionType::encoded_indices);
+		const GPFSectionEntry* indexBlockSection = layout->FindSection(GPFSectionType::index_blocks);
+		const GPFSectionEntry* boundsSection = layout->FindSection(GPFSectionType::bounds);
+		if (!headerSection || (!vertexSection && !packedVertexSection && !compressedVertexSection)
+			|| (!indexSection && !encodedIndexSection) || (encodedIndexSection && !indexBlockSection))
+		{
+			return false;
+		}
+
+		if (headerSection->elementStride != sizeof(GPFMeshHeader) || headerSection->elementCount != layout->meshCount
+			|| uint64(headerSection->elementCount) * headerSection->elementStride > headerSection->byteSize)
+		{
+			return false;
+		}
+		layout->meshHeaders = reinterpret_cast<const GPFMeshHeader*>(data + headerSection->offset);
+
+		// full vertices win when more than one format is present, old readers only know about them
+		bool needsQuantizations = false;
+		if (vertexSection)
+		{
+			if (vertexSection->elementStride != sizeof(MeshData::Vertex)
+				|| uint64(vertexSection->elementCount) * vertexSection->elementStride > vertexSection->byteSize)
+			{
+				return false;
+			}
+			layout->vertices = reinterpret_cast<const MeshData::Vertex*>(data + vertexSection->offset);
+			layout->vertexCount = vertexSection->elementCount;
+		}
+		else if (packedVertexSection)
+		{
+			if (packedVertexSection->elementStride != sizeof(PackedVertex)
+				|| uint64(packedVertexSection->elementCount) * packedVertexSection->elementStride > packedVertexSection->byteSize)
+			{
+				return false;
+			}
+			layout->packedVertices = reinterpret_cast<const PackedVertex*>(data + packedVertexSection->offset);
+			layout->vertexCount = packedVertexSection->elementCount;
+			needsQuantizations = true;
+		}
+		else
+		{
+			// the element stride tells which vertices have been compressed
+			if (compressedVertexSection->elementStride != sizeof(MeshData::Vertex) && compressedVertexSection->elementStride != sizeof(PackedVertex))
+			{
+				return false;
+			}
+			layout->compressedVertices = reinterpret_cast<const uint8*>(data + compressedVertexSection->offset);
+			layout->compressedVertexByteSize = compressedVertexSection->byteSize;
+			layout->compressedVertexStride = compressedVertexSection->elementStride;
+			layout->vertexCount = compressedVertexSection->elementCount;
+			needsQuantizations = compressedVertexSection->elementStride == sizeof(PackedVertex);
+		}
+
+		if (needsQuantizations)
+		{
+			if (!quantizationSection || quantizationSection->elementStride != sizeof(VertexQuantization) || quantizationSection->elementCount != layout->meshCount
+				|| uint64(quantizationSection->elementCount) * quantizationSection->elementStride > quantizationSection->byteSize)
+			{
+				return false;
+			}
+			layout->vertexQuantizations = reinterpret_cast<const VertexQuantization*>(data + quantizationSection->offset);
+		}
+
+		if (boundsSection)
+		{
+			if (boundsSection->elementStride != sizeof(MeshBounds) || boundsSection->elementCount != layout->meshCount
+				|| uint64(boundsSection->elementCount) * boundsSection->elementStride > boundsSection->byteSize)
+			{
+				return false;
+			}
+			layout->bounds = reinterpret_cast<const MeshBounds*>(data + boundsSection->offset);
+		}
+
+		// plain indices win when both are present, like the vertices
+		if (indexSection)
+		{
+			if (indexSection->elementStride != sizeof(uint32)
+				|| uint64(indexSection->elementCount) * indexSection->elementStride > indexSection->byteSize)
+			{
+				return false;
+			}
+			layout->indices = reinterpret_cast<const uint32*>(data + indexSection->offset);
+			layout->indexCount = indexSection->elementCount;
+		}
+		else
+		{
+			if (indexBlockSection->elementStride != sizeof(GPFIndexBlock) || indexBlockSection->elementCount != layout->meshCount
+				|| uint64(indexBlockSection->elementCount) * indexBlockSection->elementStride > indexBlockSection->byteSize)
+			{
+				return false;
+			}
+			layout->encodedIndices = reinterpret_cast<const uint8*>(data + encodedIndexSection->offset);
+			layout->indexBlocks = reinterpret_cast<const GPFIndexBlock*>(data + indexBlockSection->offset);
+
+			uint64 totalIndexCount = 0;
+			for (uint32 meshIndex = 0; meshIndex < layout->meshCount; meshIndex++)
+			{
+				if (!IsValidIndexBlock(layout->indexBlocks[meshIndex], layout->meshHeaders[meshIndex], encodedIndexSection->byteSize))
+				{
+					return false;
+				}
+				totalIndexCount += layout->meshHeaders[meshIndex].indexCount;
+			}
+			if (totalIndexCount > UINT32_MAX)
+			{
+				return false;
+			}
+			layout->indexCount = uint32(totalIndexCount);
+		}
+
+		// every mesh must reference data inside the streams
+		for (uint32 meshIndex = 0; meshIndex < layout->meshCount; meshIndex++)
+		{
+			const GPFMeshHeader& meshHeader = layout->meshHeaders[meshIndex];
+			if (uint64(meshHeader.vertexOffset) + meshHeader.vertexCount > layout->vertexCount
+				|| uint64(meshHeader.indexOffset) + meshHeader.indexCount > layout->indexCount)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+
+const GPFSectionEntry* GPFLayout::FindSection(GPFSectionType type) const
+{
+	for (uint32 sectionIndex = 0; sectionIndex < sectionCount; sectionIndex++)
+	{
+		if (sections[sectionIndex].type == type)
+		{
+			return &sections[sectionIndex];
+		}
+	}
+	return nullptr;
+}
+
+
+bool xtest::file::ParseGPFLayout(const char* data, uint64 byteSize, GPFLayout* layout)
+{
+	XTEST_ASSERT(layout);
+
+	*layout = GPFLayout();
+	if (!data)
+	{
+		return false;
+	}
+
+	bool parsed = IsV2(data, byteSize) ? ParseV2(data, byteSize, layout) : ParseV1(data, byteSize, layout);
+	if (!parsed)
+	{
+		*layout = GPFLayout();
+	}
+	return parsed;
+}
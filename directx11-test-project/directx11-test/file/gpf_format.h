@@ -0,0 +1,189 @@
+#pragma once
+
+#include <mesh/mesh_format.h>
+#include <mesh/packed_vertex.h>
+
+
+namespace xtest {
+namespace file {
+
+	// gpf v1 file layout:
+	//
+	// 		+---------------------------------------------------------------------------------------------------------------------- - +
+	// 		| mesh  | name | vertex | index  | vertex | index  | Unused | ... |   mesh 1   | mesh 2   | ... | mesh 1  | mesh 2  | ... |
+	// 		| count |      | count  | count  | offset | offset |        |     |   Vertices | Vertices |     | Indices | Indices |     |
+	// 		+---------------------------------------------------------------------------------------------------------------------- - +
+	// 	       4b     24b      4b       4b      4b      4b        24b
+	// 			    ^                                                   ^
+	// 			    |                                                   |
+	// 			    +-------------------------------------------------- +
+	// 			                       gpfMeshHeader
+	// 			                            64b
+	//
+	//
+	// gpf v2 file layout:
+	//
+	// 		+--------------------------------------------------------------------------------------------------+
+	// 		| file   | section | section | ... | pad | section 1 | pad | section 2 | pad | ... | section N | pad |
+	// 		| header | entry 1 | entry 2 |     |     |   data    |     |   data    |     |     |   data    |     |
+	// 		+--------------------------------------------------------------------------------------------------+
+	// 		   64b      32b       32b                ^                 ^
+	// 		                                         |                 |
+	// 		                           every section starts on a 64 bytes boundary
+	//
+	// the section table starts right after the file header (16 bytes aligned), every
+	// section entry describes where its data is, so a reader can skip what it doesn't need;
+	// the sections don't overlap each other, the file header or the section table.
+	// a v2 file always contains the mesh_headers, vertices and indices sections, the
+	// mesh headers have the same format and meaning of the v1 ones. the vertices section
+	// can be replaced by the packed_vertices and vertex_quantizations ones or by the compressed_vertices
+	// one, the indices section by the encoded_indices and index_blocks ones. the bounds section is optional,
+	// when it's missing, like for v1 files, ReadGPF computes the bounds from the vertices and GPFView only
+	// on request, see GPFView::ComputeMissingBounds.
+
+	struct GPFMeshHeader
+	{
+		char name[24] = { 0 };
+		uint32 vertexCount = 0;
+		uint32 indexCount = 0;
+		uint32 vertexOffset = 0;
+		uint32 indexOffset = 0;
+		char unused[24] = { 0 };
+	};
+
+
+	enum class GPFSectionType : uint32
+	{
+		mesh_headers = 1,	// GPFMeshHeader array, one per mesh
+		vertices = 2,		// mesh::MeshData::Vertex array of all the meshes
+		indices = 3,		// uint32 array of all the meshes
+		bounds = 4,			// mesh::MeshBounds array, one per mesh
+		packed_vertices = 5,		// mesh::PackedVertex array of all the meshes, in place of vertices
+		vertex_quantizations = 6,	// mesh::VertexQuantization array, one per mesh, required by packed_vertices
+		encoded_indices = 7,		// byte stream with the indices of every mesh, in place of indices
+		index_blocks = 8,			// GPFIndexBlock array, one per mesh, required by encoded_indices
+		compressed_vertices = 9,	// mesh::EncodeVertices stream of all the meshes, the element stride is the one of the
+									// compressed vertices: mesh::PackedVertex ones need vertex_quantizations as well
+		first_extra = 1024,	// sections from here on are optional extras, unknown ones are skipped by readers
+		meshlet_ranges = 1025,		// GPFMeshletRange array, one per mesh
+		meshlets = 1026,			// mesh::Meshlet array of all the meshes
+		meshlet_vertices = 1027,	// uint32 array, mesh-local vertex indices referenced by the meshlets
+		meshlet_triangles = 1028,	// uint8 array, three meshlet-local vertex indices per triangle
+		meshlet_bounds = 1029,		// mesh::MeshletBounds array, one per meshlet
+		lod_ranges = 1030,			// GPFLodRange array, one per mesh
+		lods = 1031,				// GPFLod array of all the meshes
+		lod_indices = 1032			// uint32 array, mesh-local indices of the lod triangle lists
+	};
+
+
+	// the meshlets of a mesh are the range [meshletOffset, meshletOffset + meshletCount) of the meshlets section
+	struct GPFMeshletRange
+	{
+		uint32 meshletOffset = 0;
+		uint32 meshletCount = 0;
+	};
+
+
+	// the lods of a mesh are the range [lodOffset, lodOffset + lodCount) of the lods section, from the finest
+	// to the coarsest; the mesh indices are the lod 0 and are not part of it
+	struct GPFLodRange
+	{
+		uint32 lodOffset = 0;
+		uint32 lodCount = 0;
+	};
+
+
+	// a simplified triangle list of a mesh, drawn with the vertices of the mesh
+	struct GPFLod
+	{
+		uint32 indexOffset = 0;	// first index in the lod_indices section
+		uint32 indexCount = 0;
+		float error = 0.f;		// deviation from the mesh surface in the mesh space units, see file::BuildGPFLods
+		uint32 unused = 0;
+	};
+
+
+	enum class GPFIndexEncoding : uint32
+	{
+		uint32_list = 0,	// plain uint32 indices
+		uint16_list = 1,	// plain uint16 indices, for meshes with up to 65536 vertices
+		fifo_codec = 2		// compressed with mesh::EncodeIndices
+	};
+
+
+	// where the indices of a mesh are in the encoded_indices section, the decoded indices are mesh-local
+	// and their count is the one in the mesh header; uint16 and uint32 lists are aligned to their size
+	struct GPFIndexBlock
+	{
+		GPFIndexEncoding encoding = GPFIndexEncoding::uint32_list;
+		uint32 unused = 0;
+		uint64 byteOffset = 0;	// from the start of the encoded_indices section
+		uint64 byteSize = 0;
+	};
+
+
+	struct GPFFileHeader
+	{
+		char magic[4] = { 'X', 'G', 'P', 'F' };
+		uint32 version = 2;
+		uint32 meshCount = 0;
+		uint32 sectionCount = 0;
+		uint64 sectionTableOffset = 0;
+		uint64 fileByteSize = 0;
+		char unused[32] = { 0 };
+	};
+
+
+	struct GPFSectionEntry
+	{
+		GPFSectionType type = GPFSectionType::mesh_headers;
+		uint32 flags = 0;
+		uint64 offset = 0;
+		uint64 byteSize = 0;
+		uint32 elementCount = 0;
+		uint32 elementStride = 0;
+	};
+
+
+	XTEST_STATIC_ASSERT(sizeof(GPFMeshHeader) == 64, "the gpf mesh header must be 64 bytes wide");
+	XTEST_STATIC_ASSERT(sizeof(GPFFileHeader) == 64, "the gpf file header must be 64 bytes wide");
+	XTEST_STATIC_ASSERT(sizeof(GPFSectionEntry) == 32, "the gpf section entry must be 32 bytes wide");
+	XTEST_STATIC_ASSERT(sizeof(GPFIndexBlock) == 24, "the gpf index block must be 24 bytes wide");
+	XTEST_STATIC_ASSERT(sizeof(GPFLod) == 16, "the gpf lod must be 16 bytes wide");
+	XTEST_STATIC_ASSERT(sizeof(mesh::MeshBounds) == 40, "the gpf mesh bounds must be 40 bytes wide");
+
+	const uint32 kGPFSectionTableAlignment = 16;
+	const uint32 kGPFSectionAlignment = 64;
+
+
+	// where every piece of a gpf file is, pointers refers to the memory the layout was parsed from
+	struct GPFLayout
+	{
+		uint32 version = 0;
+		uint32 meshCount = 0;
+		const GPFMeshHeader* meshHeaders = nullptr;
+		const mesh::MeshData::Vertex* vertices = nullptr;			// null if the file stores packed or compressed vertices
+		const mesh::PackedVertex* packedVertices = nullptr;			// v2 only, null unless the file stores packed vertices
+		const mesh::VertexQuantization* vertexQuantizations = nullptr;	// one per mesh, along with packed vertices
+		const uint8* compressedVertices = nullptr;						// v2 only, see mesh::DecodeVertices
+		uint64 compressedVertexByteSize = 0;
+		uint32 compressedVertexStride = 0;								// the size of a full or a packed vertex
+		uint32 vertexCount = 0;
+		const mesh::MeshBounds* bounds = nullptr;			// v2 only, one per mesh, null if the file has no bounds section
+		const uint32* indices = nullptr;					// null if the file stores encoded indices
+		const uint8* encodedIndices = nullptr;				// v2 only, null if the file stores plain indices
+		const GPFIndexBlock* indexBlocks = nullptr;			// one per mesh, along with encodedIndices
+		uint32 indexCount = 0;
+		const GPFSectionEntry* sections = nullptr; // v2 only
+		uint32 sectionCount = 0;
+
+		const GPFSectionEntry* FindSection(GPFSectionType type) const;
+	};
+
+
+	// validates a v1 or v2 gpf file already in memory, returns false if the data is malformed
+	bool ParseGPFLayout(const char* data, uint64 byteSize, GPFLayout* layout);
+
+} // file
+} // xtest
+
@@ -0,0 +1,125 @@
+#include "stdafx.h"
+#include "gpf_indices.h"
+#include <file/gpf_writer.h>
+#include <mesh/index_codec.h>
+
+
+using xtest::file::GPFEncodedIndices;
+using xtest::file::GPFIndexBlock;
+using xtest::file::GPFIndexEncoding;
+using xtest::file::GPFMeshHeader;
+using xtest::file::GPFSectionType;
+
+
+namespace
+{
+	// uint16 and uint32 lists must be readable in place
+	void AlignData(std::vector<uint8>* data, size_t alignment)
+	{
+		data->resize((data->size() + alignment - 1) / alignment * alignment, 0);
+	}
+
+
+	template<typename T>
+	void AppendList(const T* list, size_t count, std::vector<uint8>* data)
+	{
+		const uint8* bytes = reinterpret_cast<const uint8*>(list);
+		data->insert(data->end(), bytes, bytes + count * sizeof(T));
+	}
+}
+
+
+GPFEncodedIndices xtest::file::EncodeGPFIndices(const std::vector<GPFMeshHeader>& meshHeaders, const std::vector<uint32>& indices, bool compress)
+{
+	GPFEncodedIndices encodedIndices;
+	encodedIndices.blocks.reserve(meshHeaders.size());
+
+	std::vector<uint16> narrowIndices;
+	for (const GPFMeshHeader& meshHeader : meshHeaders)
+	{
+		const uint32* meshIndices = indices.data() + meshHeader.indexOffset;
+
+		GPFIndexBlock block;
+		if (compress)
+		{
+			block.encoding = GPFIndexEncoding::fifo_codec;
+			block.byteOffset = encodedIndices.data.size();
+
+			const std::vector<uint8> meshData = mesh::EncodeIndices(meshIndices, meshHeader.indexCount);
+			AppendList(meshData.data(), meshData.size(), &encodedIndices.data);
+		}
+		else if (meshHeader.vertexCount <= mesh::kMaxNarrowIndexVertexCount)
+		{
+			block.encoding = GPFIndexEncoding::uint16_list;
+			AlignData(&encodedIndices.data, sizeof(uint16));
+			block.byteOffset = encodedIndices.data.size();
+
+			narrowIndices.resize(meshHeader.indexCount);
+			mesh::NarrowIndices(meshIndices, meshHeader.indexCount, narrowIndices.data());
+			AppendList(narrowIndices.data(), narrowIndices.size(), &encodedIndices.data);
+		}
+		else
+		{
+			block.encoding = GPFIndexEncoding::uint32_list;
+			AlignData(&encodedIndices.data, sizeof(uint32));
+			block.byteOffset = encodedIndices.data.size();
+
+			AppendList(meshIndices, meshHeader.indexCount, &encodedIndices.data);
+		}
+
+		block.byteSize = encodedIndices.data.size() - block.byteOffset;
+		encodedIndices.blocks.push_back(block);
+	}
+
+	return encodedIndices;
+}
+
+
+void xtest::file::SetEncodedIndexSections(const GPFEncodedIndices& encodedIndices, GPFWriter* writer)
+{
+	XTEST_ASSERT(writer);
+
+	writer->RemoveSection(GPFSectionType::indices);
+	writer->AddSection(GPFSectionType::encoded_indices, encodedIndices.data.data(), encodedIndices.data.size(), uint32(encodedIndices.data.size()), sizeof(uint8));
+	writer->AddSection(GPFSectionType::index_blocks, encodedIndices.blocks.data(), sizeof(GPFIndexBlock) * encodedIndices.blocks.size(), uint32(encodedIndices.blocks.size()), sizeof(GPFIndexBlock));
+}
+
+
+bool xtest::file::DecodeGPFIndices(const uint8* encodedIndices, const GPFIndexBlock& indexBlock, uint32 indexCount, uint32 vertexCount, uint32* indices)
+{
+	const uint8* blockData = encodedIndices + indexBlock.byteOffset;
+	switch (indexBlock.encoding)
+	{
+	case GPFIndexEncoding::uint32_list:
+		if (indexBlock.byteSize != sizeof(uint32) * uint64(indexCount))
+		{
+			return false;
+		}
+		std::memcpy(indices, blockData, sizeof(uint32) * indexCount);
+		break;
+	case GPFIndexEncoding::uint16_list:
+		if (indexBlock.byteSize != sizeof(uint16) * uint64(indexCount))
+		{
+			return false;
+		}
+		mesh::WidenIndices(reinterpret_cast<const uint16*>(blockData), indexCount, indices);
+		break;
+	case GPFIndexEncoding::fifo_codec:
+		if (!mesh::DecodeIndices(blockData, size_t(indexBlock.byteSize), indices, indexCount))
+		{
+			return false;
+		}
+		break;
+	default:
+		return false;
+	}
+
+	// a well formed block can still point past the vertices, the codec can even decode an empty fifo slot
+	return AreGPFIndicesInRange(indices, indexCount, vertexCount);
+}
+
+
+bool xtest::file::AreGPFIndicesInRange(const uint32* indices, uint32 indexCount, uint32 vertexCount)
+{
+	return std::all_of(indices, indices + indexCount, [vertexCount](uint32 index) { return index < vertexCount; });
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <file/gpf_format.h>
+
+
+namespace xtest {
+namespace file {
+
+	class GPFWriter;
+
+
+	// the content of the encoded_indices and index_blocks sections
+	struct GPFEncodedIndices
+	{
+		std::vector<uint8> data;
+		std::vector<GPFIndexBlock> blocks;	// one per mesh header
+	};
+
+
+	// every mesh is compressed with mesh::EncodeIndices if compress is true, otherwise its indices
+	// are narrowed to 16 bits when its vertex count allows it and stored as they are if it doesn't
+	GPFEncodedIndices EncodeGPFIndices(const std::vector<GPFMeshHeader>& meshHeaders, const std::vector<uint32>& indices, bool compress);
+
+	// the encoded indices are referenced, not copied: they must stay alive until the writer is done
+	void SetEncodedIndexSections(const GPFEncodedIndices& encodedIndices, GPFWriter* writer);
+
+	// decodes the mesh-local indices of a single mesh, returns false if the block is malformed or if an index
+	// is not less than the vertex count of the mesh
+	bool DecodeGPFIndices(const uint8* encodedIndices, const GPFIndexBlock& indexBlock, uint32 indexCount, uint32 vertexCount, uint32* indices);
+
+	// true if every mesh-local index is less than the vertex count of the mesh
+	bool AreGPFIndicesInRange(const uint32* indices, uint32 indexCount, uint32 vertexCount);
+
+} // file
+} // xtest
+
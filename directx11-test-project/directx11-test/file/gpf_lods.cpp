@@ -0,0 +1,161 @@
+#include "stdafx.h"
+#include "gpf_lods.h"
+#include <file/gpf_writer.h>
+#include <file/gpf_view.h>
+#include <common/parallel_for.h>
+#include <mesh/mesh_simplifier.h>
+#include <mesh/mesh_optimizer.h>
+#include <mesh/mesh_bounds.h>
+
+
+using namespace DirectX;
+using xtest::file::GPFLods;
+using xtest::file::GPFLod;
+using xtest::file::GPFLodRange;
+using xtest::file::GPFMeshHeader;
+using xtest::file::GPFSectionType;
+using xtest::file::GPFView;
+using xtest::mesh::MeshData;
+using xtest::mesh::SimplifyResult;
+
+
+namespace
+{
+	// a lod that doesn't remove at least this fraction of the triangles of the previous one isn't worth its memory
+	const float kMinLodTriangleReduction = 0.1f;
+
+
+	// the lods of a single mesh, index offsets are relative to its own indices
+	struct MeshLods
+	{
+		std::vector<GPFLod> lods;
+		std::vector<uint32> indices;
+	};
+
+
+	float LargestBoundsSide(const MeshData::Vertex* vertices, uint32 vertexCount)
+	{
+		const xtest::mesh::MeshBounds bounds = xtest::mesh::ComputeBounds(vertices, vertexCount);
+		return std::max(bounds.boxMax.x - bounds.boxMin.x, std::max(bounds.boxMax.y - bounds.boxMin.y, bounds.boxMax.z - bounds.boxMin.z));
+	}
+
+
+	MeshLods BuildMeshLods(const MeshData::Vertex* vertices, uint32 vertexCount, const uint32* indices, uint32 indexCount, uint32 lodCount, float reduction, float maxError)
+	{
+		MeshLods meshLods;
+		if (vertexCount == 0)
+		{
+			return meshLods;
+		}
+
+		const float maxSimplifyError = maxError * LargestBoundsSide(vertices, vertexCount);
+		std::vector<uint32> previousIndices(indices, indices + indexCount);
+		float error = 0.f;
+		for (uint32 lodIndex = 0; lodIndex < lodCount; lodIndex++)
+		{
+			const size_t targetIndexCount = size_t(float(previousIndices.size() / 3) * reduction) * 3;
+			SimplifyResult result = xtest::mesh::Simplify(vertices, vertexCount, previousIndices.data(), previousIndices.size(), targetIndexCount, maxSimplifyError);
+			if (result.indices.empty() || float(result.indices.size()) > float(previousIndices.size()) * (1.f - kMinLodTriangleReduction))
+			{
+				break;
+			}
+
+			xtest::mesh::OptimizeVertexCache(result.indices.data(), result.indices.size(), vertexCount);
+			error += result.error;
+
+			GPFLod lod;
+			lod.indexOffset = uint32(meshLods.indices.size());
+			lod.indexCount = uint32(result.indices.size());
+			lod.error = error;
+			meshLods.lods.push_back(lod);
+			meshLods.indices.insert(meshLods.indices.end(), result.indices.begin(), result.indices.end());
+			previousIndices = std::move(result.indices);
+		}
+		return meshLods;
+	}
+}
+
+
+GPFLods xtest::file::BuildGPFLods(const std::vector<GPFMeshHeader>& meshHeaders, const MeshData& meshData, uint32 lodCount, float reduction, float maxError, uint32 threadCount)
+{
+	XTEST_ASSERT(reduction > 0.f && reduction < 1.f, L"the lod reduction must be in (0, 1)");
+
+	// every mesh is simplified on its own worker, the results are then stitched in mesh order
+	std::vector<MeshLods> meshLods(meshHeaders.size());
+	common::ParallelFor(uint32(meshHeaders.size()), threadCount, [&](uint32 meshIndex)
+	{
+		const GPFMeshHeader& meshHeader = meshHeaders[meshIndex];
+		meshLods[meshIndex] = BuildMeshLods(&meshData.vertices[meshHeader.vertexOffset], meshHeader.vertexCount, &meshData.indices[meshHeader.indexOffset],
+			meshHeader.indexCount, lodCount, reduction, maxError);
+	});
+
+	GPFLods lods;
+	lods.ranges.reserve(meshHeaders.size());
+	for (MeshLods& mesh : meshLods)
+	{
+		GPFLodRange range;
+		range.lodOffset = uint32(lods.lods.size());
+		range.lodCount = uint32(mesh.lods.size());
+		lods.ranges.push_back(range);
+
+		for (GPFLod lod : mesh.lods)
+		{
+			lod.indexOffset += uint32(lods.indices.size());
+			lods.lods.push_back(lod);
+		}
+		lods.indices.insert(lods.indices.end(), mesh.indices.begin(), mesh.indices.end());
+
+		// release the mesh memory as soon as possible
+		mesh = MeshLods();
+	}
+
+	return lods;
+}
+
+
+void xtest::file::AddLodSections(const GPFLods& lods, GPFWriter* writer)
+{
+	XTEST_ASSERT(writer);
+
+	writer->AddSection(GPFSectionType::lod_ranges, lods.ranges);
+	writer->AddSection(GPFSectionType::lods, lods.lods);
+	writer->AddSection(GPFSectionType::lod_indices, lods.indices);
+}
+
+
+bool xtest::file::ReadLodSections(const GPFView& view, GPFLods* lods)
+{
+	XTEST_ASSERT(lods);
+
+	*lods = GPFLods();
+	const bool read = view.CopySection(GPFSectionType::lod_ranges, &lods->ranges)
+		&& view.CopySection(GPFSectionType::lods, &lods->lods)
+		&& view.CopySection(GPFSectionType::lod_indices, &lods->indices);
+
+	bool valid = read && lods->ranges.size() == view.MeshCount();
+
+	// every lod must be a triangle list inside the indices referencing vertices inside its mesh
+	for (uint32 meshIndex = 0; valid && meshIndex < view.MeshCount(); meshIndex++)
+	{
+		const GPFLodRange& range = lods->ranges[meshIndex];
+		const uint32 meshVertexCount = view.MeshHeaders()[meshIndex].vertexCount;
+		valid = uint64(range.lodOffset) + range.lodCount <= lods->lods.size();
+
+		for (uint32 lodIndex = range.lodOffset; valid && lodIndex < range.lodOffset + range.lodCount; lodIndex++)
+		{
+			const GPFLod& lod = lods->lods[lodIndex];
+			valid = lod.indexCount % 3 == 0 && uint64(lod.indexOffset) + lod.indexCount <= lods->indices.size();
+
+			for (uint32 index = lod.indexOffset; valid && index < lod.indexOffset + lod.indexCount; index++)
+			{
+				valid = lods->indices[index] < meshVertexCount;
+			}
+		}
+	}
+
+	if (!valid)
+	{
+		*lods = GPFLods();
+	}
+	return valid;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <file/gpf_format.h>
+
+
+namespace xtest {
+namespace file {
+
+	class GPFWriter;
+	class GPFView;
+
+
+	// the lods of all the meshes of a gpf file, the lod indices are mesh-local just like the gpf
+	// indices, ranges has one entry per mesh header
+	struct GPFLods
+	{
+		std::vector<GPFLodRange> ranges;
+		std::vector<GPFLod> lods;
+		std::vector<uint32> indices;
+	};
+
+
+	/**
+	Builds a chain of up to lodCount lods for every mesh with mesh::Simplify, every lod aiming at reduction times
+	the triangles of the previous one and simplified from it; every lod is then optimized with mesh::OptimizeVertexCache.
+	The chain of a mesh stops early when the next lod would be too close to the previous one, because maxError is hit.
+	The error of a lod is the sum of the errors of the simplifications that lead to it, a conservative estimate
+	of how far it is from the original mesh.
+	@param maxError		The largest error of a single simplification, relative to the largest side of the mesh bounds.
+	@param threadCount	The maximum number of threads simplifying the meshes, 0 means one per hardware thread.
+	*/
+	GPFLods BuildGPFLods(const std::vector<GPFMeshHeader>& meshHeaders, const mesh::MeshData& meshData, uint32 lodCount, float reduction, float maxError, uint32 threadCount);
+
+	// the lods are referenced, not copied: they must stay alive until the writer is done
+	void AddLodSections(const GPFLods& lods, GPFWriter* writer);
+
+	// returns false if the file has no lods or they are malformed
+	bool ReadLodSections(const GPFView& view, GPFLods* lods);
+
+} // file
+} // xtest
+
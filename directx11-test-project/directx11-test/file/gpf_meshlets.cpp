@@ -0,0 +1,93 @@
+#include "stdafx.h"
+#include "gpf_meshlets.h"
+#include <file/gpf_writer.h>
+#include <file/gpf_view.h>
+
+
+using xtest::file::GPFMeshlets;
+using xtest::file::GPFMeshletRange;
+using xtest::file::GPFMeshHeader;
+using xtest::file::GPFSectionType;
+using xtest::file::GPFView;
+using xtest::mesh::MeshData;
+using xtest::mesh::Meshlet;
+using xtest::mesh::MeshletBounds;
+
+
+GPFMeshlets xtest::file::BuildGPFMeshlets(const std::vector<GPFMeshHeader>& meshHeaders, const MeshData& meshData, uint32 maxVertexCount, uint32 maxTriangleCount)
+{
+	GPFMeshlets meshlets;
+	meshlets.ranges.reserve(meshHeaders.size());
+
+	for (const GPFMeshHeader& meshHeader : meshHeaders)
+	{
+		GPFMeshletRange range;
+		range.meshletOffset = uint32(meshlets.meshletData.meshlets.size());
+		mesh::BuildMeshlets(&meshData.vertices[meshHeader.vertexOffset], meshHeader.vertexCount, &meshData.indices[meshHeader.indexOffset],
+			meshHeader.indexCount, maxVertexCount, maxTriangleCount, &meshlets.meshletData);
+		range.meshletCount = uint32(meshlets.meshletData.meshlets.size()) - range.meshletOffset;
+		meshlets.ranges.push_back(range);
+	}
+
+	return meshlets;
+}
+
+
+void xtest::file::AddMeshletSections(const GPFMeshlets& meshlets, GPFWriter* writer)
+{
+	XTEST_ASSERT(writer);
+
+	writer->AddSection(GPFSectionType::meshlet_ranges, meshlets.ranges);
+	writer->AddSection(GPFSectionType::meshlets, meshlets.meshletData.meshlets);
+	writer->AddSection(GPFSectionType::meshlet_vertices, meshlets.meshletData.vertices);
+	writer->AddSection(GPFSectionType::meshlet_triangles, meshlets.meshletData.triangles);
+	writer->AddSection(GPFSectionType::meshlet_bounds, meshlets.meshletData.bounds);
+}
+
+
+bool xtest::file::ReadMeshletSections(const GPFView& view, GPFMeshlets* meshlets)
+{
+	XTEST_ASSERT(meshlets);
+
+	*meshlets = GPFMeshlets();
+	const bool read = view.CopySection(GPFSectionType::meshlet_ranges, &meshlets->ranges)
+		&& view.CopySection(GPFSectionType::meshlets, &meshlets->meshletData.meshlets)
+		&& view.CopySection(GPFSectionType::meshlet_vertices, &meshlets->meshletData.vertices)
+		&& view.CopySection(GPFSectionType::meshlet_triangles, &meshlets->meshletData.triangles)
+		&& view.CopySection(GPFSectionType::meshlet_bounds, &meshlets->meshletData.bounds);
+
+	bool valid = read
+		&& meshlets->ranges.size() == view.MeshCount()
+		&& meshlets->meshletData.bounds.size() == meshlets->meshletData.meshlets.size();
+
+	// every meshlet must reference data inside the streams and vertices inside its mesh
+	for (uint32 meshIndex = 0; valid && meshIndex < view.MeshCount(); meshIndex++)
+	{
+		const GPFMeshletRange& range = meshlets->ranges[meshIndex];
+		const uint32 meshVertexCount = view.MeshHeaders()[meshIndex].vertexCount;
+		valid = uint64(range.meshletOffset) + range.meshletCount <= meshlets->meshletData.meshlets.size();
+
+		for (uint32 meshletIndex = range.meshletOffset; valid && meshletIndex < range.meshletOffset + range.meshletCount; meshletIndex++)
+		{
+			const Meshlet& meshlet = meshlets->meshletData.meshlets[meshletIndex];
+			valid = meshlet.vertexCount <= mesh::kMaxMeshletVertexCount
+				&& uint64(meshlet.vertexOffset) + meshlet.vertexCount <= meshlets->meshletData.vertices.size()
+				&& (uint64(meshlet.triangleOffset) + meshlet.triangleCount) * 3 <= meshlets->meshletData.triangles.size();
+
+			for (uint32 vertexIndex = 0; valid && vertexIndex < meshlet.vertexCount; vertexIndex++)
+			{
+				valid = meshlets->meshletData.vertices[meshlet.vertexOffset + vertexIndex] < meshVertexCount;
+			}
+			for (uint32 corner = 0; valid && corner < meshlet.triangleCount * 3; corner++)
+			{
+				valid = meshlets->meshletData.triangles[meshlet.triangleOffset * 3 + corner] < meshlet.vertexCount;
+			}
+		}
+	}
+
+	if (!valid)
+	{
+		*meshlets = GPFMeshlets();
+	}
+	return valid;
+}
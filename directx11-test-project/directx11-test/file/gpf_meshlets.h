@@ -0,0 +1,34 @@
+#pragma once
+
+#include <file/gpf_format.h>
+#include <mesh/meshlet.h>
+
+
+namespace xtest {
+namespace file {
+
+	class GPFWriter;
+	class GPFView;
+
+
+	// the meshlets of all the meshes of a gpf file, the meshlet vertices are mesh-local
+	// indices just like the gpf indices, ranges has one entry per mesh header
+	struct GPFMeshlets
+	{
+		std::vector<GPFMeshletRange> ranges;
+		mesh::MeshletData meshletData;
+	};
+
+
+	// builds the meshlets of every mesh, the data is laid out in mesh order
+	GPFMeshlets BuildGPFMeshlets(const std::vector<GPFMeshHeader>& meshHeaders, const mesh::MeshData& meshData, uint32 maxVertexCount, uint32 maxTriangleCount);
+
+	// the meshlets are referenced, not copied: they must stay alive until the writer is done
+	void AddMeshletSections(const GPFMeshlets& meshlets, GPFWriter* writer);
+
+	// returns false if the file has no meshlets or they are malformed
+	bool ReadMeshletSections(const GPFView& view, GPFMeshlets* meshlets);
+
+} // file
+} // xtest
+
@@ -0,0 +1,236 @@
+#include "stdafx.h"
+#include "gpf_view.h"
+#include <mesh/mesh_bounds.h>
+
+using xtest::file::GPFView;
+using xtest::file::GPFMeshHeader;
+using xtest::file::GPFSectionEntry;
+using xtest::file::GPFSectionType;
+using xtest::file::GPFLayout;
+using xtest::file::GPFIndexBlock;
+using xtest::mesh::GPFMesh;
+using xtest::mesh::MeshData;
+using xtest::mesh::PackedVertex;
+using xtest::mesh::VertexQuantization;
+
+
+GPFView::GPFView()
+	: m_file()
+	, m_layout()
+	, m_computedBounds()
+{}
+
+
+GPFView::GPFView(GPFView&& other)
+	: m_file(std::move(other.m_file))
+	, m_layout(other.m_layout)
+	, m_computedBounds(std::move(other.m_computedBounds))
+{
+	other.m_layout = GPFLayout();
+}
+
+
+GPFView& GPFView::operator=(GPFView&& other)
+{
+	std::swap(m_file, other.m_file);
+	std::swap(m_layout, other.m_layout);
+	std::swap(m_computedBounds, other.m_computedBounds);
+	return *this;
+}
+
+
+GPFView::~GPFView()
+{}
+
+
+uint32 GPFView::MeshCount() const
+{
+	return m_layout.meshCount;
+}
+
+
+const GPFMeshHeader* GPFView::MeshHeaders() const
+{
+	return m_layout.meshHeaders;
+}
+
+
+std::string GPFView::MeshNameAt(uint32 meshIndex) const
+{
+	XTEST_ASSERT(meshIndex < m_layout.meshCount);
+
+	// the name field is null terminated only if shorter than the field itself
+	const char* name = m_layout.meshHeaders[meshIndex].name;
+	return std::string(name, std::find(name, name + sizeof(GPFMeshHeader::name), '\0'));
+}
+
+
+GPFMesh::MeshDescriptor GPFView::MeshDescriptorAt(uint32 meshIndex) const
+{
+	XTEST_ASSERT(meshIndex < m_layout.meshCount);
+
+	const GPFMeshHeader& meshHeader = m_layout.meshHeaders[meshIndex];
+
+	GPFMesh::MeshDescriptor meshDesc;
+	meshDesc.vertexCount = meshHeader.vertexCount;
+	meshDesc.vertexOffset = meshHeader.vertexOffset;
+	meshDesc.indexCount = meshHeader.indexCount;
+	meshDesc.indexOffset = meshHeader.indexOffset;
+
+	// files without the bounds section get them from ComputeMissingBounds, if it was called
+	if (m_layout.bounds)
+	{
+		meshDesc.bounds = m_layout.bounds[meshIndex];
+	}
+	else if (!m_computedBounds.empty())
+	{
+		meshDesc.bounds = m_computedBounds[meshIndex];
+	}
+	return meshDesc;
+}
+
+
+std::map<std::string, GPFMesh::MeshDescriptor> GPFView::MeshDescriptorMapByName() const
+{
+	std::map<std::string, GPFMesh::MeshDescriptor> meshDescriptorMapByName;
+	for (uint32 meshIndex = 0; meshIndex < m_layout.meshCount; meshIndex++)
+	{
+		meshDescriptorMapByName[MeshNameAt(meshIndex)] = MeshDescriptorAt(meshIndex);
+	}
+	return meshDescriptorMapByName;
+}
+
+
+void GPFView::ComputeMissingBounds()
+{
+	// only the plain vertices can be read in place, and only once
+	if (m_layout.bounds || !m_layout.vertices || !m_computedBounds.empty())
+	{
+		return;
+	}
+
+	m_computedBounds.resize(m_layout.meshCount);
+	for (uint32 meshIndex = 0; meshIndex < m_layout.meshCount; meshIndex++)
+	{
+		const GPFMeshHeader& meshHeader = m_layout.meshHeaders[meshIndex];
+		m_computedBounds[meshIndex] = mesh::ComputeBounds(m_layout.vertices + meshHeader.vertexOffset, meshHeader.vertexCount);
+	}
+}
+
+
+const MeshData::Vertex* GPFView::Vertices() const
+{
+	return m_layout.vertices;
+}
+
+
+const PackedVertex* GPFView::PackedVertices() const
+{
+	return m_layout.packedVertices;
+}
+
+
+const VertexQuantization* GPFView::VertexQuantizations() const
+{
+	return m_layout.vertexQuantizations;
+}
+
+
+const uint8* GPFView::CompressedVertices() const
+{
+	return m_layout.compressedVertices;
+}
+
+
+uint32 GPFView::CompressedVertexStride() const
+{
+	return m_layout.compressedVertexStride;
+}
+
+
+uint32 GPFView::VertexCount() const
+{
+	return m_layout.vertexCount;
+}
+
+
+uint64 GPFView::VertexByteSize() const
+{
+	if (m_layout.compressedVertices)
+	{
+		return m_layout.compressedVertexByteSize;
+	}
+	return uint64(m_layout.vertexCount) * (m_layout.packedVertices ? sizeof(PackedVertex) : sizeof(MeshData::Vertex));
+}
+
+
+const uint32* GPFView::Indices() const
+{
+	return m_layout.indices;
+}
+
+
+const uint8* GPFView::EncodedIndices() const
+{
+	return m_layout.encodedIndices;
+}
+
+
+const GPFIndexBlock* GPFView::IndexBlocks() const
+{
+	return m_layout.indexBlocks;
+}
+
+
+uint32 GPFView::IndexCount() const
+{
+	return m_layout.indexCount;
+}
+
+
+uint64 GPFView::IndexByteSize() const
+{
+	if (m_layout.encodedIndices)
+	{
+		const GPFSectionEntry* section = m_layout.FindSection(GPFSectionType::encoded_indices);
+		return section ? section->byteSize : 0;
+	}
+	return uint64(m_layout.indexCount) * sizeof(uint32);
+}
+
+
+uint32 GPFView::Version() const
+{
+	return m_layout.version;
+}
+
+
+uint32 GPFView::SectionCount() const
+{
+	return m_layout.sectionCount;
+}
+
+
+const GPFSectionEntry* GPFView::Sections() const
+{
+	return m_layout.sections;
+}
+
+
+const GPFSectionEntry* GPFView::FindSection(GPFSectionType type) const
+{
+	return m_layout.FindSection(type);
+}
+
+
+const char* GPFView::SectionData(const GPFSectionEntry& section) const
+{
+	XTEST_ASSERT(section.offset + section.byteSize <= m_file.ByteSize());
+	return m_file.Data() + section.offset;
+}
+
+
+bool GPFView::IsValid() const
+{
+	return m_file.IsMapped() && m_layout.meshHeaders != nullptr;
+}
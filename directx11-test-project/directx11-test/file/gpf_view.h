@@ -0,0 +1,100 @@
+#pragma once
+
+#include <file/mapped_file.h>
+#include <file/gpf_format.h>
+#include <mesh/mesh_format.h>
+
+
+namespace xtest {
+namespace file {
+
+	// zero-copy view of a gpf file, every pointer returned points directly
+	// inside the file mapping and stays valid as long as the view is alive
+	class GPFView
+	{
+		// the only way to create a non-empty GPFView
+		friend GPFView MapGPF(const std::wstring& filePath);
+
+	public:
+
+		GPFView();
+		GPFView(GPFView&& other);
+		GPFView& operator=(GPFView&& other);
+
+		virtual ~GPFView();
+
+
+		GPFView(const GPFView&) = delete;
+		GPFView& operator=(const GPFView&) = delete;
+
+
+		uint32 MeshCount() const;
+		const GPFMeshHeader* MeshHeaders() const;
+		std::string MeshNameAt(uint32 meshIndex) const;
+
+		// the bounds come from the bounds section or, without it, from ComputeMissingBounds; they are zero
+		// until it's called, and always for packed and compressed vertices without the section, so a culling
+		// based on them drops the mesh
+		mesh::GPFMesh::MeshDescriptor MeshDescriptorAt(uint32 meshIndex) const;
+		std::map<std::string, mesh::GPFMesh::MeshDescriptor> MeshDescriptorMapByName() const;
+
+		// computes once the bounds of the files without the bounds section (like v1 ones) from the plain vertices,
+		// it reads every vertex of the file, so it pages in the whole vertices section
+		void ComputeMissingBounds();
+
+		// only one of Vertices, PackedVertices and CompressedVertices is not null, VertexByteSize is the size of that one
+		const mesh::MeshData::Vertex* Vertices() const;
+		const mesh::PackedVertex* PackedVertices() const;
+		const mesh::VertexQuantization* VertexQuantizations() const;
+		const uint8* CompressedVertices() const;
+		uint32 CompressedVertexStride() const;
+		uint32 VertexCount() const;
+		uint64 VertexByteSize() const;
+
+		// Indices is null if the file stores encoded indices, see file::DecodeGPFIndices; IndexByteSize is the size
+		// of the indices section or, without it, of the encoded_indices one
+		const uint32* Indices() const;
+		const uint8* EncodedIndices() const;
+		const GPFIndexBlock* IndexBlocks() const;
+		uint32 IndexCount() const;
+		uint64 IndexByteSize() const;
+
+		// v1 files have no section table
+		uint32 Version() const;
+		uint32 SectionCount() const;
+		const GPFSectionEntry* Sections() const;
+		const GPFSectionEntry* FindSection(GPFSectionType type) const;
+		const char* SectionData(const GPFSectionEntry& section) const;
+
+		// copies a whole section, false if it's missing or its elements are not T
+		template<typename T>
+		bool CopySection(GPFSectionType type, std::vector<T>* elements) const;
+
+		bool IsValid() const;
+
+	private:
+
+		MappedFile m_file;
+		GPFLayout m_layout;
+		std::vector<mesh::MeshBounds> m_computedBounds;
+
+	};
+
+
+	template<typename T>
+	bool GPFView::CopySection(GPFSectionType type, std::vector<T>* elements) const
+	{
+		const GPFSectionEntry* section = FindSection(type);
+		if (!section || section->elementStride != sizeof(T) || uint64(section->elementCount) * sizeof(T) > section->byteSize)
+		{
+			return false;
+		}
+
+		const T* data = reinterpret_cast<const T*>(SectionData(*section));
+		elements->assign(data, data + section->elementCount);
+		return true;
+	}
+
+} // file
+} // xtest
+
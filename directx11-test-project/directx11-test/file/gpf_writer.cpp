@@ -0,0 +1,125 @@
+#include "stdafx.h"
+#include "gpf_writer.h"
+#include <fstream>
+
+using xtest::file::GPFWriter;
+using xtest::file::GPFSectionType;
+using xtest::file::GPFSectionEntry;
+using xtest::file::GPFFileHeader;
+using xtest::file::GPFMeshHeader;
+
+
+namespace
+{
+	uint64 AlignUp(uint64 value, uint64 alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+
+	void WritePadding(std::ofstream& fileStream, uint64 byteCount)
+	{
+		const char zeros[xtest::file::kGPFSectionAlignment] = { 0 };
+		while (byteCount > 0)
+		{
+			const uint64 chunk = std::min<uint64>(byteCount, sizeof(zeros));
+			fileStream.write(zeros, chunk);
+			byteCount -= chunk;
+		}
+	}
+}
+
+
+GPFWriter::GPFWriter(const std::vector<GPFMeshHeader>& meshHeaders, const mesh::MeshData& meshData)
+	: m_meshCount(uint32(meshHeaders.size()))
+	, m_sections()
+{
+	AddSection(GPFSectionType::mesh_headers, meshHeaders.data(), sizeof(GPFMeshHeader) * meshHeaders.size(), uint32(meshHeaders.size()), sizeof(GPFMeshHeader));
+	AddSection(GPFSectionType::vertices, meshData.vertices.data(), sizeof(mesh::MeshData::Vertex) * meshData.vertices.size(), uint32(meshData.vertices.size()), sizeof(mesh::MeshData::Vertex));
+	AddSection(GPFSectionType::indices, meshData.indices.data(), sizeof(uint32) * meshData.indices.size(), uint32(meshData.indices.size()), sizeof(uint32));
+}
+
+
+GPFWriter::GPFWriter(const std::vector<GPFMeshHeader>& meshHeaders, const std::vector<mesh::PackedVertex>& packedVertices,
+	const std::vector<mesh::VertexQuantization>& vertexQuantizations, const std::vector<uint32>& indices)
+	: m_meshCount(uint32(meshHeaders.size()))
+	, m_sections()
+{
+	XTEST_ASSERT(vertexQuantizations.size() == meshHeaders.size(), L"one vertex quantization per mesh expected, got %zu for %zu meshes", vertexQuantizations.size(), meshHeaders.size());
+
+	AddSection(GPFSectionType::mesh_headers, meshHeaders.data(), sizeof(GPFMeshHeader) * meshHeaders.size(), uint32(meshHeaders.size()), sizeof(GPFMeshHeader));
+	AddSection(GPFSectionType::packed_vertices, packedVertices.data(), sizeof(mesh::PackedVertex) * packedVertices.size(), uint32(packedVertices.size()), sizeof(mesh::PackedVertex));
+	AddSection(GPFSectionType::vertex_quantizations, vertexQuantizations.data(), sizeof(mesh::VertexQuantization) * vertexQuantizations.size(), uint32(vertexQuantizations.size()), sizeof(mesh::VertexQuantization));
+	AddSection(GPFSectionType::indices, indices.data(), sizeof(uint32) * indices.size(), uint32(indices.size()), sizeof(uint32));
+}
+
+
+void GPFWriter::AddSection(GPFSectionType type, const void* data, uint64 byteSize, uint32 elementCount, uint32 elementStride, uint32 flags)
+{
+	XTEST_ASSERT(data || byteSize == 0);
+
+	PendingSection section;
+	section.entry.type = type;
+	section.entry.flags = flags;
+	section.entry.byteSize = byteSize;
+	section.entry.elementCount = elementCount;
+	section.entry.elementStride = elementStride;
+	section.data = data;
+	m_sections.push_back(section);
+}
+
+
+void GPFWriter::RemoveSection(GPFSectionType type)
+{
+	m_sections.erase(std::remove_if(m_sections.begin(), m_sections.end(), [type](const PendingSection& section)
+	{
+		return section.entry.type == type;
+	}), m_sections.end());
+}
+
+
+bool GPFWriter::WriteOnDisk(const std::wstring& filePath) const
+{
+	// compute the final position of every piece
+	GPFFileHeader fileHeader;
+	fileHeader.meshCount = m_meshCount;
+	fileHeader.sectionCount = uint32(m_sections.size());
+	fileHeader.sectionTableOffset = AlignUp(sizeof(GPFFileHeader), kGPFSectionTableAlignment);
+
+	std::vector<GPFSectionEntry> sectionTable;
+	sectionTable.reserve(m_sections.size());
+
+	uint64 offset = fileHeader.sectionTableOffset + sizeof(GPFSectionEntry) * m_sections.size();
+	for (const PendingSection& section : m_sections)
+	{
+		GPFSectionEntry entry = section.entry;
+		entry.offset = AlignUp(offset, kGPFSectionAlignment);
+		offset = entry.offset + entry.byteSize;
+		sectionTable.push_back(entry);
+	}
+	fileHeader.fileByteSize = AlignUp(offset, kGPFSectionAlignment);
+
+
+	std::ofstream fileStream(filePath.c_str(), std::ofstream::binary);
+	XTEST_ASSERT(fileStream.is_open(), L"unable to open the file:'%s'", filePath.c_str());
+	if (!fileStream.is_open())
+	{
+		return false;
+	}
+
+	fileStream.write(reinterpret_cast<const char*>(&fileHeader), sizeof(GPFFileHeader));
+	WritePadding(fileStream, fileHeader.sectionTableOffset - sizeof(GPFFileHeader));
+	fileStream.write(reinterpret_cast<const char*>(sectionTable.data()), sizeof(GPFSectionEntry) * sectionTable.size());
+
+	uint64 writtenByteSize = fileHeader.sectionTableOffset + sizeof(GPFSectionEntry) * sectionTable.size();
+	for (size_t sectionIndex = 0; sectionIndex < m_sections.size(); sectionIndex++)
+	{
+		const GPFSectionEntry& entry = sectionTable[sectionIndex];
+		WritePadding(fileStream, entry.offset - writtenByteSize);
+		fileStream.write(reinterpret_cast<const char*>(m_sections[sectionIndex].data), entry.byteSize);
+		writtenByteSize = entry.offset + entry.byteSize;
+	}
+	WritePadding(fileStream, fileHeader.fileByteSize - writtenByteSize);
+
+	return fileStream.good();
+}
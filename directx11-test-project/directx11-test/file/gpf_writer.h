@@ -0,0 +1,63 @@
+#pragma once
+
+#include <file/gpf_format.h>
+#include <mesh/mesh_format.h>
+#include <mesh/packed_vertex.h>
+
+
+namespace xtest {
+namespace file {
+
+	// writes gpf v2 files, the mesh headers, vertices and indices sections are always
+	// present, any other section can be appended with AddSection
+	class GPFWriter
+	{
+	public:
+
+		// the data is referenced, not copied: it must stay alive until WriteOnDisk returns
+		GPFWriter(const std::vector<GPFMeshHeader>& meshHeaders, const mesh::MeshData& meshData);
+
+		// stores the vertices packed, vertexQuantizations has one entry per mesh header
+		GPFWriter(const std::vector<GPFMeshHeader>& meshHeaders, const std::vector<mesh::PackedVertex>& packedVertices,
+			const std::vector<mesh::VertexQuantization>& vertexQuantizations, const std::vector<uint32>& indices);
+
+		GPFWriter(GPFWriter&&) = delete;
+		GPFWriter(const GPFWriter&) = delete;
+		GPFWriter& operator=(GPFWriter&&) = delete;
+		GPFWriter& operator=(const GPFWriter&) = delete;
+
+
+		// the data is referenced, not copied: it must stay alive until WriteOnDisk returns
+		void AddSection(GPFSectionType type, const void* data, uint64 byteSize, uint32 elementCount, uint32 elementStride, uint32 flags = 0);
+
+		// a section with one element per entry of elements, referenced as well
+		template<typename T>
+		void AddSection(GPFSectionType type, const std::vector<T>& elements, uint32 flags = 0);
+
+		// drops every pending section of this type, to store one of the default ones in another format
+		void RemoveSection(GPFSectionType type);
+
+		bool WriteOnDisk(const std::wstring& filePath) const;
+
+	private:
+
+		struct PendingSection
+		{
+			GPFSectionEntry entry;
+			const void* data;
+		};
+
+		uint32 m_meshCount;
+		std::vector<PendingSection> m_sections;
+	};
+
+
+	template<typename T>
+	void GPFWriter::AddSection(GPFSectionType type, const std::vector<T>& elements, uint32 flags)
+	{
+		AddSection(type, elements.data(), sizeof(T) * elements.size(), uint32(elements.size()), sizeof(T), flags);
+	}
+
+} // file
+} // xtest
+
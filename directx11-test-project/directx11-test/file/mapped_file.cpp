@@ -0,0 +1,91 @@
+#include "stdafx.h"
+#include "mapped_file.h"
+
+using xtest::file::MappedFile;
+
+
+MappedFile::MappedFile()
+	: m_fileHandle(INVALID_HANDLE_VALUE)
+	, m_mappingHandle(nullptr)
+	, m_data(nullptr)
+	, m_byteSize(0)
+{}
+
+
+MappedFile::MappedFile(MappedFile&& other)
+	: m_fileHandle(other.m_fileHandle)
+	, m_mappingHandle(other.m_mappingHandle)
+	, m_data(other.m_data)
+	, m_byteSize(other.m_byteSize)
+{
+	other.m_fileHandle = INVALID_HANDLE_VALUE;
+	other.m_mappingHandle = nullptr;
+	other.m_data = nullptr;
+	other.m_byteSize = 0;
+}
+
+
+MappedFile& MappedFile::operator=(MappedFile&& other)
+{
+	std::swap(m_fileHandle, other.m_fileHandle);
+	std::swap(m_mappingHandle, other.m_mappingHandle);
+	std::swap(m_data, other.m_data);
+	std::swap(m_byteSize, other.m_byteSize);
+	return *this;
+}
+
+
+MappedFile::MappedFile(HANDLE fileHandle, HANDLE mappingHandle, const char* data, uint64 size)
+	: m_fileHandle(fileHandle)
+	, m_mappingHandle(mappingHandle)
+	, m_data(data)
+	, m_byteSize(size)
+{}
+
+
+MappedFile::~MappedFile()
+{
+	Unmap();
+}
+
+
+void MappedFile::Unmap()
+{
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+		m_data = nullptr;
+	}
+
+	if (m_mappingHandle)
+	{
+		CloseHandle(m_mappingHandle);
+		m_mappingHandle = nullptr;
+	}
+
+	if (m_fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_fileHandle);
+		m_fileHandle = INVALID_HANDLE_VALUE;
+	}
+
+	m_byteSize = 0;
+}
+
+
+const char* MappedFile::Data() const
+{
+	return m_data;
+}
+
+
+uint64 MappedFile::ByteSize() const
+{
+	return m_byteSize;
+}
+
+
+bool MappedFile::IsMapped() const
+{
+	return m_data != nullptr;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+namespace xtest {
+namespace file {
+
+	// read-only view of a whole file mapped in the process address space,
+	// the content is paged in by the OS on first access
+	class MappedFile
+	{
+		// the only way to create a non-empty MappedFile
+		friend MappedFile MapFile(const std::wstring& filePath);
+
+	public:
+
+		MappedFile();
+		MappedFile(MappedFile&& other);
+		MappedFile& operator=(MappedFile&& other);
+
+		virtual ~MappedFile();
+
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+
+		const char* Data() const;
+		uint64 ByteSize() const;
+		bool IsMapped() const;
+
+	private:
+
+		MappedFile(HANDLE fileHandle, HANDLE mappingHandle, const char* data, uint64 size);
+
+		void Unmap();
+
+		HANDLE m_fileHandle;
+		HANDLE m_mappingHandle;
+		const char* m_data;
+		uint64 m_byteSize;
+
+	};
+
+} // file
+} // xtest
+
@@ -0,0 +1,59 @@
+#include "stdafx.h"
+#include "obj_bake_benchmark.h"
+#include <psapi.h>
+#include <fstream>
+
+
+using xtest::file::ObjBakeBenchmarkResult;
+
+
+namespace
+{
+	PROCESS_MEMORY_COUNTERS ProcessMemory()
+	{
+		PROCESS_MEMORY_COUNTERS counters = {};
+		counters.cb = sizeof(PROCESS_MEMORY_COUNTERS);
+		GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(PROCESS_MEMORY_COUNTERS));
+		return counters;
+	}
+
+
+	float MBPerSecond(uint64 byteSize, float millis)
+	{
+		return millis > 0.f ? float(byteSize) / (1024.f * 1024.f) / (millis / 1000.f) : 0.f;
+	}
+}
+
+
+ObjBakeBenchmarkResult xtest::file::RunObjBakeBenchmark(const std::wstring& objFilePath, ObjImporter importer)
+{
+	ObjBakeBenchmarkResult result;
+	{
+		std::ifstream objFile(objFilePath, std::ios::binary | std::ios::ate);
+		if (!objFile.is_open())
+		{
+			return result;
+		}
+		result.fileByteSize = uint64(objFile.tellg());
+	}
+
+	ObjBakeSettings settings;
+	settings.importer = importer;
+
+	const std::wstring gpfFilePath = objFilePath + L".benchmark.gpf";
+	const PROCESS_MEMORY_COUNTERS memoryBefore = ProcessMemory();
+	const ObjBakeReport report = WriteGPFOnDiskFromObj(objFilePath, gpfFilePath, settings);
+	const PROCESS_MEMORY_COUNTERS memoryAfter = ProcessMemory();
+	DeleteFileW(gpfFilePath.c_str());
+
+	result.threadCount = report.threadCount;
+	result.vertexCount = report.vertexCount;
+	result.indexCount = report.indexCount;
+	result.parseMillis = report.parseTime.Millis();
+	result.bakeMillis = report.totalTime.Millis();
+	result.parseMBPerSecond = MBPerSecond(result.fileByteSize, result.parseMillis);
+	result.bakeMBPerSecond = MBPerSecond(result.fileByteSize, result.bakeMillis);
+	result.peakWorkingSetGrowth = memoryAfter.PeakWorkingSetSize > memoryBefore.WorkingSetSize ? memoryAfter.PeakWorkingSetSize - memoryBefore.WorkingSetSize : 0;
+	result.succeeded = report.succeeded;
+	return result;
+}
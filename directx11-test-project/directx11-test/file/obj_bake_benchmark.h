@@ -0,0 +1,33 @@
+#pragma once
+
+#include <file/obj_baker.h>
+
+
+namespace xtest {
+namespace file {
+
+	// the time of a bake and the most memory the process had while baking
+	struct ObjBakeBenchmarkResult
+	{
+		uint64 fileByteSize = 0;	// of the obj file
+		uint32 threadCount = 0;
+		uint32 vertexCount = 0;
+		uint32 indexCount = 0;
+		float parseMillis = 0.f;
+		float bakeMillis = 0.f;		// from the import to the gpf file written
+		float parseMBPerSecond = 0.f;
+		float bakeMBPerSecond = 0.f;
+		uint64 peakWorkingSetGrowth = 0;	// the peak working set of the process minus the working set before the bake
+		bool succeeded = false;
+	};
+
+
+	/**
+	Bakes the obj file to a temporary gpf file next to it with the given importer and the default settings, the gpf
+	file is then deleted. The peak working set of a process never goes down: only the first bake of a process
+	measures its own memory, every importer has to be benchmarked in its own run.
+	*/
+	ObjBakeBenchmarkResult RunObjBakeBenchmark(const std::wstring& objFilePath, ObjImporter importer);
+
+} // file
+} // xtest
@@ -0,0 +1,483 @@
+#include "stdafx.h"
+#include "obj_baker.h"
+#include <file/gpf_format.h>
+#include <file/gpf_writer.h>
+#include <file/gpf_meshlets.h>
+#include <file/gpf_indices.h>
+#include <file/gpf_lods.h>
+#include <file/gpf_bounds.h>
+#include <file/obj_reader.h>
+#include <file/file_utils.h>
+#include <common/parallel_for.h>
+#include <time/time_point.h>
+#include <mesh/mesh_format.h>
+#include <mesh/vertex_weld_table.h>
+#include <mesh/vertex_codec.h>
+#include <tuple>
+#include <external_libs/tiny_obj_loader/tiny_obj_loader.h>
+
+
+using xtest::file::ObjBakeReport;
+using xtest::file::ObjBakeSettings;
+using xtest::file::ObjImporter;
+using xtest::file::ObjReadSettings;
+using xtest::file::MappedFile;
+using xtest::file::GPFMeshHeader;
+using xtest::file::GPFWriter;
+using xtest::file::GPFSectionType;
+using xtest::file::GPFMeshlets;
+using xtest::file::GPFEncodedIndices;
+using xtest::file::GPFLods;
+using xtest::time::TimePoint;
+using xtest::mesh::MeshData;
+using xtest::mesh::VertexWeldTable;
+using xtest::mesh::PackedVertex;
+using xtest::mesh::PackedVertexError;
+using xtest::mesh::VertexQuantization;
+
+
+namespace
+{
+	// vertices and shape-local indices of a single baked shape
+	struct BakedShape
+	{
+		std::vector<MeshData::Vertex> vertices;
+		std::vector<uint32> indices;
+	};
+
+
+	BakedShape BakeShape(const tinyobj::attrib_t& attrib, const tinyobj::shape_t& shape, float weldEpsilon)
+	{
+		BakedShape bakedShape;
+		bakedShape.indices.reserve(shape.mesh.indices.size());
+
+		// keeps vertex unique per shape
+		VertexWeldTable weldTable(&bakedShape.vertices, shape.mesh.indices.size(), weldEpsilon);
+
+		size_t tyniobjIndexOffset = 0;
+		for (size_t faceIndex = 0; faceIndex < shape.mesh.num_face_vertices.size(); faceIndex++)
+		{
+			const size_t faceVertexCount = shape.mesh.num_face_vertices[faceIndex];
+			for (size_t tyniobjVertexIndex = 0; tyniobjVertexIndex < faceVertexCount; tyniobjVertexIndex++)
+			{
+				// access to vertex data
+				tinyobj::index_t idx = shape.mesh.indices[tyniobjIndexOffset + tyniobjVertexIndex];
+				tinyobj::real_t vx = attrib.vertices[3 * idx.vertex_index + 0];
+				tinyobj::real_t vy = attrib.vertices[3 * idx.vertex_index + 1];
+				tinyobj::real_t vz = attrib.vertices[3 * idx.vertex_index + 2];
+
+				// normals and uvs are optional, the missing ones stay zero like in ReadObj
+				MeshData::Vertex meshDataVertex = { { vx, vy, vz },{ 0.f, 0.f, 0.f },{ 0.f, 0.f, 0.f },{ 0.f, 0.f } };
+				if (idx.normal_index >= 0)
+				{
+					meshDataVertex.normal = { attrib.normals[3 * idx.normal_index + 0], attrib.normals[3 * idx.normal_index + 1], attrib.normals[3 * idx.normal_index + 2] };
+				}
+				if (idx.texcoord_index >= 0)
+				{
+					meshDataVertex.uv = { attrib.texcoords[2 * idx.texcoord_index + 0], attrib.texcoords[2 * idx.texcoord_index + 1] };
+				}
+
+				// merge vertex data
+				bakedShape.indices.push_back(weldTable.FindOrAdd(meshDataVertex));
+			}
+			tyniobjIndexOffset += faceVertexCount;
+		}
+
+		return bakedShape;
+	}
+
+
+	bool ImportWithTinyObj(const std::wstring& inputFile, const ObjBakeSettings& settings, ObjBakeReport* report, std::vector<GPFMeshHeader>* gpfMeshHeaders, MeshData* meshData)
+	{
+		const TimePoint startTime = TimePoint::Now();
+
+		tinyobj::attrib_t attrib;
+		std::vector<tinyobj::shape_t> shapes;
+		std::vector<tinyobj::material_t> materials;
+		std::string warn;
+		std::string err;
+
+		//workaround: tiny object doesn't support multi byte string
+		std::string inputFile_asString(inputFile.begin(), inputFile.end());
+
+		bool result = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, inputFile_asString.c_str());
+		XTEST_ASSERT(result, L"tiny object loader failed to parse the file");
+
+		const TimePoint parseEndTime = TimePoint::Now();
+		report->parseTime = parseEndTime - startTime;
+
+		if (!result)
+		{
+			return false;
+		}
+
+
+		// every shape is welded independently on its own worker, the results are then
+		// stitched in shape order so the output doesn't depend on the scheduling
+		std::vector<BakedShape> bakedShapes(shapes.size());
+		xtest::common::ParallelFor(uint32(shapes.size()), report->threadCount, [&](uint32 shapeIndex)
+		{
+			bakedShapes[shapeIndex] = BakeShape(attrib, shapes[shapeIndex], settings.weldEpsilon);
+		});
+
+
+		uint32 gpfVertexOffset = 0;
+		uint32 gpfIndexOffset = 0;
+
+		size_t totalVertexCount = 0;
+		size_t totalIndexCount = 0;
+		for (const BakedShape& bakedShape : bakedShapes)
+		{
+			totalVertexCount += bakedShape.vertices.size();
+			totalIndexCount += bakedShape.indices.size();
+		}
+		meshData->vertices.reserve(totalVertexCount);
+		meshData->indices.reserve(totalIndexCount);
+
+		for (size_t shapeIndex = 0; shapeIndex < shapes.size(); shapeIndex++)
+		{
+			BakedShape& bakedShape = bakedShapes[shapeIndex];
+			GPFMeshHeader gpfMeshHeader;
+
+			// store all vertex buffers and index buffer together, indices stay local to the shape
+			meshData->vertices.insert(meshData->vertices.end(), bakedShape.vertices.begin(), bakedShape.vertices.end());
+			meshData->indices.insert(meshData->indices.end(), bakedShape.indices.begin(), bakedShape.indices.end());
+
+			// register mesh header data
+			// fixed name width for our format (24 in total, null terminator included)
+			const char* shapeName_cstr = shapes[shapeIndex].name.c_str();
+			std::memcpy(&gpfMeshHeader.name, shapeName_cstr, std::min(sizeof(gpfMeshHeader.name) - 1, std::strlen(shapeName_cstr)));
+
+			// vertex index data
+			gpfMeshHeader.vertexCount = uint32(bakedShape.vertices.size());
+			gpfMeshHeader.indexCount = uint32(bakedShape.indices.size());
+			gpfMeshHeader.vertexOffset = gpfVertexOffset;
+			gpfMeshHeader.indexOffset = gpfIndexOffset;
+
+
+			gpfMeshHeaders->push_back(gpfMeshHeader);
+			gpfVertexOffset += gpfMeshHeader.vertexCount;
+			gpfIndexOffset += gpfMeshHeader.indexCount;
+
+			// release the shape memory as soon as possible
+			bakedShape = BakedShape();
+		}
+
+		report->weldTime = TimePoint::Now() - parseEndTime;
+		return true;
+	}
+
+
+	// the streaming importer parses the file in chunks on the calling thread, the mapped one parses the whole
+	// mapping with all the threads
+	bool ImportWithReadObj(const std::wstring& inputFile, const ObjBakeSettings& settings, ObjBakeReport* report, std::vector<GPFMeshHeader>* gpfMeshHeaders, MeshData* meshData)
+	{
+		const TimePoint startTime = TimePoint::Now();
+
+		ObjReadSettings readSettings;
+		readSettings.weldEpsilon = settings.weldEpsilon;
+
+		bool result = false;
+		if (settings.importer == ObjImporter::streaming)
+		{
+			readSettings.threadCount = 1;
+			result = xtest::file::ReadObj(inputFile, readSettings, gpfMeshHeaders, meshData);
+		}
+		else
+		{
+			readSettings.threadCount = report->threadCount;
+			MappedFile objFile = xtest::file::MapFile(inputFile);
+			result = objFile.IsMapped() && xtest::file::ReadObj(objFile.Data(), objFile.ByteSize(), readSettings, gpfMeshHeaders, meshData);
+		}
+
+		report->parseTime = TimePoint::Now() - startTime;
+		return result;
+	}
+
+
+	// gives normals and tangents to every mesh, returns the number of generated normals and of split vertices.
+	// the meshes smaller than mesh::kMinParallelTangentSpaceTriangleCount are processed in parallel with each other,
+	// the larger ones one after another with all the threads. the meshes are then stitched back in order, the ones
+	// after a mesh that got split vertices move
+	std::pair<uint32, uint32> GenerateTangentSpace(xtest::mesh::NormalWeighting normalWeighting, uint32 threadCount, std::vector<GPFMeshHeader>* gpfMeshHeaders, MeshData* meshData)
+	{
+		const uint32 meshCount = uint32(gpfMeshHeaders->size());
+		std::vector<MeshData> meshes(meshCount);
+		for (uint32 meshIndex = 0; meshIndex < meshCount; meshIndex++)
+		{
+			const GPFMeshHeader& gpfMeshHeader = (*gpfMeshHeaders)[meshIndex];
+			const auto firstVertex = meshData->vertices.begin() + gpfMeshHeader.vertexOffset;
+			const auto firstIndex = meshData->indices.begin() + gpfMeshHeader.indexOffset;
+			meshes[meshIndex].vertices.assign(firstVertex, firstVertex + gpfMeshHeader.vertexCount);
+			meshes[meshIndex].indices.assign(firstIndex, firstIndex + gpfMeshHeader.indexCount);
+		}
+
+		std::vector<uint32> generatedNormalCounts(meshCount);
+		std::vector<uint32> splitCounts(meshCount);
+		auto processMesh = [&](uint32 meshIndex, uint32 meshThreadCount)
+		{
+			generatedNormalCounts[meshIndex] = xtest::mesh::GenerateMissingNormals(meshes[meshIndex], normalWeighting, meshThreadCount);
+			splitCounts[meshIndex] = xtest::mesh::GenerateTangents(meshes[meshIndex], meshThreadCount);
+		};
+		auto isLarge = [&](uint32 meshIndex) { return meshes[meshIndex].indices.size() / 3 >= xtest::mesh::kMinParallelTangentSpaceTriangleCount; };
+
+		xtest::common::ParallelFor(meshCount, threadCount, [&](uint32 meshIndex)
+		{
+			if (!isLarge(meshIndex))
+			{
+				processMesh(meshIndex, 1);
+			}
+		});
+		for (uint32 meshIndex = 0; meshIndex < meshCount; meshIndex++)
+		{
+			if (isLarge(meshIndex))
+			{
+				processMesh(meshIndex, threadCount);
+			}
+		}
+
+		uint32 generatedNormalCount = 0;
+		uint32 splitCount = 0;
+		meshData->vertices.clear();
+		meshData->indices.clear();
+		for (uint32 meshIndex = 0; meshIndex < meshCount; meshIndex++)
+		{
+			GPFMeshHeader& gpfMeshHeader = (*gpfMeshHeaders)[meshIndex];
+			MeshData& mesh = meshes[meshIndex];
+			gpfMeshHeader.vertexOffset = uint32(meshData->vertices.size());
+			gpfMeshHeader.vertexCount = uint32(mesh.vertices.size());
+			meshData->vertices.insert(meshData->vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+			meshData->indices.insert(meshData->indices.end(), mesh.indices.begin(), mesh.indices.end());
+			generatedNormalCount += generatedNormalCounts[meshIndex];
+			splitCount += splitCounts[meshIndex];
+
+			// release the mesh memory as soon as possible
+			mesh = MeshData();
+		}
+
+		return std::make_pair(generatedNormalCount, splitCount);
+	}
+
+
+	// optimizes every mesh independently, the average cache miss ratios and the overdraw of all the meshes before and
+	// after go in the report
+	void OptimizeMeshes(const std::vector<GPFMeshHeader>& gpfMeshHeaders, float overdrawAcmrThreshold, uint32 threadCount, MeshData* meshData, ObjBakeReport* report)
+	{
+		std::vector<xtest::mesh::VertexCacheStatistics> statisticsBefore(gpfMeshHeaders.size());
+		std::vector<xtest::mesh::VertexCacheStatistics> statisticsAfter(gpfMeshHeaders.size());
+		std::vector<xtest::mesh::OverdrawStatistics> overdrawBefore(gpfMeshHeaders.size());
+		std::vector<xtest::mesh::OverdrawStatistics> overdrawAfter(gpfMeshHeaders.size());
+
+		xtest::common::ParallelFor(uint32(gpfMeshHeaders.size()), threadCount, [&](uint32 meshIndex)
+		{
+			const GPFMeshHeader& gpfMeshHeader = gpfMeshHeaders[meshIndex];
+			MeshData::Vertex* vertices = &meshData->vertices[gpfMeshHeader.vertexOffset];
+			uint32* indices = &meshData->indices[gpfMeshHeader.indexOffset];
+
+			statisticsBefore[meshIndex] = xtest::mesh::AnalyzeVertexCache(indices, gpfMeshHeader.indexCount, gpfMeshHeader.vertexCount);
+			if (overdrawAcmrThreshold > 0.f)
+			{
+				overdrawBefore[meshIndex] = xtest::mesh::AnalyzeOverdraw(indices, gpfMeshHeader.indexCount, vertices, gpfMeshHeader.vertexCount);
+			}
+
+			xtest::mesh::OptimizeVertexCache(indices, gpfMeshHeader.indexCount, gpfMeshHeader.vertexCount);
+			if (overdrawAcmrThreshold > 0.f)
+			{
+				xtest::mesh::OptimizeOverdraw(indices, gpfMeshHeader.indexCount, vertices, gpfMeshHeader.vertexCount, overdrawAcmrThreshold);
+			}
+			xtest::mesh::OptimizeVertexFetch(vertices, gpfMeshHeader.vertexCount, indices, gpfMeshHeader.indexCount);
+
+			statisticsAfter[meshIndex] = xtest::mesh::AnalyzeVertexCache(indices, gpfMeshHeader.indexCount, gpfMeshHeader.vertexCount);
+			if (overdrawAcmrThreshold > 0.f)
+			{
+				overdrawAfter[meshIndex] = xtest::mesh::AnalyzeOverdraw(indices, gpfMeshHeader.indexCount, vertices, gpfMeshHeader.vertexCount);
+			}
+		});
+
+		uint64 triangleCount = 0;
+		uint64 transformedBefore = 0;
+		uint64 transformedAfter = 0;
+		uint64 coveredPixelCount = 0;
+		uint64 shadedBefore = 0;
+		uint64 shadedAfter = 0;
+		for (size_t meshIndex = 0; meshIndex < gpfMeshHeaders.size(); meshIndex++)
+		{
+			triangleCount += statisticsBefore[meshIndex].triangleCount;
+			transformedBefore += statisticsBefore[meshIndex].transformedVertexCount;
+			transformedAfter += statisticsAfter[meshIndex].transformedVertexCount;
+			coveredPixelCount += overdrawBefore[meshIndex].coveredPixelCount;
+			shadedBefore += overdrawBefore[meshIndex].shadedPixelCount;
+			shadedAfter += overdrawAfter[meshIndex].shadedPixelCount;
+		}
+
+		if (triangleCount > 0)
+		{
+			report->acmrBefore = float(transformedBefore) / triangleCount;
+			report->acmrAfter = float(transformedAfter) / triangleCount;
+		}
+		if (coveredPixelCount > 0)
+		{
+			report->overdrawBefore = float(shadedBefore) / coveredPixelCount;
+			report->overdrawAfter = float(shadedAfter) / coveredPixelCount;
+		}
+	}
+
+
+	// packs every mesh against its own bounds, returns the worst error among all of them
+	PackedVertexError PackMeshes(const std::vector<GPFMeshHeader>& gpfMeshHeaders, const MeshData& meshData, uint32 threadCount,
+		std::vector<PackedVertex>* packedVertices, std::vector<VertexQuantization>* vertexQuantizations)
+	{
+		packedVertices->resize(meshData.vertices.size());
+		vertexQuantizations->resize(gpfMeshHeaders.size());
+		std::vector<PackedVertexError> errors(gpfMeshHeaders.size());
+
+		xtest::common::ParallelFor(uint32(gpfMeshHeaders.size()), threadCount, [&](uint32 meshIndex)
+		{
+			const GPFMeshHeader& gpfMeshHeader = gpfMeshHeaders[meshIndex];
+			const MeshData::Vertex* vertices = meshData.vertices.data() + gpfMeshHeader.vertexOffset;
+			PackedVertex* meshPackedVertices = packedVertices->data() + gpfMeshHeader.vertexOffset;
+
+			(*vertexQuantizations)[meshIndex] = xtest::mesh::ComputeVertexQuantization(vertices, gpfMeshHeader.vertexCount);
+			xtest::mesh::PackVertices(vertices, gpfMeshHeader.vertexCount, (*vertexQuantizations)[meshIndex], meshPackedVertices);
+			errors[meshIndex] = xtest::mesh::MeasurePackingError(vertices, meshPackedVertices, gpfMeshHeader.vertexCount, (*vertexQuantizations)[meshIndex]);
+		});
+
+		PackedVertexError worstError;
+		for (const PackedVertexError& error : errors)
+		{
+			worstError.maxPositionError = std::max(worstError.maxPositionError, error.maxPositionError);
+			worstError.maxNormalError = std::max(worstError.maxNormalError, error.maxNormalError);
+			worstError.maxTangentError = std::max(worstError.maxTangentError, error.maxTangentError);
+			worstError.maxUVError = std::max(worstError.maxUVError, error.maxUVError);
+		}
+		return worstError;
+	}
+}
+
+
+ObjBakeReport xtest::file::WriteGPFOnDiskFromObj(const std::wstring& inputFile, const std::wstring& outputFile, const ObjBakeSettings& settings)
+{
+	// every pass runs on the same threads, the ones with fewer work items than threads leave some idle
+	ObjBakeReport report;
+	report.threadCount = settings.threadCount == 0 ? common::HardwareThreadCount() : settings.threadCount;
+	const TimePoint startTime = TimePoint::Now();
+
+	mesh::MeshData meshData;
+	std::vector<GPFMeshHeader> gpfMeshHeaders;
+	const bool imported = settings.importer == ObjImporter::tinyobj
+		? ImportWithTinyObj(inputFile, settings, &report, &gpfMeshHeaders, &meshData)
+		: ImportWithReadObj(inputFile, settings, &report, &gpfMeshHeaders, &meshData);
+
+	const TimePoint importEndTime = TimePoint::Now();
+	if (!imported)
+	{
+		report.totalTime = importEndTime - startTime;
+		return report;
+	}
+
+	// the vertices split by the tangents are then optimized with the others
+	if (settings.generateTangentSpace)
+	{
+		std::tie(report.generatedNormalCount, report.tangentSplitCount) = GenerateTangentSpace(settings.normalWeighting, report.threadCount, &gpfMeshHeaders, &meshData);
+	}
+	const TimePoint tangentSpaceEndTime = TimePoint::Now();
+	report.tangentSpaceTime = tangentSpaceEndTime - importEndTime;
+
+	report.shapeCount = uint32(gpfMeshHeaders.size());
+	report.vertexCount = uint32(meshData.vertices.size());
+	report.indexCount = uint32(meshData.indices.size());
+
+	if (settings.optimizeMeshes)
+	{
+		OptimizeMeshes(gpfMeshHeaders, settings.overdrawAcmrThreshold, report.threadCount, &meshData, &report);
+	}
+
+	// built on the final triangle order so that the meshlets inherit the vertex locality
+	GPFMeshlets meshlets;
+	if (settings.buildMeshlets)
+	{
+		meshlets = BuildGPFMeshlets(gpfMeshHeaders, meshData, settings.meshletMaxVertexCount, settings.meshletMaxTriangleCount);
+		report.meshletCount = uint32(meshlets.meshletData.meshlets.size());
+	}
+
+	// simplified from the optimized meshes, they keep referencing the same vertices
+	GPFLods lods;
+	if (settings.lodCount > 0)
+	{
+		lods = BuildGPFLods(gpfMeshHeaders, meshData, settings.lodCount, settings.lodReduction, settings.lodMaxError, report.threadCount);
+		report.lodCount = uint32(lods.lods.size());
+	}
+
+	// of the final vertices, the packed positions stay inside the same boxes
+	const std::vector<mesh::MeshBounds> bounds = ComputeGPFBounds(gpfMeshHeaders, meshData);
+
+	std::vector<PackedVertex> packedVertices;
+	std::vector<VertexQuantization> vertexQuantizations;
+	if (settings.packVertices)
+	{
+		report.packingError = PackMeshes(gpfMeshHeaders, meshData, report.threadCount, &packedVertices, &vertexQuantizations);
+	}
+
+	report.vertexByteSize = settings.packVertices ? sizeof(PackedVertex) * packedVertices.size() : sizeof(MeshData::Vertex) * meshData.vertices.size();
+	std::vector<uint8> compressedVertices;
+	if (settings.compressVertices)
+	{
+		compressedVertices = settings.packVertices
+			? mesh::EncodeVertices(packedVertices.data(), uint32(packedVertices.size()), sizeof(PackedVertex))
+			: mesh::EncodeVertices(meshData.vertices.data(), uint32(meshData.vertices.size()), sizeof(MeshData::Vertex));
+		report.vertexByteSize = compressedVertices.size();
+	}
+
+	GPFEncodedIndices encodedIndices;
+	report.indexByteSize = sizeof(uint32) * meshData.indices.size();
+	if (settings.narrowIndices || settings.compressIndices)
+	{
+		encodedIndices = EncodeGPFIndices(gpfMeshHeaders, meshData.indices, settings.compressIndices);
+		report.indexByteSize = encodedIndices.data.size();
+	}
+
+	const TimePoint optimizeEndTime = TimePoint::Now();
+	report.optimizeTime = optimizeEndTime - tangentSpaceEndTime;
+
+
+	// write gpf file on disk, see gpf_format.h for the layout
+	std::unique_ptr<GPFWriter> gpfWriter = settings.packVertices
+		? std::make_unique<GPFWriter>(gpfMeshHeaders, packedVertices, vertexQuantizations, meshData.indices)
+		: std::make_unique<GPFWriter>(gpfMeshHeaders, meshData);
+	if (settings.compressVertices)
+	{
+		gpfWriter->RemoveSection(settings.packVertices ? GPFSectionType::packed_vertices : GPFSectionType::vertices);
+		gpfWriter->AddSection(GPFSectionType::compressed_vertices, compressedVertices.data(), compressedVertices.size(), report.vertexCount,
+			settings.packVertices ? sizeof(PackedVertex) : sizeof(MeshData::Vertex));
+	}
+	AddBoundsSection(bounds, gpfWriter.get());
+	if (settings.narrowIndices || settings.compressIndices)
+	{
+		SetEncodedIndexSections(encodedIndices, gpfWriter.get());
+	}
+	if (settings.buildMeshlets)
+	{
+		AddMeshletSections(meshlets, gpfWriter.get());
+	}
+	if (settings.lodCount > 0)
+	{
+		AddLodSections(lods, gpfWriter.get());
+	}
+	report.succeeded = gpfWriter->WriteOnDisk(outputFile);
+	XTEST_ASSERT(report.succeeded, L"unable to write the file:'%s'", outputFile.c_str());
+
+	const TimePoint endTime = TimePoint::Now();
+	report.writeTime = endTime - optimizeEndTime;
+	report.totalTime = endTime - startTime;
+
+	XTEST_DEBUG_LOG(L"obj bake: " << report.shapeCount << L" shapes, " << report.vertexCount << L" vertices (" << report.vertexByteSize << L" bytes), "
+		<< report.indexCount << L" indices (" << report.indexByteSize << L" bytes), " << report.meshletCount << L" meshlets, " << report.lodCount << L" lods, " << report.threadCount
+		<< L" threads | parse " << report.parseTime.Millis() << L"ms, weld " << report.weldTime.Millis()
+		<< L"ms, tangent space " << report.tangentSpaceTime.Millis() << L"ms (" << report.generatedNormalCount << L" normals generated, "
+		<< report.tangentSplitCount << L" vertices split), optimize " << report.optimizeTime.Millis() << L"ms (acmr " << report.acmrBefore << L" -> " << report.acmrAfter
+		<< L", overdraw " << report.overdrawBefore << L" -> " << report.overdrawAfter << L"), packing error (position " << report.packingError.maxPositionError << L", normal " << report.packingError.maxNormalError
+		<< L" deg, tangent " << report.packingError.maxTangentError << L" deg, uv " << report.packingError.maxUVError
+		<< L"), write " << report.writeTime.Millis() << L"ms, total " << report.totalTime.Millis() << L"ms");
+
+	return report;
+}
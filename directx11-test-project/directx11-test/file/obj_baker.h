@@ -0,0 +1,108 @@
+#pragma once
+
+#include <time/time_span.h>
+#include <mesh/mesh_optimizer.h>
+#include <mesh/tangent_space.h>
+#include <mesh/meshlet.h>
+#include <mesh/packed_vertex.h>
+
+
+namespace xtest {
+namespace file {
+
+	enum class ObjImporter
+	{
+		streaming,	// ReadObj on the file read serially in chunks, the memory used doesn't grow with the file size
+		mapped,		// ReadObj in parallel on the mapped file, keeps every face corner until the shapes are welded
+		tinyobj		// tiny obj loader, keeps the whole model in memory before welding it
+	};
+
+
+	struct ObjBakeSettings
+	{
+		ObjImporter importer = ObjImporter::streaming;
+
+		// number of threads parsing (mapped importer) or welding the shapes (tinyobj importer), 0 means one per
+		// hardware thread; the streaming importer always parses on a single thread. the passes after the import use
+		// the same threads. the output file is byte-identical whatever the importer and the thread count are.
+		uint32 threadCount = 0;
+
+		// vertices whose attributes fall in the same cell of a grid with this step are merged,
+		// 0 merges only vertices that are exactly equal.
+		float weldEpsilon = 0.f;
+
+		// gives a normal to the vertices imported without one and computes the tangents of every mesh, before the
+		// optimizations since the tangents can split vertices. see mesh::GenerateMissingNormals and mesh::GenerateTangents
+		bool generateTangentSpace = true;
+		mesh::NormalWeighting normalWeighting = mesh::NormalWeighting::angle;
+
+		// reorders the triangles for the post-transform vertex cache and the vertices in first-use order,
+		// every mesh on its own. see mesh::OptimizeVertexCache and mesh::OptimizeVertexFetch.
+		bool optimizeMeshes = true;
+
+		// with optimizeMeshes, the triangle clusters are then sorted to reduce overdraw allowing the cache
+		// miss ratio to get this much worse, 0 skips the pass. see mesh::OptimizeOverdraw.
+		float overdrawAcmrThreshold = mesh::kDefaultOverdrawAcmrThreshold;
+
+		// splits every mesh in meshlets after the optimizations and stores them in the meshlet sections,
+		// see mesh::BuildMeshlets and file::AddMeshletSections
+		bool buildMeshlets = false;
+		uint32 meshletMaxVertexCount = mesh::kDefaultMeshletVertexCount;
+		uint32 meshletMaxTriangleCount = mesh::kDefaultMeshletTriangleCount;
+
+		// builds a chain of up to lodCount simplified triangle lists per mesh, each one with about lodReduction times
+		// the triangles of the previous one and simplified from it with at most lodMaxError, relative to the largest side
+		// of the mesh bounds. the lods share the mesh vertices, see file::BuildGPFLods and file::AddLodSections
+		uint32 lodCount = 0;
+		float lodReduction = 0.5f;
+		float lodMaxError = 0.01f;
+
+		// stores mesh::PackedVertex instead of the full vertices, quantized against the bounds of every mesh.
+		// ReadGPF unpacks them, see ObjBakeReport::packingError for how much the attributes moved.
+		bool packVertices = false;
+
+		// compresses the full or packed vertices, see mesh::EncodeVertices. ReadGPF decodes them in parallel.
+		bool compressVertices = false;
+
+		// stores the indices of the meshes with up to 65536 vertices in 16 bits, see file::EncodeGPFIndices
+		bool narrowIndices = false;
+
+		// compresses the indices of every mesh, narrowIndices is then ignored. see mesh::EncodeIndices
+		bool compressIndices = false;
+	};
+
+
+	struct ObjBakeReport
+	{
+		// the streaming and mapped importers weld while parsing, their weld time is part of parseTime
+		time::TimeSpan parseTime;
+		time::TimeSpan weldTime;
+		time::TimeSpan tangentSpaceTime;
+		time::TimeSpan optimizeTime;
+		time::TimeSpan writeTime;
+		time::TimeSpan totalTime;
+		uint32 threadCount = 0;	// used by every pass, ObjBakeSettings::threadCount with 0 resolved
+		uint32 shapeCount = 0;
+		uint32 vertexCount = 0;
+		uint32 indexCount = 0;
+		uint32 generatedNormalCount = 0;	// vertices imported without a normal that got one
+		uint32 tangentSplitCount = 0;		// vertices added to keep mirrored uvs apart, see mesh::GenerateTangents
+		uint64 vertexByteSize = 0;	// of the vertices in the file
+		uint64 indexByteSize = 0;	// of the indices in the file
+		uint32 meshletCount = 0;
+		uint32 lodCount = 0;	// of all the meshes
+		float acmrBefore = 0.f;	// average cache miss ratio of all the meshes, see mesh::AnalyzeVertexCache
+		float acmrAfter = 0.f;
+		float overdrawBefore = 0.f;	// shaded per covered pixels of all the meshes, see mesh::AnalyzeOverdraw. only with the overdraw pass
+		float overdrawAfter = 0.f;
+		mesh::PackedVertexError packingError;	// worst error among all the meshes, only with packVertices
+		bool succeeded = false;
+	};
+
+
+	// converts an obj file to a gpf file, every obj shape becomes a gpf mesh with its own unique vertices
+	ObjBakeReport WriteGPFOnDiskFromObj(const std::wstring& inputFile, const std::wstring& outputFile, const ObjBakeSettings& settings = ObjBakeSettings());
+
+} // file
+} // xtest
+
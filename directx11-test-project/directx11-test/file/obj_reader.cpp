@@ -0,0 +1,891 @@
+#include "stdafx.h"
+#include "obj_reader.h"
+#include <mesh/vertex_weld_table.h>
+#include <common/parallel_for.h>
+#include <fstream>
+
+
+using xtest::file::GPFMeshHeader;
+using xtest::file::ObjReadSettings;
+using xtest::mesh::MeshData;
+using xtest::mesh::VertexWeldTable;
+
+
+namespace
+{
+	const size_t kObjChunkByteSize = 4 * 1024 * 1024;
+	const size_t kObjMinParallelChunkByteSize = 1024 * 1024;
+	const uint32 kObjChunksPerThread = 4;
+	const uint32 kObjMissingIndex = UINT32_MAX;
+
+	const std::array<double, 23> kPowersOfTen = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+
+	bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+
+	bool IsDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+
+	const char* SkipSpaces(const char* cursor, const char* end)
+	{
+		while (cursor < end && IsSpace(*cursor))
+		{
+			cursor++;
+		}
+		return cursor;
+	}
+
+
+	// true if the line starts with the given keyword followed by a space
+	bool IsRecord(const char* cursor, const char* end, const char* keyword)
+	{
+		while (*keyword)
+		{
+			if (cursor == end || *cursor++ != *keyword++)
+			{
+				return false;
+			}
+		}
+		return cursor == end || IsSpace(*cursor);
+	}
+
+
+	// the input is not null terminated, every parse function stops at end
+	bool ParseFloat(const char** cursor, const char* end, float* value)
+	{
+		const char* current = SkipSpaces(*cursor, end);
+
+		bool negative = false;
+		if (current < end && (*current == '-' || *current == '+'))
+		{
+			negative = *current++ == '-';
+		}
+
+		// up to 19 significant digits fit in the mantissa, the others only move the exponent
+		uint64 mantissa = 0;
+		int32 significantDigits = 0;
+		int32 exponent = 0;
+		bool anyDigit = false;
+		for (; current < end && IsDigit(*current); current++, anyDigit = true)
+		{
+			if (significantDigits < 19)
+			{
+				mantissa = mantissa * 10 + uint64(*current - '0');
+				significantDigits += mantissa != 0 ? 1 : 0;
+			}
+			else
+			{
+				exponent++;
+			}
+		}
+
+		if (current < end && *current == '.')
+		{
+			for (current++; current < end && IsDigit(*current); current++, anyDigit = true)
+			{
+				if (significantDigits < 19)
+				{
+					mantissa = mantissa * 10 + uint64(*current - '0');
+					significantDigits += mantissa != 0 ? 1 : 0;
+					exponent--;
+				}
+			}
+		}
+
+		if (!anyDigit)
+		{
+			return false;
+		}
+
+		if (current < end && (*current == 'e' || *current == 'E'))
+		{
+			const char* exponentStart = current + 1;
+			bool negativeExponent = false;
+			if (exponentStart < end && (*exponentStart == '-' || *exponentStart == '+'))
+			{
+				negativeExponent = *exponentStart++ == '-';
+			}
+
+			if (exponentStart < end && IsDigit(*exponentStart))
+			{
+				int32 explicitExponent = 0;
+				for (current = exponentStart; current < end && IsDigit(*current); current++)
+				{
+					explicitExponent = std::min(explicitExponent * 10 + (*current - '0'), 100000);
+				}
+				exponent += negativeExponent ? -explicitExponent : explicitExponent;
+			}
+		}
+
+		// powers of ten up to 1e22 are exact doubles, one multiplication or division is enough for
+		// the values found in obj files. std::pow is only used for extreme exponents
+		double result = double(mantissa);
+		if (mantissa != 0 && exponent != 0)
+		{
+			const int32 absExponent = exponent > 0 ? exponent : -exponent;
+			const double scale = absExponent < int32(kPowersOfTen.size()) ? kPowersOfTen[absExponent] : std::pow(10.0, absExponent);
+			result = exponent > 0 ? result * scale : result / scale;
+		}
+
+		*value = float(negative ? -result : result);
+		*cursor = current;
+		return true;
+	}
+
+
+	bool ParseInt(const char** cursor, const char* end, int64* value)
+	{
+		const char* current = *cursor;
+
+		bool negative = false;
+		if (current < end && (*current == '-' || *current == '+'))
+		{
+			negative = *current++ == '-';
+		}
+
+		if (current == end || !IsDigit(*current))
+		{
+			return false;
+		}
+
+		int64 result = 0;
+		for (; current < end && IsDigit(*current); current++)
+		{
+			result = std::min(result * 10 + (*current - '0'), int64(INT32_MAX));
+		}
+
+		*value = negative ? -result : result;
+		*cursor = current;
+		return true;
+	}
+
+
+	// v, v/vt, v//vn or v/vt/vn, missing indices are set to 0
+	bool ParseCorner(const char** cursor, const char* end, int64* positionIndex, int64* uvIndex, int64* normalIndex)
+	{
+		*positionIndex = 0;
+		*uvIndex = 0;
+		*normalIndex = 0;
+
+		const char* current = *cursor;
+		if (!ParseInt(&current, end, positionIndex))
+		{
+			return false;
+		}
+		if (current < end && *current == '/')
+		{
+			current++;
+			if (current < end && *current != '/' && !ParseInt(&current, end, uvIndex))
+			{
+				return false;
+			}
+			if (current < end && *current == '/')
+			{
+				current++;
+				if (!ParseInt(&current, end, normalIndex))
+				{
+					return false;
+				}
+			}
+		}
+
+		*cursor = current;
+		return true;
+	}
+
+
+	// the whole rest of the line, without the surrounding spaces
+	std::string ParseShapeName(const char* cursor, const char* end)
+	{
+		const char* nameBegin = SkipSpaces(cursor, end);
+		const char* nameEnd = end;
+		while (nameEnd > nameBegin && IsSpace(nameEnd[-1]))
+		{
+			nameEnd--;
+		}
+		return std::string(nameBegin, nameEnd);
+	}
+
+
+	// obj indices are 1 based, negative ones are relative to the end of the pool
+	bool ResolveIndex(int64 objIndex, size_t poolSize, uint32* index)
+	{
+		const int64 resolved = objIndex > 0 ? objIndex - 1 : int64(poolSize) + objIndex;
+		if (objIndex == 0 || resolved < 0 || resolved >= int64(poolSize))
+		{
+			return false;
+		}
+		*index = uint32(resolved);
+		return true;
+	}
+
+
+	class ObjStreamParser
+	{
+	public:
+
+		ObjStreamParser(const ObjReadSettings& settings, std::vector<GPFMeshHeader>* meshHeaders, MeshData* meshData)
+			: m_settings(settings)
+			, m_meshHeaders(meshHeaders)
+			, m_meshData(meshData)
+			, m_weldTable(&meshData->vertices, 0, settings.weldEpsilon)
+			, m_shapeName()
+			, m_shapeVertexOffset(uint32(meshData->vertices.size()))
+			, m_shapeIndexOffset(uint32(meshData->indices.size()))
+		{}
+
+
+		bool ParseLine(const char* cursor, const char* end)
+		{
+			cursor = SkipSpaces(cursor, end);
+			if (cursor == end || *cursor == '#')
+			{
+				return true;
+			}
+
+			if (IsRecord(cursor, end, "v"))
+			{
+				return ParseFloats(cursor + 1, end, 3, &m_positions);
+			}
+			if (IsRecord(cursor, end, "vn"))
+			{
+				return ParseFloats(cursor + 2, end, 3, &m_normals);
+			}
+			if (IsRecord(cursor, end, "vt"))
+			{
+				return ParseFloats(cursor + 2, end, 2, &m_uvs);
+			}
+			if (IsRecord(cursor, end, "f"))
+			{
+				return ParseFace(cursor + 1, end);
+			}
+			if (IsRecord(cursor, end, "o") || IsRecord(cursor, end, "g"))
+			{
+				FlushShape();
+				m_shapeName = ParseShapeName(cursor + 1, end);
+				return true;
+			}
+
+			// materials, smoothing groups, lines and points are not used by gpf meshes
+			return true;
+		}
+
+
+		void FlushShape()
+		{
+			const uint32 indexCount = uint32(m_meshData->indices.size()) - m_shapeIndexOffset;
+			if (indexCount > 0)
+			{
+				GPFMeshHeader meshHeader;
+
+				// fixed name width for our format (24 in total, null terminator included)
+				std::memcpy(&meshHeader.name, m_shapeName.c_str(), std::min(sizeof(meshHeader.name) - 1, m_shapeName.size()));
+				meshHeader.vertexCount = uint32(m_meshData->vertices.size()) - m_shapeVertexOffset;
+				meshHeader.indexCount = indexCount;
+				meshHeader.vertexOffset = m_shapeVertexOffset;
+				meshHeader.indexOffset = m_shapeIndexOffset;
+				m_meshHeaders->push_back(meshHeader);
+			}
+
+			// vertices are welded per shape, as the tinyobj based importer does
+			m_weldTable = VertexWeldTable(&m_meshData->vertices, 0, m_settings.weldEpsilon);
+			m_shapeVertexOffset = uint32(m_meshData->vertices.size());
+			m_shapeIndexOffset = uint32(m_meshData->indices.size());
+		}
+
+	private:
+
+		bool ParseFloats(const char* cursor, const char* end, uint32 count, std::vector<float>* pool)
+		{
+			// optional trailing values (w, vertex colors) are ignored
+			for (uint32 valueIndex = 0; valueIndex < count; valueIndex++)
+			{
+				float value;
+				if (!ParseFloat(&cursor, end, &value))
+				{
+					return false;
+				}
+				pool->push_back(value);
+			}
+			return true;
+		}
+
+
+		bool ParseFace(const char* cursor, const char* end)
+		{
+			m_faceCorners.clear();
+			for (cursor = SkipSpaces(cursor, end); cursor < end; cursor = SkipSpaces(cursor, end))
+			{
+				int64 positionIndex;
+				int64 uvIndex;
+				int64 normalIndex;
+				if (!ParseCorner(&cursor, end, &positionIndex, &uvIndex, &normalIndex))
+				{
+					return false;
+				}
+
+				MeshData::Vertex vertex = { { 0.f, 0.f, 0.f },{ 0.f, 0.f, 0.f },{ 0.f, 0.f, 0.f },{ 0.f, 0.f } };
+				uint32 index;
+				if (!ResolveIndex(positionIndex, m_positions.size() / 3, &index))
+				{
+					return false;
+				}
+				vertex.position = { m_positions[3 * index + 0], m_positions[3 * index + 1], m_positions[3 * index + 2] };
+
+				if (normalIndex != 0)
+				{
+					if (!ResolveIndex(normalIndex, m_normals.size() / 3, &index))
+					{
+						return false;
+					}
+					vertex.normal = { m_normals[3 * index + 0], m_normals[3 * index + 1], m_normals[3 * index + 2] };
+				}
+
+				if (uvIndex != 0)
+				{
+					if (!ResolveIndex(uvIndex, m_uvs.size() / 2, &index))
+					{
+						return false;
+					}
+					vertex.uv = { m_uvs[2 * index + 0], m_uvs[2 * index + 1] };
+				}
+
+				m_faceCorners.push_back(vertex);
+			}
+
+			// faces with less than 3 vertices are skipped
+			if (m_faceCorners.size() < 3)
+			{
+				return true;
+			}
+
+			m_faceIndices.clear();
+			for (const MeshData::Vertex& corner : m_faceCorners)
+			{
+				m_faceIndices.push_back(m_weldTable.FindOrAdd(corner) - m_shapeVertexOffset);
+			}
+
+			for (size_t cornerIndex = 2; cornerIndex < m_faceIndices.size(); cornerIndex++)
+			{
+				m_meshData->indices.push_back(m_faceIndices[0]);
+				m_meshData->indices.push_back(m_faceIndices[cornerIndex - 1]);
+				m_meshData->indices.push_back(m_faceIndices[cornerIndex]);
+			}
+			return true;
+		}
+
+
+		const ObjReadSettings& m_settings;
+		std::vector<GPFMeshHeader>* m_meshHeaders;
+		MeshData* m_meshData;
+		VertexWeldTable m_weldTable;
+		std::string m_shapeName;
+		uint32 m_shapeVertexOffset;
+		uint32 m_shapeIndexOffset;
+
+		std::vector<float> m_positions;
+		std::vector<float> m_normals;
+		std::vector<float> m_uvs;
+		std::vector<MeshData::Vertex> m_faceCorners;
+		std::vector<uint32> m_faceIndices;
+	};
+
+
+	bool ParseLines(ObjStreamParser* parser, const char* begin, const char* end, uint32* lineNumber)
+	{
+		for (const char* lineBegin = begin; lineBegin < end; (*lineNumber)++)
+		{
+			const char* lineEnd = static_cast<const char*>(std::memchr(lineBegin, '\n', size_t(end - lineBegin)));
+			lineEnd = lineEnd ? lineEnd : end;
+
+			if (!parser->ParseLine(lineBegin, lineEnd))
+			{
+				XTEST_ASSERT(false, L"malformed obj record at line %u", *lineNumber);
+				return false;
+			}
+			lineBegin = lineEnd + 1;
+		}
+		return true;
+	}
+
+
+
+	// a face corner with its indices already resolved against the whole file
+	struct ObjCorner
+	{
+		uint32 position;
+		uint32 uv;
+		uint32 normal;
+	};
+
+
+	// an o/g record, the faces from faceIndex on belong to the named shape
+	struct ObjShapeBreak
+	{
+		uint32 faceIndex;
+		std::string name;
+	};
+
+
+	// a line aligned piece of the file, counted and then parsed by a single worker
+	struct ObjChunk
+	{
+		const char* begin = nullptr;
+		const char* end = nullptr;
+		uint32 firstLineNumber = 1;
+		uint32 lineCount = 0;
+		uint32 positionBase = 0;
+		uint32 positionCount = 0;
+		uint32 normalBase = 0;
+		uint32 normalCount = 0;
+		uint32 uvBase = 0;
+		uint32 uvCount = 0;
+
+		std::vector<ObjCorner> corners;
+		std::vector<uint32> faceCornerCounts;
+		std::vector<ObjShapeBreak> shapeBreaks;
+		uint32 errorLineNumber = 0;
+	};
+
+
+	// consecutive faces of a shape inside a single chunk
+	struct ObjShapeSpan
+	{
+		uint32 chunkIndex;
+		uint32 firstFace;
+		uint32 endFace;
+		uint32 firstCorner;
+	};
+
+
+	struct ObjShape
+	{
+		std::string name;
+		std::vector<ObjShapeSpan> spans;
+	};
+
+
+	struct ObjPools
+	{
+		std::vector<float> positions;
+		std::vector<float> normals;
+		std::vector<float> uvs;
+	};
+
+
+	struct ObjWeldedShape
+	{
+		std::vector<MeshData::Vertex> vertices;
+		std::vector<uint32> indices;
+	};
+
+
+	std::vector<ObjChunk> SplitInChunks(const char* data, uint64 byteSize, uint32 chunkCount)
+	{
+		const char* end = data + byteSize;
+		const uint64 chunkByteSize = std::max(byteSize / chunkCount, uint64(kObjMinParallelChunkByteSize));
+
+		std::vector<ObjChunk> chunks;
+		for (const char* chunkBegin = data; chunkBegin < end;)
+		{
+			// every chunk ends right after a new line
+			const char* chunkEnd = chunkBegin + std::min(chunkByteSize, uint64(end - chunkBegin));
+			if (chunkEnd < end)
+			{
+				const char* newLine = static_cast<const char*>(std::memchr(chunkEnd, '\n', size_t(end - chunkEnd)));
+				chunkEnd = newLine ? newLine + 1 : end;
+			}
+
+			ObjChunk chunk;
+			chunk.begin = chunkBegin;
+			chunk.end = chunkEnd;
+			chunks.push_back(std::move(chunk));
+			chunkBegin = chunkEnd;
+		}
+		return chunks;
+	}
+
+
+	// first pass: how many lines and attributes are in the chunk, so that every chunk knows
+	// where its attributes go in the pools and can resolve relative indices on its own
+	void CountRecords(ObjChunk* chunk)
+	{
+		for (const char* lineBegin = chunk->begin; lineBegin < chunk->end; chunk->lineCount++)
+		{
+			const char* lineEnd = static_cast<const char*>(std::memchr(lineBegin, '\n', size_t(chunk->end - lineBegin)));
+			lineEnd = lineEnd ? lineEnd : chunk->end;
+
+			const char* cursor = SkipSpaces(lineBegin, lineEnd);
+			if (IsRecord(cursor, lineEnd, "v"))
+			{
+				chunk->positionCount++;
+			}
+			else if (IsRecord(cursor, lineEnd, "vn"))
+			{
+				chunk->normalCount++;
+			}
+			else if (IsRecord(cursor, lineEnd, "vt"))
+			{
+				chunk->uvCount++;
+			}
+			lineBegin = lineEnd + 1;
+		}
+	}
+
+
+	bool ParseFloatsInto(const char* cursor, const char* end, uint32 count, float* values)
+	{
+		// optional trailing values (w, vertex colors) are ignored
+		for (uint32 valueIndex = 0; valueIndex < count; valueIndex++)
+		{
+			if (!ParseFloat(&cursor, end, &values[valueIndex]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	// second pass: attributes are written straight in their final place in the pools,
+	// faces are kept as resolved corners and welded later per shape
+	bool ParseChunk(ObjChunk* chunk, ObjPools* pools)
+	{
+		uint32 positionCount = 0;
+		uint32 normalCount = 0;
+		uint32 uvCount = 0;
+		std::vector<ObjCorner> faceCorners;
+
+		uint32 lineNumber = chunk->firstLineNumber;
+		for (const char* lineBegin = chunk->begin; lineBegin < chunk->end; lineNumber++)
+		{
+			const char* lineEnd = static_cast<const char*>(std::memchr(lineBegin, '\n', size_t(chunk->end - lineBegin)));
+			lineEnd = lineEnd ? lineEnd : chunk->end;
+
+			bool parsed = true;
+			const char* cursor = SkipSpaces(lineBegin, lineEnd);
+			if (IsRecord(cursor, lineEnd, "v"))
+			{
+				parsed = ParseFloatsInto(cursor + 1, lineEnd, 3, &pools->positions[3 * size_t(chunk->positionBase + positionCount++)]);
+			}
+			else if (IsRecord(cursor, lineEnd, "vn"))
+			{
+				parsed = ParseFloatsInto(cursor + 2, lineEnd, 3, &pools->normals[3 * size_t(chunk->normalBase + normalCount++)]);
+			}
+			else if (IsRecord(cursor, lineEnd, "vt"))
+			{
+				parsed = ParseFloatsInto(cursor + 2, lineEnd, 2, &pools->uvs[2 * size_t(chunk->uvBase + uvCount++)]);
+			}
+			else if (IsRecord(cursor, lineEnd, "f"))
+			{
+				faceCorners.clear();
+				for (cursor = SkipSpaces(cursor + 1, lineEnd); parsed && cursor < lineEnd; cursor = SkipSpaces(cursor, lineEnd))
+				{
+					int64 positionIndex;
+					int64 uvIndex;
+					int64 normalIndex;
+					ObjCorner corner = { kObjMissingIndex, kObjMissingIndex, kObjMissingIndex };
+
+					// only the attributes defined so far can be referenced, as in the serial parser
+					parsed = ParseCorner(&cursor, lineEnd, &positionIndex, &uvIndex, &normalIndex)
+						&& ResolveIndex(positionIndex, chunk->positionBase + positionCount, &corner.position)
+						&& (uvIndex == 0 || ResolveIndex(uvIndex, chunk->uvBase + uvCount, &corner.uv))
+						&& (normalIndex == 0 || ResolveIndex(normalIndex, chunk->normalBase + normalCount, &corner.normal));
+					faceCorners.push_back(corner);
+				}
+
+				// faces with less than 3 vertices are skipped
+				if (parsed && faceCorners.size() >= 3)
+				{
+					chunk->corners.insert(chunk->corners.end(), faceCorners.begin(), faceCorners.end());
+					chunk->faceCornerCounts.push_back(uint32(faceCorners.size()));
+				}
+			}
+			else if (IsRecord(cursor, lineEnd, "o") || IsRecord(cursor, lineEnd, "g"))
+			{
+				chunk->shapeBreaks.push_back(ObjShapeBreak{ uint32(chunk->faceCornerCounts.size()), ParseShapeName(cursor + 1, lineEnd) });
+			}
+
+			if (!parsed)
+			{
+				chunk->errorLineNumber = lineNumber;
+				return false;
+			}
+			lineBegin = lineEnd + 1;
+		}
+		return true;
+	}
+
+
+	// follows the o/g records across the chunks, shapes without faces are dropped as in the serial parser
+	std::vector<ObjShape> CollectShapes(const std::vector<ObjChunk>& chunks)
+	{
+		std::vector<ObjShape> shapes;
+		ObjShape currentShape;
+
+		for (uint32 chunkIndex = 0; chunkIndex < uint32(chunks.size()); chunkIndex++)
+		{
+			const ObjChunk& chunk = chunks[chunkIndex];
+			uint32 faceIndex = 0;
+			uint32 cornerIndex = 0;
+
+			for (size_t breakIndex = 0; breakIndex <= chunk.shapeBreaks.size(); breakIndex++)
+			{
+				const bool chunkTail = breakIndex == chunk.shapeBreaks.size();
+				const uint32 endFace = chunkTail ? uint32(chunk.faceCornerCounts.size()) : chunk.shapeBreaks[breakIndex].faceIndex;
+				if (endFace > faceIndex)
+				{
+					currentShape.spans.push_back(ObjShapeSpan{ chunkIndex, faceIndex, endFace, cornerIndex });
+					for (; faceIndex < endFace; faceIndex++)
+					{
+						cornerIndex += chunk.faceCornerCounts[faceIndex];
+					}
+				}
+
+				if (!chunkTail)
+				{
+					if (!currentShape.spans.empty())
+					{
+						shapes.push_back(std::move(currentShape));
+					}
+					currentShape = ObjShape();
+					currentShape.name = chunk.shapeBreaks[breakIndex].name;
+				}
+			}
+		}
+
+		if (!currentShape.spans.empty())
+		{
+			shapes.push_back(std::move(currentShape));
+		}
+		return shapes;
+	}
+
+
+	ObjWeldedShape WeldShape(const ObjShape& shape, const std::vector<ObjChunk>& chunks, const ObjPools& pools, float weldEpsilon)
+	{
+		ObjWeldedShape weldedShape;
+		VertexWeldTable weldTable(&weldedShape.vertices, 0, weldEpsilon);
+		std::vector<uint32> faceIndices;
+
+		for (const ObjShapeSpan& span : shape.spans)
+		{
+			const ObjChunk& chunk = chunks[span.chunkIndex];
+			const ObjCorner* corner = &chunk.corners[span.firstCorner];
+			for (uint32 faceIndex = span.firstFace; faceIndex < span.endFace; faceIndex++)
+			{
+				faceIndices.clear();
+				for (uint32 faceCornerIndex = 0; faceCornerIndex < chunk.faceCornerCounts[faceIndex]; faceCornerIndex++, corner++)
+				{
+					MeshData::Vertex vertex = { { 0.f, 0.f, 0.f },{ 0.f, 0.f, 0.f },{ 0.f, 0.f, 0.f },{ 0.f, 0.f } };
+					const float* position = &pools.positions[3 * size_t(corner->position)];
+					vertex.position = { position[0], position[1], position[2] };
+
+					if (corner->normal != kObjMissingIndex)
+					{
+						const float* normal = &pools.normals[3 * size_t(corner->normal)];
+						vertex.normal = { normal[0], normal[1], normal[2] };
+					}
+
+					if (corner->uv != kObjMissingIndex)
+					{
+						const float* uv = &pools.uvs[2 * size_t(corner->uv)];
+						vertex.uv = { uv[0], uv[1] };
+					}
+
+					faceIndices.push_back(weldTable.FindOrAdd(vertex));
+				}
+
+				for (size_t cornerIndex = 2; cornerIndex < faceIndices.size(); cornerIndex++)
+				{
+					weldedShape.indices.push_back(faceIndices[0]);
+					weldedShape.indices.push_back(faceIndices[cornerIndex - 1]);
+					weldedShape.indices.push_back(faceIndices[cornerIndex]);
+				}
+			}
+		}
+
+		return weldedShape;
+	}
+
+
+	bool ReadObjParallel(const char* data, uint64 byteSize, const ObjReadSettings& settings, std::vector<GPFMeshHeader>* meshHeaders, MeshData* meshData)
+	{
+		const uint32 threadCount = settings.threadCount == 0 ? xtest::common::HardwareThreadCount() : settings.threadCount;
+
+		// more chunks than threads, lines are not uniformly expensive (faces vs comments)
+		std::vector<ObjChunk> chunks = SplitInChunks(data, byteSize, threadCount * kObjChunksPerThread);
+		const uint32 chunkCount = uint32(chunks.size());
+
+		xtest::common::ParallelFor(chunkCount, threadCount, [&](uint32 chunkIndex)
+		{
+			CountRecords(&chunks[chunkIndex]);
+		});
+
+		uint32 lineCount = 0;
+		uint64 positionCount = 0;
+		uint64 normalCount = 0;
+		uint64 uvCount = 0;
+		for (ObjChunk& chunk : chunks)
+		{
+			chunk.firstLineNumber = lineCount + 1;
+			chunk.positionBase = uint32(positionCount);
+			chunk.normalBase = uint32(normalCount);
+			chunk.uvBase = uint32(uvCount);
+			lineCount += chunk.lineCount;
+			positionCount += chunk.positionCount;
+			normalCount += chunk.normalCount;
+			uvCount += chunk.uvCount;
+		}
+
+		if (positionCount > UINT32_MAX || normalCount > UINT32_MAX || uvCount > UINT32_MAX)
+		{
+			return false;
+		}
+
+		ObjPools pools;
+		pools.positions.resize(size_t(positionCount) * 3);
+		pools.normals.resize(size_t(normalCount) * 3);
+		pools.uvs.resize(size_t(uvCount) * 2);
+
+		xtest::common::ParallelFor(chunkCount, threadCount, [&](uint32 chunkIndex)
+		{
+			ParseChunk(&chunks[chunkIndex], &pools);
+		});
+
+		for (const ObjChunk& chunk : chunks)
+		{
+			if (chunk.errorLineNumber != 0)
+			{
+				XTEST_ASSERT(false, L"malformed obj record at line %u", chunk.errorLineNumber);
+				return false;
+			}
+		}
+
+
+		// shapes are welded independently and stitched in file order, so the result is the same of the serial parser
+		const std::vector<ObjShape> shapes = CollectShapes(chunks);
+		std::vector<ObjWeldedShape> weldedShapes(shapes.size());
+		xtest::common::ParallelFor(uint32(shapes.size()), threadCount, [&](uint32 shapeIndex)
+		{
+			weldedShapes[shapeIndex] = WeldShape(shapes[shapeIndex], chunks, pools, settings.weldEpsilon);
+		});
+
+		size_t totalVertexCount = meshData->vertices.size();
+		size_t totalIndexCount = meshData->indices.size();
+		for (const ObjWeldedShape& weldedShape : weldedShapes)
+		{
+			totalVertexCount += weldedShape.vertices.size();
+			totalIndexCount += weldedShape.indices.size();
+		}
+		meshData->vertices.reserve(totalVertexCount);
+		meshData->indices.reserve(totalIndexCount);
+
+		for (size_t shapeIndex = 0; shapeIndex < shapes.size(); shapeIndex++)
+		{
+			ObjWeldedShape& weldedShape = weldedShapes[shapeIndex];
+			const std::string& shapeName = shapes[shapeIndex].name;
+
+			GPFMeshHeader meshHeader;
+			std::memcpy(&meshHeader.name, shapeName.c_str(), std::min(sizeof(meshHeader.name) - 1, shapeName.size()));
+			meshHeader.vertexCount = uint32(weldedShape.vertices.size());
+			meshHeader.indexCount = uint32(weldedShape.indices.size());
+			meshHeader.vertexOffset = uint32(meshData->vertices.size());
+			meshHeader.indexOffset = uint32(meshData->indices.size());
+			meshHeaders->push_back(meshHeader);
+
+			meshData->vertices.insert(meshData->vertices.end(), weldedShape.vertices.begin(), weldedShape.vertices.end());
+			meshData->indices.insert(meshData->indices.end(), weldedShape.indices.begin(), weldedShape.indices.end());
+
+			// release the shape memory as soon as possible
+			weldedShape = ObjWeldedShape();
+		}
+
+		return true;
+	}
+}
+
+
+bool xtest::file::ReadObj(const char* data, uint64 byteSize, const ObjReadSettings& settings, std::vector<GPFMeshHeader>* meshHeaders, MeshData* meshData)
+{
+	XTEST_ASSERT(meshHeaders && meshData);
+
+	if (settings.threadCount != 1)
+	{
+		return ReadObjParallel(data, byteSize, settings, meshHeaders, meshData);
+	}
+
+	ObjStreamParser parser(settings, meshHeaders, meshData);
+	uint32 lineNumber = 1;
+	if (!ParseLines(&parser, data, data + byteSize, &lineNumber))
+	{
+		return false;
+	}
+
+	parser.FlushShape();
+	return true;
+}
+
+
+bool xtest::file::ReadObj(const std::wstring& filePath, const ObjReadSettings& settings, std::vector<GPFMeshHeader>* meshHeaders, MeshData* meshData)
+{
+	XTEST_ASSERT(meshHeaders && meshData);
+
+	std::ifstream fileStream(filePath, std::ifstream::binary);
+	XTEST_ASSERT(fileStream.is_open(), L"unable to open the file:'%s'", filePath.c_str());
+	if (!fileStream.is_open())
+	{
+		return false;
+	}
+
+	ObjStreamParser parser(settings, meshHeaders, meshData);
+	uint32 lineNumber = 1;
+
+	// the chunk only grows if a single line doesn't fit in it
+	std::vector<char> chunk(kObjChunkByteSize);
+	size_t carriedByteSize = 0;
+	for (bool lastChunk = false; !lastChunk;)
+	{
+		fileStream.read(chunk.data() + carriedByteSize, std::streamsize(chunk.size() - carriedByteSize));
+		const size_t availableByteSize = carriedByteSize + size_t(fileStream.gcount());
+		lastChunk = !fileStream;
+
+		// only whole lines are parsed, the incomplete tail is moved in front of the next chunk
+		size_t parsedByteSize = availableByteSize;
+		if (!lastChunk)
+		{
+			while (parsedByteSize > 0 && chunk[parsedByteSize - 1] != '\n')
+			{
+				parsedByteSize--;
+			}
+
+			if (parsedByteSize == 0)
+			{
+				carriedByteSize = availableByteSize;
+				chunk.resize(chunk.size() * 2);
+				continue;
+			}
+		}
+
+		if (!ParseLines(&parser, chunk.data(), chunk.data() + parsedByteSize, &lineNumber))
+		{
+			return false;
+		}
+
+		carriedByteSize = availableByteSize - parsedByteSize;
+		std::memmove(chunk.data(), chunk.data() + parsedByteSize, carriedByteSize);
+	}
+
+	parser.FlushShape();
+	return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <file/gpf_format.h>
+#include <mesh/mesh_format.h>
+
+
+namespace xtest {
+namespace file {
+
+	struct ObjReadSettings
+	{
+		// see ObjBakeSettings::weldEpsilon
+		float weldEpsilon = 0.f;
+
+		// threads parsing an obj file in memory, 0 means one per hardware thread, 1 parses serially.
+		// the result is the same whatever the thread count is.
+		uint32 threadCount = 1;
+	};
+
+
+	// parses an obj file in a single pass, faces are triangulated and welded as soon as they are read,
+	// straight into meshData, so the only other memory used is the v/vn/vt pools.
+	// every o/g record with faces becomes a mesh header, indices are local to their mesh as in gpf files.
+	// polygons are fan triangulated, missing normals and uvs are set to zero.
+	// with more than one thread the data is split in line aligned chunks that are first counted,
+	// to know where their v/vn/vt records go, and then parsed concurrently; the shapes are welded
+	// concurrently as well. this needs the whole file in memory and keeps every face corner until
+	// the shapes are welded, so it uses more memory than the serial parser.
+	bool ReadObj(const char* data, uint64 byteSize, const ObjReadSettings& settings, std::vector<GPFMeshHeader>* meshHeaders, mesh::MeshData* meshData);
+
+	// same as above, the file is read serially in fixed size chunks so it is never entirely in memory
+	bool ReadObj(const std::wstring& filePath, const ObjReadSettings& settings, std::vector<GPFMeshHeader>* meshHeaders, mesh::MeshData* meshData);
+
+} // file
+} // xtest
+
@@ -0,0 +1,189 @@
+#include "stdafx.h"
+#include "scene_reader.h"
+#include <math/math_utils.h>
+#include <fstream>
+
+
+using namespace DirectX;
+using xtest::file::SceneDesc;
+using xtest::file::SceneObjectDesc;
+using xtest::file::SceneTransformDesc;
+
+
+namespace
+{
+	bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+
+	const char* SkipSpaces(const char* cursor, const char* end)
+	{
+		while (cursor < end && IsSpace(*cursor))
+		{
+			cursor++;
+		}
+		return cursor;
+	}
+
+
+	// the characters up to the next space, false if there are none
+	bool ParseToken(const char** cursor, const char* end, std::string* token)
+	{
+		const char* begin = SkipSpaces(*cursor, end);
+		const char* current = begin;
+		while (current < end && !IsSpace(*current))
+		{
+			current++;
+		}
+
+		token->assign(begin, current);
+		*cursor = current;
+		return current != begin;
+	}
+
+
+	// the input is not null terminated, the token is copied before it is converted
+	bool ParseFloat(const char** cursor, const char* end, float* value)
+	{
+		std::string token;
+		if (!ParseToken(cursor, end, &token))
+		{
+			return false;
+		}
+
+		char* tokenEnd = nullptr;
+		*value = std::strtof(token.c_str(), &tokenEnd);
+		return tokenEnd == token.c_str() + token.size();
+	}
+
+
+	// none of the values or all of them
+	bool ParseOptionalFloat3(const char** cursor, const char* end, XMFLOAT3* value, bool* isFound)
+	{
+		*isFound = SkipSpaces(*cursor, end) < end;
+		return !*isFound || (ParseFloat(cursor, end, &value->x) && ParseFloat(cursor, end, &value->y) && ParseFloat(cursor, end, &value->z));
+	}
+
+
+	bool ParseNames(const char** cursor, const char* end, SceneObjectDesc* object)
+	{
+		return ParseToken(cursor, end, &object->mesh) && ParseToken(cursor, end, &object->material);
+	}
+
+
+	bool ParseTransform(const char* cursor, const char* end, SceneTransformDesc* transform)
+	{
+		if (!ParseFloat(&cursor, end, &transform->position.x) || !ParseFloat(&cursor, end, &transform->position.y) || !ParseFloat(&cursor, end, &transform->position.z))
+		{
+			return false;
+		}
+
+		bool isFound = false;
+		if (!ParseOptionalFloat3(&cursor, end, &transform->rotation, &isFound))
+		{
+			return false;
+		}
+		if (isFound && !ParseOptionalFloat3(&cursor, end, &transform->scale, &isFound))
+		{
+			return false;
+		}
+
+		return SkipSpaces(cursor, end) == end;
+	}
+
+
+	// the shapes refer to the last object, which must be one of this file: the ones before firstObject are not
+	bool ParseRecord(const char* cursor, const char* end, size_t firstObject, SceneDesc* scene)
+	{
+		std::string keyword;
+		SceneObjectDesc object;
+		if (!ParseToken(&cursor, end, &keyword) || !ParseNames(&cursor, end, &object))
+		{
+			return false;
+		}
+
+		if (keyword == "object")
+		{
+			SceneTransformDesc transform;
+			if (!ParseTransform(cursor, end, &transform))
+			{
+				return false;
+			}
+			object.transform = uint32(scene->transforms.size());
+			scene->transforms.push_back(transform);
+		}
+		else if (keyword == "shape")
+		{
+			if (SkipSpaces(cursor, end) != end || scene->objects.size() == firstObject)
+			{
+				return false;
+			}
+			object.transform = scene->objects.back().transform;
+		}
+		else
+		{
+			return false;
+		}
+
+		scene->objects.push_back(std::move(object));
+		return true;
+	}
+}
+
+
+XMMATRIX SceneTransformDesc::World() const
+{
+	const XMMATRIX S = XMMatrixScaling(scale.x, scale.y, scale.z);
+	const XMMATRIX R = XMMatrixRotationRollPitchYaw(math::ToRadians(rotation.x), math::ToRadians(rotation.y), math::ToRadians(rotation.z));
+	const XMMATRIX T = XMMatrixTranslation(position.x, position.y, position.z);
+	return XMMatrixMultiply(XMMatrixMultiply(S, R), T);
+}
+
+
+bool xtest::file::ReadScene(const char* data, uint64 byteSize, SceneDesc* scene)
+{
+	XTEST_ASSERT(scene);
+	XTEST_ASSERT(data || byteSize == 0);
+
+	const size_t firstObject = scene->objects.size();
+	const char* end = data + byteSize;
+	uint32 lineNumber = 1;
+	for (const char* lineBegin = data; lineBegin < end; lineNumber++)
+	{
+		const char* lineEnd = std::find(lineBegin, end, '\n');
+		const char* cursor = SkipSpaces(lineBegin, lineEnd);
+
+		if (cursor < lineEnd && *cursor != '#')
+		{
+			if (!ParseRecord(cursor, lineEnd, firstObject, scene))
+			{
+				XTEST_ASSERT(false, L"malformed scene record at line %u", lineNumber);
+				return false;
+			}
+		}
+
+		lineBegin = lineEnd < end ? lineEnd + 1 : end;
+	}
+
+	return true;
+}
+
+
+bool xtest::file::ReadScene(const std::wstring& filePath, SceneDesc* scene)
+{
+	XTEST_ASSERT(scene);
+
+	std::ifstream fileStream(filePath, std::ifstream::binary);
+	XTEST_ASSERT(fileStream.is_open(), L"unable to open the file:'%s'", filePath.c_str());
+	if (!fileStream.is_open())
+	{
+		return false;
+	}
+
+	// scene files are small enough to be parsed in memory at once
+	std::vector<char> data((std::istreambuf_iterator<char>(fileStream)), std::istreambuf_iterator<char>());
+	return ReadScene(data.data(), data.size(), scene);
+}
+
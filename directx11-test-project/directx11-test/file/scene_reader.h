@@ -0,0 +1,48 @@
+#pragma once
+
+
+namespace xtest {
+namespace file {
+
+	// where an object of a scene file is, shared by the shapes that follow it in the file
+	struct SceneTransformDesc
+	{
+		DirectX::XMFLOAT3 position = { 0.f, 0.f, 0.f };
+		DirectX::XMFLOAT3 rotation = { 0.f, 0.f, 0.f };	// pitch, yaw and roll in degrees
+		DirectX::XMFLOAT3 scale = { 1.f, 1.f, 1.f };
+
+		// scale, then rotation, then translation
+		DirectX::XMMATRIX World() const;
+	};
+
+
+	// an object of a scene file, the mesh and the material are names the application resolves
+	struct SceneObjectDesc
+	{
+		std::string mesh;
+		std::string material;
+		uint32 transform = 0;	// the index in SceneDesc::transforms
+	};
+
+
+	struct SceneDesc
+	{
+		std::vector<SceneTransformDesc> transforms;
+		std::vector<SceneObjectDesc> objects;
+	};
+
+
+	/**
+	Parses a scene file, a text file with an object on every line:
+		object <mesh> <material> <x> <y> <z> [<pitch> <yaw> <roll> [<scale x> <scale y> <scale z>]]
+		shape <mesh> <material>
+	An object line has a transform of its own, a shape line is one more object drawn with the transform of the
+	object line before it. The names have no spaces, the angles are in degrees. Empty lines and the ones starting
+	with # are skipped. The objects and the transforms are appended in the order of the file.
+	*/
+	bool ReadScene(const char* data, uint64 byteSize, SceneDesc* scene);
+	bool ReadScene(const std::wstring& filePath, SceneDesc* scene);
+
+} // file
+} // xtest
+
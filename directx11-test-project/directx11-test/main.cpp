@@ -1,9 +1,33 @@
 #include "stdafx.h"
 #include <demo/box_demo/box_demo_app.h>
 #include <demo/textures_demo/textures_demo_app.h>
+#include <file/file_utils.h>
+#include <file/gpf_benchmark.h>
+#include <file/obj_bake_benchmark.h>
+#include <mesh/mesh_generator_benchmark.h>
+#include <mesh/vertex_codec_benchmark.h>
+#include <mesh/vertex_weld_benchmark.h>
+#include <render/culling_benchmark.h>
+#include <render/draw_queue_benchmark.h>
+#include <render/object_transforms_benchmark.h>
+#include <scene/scene_benchmark.h>
+#include <test/unit_tests.h>
+#include <fstream>
 
 
 using namespace xtest::application;
+using xtest::file::GPFBenchmarkResult;
+using xtest::file::ObjBakeBenchmarkResult;
+using xtest::file::ObjImporter;
+using xtest::mesh::MeshGeneratorBenchmarkResult;
+using xtest::mesh::VertexCodecBenchmarkResult;
+using xtest::mesh::VertexWeldBenchmarkResult;
+using xtest::render::CullingBenchmarkResult;
+using xtest::render::DrawQueueBenchmarkResult;
+using xtest::render::ObjectTransformsBenchmarkResult;
+using xtest::scene::SceneBenchmarkResult;
+using xtest::scene::SceneBenchmarkSettings;
+using xtest::test::UnitTestReport;
 
 
 int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
@@ -12,9 +36,180 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 					 _In_ int	   nCmdShow)
 {
 	UNREFERENCED_PARAMETER(hPrevInstance);
-	UNREFERENCED_PARAMETER(lpCmdLine);
 	UNREFERENCED_PARAMETER(nCmdShow);
 
+	// -scene-benchmark <scene file>: runs the frames of the scene without a window or a device, the times are
+	// written in a text file next to the scene
+	const std::wstring commandLine(lpCmdLine);
+	const std::wstring benchmarkOption(L"-scene-benchmark ");
+	if (commandLine.compare(0, benchmarkOption.size(), benchmarkOption) == 0)
+	{
+		std::wstring sceneFilePath = commandLine.substr(benchmarkOption.size());
+		sceneFilePath.erase(std::remove(sceneFilePath.begin(), sceneFilePath.end(), L'"'), sceneFilePath.end());
+
+		const SceneBenchmarkResult result = xtest::scene::RunSceneBenchmark(sceneFilePath, SceneBenchmarkSettings());
+		std::wofstream report(sceneFilePath + L".benchmark.txt");
+		report << L"objects: " << result.objectCount << L", visible: " << result.visibleCount << L", draws: " << result.drawCount << std::endl;
+		report << L"frame: " << result.frameMillis << L" ms, transforms: " << result.transformMillis << L" ms, culling: " << result.cullMillis
+			<< L" ms, submission: " << result.submitMillis << L" ms" << std::endl;
+		return 0;
+	}
+
+	// -unit-tests: runs the unit tests without a window or a device, the report is written in unit_tests.txt and
+	// the exit code is the number of failed checks
+	if (commandLine == L"-unit-tests")
+	{
+		const UnitTestReport unitTestReport = xtest::test::RunUnitTests();
+		std::ofstream report(L"unit_tests.txt");
+		report << unitTestReport.Summary();
+		return int(unitTestReport.FailureCount());
+	}
+
+	// -culling-benchmark: culls 10k, 100k and 1M objects, the times are written in culling.benchmark.txt
+	if (commandLine == L"-culling-benchmark")
+	{
+		std::wofstream report(L"culling.benchmark.txt");
+		for (uint32 objectCount : { 10000u, 100000u, 1000000u })
+		{
+			const CullingBenchmarkResult result = xtest::render::RunCullingBenchmark(objectCount);
+			report << L"objects: " << result.objectCount << L", visible: " << result.visibleSphereCount << L" spheres, " << result.visibleBoxCount
+				<< L" boxes; spheres: " << result.sphereMillis << L" ms, boxes: " << result.boxMillis << L" ms" << std::endl;
+		}
+		return 0;
+	}
+
+	// -gpf-benchmark: writes a synthetic gpf file of about 400MB and loads it with ReadGPF and with MapGPF, the times
+	// and the bytes copied are written in gpf.benchmark.txt
+	if (commandLine == L"-gpf-benchmark")
+	{
+		const GPFBenchmarkResult result = xtest::file::RunGPFBenchmark(L"gpf_benchmark.gpf");
+		std::wofstream report(L"gpf.benchmark.txt");
+		report << L"file: " << result.fileByteSize << L" bytes, meshes: " << result.meshCount << L", vertices: " << result.vertexCount
+			<< L", indices: " << result.indexCount << std::endl;
+		report << L"ReadGPF: " << result.readMillis << L" ms, " << result.readCopiedBytes << L" bytes copied" << std::endl;
+		report << L"MapGPF: " << result.mapMillis << L" ms, " << result.mapCopiedBytes << L" bytes copied, first read of every page: "
+			<< result.mapTouchMillis << L" ms" << std::endl;
+		return 0;
+	}
+
+	// -vertex-codec-benchmark: encodes and decodes the full and the packed vertices of torus knots of growing detail, the
+	// ratios and the times are written in vertex_codec.benchmark.txt
+	if (commandLine == L"-vertex-codec-benchmark")
+	{
+		std::wofstream report(L"vertex_codec.benchmark.txt");
+		for (uint32 detailsCount : { 250u, 1000u, 2000u })
+		{
+			for (const VertexCodecBenchmarkResult& result : xtest::mesh::RunVertexCodecBenchmark(detailsCount))
+			{
+				report << L"vertices: " << result.vertexCount << L" of " << result.vertexStride << L" bytes, " << result.rawByteSize << L" -> "
+					<< result.encodedByteSize << L" bytes, ratio: " << result.ratio << L"; encode: " << result.encodeMillis << L" ms, decode: "
+					<< result.decodeMillis << L" ms (" << result.decodeMBPerSecond << L" MB/s), parallel decode: " << result.parallelDecodeMillis
+					<< L" ms (" << result.parallelDecodeMBPerSecond << L" MB/s)" << std::endl;
+			}
+		}
+		return 0;
+	}
+
+	// -generator-benchmark: generates the sphere, the torus and the torus knot at growing detail on a single thread
+	// and on all of them, the times are written in generator.benchmark.txt
+	if (commandLine == L"-generator-benchmark")
+	{
+		std::wofstream report(L"generator.benchmark.txt");
+		for (uint32 detailsCount : { 250u, 1000u, 2000u })
+		{
+			for (const MeshGeneratorBenchmarkResult& result : xtest::mesh::RunMeshGeneratorBenchmark(detailsCount))
+			{
+				report << result.meshName << L" " << result.detailsCount << L"x" << result.detailsCount << L", vertices: " << result.vertexCount
+					<< L", indices: " << result.indexCount << L"; single thread: " << result.millis << L" ms, parallel: " << result.parallelMillis
+					<< L" ms" << std::endl;
+			}
+		}
+		return 0;
+	}
+
+	// -weld-benchmark <gpf file>: welds the triangle corners of the meshes of the file, then those of a sphere and a
+	// torus knot of a million triangles, with VertexWeldTable and with the std::unordered_map it replaced. the times
+	// are written in a text file next to the gpf one
+	const std::wstring weldBenchmarkOption(L"-weld-benchmark ");
+	if (commandLine.compare(0, weldBenchmarkOption.size(), weldBenchmarkOption) == 0)
+	{
+		std::wstring gpfFilePath = commandLine.substr(weldBenchmarkOption.size());
+		gpfFilePath.erase(std::remove(gpfFilePath.begin(), gpfFilePath.end(), L'"'), gpfFilePath.end());
+
+		const std::wstring meshName = gpfFilePath.substr(gpfFilePath.find_last_of(L"\\/") + 1);
+		std::wofstream report(gpfFilePath + L".weld.benchmark.txt");
+		for (const VertexWeldBenchmarkResult& result : xtest::mesh::RunVertexWeldBenchmark(xtest::file::ReadGPF(gpfFilePath), meshName))
+		{
+			report << result.meshName << L", corners: " << result.cornerCount << L", vertices: " << result.vertexCount << L"; weld table: "
+				<< result.weldTableMillis << L" ms, with epsilon: " << result.epsilonWeldTableMillis << L" ms, std::unordered_map: "
+				<< result.unorderedMapMillis << L" ms, largest bucket: " << result.largestBucketSize << std::endl;
+		}
+		return 0;
+	}
+
+	// -draw-queue-benchmark: sorts and submits 10k, 100k and 1M draws to a recording backend, the times and the binds
+	// are written in draw_queue.benchmark.txt
+	if (commandLine == L"-draw-queue-benchmark")
+	{
+		std::wofstream report(L"draw_queue.benchmark.txt");
+		for (uint32 drawCount : { 10000u, 100000u, 1000000u })
+		{
+			const DrawQueueBenchmarkResult result = xtest::render::RunDrawQueueBenchmark(drawCount);
+			report << L"draws: " << result.drawCount << L", binds: " << result.bindCount << L", elided: " << result.elidedBindCount
+				<< L", unsorted binds: " << result.unsortedBindCount << L"; radix sort: " << result.sortMillis << L" ms, std::stable_sort: "
+				<< result.stableSortMillis << L" ms, execute: " << result.executeMillis << L" ms" << std::endl;
+		}
+		return 0;
+	}
+
+	// -transforms-benchmark: computes the matrices of 1k, 100k and 1M objects one at a time and in batches, the
+	// times are written in transforms.benchmark.txt
+	if (commandLine == L"-transforms-benchmark")
+	{
+		std::wofstream report(L"transforms.benchmark.txt");
+		for (uint32 objectCount : { 1000u, 100000u, 1000000u })
+		{
+			const ObjectTransformsBenchmarkResult result = xtest::render::RunObjectTransformsBenchmark(objectCount);
+			report << L"objects: " << result.objectCount << L"; per object: " << result.perObjectMillis << L" ms, batch: " << result.batchMillis
+				<< L" ms, parallel batch: " << result.parallelBatchMillis << L" ms" << std::endl;
+		}
+		return 0;
+	}
+
+	// -obj-benchmark <streaming|mapped|tinyobj> <obj file>: bakes the obj file with the importer, the throughput and
+	// the peak memory are written in a text file next to the obj one. the peak memory of a process never goes down,
+	// every importer is benchmarked by its own run
+	const std::wstring objBenchmarkOption(L"-obj-benchmark ");
+	if (commandLine.compare(0, objBenchmarkOption.size(), objBenchmarkOption) == 0)
+	{
+		const std::wstring arguments = commandLine.substr(objBenchmarkOption.size());
+		const std::wstring importerName = arguments.substr(0, arguments.find(L' '));
+		std::wstring objFilePath = arguments.substr(std::min(importerName.size() + 1, arguments.size()));
+		objFilePath.erase(std::remove(objFilePath.begin(), objFilePath.end(), L'"'), objFilePath.end());
+
+		ObjImporter importer = ObjImporter::streaming;
+		if (importerName == L"mapped")
+		{
+			importer = ObjImporter::mapped;
+		}
+		else if (importerName == L"tinyobj")
+		{
+			importer = ObjImporter::tinyobj;
+		}
+		else if (importerName != L"streaming")
+		{
+			return 1;
+		}
+
+		const ObjBakeBenchmarkResult result = xtest::file::RunObjBakeBenchmark(objFilePath, importer);
+		std::wofstream report(objFilePath + L"." + importerName + L".benchmark.txt");
+		report << importerName << L", file: " << result.fileByteSize << L" bytes, threads: " << result.threadCount << L", vertices: "
+			<< result.vertexCount << L", indices: " << result.indexCount << (result.succeeded ? L"" : L", failed") << std::endl;
+		report << L"parse: " << result.parseMillis << L" ms (" << result.parseMBPerSecond << L" MB/s), bake: " << result.bakeMillis << L" ms ("
+			<< result.bakeMBPerSecond << L" MB/s), peak working set growth: " << result.peakWorkingSetGrowth << L" bytes" << std::endl;
+		return result.succeeded ? 0 : 1;
+	}
+
 	WindowSettings windowSettings;
 	windowSettings.width = 1280;
 	windowSettings.height = 720;
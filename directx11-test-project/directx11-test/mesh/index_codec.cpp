@@ -0,0 +1,289 @@
+#include "stdafx.h"
+#include "index_codec.h"
+
+
+namespace
+{
+	// first byte of every encoded stream, bumped when the format changes
+	const uint8 kIndexCodecVersion = 0xA1;
+
+	// every triangle starts with a code byte: the high nibble is the position of the shared edge in the edge fifo,
+	// or kNoEdge when the three vertices follow; every vertex is then described by a nibble
+	const uint32 kNoEdge = 15;
+	const uint32 kNextVertex = 0;		// the vertex after the highest one so far
+	const uint32 kExplicitVertex = 15;	// a zigzag varint delta from the last explicit vertex follows
+	const uint32 kFifoSize = 16;		// codes 1-14 are vertex fifo positions, 0-14 are edge fifo positions
+	const uint32 kEdgeFifoCodeCount = 15;
+	const uint32 kVertexFifoCodeCount = 14;
+
+
+	struct Edge
+	{
+		uint32 a;
+		uint32 b;
+	};
+
+
+	// shared by the encoder and the decoder, they must push exactly the same things in the same order
+	struct CodecState
+	{
+		Edge edges[kFifoSize];
+		uint32 vertices[kFifoSize];
+		uint32 edgeHead = 0;
+		uint32 vertexHead = 0;
+		uint32 nextVertex = 0;
+		uint32 lastExplicitVertex = 0;
+
+		CodecState()
+		{
+			std::fill(std::begin(edges), std::end(edges), Edge{ UINT32_MAX, UINT32_MAX });
+			std::fill(std::begin(vertices), std::end(vertices), UINT32_MAX);
+		}
+
+		void PushEdge(uint32 a, uint32 b)
+		{
+			edges[edgeHead++ % kFifoSize] = Edge{ a, b };
+		}
+
+		void PushVertex(uint32 vertex)
+		{
+			vertices[vertexHead++ % kFifoSize] = vertex;
+		}
+
+		const Edge& EdgeAt(uint32 position) const
+		{
+			return edges[(edgeHead - 1 - position) % kFifoSize];
+		}
+
+		uint32 VertexAt(uint32 position) const
+		{
+			return vertices[(vertexHead - 1 - position) % kFifoSize];
+		}
+	};
+
+
+	void WriteVarint(uint32 value, std::vector<uint8>* data)
+	{
+		while (value >= 0x80)
+		{
+			data->push_back(uint8(value | 0x80));
+			value >>= 7;
+		}
+		data->push_back(uint8(value));
+	}
+
+
+	bool ReadVarint(const uint8* data, size_t byteSize, size_t* position, uint32* value)
+	{
+		uint32 result = 0;
+		for (uint32 shift = 0; shift < 35; shift += 7)
+		{
+			if (*position == byteSize)
+			{
+				return false;
+			}
+
+			const uint8 byte = data[(*position)++];
+			result |= uint32(byte & 0x7f) << shift;
+			if (byte < 0x80)
+			{
+				*value = result;
+				return true;
+			}
+		}
+		return false;
+	}
+
+
+	// returns the nibble describing the vertex, the explicit ones are appended to data
+	uint32 EncodeVertex(uint32 vertex, CodecState* state, std::vector<uint8>* data)
+	{
+		if (vertex == state->nextVertex)
+		{
+			state->nextVertex++;
+			state->PushVertex(vertex);
+			return kNextVertex;
+		}
+
+		for (uint32 position = 0; position < kVertexFifoCodeCount; position++)
+		{
+			if (state->VertexAt(position) == vertex)
+			{
+				return position + 1;
+			}
+		}
+
+		const uint32 delta = vertex - state->lastExplicitVertex;
+		WriteVarint((delta << 1) ^ uint32(int32(delta) >> 31), data);
+		state->lastExplicitVertex = vertex;
+		state->PushVertex(vertex);
+		return kExplicitVertex;
+	}
+
+
+	bool DecodeVertex(uint32 code, const uint8* data, size_t byteSize, size_t* position, CodecState* state, uint32* vertex)
+	{
+		if (code == kNextVertex)
+		{
+			*vertex = state->nextVertex++;
+			state->PushVertex(*vertex);
+			return true;
+		}
+
+		if (code != kExplicitVertex)
+		{
+			*vertex = state->VertexAt(code - 1);
+			return true;
+		}
+
+		uint32 zigzag;
+		if (!ReadVarint(data, byteSize, position, &zigzag))
+		{
+			return false;
+		}
+
+		*vertex = state->lastExplicitVertex + ((zigzag >> 1) ^ (0u - (zigzag & 1)));
+		state->lastExplicitVertex = *vertex;
+		state->PushVertex(*vertex);
+		return true;
+	}
+
+
+	// position in the edge fifo of the first triangle edge found, the triangle is rotated to start with it
+	uint32 FindSharedEdge(const CodecState& state, uint32 triangle[3])
+	{
+		for (uint32 position = 0; position < kEdgeFifoCodeCount; position++)
+		{
+			const Edge& edge = state.EdgeAt(position);
+			for (uint32 rotation = 0; rotation < 3; rotation++)
+			{
+				if (edge.a == triangle[rotation] && edge.b == triangle[(rotation + 1) % 3])
+				{
+					std::rotate(triangle, triangle + rotation, triangle + 3);
+					return position;
+				}
+			}
+		}
+		return kNoEdge;
+	}
+}
+
+
+std::vector<uint8> xtest::mesh::EncodeIndices(const uint32* indices, size_t indexCount)
+{
+	XTEST_ASSERT(indexCount % 3 == 0);
+
+	std::vector<uint8> data;
+	data.reserve(1 + indexCount / 2);
+	data.push_back(kIndexCodecVersion);
+
+	CodecState state;
+	for (size_t index = 0; index + 2 < indexCount; index += 3)
+	{
+		uint32 triangle[3] = { indices[index], indices[index + 1], indices[index + 2] };
+		const uint32 edgePosition = FindSharedEdge(state, triangle);
+		const uint32 a = triangle[0];
+		const uint32 b = triangle[1];
+		const uint32 c = triangle[2];
+
+		// the code bytes are filled once the vertices are encoded, their explicit values follow them
+		const size_t codePosition = data.size();
+		if (edgePosition != kNoEdge)
+		{
+			data.push_back(0);
+			data[codePosition] = uint8((edgePosition << 4) | EncodeVertex(c, &state, &data));
+		}
+		else
+		{
+			data.push_back(0);
+			data.push_back(0);
+			const uint32 codeA = EncodeVertex(a, &state, &data);
+			const uint32 codeB = EncodeVertex(b, &state, &data);
+			const uint32 codeC = EncodeVertex(c, &state, &data);
+			data[codePosition] = uint8((kNoEdge << 4) | codeA);
+			data[codePosition + 1] = uint8((codeB << 4) | codeC);
+			state.PushEdge(b, a);
+		}
+
+		// the edges as a neighbour triangle with the same winding would walk them
+		state.PushEdge(c, b);
+		state.PushEdge(a, c);
+	}
+
+	return data;
+}
+
+
+bool xtest::mesh::DecodeIndices(const uint8* data, size_t byteSize, uint32* indices, size_t indexCount)
+{
+	if (indexCount % 3 != 0 || byteSize == 0 || data[0] != kIndexCodecVersion)
+	{
+		return false;
+	}
+
+	CodecState state;
+	size_t position = 1;
+	for (size_t index = 0; index < indexCount; index += 3)
+	{
+		if (position == byteSize)
+		{
+			return false;
+		}
+
+		const uint8 code = data[position++];
+		uint32 a;
+		uint32 b;
+		uint32 c;
+		if ((code >> 4) != kNoEdge)
+		{
+			const Edge& edge = state.EdgeAt(code >> 4);
+			a = edge.a;
+			b = edge.b;
+			if (!DecodeVertex(code & 15, data, byteSize, &position, &state, &c))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			if (position == byteSize)
+			{
+				return false;
+			}
+
+			const uint8 secondCode = data[position++];
+			if (!DecodeVertex(code & 15, data, byteSize, &position, &state, &a)
+				|| !DecodeVertex(secondCode >> 4, data, byteSize, &position, &state, &b)
+				|| !DecodeVertex(secondCode & 15, data, byteSize, &position, &state, &c))
+			{
+				return false;
+			}
+			state.PushEdge(b, a);
+		}
+
+		state.PushEdge(c, b);
+		state.PushEdge(a, c);
+
+		indices[index] = a;
+		indices[index + 1] = b;
+		indices[index + 2] = c;
+	}
+
+	return position == byteSize;
+}
+
+
+void xtest::mesh::NarrowIndices(const uint32* indices, size_t indexCount, uint16* narrowIndices)
+{
+	for (size_t index = 0; index < indexCount; index++)
+	{
+		XTEST_ASSERT(indices[index] < kMaxNarrowIndexVertexCount, L"index %u doesn't fit in 16 bits", indices[index]);
+		narrowIndices[index] = uint16(indices[index]);
+	}
+}
+
+
+void xtest::mesh::WidenIndices(const uint16* narrowIndices, size_t indexCount, uint32* indices)
+{
+	std::copy(narrowIndices, narrowIndices + indexCount, indices);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+
+namespace xtest {
+namespace mesh {
+
+	/**
+	Lossless compression of triangle lists. Every triangle is encoded against a fifo of the last edges
+	and a fifo of the last vertices: a triangle sharing an edge with a recent one costs a single byte when
+	its third vertex is new or recent, other vertices are stored as variable length deltas. Works best on
+	triangle lists optimized with OptimizeVertexCache and OptimizeVertexFetch, where most vertices are
+	either recent or the next one never seen.
+	Triangles can be rotated, the winding order is preserved.
+	*/
+	std::vector<uint8> EncodeIndices(const uint32* indices, size_t indexCount);
+
+	// returns false if the data is malformed or doesn't contain exactly indexCount indices
+	bool DecodeIndices(const uint8* data, size_t byteSize, uint32* indices, size_t indexCount);
+
+
+	// the largest vertex count whose indices fit in 16 bits
+	const uint32 kMaxNarrowIndexVertexCount = 65536;
+
+	void NarrowIndices(const uint32* indices, size_t indexCount, uint16* narrowIndices);
+	void WidenIndices(const uint16* narrowIndices, size_t indexCount, uint32* indices);
+
+} // mesh
+} // xtest
+
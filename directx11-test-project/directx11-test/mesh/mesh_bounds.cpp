@@ -0,0 +1,121 @@
+#include "stdafx.h"
+#include "mesh_bounds.h"
+
+
+using namespace DirectX;
+using xtest::mesh::MeshBounds;
+using xtest::mesh::MeshData;
+
+
+namespace
+{
+	// vertices handled per iteration, each one with its own accumulator so that the min, max and length
+	// operations of different vertices don't wait on each other
+	const uint32 kBoundsLaneCount = 4;
+}
+
+
+MeshBounds xtest::mesh::ComputeBounds(const MeshData::Vertex* vertices, uint32 vertexCount)
+{
+	MeshBounds bounds;
+	if (vertexCount == 0)
+	{
+		return bounds;
+	}
+
+	XMVECTOR boxMin[kBoundsLaneCount];
+	XMVECTOR boxMax[kBoundsLaneCount];
+	for (uint32 lane = 0; lane < kBoundsLaneCount; lane++)
+	{
+		boxMin[lane] = XMLoadFloat3(&vertices[0].position);
+		boxMax[lane] = boxMin[lane];
+	}
+
+	const uint32 laneVertexCount = vertexCount / kBoundsLaneCount * kBoundsLaneCount;
+	for (uint32 vertexIndex = 0; vertexIndex < laneVertexCount; vertexIndex += kBoundsLaneCount)
+	{
+		for (uint32 lane = 0; lane < kBoundsLaneCount; lane++)
+		{
+			const XMVECTOR position = XMLoadFloat3(&vertices[vertexIndex + lane].position);
+			boxMin[lane] = XMVectorMin(boxMin[lane], position);
+			boxMax[lane] = XMVectorMax(boxMax[lane], position);
+		}
+	}
+	for (uint32 vertexIndex = laneVertexCount; vertexIndex < vertexCount; vertexIndex++)
+	{
+		const XMVECTOR position = XMLoadFloat3(&vertices[vertexIndex].position);
+		boxMin[0] = XMVectorMin(boxMin[0], position);
+		boxMax[0] = XMVectorMax(boxMax[0], position);
+	}
+
+	const XMVECTOR boundsMin = XMVectorMin(XMVectorMin(boxMin[0], boxMin[1]), XMVectorMin(boxMin[2], boxMin[3]));
+	const XMVECTOR boundsMax = XMVectorMax(XMVectorMax(boxMax[0], boxMax[1]), XMVectorMax(boxMax[2], boxMax[3]));
+	const XMVECTOR center = XMVectorScale(XMVectorAdd(boundsMin, boundsMax), 0.5f);
+
+
+	// the farthest vertex from the center, the square root is taken once at the end
+	XMVECTOR maxDistanceSq[kBoundsLaneCount];
+	for (uint32 lane = 0; lane < kBoundsLaneCount; lane++)
+	{
+		maxDistanceSq[lane] = XMVectorZero();
+	}
+	for (uint32 vertexIndex = 0; vertexIndex < laneVertexCount; vertexIndex += kBoundsLaneCount)
+	{
+		for (uint32 lane = 0; lane < kBoundsLaneCount; lane++)
+		{
+			const XMVECTOR offset = XMVectorSubtract(XMLoadFloat3(&vertices[vertexIndex + lane].position), center);
+			maxDistanceSq[lane] = XMVectorMax(maxDistanceSq[lane], XMVector3LengthSq(offset));
+		}
+	}
+	for (uint32 vertexIndex = laneVertexCount; vertexIndex < vertexCount; vertexIndex++)
+	{
+		const XMVECTOR offset = XMVectorSubtract(XMLoadFloat3(&vertices[vertexIndex].position), center);
+		maxDistanceSq[0] = XMVectorMax(maxDistanceSq[0], XMVector3LengthSq(offset));
+	}
+	const XMVECTOR radius = XMVectorSqrt(XMVectorMax(XMVectorMax(maxDistanceSq[0], maxDistanceSq[1]), XMVectorMax(maxDistanceSq[2], maxDistanceSq[3])));
+
+	XMStoreFloat3(&bounds.boxMin, boundsMin);
+	XMStoreFloat3(&bounds.boxMax, boundsMax);
+	XMStoreFloat3(&bounds.sphereCenter, center);
+	bounds.sphereRadius = XMVectorGetX(radius);
+	return bounds;
+}
+
+
+MeshBounds xtest::mesh::ComputeBounds(const MeshData& meshData)
+{
+	return ComputeBounds(meshData.vertices.data(), uint32(meshData.vertices.size()));
+}
+
+
+MeshBounds xtest::mesh::MergeBounds(const MeshBounds* bounds, uint32 boundsCount)
+{
+	MeshBounds mergedBounds;
+	if (boundsCount == 0)
+	{
+		return mergedBounds;
+	}
+
+	XMVECTOR boxMin = XMLoadFloat3(&bounds[0].boxMin);
+	XMVECTOR boxMax = XMLoadFloat3(&bounds[0].boxMax);
+	for (uint32 boundsIndex = 1; boundsIndex < boundsCount; boundsIndex++)
+	{
+		boxMin = XMVectorMin(boxMin, XMLoadFloat3(&bounds[boundsIndex].boxMin));
+		boxMax = XMVectorMax(boxMax, XMLoadFloat3(&bounds[boundsIndex].boxMax));
+	}
+	const XMVECTOR center = XMVectorScale(XMVectorAdd(boxMin, boxMax), 0.5f);
+
+	// the farthest point of every sphere from the merged center
+	XMVECTOR radius = XMVectorZero();
+	for (uint32 boundsIndex = 0; boundsIndex < boundsCount; boundsIndex++)
+	{
+		const XMVECTOR centerDistance = XMVector3Length(XMVectorSubtract(XMLoadFloat3(&bounds[boundsIndex].sphereCenter), center));
+		radius = XMVectorMax(radius, XMVectorAdd(centerDistance, XMVectorReplicate(bounds[boundsIndex].sphereRadius)));
+	}
+
+	XMStoreFloat3(&mergedBounds.boxMin, boxMin);
+	XMStoreFloat3(&mergedBounds.boxMax, boxMax);
+	XMStoreFloat3(&mergedBounds.sphereCenter, center);
+	mergedBounds.sphereRadius = XMVectorGetX(radius);
+	return mergedBounds;
+}
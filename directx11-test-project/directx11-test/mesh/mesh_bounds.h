@@ -0,0 +1,25 @@
+#pragma once
+
+#include <mesh/mesh_format.h>
+
+
+namespace xtest {
+namespace mesh {
+
+	/**
+	Computes the box around the vertex positions and the sphere centered in it that encloses them all,
+	zero bounds if there are no vertices. Unreferenced vertices are included as well.
+	*/
+	MeshBounds ComputeBounds(const MeshData::Vertex* vertices, uint32 vertexCount);
+	MeshBounds ComputeBounds(const MeshData& meshData);
+
+	/**
+	Merges the bounds of several meshes without going through their vertices: the box around all the boxes and the
+	sphere centered in it that encloses all the spheres, zero bounds if there are none. The sphere can be larger
+	than the one ComputeBounds would give on all the vertices, the bounds of a single mesh are kept as they are.
+	*/
+	MeshBounds MergeBounds(const MeshBounds* bounds, uint32 boundsCount);
+
+} // mesh
+} // xtest
+
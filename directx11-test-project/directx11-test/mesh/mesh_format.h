@@ -5,6 +5,17 @@ namespace xtest {
 namespace mesh {
 
 
+	// axis aligned box and sphere around the vertex positions, the sphere is centered in the box.
+	// see ComputeBounds
+	struct MeshBounds
+	{
+		DirectX::XMFLOAT3 boxMin = { 0.f, 0.f, 0.f };
+		DirectX::XMFLOAT3 boxMax = { 0.f, 0.f, 0.f };
+		DirectX::XMFLOAT3 sphereCenter = { 0.f, 0.f, 0.f };
+		float sphereRadius = 0.f;
+	};
+
+
 	struct MeshData
 	{
 		struct Vertex
@@ -20,6 +31,7 @@ namespace mesh {
 
 		std::vector<Vertex> vertices;
 		std::vector<uint32> indices;
+		MeshBounds bounds;	// set by the generators and by ReadGPF, see MergeBounds. call ComputeBounds after moving the vertices
 	};
 
 
@@ -31,6 +43,7 @@ namespace mesh {
 			uint32 vertexOffset;
 			uint32 indexCount;
 			uint32 indexOffset;
+			MeshBounds bounds;
 		};
 
 		std::map<std::string, MeshDescriptor> meshDescriptorMapByName;
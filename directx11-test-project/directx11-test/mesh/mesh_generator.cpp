@@ -1,6 +1,8 @@
 ﻿#include "stdafx.h"
 #include "mesh_generator.h"
 #include <math/math_utils.h>
+#include <mesh/mesh_parametric.h>
+#include <mesh/mesh_bounds.h>
 
 
 using namespace xtest::mesh;
@@ -61,310 +63,44 @@ xtest::mesh::MeshData xtest::mesh::GeneratePlane(float xLength, float zLength, u
 		}
 	}
 
+	mesh.bounds = ComputeBounds(mesh);
 	return mesh;
 }
 
-xtest::mesh::MeshData xtest::mesh::GenerateSphere(float radius, uint32 sliceCount, uint32 stackCount)
+xtest::mesh::MeshData xtest::mesh::GenerateSphere(float radius, uint32 sliceCount, uint32 stackCount, uint32 threadCount)
 {
-	// poles vertices
-	MeshData::Vertex topVertex = { {0.0f, +radius, 0.0f}, {0.0f, +1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 0.0f} };
-	MeshData::Vertex bottomVertex = { {0.0f, -radius, 0.0f}, {0.0f, -1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f} };
-
-	MeshData mesh;
-	mesh.vertices.push_back(topVertex);
-
-	const float phiStep = XM_PI / stackCount;
-	const float thetaStep = 2.0f*XM_PI / sliceCount;
-
-	//rings vertices
-	for (uint32 stack = 1; stack <= stackCount - 1; ++stack)
-	{
-		float phi = stack * phiStep;
-
-		for (uint32 slice = 0; slice <= sliceCount; ++slice)
-		{
-			float theta = slice * thetaStep;
-
-			MeshData::Vertex vertex;
-
-			// spherical to cartesian
-			vertex.position.x = radius * sinf(phi)*cosf(theta);
-			vertex.position.y = radius * cosf(phi);
-			vertex.position.z = radius * sinf(phi)*sinf(theta);
-
-			// Partial derivative of P with respect to theta
-			vertex.tangentU.x = -radius * sinf(phi)*sinf(theta);
-			vertex.tangentU.y = 0.0f;
-			vertex.tangentU.z = +radius * sinf(phi)*cosf(theta);
-
-			XMVECTOR tangentU = XMLoadFloat3(&vertex.tangentU);
-			XMStoreFloat3(&vertex.tangentU, XMVector3Normalize(tangentU));
-
-			XMVECTOR position = XMLoadFloat3(&vertex.position);
-			XMStoreFloat3(&vertex.normal, XMVector3Normalize(position));
-
-			vertex.uv.x = theta / XM_2PI;
-			vertex.uv.y = phi / XM_PI;
-
-			mesh.vertices.push_back(vertex);
-		}
-	}
-
-	mesh.vertices.push_back(bottomVertex);
-
-
-	// top indices
-	for (uint32 slice = 1; slice <= sliceCount; ++slice)
-	{
-		mesh.indices.push_back(0);
-		mesh.indices.push_back(slice + 1);
-		mesh.indices.push_back(slice);
-	}
-
-	// stacks indices
-	uint32 baseIndex = 1;
-	uint32 ringVertexCount = sliceCount + 1;
-	for (uint32 stack = 0; stack < stackCount - 2; ++stack)
-	{
-		for (uint32 slice = 0; slice < sliceCount; ++slice)
-		{
-			mesh.indices.push_back(baseIndex + stack * ringVertexCount + slice);
-			mesh.indices.push_back(baseIndex + stack * ringVertexCount + slice + 1);
-			mesh.indices.push_back(baseIndex + (stack + 1)*ringVertexCount + slice);
-			
-			mesh.indices.push_back(baseIndex + (stack + 1)*ringVertexCount + slice);
-			mesh.indices.push_back(baseIndex + stack * ringVertexCount + slice + 1);
-			mesh.indices.push_back(baseIndex + (stack + 1)*ringVertexCount + slice + 1);
-		}
-	}
-
-	
-	// South pole vertex was added last.
-	uint32 southPoleIndex = uint32(mesh.vertices.size() - 1);
-
-	// Offset the indices to the index of the first vertex in the last ring.
-	baseIndex = southPoleIndex - ringVertexCount;
-
-	for (uint32 slice = 0; slice < sliceCount; ++slice)
-	{
-		mesh.indices.push_back(southPoleIndex);
-		mesh.indices.push_back(baseIndex + slice);
-		mesh.indices.push_back(baseIndex + slice + 1);
-	}
-
-	return mesh;
+	SphereSurface sphere;
+	sphere.radius = radius;
+	return GenerateParametric(sphere, sliceCount, stackCount, true, false, threadCount);
 }
 
-xtest::mesh::MeshData xtest::mesh::GenerateTorusKnot(float r, float R, float c, uint32 detailsCount, uint32 q, uint32 p)
+xtest::mesh::MeshData xtest::mesh::GenerateTorusKnot(float r, float R, float c, uint32 detailsCount, uint32 q, uint32 p, uint32 threadCount)
 {
-	uint32 sliceCount = detailsCount;
-	uint32 stackCount = detailsCount;
-
-	assert(sliceCount > 3);
-	assert(stackCount > 0.0f);
+	assert(detailsCount > 3);
 	assert(r > 0);
 	assert(R > 0);
 	assert(c > 0);
 	assert(R > r);
 
-	const float phiStep = XM_2PI / sliceCount;
-	const float thetaStep = XM_2PI / stackCount;
-
-	MeshData mesh;
-
-	float phi_phase = 0;
-	float theta_phase = 0;
-
-	float t = XM_PI;
-
-	for (uint32 slice = 0; slice < sliceCount; ++slice)
-	{
-		float theta = slice * phiStep + theta_phase;
-
-
-		for (uint32 stack = 0; stack < stackCount; ++stack) {
-			float phy = stack * thetaStep + phi_phase;
-
-			MeshData::Vertex v1;
-
-			XMFLOAT3 X;
-			XMFLOAT3 N;
-			XMFLOAT3 T;
-			XMFLOAT3 B;
-
-			X.x = (R + r * cosf( q * theta)) * cosf( p * theta  );
-			X.y = (R + r * cosf( q * theta)) * sinf( p * theta );
-			X.z =	   r * sinf( q * theta);
-
-			N.x = cosf( p * theta) * cosf( q * theta );
-			N.y = sinf( p * theta) * cosf( q * theta );
-			N.z =					 sinf( q * theta);
-
-
-			T.x = p * (R + r * cosf(q*theta))*-sinf(p * theta) + q * (r * (-sinf ( q * theta ) * cosf ( p * theta )));
-			T.y = p * (R + r * cosf(q*theta))* cosf(p * theta) + q * (r * (-sinf ( q * theta ) * sinf ( p * theta )));
-			T.z = p * (R + r * cosf(q*theta)) * 0			   + q * (r * ( cosf ( q * theta )));
-		
-			XMVECTOR Xv = XMLoadFloat3(&X);
-			XMVECTOR Tv = XMVector3Normalize(XMLoadFloat3(&T));
-			XMVECTOR Nv = XMLoadFloat3(&N);
-			XMVECTOR Bv;
-			XMVECTOR Xk;
-
-			Bv = XMVector3Cross( Tv , Nv );
-			Xk = XMVectorAdd(Xv, XMVectorAdd(c * cosf(phy) * Nv , c * sinf(phy) * Bv));
-			Nv = XMVectorAdd( cosf(phy) * Nv , sinf(phy) * Bv);
-
-			XMStoreFloat3(&v1.position, Xk);
-			XMStoreFloat3(&v1.tangentU, Tv);
-			XMStoreFloat3(&v1.normal, Nv);
-
-			v1.uv.x = (stack * thetaStep / XM_2PI);
-			v1.uv.y = (slice * phiStep / XM_2PI);
-
-			mesh.vertices.push_back(v1);
-		}
-
-	}
-
-	// stacks indices
-	uint32  offset;
-	uint32  i0;
-	uint32  i1;
-	uint32  i2;
-	uint32  i3;
-
-	uint32 MAX_INDEX = (stackCount - 1) + (sliceCount - 1)*sliceCount;
-
-	for (uint32 slice = 0; slice < sliceCount; ++slice)
-	{
-		for (uint32 i = 0; i < stackCount; ++i)
-		{
-			offset = (i + slice * sliceCount);
-
-			i0 = offset;
-			i1 = offset + 1;
-			i2 = offset + stackCount;
-			i3 = offset + stackCount + 1;
-
-			i1 > MAX_INDEX ? i1 -= stackCount * stackCount : false;
-			i2 > MAX_INDEX ? i2 -= stackCount * stackCount : false;
-			i3 > MAX_INDEX ? i3 -= stackCount * stackCount : false;
-
-
-			mesh.indices.push_back(i0);
-			mesh.indices.push_back(i1);
-			mesh.indices.push_back(i2);
-
-			mesh.indices.push_back(i2);
-			mesh.indices.push_back(i1);
-			mesh.indices.push_back(i3);
-		}
-	}
-
-	return mesh;
-
+	TorusKnotSurface torusKnot;
+	torusKnot.r = r;
+	torusKnot.R = R;
+	torusKnot.tubeRadius = c;
+	torusKnot.q = q;
+	torusKnot.p = p;
+	return GenerateParametric(torusKnot, detailsCount, detailsCount, true, true, threadCount);
 }
 
-xtest::mesh::MeshData xtest::mesh::GenerateTorus(float max_radius, float min_radius, uint32 detailsCount)
+xtest::mesh::MeshData xtest::mesh::GenerateTorus(float max_radius, float min_radius, uint32 detailsCount, uint32 threadCount)
 {
-
-	uint32 sliceCount = detailsCount;
-	uint32 stackCount = detailsCount;
-
-	assert(sliceCount > 3);
-	assert(stackCount > 0.0f);
+	assert(detailsCount > 3);
 	assert(max_radius > min_radius);
 	assert(min_radius > 0.0f);
 
-	const float phiStep		= XM_2PI /  sliceCount;
-	const float thetaStep	= XM_2PI /  stackCount;
-
-	float torus_radius = (max_radius - min_radius) / 2.0f;
-	const float d = (min_radius + torus_radius);
-
-	MeshData mesh;
-	
-	float phi_phase= 0;
-	float theta_phase = 0;
-
-	for (uint32 slice = 0; slice < sliceCount; ++slice)
-	{
-			float theta = slice * phiStep + theta_phase;
-
-			for (uint32 stack = 0; stack < stackCount; ++stack) {
-				float phy = stack * thetaStep + phi_phase;
-
-				MeshData::Vertex v1;
-				v1.position.x = (d + torus_radius * cosf(phy))*cosf(theta);
-				v1.position.z = (d + torus_radius * cosf(phy))*sinf(theta);
-				v1.position.y =      torus_radius * sinf(phy);
-				
-				// Partial derivative of P with respect to theta
-				//v1.tangentU.x = torus_radius * (-sinf(theta)*cosf(phi));
-				//v1.tangentU.z = torus_radius * (-sinf(theta)*sinf(phi));
-				//v1.tangentU.y = torus_radius *   cosf(theta);
-
-				//v1.tangentU.x = (d + torus_radius * cosf(phy)) * -sinf(theta);
-				//v1.tangentU.z = 0.0f;
-				//v1.tangentU.y = (d + torus_radius * cosf(phy)) * cosf(theta);
-
-				v1.tangentU.x = torus_radius* (-sinf(phy)*cosf(theta));
-				v1.tangentU.z = torus_radius* (-sinf(phy)*sinf(theta));
-				v1.tangentU.y = torus_radius* (cosf(phy));
-
-				v1.normal.x = cosf(theta)*cosf(phy);
-				v1.normal.z = sinf(theta)*cosf(phy);
-				v1.normal.y = sinf(phy);
-
-				//XMVECTOR tangentU = XMVector3Normalize(XMLoadFloat3(&v1.tangentU));
-				XMVECTOR tangentU = (XMLoadFloat3(&v1.tangentU));
-				XMStoreFloat3(&v1.tangentU, tangentU);
-
-				v1.uv.x = (stack * thetaStep / XM_2PI);
-				v1.uv.y = (slice * phiStep / XM_2PI);
-
-				mesh.vertices.push_back(v1);
-			}
-			
-	}
-
-	// stacks indices
-	uint32  offset;
-	uint32  i0;
-	uint32  i1;
-	uint32  i2;
-	uint32  i3;
-	
-	uint32 MAX_INDEX = (stackCount - 1) + (sliceCount - 1)*sliceCount;
-
-	for (uint32 slice = 0; slice < sliceCount; ++slice)
-	{
-		for (uint32 i = 0; i < stackCount; ++i)
-		{
-			offset = (i + slice * sliceCount);
-
-			i0 = offset;
-			i1 = offset + 1;
-			i2 = offset + stackCount;
-			i3 = offset + stackCount + 1;
-
-			i1 > MAX_INDEX ? i1 -= stackCount * stackCount : false;
-			i2 > MAX_INDEX ? i2 -= stackCount * stackCount : false;
-			i3 > MAX_INDEX ? i3 -= stackCount * stackCount : false;
-			
-
-			mesh.indices.push_back(i0);
-			mesh.indices.push_back(i1);
-			mesh.indices.push_back(i2);
-			
-			mesh.indices.push_back(i2);
-			mesh.indices.push_back(i1);
-			mesh.indices.push_back(i3);
-		}
-	}
-
-	return mesh;
+	TorusSurface torus;
+	torus.tubeRadius = (max_radius - min_radius) / 2.0f;
+	torus.ringRadius = min_radius + torus.tubeRadius;
+	return GenerateParametric(torus, detailsCount, detailsCount, true, true, threadCount);
 }
 
 
@@ -466,6 +202,7 @@ xtest::mesh::MeshData xtest::mesh::GenerateBox(float xLength, float yLength, flo
 	mesh.indices[34] = 22; 
 	mesh.indices[35] = 23;
 
+	mesh.bounds = ComputeBounds(mesh);
 	return mesh;
 }
 
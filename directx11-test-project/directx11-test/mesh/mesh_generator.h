@@ -6,11 +6,16 @@ namespace xtest{
 namespace mesh {
 	
 	
+	// the sphere, torus and torus knot are GenerateParametric grids of SphereSurface, TorusSurface and
+	// TorusKnotSurface, see mesh/mesh_parametric.h; the seams have duplicated vertices with their own uvs.
+	// the rows are spread over threadCount threads, 0 means one per hardware thread.
+	// every mesh comes with its bounds.
+
 	MeshData GeneratePlane(float xLength, float zLength, uint32 zDivisions, uint32 xDivisions);
-	MeshData GenerateSphere(float radius, uint32 sliceCount, uint32 stackCount);
+	MeshData GenerateSphere(float radius, uint32 sliceCount, uint32 stackCount, uint32 threadCount = 0);
 	MeshData GenerateBox(float xLenght, float yLenght, float zLenght);
-	MeshData GenerateTorus(float max_radius, float min_radius, uint32 detailsCount);
-	MeshData GenerateTorusKnot(float r, float R, float c, uint32 detailsCount, uint32 q, uint32 p);
+	MeshData GenerateTorus(float max_radius, float min_radius, uint32 detailsCount, uint32 threadCount = 0);
+	MeshData GenerateTorusKnot(float r, float R, float c, uint32 detailsCount, uint32 q, uint32 p, uint32 threadCount = 0);
 	
 } // xtest
 } // mesh
@@ -0,0 +1,60 @@
+#include "stdafx.h"
+#include "mesh_generator_benchmark.h"
+#include <mesh/mesh_generator.h>
+#include <time/time_point.h>
+#include <cfloat>
+
+
+using xtest::mesh::MeshData;
+using xtest::mesh::MeshGeneratorBenchmarkResult;
+
+
+namespace
+{
+	// generate(threadCount) is timed on a single thread and on one thread per hardware thread
+	template <typename Generate>
+	MeshGeneratorBenchmarkResult MeasureGenerator(const std::wstring& meshName, uint32 detailsCount, uint32 repeatCount, Generate generate)
+	{
+		MeshGeneratorBenchmarkResult result;
+		result.meshName = meshName;
+		result.detailsCount = detailsCount;
+		result.millis = FLT_MAX;
+		result.parallelMillis = FLT_MAX;
+
+		for (uint32 repeat = 0; repeat < std::max(repeatCount, 1u); repeat++)
+		{
+			const xtest::time::TimePoint start = xtest::time::TimePoint::Now();
+			const MeshData mesh = generate(1);
+
+			const xtest::time::TimePoint parallelStart = xtest::time::TimePoint::Now();
+			const MeshData parallelMesh = generate(0);
+
+			const xtest::time::TimePoint parallelEnd = xtest::time::TimePoint::Now();
+			XTEST_ASSERT(mesh.vertices == parallelMesh.vertices && mesh.indices == parallelMesh.indices, L"the %s depends on the thread count", meshName.c_str());
+			result.millis = std::min(result.millis, (parallelStart - start).Millis());
+			result.parallelMillis = std::min(result.parallelMillis, (parallelEnd - parallelStart).Millis());
+			result.vertexCount = uint32(mesh.vertices.size());
+			result.indexCount = uint32(mesh.indices.size());
+		}
+		return result;
+	}
+}
+
+
+std::vector<MeshGeneratorBenchmarkResult> xtest::mesh::RunMeshGeneratorBenchmark(uint32 detailsCount, uint32 repeatCount)
+{
+	std::vector<MeshGeneratorBenchmarkResult> results;
+	results.push_back(MeasureGenerator(L"sphere", detailsCount, repeatCount, [detailsCount](uint32 threadCount)
+	{
+		return GenerateSphere(1.f, detailsCount, detailsCount, threadCount);
+	}));
+	results.push_back(MeasureGenerator(L"torus", detailsCount, repeatCount, [detailsCount](uint32 threadCount)
+	{
+		return GenerateTorus(4.f, 0.2f, detailsCount, threadCount);
+	}));
+	results.push_back(MeasureGenerator(L"torus knot", detailsCount, repeatCount, [detailsCount](uint32 threadCount)
+	{
+		return GenerateTorusKnot(2.f, 10.f, 0.05f, detailsCount, 20, 1, threadCount);
+	}));
+	return results;
+}
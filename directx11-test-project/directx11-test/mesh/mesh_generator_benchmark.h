@@ -0,0 +1,26 @@
+#pragma once
+
+
+namespace xtest {
+namespace mesh {
+
+	// the best times of the generation of a mesh on a single thread and on one thread per hardware thread
+	struct MeshGeneratorBenchmarkResult
+	{
+		std::wstring meshName;
+		uint32 detailsCount = 0;
+		uint32 vertexCount = 0;
+		uint32 indexCount = 0;
+		float millis = 0.f;				// on a single thread
+		float parallelMillis = 0.f;		// on one thread per hardware thread
+	};
+
+
+	/**
+	Generates the sphere, the torus and the torus knot of the demos with detailsCount x detailsCount vertices.
+	@param repeatCount	Every mesh is generated this many times, the best time is kept.
+	*/
+	std::vector<MeshGeneratorBenchmarkResult> RunMeshGeneratorBenchmark(uint32 detailsCount, uint32 repeatCount = 5);
+
+} // mesh
+} // xtest
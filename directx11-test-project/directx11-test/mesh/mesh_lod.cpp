@@ -0,0 +1,142 @@
+#include "stdafx.h"
+#include "mesh_lod.h"
+#include <mesh/mesh_bounds.h>
+
+
+using namespace DirectX;
+using xtest::mesh::LodSet;
+using xtest::mesh::LodStatistics;
+using xtest::mesh::LodView;
+using xtest::mesh::LodSelectionSettings;
+using xtest::mesh::MeshBounds;
+using xtest::mesh::MeshData;
+
+
+namespace
+{
+	// how many pixels a unit of error of the lod set covers, infinite when the camera is inside its bounds
+	float PixelsPerErrorUnit(const LodSet& lodSet, FXMMATRIX world, const LodView& view)
+	{
+		// the largest scale of the world matrix, so that the error is never underestimated
+		const float worldScale = std::sqrt(std::max(XMVectorGetX(XMVector3LengthSq(world.r[0])),
+			std::max(XMVectorGetX(XMVector3LengthSq(world.r[1])), XMVectorGetX(XMVector3LengthSq(world.r[2])))));
+
+		const XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&lodSet.boundsCenter), world);
+		const float centerDistance = XMVectorGetX(XMVector3Length(XMVectorSubtract(center, XMLoadFloat3(&view.cameraPosition))));
+		const float distance = centerDistance - lodSet.boundsRadius * worldScale;
+		if (distance <= 0.f)
+		{
+			return std::numeric_limits<float>::infinity();
+		}
+
+		return view.projectionScale * worldScale / distance;
+	}
+
+
+	float ProjectError(float error, float pixelsPerErrorUnit)
+	{
+		// a level without error is exact at any distance, even from inside the bounds
+		return error > 0.f ? error * pixelsPerErrorUnit : 0.f;
+	}
+}
+
+
+LodSet xtest::mesh::BuildLodSet(std::vector<MeshData> levels)
+{
+	XTEST_ASSERT(!levels.empty(), L"a lod set needs at least a level");
+
+	LodSet lodSet;
+	lodSet.levels.resize(levels.size());
+	for (size_t levelIndex = 0; levelIndex < levels.size(); levelIndex++)
+	{
+		LodSet::Level& level = lodSet.levels[levelIndex];
+		level.meshData = std::move(levels[levelIndex]);
+		level.error = EstimateTessellationError(level.meshData);
+		if (levelIndex > 0)
+		{
+			level.error = std::max(level.error, lodSet.levels[levelIndex - 1].error);
+		}
+	}
+
+	// sphere around the center of the bounding box of the finest level
+	const MeshBounds bounds = ComputeBounds(lodSet.levels[0].meshData);
+	lodSet.boundsCenter = bounds.sphereCenter;
+	lodSet.boundsRadius = bounds.sphereRadius;
+
+	return lodSet;
+}
+
+
+float xtest::mesh::EstimateTessellationError(const MeshData& meshData)
+{
+	float error = 0.f;
+	for (size_t index = 0; index + 2 < meshData.indices.size(); index += 3)
+	{
+		for (uint32 corner = 0; corner < 3; corner++)
+		{
+			const MeshData::Vertex& a = meshData.vertices[meshData.indices[index + corner]];
+			const MeshData::Vertex& b = meshData.vertices[meshData.indices[index + (corner + 1) % 3]];
+
+			// an arc bending by angle has a sagitta of chord / 2 * tan(angle / 4)
+			const float chord = XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&b.position), XMLoadFloat3(&a.position))));
+			const float cosine = XMVectorGetX(XMVector3Dot(XMVector3Normalize(XMLoadFloat3(&a.normal)), XMVector3Normalize(XMLoadFloat3(&b.normal))));
+			const float angle = std::acos(std::min(1.f, std::max(-1.f, cosine)));
+			error = std::max(error, 0.5f * chord * std::tan(0.25f * angle));
+		}
+	}
+	return error;
+}
+
+
+LodView xtest::mesh::MakeLodView(const XMFLOAT3& cameraPosition, FXMMATRIX projection, float viewportHeight)
+{
+	// the second diagonal element of a perspective projection is 1 / tan(fovY / 2), it maps a unit
+	// segment at unit distance to that much of the [-1, 1] viewport height
+	LodView view;
+	view.cameraPosition = cameraPosition;
+	view.projectionScale = XMVectorGetY(projection.r[1]) * viewportHeight * 0.5f;
+	return view;
+}
+
+
+float xtest::mesh::ProjectLodError(const LodSet& lodSet, uint32 level, FXMMATRIX world, const LodView& view)
+{
+	XTEST_ASSERT(level < lodSet.levels.size(), L"level %u is not in the lod set", level);
+	return ProjectError(lodSet.levels[level].error, PixelsPerErrorUnit(lodSet, world, view));
+}
+
+
+uint32 xtest::mesh::SelectLod(const LodSet& lodSet, FXMMATRIX world, const LodView& view, uint32 currentLevel, const LodSelectionSettings& settings)
+{
+	XTEST_ASSERT(!lodSet.levels.empty(), L"a lod set needs at least a level");
+
+	// the errors grow with the level, so the finer levels are searched only when the current one got too coarse
+	const uint32 levelCount = uint32(lodSet.levels.size());
+	const float pixelsPerErrorUnit = PixelsPerErrorUnit(lodSet, world, view);
+	uint32 level = std::min(currentLevel, levelCount - 1);
+	if (ProjectError(lodSet.levels[level].error, pixelsPerErrorUnit) > settings.maxScreenError)
+	{
+		while (level > 0 && ProjectError(lodSet.levels[level].error, pixelsPerErrorUnit) > settings.maxScreenError)
+		{
+			level--;
+		}
+		return level;
+	}
+
+	const float coarserScreenError = (1.f - settings.hysteresis) * settings.maxScreenError;
+	while (level + 1 < levelCount && ProjectError(lodSet.levels[level + 1].error, pixelsPerErrorUnit) <= coarserScreenError)
+	{
+		level++;
+	}
+	return level;
+}
+
+
+void LodStatistics::AddDraw(const LodSet& lodSet, uint32 level)
+{
+	XTEST_ASSERT(level < lodSet.levels.size(), L"level %u is not in the lod set", level);
+
+	drawCount++;
+	submittedTriangleCount += lodSet.levels[level].meshData.indices.size() / 3;
+	finestTriangleCount += lodSet.levels[0].meshData.indices.size() / 3;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <mesh/mesh_format.h>
+
+
+namespace xtest {
+namespace mesh {
+
+	// the same object at decreasing detail, level 0 is the finest
+	struct LodSet
+	{
+		struct Level
+		{
+			MeshData meshData;
+			float error = 0.f;	// how far the level is from the surface it approximates, in object space units
+		};
+
+		std::vector<Level> levels;
+		DirectX::XMFLOAT3 boundsCenter = { 0.f, 0.f, 0.f };	// bounding sphere of the finest level, in object space
+		float boundsRadius = 0.f;
+	};
+
+
+	/**
+	Builds a lod set out of the same surface tessellated at decreasing detail, e.g. regenerated with a lower
+	detail count. The error of every level is estimated with EstimateTessellationError and raised to the one
+	of the previous level when smaller, so that the errors never decrease with the level.
+	*/
+	LodSet BuildLodSet(std::vector<MeshData> levels);
+
+	/**
+	Estimates how far the triangles are from the smooth surface their vertex normals describe: every edge
+	is taken as the chord of a circular arc bending from the normal of one end to the normal of the other,
+	the result is the largest distance between a chord and its arc. Edges between vertices with the same
+	normal, like the ones of flat faces, have no error.
+	*/
+	float EstimateTessellationError(const MeshData& meshData);
+
+
+	struct LodSelectionSettings
+	{
+		// in pixels, the coarsest level whose projected error stays within it is selected
+		float maxScreenError = 1.f;
+
+		// a coarser level than the current one is selected only when its projected error is within
+		// (1 - hysteresis) * maxScreenError, so that a camera hovering around a switch distance doesn't pop
+		float hysteresis = 0.25f;
+	};
+
+
+	// the point of view the levels are selected for, make it once per frame
+	struct LodView
+	{
+		DirectX::XMFLOAT3 cameraPosition = { 0.f, 0.f, 0.f };
+		float projectionScale = 0.f;	// pixels covered by a unit long segment facing the camera at unit distance
+	};
+
+	LodView MakeLodView(const DirectX::XMFLOAT3& cameraPosition, DirectX::FXMMATRIX projection, float viewportHeight);
+
+
+	// the error of a level in pixels, as if it was at the point of the bounding sphere closest to the camera;
+	// the error is infinite when the camera is inside the bounding sphere
+	float ProjectLodError(const LodSet& lodSet, uint32 level, DirectX::FXMMATRIX world, const LodView& view);
+
+	// the level to draw the lod set with, given the one it was drawn with so far
+	uint32 SelectLod(const LodSet& lodSet, DirectX::FXMMATRIX world, const LodView& view, uint32 currentLevel, const LodSelectionSettings& settings = LodSelectionSettings());
+
+
+	// what the lod selection saved in a frame, reset it at the start of every frame
+	struct LodStatistics
+	{
+		uint32 drawCount = 0;
+		uint64 submittedTriangleCount = 0;
+		uint64 finestTriangleCount = 0;	// the triangles that drawing every lod set at level 0 would have submitted
+
+		void AddDraw(const LodSet& lodSet, uint32 level);
+	};
+
+} // mesh
+} // xtest
+
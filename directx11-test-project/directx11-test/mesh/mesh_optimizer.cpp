@@ -0,0 +1,621 @@
+#include "stdafx.h"
+#include "mesh_optimizer.h"
+#include <limits>
+
+
+using namespace DirectX;
+using xtest::mesh::MeshData;
+using xtest::mesh::OverdrawStatistics;
+using xtest::mesh::VertexCacheStatistics;
+
+
+namespace
+{
+	// tuning values from Tom Forsyth's paper
+	const uint32 kForsythCacheSize = 32;
+	const float kForsythCacheDecayPower = 1.5f;
+	const float kForsythLastTriangleScore = 0.75f;
+	const float kForsythValenceBoostScale = 2.f;
+	const float kForsythValenceBoostPower = 0.5f;
+	const uint32 kForsythMaxTabulatedValence = 64;
+
+	const uint32 kNoTriangle = UINT32_MAX;
+	const int32 kNotInCache = -1;
+
+
+	class ForsythScoreTable
+	{
+	public:
+
+		ForsythScoreTable()
+		{
+			for (uint32 cachePosition = 0; cachePosition < kForsythCacheSize; cachePosition++)
+			{
+				// the vertices of the last triangle get a fixed score so that the next triangle doesn't
+				// reuse the same edge, this avoids long thin strips
+				if (cachePosition < 3)
+				{
+					m_cacheScores[cachePosition] = kForsythLastTriangleScore;
+				}
+				else
+				{
+					const float scale = 1.f / (kForsythCacheSize - 3);
+					m_cacheScores[cachePosition] = std::pow(1.f - (cachePosition - 3) * scale, kForsythCacheDecayPower);
+				}
+			}
+
+			m_valenceScores[0] = 0.f;
+			for (uint32 valence = 1; valence <= kForsythMaxTabulatedValence; valence++)
+			{
+				m_valenceScores[valence] = ValenceScore(valence);
+			}
+		}
+
+
+		float VertexScore(int32 cachePosition, uint32 remainingValence) const
+		{
+			if (remainingValence == 0)
+			{
+				// no triangle needs this vertex anymore
+				return -1.f;
+			}
+
+			const float cacheScore = cachePosition == kNotInCache ? 0.f : m_cacheScores[cachePosition];
+			const float valenceScore = remainingValence <= kForsythMaxTabulatedValence ? m_valenceScores[remainingValence] : ValenceScore(remainingValence);
+			return cacheScore + valenceScore;
+		}
+
+	private:
+
+		// vertices with few triangles left are preferred, so that they don't remain isolated
+		static float ValenceScore(uint32 remainingValence)
+		{
+			return kForsythValenceBoostScale * std::pow(float(remainingValence), -kForsythValenceBoostPower);
+		}
+
+		std::array<float, kForsythCacheSize> m_cacheScores;
+		std::array<float, kForsythMaxTabulatedValence + 1> m_valenceScores;
+	};
+
+
+	// fifo post-transform cache: a vertex is still cached while less than cacheSize misses happened after it entered
+	class FifoCacheSimulator
+	{
+	public:
+
+		FifoCacheSimulator(uint32 vertexCount, uint32 cacheSize)
+			: m_cacheSize(cacheSize)
+			, m_time(cacheSize + 1)
+			, m_missCount(0)
+			, m_entryTimes(vertexCount, 0)
+		{}
+
+
+		// returns the number of vertices of the triangle the vertex shader has to transform
+		uint32 Transform(const uint32* triangle)
+		{
+			uint32 misses = 0;
+			for (uint32 corner = 0; corner < 3; corner++)
+			{
+				uint32& entryTime = m_entryTimes[triangle[corner]];
+				if (m_time - entryTime > m_cacheSize)
+				{
+					entryTime = m_time++;
+					misses++;
+				}
+			}
+			m_missCount += misses;
+			return misses;
+		}
+
+
+		// evicts every vertex
+		void Flush()
+		{
+			m_time += m_cacheSize;
+		}
+
+
+		uint32 MissCount() const
+		{
+			return m_missCount;
+		}
+
+	private:
+
+		uint32 m_cacheSize;
+		uint32 m_time;
+		uint32 m_missCount;
+		std::vector<uint32> m_entryTimes;
+	};
+
+
+	XMVECTOR TriangleCross(const MeshData::Vertex* vertices, const uint32* triangle)
+	{
+		// the generators and the obj files wind the triangles so that this points outwards
+		const XMVECTOR a = XMLoadFloat3(&vertices[triangle[0]].position);
+		const XMVECTOR b = XMLoadFloat3(&vertices[triangle[1]].position);
+		const XMVECTOR c = XMLoadFloat3(&vertices[triangle[2]].position);
+		return XMVector3Cross(XMVectorSubtract(b, a), XMVectorSubtract(c, a));
+	}
+
+
+	XMVECTOR TriangleCentroid(const MeshData::Vertex* vertices, const uint32* triangle)
+	{
+		const XMVECTOR a = XMLoadFloat3(&vertices[triangle[0]].position);
+		const XMVECTOR b = XMLoadFloat3(&vertices[triangle[1]].position);
+		const XMVECTOR c = XMLoadFloat3(&vertices[triangle[2]].position);
+		return XMVectorScale(XMVectorAdd(a, XMVectorAdd(b, c)), 1.f / 3.f);
+	}
+
+
+	// a triangle already projected on the viewport, depth in [0, 1] from the camera
+	struct RasterTriangle
+	{
+		float x[3];
+		float y[3];
+		float z[3];
+	};
+
+
+	// half-space rasterization with pixel centers sampling, the depth test is "less"
+	void RasterizeDepth(const RasterTriangle& triangle, std::vector<float>* depthBuffer, std::vector<uint8>* coverage, OverdrawStatistics* statistics)
+	{
+		const float area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) - (triangle.x[2] - triangle.x[0]) * (triangle.y[1] - triangle.y[0]);
+		if (area == 0.f)
+		{
+			return;
+		}
+
+		const float maxCoordinate = float(xtest::mesh::kOverdrawViewportSize - 1);
+		const int32 minX = int32(std::max(0.f, std::floor(std::min({ triangle.x[0], triangle.x[1], triangle.x[2] }))));
+		const int32 maxX = int32(std::min(maxCoordinate, std::ceil(std::max({ triangle.x[0], triangle.x[1], triangle.x[2] }))));
+		const int32 minY = int32(std::max(0.f, std::floor(std::min({ triangle.y[0], triangle.y[1], triangle.y[2] }))));
+		const int32 maxY = int32(std::min(maxCoordinate, std::ceil(std::max({ triangle.y[0], triangle.y[1], triangle.y[2] }))));
+
+		const float inverseArea = 1.f / area;
+		for (int32 y = minY; y <= maxY; y++)
+		{
+			for (int32 x = minX; x <= maxX; x++)
+			{
+				const float px = x + 0.5f;
+				const float py = y + 0.5f;
+
+				// barycentric weights, the sign of the area makes them positive inside for both windings
+				const float w0 = ((triangle.x[2] - triangle.x[1]) * (py - triangle.y[1]) - (triangle.y[2] - triangle.y[1]) * (px - triangle.x[1])) * inverseArea;
+				const float w1 = ((triangle.x[0] - triangle.x[2]) * (py - triangle.y[2]) - (triangle.y[0] - triangle.y[2]) * (px - triangle.x[2])) * inverseArea;
+				const float w2 = 1.f - w0 - w1;
+				if (w0 < 0.f || w1 < 0.f || w2 < 0.f)
+				{
+					continue;
+				}
+
+				const size_t pixel = size_t(y) * xtest::mesh::kOverdrawViewportSize + size_t(x);
+				const float depth = w0 * triangle.z[0] + w1 * triangle.z[1] + w2 * triangle.z[2];
+				if (depth < (*depthBuffer)[pixel])
+				{
+					(*depthBuffer)[pixel] = depth;
+					statistics->shadedPixelCount++;
+					if (!(*coverage)[pixel])
+					{
+						(*coverage)[pixel] = 1;
+						statistics->coveredPixelCount++;
+					}
+				}
+			}
+		}
+	}
+}
+
+
+void xtest::mesh::OptimizeVertexCache(uint32* indices, size_t indexCount, uint32 vertexCount)
+{
+	XTEST_ASSERT(indexCount % 3 == 0);
+	const uint32 triangleCount = uint32(indexCount / 3);
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	static const ForsythScoreTable scoreTable;
+
+
+	// triangles adjacent to every vertex, the first remainingValence entries of a vertex are the ones not emitted yet
+	std::vector<uint32> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t index = 0; index < indexCount; index++)
+	{
+		XTEST_ASSERT(indices[index] < vertexCount);
+		adjacencyOffsets[indices[index] + 1]++;
+	}
+	for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		adjacencyOffsets[vertexIndex + 1] += adjacencyOffsets[vertexIndex];
+	}
+
+	std::vector<uint32> remainingValences(vertexCount, 0);
+	std::vector<uint32> adjacentTriangles(indexCount);
+	for (uint32 triangleIndex = 0; triangleIndex < triangleCount; triangleIndex++)
+	{
+		for (uint32 corner = 0; corner < 3; corner++)
+		{
+			const uint32 vertexIndex = indices[triangleIndex * 3 + corner];
+			adjacentTriangles[adjacencyOffsets[vertexIndex] + remainingValences[vertexIndex]++] = triangleIndex;
+		}
+	}
+
+
+	std::vector<int32> cachePositions(vertexCount, kNotInCache);
+	std::vector<float> vertexScores(vertexCount);
+	for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		vertexScores[vertexIndex] = scoreTable.VertexScore(kNotInCache, remainingValences[vertexIndex]);
+	}
+
+	uint32 bestTriangle = 0;
+	float bestScore = -1.f;
+	for (uint32 triangleIndex = 0; triangleIndex < triangleCount; triangleIndex++)
+	{
+		const uint32* triangle = &indices[triangleIndex * 3];
+		const float score = vertexScores[triangle[0]] + vertexScores[triangle[1]] + vertexScores[triangle[2]];
+		if (score > bestScore)
+		{
+			bestScore = score;
+			bestTriangle = triangleIndex;
+		}
+	}
+
+
+	std::vector<uint32> optimizedIndices(indexCount);
+	std::vector<bool> emitted(triangleCount, false);
+	std::array<uint32, kForsythCacheSize + 3> cache;
+	std::array<uint32, kForsythCacheSize + 3> nextCache;
+	uint32 cacheCount = 0;
+	uint32 nextNotEmitted = 0;
+
+	for (uint32 outputTriangle = 0; outputTriangle < triangleCount; outputTriangle++)
+	{
+		if (bestTriangle == kNoTriangle)
+		{
+			// nothing adjacent to the cache is left, restart from the first triangle not emitted yet
+			while (emitted[nextNotEmitted])
+			{
+				nextNotEmitted++;
+			}
+			bestTriangle = nextNotEmitted;
+		}
+
+		const uint32* triangle = &indices[bestTriangle * 3];
+		std::copy(triangle, triangle + 3, &optimizedIndices[outputTriangle * 3]);
+		emitted[bestTriangle] = true;
+
+		// the triangle is not pending anymore for its vertices
+		for (uint32 corner = 0; corner < 3; corner++)
+		{
+			const uint32 vertexIndex = triangle[corner];
+			uint32* vertexTriangles = &adjacentTriangles[adjacencyOffsets[vertexIndex]];
+			uint32* lastTriangle = vertexTriangles + --remainingValences[vertexIndex];
+			std::swap(*std::find(vertexTriangles, lastTriangle + 1, bestTriangle), *lastTriangle);
+		}
+
+		// lru update: the triangle vertices go in front, the ones pushed past the cache size are evicted
+		uint32 nextCacheCount = 0;
+		for (uint32 corner = 0; corner < 3; corner++)
+		{
+			if (std::find(nextCache.begin(), nextCache.begin() + nextCacheCount, triangle[corner]) == nextCache.begin() + nextCacheCount)
+			{
+				nextCache[nextCacheCount++] = triangle[corner];
+			}
+		}
+		for (uint32 cacheIndex = 0; cacheIndex < cacheCount; cacheIndex++)
+		{
+			const uint32 vertexIndex = cache[cacheIndex];
+			if (vertexIndex != triangle[0] && vertexIndex != triangle[1] && vertexIndex != triangle[2])
+			{
+				nextCache[nextCacheCount++] = vertexIndex;
+			}
+		}
+
+		for (uint32 cacheIndex = 0; cacheIndex < nextCacheCount; cacheIndex++)
+		{
+			const uint32 vertexIndex = nextCache[cacheIndex];
+			cachePositions[vertexIndex] = cacheIndex < kForsythCacheSize ? int32(cacheIndex) : kNotInCache;
+			vertexScores[vertexIndex] = scoreTable.VertexScore(cachePositions[vertexIndex], remainingValences[vertexIndex]);
+		}
+
+		// only the triangles touching the cache changed score, the best one of them is the next candidate
+		bestTriangle = kNoTriangle;
+		bestScore = -1.f;
+		for (uint32 cacheIndex = 0; cacheIndex < nextCacheCount; cacheIndex++)
+		{
+			const uint32 vertexIndex = nextCache[cacheIndex];
+			const uint32* vertexTriangles = &adjacentTriangles[adjacencyOffsets[vertexIndex]];
+			for (uint32 adjacentIndex = 0; adjacentIndex < remainingValences[vertexIndex]; adjacentIndex++)
+			{
+				const uint32 triangleIndex = vertexTriangles[adjacentIndex];
+				const uint32* adjacentTriangle = &indices[triangleIndex * 3];
+				const float score = vertexScores[adjacentTriangle[0]] + vertexScores[adjacentTriangle[1]] + vertexScores[adjacentTriangle[2]];
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = triangleIndex;
+				}
+			}
+		}
+
+		cacheCount = std::min(nextCacheCount, kForsythCacheSize);
+		std::copy(nextCache.begin(), nextCache.begin() + cacheCount, cache.begin());
+	}
+
+	std::copy(optimizedIndices.begin(), optimizedIndices.end(), indices);
+}
+
+
+void xtest::mesh::OptimizeVertexCache(MeshData& meshData)
+{
+	OptimizeVertexCache(meshData.indices.data(), meshData.indices.size(), uint32(meshData.vertices.size()));
+}
+
+
+void xtest::mesh::OptimizeVertexFetch(MeshData::Vertex* vertices, uint32 vertexCount, uint32* indices, size_t indexCount)
+{
+	const uint32 kNotRemapped = UINT32_MAX;
+	std::vector<uint32> remap(vertexCount, kNotRemapped);
+
+	uint32 nextVertex = 0;
+	for (size_t index = 0; index < indexCount; index++)
+	{
+		XTEST_ASSERT(indices[index] < vertexCount);
+		uint32& newIndex = remap[indices[index]];
+		if (newIndex == kNotRemapped)
+		{
+			newIndex = nextVertex++;
+		}
+		indices[index] = newIndex;
+	}
+
+	std::vector<MeshData::Vertex> sourceVertices(vertices, vertices + vertexCount);
+	for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		if (remap[vertexIndex] == kNotRemapped)
+		{
+			remap[vertexIndex] = nextVertex++;
+		}
+		vertices[remap[vertexIndex]] = sourceVertices[vertexIndex];
+	}
+}
+
+
+void xtest::mesh::OptimizeVertexFetch(MeshData& meshData)
+{
+	OptimizeVertexFetch(meshData.vertices.data(), uint32(meshData.vertices.size()), meshData.indices.data(), meshData.indices.size());
+}
+
+
+void xtest::mesh::OptimizeOverdraw(uint32* indices, size_t indexCount, const MeshData::Vertex* vertices, uint32 vertexCount, float acmrThreshold)
+{
+	XTEST_ASSERT(indexCount % 3 == 0);
+	const uint32 triangleCount = uint32(indexCount / 3);
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	FifoCacheSimulator cache(vertexCount, kDefaultAnalyzedVertexCacheSize);
+
+	// hard boundaries: a triangle with all its vertices out of the cache most likely starts a new patch,
+	// moving patches around doesn't change the cache behavior
+	std::vector<uint32> patchStarts;
+	for (uint32 triangleIndex = 0; triangleIndex < triangleCount; triangleIndex++)
+	{
+		if (cache.Transform(&indices[triangleIndex * 3]) == 3 || triangleIndex == 0)
+		{
+			patchStarts.push_back(triangleIndex);
+		}
+	}
+	patchStarts.push_back(triangleCount);
+
+	// soft boundaries: a patch is split every time the cache miss ratio of the current cluster is back
+	// under the threshold, smaller clusters can be sorted better
+	std::vector<uint32> clusterStarts;
+	for (size_t patchIndex = 0; patchIndex + 1 < patchStarts.size(); patchIndex++)
+	{
+		const uint32 patchBegin = patchStarts[patchIndex];
+		const uint32 patchEnd = patchStarts[patchIndex + 1];
+
+		cache.Flush();
+		const uint32 missCountBefore = cache.MissCount();
+		for (uint32 triangleIndex = patchBegin; triangleIndex < patchEnd; triangleIndex++)
+		{
+			cache.Transform(&indices[triangleIndex * 3]);
+		}
+		const float clusterMissThreshold = acmrThreshold * float(cache.MissCount() - missCountBefore) / float(patchEnd - patchBegin);
+
+		cache.Flush();
+		clusterStarts.push_back(patchBegin);
+		uint32 clusterMissCount = 0;
+		uint32 clusterTriangleCount = 0;
+		for (uint32 triangleIndex = patchBegin; triangleIndex < patchEnd; triangleIndex++)
+		{
+			clusterMissCount += cache.Transform(&indices[triangleIndex * 3]);
+			clusterTriangleCount++;
+
+			if (float(clusterMissCount) <= clusterMissThreshold * clusterTriangleCount && triangleIndex + 1 < patchEnd)
+			{
+				clusterStarts.push_back(triangleIndex + 1);
+				cache.Flush();
+				clusterMissCount = 0;
+				clusterTriangleCount = 0;
+			}
+		}
+	}
+	const uint32 clusterCount = uint32(clusterStarts.size());
+	clusterStarts.push_back(triangleCount);
+
+
+	// area weighted centroids and normals of every cluster and of the whole mesh
+	std::vector<XMFLOAT3> clusterCentroids(clusterCount);
+	std::vector<XMFLOAT3> clusterNormals(clusterCount);
+	XMVECTOR meshCentroid = XMVectorZero();
+	float meshArea = 0.f;
+	for (uint32 clusterIndex = 0; clusterIndex < clusterCount; clusterIndex++)
+	{
+		XMVECTOR centroid = XMVectorZero();
+		XMVECTOR normal = XMVectorZero();
+		float area = 0.f;
+		for (uint32 triangleIndex = clusterStarts[clusterIndex]; triangleIndex < clusterStarts[clusterIndex + 1]; triangleIndex++)
+		{
+			const uint32* triangle = &indices[triangleIndex * 3];
+			const XMVECTOR cross = TriangleCross(vertices, triangle);
+			const float triangleArea = XMVectorGetX(XMVector3Length(cross));
+
+			centroid = XMVectorAdd(centroid, XMVectorScale(TriangleCentroid(vertices, triangle), triangleArea));
+			normal = XMVectorAdd(normal, cross);
+			area += triangleArea;
+		}
+
+		meshCentroid = XMVectorAdd(meshCentroid, centroid);
+		meshArea += area;
+		XMStoreFloat3(&clusterCentroids[clusterIndex], area > 0.f ? XMVectorScale(centroid, 1.f / area) : centroid);
+		XMStoreFloat3(&clusterNormals[clusterIndex], XMVector3Normalize(normal));
+	}
+	meshCentroid = meshArea > 0.f ? XMVectorScale(meshCentroid, 1.f / meshArea) : meshCentroid;
+
+	// clusters far from the center and facing outwards are more likely to hide the others
+	std::vector<float> occlusionPotentials(clusterCount);
+	for (uint32 clusterIndex = 0; clusterIndex < clusterCount; clusterIndex++)
+	{
+		const XMVECTOR offset = XMVectorSubtract(XMLoadFloat3(&clusterCentroids[clusterIndex]), meshCentroid);
+		occlusionPotentials[clusterIndex] = XMVectorGetX(XMVector3Dot(offset, XMLoadFloat3(&clusterNormals[clusterIndex])));
+	}
+
+	std::vector<uint32> clusterOrder(clusterCount);
+	for (uint32 clusterIndex = 0; clusterIndex < clusterCount; clusterIndex++)
+	{
+		clusterOrder[clusterIndex] = clusterIndex;
+	}
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&occlusionPotentials](uint32 first, uint32 second)
+	{
+		return occlusionPotentials[first] > occlusionPotentials[second];
+	});
+
+
+	std::vector<uint32> sortedIndices;
+	sortedIndices.reserve(indexCount);
+	for (uint32 clusterIndex : clusterOrder)
+	{
+		sortedIndices.insert(sortedIndices.end(), &indices[clusterStarts[clusterIndex] * 3], &indices[clusterStarts[clusterIndex + 1] * 3]);
+	}
+	std::copy(sortedIndices.begin(), sortedIndices.end(), indices);
+}
+
+
+void xtest::mesh::OptimizeOverdraw(MeshData& meshData, float acmrThreshold)
+{
+	OptimizeOverdraw(meshData.indices.data(), meshData.indices.size(), meshData.vertices.data(), uint32(meshData.vertices.size()), acmrThreshold);
+}
+
+
+VertexCacheStatistics xtest::mesh::AnalyzeVertexCache(const uint32* indices, size_t indexCount, uint32 vertexCount, uint32 cacheSize)
+{
+	XTEST_ASSERT(cacheSize > 0);
+
+	VertexCacheStatistics statistics;
+	statistics.triangleCount = uint32(indexCount / 3);
+	statistics.vertexCount = vertexCount;
+
+	FifoCacheSimulator cache(vertexCount, cacheSize);
+	for (uint32 triangleIndex = 0; triangleIndex < statistics.triangleCount; triangleIndex++)
+	{
+		cache.Transform(&indices[triangleIndex * 3]);
+	}
+
+	statistics.transformedVertexCount = cache.MissCount();
+	statistics.acmr = statistics.triangleCount == 0 ? 0.f : float(statistics.transformedVertexCount) / statistics.triangleCount;
+	statistics.atvr = vertexCount == 0 ? 0.f : float(statistics.transformedVertexCount) / vertexCount;
+	return statistics;
+}
+
+
+VertexCacheStatistics xtest::mesh::AnalyzeVertexCache(const MeshData& meshData, uint32 cacheSize)
+{
+	return AnalyzeVertexCache(meshData.indices.data(), meshData.indices.size(), uint32(meshData.vertices.size()), cacheSize);
+}
+
+
+OverdrawStatistics xtest::mesh::AnalyzeOverdraw(const uint32* indices, size_t indexCount, const MeshData::Vertex* vertices, uint32 vertexCount)
+{
+	OverdrawStatistics statistics;
+	if (vertexCount == 0 || indexCount < 3)
+	{
+		return statistics;
+	}
+
+	XMVECTOR boundsMin = XMLoadFloat3(&vertices[0].position);
+	XMVECTOR boundsMax = boundsMin;
+	for (uint32 vertexIndex = 1; vertexIndex < vertexCount; vertexIndex++)
+	{
+		const XMVECTOR position = XMLoadFloat3(&vertices[vertexIndex].position);
+		boundsMin = XMVectorMin(boundsMin, position);
+		boundsMax = XMVectorMax(boundsMax, position);
+	}
+
+	// uniform scale so that the mesh keeps its proportions in every view
+	XMFLOAT3 extents;
+	XMStoreFloat3(&extents, XMVectorSubtract(boundsMax, boundsMin));
+	const float maxExtent = std::max({ extents.x, extents.y, extents.z });
+	const float scale = maxExtent > 0.f ? 1.f / maxExtent : 0.f;
+
+	std::vector<XMFLOAT3> normalizedPositions(vertexCount);
+	for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		XMStoreFloat3(&normalizedPositions[vertexIndex], XMVectorScale(XMVectorSubtract(XMLoadFloat3(&vertices[vertexIndex].position), boundsMin), scale));
+	}
+
+	const size_t pixelCount = size_t(kOverdrawViewportSize) * kOverdrawViewportSize;
+	std::vector<float> depthBuffer(pixelCount);
+	std::vector<uint8> coverage(pixelCount);
+	const float viewportScale = float(kOverdrawViewportSize);
+
+	// the view looks along +axis or -axis, the other two axes are the screen ones
+	for (uint32 axis = 0; axis < 3; axis++)
+	{
+		for (uint32 side = 0; side < 2; side++)
+		{
+			std::fill(depthBuffer.begin(), depthBuffer.end(), std::numeric_limits<float>::max());
+			std::fill(coverage.begin(), coverage.end(), uint8(0));
+
+			const float viewDirection = side == 0 ? 1.f : -1.f;
+			for (size_t index = 0; index + 2 < indexCount; index += 3)
+			{
+				const uint32* triangle = &indices[index];
+
+				// back faces are culled, the triangle cross product points outwards
+				XMFLOAT3 cross;
+				XMStoreFloat3(&cross, TriangleCross(vertices, triangle));
+				if ((&cross.x)[axis] * viewDirection >= 0.f)
+				{
+					continue;
+				}
+
+				RasterTriangle rasterTriangle;
+				for (uint32 corner = 0; corner < 3; corner++)
+				{
+					const float* position = &normalizedPositions[triangle[corner]].x;
+					rasterTriangle.x[corner] = position[(axis + 1) % 3] * viewportScale;
+					rasterTriangle.y[corner] = position[(axis + 2) % 3] * viewportScale;
+					rasterTriangle.z[corner] = side == 0 ? position[axis] : 1.f - position[axis];
+				}
+				RasterizeDepth(rasterTriangle, &depthBuffer, &coverage, &statistics);
+			}
+		}
+	}
+
+	statistics.overdraw = statistics.coveredPixelCount == 0 ? 0.f : float(statistics.shadedPixelCount) / statistics.coveredPixelCount;
+	return statistics;
+}
+
+
+OverdrawStatistics xtest::mesh::AnalyzeOverdraw(const MeshData& meshData)
+{
+	return AnalyzeOverdraw(meshData.indices.data(), meshData.indices.size(), meshData.vertices.data(), uint32(meshData.vertices.size()));
+}
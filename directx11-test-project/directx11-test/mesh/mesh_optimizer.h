@@ -0,0 +1,85 @@
+#pragma once
+
+#include <mesh/mesh_format.h>
+
+
+namespace xtest {
+namespace mesh {
+
+	// size of the fifo cache simulated by AnalyzeVertexCache when not specified, close to what
+	// current hardware effectively gives to a vertex shader with 44 bytes of output
+	const uint32 kDefaultAnalyzedVertexCacheSize = 16;
+
+	// OptimizeOverdraw can make the cache miss ratio of each cluster up to 5% worse
+	const float kDefaultOverdrawAcmrThreshold = 1.05f;
+
+	// side of the square depth buffer AnalyzeOverdraw renders to
+	const uint32 kOverdrawViewportSize = 256;
+
+
+	struct VertexCacheStatistics
+	{
+		uint32 triangleCount = 0;
+		uint32 vertexCount = 0;
+		uint32 transformedVertexCount = 0;	// vertex shader invocations with the simulated cache
+		float acmr = 0.f;	// average cache miss ratio: transformed vertices per triangle, 0.5 is the best possible
+		float atvr = 0.f;	// average transformed vertex ratio: transformed vertices per vertex, 1 is the best possible
+	};
+
+
+	struct OverdrawStatistics
+	{
+		uint64 coveredPixelCount = 0;	// pixels covered by at least one front facing triangle
+		uint64 shadedPixelCount = 0;	// pixels that passed the depth test, so the pixel shader would run on them
+		float overdraw = 0.f;			// shaded pixels per covered pixel, 1 is the best possible
+	};
+
+
+	/**
+	Reorders the triangles so that the vertices already transformed by the gpu are reused as much
+	as possible (Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"), it runs in linear time.
+	The vertices are not touched, call OptimizeVertexFetch afterwards to also improve the memory
+	access pattern of the vertex buffer.
+	@param indices		The triangle list to reorder in place.
+	@param indexCount	The number of indices, a multiple of 3.
+	@param vertexCount	The number of vertices referenced by the indices.
+	*/
+	void OptimizeVertexCache(uint32* indices, size_t indexCount, uint32 vertexCount);
+	void OptimizeVertexCache(MeshData& meshData);
+
+
+	/**
+	Renumbers the vertices in the order they are first used by the triangles and moves them
+	accordingly, so that the vertex buffer is read almost sequentially. Vertices that are not
+	referenced are moved at the end. The triangle order is not touched.
+	*/
+	void OptimizeVertexFetch(MeshData::Vertex* vertices, uint32 vertexCount, uint32* indices, size_t indexCount);
+	void OptimizeVertexFetch(MeshData& meshData);
+
+
+	/**
+	Reorders the triangles to reduce overdraw without undoing most of the vertex cache optimization
+	(Sander, Nehab, Barczak - "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+	The triangle list, already optimized by OptimizeVertexCache, is split in clusters where the cache
+	would be cold anyway, then in smaller clusters as long as the cache miss ratio of each one stays within
+	acmrThreshold times the one of the cluster it comes from. The clusters are then sorted so that the ones
+	facing outwards, that are more likely to occlude the rest of the mesh, are drawn first; the order
+	doesn't depend on the point of view.
+	*/
+	void OptimizeOverdraw(uint32* indices, size_t indexCount, const MeshData::Vertex* vertices, uint32 vertexCount, float acmrThreshold = kDefaultOverdrawAcmrThreshold);
+	void OptimizeOverdraw(MeshData& meshData, float acmrThreshold = kDefaultOverdrawAcmrThreshold);
+
+
+	// simulates a post-transform fifo cache of cacheSize entries over the triangle list
+	VertexCacheStatistics AnalyzeVertexCache(const uint32* indices, size_t indexCount, uint32 vertexCount, uint32 cacheSize = kDefaultAnalyzedVertexCacheSize);
+	VertexCacheStatistics AnalyzeVertexCache(const MeshData& meshData, uint32 cacheSize = kDefaultAnalyzedVertexCacheSize);
+
+
+	// rasterizes the depth of the front facing triangles, in index order, from the 6 axis aligned directions
+	// with an orthographic projection fitting the mesh bounds, and sums the pixels of every view
+	OverdrawStatistics AnalyzeOverdraw(const uint32* indices, size_t indexCount, const MeshData::Vertex* vertices, uint32 vertexCount);
+	OverdrawStatistics AnalyzeOverdraw(const MeshData& meshData);
+
+} // mesh
+} // xtest
+
@@ -0,0 +1,263 @@
+#include "stdafx.h"
+#include "mesh_parametric.h"
+#include <mesh/mesh_bounds.h>
+
+
+using namespace DirectX;
+using xtest::mesh::MeshData;
+using xtest::mesh::ParametricColumns;
+using xtest::mesh::ParametricPoints;
+using xtest::mesh::SphereSurface;
+using xtest::mesh::TorusSurface;
+using xtest::mesh::TorusKnotSurface;
+
+
+namespace
+{
+	// normalizes 4 non zero vectors given by components
+	void NormalizeQuad(XMVECTOR* components)
+	{
+		const XMVECTOR lengthSq = XMVectorAdd(XMVectorAdd(XMVectorMultiply(components[0], components[0]),
+			XMVectorMultiply(components[1], components[1])), XMVectorMultiply(components[2], components[2]));
+		const XMVECTOR length = XMVectorSqrt(lengthSq);
+		for (uint32 component = 0; component < 3; component++)
+		{
+			components[component] = XMVectorDivide(components[component], length);
+		}
+	}
+
+
+	// all the vertices of the row share the position of the first one
+	bool IsCollapsedRow(const MeshData::Vertex* rowVertices, uint32 rowVertexCount)
+	{
+		const XMFLOAT3& first = rowVertices[0].position;
+		for (uint32 column = 1; column < rowVertexCount; column++)
+		{
+			const XMFLOAT3& position = rowVertices[column].position;
+			if (position.x != first.x || position.y != first.y || position.z != first.z)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	void SplatFloat3(const XMFLOAT3& value, XMVECTOR* components)
+	{
+		components[0] = XMVectorReplicate(value.x);
+		components[1] = XMVectorReplicate(value.y);
+		components[2] = XMVectorReplicate(value.z);
+	}
+}
+
+
+void xtest::mesh::StoreParametricPoints(const ParametricPoints& points, FXMVECTOR u, float v, uint32 count, MeshData::Vertex* vertices)
+{
+	XMVECTOR normal[3];
+	normal[0] = XMVectorSubtract(XMVectorMultiply(points.dPdu[1], points.dPdv[2]), XMVectorMultiply(points.dPdu[2], points.dPdv[1]));
+	normal[1] = XMVectorSubtract(XMVectorMultiply(points.dPdu[2], points.dPdv[0]), XMVectorMultiply(points.dPdu[0], points.dPdv[2]));
+	normal[2] = XMVectorSubtract(XMVectorMultiply(points.dPdu[0], points.dPdv[1]), XMVectorMultiply(points.dPdu[1], points.dPdv[0]));
+	NormalizeQuad(normal);
+
+	XMVECTOR tangentU[3] = { points.dPdu[0], points.dPdu[1], points.dPdu[2] };
+	NormalizeQuad(tangentU);
+
+	// back to one vertex per lane
+	float lanes[10][4];
+	for (uint32 component = 0; component < 3; component++)
+	{
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(lanes[component]), points.position[component]);
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(lanes[3 + component]), normal[component]);
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(lanes[6 + component]), tangentU[component]);
+	}
+	XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(lanes[9]), u);
+
+	for (uint32 lane = 0; lane < count; lane++)
+	{
+		MeshData::Vertex& vertex = vertices[lane];
+		vertex.position = { lanes[0][lane], lanes[1][lane], lanes[2][lane] };
+		vertex.normal = { lanes[3][lane], lanes[4][lane], lanes[5][lane] };
+		vertex.tangentU = { lanes[6][lane], lanes[7][lane], lanes[8][lane] };
+		vertex.uv = { lanes[9][lane], v };
+	}
+}
+
+
+void xtest::mesh::CompleteParametricGrid(uint32 uSegments, uint32 vSegments, bool wrapU, bool wrapV, uint32 threadCount, MeshData* mesh)
+{
+	const uint32 rowVertexCount = uSegments + 1;
+	const uint32 rowCount = vSegments + 1;
+	std::vector<MeshData::Vertex>& vertices = mesh->vertices;
+	XTEST_ASSERT(vertices.size() == size_t(rowVertexCount) * rowCount, L"the grid has %zu vertices instead of %u x %u", vertices.size(), rowVertexCount, rowCount);
+
+	if (wrapU)
+	{
+		for (uint32 row = 0; row < (wrapV ? vSegments : rowCount); row++)
+		{
+			MeshData::Vertex* rowVertices = &vertices[size_t(row) * rowVertexCount];
+			rowVertices[uSegments] = rowVertices[0];
+			rowVertices[uSegments].uv.x = 1.f;
+		}
+	}
+
+	if (wrapV)
+	{
+		MeshData::Vertex* lastRowVertices = &vertices[size_t(vSegments) * rowVertexCount];
+		for (uint32 column = 0; column < rowVertexCount; column++)
+		{
+			lastRowVertices[column] = vertices[column];
+			lastRowVertices[column].uv.y = 1.f;
+		}
+	}
+
+
+	// the cells touching a collapsed row have a single triangle, every row of cells gets its range of indices
+	std::vector<bool> collapsedRows(rowCount);
+	for (uint32 row = 0; row < rowCount; row++)
+	{
+		collapsedRows[row] = IsCollapsedRow(&vertices[size_t(row) * rowVertexCount], rowVertexCount);
+	}
+
+	std::vector<size_t> cellRowIndexOffsets(vSegments + 1);
+	for (uint32 cellRow = 0; cellRow < vSegments; cellRow++)
+	{
+		const uint32 cellTriangleCount = (collapsedRows[cellRow] ? 0 : 1) + (collapsedRows[cellRow + 1] ? 0 : 1);
+		cellRowIndexOffsets[cellRow + 1] = cellRowIndexOffsets[cellRow] + 3 * cellTriangleCount * uSegments;
+	}
+	mesh->indices.resize(cellRowIndexOffsets[vSegments]);
+
+	common::ParallelFor(vSegments, threadCount, [&](uint32 cellRow)
+	{
+		const bool hasUpperTriangles = !collapsedRows[cellRow];
+		const bool hasLowerTriangles = !collapsedRows[cellRow + 1];
+		const uint32 baseIndex = cellRow * rowVertexCount;
+		uint32* indices = mesh->indices.data() + cellRowIndexOffsets[cellRow];
+		for (uint32 column = 0; column < uSegments; column++)
+		{
+			const uint32 i0 = baseIndex + column;
+			const uint32 i1 = i0 + 1;
+			const uint32 i2 = i0 + rowVertexCount;
+			const uint32 i3 = i2 + 1;
+
+			if (hasUpperTriangles)
+			{
+				*indices++ = i0;
+				*indices++ = i1;
+				*indices++ = i2;
+			}
+			if (hasLowerTriangles)
+			{
+				*indices++ = i2;
+				*indices++ = i1;
+				*indices++ = i3;
+			}
+		}
+	});
+
+	mesh->bounds = ComputeBounds(*mesh);
+}
+
+
+void SphereSurface::Evaluate(const ParametricColumns& columns, float v, ParametricPoints* points) const
+{
+	const XMVECTOR sinTheta = columns.sinAngle;
+	const XMVECTOR cosTheta = columns.cosAngle;
+
+	// from the closer pole, so that both poles collapse to a single point exactly
+	const float sinPhi = sinf(XM_PI * std::min(v, 1.f - v));
+	const float cosPhi = v <= 0.5f ? cosf(XM_PI * v) : -cosf(XM_PI * (1.f - v));
+
+	points->position[0] = XMVectorScale(cosTheta, radius * sinPhi);
+	points->position[1] = XMVectorReplicate(radius * cosPhi);
+	points->position[2] = XMVectorScale(sinTheta, radius * sinPhi);
+
+	// dP/dtheta divided by radius * sin(phi), so that it doesn't vanish at the poles
+	points->dPdu[0] = XMVectorNegate(sinTheta);
+	points->dPdu[1] = XMVectorZero();
+	points->dPdu[2] = cosTheta;
+
+	points->dPdv[0] = XMVectorScale(cosTheta, radius * cosPhi);
+	points->dPdv[1] = XMVectorReplicate(-radius * sinPhi);
+	points->dPdv[2] = XMVectorScale(sinTheta, radius * cosPhi);
+}
+
+
+void TorusSurface::Evaluate(const ParametricColumns& columns, float v, ParametricPoints* points) const
+{
+	const XMVECTOR sinPhi = columns.sinAngle;
+	const XMVECTOR cosPhi = columns.cosAngle;
+
+	const float sinTheta = sinf(XM_2PI * v);
+	const float cosTheta = cosf(XM_2PI * v);
+
+	// distance of the points from the axis
+	const XMVECTOR axisDistance = XMVectorAdd(XMVectorReplicate(ringRadius), XMVectorScale(cosPhi, tubeRadius));
+
+	points->position[0] = XMVectorScale(axisDistance, cosTheta);
+	points->position[1] = XMVectorScale(sinPhi, tubeRadius);
+	points->position[2] = XMVectorScale(axisDistance, sinTheta);
+
+	points->dPdu[0] = XMVectorScale(sinPhi, -cosTheta);
+	points->dPdu[1] = cosPhi;
+	points->dPdu[2] = XMVectorScale(sinPhi, -sinTheta);
+
+	points->dPdv[0] = XMVectorReplicate(-sinTheta);
+	points->dPdv[1] = XMVectorZero();
+	points->dPdv[2] = XMVectorReplicate(cosTheta);
+}
+
+
+void TorusKnotSurface::Evaluate(const ParametricColumns& columns, float v, ParametricPoints* points) const
+{
+	// the point of the knot, the same for the whole row
+	const float theta = XM_2PI * v;
+	const float pf = float(p);
+	const float qf = float(q);
+	const float sinQTheta = sinf(qf * theta);
+	const float cosQTheta = cosf(qf * theta);
+	const float sinPTheta = sinf(pf * theta);
+	const float cosPTheta = cosf(pf * theta);
+
+	const XMFLOAT3 X = { (R + r * cosQTheta) * cosPTheta, (R + r * cosQTheta) * sinPTheta, r * sinQTheta };
+	const XMFLOAT3 T = {
+		-pf * (R + r * cosQTheta) * sinPTheta - qf * r * sinQTheta * cosPTheta,
+		 pf * (R + r * cosQTheta) * cosPTheta - qf * r * sinQTheta * sinPTheta,
+		 qf * r * cosQTheta };
+
+	// the tube frame: the knot tangent, the direction away from the torus core circle made orthogonal to it
+	// and their cross product
+	const XMVECTOR tangentV = XMVector3Normalize(XMLoadFloat3(&T));
+	const XMVECTOR away = XMVectorSet(cosPTheta * cosQTheta, sinPTheta * cosQTheta, sinQTheta, 0.f);
+	const XMVECTOR normalV = XMVector3Normalize(XMVectorSubtract(away, XMVectorMultiply(XMVector3Dot(away, tangentV), tangentV)));
+	const XMVECTOR binormalV = XMVector3Cross(tangentV, normalV);
+
+	XMFLOAT3 tangent;
+	XMFLOAT3 normal;
+	XMFLOAT3 binormal;
+	XMStoreFloat3(&tangent, tangentV);
+	XMStoreFloat3(&normal, normalV);
+	XMStoreFloat3(&binormal, binormalV);
+
+	XMVECTOR tubeCenter[3];
+	XMVECTOR tubeNormal[3];
+	XMVECTOR tubeBinormal[3];
+	SplatFloat3(X, tubeCenter);
+	SplatFloat3(normal, tubeNormal);
+	SplatFloat3(binormal, tubeBinormal);
+
+	// around the tube
+	const XMVECTOR sinPhi = columns.sinAngle;
+	const XMVECTOR cosPhi = columns.cosAngle;
+
+	for (uint32 component = 0; component < 3; component++)
+	{
+		const XMVECTOR outwards = XMVectorAdd(XMVectorMultiply(cosPhi, tubeNormal[component]), XMVectorMultiply(sinPhi, tubeBinormal[component]));
+		points->position[component] = XMVectorAdd(tubeCenter[component], XMVectorScale(outwards, tubeRadius));
+		points->dPdu[component] = XMVectorSubtract(XMVectorMultiply(cosPhi, tubeBinormal[component]), XMVectorMultiply(sinPhi, tubeNormal[component]));
+	}
+
+	// along the knot the tube normal is the outwards direction whatever the frame rotation, the knot tangent
+	// gives the same normal as the exact partial derivative
+	SplatFloat3(tangent, points->dPdv);
+}
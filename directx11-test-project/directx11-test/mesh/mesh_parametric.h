@@ -0,0 +1,100 @@
+#pragma once
+
+#include <mesh/mesh_format.h>
+
+
+namespace xtest {
+namespace mesh {
+
+	// the rows of smaller grids are generated on the calling thread, starting threads would cost more
+	const uint32 kMinParallelParametricVertexCount = 64 * 1024;
+
+
+	// 4 points of a row of a parametric surface in structure of arrays layout, every vector holds a
+	// component of all of them
+	struct ParametricPoints
+	{
+		DirectX::XMVECTOR position[3];
+		DirectX::XMVECTOR dPdu[3];	// directions of the surface along u and v, of any non zero length
+		DirectX::XMVECTOR dPdv[3];
+	};
+
+
+	// 4 columns of a parametric grid, the same for every row: their u and the sine and cosine of the angle 2 pi u
+	// that every surface here goes around once along u
+	struct ParametricColumns
+	{
+		DirectX::XMVECTOR u;
+		DirectX::XMVECTOR sinAngle;
+		DirectX::XMVECTOR cosAngle;
+	};
+
+
+	/**
+	Generates the grid of (uSegments + 1) x (vSegments + 1) vertices of a parametric surface, with u and v going
+	from 0 to 1, and the two triangles of every grid cell. Surface is a type with the method
+		void Evaluate(const ParametricColumns& columns, float v, ParametricPoints* points) const;
+	computing 4 points of the row v at once, the columns are computed once for the whole grid. The vertex normal
+	is normalize(cross(dPdu, dPdv)), so the directions have to be oriented to make it point outwards, the tangentU
+	is normalize(dPdu) and the uv is (u, v).
+	The triangles of a cell are (u, v) (u + 1, v) (u, v + 1) and (u, v + 1) (u + 1, v) (u + 1, v + 1). A row
+	whose vertices all share the same position, like the poles of a sphere, gets only the triangles that are
+	not degenerate. The mesh bounds are computed as well.
+	@param uSegments	The number of cells along u.
+	@param vSegments	The number of cells along v.
+	@param wrapU		The surface closes along u: the last column of vertices takes the position, normal and
+						tangent of the first one so that the seam has no cracks, only the uv differs.
+	@param wrapV		The same along v, for the last row.
+	@param threadCount	The rows are spread over this many threads, 0 means one per hardware thread. Grids smaller
+						than kMinParallelParametricVertexCount are generated on the calling thread. The output
+						doesn't depend on the thread count.
+	*/
+	template <typename Surface>
+	MeshData GenerateParametric(const Surface& surface, uint32 uSegments, uint32 vSegments, bool wrapU, bool wrapV, uint32 threadCount = 0);
+
+
+	// centered in the origin, v goes from the top pole (+y) to the bottom one
+	struct SphereSurface
+	{
+		float radius = 1.f;
+
+		void Evaluate(const ParametricColumns& columns, float v, ParametricPoints* points) const;
+	};
+
+
+	// around the y axis, u goes around the tube and v around the axis
+	struct TorusSurface
+	{
+		float ringRadius = 1.f;	// from the axis to the center of the tube
+		float tubeRadius = 0.25f;
+
+		void Evaluate(const ParametricColumns& columns, float v, ParametricPoints* points) const;
+	};
+
+
+	// a tube around the (p, q) torus knot drawn on the torus with radius R and tube radius r, u goes around
+	// the tube and v along the knot
+	struct TorusKnotSurface
+	{
+		float r = 1.f;
+		float R = 3.f;
+		float tubeRadius = 0.25f;
+		uint32 q = 3;
+		uint32 p = 2;
+
+		void Evaluate(const ParametricColumns& columns, float v, ParametricPoints* points) const;
+	};
+
+
+	// the parts of GenerateParametric that don't depend on the surface
+
+	// writes the first count points of the row v, the u values of the points are in u
+	void StoreParametricPoints(const ParametricPoints& points, DirectX::FXMVECTOR u, float v, uint32 count, MeshData::Vertex* vertices);
+
+	// fills the wrapped column and row of a grid whose other vertices are already there, then its indices and bounds
+	void CompleteParametricGrid(uint32 uSegments, uint32 vSegments, bool wrapU, bool wrapV, uint32 threadCount, MeshData* mesh);
+
+} // mesh
+} // xtest
+
+#include "mesh_parametric.inl"
@@ -0,0 +1,50 @@
+#include "mesh_parametric.h"
+#pragma once
+
+#include <common/parallel_for.h>
+
+
+template <typename Surface>
+xtest::mesh::MeshData xtest::mesh::GenerateParametric(const Surface& surface, uint32 uSegments, uint32 vSegments, bool wrapU, bool wrapV, uint32 threadCount)
+{
+	XTEST_ASSERT(uSegments > 0 && vSegments > 0, L"a parametric grid needs at least a cell");
+
+	const uint32 rowVertexCount = uSegments + 1;
+	MeshData mesh;
+	mesh.vertices.resize(size_t(rowVertexCount) * (vSegments + 1));
+	if (mesh.vertices.size() < kMinParallelParametricVertexCount)
+	{
+		threadCount = 1;
+	}
+
+	// the wrapped column and row are copies of the first ones, see CompleteParametricGrid
+	const uint32 evaluatedColumnCount = wrapU ? uSegments : rowVertexCount;
+	const uint32 evaluatedRowCount = wrapV ? vSegments : vSegments + 1;
+	const DirectX::XMVECTOR laneOffsets = DirectX::XMVectorSet(0.f, 1.f, 2.f, 3.f);
+	const DirectX::XMVECTOR uSegmentCount = DirectX::XMVectorReplicate(float(uSegments));
+
+	std::vector<ParametricColumns> columns((evaluatedColumnCount + 3) / 4);
+	for (uint32 column = 0; column < evaluatedColumnCount; column += 4)
+	{
+		ParametricColumns& columnGroup = columns[column / 4];
+		columnGroup.u = DirectX::XMVectorDivide(DirectX::XMVectorAdd(DirectX::XMVectorReplicate(float(column)), laneOffsets), uSegmentCount);
+		DirectX::XMVectorSinCos(&columnGroup.sinAngle, &columnGroup.cosAngle, DirectX::XMVectorScale(columnGroup.u, DirectX::XM_2PI));
+	}
+
+	common::ParallelFor(evaluatedRowCount, threadCount, [&](uint32 row)
+	{
+		const float v = float(row) / vSegments;
+		MeshData::Vertex* rowVertices = &mesh.vertices[size_t(row) * rowVertexCount];
+		for (uint32 column = 0; column < evaluatedColumnCount; column += 4)
+		{
+			const ParametricColumns& columnGroup = columns[column / 4];
+
+			ParametricPoints points;
+			surface.Evaluate(columnGroup, v, &points);
+			StoreParametricPoints(points, columnGroup.u, v, std::min(4u, evaluatedColumnCount - column), rowVertices + column);
+		}
+	});
+
+	CompleteParametricGrid(uSegments, vSegments, wrapU, wrapV, threadCount, &mesh);
+	return mesh;
+}
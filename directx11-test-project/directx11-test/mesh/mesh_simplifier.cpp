@@ -0,0 +1,582 @@
+#include "stdafx.h"
+#include "mesh_simplifier.h"
+#include <numeric>
+
+
+using namespace DirectX;
+using xtest::mesh::MeshData;
+using xtest::mesh::SimplifyResult;
+
+
+namespace
+{
+	// the attributes the collapses try to preserve: normal xyz and uv
+	const uint32 kAttributeCount = 5;
+
+	// attributes are scaled by these before being compared with the positions in the unit box,
+	// a normal bending by 0.1 costs like a vertex moving by 5% of the mesh size
+	const float kNormalWeight = 0.5f;
+	const float kUVWeight = 1.f;
+
+	// border edges are held in place by planes perpendicular to their triangle, weighted this much more than the triangle planes
+	const float kBorderWeight = 10.f;
+
+	// a collapse can't rotate a triangle by more than about 75 degrees, it would likely fold it over a neighbour
+	const float kMinTriangleRotationCosine = 0.25f;
+
+	const uint32 kNoVertex = UINT32_MAX;
+
+
+	enum class VertexKind : uint8
+	{
+		manifold,	// can collapse on any neighbour
+		border,		// on an open border, can only slide along it
+		locked		// on a seam or a non-manifold edge, never moves
+	};
+
+
+	// the borders are tracked by position, so that the two sides of a seam count as a single edge
+	struct VertexTopology
+	{
+		VertexKind kind = VertexKind::locked;
+		uint32 borderNext = kNoVertex;		// position ids of the border edges vertex -> borderNext and borderPrevious -> vertex
+		uint32 borderPrevious = kNoVertex;
+		uint32 borderNextTriangle = 0;		// the triangles the border edges belong to
+		uint32 borderPreviousTriangle = 0;
+	};
+
+
+	struct VertexAttributes
+	{
+		float values[kAttributeCount];
+	};
+
+
+	// the triangles around every vertex: triangles[offsets[v]] to triangles[offsets[v + 1]]
+	struct Adjacency
+	{
+		std::vector<uint32> offsets;
+		std::vector<uint32> triangles;
+	};
+
+
+	struct Collapse
+	{
+		uint32 vertex;
+		uint32 target;
+		float error;
+	};
+
+
+	/**
+	Sum of squared distances from planes and from linear attribute fields, as a function of a position p and of
+	the attribute values a: p'Ap + 2b'p + c + sum_k(a_k^2 w - 2 a_k (g_k'p + d_k)), where a_k(p) = g_k'p + d_k is the
+	field of the attribute k on a triangle. The terms of the attribute fields that depend only on p are folded in A, b and c.
+	*/
+	struct Quadric
+	{
+		float a00 = 0.f, a11 = 0.f, a22 = 0.f, a01 = 0.f, a02 = 0.f, a12 = 0.f;
+		float b0 = 0.f, b1 = 0.f, b2 = 0.f;
+		float c = 0.f;
+		float gradients[kAttributeCount][4] = {};	// g_k and d_k, summed with their weights
+		float w = 0.f;
+
+		void Add(const Quadric& other)
+		{
+			a00 += other.a00; a11 += other.a11; a22 += other.a22;
+			a01 += other.a01; a02 += other.a02; a12 += other.a12;
+			b0 += other.b0; b1 += other.b1; b2 += other.b2;
+			c += other.c;
+			for (uint32 attribute = 0; attribute < kAttributeCount; attribute++)
+			{
+				for (uint32 component = 0; component < 4; component++)
+				{
+					gradients[attribute][component] += other.gradients[attribute][component];
+				}
+			}
+			w += other.w;
+		}
+
+		// squared distance from the plane n'p + d = 0, or from the attribute field a(p) = n'p + d
+		void AddSquaredLinear(const XMFLOAT3& n, float d, float weight)
+		{
+			a00 += weight * n.x * n.x; a11 += weight * n.y * n.y; a22 += weight * n.z * n.z;
+			a01 += weight * n.x * n.y; a02 += weight * n.x * n.z; a12 += weight * n.y * n.z;
+			b0 += weight * n.x * d; b1 += weight * n.y * d; b2 += weight * n.z * d;
+			c += weight * d * d;
+		}
+
+		void AddAttributeField(uint32 attribute, const XMFLOAT3& g, float d, float weight)
+		{
+			AddSquaredLinear(g, d, weight);
+			gradients[attribute][0] += weight * g.x;
+			gradients[attribute][1] += weight * g.y;
+			gradients[attribute][2] += weight * g.z;
+			gradients[attribute][3] += weight * d;
+		}
+
+		float Error(const XMFLOAT3& p, const VertexAttributes& attributes) const
+		{
+			float error = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z
+				+ 2.f * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z)
+				+ 2.f * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+
+			for (uint32 attribute = 0; attribute < kAttributeCount; attribute++)
+			{
+				const float* g = gradients[attribute];
+				const float a = attributes.values[attribute];
+				error += a * (a * w - 2.f * (g[0] * p.x + g[1] * p.y + g[2] * p.z + g[3]));
+			}
+
+			// the terms cancel out almost exactly at the original positions
+			return std::max(error, 0.f);
+		}
+	};
+
+
+	// every vertex gets the smallest index among the vertices with its very same position
+	std::vector<uint32> BuildPositionIds(const MeshData::Vertex* vertices, uint32 vertexCount)
+	{
+		std::vector<uint32> order(vertexCount);
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [vertices](uint32 a, uint32 b)
+		{
+			const XMFLOAT3& positionA = vertices[a].position;
+			const XMFLOAT3& positionB = vertices[b].position;
+			return std::tie(positionA.x, positionA.y, positionA.z, a) < std::tie(positionB.x, positionB.y, positionB.z, b);
+		});
+
+		std::vector<uint32> positionIds(vertexCount);
+		for (uint32 orderIndex = 0; orderIndex < vertexCount; orderIndex++)
+		{
+			const uint32 vertex = order[orderIndex];
+			const uint32 previous = orderIndex > 0 ? order[orderIndex - 1] : kNoVertex;
+			const bool samePosition = previous != kNoVertex
+				&& vertices[vertex].position.x == vertices[previous].position.x
+				&& vertices[vertex].position.y == vertices[previous].position.y
+				&& vertices[vertex].position.z == vertices[previous].position.z;
+			positionIds[vertex] = samePosition ? positionIds[previous] : vertex;
+		}
+		return positionIds;
+	}
+
+
+	// drops the triangles with two corners in the same position, compacting the list in place
+	void RemoveDegenerateTriangles(const std::vector<uint32>& positionIds, std::vector<uint32>* indices)
+	{
+		size_t writeIndex = 0;
+		for (size_t index = 0; index < indices->size(); index += 3)
+		{
+			const uint32 a = (*indices)[index];
+			const uint32 b = (*indices)[index + 1];
+			const uint32 c = (*indices)[index + 2];
+			if (positionIds[a] != positionIds[b] && positionIds[b] != positionIds[c] && positionIds[c] != positionIds[a])
+			{
+				(*indices)[writeIndex++] = a;
+				(*indices)[writeIndex++] = b;
+				(*indices)[writeIndex++] = c;
+			}
+		}
+		indices->resize(writeIndex);
+	}
+
+
+	void BuildAdjacency(const std::vector<uint32>& indices, uint32 vertexCount, Adjacency* adjacency)
+	{
+		adjacency->offsets.assign(vertexCount + 1, 0);
+		for (uint32 index : indices)
+		{
+			adjacency->offsets[index + 1]++;
+		}
+		for (uint32 vertex = 0; vertex < vertexCount; vertex++)
+		{
+			adjacency->offsets[vertex + 1] += adjacency->offsets[vertex];
+		}
+
+		adjacency->triangles.resize(indices.size());
+		std::vector<uint32> fillCounts(vertexCount, 0);
+		for (size_t index = 0; index < indices.size(); index++)
+		{
+			const uint32 vertex = indices[index];
+			adjacency->triangles[adjacency->offsets[vertex] + fillCounts[vertex]++] = uint32(index / 3);
+		}
+	}
+
+
+	// the position of vertex in the triangle, it appears exactly once since there are no degenerate triangles
+	uint32 CornerOf(const uint32* triangle, uint32 vertex)
+	{
+		return triangle[0] == vertex ? 0 : (triangle[1] == vertex ? 1 : 2);
+	}
+
+
+	VertexTopology ClassifyVertex(uint32 vertex, const std::vector<uint32>& indices, const Adjacency& adjacency, const std::vector<uint32>& positionIds)
+	{
+		VertexTopology topology;
+		const uint32* vertexTriangles = &adjacency.triangles[adjacency.offsets[vertex]];
+		const uint32 triangleCount = adjacency.offsets[vertex + 1] - adjacency.offsets[vertex];
+
+		// an edge vertex -> next is closed by a triangle walking next -> vertex, all of them are around vertex
+		uint32 openEdgeCount = 0;
+		for (uint32 triangleIndex = 0; triangleIndex < triangleCount; triangleIndex++)
+		{
+			const uint32* triangle = &indices[vertexTriangles[triangleIndex] * 3];
+			const uint32 corner = CornerOf(triangle, vertex);
+			const uint32 next = positionIds[triangle[(corner + 1) % 3]];
+			const uint32 previous = positionIds[triangle[(corner + 2) % 3]];
+
+			uint32 closingTriangleCount = 0;
+			uint32 openingTriangleCount = 0;
+			for (uint32 otherIndex = 0; otherIndex < triangleCount; otherIndex++)
+			{
+				const uint32* other = &indices[vertexTriangles[otherIndex] * 3];
+				const uint32 otherCorner = CornerOf(other, vertex);
+				const uint32 otherNext = positionIds[other[(otherCorner + 1) % 3]];
+				const uint32 otherPrevious = positionIds[other[(otherCorner + 2) % 3]];
+				closingTriangleCount += otherPrevious == next ? 1 : 0;
+				openingTriangleCount += otherNext == previous ? 1 : 0;
+
+				// two triangles walking the same edge in the same direction
+				if (otherIndex != triangleIndex && otherNext == next)
+				{
+					return topology;
+				}
+			}
+
+			if (closingTriangleCount > 1 || openingTriangleCount > 1)
+			{
+				return topology;
+			}
+			if (closingTriangleCount == 0)
+			{
+				topology.borderNext = next;
+				topology.borderNextTriangle = vertexTriangles[triangleIndex];
+				openEdgeCount++;
+			}
+			if (openingTriangleCount == 0)
+			{
+				topology.borderPrevious = previous;
+				topology.borderPreviousTriangle = vertexTriangles[triangleIndex];
+				openEdgeCount++;
+			}
+		}
+
+		if (openEdgeCount == 0)
+		{
+			topology.kind = VertexKind::manifold;
+		}
+		else if (openEdgeCount == 2 && topology.borderNext != kNoVertex && topology.borderPrevious != kNoVertex)
+		{
+			topology.kind = VertexKind::border;
+		}
+		return topology;
+	}
+
+
+	void ClassifyVertices(const std::vector<uint32>& indices, const Adjacency& adjacency, const std::vector<uint32>& positionIds,
+		const std::vector<bool>& seams, std::vector<VertexTopology>* topologies)
+	{
+		for (uint32 vertex = 0; vertex < uint32(topologies->size()); vertex++)
+		{
+			(*topologies)[vertex] = seams[vertex] ? VertexTopology() : ClassifyVertex(vertex, indices, adjacency, positionIds);
+		}
+	}
+
+
+	XMVECTOR TriangleCross(const std::vector<XMFLOAT3>& positions, const uint32* triangle)
+	{
+		const XMVECTOR a = XMLoadFloat3(&positions[triangle[0]]);
+		const XMVECTOR b = XMLoadFloat3(&positions[triangle[1]]);
+		const XMVECTOR c = XMLoadFloat3(&positions[triangle[2]]);
+		return XMVector3Cross(XMVectorSubtract(b, a), XMVectorSubtract(c, a));
+	}
+
+
+	// the plane containing the edge from -> to and perpendicular to the triangle
+	void AddBorderPlane(const std::vector<XMFLOAT3>& positions, const uint32* triangle, uint32 from, uint32 to, Quadric* quadric)
+	{
+		const XMVECTOR cross = TriangleCross(positions, triangle);
+		const XMVECTOR edge = XMVectorSubtract(XMLoadFloat3(&positions[to]), XMLoadFloat3(&positions[from]));
+		const XMVECTOR planeNormal = XMVector3Cross(edge, cross);
+		if (XMVectorGetX(XMVector3LengthSq(planeNormal)) == 0.f)
+		{
+			return;
+		}
+
+		XMFLOAT3 n;
+		XMStoreFloat3(&n, XMVector3Normalize(planeNormal));
+		const float d = -(n.x * positions[from].x + n.y * positions[from].y + n.z * positions[from].z);
+		quadric->AddSquaredLinear(n, d, kBorderWeight * XMVectorGetX(XMVector3LengthSq(edge)));
+	}
+
+
+	// the vertex of triangle with the given position id
+	uint32 VertexAtPosition(const uint32* triangle, uint32 positionId, const std::vector<uint32>& positionIds)
+	{
+		return positionIds[triangle[0]] == positionId ? triangle[0] : (positionIds[triangle[1]] == positionId ? triangle[1] : triangle[2]);
+	}
+
+
+	std::vector<Quadric> ComputeQuadrics(const std::vector<uint32>& indices, const std::vector<XMFLOAT3>& positions, const std::vector<VertexAttributes>& attributes,
+		const std::vector<VertexTopology>& topologies, const std::vector<uint32>& positionIds)
+	{
+		std::vector<Quadric> quadrics(positions.size());
+		for (size_t index = 0; index < indices.size(); index += 3)
+		{
+			const uint32* triangle = &indices[index];
+			const XMVECTOR p0 = XMLoadFloat3(&positions[triangle[0]]);
+			const XMVECTOR e1 = XMVectorSubtract(XMLoadFloat3(&positions[triangle[1]]), p0);
+			const XMVECTOR e2 = XMVectorSubtract(XMLoadFloat3(&positions[triangle[2]]), p0);
+			const XMVECTOR cross = XMVector3Cross(e1, e2);
+			const float crossLength = XMVectorGetX(XMVector3Length(cross));
+			if (crossLength == 0.f)
+			{
+				continue;
+			}
+
+			// every plane and field is weighted by the area of its triangle
+			const float area = 0.5f * crossLength;
+			Quadric triangleQuadric;
+			XMFLOAT3 n;
+			XMStoreFloat3(&n, XMVectorScale(cross, 1.f / crossLength));
+			triangleQuadric.AddSquaredLinear(n, -XMVectorGetX(XMVector3Dot(XMLoadFloat3(&n), p0)), area);
+
+			// the gradient of a linear field lies in the triangle plane: g = alpha e1 + beta e2, with g'e1 and g'e2
+			// equal to the attribute differences along the edges
+			const float d11 = XMVectorGetX(XMVector3Dot(e1, e1));
+			const float d12 = XMVectorGetX(XMVector3Dot(e1, e2));
+			const float d22 = XMVectorGetX(XMVector3Dot(e2, e2));
+			const float determinant = crossLength * crossLength;
+			for (uint32 attribute = 0; attribute < kAttributeCount; attribute++)
+			{
+				const float a0 = attributes[triangle[0]].values[attribute];
+				const float delta1 = attributes[triangle[1]].values[attribute] - a0;
+				const float delta2 = attributes[triangle[2]].values[attribute] - a0;
+				const float alpha = (d22 * delta1 - d12 * delta2) / determinant;
+				const float beta = (d11 * delta2 - d12 * delta1) / determinant;
+
+				XMFLOAT3 g;
+				const XMVECTOR gradient = XMVectorAdd(XMVectorScale(e1, alpha), XMVectorScale(e2, beta));
+				XMStoreFloat3(&g, gradient);
+				triangleQuadric.AddAttributeField(attribute, g, a0 - XMVectorGetX(XMVector3Dot(gradient, p0)), area);
+			}
+			triangleQuadric.w = area;
+
+			for (uint32 corner = 0; corner < 3; corner++)
+			{
+				quadrics[triangle[corner]].Add(triangleQuadric);
+			}
+		}
+
+		// only the quadric of the vertex that moves is ever evaluated, the ones sliding on a border keep it in place
+		for (uint32 vertex = 0; vertex < uint32(positions.size()); vertex++)
+		{
+			const VertexTopology& topology = topologies[vertex];
+			if (topology.kind == VertexKind::border)
+			{
+				const uint32* nextTriangle = &indices[topology.borderNextTriangle * 3];
+				const uint32* previousTriangle = &indices[topology.borderPreviousTriangle * 3];
+				AddBorderPlane(positions, nextTriangle, vertex, VertexAtPosition(nextTriangle, topology.borderNext, positionIds), &quadrics[vertex]);
+				AddBorderPlane(positions, previousTriangle, VertexAtPosition(previousTriangle, topology.borderPrevious, positionIds), vertex, &quadrics[vertex]);
+			}
+		}
+
+		return quadrics;
+	}
+
+
+	bool CanCollapse(uint32 vertex, uint32 target, const std::vector<VertexTopology>& topologies, const std::vector<uint32>& positionIds)
+	{
+		const VertexTopology& topology = topologies[vertex];
+		return topology.kind == VertexKind::manifold
+			|| (topology.kind == VertexKind::border && (positionIds[target] == topology.borderNext || positionIds[target] == topology.borderPrevious));
+	}
+
+
+	// true if moving vertex onto target would turn one of the triangles around too much or collapse it on a seam
+	bool WouldFlipTriangles(uint32 vertex, uint32 target, const std::vector<uint32>& indices, const Adjacency& adjacency,
+		const std::vector<XMFLOAT3>& positions, const std::vector<uint32>& positionIds)
+	{
+		for (uint32 offset = adjacency.offsets[vertex]; offset < adjacency.offsets[vertex + 1]; offset++)
+		{
+			const uint32* triangle = &indices[adjacency.triangles[offset] * 3];
+			const uint32 corner = CornerOf(triangle, vertex);
+			const uint32 b = triangle[(corner + 1) % 3];
+			const uint32 c = triangle[(corner + 2) % 3];
+			if (b == target || c == target)
+			{
+				continue;
+			}
+			if (positionIds[b] == positionIds[target] || positionIds[c] == positionIds[target])
+			{
+				return true;
+			}
+
+			const uint32 before[3] = { vertex, b, c };
+			const uint32 after[3] = { target, b, c };
+			const XMVECTOR crossBefore = TriangleCross(positions, before);
+			const XMVECTOR crossAfter = TriangleCross(positions, after);
+			const float lengthBefore = XMVectorGetX(XMVector3Length(crossBefore));
+			const float lengthAfter = XMVectorGetX(XMVector3Length(crossAfter));
+
+			// triangles that are already degenerate can't get any worse, the others can't become degenerate
+			if (lengthBefore > 0.f && XMVectorGetX(XMVector3Dot(crossBefore, crossAfter)) <= kMinTriangleRotationCosine * lengthBefore * lengthAfter)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+
+SimplifyResult xtest::mesh::Simplify(const MeshData::Vertex* vertices, uint32 vertexCount, const uint32* indices, size_t indexCount, size_t targetIndexCount, float maxError)
+{
+	XTEST_ASSERT(indexCount % 3 == 0, L"the index count must be a multiple of 3");
+
+	SimplifyResult result;
+	result.indices.assign(indices, indices + indexCount);
+	if (vertexCount == 0 || indexCount <= targetIndexCount)
+	{
+		return result;
+	}
+
+	// works on the mesh scaled to a unit box, so that the attribute weights don't depend on its size
+	XMVECTOR boundsMin = XMLoadFloat3(&vertices[0].position);
+	XMVECTOR boundsMax = boundsMin;
+	for (uint32 vertexIndex = 1; vertexIndex < vertexCount; vertexIndex++)
+	{
+		const XMVECTOR position = XMLoadFloat3(&vertices[vertexIndex].position);
+		boundsMin = XMVectorMin(boundsMin, position);
+		boundsMax = XMVectorMax(boundsMax, position);
+	}
+	XMFLOAT3 extents;
+	XMStoreFloat3(&extents, XMVectorSubtract(boundsMax, boundsMin));
+	const float extent = std::max(extents.x, std::max(extents.y, extents.z));
+	if (extent <= 0.f)
+	{
+		return result;
+	}
+
+	std::vector<XMFLOAT3> positions(vertexCount);
+	std::vector<VertexAttributes> attributes(vertexCount);
+	for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		const MeshData::Vertex& vertex = vertices[vertexIndex];
+		XMStoreFloat3(&positions[vertexIndex], XMVectorScale(XMVectorSubtract(XMLoadFloat3(&vertex.position), boundsMin), 1.f / extent));
+		attributes[vertexIndex] = VertexAttributes{ { vertex.normal.x * kNormalWeight, vertex.normal.y * kNormalWeight, vertex.normal.z * kNormalWeight,
+			vertex.uv.x * kUVWeight, vertex.uv.y * kUVWeight } };
+	}
+
+	// vertices sharing their position with others sit on a seam
+	const std::vector<uint32> positionIds = BuildPositionIds(vertices, vertexCount);
+	std::vector<bool> seams(vertexCount, false);
+	for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		if (positionIds[vertexIndex] != vertexIndex)
+		{
+			seams[vertexIndex] = true;
+			seams[positionIds[vertexIndex]] = true;
+		}
+	}
+
+	RemoveDegenerateTriangles(positionIds, &result.indices);
+
+	Adjacency adjacency;
+	std::vector<VertexTopology> topologies(vertexCount);
+	BuildAdjacency(result.indices, vertexCount, &adjacency);
+	ClassifyVertices(result.indices, adjacency, positionIds, seams, &topologies);
+	std::vector<Quadric> quadrics = ComputeQuadrics(result.indices, positions, attributes, topologies, positionIds);
+
+	const float maxCollapseError = (maxError / extent) * (maxError / extent);
+	float worstError = 0.f;
+
+	std::vector<Collapse> collapses;
+	std::vector<uint32> collapseTargets(vertexCount);
+	std::vector<bool> touched(vertexCount);
+	while (result.indices.size() > targetIndexCount)
+	{
+		// every edge proposes its cheapest valid direction, the edges between manifold vertices are seen
+		// from both their triangles and only one of them proposes
+		collapses.clear();
+		for (size_t index = 0; index < result.indices.size(); index += 3)
+		{
+			const uint32* triangle = &result.indices[index];
+			for (uint32 corner = 0; corner < 3; corner++)
+			{
+				const uint32 a = triangle[corner];
+				const uint32 b = triangle[(corner + 1) % 3];
+				if (a > b && topologies[a].kind == VertexKind::manifold && topologies[b].kind == VertexKind::manifold)
+				{
+					continue;
+				}
+
+				const bool canCollapseA = CanCollapse(a, b, topologies, positionIds);
+				const bool canCollapseB = CanCollapse(b, a, topologies, positionIds);
+				const float errorA = canCollapseA ? quadrics[a].Error(positions[b], attributes[b]) : std::numeric_limits<float>::max();
+				const float errorB = canCollapseB ? quadrics[b].Error(positions[a], attributes[a]) : std::numeric_limits<float>::max();
+				if (canCollapseA || canCollapseB)
+				{
+					collapses.push_back(errorA <= errorB ? Collapse{ a, b, errorA } : Collapse{ b, a, errorB });
+				}
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b)
+		{
+			return a.error < b.error;
+		});
+
+
+		// the collapses of a pass don't touch each other's triangles, so they can be checked against the current ones
+		std::iota(collapseTargets.begin(), collapseTargets.end(), 0);
+		std::fill(touched.begin(), touched.end(), false);
+		const size_t removableTriangleCount = (result.indices.size() - targetIndexCount + 2) / 3;
+		size_t removedTriangleCount = 0;
+		for (const Collapse& collapse : collapses)
+		{
+			if (collapse.error > maxCollapseError || removedTriangleCount >= removableTriangleCount)
+			{
+				break;
+			}
+			if (touched[collapse.vertex] || touched[collapse.target]
+				|| WouldFlipTriangles(collapse.vertex, collapse.target, result.indices, adjacency, positions, positionIds))
+			{
+				continue;
+			}
+
+			for (uint32 offset = adjacency.offsets[collapse.vertex]; offset < adjacency.offsets[collapse.vertex + 1]; offset++)
+			{
+				const uint32* triangle = &result.indices[adjacency.triangles[offset] * 3];
+				touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = true;
+				removedTriangleCount += (triangle[0] == collapse.target || triangle[1] == collapse.target || triangle[2] == collapse.target) ? 1 : 0;
+			}
+
+			collapseTargets[collapse.vertex] = collapse.target;
+			quadrics[collapse.target].Add(quadrics[collapse.vertex]);
+			worstError = std::max(worstError, collapse.error);
+		}
+
+		if (removedTriangleCount == 0)
+		{
+			break;
+		}
+
+		for (uint32& index : result.indices)
+		{
+			index = collapseTargets[index];
+		}
+		RemoveDegenerateTriangles(positionIds, &result.indices);
+		BuildAdjacency(result.indices, vertexCount, &adjacency);
+		ClassifyVertices(result.indices, adjacency, positionIds, seams, &topologies);
+	}
+
+	result.error = std::sqrt(worstError) * extent;
+	return result;
+}
+
+
+SimplifyResult xtest::mesh::Simplify(const MeshData& meshData, size_t targetIndexCount, float maxError)
+{
+	return Simplify(meshData.vertices.data(), uint32(meshData.vertices.size()), meshData.indices.data(), meshData.indices.size(), targetIndexCount, maxError);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <mesh/mesh_format.h>
+
+
+namespace xtest {
+namespace mesh {
+
+	struct SimplifyResult
+	{
+		std::vector<uint32> indices;	// the simplified triangle list, referencing the original vertices
+		float error = 0.f;				// largest distance of a moved vertex from its original triangles, in the mesh space units
+	};
+
+
+	/**
+	Reduces the triangle count with quadric error metrics (Garland, Heckbert - "Surface Simplification Using
+	Quadric Error Metrics"), collapsing every edge of a vertex onto one of its neighbours in order of cost.
+	Vertices never move, so the result references the original vertex buffer and can be drawn with it.
+	The cost of a collapse measures how far the vertex lands from the planes of its original triangles and
+	how much the normals and uv interpolated on them differ from the ones of the neighbour it lands on
+	(Hoppe - "New Quadric Metric for Simplifying Meshes with Appearance Attributes"); attribute differences
+	are counted as distances in a mesh scaled to a unit box.
+	Vertices on attribute seams (same position, different attributes) and on non-manifold edges are
+	locked, vertices on open borders can only slide along them.
+	@param targetIndexCount	Stops once the triangle list is this short, it can stay longer when maxError is hit first.
+	@param maxError			The largest collapse cost allowed, in the mesh space units.
+	*/
+	SimplifyResult Simplify(const MeshData::Vertex* vertices, uint32 vertexCount, const uint32* indices, size_t indexCount, size_t targetIndexCount, float maxError);
+	SimplifyResult Simplify(const MeshData& meshData, size_t targetIndexCount, float maxError);
+
+} // mesh
+} // xtest
+
@@ -0,0 +1,180 @@
+#include "stdafx.h"
+#include "meshlet.h"
+
+
+using namespace DirectX;
+using xtest::mesh::MeshData;
+using xtest::mesh::Meshlet;
+using xtest::mesh::MeshletBounds;
+using xtest::mesh::MeshletData;
+
+
+namespace
+{
+	const uint32 kNotInMeshlet = UINT32_MAX;
+
+
+	MeshletBounds ComputeMeshletBounds(const MeshData::Vertex* vertices, const MeshletData& meshletData, const Meshlet& meshlet)
+	{
+		const uint32* meshletVertices = &meshletData.vertices[meshlet.vertexOffset];
+		const uint8* meshletTriangles = &meshletData.triangles[meshlet.triangleOffset * 3];
+
+		// sphere around the center of the bounding box, a bit larger than the optimal one but cheap and stable
+		XMVECTOR boundsMin = XMLoadFloat3(&vertices[meshletVertices[0]].position);
+		XMVECTOR boundsMax = boundsMin;
+		for (uint32 vertexIndex = 1; vertexIndex < meshlet.vertexCount; vertexIndex++)
+		{
+			const XMVECTOR position = XMLoadFloat3(&vertices[meshletVertices[vertexIndex]].position);
+			boundsMin = XMVectorMin(boundsMin, position);
+			boundsMax = XMVectorMax(boundsMax, position);
+		}
+
+		const XMVECTOR center = XMVectorScale(XMVectorAdd(boundsMin, boundsMax), 0.5f);
+		float radius = 0.f;
+		for (uint32 vertexIndex = 0; vertexIndex < meshlet.vertexCount; vertexIndex++)
+		{
+			const XMVECTOR position = XMLoadFloat3(&vertices[meshletVertices[vertexIndex]].position);
+			radius = std::max(radius, XMVectorGetX(XMVector3Length(XMVectorSubtract(position, center))));
+		}
+
+		// the cone contains the normals of every triangle, they are computed from the positions
+		// because that's what the rasterizer uses to decide the facing
+		std::vector<XMVECTOR> triangleNormals;
+		triangleNormals.reserve(meshlet.triangleCount);
+		XMVECTOR axis = XMVectorZero();
+		for (uint32 triangleIndex = 0; triangleIndex < meshlet.triangleCount; triangleIndex++)
+		{
+			const uint8* triangle = &meshletTriangles[triangleIndex * 3];
+			const XMVECTOR a = XMLoadFloat3(&vertices[meshletVertices[triangle[0]]].position);
+			const XMVECTOR b = XMLoadFloat3(&vertices[meshletVertices[triangle[1]]].position);
+			const XMVECTOR c = XMLoadFloat3(&vertices[meshletVertices[triangle[2]]].position);
+			const XMVECTOR cross = XMVector3Cross(XMVectorSubtract(b, a), XMVectorSubtract(c, a));
+			if (XMVectorGetX(XMVector3LengthSq(cross)) > 0.f)
+			{
+				triangleNormals.push_back(XMVector3Normalize(cross));
+				axis = XMVectorAdd(axis, triangleNormals.back());
+			}
+		}
+
+		float minDot = -1.f;
+		if (!triangleNormals.empty() && XMVectorGetX(XMVector3LengthSq(axis)) > 0.f)
+		{
+			axis = XMVector3Normalize(axis);
+			minDot = 1.f;
+			for (const XMVECTOR& normal : triangleNormals)
+			{
+				minDot = std::min(minDot, XMVectorGetX(XMVector3Dot(axis, normal)));
+			}
+		}
+
+		MeshletBounds bounds;
+		XMStoreFloat3(&bounds.center, center);
+		bounds.radius = radius;
+		XMStoreFloat3(&bounds.coneAxis, axis);
+
+		// a cone of 90 degrees or more can't be entirely back facing
+		bounds.coneCutoff = minDot <= 0.f ? 1.f : std::sqrt(1.f - minDot * minDot);
+		return bounds;
+	}
+}
+
+
+void xtest::mesh::BuildMeshlets(const MeshData::Vertex* vertices, uint32 vertexCount, const uint32* indices, size_t indexCount, uint32 maxVertexCount, uint32 maxTriangleCount, MeshletData* meshletData)
+{
+	XTEST_ASSERT(meshletData);
+	XTEST_ASSERT(indexCount % 3 == 0);
+	XTEST_ASSERT(maxVertexCount >= 3 && maxVertexCount <= kMaxMeshletVertexCount, L"invalid meshlet vertex count: %u", maxVertexCount);
+	XTEST_ASSERT(maxTriangleCount >= 1 && maxTriangleCount <= kMaxMeshletTriangleCount, L"invalid meshlet triangle count: %u", maxTriangleCount);
+
+	const size_t firstMeshlet = meshletData->meshlets.size();
+
+	// local index of every mesh vertex in the meshlet being built
+	std::vector<uint32> localIndices(vertexCount, kNotInMeshlet);
+
+	Meshlet meshlet;
+	meshlet.vertexOffset = uint32(meshletData->vertices.size());
+	meshlet.triangleOffset = uint32(meshletData->triangles.size() / 3);
+
+	auto FlushMeshlet = [&]()
+	{
+		for (uint32 vertexIndex = 0; vertexIndex < meshlet.vertexCount; vertexIndex++)
+		{
+			localIndices[meshletData->vertices[meshlet.vertexOffset + vertexIndex]] = kNotInMeshlet;
+		}
+		meshletData->meshlets.push_back(meshlet);
+
+		meshlet = Meshlet();
+		meshlet.vertexOffset = uint32(meshletData->vertices.size());
+		meshlet.triangleOffset = uint32(meshletData->triangles.size() / 3);
+	};
+
+	for (size_t index = 0; index < indexCount; index += 3)
+	{
+		const uint32* triangle = &indices[index];
+		const uint32 newVertexCount = (localIndices[triangle[0]] == kNotInMeshlet ? 1 : 0)
+			+ (localIndices[triangle[1]] == kNotInMeshlet && triangle[1] != triangle[0] ? 1 : 0)
+			+ (localIndices[triangle[2]] == kNotInMeshlet && triangle[2] != triangle[0] && triangle[2] != triangle[1] ? 1 : 0);
+
+		if (meshlet.vertexCount + newVertexCount > maxVertexCount || meshlet.triangleCount + 1 > maxTriangleCount)
+		{
+			FlushMeshlet();
+		}
+
+		for (uint32 corner = 0; corner < 3; corner++)
+		{
+			uint32& localIndex = localIndices[triangle[corner]];
+			if (localIndex == kNotInMeshlet)
+			{
+				localIndex = meshlet.vertexCount++;
+				meshletData->vertices.push_back(triangle[corner]);
+			}
+			meshletData->triangles.push_back(uint8(localIndex));
+		}
+		meshlet.triangleCount++;
+	}
+
+	if (meshlet.triangleCount > 0)
+	{
+		FlushMeshlet();
+	}
+
+	for (size_t meshletIndex = firstMeshlet; meshletIndex < meshletData->meshlets.size(); meshletIndex++)
+	{
+		meshletData->bounds.push_back(ComputeMeshletBounds(vertices, *meshletData, meshletData->meshlets[meshletIndex]));
+	}
+}
+
+
+MeshletData xtest::mesh::BuildMeshlets(const MeshData& meshData, uint32 maxVertexCount, uint32 maxTriangleCount)
+{
+	MeshletData meshletData;
+	BuildMeshlets(meshData.vertices.data(), uint32(meshData.vertices.size()), meshData.indices.data(), meshData.indices.size(), maxVertexCount, maxTriangleCount, &meshletData);
+	return meshletData;
+}
+
+
+bool xtest::mesh::IsMeshletBackfacing(const MeshletBounds& bounds, FXMVECTOR cameraPosition)
+{
+	// conservative test on the whole bounding sphere, see "Optimizing the Graphics Pipeline with Compute" (Wihlidal)
+	const XMVECTOR centerOffset = XMVectorSubtract(XMLoadFloat3(&bounds.center), cameraPosition);
+	const float distance = XMVectorGetX(XMVector3Length(centerOffset));
+	const float projection = XMVectorGetX(XMVector3Dot(centerOffset, XMLoadFloat3(&bounds.coneAxis)));
+	return projection >= bounds.coneCutoff * distance + bounds.radius;
+}
+
+
+std::vector<uint32> xtest::mesh::BuildMeshletIndices(const MeshletData& meshletData)
+{
+	std::vector<uint32> indices;
+	indices.reserve(meshletData.triangles.size());
+	for (const Meshlet& meshlet : meshletData.meshlets)
+	{
+		const uint32* meshletVertices = &meshletData.vertices[meshlet.vertexOffset];
+		const uint8* meshletTriangles = &meshletData.triangles[meshlet.triangleOffset * 3];
+		for (uint32 corner = 0; corner < meshlet.triangleCount * 3; corner++)
+		{
+			indices.push_back(meshletVertices[meshletTriangles[corner]]);
+		}
+	}
+	return indices;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <mesh/mesh_format.h>
+
+
+namespace xtest {
+namespace mesh {
+
+	// local indices are stored in a byte
+	const uint32 kMaxMeshletVertexCount = 256;
+	const uint32 kMaxMeshletTriangleCount = 512;
+
+	// fits the usual mesh shader limits, good for cpu culling as well
+	const uint32 kDefaultMeshletVertexCount = 64;
+	const uint32 kDefaultMeshletTriangleCount = 124;
+
+
+	// a small cluster of triangles with its own local vertex list
+	struct Meshlet
+	{
+		uint32 vertexOffset = 0;	// first entry in MeshletData::vertices
+		uint32 triangleOffset = 0;	// first triangle in MeshletData::triangles, 3 local indices each
+		uint32 vertexCount = 0;
+		uint32 triangleCount = 0;
+	};
+
+
+	struct MeshletBounds
+	{
+		DirectX::XMFLOAT3 center;	// bounding sphere of the meshlet vertices
+		float radius;
+		DirectX::XMFLOAT3 coneAxis;	// average facing direction of the triangles
+		float coneCutoff;			// sine of the normal cone spread, 1 when the cone is too wide to be useful
+	};
+
+
+	struct MeshletData
+	{
+		std::vector<Meshlet> meshlets;
+		std::vector<MeshletBounds> bounds;	// one per meshlet
+		std::vector<uint32> vertices;		// index of the mesh vertex used by each meshlet local vertex
+		std::vector<uint8> triangles;		// local vertex indices, 3 per triangle
+	};
+
+
+	/**
+	Splits a triangle list in meshlets of at most maxVertexCount vertices and maxTriangleCount triangles.
+	Triangles are taken in index order, so the mesh should be optimized with OptimizeVertexCache first to
+	get few, compact meshlets. Every meshlet gets its bounding sphere and normal cone for culling.
+	The meshlets are appended to the ones already in meshletData.
+	*/
+	void BuildMeshlets(const MeshData::Vertex* vertices, uint32 vertexCount, const uint32* indices, size_t indexCount, uint32 maxVertexCount, uint32 maxTriangleCount, MeshletData* meshletData);
+	MeshletData BuildMeshlets(const MeshData& meshData, uint32 maxVertexCount = kDefaultMeshletVertexCount, uint32 maxTriangleCount = kDefaultMeshletTriangleCount);
+
+
+	// true if no triangle of the meshlet can face a camera in that position, cameraPosition in the same space of the mesh
+	bool IsMeshletBackfacing(const MeshletBounds& bounds, DirectX::FXMVECTOR cameraPosition);
+
+
+	// triangle list of the meshlet triangles in meshlet order, referencing the mesh vertices, so that
+	// a range of consecutive meshlets can be drawn with a single DrawIndexed
+	std::vector<uint32> BuildMeshletIndices(const MeshletData& meshletData);
+
+} // mesh
+} // xtest
+
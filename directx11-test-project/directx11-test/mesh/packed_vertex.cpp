@@ -0,0 +1,284 @@
+#include "stdafx.h"
+#include "packed_vertex.h"
+
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+using xtest::mesh::MeshData;
+using xtest::mesh::PackedVertex;
+using xtest::mesh::PackedVertexError;
+using xtest::mesh::VertexQuantization;
+
+
+namespace
+{
+	const uint32 kNormalMaxValue = (1u << xtest::mesh::kPackedNormalBits) - 1;
+	const uint32 kTangentStepCount = 1u << xtest::mesh::kPackedTangentBits;
+
+
+	float SignNotZero(float value)
+	{
+		return value >= 0.f ? 1.f : -1.f;
+	}
+
+
+	// the z < 0 half of the octahedron is folded over the z > 0 one
+	XMFLOAT2 OctahedronFromNormal(FXMVECTOR normal)
+	{
+		XMFLOAT3 n;
+		XMStoreFloat3(&n, normal);
+
+		const float l1Norm = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+		XMFLOAT2 p(n.x / l1Norm, n.y / l1Norm);
+		if (n.z < 0.f)
+		{
+			p = XMFLOAT2((1.f - std::abs(p.y)) * SignNotZero(p.x), (1.f - std::abs(p.x)) * SignNotZero(p.y));
+		}
+		return p;
+	}
+
+
+	XMVECTOR NormalFromOctahedron(float x, float y)
+	{
+		const float z = 1.f - std::abs(x) - std::abs(y);
+		const float fold = std::max(-z, 0.f);
+		x += x >= 0.f ? -fold : fold;
+		y += y >= 0.f ? -fold : fold;
+		return XMVector3Normalize(XMVectorSet(x, y, z, 0.f));
+	}
+
+
+	XMVECTOR DecodeNormal(uint32 x, uint32 y)
+	{
+		return NormalFromOctahedron(float(x) / kNormalMaxValue * 2.f - 1.f, float(y) / kNormalMaxValue * 2.f - 1.f);
+	}
+
+
+	// rounding each coordinate is not always the closest code, the 4 around the exact one are tried
+	// (Cigolle et al. - "A Survey of Efficient Representations for Independent Unit Vectors")
+	uint32 EncodeNormal(FXMVECTOR normal)
+	{
+		if (XMVectorGetX(XMVector3LengthSq(normal)) == 0.f)
+		{
+			return 0;
+		}
+
+		const XMVECTOR unitNormal = XMVector3Normalize(normal);
+		const XMFLOAT2 p = OctahedronFromNormal(unitNormal);
+		const float x = (p.x * 0.5f + 0.5f) * kNormalMaxValue;
+		const float y = (p.y * 0.5f + 0.5f) * kNormalMaxValue;
+
+		uint32 bestCode = 0;
+		float bestDot = -2.f;
+		for (uint32 candidate = 0; candidate < 4; candidate++)
+		{
+			const uint32 codeX = std::min(uint32(candidate & 1 ? std::ceil(x) : std::floor(x)), kNormalMaxValue);
+			const uint32 codeY = std::min(uint32(candidate & 2 ? std::ceil(y) : std::floor(y)), kNormalMaxValue);
+			const float dot = XMVectorGetX(XMVector3Dot(unitNormal, DecodeNormal(codeX, codeY)));
+			if (dot > bestDot)
+			{
+				bestDot = dot;
+				bestCode = codeX | (codeY << xtest::mesh::kPackedNormalBits);
+			}
+		}
+		return bestCode;
+	}
+
+
+	// branchless orthonormal basis around a unit normal (Duff et al. - "Building an Orthonormal Basis, Revisited"),
+	// the tangent angle is measured from the first axis towards the second one
+	void TangentBasis(FXMVECTOR normal, XMVECTOR* axis0, XMVECTOR* axis1)
+	{
+		XMFLOAT3 n;
+		XMStoreFloat3(&n, normal);
+
+		const float sign = SignNotZero(n.z);
+		const float a = -1.f / (sign + n.z);
+		const float b = n.x * n.y * a;
+		*axis0 = XMVectorSet(1.f + sign * n.x * n.x * a, sign * b, -sign * n.x, 0.f);
+		*axis1 = XMVectorSet(b, sign + n.y * n.y * a, -n.y, 0.f);
+	}
+
+
+	// the tangent is first made orthogonal to the normal the shader will see
+	uint32 EncodeTangent(FXMVECTOR tangent, FXMVECTOR decodedNormal)
+	{
+		const XMVECTOR projected = XMVectorSubtract(tangent, XMVectorMultiply(decodedNormal, XMVector3Dot(tangent, decodedNormal)));
+		if (XMVectorGetX(XMVector3LengthSq(projected)) == 0.f)
+		{
+			return 0;
+		}
+
+		XMVECTOR axis0;
+		XMVECTOR axis1;
+		TangentBasis(decodedNormal, &axis0, &axis1);
+
+		const float angle = std::atan2(XMVectorGetX(XMVector3Dot(projected, axis1)), XMVectorGetX(XMVector3Dot(projected, axis0)));
+		const int32 step = int32(std::lround(angle / XM_2PI * kTangentStepCount));
+		return uint32(step) & (kTangentStepCount - 1);
+	}
+
+
+	XMVECTOR DecodeTangent(uint32 code, FXMVECTOR decodedNormal)
+	{
+		XMVECTOR axis0;
+		XMVECTOR axis1;
+		TangentBasis(decodedNormal, &axis0, &axis1);
+
+		float sinAngle;
+		float cosAngle;
+		XMScalarSinCos(&sinAngle, &cosAngle, float(code) * XM_2PI / kTangentStepCount);
+		return XMVectorAdd(XMVectorScale(axis0, cosAngle), XMVectorScale(axis1, sinAngle));
+	}
+
+
+	XMVECTOR InversePositionScale(const VertexQuantization& quantization)
+	{
+		const XMVECTOR scale = XMLoadFloat3(&quantization.positionScale);
+		const XMVECTOR isFlat = XMVectorEqual(scale, XMVectorZero());
+		return XMVectorSelect(XMVectorReciprocal(scale), XMVectorZero(), isFlat);
+	}
+
+
+	float AngleInDegrees(FXMVECTOR unitA, FXMVECTOR unitB)
+	{
+		const float dot = std::min(std::max(XMVectorGetX(XMVector3Dot(unitA, unitB)), -1.f), 1.f);
+		return std::acos(dot) * 180.f / XM_PI;
+	}
+}
+
+
+VertexQuantization xtest::mesh::ComputeVertexQuantization(const MeshData::Vertex* vertices, uint32 vertexCount)
+{
+	VertexQuantization quantization;
+	if (vertexCount == 0)
+	{
+		return quantization;
+	}
+
+	XMVECTOR boundsMin = XMLoadFloat3(&vertices[0].position);
+	XMVECTOR boundsMax = boundsMin;
+	for (uint32 vertexIndex = 1; vertexIndex < vertexCount; vertexIndex++)
+	{
+		const XMVECTOR position = XMLoadFloat3(&vertices[vertexIndex].position);
+		boundsMin = XMVectorMin(boundsMin, position);
+		boundsMax = XMVectorMax(boundsMax, position);
+	}
+
+	XMStoreFloat3(&quantization.positionOffset, boundsMin);
+	XMStoreFloat3(&quantization.positionScale, XMVectorSubtract(boundsMax, boundsMin));
+	return quantization;
+}
+
+
+void xtest::mesh::PackVertices(const MeshData::Vertex* vertices, uint32 vertexCount, const VertexQuantization& quantization, PackedVertex* packedVertices)
+{
+	XTEST_ASSERT(packedVertices || vertexCount == 0);
+
+	const XMVECTOR offset = XMLoadFloat3(&quantization.positionOffset);
+	const XMVECTOR inverseScale = InversePositionScale(quantization);
+
+	for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		const MeshData::Vertex& vertex = vertices[vertexIndex];
+		PackedVertex& packedVertex = packedVertices[vertexIndex];
+
+		// XMStoreUShortN4 saturates and rounds to the nearest code
+		XMUSHORTN4 position;
+		XMStoreUShortN4(&position, XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&vertex.position), offset), inverseScale));
+		packedVertex.position[0] = position.x;
+		packedVertex.position[1] = position.y;
+		packedVertex.position[2] = position.z;
+		packedVertex.position[3] = 0;
+
+		const uint32 normalCode = EncodeNormal(XMLoadFloat3(&vertex.normal));
+		const XMVECTOR decodedNormal = DecodeNormal(normalCode & kNormalMaxValue, normalCode >> kPackedNormalBits);
+		const uint32 tangentCode = EncodeTangent(XMLoadFloat3(&vertex.tangentU), decodedNormal);
+		packedVertex.normalTangent = normalCode | (tangentCode << (2 * kPackedNormalBits));
+
+		XMHALF2 uv;
+		XMStoreHalf2(&uv, XMLoadFloat2(&vertex.uv));
+		packedVertex.uv[0] = uv.x;
+		packedVertex.uv[1] = uv.y;
+	}
+}
+
+
+std::vector<PackedVertex> xtest::mesh::PackVertices(const MeshData& meshData, VertexQuantization* quantization)
+{
+	XTEST_ASSERT(quantization);
+
+	*quantization = ComputeVertexQuantization(meshData.vertices.data(), uint32(meshData.vertices.size()));
+
+	std::vector<PackedVertex> packedVertices(meshData.vertices.size());
+	PackVertices(meshData.vertices.data(), uint32(meshData.vertices.size()), *quantization, packedVertices.data());
+	return packedVertices;
+}
+
+
+void xtest::mesh::UnpackVertices(const PackedVertex* packedVertices, uint32 vertexCount, const VertexQuantization& quantization, MeshData::Vertex* vertices)
+{
+	XTEST_ASSERT(vertices || vertexCount == 0);
+
+	const XMVECTOR offset = XMLoadFloat3(&quantization.positionOffset);
+	const XMVECTOR scale = XMLoadFloat3(&quantization.positionScale);
+
+	for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		const PackedVertex& packedVertex = packedVertices[vertexIndex];
+		MeshData::Vertex& vertex = vertices[vertexIndex];
+
+		XMUSHORTN4 position;
+		position.x = packedVertex.position[0];
+		position.y = packedVertex.position[1];
+		position.z = packedVertex.position[2];
+		position.w = 0;
+		XMStoreFloat3(&vertex.position, XMVectorMultiplyAdd(XMLoadUShortN4(&position), scale, offset));
+
+		const uint32 normalCode = packedVertex.normalTangent & ((1u << (2 * kPackedNormalBits)) - 1);
+		const XMVECTOR normal = DecodeNormal(normalCode & kNormalMaxValue, normalCode >> kPackedNormalBits);
+		XMStoreFloat3(&vertex.normal, normal);
+		XMStoreFloat3(&vertex.tangentU, DecodeTangent(packedVertex.normalTangent >> (2 * kPackedNormalBits), normal));
+
+		XMHALF2 uv;
+		uv.x = packedVertex.uv[0];
+		uv.y = packedVertex.uv[1];
+		XMStoreFloat2(&vertex.uv, XMLoadHalf2(&uv));
+	}
+}
+
+
+PackedVertexError xtest::mesh::MeasurePackingError(const MeshData::Vertex* vertices, const PackedVertex* packedVertices, uint32 vertexCount, const VertexQuantization& quantization)
+{
+	PackedVertexError error;
+
+	for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		const MeshData::Vertex& vertex = vertices[vertexIndex];
+		MeshData::Vertex unpacked;
+		UnpackVertices(&packedVertices[vertexIndex], 1, quantization, &unpacked);
+
+		const float positionError = XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&vertex.position), XMLoadFloat3(&unpacked.position))));
+		error.maxPositionError = std::max(error.maxPositionError, positionError);
+
+		const XMVECTOR normal = XMLoadFloat3(&vertex.normal);
+		if (XMVectorGetX(XMVector3LengthSq(normal)) > 0.f)
+		{
+			const XMVECTOR unitNormal = XMVector3Normalize(normal);
+			error.maxNormalError = std::max(error.maxNormalError, AngleInDegrees(unitNormal, XMLoadFloat3(&unpacked.normal)));
+
+			// only the part of the tangent orthogonal to the normal can be represented
+			const XMVECTOR tangent = XMLoadFloat3(&vertex.tangentU);
+			const XMVECTOR projected = XMVectorSubtract(tangent, XMVectorMultiply(unitNormal, XMVector3Dot(tangent, unitNormal)));
+			if (XMVectorGetX(XMVector3LengthSq(projected)) > 0.f)
+			{
+				error.maxTangentError = std::max(error.maxTangentError, AngleInDegrees(XMVector3Normalize(projected), XMLoadFloat3(&unpacked.tangentU)));
+			}
+		}
+
+		error.maxUVError = std::max(error.maxUVError, std::abs(vertex.uv.x - unpacked.uv.x));
+		error.maxUVError = std::max(error.maxUVError, std::abs(vertex.uv.y - unpacked.uv.y));
+	}
+
+	return error;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <mesh/mesh_format.h>
+
+
+namespace xtest {
+namespace mesh {
+
+	// bits of the normal octahedral coordinates and of the tangent angle in PackedVertex::normalTangent
+	const uint32 kPackedNormalBits = 11;
+	const uint32 kPackedTangentBits = 10;
+
+
+	/**
+	Compact alternative to MeshData::Vertex, 16 bytes instead of 44:
+	- the position is a 16 bits unorm triplet relative to the bounds of its mesh (R16G16B16A16_UNORM, w is unused);
+	- the normal is octahedral encoded in 2x11 bits, the tangent is stored as an angle of 10 bits around the normal,
+	  measured from a basis derived from the decoded normal (R32_UINT);
+	- the uv are half floats (R16G16_FLOAT).
+	*/
+	struct PackedVertex
+	{
+		uint16 position[4];
+		uint32 normalTangent;
+		uint16 uv[2];
+	};
+
+	XTEST_STATIC_ASSERT(sizeof(PackedVertex) == 16, "the packed vertex must be 16 bytes wide");
+
+
+	// maps the unorm positions of a mesh back to its space: position = offset + unorm * scale
+	struct VertexQuantization
+	{
+		DirectX::XMFLOAT3 positionOffset = { 0.f, 0.f, 0.f };
+		DirectX::XMFLOAT3 positionScale = { 0.f, 0.f, 0.f };
+	};
+
+
+	// largest difference between the original vertices and the unpacked ones
+	struct PackedVertexError
+	{
+		float maxPositionError = 0.f;	// distance, in mesh units
+		float maxNormalError = 0.f;		// angle in degrees
+		float maxTangentError = 0.f;	// angle in degrees, vertices without a tangent are skipped
+		float maxUVError = 0.f;			// largest absolute difference of u or v
+	};
+
+
+	// the bounding box of the vertices, the whole unorm range is used on every axis
+	VertexQuantization ComputeVertexQuantization(const MeshData::Vertex* vertices, uint32 vertexCount);
+
+	void PackVertices(const MeshData::Vertex* vertices, uint32 vertexCount, const VertexQuantization& quantization, PackedVertex* packedVertices);
+	std::vector<PackedVertex> PackVertices(const MeshData& meshData, VertexQuantization* quantization);
+
+	// the unpacked normal and tangent have unit length
+	void UnpackVertices(const PackedVertex* packedVertices, uint32 vertexCount, const VertexQuantization& quantization, MeshData::Vertex* vertices);
+
+	PackedVertexError MeasurePackingError(const MeshData::Vertex* vertices, const PackedVertex* packedVertices, uint32 vertexCount, const VertexQuantization& quantization);
+
+} // mesh
+} // xtest
+
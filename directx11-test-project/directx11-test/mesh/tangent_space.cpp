@@ -0,0 +1,340 @@
+#include "stdafx.h"
+#include "tangent_space.h"
+#include <common/parallel_for.h>
+#include <numeric>
+#include <tuple>
+
+
+using namespace DirectX;
+using xtest::mesh::MeshData;
+using xtest::mesh::NormalWeighting;
+
+
+namespace
+{
+	// the triangles and vertices handed to a worker at a time
+	const uint32 kTangentSpaceBlockSize = 4096;
+
+
+	uint32 TangentSpaceThreadCount(size_t triangleCount, uint32 threadCount)
+	{
+		return triangleCount < xtest::mesh::kMinParallelTangentSpaceTriangleCount ? 1 : threadCount;
+	}
+
+
+	// calls function(first, last) on consecutive blocks of the range [0, count)
+	template <typename Function>
+	void ParallelForBlocks(size_t count, uint32 threadCount, const Function& function)
+	{
+		const uint32 blockCount = uint32((count + kTangentSpaceBlockSize - 1) / kTangentSpaceBlockSize);
+		xtest::common::ParallelFor(blockCount, threadCount, [&](uint32 blockIndex)
+		{
+			const size_t first = size_t(blockIndex) * kTangentSpaceBlockSize;
+			function(first, std::min(count, first + kTangentSpaceBlockSize));
+		});
+	}
+
+
+	// the corners of every key, in corner order: the corners of key k are corners[offsets[k]] up to corners[offsets[k + 1]]
+	void GroupCorners(const std::vector<uint32>& cornerKeys, uint32 keyCount, std::vector<uint32>* offsets, std::vector<uint32>* corners)
+	{
+		offsets->assign(size_t(keyCount) + 1, 0);
+		for (uint32 key : cornerKeys)
+		{
+			(*offsets)[key + 1]++;
+		}
+		std::partial_sum(offsets->begin(), offsets->end(), offsets->begin());
+
+		std::vector<uint32> cursors(offsets->begin(), offsets->end() - 1);
+		corners->resize(cornerKeys.size());
+		for (uint32 corner = 0; corner < uint32(cornerKeys.size()); corner++)
+		{
+			(*corners)[cursors[cornerKeys[corner]]++] = corner;
+		}
+	}
+
+
+	XMVECTOR SumCorners(const std::vector<XMFLOAT3>& cornerValues, const std::vector<uint32>& offsets, const std::vector<uint32>& corners, uint32 key)
+	{
+		XMVECTOR sum = XMVectorZero();
+		for (uint32 cornerIndex = offsets[key]; cornerIndex < offsets[key + 1]; cornerIndex++)
+		{
+			sum = XMVectorAdd(sum, XMLoadFloat3(&cornerValues[corners[cornerIndex]]));
+		}
+		return sum;
+	}
+
+
+	// zero stays zero
+	XMVECTOR SafeNormalize3(FXMVECTOR vector)
+	{
+		const float lengthSq = XMVectorGetX(XMVector3LengthSq(vector));
+		return lengthSq > 0.f ? XMVectorScale(vector, 1.f / std::sqrt(lengthSq)) : XMVectorZero();
+	}
+
+
+	XMVECTOR ProjectOnPlane(FXMVECTOR vector, FXMVECTOR normal)
+	{
+		return XMVectorSubtract(vector, XMVectorMultiply(XMVector3Dot(vector, normal), normal));
+	}
+
+
+	// angle between two directions, 0 if one of them is zero
+	float AngleBetween(FXMVECTOR a, FXMVECTOR b)
+	{
+		const XMVECTOR normalizedA = SafeNormalize3(a);
+		const XMVECTOR normalizedB = SafeNormalize3(b);
+		if (XMVector3Equal(normalizedA, XMVectorZero()) || XMVector3Equal(normalizedB, XMVectorZero()))
+		{
+			return 0.f;
+		}
+		return std::acos(std::min(1.f, std::max(-1.f, XMVectorGetX(XMVector3Dot(normalizedA, normalizedB)))));
+	}
+
+
+	// any unit vector orthogonal to the normal, built from the axis the normal is the farthest from
+	XMVECTOR OrthogonalTangent(const XMFLOAT3& normal)
+	{
+		const XMVECTOR normalV = SafeNormalize3(XMLoadFloat3(&normal));
+		const float ax = std::abs(normal.x);
+		const float ay = std::abs(normal.y);
+		const float az = std::abs(normal.z);
+		const XMVECTOR axis = ax <= ay && ax <= az ? XMVectorSet(1.f, 0.f, 0.f, 0.f) : (ay <= az ? XMVectorSet(0.f, 1.f, 0.f, 0.f) : XMVectorSet(0.f, 0.f, 1.f, 0.f));
+		const XMVECTOR tangent = SafeNormalize3(ProjectOnPlane(axis, normalV));
+		return XMVector3Equal(tangent, XMVectorZero()) ? XMVectorSet(1.f, 0.f, 0.f, 0.f) : tangent;
+	}
+
+
+	bool HasNormal(const MeshData::Vertex& vertex)
+	{
+		return vertex.normal.x != 0.f || vertex.normal.y != 0.f || vertex.normal.z != 0.f;
+	}
+
+
+	// maps every vertex to the lowest index among the vertices with the same position
+	std::vector<uint32> FindPositionGroups(const MeshData::Vertex* vertices, uint32 vertexCount)
+	{
+		std::vector<uint32> sortedVertices(vertexCount);
+		std::iota(sortedVertices.begin(), sortedVertices.end(), 0);
+		std::sort(sortedVertices.begin(), sortedVertices.end(), [vertices](uint32 a, uint32 b)
+		{
+			const XMFLOAT3& positionA = vertices[a].position;
+			const XMFLOAT3& positionB = vertices[b].position;
+			return std::tie(positionA.x, positionA.y, positionA.z, a) < std::tie(positionB.x, positionB.y, positionB.z, b);
+		});
+
+		std::vector<uint32> positionGroups(vertexCount);
+		uint32 group = 0;
+		for (uint32 sortedIndex = 0; sortedIndex < vertexCount; sortedIndex++)
+		{
+			const uint32 vertexIndex = sortedVertices[sortedIndex];
+			const XMFLOAT3& position = vertices[vertexIndex].position;
+			const XMFLOAT3& groupPosition = vertices[group].position;
+			if (sortedIndex == 0 || position.x != groupPosition.x || position.y != groupPosition.y || position.z != groupPosition.z)
+			{
+				group = vertexIndex;
+			}
+			positionGroups[vertexIndex] = group;
+		}
+		return positionGroups;
+	}
+}
+
+
+uint32 xtest::mesh::GenerateMissingNormals(MeshData::Vertex* vertices, uint32 vertexCount, const uint32* indices, size_t indexCount, NormalWeighting weighting, uint32 threadCount)
+{
+	XTEST_ASSERT(indexCount % 3 == 0, L"the index count %zu is not a multiple of 3", indexCount);
+
+	const bool hasMissingNormals = std::any_of(vertices, vertices + vertexCount, [](const MeshData::Vertex& vertex) { return !HasNormal(vertex); });
+	if (!hasMissingNormals)
+	{
+		return 0;
+	}
+
+	threadCount = TangentSpaceThreadCount(indexCount / 3, threadCount);
+	const std::vector<uint32> positionGroups = FindPositionGroups(vertices, vertexCount);
+
+	// what every triangle adds to the normal of each of its corners
+	std::vector<XMFLOAT3> cornerNormals(indexCount);
+	ParallelForBlocks(indexCount / 3, threadCount, [&](size_t firstTriangle, size_t lastTriangle)
+	{
+		for (size_t triangle = firstTriangle; triangle < lastTriangle; triangle++)
+		{
+			const size_t firstCorner = 3 * triangle;
+			XMVECTOR positions[3];
+			for (uint32 corner = 0; corner < 3; corner++)
+			{
+				XTEST_ASSERT(indices[firstCorner + corner] < vertexCount, L"index %u out of %u vertices", indices[firstCorner + corner], vertexCount);
+				positions[corner] = XMLoadFloat3(&vertices[indices[firstCorner + corner]].position);
+			}
+
+			// twice the area long
+			const XMVECTOR faceNormal = XMVector3Cross(XMVectorSubtract(positions[1], positions[0]), XMVectorSubtract(positions[2], positions[0]));
+			const XMVECTOR unitFaceNormal = SafeNormalize3(faceNormal);
+			for (uint32 corner = 0; corner < 3; corner++)
+			{
+				XMVECTOR normal = faceNormal;
+				if (weighting == NormalWeighting::angle)
+				{
+					const XMVECTOR toNext = XMVectorSubtract(positions[(corner + 1) % 3], positions[corner]);
+					const XMVECTOR toPrevious = XMVectorSubtract(positions[(corner + 2) % 3], positions[corner]);
+					normal = XMVectorScale(unitFaceNormal, AngleBetween(toNext, toPrevious));
+				}
+				XMStoreFloat3(&cornerNormals[firstCorner + corner], normal);
+			}
+		}
+	});
+
+	std::vector<uint32> cornerGroups(indexCount);
+	for (size_t corner = 0; corner < indexCount; corner++)
+	{
+		cornerGroups[corner] = positionGroups[indices[corner]];
+	}
+	std::vector<uint32> groupOffsets;
+	std::vector<uint32> groupCorners;
+	GroupCorners(cornerGroups, vertexCount, &groupOffsets, &groupCorners);
+
+	// every group is summed by the block of its first vertex, then its vertices without a normal read it
+	std::vector<XMFLOAT3> groupNormals(vertexCount);
+	ParallelForBlocks(vertexCount, threadCount, [&](size_t firstVertex, size_t lastVertex)
+	{
+		for (uint32 vertexIndex = uint32(firstVertex); vertexIndex < lastVertex; vertexIndex++)
+		{
+			if (positionGroups[vertexIndex] == vertexIndex)
+			{
+				XMStoreFloat3(&groupNormals[vertexIndex], SafeNormalize3(SumCorners(cornerNormals, groupOffsets, groupCorners, vertexIndex)));
+			}
+		}
+	});
+
+	uint32 generatedCount = 0;
+	for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		MeshData::Vertex& vertex = vertices[vertexIndex];
+		if (!HasNormal(vertex))
+		{
+			vertex.normal = groupNormals[positionGroups[vertexIndex]];
+			generatedCount += HasNormal(vertex) ? 1 : 0;
+		}
+	}
+	return generatedCount;
+}
+
+
+uint32 xtest::mesh::GenerateMissingNormals(MeshData& meshData, NormalWeighting weighting, uint32 threadCount)
+{
+	return GenerateMissingNormals(meshData.vertices.data(), uint32(meshData.vertices.size()), meshData.indices.data(), meshData.indices.size(), weighting, threadCount);
+}
+
+
+uint32 xtest::mesh::GenerateTangents(MeshData& meshData, uint32 threadCount)
+{
+	XTEST_ASSERT(meshData.indices.size() % 3 == 0, L"the index count %zu is not a multiple of 3", meshData.indices.size());
+
+	const uint32 vertexCount = uint32(meshData.vertices.size());
+	const size_t triangleCount = meshData.indices.size() / 3;
+	threadCount = TangentSpaceThreadCount(triangleCount, threadCount);
+
+	enum TriangleOrientation : uint8 { degenerate = 0, preserved = 1, mirrored = 2 };
+
+	// what every triangle adds to the tangent of each of its corners, see MikkTSpace's InitTriInfo and EvalTspace
+	std::vector<XMFLOAT3> cornerTangents(meshData.indices.size());
+	std::vector<uint8> triangleOrientations(triangleCount);
+	ParallelForBlocks(triangleCount, threadCount, [&](size_t firstTriangle, size_t lastTriangle)
+	{
+		for (size_t triangle = firstTriangle; triangle < lastTriangle; triangle++)
+		{
+			const size_t firstCorner = 3 * triangle;
+			const MeshData::Vertex* corners[3];
+			for (uint32 corner = 0; corner < 3; corner++)
+			{
+				XTEST_ASSERT(meshData.indices[firstCorner + corner] < vertexCount, L"index %u out of %u vertices", meshData.indices[firstCorner + corner], vertexCount);
+				corners[corner] = &meshData.vertices[meshData.indices[firstCorner + corner]];
+			}
+
+			// the direction of increasing u, dP/du up to a positive factor
+			const XMVECTOR position0 = XMLoadFloat3(&corners[0]->position);
+			const XMVECTOR edge1 = XMVectorSubtract(XMLoadFloat3(&corners[1]->position), position0);
+			const XMVECTOR edge2 = XMVectorSubtract(XMLoadFloat3(&corners[2]->position), position0);
+			const XMFLOAT2 uvEdge1 = { corners[1]->uv.x - corners[0]->uv.x, corners[1]->uv.y - corners[0]->uv.y };
+			const XMFLOAT2 uvEdge2 = { corners[2]->uv.x - corners[0]->uv.x, corners[2]->uv.y - corners[0]->uv.y };
+			const float signedUVArea = uvEdge1.x * uvEdge2.y - uvEdge1.y * uvEdge2.x;
+			const XMVECTOR faceTangent = SafeNormalize3(XMVectorScale(
+				XMVectorSubtract(XMVectorScale(edge1, uvEdge2.y), XMVectorScale(edge2, uvEdge1.y)), signedUVArea < 0.f ? -1.f : 1.f));
+
+			if (signedUVArea == 0.f || XMVector3Equal(faceTangent, XMVectorZero()))
+			{
+				triangleOrientations[triangle] = degenerate;
+				for (uint32 corner = 0; corner < 3; corner++)
+				{
+					cornerTangents[firstCorner + corner] = { 0.f, 0.f, 0.f };
+				}
+				continue;
+			}
+
+			triangleOrientations[triangle] = signedUVArea > 0.f ? preserved : mirrored;
+			for (uint32 corner = 0; corner < 3; corner++)
+			{
+				// the tangent and the corner angle as seen on the tangent plane of the vertex
+				const XMVECTOR normal = SafeNormalize3(XMLoadFloat3(&corners[corner]->normal));
+				const XMVECTOR position = XMLoadFloat3(&corners[corner]->position);
+				const XMVECTOR toNext = ProjectOnPlane(XMVectorSubtract(XMLoadFloat3(&corners[(corner + 1) % 3]->position), position), normal);
+				const XMVECTOR toPrevious = ProjectOnPlane(XMVectorSubtract(XMLoadFloat3(&corners[(corner + 2) % 3]->position), position), normal);
+				const XMVECTOR tangent = SafeNormalize3(ProjectOnPlane(faceTangent, normal));
+				XMStoreFloat3(&cornerTangents[firstCorner + corner], XMVectorScale(tangent, AngleBetween(toNext, toPrevious)));
+			}
+		}
+	});
+
+
+	// the mirrored triangles of a vertex shared with preserved ones move to a copy of it, appended in vertex order
+	std::vector<uint8> vertexOrientations(vertexCount);
+	for (size_t corner = 0; corner < meshData.indices.size(); corner++)
+	{
+		vertexOrientations[meshData.indices[corner]] |= triangleOrientations[corner / 3];
+	}
+
+	std::vector<uint32> splitVertices(vertexCount);
+	for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		splitVertices[vertexIndex] = vertexIndex;
+		if (vertexOrientations[vertexIndex] == (preserved | mirrored))
+		{
+			splitVertices[vertexIndex] = uint32(meshData.vertices.size());
+			meshData.vertices.push_back(meshData.vertices[vertexIndex]);
+		}
+	}
+	const uint32 splitCount = uint32(meshData.vertices.size()) - vertexCount;
+
+	if (splitCount > 0)
+	{
+		for (size_t corner = 0; corner < meshData.indices.size(); corner++)
+		{
+			if (triangleOrientations[corner / 3] == mirrored)
+			{
+				meshData.indices[corner] = splitVertices[meshData.indices[corner]];
+			}
+		}
+	}
+
+
+	std::vector<uint32> vertexOffsets;
+	std::vector<uint32> vertexCorners;
+	GroupCorners(meshData.indices, uint32(meshData.vertices.size()), &vertexOffsets, &vertexCorners);
+
+	ParallelForBlocks(meshData.vertices.size(), threadCount, [&](size_t firstVertex, size_t lastVertex)
+	{
+		for (uint32 vertexIndex = uint32(firstVertex); vertexIndex < lastVertex; vertexIndex++)
+		{
+			MeshData::Vertex& vertex = meshData.vertices[vertexIndex];
+			XMVECTOR tangent = SafeNormalize3(SumCorners(cornerTangents, vertexOffsets, vertexCorners, vertexIndex));
+			if (XMVector3Equal(tangent, XMVectorZero()))
+			{
+				tangent = OrthogonalTangent(vertex.normal);
+			}
+			XMStoreFloat3(&vertex.tangentU, tangent);
+		}
+	});
+
+	return splitCount;
+}
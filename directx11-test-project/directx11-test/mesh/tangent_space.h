@@ -0,0 +1,52 @@
+#pragma once
+
+#include <mesh/mesh_format.h>
+
+
+namespace xtest {
+namespace mesh {
+
+	// the triangles of smaller meshes are processed on the calling thread, starting threads would cost more
+	const uint32 kMinParallelTangentSpaceTriangleCount = 32 * 1024;
+
+
+	// how much every triangle counts in the normal of the vertices it touches
+	enum class NormalWeighting
+	{
+		area,	// by its area, large faces dominate
+		angle	// by its angle at the vertex, independent of how the surface is triangulated
+	};
+
+
+	/**
+	Gives a normal to the vertices that have none, i.e. whose normal has zero length like the ones imported from an
+	obj without normals. The normal is the weighted average of the normals of all the triangles touching a vertex
+	with the same position, so that vertices split only by their uvs get the same normal and the seam is not shaded.
+	Vertices that already have a normal are not touched.
+	Every triangle computes its contributions on its own, then every vertex sums the ones of its triangles in
+	triangle order: the accumulation needs neither locks nor atomics and the result doesn't depend on the thread count.
+	@param threadCount	The triangles and the vertices are spread over this many threads, 0 means one per hardware
+						thread. Meshes smaller than kMinParallelTangentSpaceTriangleCount use the calling thread.
+	@return the number of vertices that got a normal.
+	*/
+	uint32 GenerateMissingNormals(MeshData::Vertex* vertices, uint32 vertexCount, const uint32* indices, size_t indexCount, NormalWeighting weighting = NormalWeighting::angle, uint32 threadCount = 0);
+	uint32 GenerateMissingNormals(MeshData& meshData, NormalWeighting weighting = NormalWeighting::angle, uint32 threadCount = 0);
+
+
+	/**
+	Computes the tangentU of every vertex the way MikkTSpace does, so that normal maps baked against it match:
+	the direction of increasing u of every triangle is projected on the plane of the normal of each of its vertices
+	and weighted by the angle of the triangle at the vertex, triangles with degenerate uvs don't contribute. Like in
+	MikkTSpace the triangles with mirrored uvs are never averaged with the others: a vertex shared by both gets
+	split, the copy is appended to the vertices and the mirrored triangles are remapped to it. The vertex format has
+	no handedness sign, so the bitangent is cross(normal, tangentU) as in the shaders and mirrored uvs get a
+	tangent frame of the opposite orientation to what the normal map expects.
+	Vertices without any valid triangle get a tangent orthogonal to the normal. Runs in parallel like
+	GenerateMissingNormals, with the same guarantees.
+	@return the number of vertices added by the splits.
+	*/
+	uint32 GenerateTangents(MeshData& meshData, uint32 threadCount = 0);
+
+} // mesh
+} // xtest
+
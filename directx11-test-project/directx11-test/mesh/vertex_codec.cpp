@@ -0,0 +1,490 @@
+#include "stdafx.h"
+#include "vertex_codec.h"
+#include <common/parallel_for.h>
+#include <queue>
+
+
+namespace
+{
+	// stream layout:
+	//   StreamHeader | ChunkEntry * chunkCount | chunk data ...
+	// chunk layout, for every byte of the vertex stride (a plane):
+	//   mode byte | constant value byte                      (PlaneMode::constant)
+	//   mode byte | raw plane bytes                          (PlaneMode::raw)
+	//   mode byte | 128 bytes of nibble code lengths | uint32 bit stream byte size | bit stream   (PlaneMode::huffman)
+
+	const uint32 kVertexCodecMagic = 0x31435658; // "XVC1"
+	const uint32 kMaxCodeLength = 12;
+	const uint32 kDecodeTableSize = 1u << kMaxCodeLength;
+
+
+	struct StreamHeader
+	{
+		uint32 magic;
+		uint32 vertexCount;
+		uint32 vertexStride;
+		uint32 chunkCount;
+	};
+
+
+	struct ChunkEntry
+	{
+		uint64 offset;	// from the start of the stream
+		uint64 byteSize;
+	};
+
+
+	enum class PlaneMode : uint8
+	{
+		constant = 0,
+		raw = 1,
+		huffman = 2
+	};
+
+
+	uint32 ZigZag(uint32 value)
+	{
+		return (value << 1) ^ uint32(int32(value) >> 31);
+	}
+
+
+	uint32 UnZigZag(uint32 value)
+	{
+		return (value >> 1) ^ (0u - (value & 1));
+	}
+
+
+	template<typename T>
+	void Append(const T& value, std::vector<uint8>* data)
+	{
+		const uint8* bytes = reinterpret_cast<const uint8*>(&value);
+		data->insert(data->end(), bytes, bytes + sizeof(T));
+	}
+
+
+	// huffman code lengths limited to kMaxCodeLength, the frequencies are flattened until they fit
+	void BuildCodeLengths(const uint32 frequencies[256], uint8 codeLengths[256])
+	{
+		std::array<uint32, 256> weights;
+		std::copy(frequencies, frequencies + 256, weights.begin());
+
+		for (;;)
+		{
+			struct Node
+			{
+				uint64 weight;
+				int32 parent;
+			};
+
+			std::vector<Node> nodes;
+			typedef std::pair<uint64, int32> QueueEntry;
+			std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+			for (uint32 symbol = 0; symbol < 256; symbol++)
+			{
+				nodes.push_back(Node{ weights[symbol], -1 });
+				if (weights[symbol] > 0)
+				{
+					queue.push(QueueEntry(weights[symbol], int32(symbol)));
+				}
+			}
+
+			while (queue.size() > 1)
+			{
+				const QueueEntry first = queue.top();
+				queue.pop();
+				const QueueEntry second = queue.top();
+				queue.pop();
+
+				const int32 parent = int32(nodes.size());
+				nodes.push_back(Node{ first.first + second.first, -1 });
+				nodes[first.second].parent = parent;
+				nodes[second.second].parent = parent;
+				queue.push(QueueEntry(first.first + second.first, parent));
+			}
+
+			uint32 maxLength = 0;
+			for (uint32 symbol = 0; symbol < 256; symbol++)
+			{
+				uint32 length = 0;
+				for (int32 node = nodes[symbol].parent; node >= 0; node = nodes[node].parent)
+				{
+					length++;
+				}
+
+				// a lone symbol still needs a bit
+				codeLengths[symbol] = uint8(weights[symbol] > 0 ? std::max(length, 1u) : 0);
+				maxLength = std::max<uint32>(maxLength, codeLengths[symbol]);
+			}
+
+			if (maxLength <= kMaxCodeLength)
+			{
+				return;
+			}
+
+			for (uint32& weight : weights)
+			{
+				weight = weight > 0 ? (weight >> 1) | 1 : 0;
+			}
+		}
+	}
+
+
+	// canonical codes, bit reversed because the bit stream is written starting from the least significant bit
+	void BuildCodes(const uint8 codeLengths[256], uint16 codes[256])
+	{
+		uint32 code = 0;
+		for (uint32 length = 1; length <= kMaxCodeLength; length++)
+		{
+			for (uint32 symbol = 0; symbol < 256; symbol++)
+			{
+				if (codeLengths[symbol] == length)
+				{
+					uint32 reversed = 0;
+					for (uint32 bit = 0; bit < length; bit++)
+					{
+						reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+					}
+					codes[symbol] = uint16(reversed);
+					code++;
+				}
+			}
+			code <<= 1;
+		}
+	}
+
+
+	// every entry is symbol | length << 8, a length of 0 marks a code that can't appear in a valid stream
+	bool BuildDecodeTable(const uint8 codeLengths[256], std::vector<uint16>* table)
+	{
+		// the lengths come from the file, they must fit the table and describe a code that is not oversubscribed
+		uint32 kraftSum = 0;
+		for (uint32 symbol = 0; symbol < 256; symbol++)
+		{
+			if (codeLengths[symbol] > kMaxCodeLength)
+			{
+				return false;
+			}
+			if (codeLengths[symbol] > 0)
+			{
+				kraftSum += kDecodeTableSize >> codeLengths[symbol];
+			}
+		}
+		if (kraftSum > kDecodeTableSize)
+		{
+			return false;
+		}
+
+		uint16 codes[256] = { 0 };
+		BuildCodes(codeLengths, codes);
+
+		table->assign(kDecodeTableSize, 0);
+		for (uint32 symbol = 0; symbol < 256; symbol++)
+		{
+			const uint32 length = codeLengths[symbol];
+			for (uint32 entry = codes[symbol]; length > 0 && entry < kDecodeTableSize; entry += 1u << length)
+			{
+				(*table)[entry] = uint16(symbol | (length << 8));
+			}
+		}
+		return true;
+	}
+
+
+	void EncodePlane(const uint8* plane, uint32 count, std::vector<uint8>* data)
+	{
+		uint32 frequencies[256] = { 0 };
+		for (uint32 index = 0; index < count; index++)
+		{
+			frequencies[plane[index]]++;
+		}
+
+		if (frequencies[plane[0]] == count)
+		{
+			data->push_back(uint8(PlaneMode::constant));
+			data->push_back(plane[0]);
+			return;
+		}
+
+		uint8 codeLengths[256];
+		uint16 codes[256];
+		BuildCodeLengths(frequencies, codeLengths);
+		BuildCodes(codeLengths, codes);
+
+		uint64 bitCount = 0;
+		for (uint32 symbol = 0; symbol < 256; symbol++)
+		{
+			bitCount += uint64(frequencies[symbol]) * codeLengths[symbol];
+		}
+
+		const uint64 huffmanByteSize = 1 + 128 + sizeof(uint32) + (bitCount + 7) / 8;
+		if (huffmanByteSize >= 1 + uint64(count))
+		{
+			data->push_back(uint8(PlaneMode::raw));
+			data->insert(data->end(), plane, plane + count);
+			return;
+		}
+
+		data->push_back(uint8(PlaneMode::huffman));
+		for (uint32 symbol = 0; symbol < 256; symbol += 2)
+		{
+			data->push_back(uint8(codeLengths[symbol] | (codeLengths[symbol + 1] << 4)));
+		}
+		Append(uint32((bitCount + 7) / 8), data);
+
+		uint64 bitBuffer = 0;
+		uint32 bufferedBitCount = 0;
+		for (uint32 index = 0; index < count; index++)
+		{
+			bitBuffer |= uint64(codes[plane[index]]) << bufferedBitCount;
+			bufferedBitCount += codeLengths[plane[index]];
+			while (bufferedBitCount >= 8)
+			{
+				data->push_back(uint8(bitBuffer));
+				bitBuffer >>= 8;
+				bufferedBitCount -= 8;
+			}
+		}
+		if (bufferedBitCount > 0)
+		{
+			data->push_back(uint8(bitBuffer));
+		}
+	}
+
+
+	bool DecodePlane(const uint8* data, size_t byteSize, size_t* position, uint8* plane, uint32 count, std::vector<uint16>* decodeTable)
+	{
+		if (*position == byteSize)
+		{
+			return false;
+		}
+
+		const PlaneMode mode = PlaneMode(data[(*position)++]);
+		if (mode == PlaneMode::constant)
+		{
+			if (*position == byteSize)
+			{
+				return false;
+			}
+			std::fill(plane, plane + count, data[(*position)++]);
+			return true;
+		}
+
+		if (mode == PlaneMode::raw)
+		{
+			if (byteSize - *position < count)
+			{
+				return false;
+			}
+			std::memcpy(plane, data + *position, count);
+			*position += count;
+			return true;
+		}
+
+		if (mode != PlaneMode::huffman || byteSize - *position < 128 + sizeof(uint32))
+		{
+			return false;
+		}
+
+		uint8 codeLengths[256];
+		for (uint32 symbol = 0; symbol < 256; symbol += 2)
+		{
+			const uint8 packedLengths = data[*position + symbol / 2];
+			codeLengths[symbol] = packedLengths & 15;
+			codeLengths[symbol + 1] = packedLengths >> 4;
+		}
+		*position += 128;
+
+		uint32 streamByteSize;
+		std::memcpy(&streamByteSize, data + *position, sizeof(uint32));
+		*position += sizeof(uint32);
+		if (byteSize - *position < streamByteSize || !BuildDecodeTable(codeLengths, decodeTable))
+		{
+			return false;
+		}
+
+		const uint8* stream = data + *position;
+		const uint8* streamEnd = stream + streamByteSize;
+		*position += streamByteSize;
+
+		// after a refill there are at least 56 bits, enough for kSymbolsPerRefill codes of the maximum length.
+		// bits past the end of the stream read as zeros, a valid stream never uses them
+		const uint32 kSymbolsPerRefill = 56 / kMaxCodeLength;
+		const uint16* table = decodeTable->data();
+		uint64 bitBuffer = 0;
+		uint32 bufferedBitCount = 0;
+		for (uint32 index = 0; index < count;)
+		{
+			if (streamEnd - stream >= 8)
+			{
+				uint64 word;
+				std::memcpy(&word, stream, sizeof(uint64));
+				bitBuffer |= word << bufferedBitCount;
+				stream += (63 - bufferedBitCount) >> 3;
+				bufferedBitCount |= 56;
+			}
+			else
+			{
+				while (bufferedBitCount <= 56)
+				{
+					bitBuffer |= uint64(stream < streamEnd ? *stream++ : 0) << bufferedBitCount;
+					bufferedBitCount += 8;
+				}
+			}
+
+			const uint32 lastIndex = std::min(count, index + kSymbolsPerRefill);
+			for (; index < lastIndex; index++)
+			{
+				const uint16 entry = table[bitBuffer & (kDecodeTableSize - 1)];
+				const uint32 length = entry >> 8;
+				if (length == 0)
+				{
+					return false;
+				}
+
+				plane[index] = uint8(entry);
+				bitBuffer >>= length;
+				bufferedBitCount -= length;
+			}
+		}
+		return true;
+	}
+
+
+	void EncodeChunk(const uint8* vertices, uint32 vertexCount, uint32 vertexStride, std::vector<uint8>* data)
+	{
+		const uint32 wordCount = vertexStride / sizeof(uint32);
+		std::vector<uint8> planes(size_t(vertexStride) * vertexCount);
+
+		// every chunk starts from zero so that it can be decoded alone
+		std::vector<uint32> previousWords(wordCount, 0);
+		for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+		{
+			for (uint32 wordIndex = 0; wordIndex < wordCount; wordIndex++)
+			{
+				uint32 word;
+				std::memcpy(&word, vertices + size_t(vertexIndex) * vertexStride + wordIndex * sizeof(uint32), sizeof(uint32));
+				const uint32 delta = ZigZag(word - previousWords[wordIndex]);
+				previousWords[wordIndex] = word;
+
+				for (uint32 byteIndex = 0; byteIndex < sizeof(uint32); byteIndex++)
+				{
+					planes[size_t(wordIndex * sizeof(uint32) + byteIndex) * vertexCount + vertexIndex] = uint8(delta >> (8 * byteIndex));
+				}
+			}
+		}
+
+		for (uint32 planeIndex = 0; planeIndex < vertexStride; planeIndex++)
+		{
+			EncodePlane(&planes[size_t(planeIndex) * vertexCount], vertexCount, data);
+		}
+	}
+
+
+	bool DecodeChunk(const uint8* data, size_t byteSize, uint8* vertices, uint32 vertexCount, uint32 vertexStride)
+	{
+		std::vector<uint8> planes(size_t(vertexStride) * vertexCount);
+		std::vector<uint16> decodeTable;
+
+		size_t position = 0;
+		for (uint32 planeIndex = 0; planeIndex < vertexStride; planeIndex++)
+		{
+			if (!DecodePlane(data, byteSize, &position, &planes[size_t(planeIndex) * vertexCount], vertexCount, &decodeTable))
+			{
+				return false;
+			}
+		}
+
+		const uint32 wordCount = vertexStride / sizeof(uint32);
+		for (uint32 wordIndex = 0; wordIndex < wordCount; wordIndex++)
+		{
+			const uint8* plane0 = &planes[size_t(wordIndex * 4 + 0) * vertexCount];
+			const uint8* plane1 = &planes[size_t(wordIndex * 4 + 1) * vertexCount];
+			const uint8* plane2 = &planes[size_t(wordIndex * 4 + 2) * vertexCount];
+			const uint8* plane3 = &planes[size_t(wordIndex * 4 + 3) * vertexCount];
+
+			uint32 word = 0;
+			for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+			{
+				const uint32 delta = plane0[vertexIndex] | (plane1[vertexIndex] << 8) | (plane2[vertexIndex] << 16) | (uint32(plane3[vertexIndex]) << 24);
+				word += UnZigZag(delta);
+				std::memcpy(vertices + size_t(vertexIndex) * vertexStride + wordIndex * sizeof(uint32), &word, sizeof(uint32));
+			}
+		}
+
+		return position == byteSize;
+	}
+}
+
+
+std::vector<uint8> xtest::mesh::EncodeVertices(const void* vertices, uint32 vertexCount, uint32 vertexStride)
+{
+	XTEST_ASSERT(vertexStride > 0 && vertexStride % sizeof(uint32) == 0, L"the vertex stride must be a multiple of 4, got %u", vertexStride);
+
+	StreamHeader header;
+	header.magic = kVertexCodecMagic;
+	header.vertexCount = vertexCount;
+	header.vertexStride = vertexStride;
+	header.chunkCount = (vertexCount + kVertexCodecChunkVertexCount - 1) / kVertexCodecChunkVertexCount;
+
+	std::vector<ChunkEntry> chunkTable(header.chunkCount);
+	std::vector<uint8> data;
+	data.resize(sizeof(StreamHeader) + sizeof(ChunkEntry) * chunkTable.size());
+
+	const uint8* vertexBytes = static_cast<const uint8*>(vertices);
+	for (uint32 chunkIndex = 0; chunkIndex < header.chunkCount; chunkIndex++)
+	{
+		const uint32 firstVertex = chunkIndex * kVertexCodecChunkVertexCount;
+		const uint32 chunkVertexCount = std::min(kVertexCodecChunkVertexCount, vertexCount - firstVertex);
+
+		chunkTable[chunkIndex].offset = data.size();
+		EncodeChunk(vertexBytes + size_t(firstVertex) * vertexStride, chunkVertexCount, vertexStride, &data);
+		chunkTable[chunkIndex].byteSize = data.size() - chunkTable[chunkIndex].offset;
+	}
+
+	std::memcpy(data.data(), &header, sizeof(StreamHeader));
+	std::memcpy(data.data() + sizeof(StreamHeader), chunkTable.data(), sizeof(ChunkEntry) * chunkTable.size());
+	return data;
+}
+
+
+bool xtest::mesh::DecodeVertices(const uint8* data, size_t byteSize, void* vertices, uint32 vertexCount, uint32 vertexStride, uint32 threadCount)
+{
+	if (byteSize < sizeof(StreamHeader))
+	{
+		return false;
+	}
+
+	StreamHeader header;
+	std::memcpy(&header, data, sizeof(StreamHeader));
+	const uint32 chunkCount = (vertexCount + kVertexCodecChunkVertexCount - 1) / kVertexCodecChunkVertexCount;
+	if (header.magic != kVertexCodecMagic || header.vertexCount != vertexCount || header.vertexStride != vertexStride
+		|| vertexStride % sizeof(uint32) != 0 || header.chunkCount != chunkCount
+		|| byteSize - sizeof(StreamHeader) < sizeof(ChunkEntry) * uint64(chunkCount))
+	{
+		return false;
+	}
+
+	std::vector<ChunkEntry> chunkTable(chunkCount);
+	std::memcpy(chunkTable.data(), data + sizeof(StreamHeader), sizeof(ChunkEntry) * chunkTable.size());
+	for (const ChunkEntry& chunk : chunkTable)
+	{
+		if (chunk.offset > byteSize || chunk.byteSize > byteSize - chunk.offset)
+		{
+			return false;
+		}
+	}
+
+	uint8* vertexBytes = static_cast<uint8*>(vertices);
+	std::atomic<bool> decoded(true);
+	common::ParallelFor(chunkCount, threadCount, [&](uint32 chunkIndex)
+	{
+		const uint32 firstVertex = chunkIndex * kVertexCodecChunkVertexCount;
+		const uint32 chunkVertexCount = std::min(kVertexCodecChunkVertexCount, vertexCount - firstVertex);
+		if (!DecodeChunk(data + chunkTable[chunkIndex].offset, size_t(chunkTable[chunkIndex].byteSize), vertexBytes + size_t(firstVertex) * vertexStride, chunkVertexCount, vertexStride))
+		{
+			decoded = false;
+		}
+	});
+
+	return decoded;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+
+namespace xtest {
+namespace mesh {
+
+	// vertices are encoded in independent chunks of this size, the unit of work of a parallel decode
+	const uint32 kVertexCodecChunkVertexCount = 16384;
+
+
+	/**
+	Lossless compression of a vertex buffer seen as an array of 32 bits words. Every word is replaced by
+	the zigzag encoded difference with the same word of the previous vertex, the bytes of the differences
+	are split in planes (byte 0 of every vertex, byte 1 of every vertex, ...) and every plane is entropy
+	coded on its own with a canonical huffman code. Neighbour vertices must be similar for this to pay off,
+	which is the case of vertex buffers in first-use order (see OptimizeVertexFetch).
+	@param vertexStride	The byte size of a vertex, a multiple of 4.
+	*/
+	std::vector<uint8> EncodeVertices(const void* vertices, uint32 vertexCount, uint32 vertexStride);
+
+	/**
+	Decodes a stream produced by EncodeVertices, returns false if the data is malformed or doesn't
+	contain exactly vertexCount vertices of vertexStride bytes.
+	@param threadCount	The maximum number of threads decoding the chunks, 0 means one per hardware thread.
+	*/
+	bool DecodeVertices(const uint8* data, size_t byteSize, void* vertices, uint32 vertexCount, uint32 vertexStride, uint32 threadCount = 1);
+
+} // mesh
+} // xtest
+
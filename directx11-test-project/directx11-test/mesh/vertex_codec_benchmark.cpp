@@ -0,0 +1,74 @@
+#include "stdafx.h"
+#include "vertex_codec_benchmark.h"
+#include <mesh/mesh_generator.h>
+#include <mesh/mesh_optimizer.h>
+#include <mesh/packed_vertex.h>
+#include <mesh/vertex_codec.h>
+#include <time/time_point.h>
+#include <cfloat>
+
+
+using xtest::mesh::VertexCodecBenchmarkResult;
+
+
+namespace
+{
+	float MBPerSecond(uint64 byteSize, float millis)
+	{
+		return millis > 0.f ? float(byteSize) / (1024.f * 1024.f) / (millis / 1000.f) : 0.f;
+	}
+
+
+	VertexCodecBenchmarkResult MeasureCodec(const void* vertices, uint32 vertexCount, uint32 vertexStride, uint32 repeatCount)
+	{
+		VertexCodecBenchmarkResult result;
+		result.vertexCount = vertexCount;
+		result.vertexStride = vertexStride;
+		result.rawByteSize = uint64(vertexCount) * vertexStride;
+		result.encodeMillis = FLT_MAX;
+		result.decodeMillis = FLT_MAX;
+		result.parallelDecodeMillis = FLT_MAX;
+
+		std::vector<uint8> data;
+		std::vector<uint8> decodedVertices(size_t(result.rawByteSize));
+		for (uint32 repeat = 0; repeat < std::max(repeatCount, 1u); repeat++)
+		{
+			const xtest::time::TimePoint encodeStart = xtest::time::TimePoint::Now();
+			data = xtest::mesh::EncodeVertices(vertices, vertexCount, vertexStride);
+
+			const xtest::time::TimePoint decodeStart = xtest::time::TimePoint::Now();
+			bool decoded = xtest::mesh::DecodeVertices(data.data(), data.size(), decodedVertices.data(), vertexCount, vertexStride, 1);
+
+			const xtest::time::TimePoint parallelDecodeStart = xtest::time::TimePoint::Now();
+			decoded = xtest::mesh::DecodeVertices(data.data(), data.size(), decodedVertices.data(), vertexCount, vertexStride, 0) && decoded;
+
+			const xtest::time::TimePoint parallelDecodeEnd = xtest::time::TimePoint::Now();
+			XTEST_ASSERT(decoded && std::memcmp(vertices, decodedVertices.data(), decodedVertices.size()) == 0, L"the vertices don't round trip");
+			result.encodeMillis = std::min(result.encodeMillis, (decodeStart - encodeStart).Millis());
+			result.decodeMillis = std::min(result.decodeMillis, (parallelDecodeStart - decodeStart).Millis());
+			result.parallelDecodeMillis = std::min(result.parallelDecodeMillis, (parallelDecodeEnd - parallelDecodeStart).Millis());
+		}
+
+		result.encodedByteSize = data.size();
+		result.ratio = float(result.rawByteSize) / float(std::max<uint64>(result.encodedByteSize, 1));
+		result.decodeMBPerSecond = MBPerSecond(result.rawByteSize, result.decodeMillis);
+		result.parallelDecodeMBPerSecond = MBPerSecond(result.rawByteSize, result.parallelDecodeMillis);
+		return result;
+	}
+}
+
+
+std::vector<VertexCodecBenchmarkResult> xtest::mesh::RunVertexCodecBenchmark(uint32 detailsCount, uint32 repeatCount)
+{
+	MeshData meshData = GenerateTorusKnot(2.f, 10.f, 0.05f, detailsCount, 20, 1);
+	OptimizeVertexCache(meshData);
+	OptimizeVertexFetch(meshData);
+
+	VertexQuantization quantization;
+	const std::vector<PackedVertex> packedVertices = PackVertices(meshData, &quantization);
+
+	std::vector<VertexCodecBenchmarkResult> results;
+	results.push_back(MeasureCodec(meshData.vertices.data(), uint32(meshData.vertices.size()), sizeof(MeshData::Vertex), repeatCount));
+	results.push_back(MeasureCodec(packedVertices.data(), uint32(packedVertices.size()), sizeof(PackedVertex), repeatCount));
+	return results;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+
+namespace xtest {
+namespace mesh {
+
+	// the compression of the same vertices with a vertex stride and the best times of their encode and decode
+	struct VertexCodecBenchmarkResult
+	{
+		uint32 vertexCount = 0;
+		uint32 vertexStride = 0;
+		uint64 rawByteSize = 0;
+		uint64 encodedByteSize = 0;
+		float ratio = 0.f;					// raw bytes per encoded byte
+		float encodeMillis = 0.f;
+		float decodeMillis = 0.f;			// on a single thread
+		float parallelDecodeMillis = 0.f;	// on one thread per hardware thread
+		float decodeMBPerSecond = 0.f;		// decoded bytes per second on a single thread
+		float parallelDecodeMBPerSecond = 0.f;
+	};
+
+
+	/**
+	Encodes and decodes the vertices of a torus knot of detailsCount x detailsCount vertices, optimized with
+	OptimizeVertexCache and OptimizeVertexFetch like the meshes of the demos, as full vertices and as packed ones.
+	@param repeatCount	Every encode and decode is run this many times, the best time is kept.
+	*/
+	std::vector<VertexCodecBenchmarkResult> RunVertexCodecBenchmark(uint32 detailsCount, uint32 repeatCount = 5);
+
+} // mesh
+} // xtest
@@ -0,0 +1,180 @@
+#include "stdafx.h"
+#include "vertex_weld_benchmark.h"
+#include <mesh/mesh_generator.h>
+#include <mesh/vertex_weld_table.h>
+#include <time/time_point.h>
+#include <cfloat>
+#include <unordered_map>
+
+
+using xtest::mesh::GPFMesh;
+using xtest::mesh::MeshData;
+using xtest::mesh::VertexWeldBenchmarkResult;
+using xtest::mesh::VertexWeldTable;
+
+
+namespace
+{
+	const float kBenchmarkWeldEpsilon = 1e-5f;
+
+
+	// the hash of the std::unordered_map dedup the obj import had before VertexWeldTable
+	struct XorShiftVertexHash
+	{
+		size_t operator()(const MeshData::Vertex& vertex) const
+		{
+			return std::hash<float>{}(vertex.position.x)
+				^ (std::hash<float>{}(vertex.position.y) << 1)
+				^ (std::hash<float>{}(vertex.position.z) << 1)
+				^ (std::hash<float>{}(vertex.normal.x) << 1)
+				^ (std::hash<float>{}(vertex.normal.y) << 1)
+				^ (std::hash<float>{}(vertex.normal.z) << 1)
+				^ (std::hash<float>{}(vertex.tangentU.x) << 1)
+				^ (std::hash<float>{}(vertex.tangentU.y) << 1)
+				^ (std::hash<float>{}(vertex.tangentU.z) << 1)
+				^ (std::hash<float>{}(vertex.uv.x) << 1)
+				^ (std::hash<float>{}(vertex.uv.y) << 1);
+		}
+	};
+
+	typedef std::unordered_map<MeshData::Vertex, uint32, XorShiftVertexHash> VertexIndexMap;
+
+
+	// every mesh welds its corners on its own
+	typedef std::vector<std::vector<MeshData::Vertex>> CornerSets;
+
+
+	CornerSets UnrollTriangles(const GPFMesh& gpfMesh)
+	{
+		CornerSets cornerSets;
+		for (const auto& namePairWithDescriptor : gpfMesh.meshDescriptorMapByName)
+		{
+			const GPFMesh::MeshDescriptor& descriptor = namePairWithDescriptor.second;
+			std::vector<MeshData::Vertex> corners;
+			corners.reserve(descriptor.indexCount);
+			for (uint32 index = 0; index < descriptor.indexCount; index++)
+			{
+				corners.push_back(gpfMesh.meshData.vertices[descriptor.vertexOffset + gpfMesh.meshData.indices[descriptor.indexOffset + index]]);
+			}
+			cornerSets.push_back(std::move(corners));
+		}
+		return cornerSets;
+	}
+
+
+	CornerSets UnrollTriangles(const MeshData& mesh)
+	{
+		std::vector<MeshData::Vertex> corners;
+		corners.reserve(mesh.indices.size());
+		for (uint32 index : mesh.indices)
+		{
+			corners.push_back(mesh.vertices[index]);
+		}
+		return CornerSets(1, std::move(corners));
+	}
+
+
+	// the vertex count of the welding
+	uint32 WeldWithTable(const CornerSets& cornerSets, float weldEpsilon)
+	{
+		uint32 vertexCount = 0;
+		std::vector<MeshData::Vertex> vertices;
+		std::vector<uint32> indices;
+		for (const std::vector<MeshData::Vertex>& corners : cornerSets)
+		{
+			vertices.clear();
+			indices.clear();
+			VertexWeldTable weldTable(&vertices, corners.size(), weldEpsilon);
+			for (const MeshData::Vertex& corner : corners)
+			{
+				indices.push_back(weldTable.FindOrAdd(corner));
+			}
+			vertexCount += weldTable.VertexCount();
+		}
+		return vertexCount;
+	}
+
+
+	// the same welding as the obj import did before VertexWeldTable
+	uint32 WeldWithMap(const CornerSets& cornerSets, uint32* largestBucketSize)
+	{
+		uint32 vertexCount = 0;
+		std::vector<MeshData::Vertex> vertices;
+		std::vector<uint32> indices;
+		for (const std::vector<MeshData::Vertex>& corners : cornerSets)
+		{
+			vertices.clear();
+			indices.clear();
+			VertexIndexMap indexMapByVertex(corners.size());
+			for (const MeshData::Vertex& corner : corners)
+			{
+				VertexIndexMap::iterator iter = indexMapByVertex.find(corner);
+				if (iter == indexMapByVertex.end())
+				{
+					indices.push_back(uint32(vertices.size()));
+					indexMapByVertex[corner] = uint32(vertices.size());
+					vertices.push_back(corner);
+				}
+				else
+				{
+					indices.push_back(iter->second);
+				}
+			}
+			vertexCount += uint32(vertices.size());
+
+			for (size_t bucket = 0; bucket < indexMapByVertex.bucket_count(); bucket++)
+			{
+				*largestBucketSize = std::max(*largestBucketSize, uint32(indexMapByVertex.bucket_size(bucket)));
+			}
+		}
+		return vertexCount;
+	}
+
+
+	VertexWeldBenchmarkResult MeasureWelding(const std::wstring& meshName, const CornerSets& cornerSets, uint32 repeatCount)
+	{
+		VertexWeldBenchmarkResult result;
+		result.meshName = meshName;
+		result.weldTableMillis = FLT_MAX;
+		result.epsilonWeldTableMillis = FLT_MAX;
+		result.unorderedMapMillis = FLT_MAX;
+		for (const std::vector<MeshData::Vertex>& corners : cornerSets)
+		{
+			result.cornerCount += uint32(corners.size());
+		}
+
+		for (uint32 repeat = 0; repeat < std::max(repeatCount, 1u); repeat++)
+		{
+			const xtest::time::TimePoint tableStart = xtest::time::TimePoint::Now();
+			result.vertexCount = WeldWithTable(cornerSets, 0.f);
+
+			const xtest::time::TimePoint epsilonTableStart = xtest::time::TimePoint::Now();
+			WeldWithTable(cornerSets, kBenchmarkWeldEpsilon);
+
+			const xtest::time::TimePoint mapStart = xtest::time::TimePoint::Now();
+			result.largestBucketSize = 0;
+			const uint32 mapVertexCount = WeldWithMap(cornerSets, &result.largestBucketSize);
+
+			const xtest::time::TimePoint mapEnd = xtest::time::TimePoint::Now();
+			XTEST_ASSERT(mapVertexCount == result.vertexCount, L"the weld table and the map of the %s don't agree", meshName.c_str());
+			XTEST_UNUSED_VAR(mapVertexCount);
+			result.weldTableMillis = std::min(result.weldTableMillis, (epsilonTableStart - tableStart).Millis());
+			result.epsilonWeldTableMillis = std::min(result.epsilonWeldTableMillis, (mapStart - epsilonTableStart).Millis());
+			result.unorderedMapMillis = std::min(result.unorderedMapMillis, (mapEnd - mapStart).Millis());
+		}
+		return result;
+	}
+}
+
+
+std::vector<VertexWeldBenchmarkResult> xtest::mesh::RunVertexWeldBenchmark(const GPFMesh& gpfMesh, const std::wstring& meshName, uint32 faceCount, uint32 repeatCount)
+{
+	// a grid of n x n cells has about 2 n^2 triangles
+	const uint32 detailsCount = std::max(uint32(std::sqrt(faceCount / 2.0)), 4u);
+
+	std::vector<VertexWeldBenchmarkResult> results;
+	results.push_back(MeasureWelding(meshName, UnrollTriangles(gpfMesh), repeatCount));
+	results.push_back(MeasureWelding(L"sphere", UnrollTriangles(GenerateSphere(1.f, detailsCount, detailsCount)), repeatCount));
+	results.push_back(MeasureWelding(L"torus knot", UnrollTriangles(GenerateTorusKnot(2.f, 10.f, 0.05f, detailsCount, 20, 1)), repeatCount));
+	return results;
+}
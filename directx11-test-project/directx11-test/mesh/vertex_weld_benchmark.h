@@ -0,0 +1,32 @@
+#pragma once
+
+#include <mesh/mesh_format.h>
+
+
+namespace xtest {
+namespace mesh {
+
+	// the welding of the triangle corners of a mesh by VertexWeldTable and by the std::unordered_map with the
+	// xor of std::hash<float> the obj import used before it, with their best times
+	struct VertexWeldBenchmarkResult
+	{
+		std::wstring meshName;
+		uint32 cornerCount = 0;
+		uint32 vertexCount = 0;				// after the welding
+		float weldTableMillis = 0.f;
+		float epsilonWeldTableMillis = 0.f;	// with a weld epsilon of 1e-5
+		float unorderedMapMillis = 0.f;
+		uint32 largestBucketSize = 0;		// the most vertices sharing a bucket of the std::unordered_map
+	};
+
+
+	/**
+	Welds the triangle corners of every mesh of gpfMesh, each on its own like the obj baker welds the shapes,
+	then the corners of a sphere and of a torus knot of about faceCount triangles each.
+	@param meshName		The name of gpfMesh in the results.
+	@param repeatCount	Every welding is run this many times, the best time is kept.
+	*/
+	std::vector<VertexWeldBenchmarkResult> RunVertexWeldBenchmark(const GPFMesh& gpfMesh, const std::wstring& meshName, uint32 faceCount = 1000000, uint32 repeatCount = 5);
+
+} // mesh
+} // xtest
@@ -0,0 +1,220 @@
+#include "stdafx.h"
+#include "vertex_weld_table.h"
+
+
+using xtest::mesh::MeshData;
+using xtest::mesh::VertexWeldTable;
+
+
+namespace
+{
+	const uint32 kEmptySlot = UINT32_MAX;
+	const size_t kMinSlotCount = 64;
+	const uint32 kCanonicalNaNBits = 0x7fc00000;
+
+
+	uint64 RotateLeft(uint64 value, uint32 shift)
+	{
+		return (value << shift) | (value >> (64 - shift));
+	}
+
+
+	// murmur3 finalizer, every input bit affects every output bit
+	uint64 Mix(uint64 value)
+	{
+		value ^= value >> 33;
+		value *= 0xff51afd7ed558ccdull;
+		value ^= value >> 33;
+		value *= 0xc4ceb9fe1a85ec53ull;
+		value ^= value >> 33;
+		return value;
+	}
+
+
+	template<size_t wordCount>
+	uint64 HashWords(const std::array<uint32, wordCount>& words)
+	{
+		uint64 hash = 0x9e3779b97f4a7c15ull ^ wordCount;
+		for (size_t wordIndex = 0; wordIndex < wordCount; wordIndex += 2)
+		{
+			uint64 block = words[wordIndex];
+			if (wordIndex + 1 < wordCount)
+			{
+				block |= uint64(words[wordIndex + 1]) << 32;
+			}
+
+			block *= 0x87c37b91114253d5ull;
+			block = RotateLeft(block, 31);
+			block *= 0x4cf5ad432745937full;
+			hash ^= block;
+			hash = RotateLeft(hash, 27) * 5 + 0x52dce729;
+		}
+		return Mix(hash);
+	}
+
+
+	// the grid cell of a scaled attribute. near the int32 limits the float cells are 128 apart, so the cells out
+	// of range and the nans get values no float cell can take and weld only among themselves
+	uint32 GridCell(float scaledAttribute)
+	{
+		const float cell = std::floor(scaledAttribute + 0.5f);
+		if (cell != cell)
+		{
+			return uint32(INT32_MIN + 1);
+		}
+		if (cell >= 2147483648.f)
+		{
+			return uint32(INT32_MAX);
+		}
+		if (cell < -2147483648.f)
+		{
+			return uint32(INT32_MIN + 2);
+		}
+		return uint32(int32(cell));
+	}
+
+
+	size_t SlotCountFor(size_t vertexCount)
+	{
+		// keeps the load factor under 0.5
+		size_t slotCount = kMinSlotCount;
+		while (slotCount < vertexCount * 2)
+		{
+			slotCount *= 2;
+		}
+		return slotCount;
+	}
+
+
+	// the bits of every attribute once the values that compare equal share them
+	std::array<uint32, sizeof(MeshData::Vertex) / sizeof(float)> ExactKey(const MeshData::Vertex& vertex)
+	{
+		std::array<uint32, sizeof(MeshData::Vertex) / sizeof(float)> key;
+		const float* attributes = reinterpret_cast<const float*>(&vertex);
+		for (size_t attributeIndex = 0; attributeIndex < key.size(); attributeIndex++)
+		{
+			// +0.0 is added so that -0.0 becomes +0.0, they are equal for MeshData::Vertex::operator==. the nans
+			// are never equal to anything, they all get the same bits instead and weld together like in the grid
+			const float attribute = attributes[attributeIndex] + 0.f;
+			key[attributeIndex] = kCanonicalNaNBits;
+			if (attribute == attribute)
+			{
+				std::memcpy(&key[attributeIndex], &attribute, sizeof(uint32));
+			}
+		}
+		return key;
+	}
+}
+
+
+uint64 xtest::mesh::HashVertex(const MeshData::Vertex& vertex)
+{
+	return HashWords(ExactKey(vertex));
+}
+
+
+VertexWeldTable::VertexWeldTable(std::vector<MeshData::Vertex>* vertices, size_t expectedVertexCount, float weldEpsilon)
+	: m_vertices(vertices)
+	, m_slots(SlotCountFor(expectedVertexCount), Slot{ 0, kEmptySlot })
+	, m_firstVertexIndex(0)
+	, m_usedSlotCount(0)
+	, m_weldEpsilon(std::max(weldEpsilon, 0.f))
+	, m_inverseWeldEpsilon(m_weldEpsilon > 0.f ? 1.f / m_weldEpsilon : 0.f)
+{
+	XTEST_ASSERT(vertices);
+	m_firstVertexIndex = uint32(m_vertices->size());
+	m_vertices->reserve(m_vertices->size() + expectedVertexCount);
+}
+
+
+uint32 VertexWeldTable::FindOrAdd(const MeshData::Vertex& vertex)
+{
+	if ((m_usedSlotCount + 1) * 2 > m_slots.size())
+	{
+		Grow();
+	}
+
+	const Key key = MakeKey(vertex);
+	const uint64 hash = HashKey(key);
+	const uint32 hashTag = uint32(hash >> 32);
+	const size_t slotMask = m_slots.size() - 1;
+
+	for (size_t slotIndex = size_t(hash) & slotMask;; slotIndex = (slotIndex + 1) & slotMask)
+	{
+		Slot& slot = m_slots[slotIndex];
+		if (slot.vertexIndex == kEmptySlot)
+		{
+			slot.hashTag = hashTag;
+			slot.vertexIndex = uint32(m_vertices->size());
+			m_vertices->push_back(vertex);
+			m_usedSlotCount++;
+			return slot.vertexIndex;
+		}
+
+		// the tag skips most of the full comparisons on collisions
+		if (slot.hashTag == hashTag && MakeKey((*m_vertices)[slot.vertexIndex]) == key)
+		{
+			return slot.vertexIndex;
+		}
+	}
+}
+
+
+uint32 VertexWeldTable::VertexCount() const
+{
+	return uint32(m_vertices->size()) - m_firstVertexIndex;
+}
+
+
+float VertexWeldTable::WeldEpsilon() const
+{
+	return m_weldEpsilon;
+}
+
+
+VertexWeldTable::Key VertexWeldTable::MakeKey(const MeshData::Vertex& vertex) const
+{
+	if (m_weldEpsilon == 0.f)
+	{
+		return ExactKey(vertex);
+	}
+
+	// snaps every attribute to the closest point of a grid with the weld epsilon step
+	Key key;
+	const float* attributes = reinterpret_cast<const float*>(&vertex);
+	for (size_t attributeIndex = 0; attributeIndex < key.size(); attributeIndex++)
+	{
+		key[attributeIndex] = GridCell(attributes[attributeIndex] * m_inverseWeldEpsilon);
+	}
+	return key;
+}
+
+
+uint64 VertexWeldTable::HashKey(const Key& key) const
+{
+	return HashWords(key);
+}
+
+
+void VertexWeldTable::Grow()
+{
+	std::vector<Slot> oldSlots(m_slots.size() * 2, Slot{ 0, kEmptySlot });
+	m_slots.swap(oldSlots);
+	const size_t slotMask = m_slots.size() - 1;
+
+	for (const Slot& oldSlot : oldSlots)
+	{
+		if (oldSlot.vertexIndex == kEmptySlot)
+		{
+			continue;
+		}
+
+		const uint64 hash = HashKey(MakeKey((*m_vertices)[oldSlot.vertexIndex]));
+		size_t slotIndex = size_t(hash) & slotMask;
+		while (m_slots[slotIndex].vertexIndex != kEmptySlot)
+		{
+			slotIndex = (slotIndex + 1) & slotMask;
+		}
+		m_slots[slotIndex] = oldSlot;
+	}
+}
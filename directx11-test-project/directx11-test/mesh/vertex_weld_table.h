@@ -0,0 +1,68 @@
+#pragma once
+
+#include <mesh/mesh_format.h>
+
+
+namespace xtest {
+namespace mesh {
+
+	// 64 bit hash of the raw vertex data, +0.0 and -0.0 hash the same way because they compare equal, and so do
+	// all the nans whatever their sign and payload
+	uint64 HashVertex(const MeshData::Vertex& vertex);
+
+
+	/**
+	Deduplicates vertices while they are appended to a vertex array.
+	The table is a flat open addressing hash table with linear probing that only stores indices into the
+	output vertex array, so no per-vertex allocation is performed.
+	With a weld epsilon of zero the vertices are merged when their attributes compare equal, so +0.0 and
+	-0.0 weld together. With a weld epsilon greater than zero every attribute is quantized to a grid with
+	that step before being hashed and compared, so vertices that are only slightly different are merged
+	into the first one inserted.
+	Unlike MeshData::Vertex::operator==, in both modes the vertices with a nan in the same attribute and
+	equal other attributes weld together, whatever the sign and payload of the nans.
+	*/
+	class VertexWeldTable
+	{
+	public:
+
+		VertexWeldTable(std::vector<MeshData::Vertex>* vertices, size_t expectedVertexCount, float weldEpsilon = 0.f);
+
+		VertexWeldTable(VertexWeldTable&&) = default;
+		VertexWeldTable(const VertexWeldTable&) = delete;
+		VertexWeldTable& operator=(VertexWeldTable&&) = default;
+		VertexWeldTable& operator=(const VertexWeldTable&) = delete;
+
+
+		// returns the index of an equivalent vertex already in the array, or appends the vertex and returns its new index
+		uint32 FindOrAdd(const MeshData::Vertex& vertex);
+
+		uint32 VertexCount() const;
+		float WeldEpsilon() const;
+
+	private:
+
+		static const uint32 kAttributeCount = sizeof(MeshData::Vertex) / sizeof(float);
+		typedef std::array<uint32, kAttributeCount> Key;
+
+		struct Slot
+		{
+			uint32 hashTag;
+			uint32 vertexIndex;
+		};
+
+		Key MakeKey(const MeshData::Vertex& vertex) const;
+		uint64 HashKey(const Key& key) const;
+		void Grow();
+
+		std::vector<MeshData::Vertex>* m_vertices;
+		std::vector<Slot> m_slots;
+		uint32 m_firstVertexIndex;
+		uint32 m_usedSlotCount;
+		float m_weldEpsilon;
+		float m_inverseWeldEpsilon;
+	};
+
+} // mesh
+} // xtest
+
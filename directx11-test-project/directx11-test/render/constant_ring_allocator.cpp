@@ -0,0 +1,144 @@
+#include "stdafx.h"
+#include "constant_ring_allocator.h"
+
+
+using xtest::render::ConstantRingAllocator;
+
+
+ConstantRingAllocator::ConstantRingAllocator(uint32 capacity, uint32 alignment)
+	: m_capacity(capacity)
+	, m_alignment(alignment)
+	, m_head(0)
+	, m_tail(0)
+	, m_usedSize(0)
+	, m_frameIndex(0)
+	, m_frameUsedSize(0)
+	, m_isFrameOpen(false)
+	, m_framesInFlight()
+{
+	XTEST_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, L"alignment %u not a power of two", alignment);
+	XTEST_ASSERT(capacity > 0 && capacity % alignment == 0, L"capacity %u not a multiple of the alignment", capacity);
+}
+
+
+void ConstantRingAllocator::BeginFrame(uint64 frameIndex)
+{
+	XTEST_ASSERT(!m_isFrameOpen, L"the previous frame is not ended");
+	XTEST_ASSERT(m_framesInFlight.empty() || frameIndex > m_framesInFlight.back().frameIndex, L"frame indices must grow");
+
+	m_frameIndex = frameIndex;
+	m_frameUsedSize = 0;
+	m_isFrameOpen = true;
+}
+
+
+void ConstantRingAllocator::EndFrame()
+{
+	XTEST_ASSERT(m_isFrameOpen, L"no frame begun");
+
+	m_framesInFlight.push_back({ m_frameIndex, m_head, m_frameUsedSize });
+	m_isFrameOpen = false;
+}
+
+
+uint32 ConstantRingAllocator::Allocate(uint32 size)
+{
+	XTEST_ASSERT(m_isFrameOpen, L"allocations are made between BeginFrame and EndFrame");
+
+	const uint32 alignedSize = (size + m_alignment - 1) & ~(m_alignment - 1);
+	if (alignedSize == 0 || alignedSize > m_capacity - m_usedSize)
+	{
+		return kInvalidConstantOffset;
+	}
+
+	// nothing in use, start over from the beginning so that the space isn't split in two; the empty frames still
+	// in flight would retire to where they ended, so they must be gone too
+	if (m_usedSize == 0 && m_framesInFlight.empty())
+	{
+		m_head = 0;
+		m_tail = 0;
+	}
+
+	uint32 offset = kInvalidConstantOffset;
+	uint32 allocatedSize = alignedSize;
+	if (m_head >= m_tail)
+	{
+		// free between the head and the end, then between the beginning and the tail
+		if (m_capacity - m_head >= alignedSize)
+		{
+			offset = m_head;
+		}
+		else if (m_tail >= alignedSize)
+		{
+			// what is left at the end is padding, it is freed with the frame like the rest
+			offset = 0;
+			allocatedSize += m_capacity - m_head;
+		}
+	}
+	else if (m_tail - m_head >= alignedSize)
+	{
+		offset = m_head;
+	}
+
+	if (offset == kInvalidConstantOffset)
+	{
+		return kInvalidConstantOffset;
+	}
+
+	m_head = offset + alignedSize;
+	if (m_head == m_capacity)
+	{
+		m_head = 0;
+	}
+	m_usedSize += allocatedSize;
+	m_frameUsedSize += allocatedSize;
+	return offset;
+}
+
+
+void ConstantRingAllocator::RetireFrames(uint64 completedFrameIndex)
+{
+	while (!m_framesInFlight.empty() && m_framesInFlight.front().frameIndex <= completedFrameIndex)
+	{
+		const FrameRange& frame = m_framesInFlight.front();
+		m_tail = frame.end;
+		m_usedSize -= frame.usedSize;
+		m_framesInFlight.pop_front();
+	}
+}
+
+
+void ConstantRingAllocator::Reset()
+{
+	m_head = 0;
+	m_tail = 0;
+	m_usedSize = 0;
+	m_frameUsedSize = 0;
+	m_framesInFlight.clear();
+}
+
+
+uint32 ConstantRingAllocator::Capacity() const
+{
+	return m_capacity;
+}
+
+
+uint32 ConstantRingAllocator::UsedSize() const
+{
+	return m_usedSize;
+}
+
+
+uint32 ConstantRingAllocator::FramesInFlight() const
+{
+	return uint32(m_framesInFlight.size());
+}
+
+
+uint64 ConstantRingAllocator::OldestFrameInFlight() const
+{
+	XTEST_ASSERT(!m_framesInFlight.empty());
+	return m_framesInFlight.front().frameIndex;
+}
+
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <render/render_backend.h>
+#include <deque>
+
+
+namespace xtest {
+namespace render {
+
+	// returned by ConstantRingAllocator::Allocate when the frames still in flight hold the space
+	const uint32 kInvalidConstantOffset = ~uint32(0);
+
+
+	/**
+	Hands out the space of one large buffer to the constant data of the frames, in the order it is asked for and
+	wrapping around at the end. A frame keeps its space until RetireFrames is told that the gpu is done with it,
+	so the data of the frames in flight is never written over. Only offsets are handled here: the buffer, its
+	mapping and how the gpu progress is known are up to the user, see D3D11ConstantRing.
+	*/
+	class ConstantRingAllocator
+	{
+	public:
+
+		// the capacity must be a multiple of the alignment, the alignment a power of two
+		explicit ConstantRingAllocator(uint32 capacity, uint32 alignment = kConstantBufferAlignment);
+
+		ConstantRingAllocator(ConstantRingAllocator&&) = default;
+		ConstantRingAllocator(const ConstantRingAllocator&) = default;
+		ConstantRingAllocator& operator=(ConstantRingAllocator&&) = default;
+		ConstantRingAllocator& operator=(const ConstantRingAllocator&) = default;
+
+
+		// the frame indices must grow from one frame to the next
+		void BeginFrame(uint64 frameIndex);
+		void EndFrame();
+
+		// the size is rounded up to the alignment, so is the offset returned; a frame can't wrap around onto its
+		// own allocations, the space of a single frame is at most the capacity
+		uint32 Allocate(uint32 size);
+
+		// frees the space of the ended frames up to and including the one given
+		void RetireFrames(uint64 completedFrameIndex);
+
+		// forgets every allocation, for when the buffer behind is replaced by a new one
+		void Reset();
+
+		uint32 Capacity() const;
+		uint32 UsedSize() const;			// the space of the frames not retired, the padding skipped at the end included
+		uint32 FramesInFlight() const;		// the ended frames not retired
+		uint64 OldestFrameInFlight() const;	// valid only with frames in flight
+
+	private:
+
+		struct FrameRange
+		{
+			uint64 frameIndex;
+			uint32 end;			// where the next frame starts
+			uint32 usedSize;
+		};
+
+		uint32 m_capacity;
+		uint32 m_alignment;
+		uint32 m_head;			// where the next allocation goes
+		uint32 m_tail;			// where the oldest space in use starts
+		uint32 m_usedSize;
+		uint64 m_frameIndex;
+		uint32 m_frameUsedSize;
+		bool m_isFrameOpen;
+		std::deque<FrameRange> m_framesInFlight;
+	};
+
+} // render
+} // xtest
+
@@ -0,0 +1,301 @@
+#include "stdafx.h"
+#include "culling.h"
+#include <common/parallel_for.h>
+
+
+using namespace DirectX;
+using xtest::mesh::MeshBounds;
+using xtest::render::CullingBoxes;
+using xtest::render::CullingSpheres;
+using xtest::render::Frustum;
+
+
+namespace
+{
+	// the objects of a block are culled by the same thread, a multiple of 4 so that only the last block has a tail
+	const uint32 kCullingBlockSize = 16 * 1024;
+
+
+	// the components of the frustum planes replicated in all the lanes
+	struct FrustumLanes
+	{
+		XMVECTOR x[6];
+		XMVECTOR y[6];
+		XMVECTOR z[6];
+		XMVECTOR w[6];
+
+		explicit FrustumLanes(const Frustum& frustum)
+		{
+			for (uint32 plane = 0; plane < 6; plane++)
+			{
+				const XMFLOAT4& p = frustum.planes[plane];
+				x[plane] = XMVectorReplicate(p.x);
+				y[plane] = XMVectorReplicate(p.y);
+				z[plane] = XMVectorReplicate(p.z);
+				w[plane] = XMVectorReplicate(p.w);
+			}
+		}
+	};
+
+
+	// the values of laneCount objects, the missing lanes are zero
+	XMVECTOR LoadLanes(const float* values, uint32 laneCount)
+	{
+		if (laneCount == 4)
+		{
+			return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(values));
+		}
+
+		XMFLOAT4 padded(0.f, 0.f, 0.f, 0.f);
+		std::copy(values, values + laneCount, &padded.x);
+		return XMLoadFloat4(&padded);
+	}
+
+
+	// signed distances of 4 points from a plane
+	XMVECTOR PlaneDistances(const FrustumLanes& frustum, uint32 plane, FXMVECTOR x, FXMVECTOR y, FXMVECTOR z)
+	{
+		XMVECTOR distance = XMVectorMultiplyAdd(x, frustum.x[plane], frustum.w[plane]);
+		distance = XMVectorMultiplyAdd(y, frustum.y[plane], distance);
+		return XMVectorMultiplyAdd(z, frustum.z[plane], distance);
+	}
+
+
+	// writes firstIndex + lane for every lane of the mask that is set, without branching on the mask: every index is
+	// written and the output moves forward only past the visible ones
+	uint32* AppendVisible(FXMVECTOR visible, uint32 firstIndex, uint32 laneCount, uint32* visibleIndices)
+	{
+		uint32 laneMasks[4];
+		XMStoreInt4(laneMasks, visible);
+		for (uint32 lane = 0; lane < laneCount; lane++)
+		{
+			*visibleIndices = firstIndex + lane;
+			visibleIndices += laneMasks[lane] & 1;
+		}
+		return visibleIndices;
+	}
+
+
+	// culls the objects in [first, first + count), testLanes(index, laneCount) gives the visibility mask of 4 of them;
+	// an index is never written past the position of the object it belongs to
+	template <typename TestLanes>
+	uint32 CullRange(uint32 first, uint32 count, const TestLanes& testLanes, uint32* visibleIndices)
+	{
+		uint32* nextVisible = visibleIndices;
+		const uint32 end = first + count;
+		for (uint32 index = first; index < end; index += 4)
+		{
+			const uint32 laneCount = std::min(4u, end - index);
+			nextVisible = AppendVisible(testLanes(index, laneCount), index, laneCount, nextVisible);
+		}
+		return uint32(nextVisible - visibleIndices);
+	}
+
+
+	template <typename TestLanes>
+	uint32 Cull(uint32 count, uint32 threadCount, const TestLanes& testLanes, uint32* visibleIndices)
+	{
+		if (count < xtest::render::kMinParallelCullingCount)
+		{
+			return CullRange(0, count, testLanes, visibleIndices);
+		}
+
+		// every block writes its indices from the position of its first object, where no other block writes
+		const uint32 blockCount = (count + kCullingBlockSize - 1) / kCullingBlockSize;
+		std::vector<uint32> blockVisibleCounts(blockCount);
+		xtest::common::ParallelFor(blockCount, threadCount, [&](uint32 block)
+		{
+			const uint32 first = block * kCullingBlockSize;
+			blockVisibleCounts[block] = CullRange(first, std::min(kCullingBlockSize, count - first), testLanes, visibleIndices + first);
+		});
+
+		// then the blocks are packed in order, the same list as culling on a single thread
+		uint32 visibleCount = blockVisibleCounts[0];
+		for (uint32 block = 1; block < blockCount; block++)
+		{
+			std::memmove(visibleIndices + visibleCount, visibleIndices + block * kCullingBlockSize, blockVisibleCounts[block] * sizeof(uint32));
+			visibleCount += blockVisibleCounts[block];
+		}
+		return visibleCount;
+	}
+}
+
+
+Frustum xtest::render::ExtractFrustum(FXMMATRIX viewProjection)
+{
+	// a point v is inside when -w <= x <= w, -w <= y <= w and 0 <= z <= w with (x, y, z, w) = v * viewProjection,
+	// i.e. when it has non negative dot products with these combinations of the columns
+	const XMMATRIX columns = XMMatrixTranspose(viewProjection);
+	const XMVECTOR planes[6] = {
+		XMVectorAdd(columns.r[3], columns.r[0]),
+		XMVectorSubtract(columns.r[3], columns.r[0]),
+		XMVectorAdd(columns.r[3], columns.r[1]),
+		XMVectorSubtract(columns.r[3], columns.r[1]),
+		columns.r[2],
+		XMVectorSubtract(columns.r[3], columns.r[2])
+	};
+
+	Frustum frustum;
+	for (uint32 plane = 0; plane < 6; plane++)
+	{
+		XMStoreFloat4(&frustum.planes[plane], XMPlaneNormalize(planes[plane]));
+	}
+	return frustum;
+}
+
+
+uint32 CullingSpheres::Add(const MeshBounds& bounds, FXMMATRIX world)
+{
+	centerX.push_back(0.f);
+	centerY.push_back(0.f);
+	centerZ.push_back(0.f);
+	radius.push_back(0.f);
+	Set(Count() - 1, bounds, world);
+	return Count() - 1;
+}
+
+
+void CullingSpheres::Set(uint32 index, const MeshBounds& bounds, FXMMATRIX world)
+{
+	XTEST_ASSERT(index < Count(), L"culling sphere %u out of range", index);
+
+	// the largest scale of the world matrix, so that the sphere still encloses the object when scaled unevenly
+	const float worldScale = std::sqrt(std::max(XMVectorGetX(XMVector3LengthSq(world.r[0])),
+		std::max(XMVectorGetX(XMVector3LengthSq(world.r[1])), XMVectorGetX(XMVector3LengthSq(world.r[2])))));
+
+	XMFLOAT3 center;
+	XMStoreFloat3(&center, XMVector3TransformCoord(XMLoadFloat3(&bounds.sphereCenter), world));
+
+	centerX[index] = center.x;
+	centerY[index] = center.y;
+	centerZ[index] = center.z;
+	radius[index] = bounds.sphereRadius * worldScale;
+}
+
+
+void CullingSpheres::Remove(uint32 index)
+{
+	XTEST_ASSERT(index < Count(), L"culling sphere %u out of range", index);
+
+	for (std::vector<float>* component : { &centerX, &centerY, &centerZ, &radius })
+	{
+		(*component)[index] = component->back();
+		component->pop_back();
+	}
+}
+
+
+uint32 CullingSpheres::Count() const
+{
+	return uint32(radius.size());
+}
+
+
+void CullingSpheres::Clear()
+{
+	centerX.clear();
+	centerY.clear();
+	centerZ.clear();
+	radius.clear();
+}
+
+
+uint32 CullingBoxes::Add(const MeshBounds& bounds, FXMMATRIX world)
+{
+	const XMVECTOR boxMin = XMLoadFloat3(&bounds.boxMin);
+	const XMVECTOR boxMax = XMLoadFloat3(&bounds.boxMax);
+	const XMVECTOR halfExtent = XMVectorScale(XMVectorSubtract(boxMax, boxMin), 0.5f);
+
+	// every axis of the box moves along a row of the world matrix, the world box encloses the three of them
+	XMVECTOR extent = XMVectorMultiply(XMVectorAbs(world.r[0]), XMVectorSplatX(halfExtent));
+	extent = XMVectorMultiplyAdd(XMVectorAbs(world.r[1]), XMVectorSplatY(halfExtent), extent);
+	extent = XMVectorMultiplyAdd(XMVectorAbs(world.r[2]), XMVectorSplatZ(halfExtent), extent);
+
+	XMFLOAT3 worldCenter;
+	XMFLOAT3 worldExtent;
+	XMStoreFloat3(&worldCenter, XMVector3TransformCoord(XMVectorScale(XMVectorAdd(boxMin, boxMax), 0.5f), world));
+	XMStoreFloat3(&worldExtent, extent);
+
+	centerX.push_back(worldCenter.x);
+	centerY.push_back(worldCenter.y);
+	centerZ.push_back(worldCenter.z);
+	extentX.push_back(worldExtent.x);
+	extentY.push_back(worldExtent.y);
+	extentZ.push_back(worldExtent.z);
+	return Count() - 1;
+}
+
+
+uint32 CullingBoxes::Count() const
+{
+	return uint32(extentX.size());
+}
+
+
+void CullingBoxes::Clear()
+{
+	centerX.clear();
+	centerY.clear();
+	centerZ.clear();
+	extentX.clear();
+	extentY.clear();
+	extentZ.clear();
+}
+
+
+uint32 xtest::render::CullSpheres(const Frustum& frustum, const CullingSpheres& spheres, uint32* visibleIndices, uint32 threadCount)
+{
+	const FrustumLanes planes(frustum);
+
+	// a sphere is out when its center is farther than its radius behind a plane
+	return Cull(spheres.Count(), threadCount, [&](uint32 index, uint32 laneCount)
+	{
+		const XMVECTOR x = LoadLanes(spheres.centerX.data() + index, laneCount);
+		const XMVECTOR y = LoadLanes(spheres.centerY.data() + index, laneCount);
+		const XMVECTOR z = LoadLanes(spheres.centerZ.data() + index, laneCount);
+		const XMVECTOR minDistance = XMVectorNegate(LoadLanes(spheres.radius.data() + index, laneCount));
+
+		XMVECTOR visible = XMVectorTrueInt();
+		for (uint32 plane = 0; plane < 6; plane++)
+		{
+			visible = XMVectorAndInt(visible, XMVectorGreaterOrEqual(PlaneDistances(planes, plane, x, y, z), minDistance));
+		}
+		return visible;
+	}, visibleIndices);
+}
+
+
+uint32 xtest::render::CullBoxes(const Frustum& frustum, const CullingBoxes& boxes, uint32* visibleIndices, uint32 threadCount)
+{
+	const FrustumLanes planes(frustum);
+	XMVECTOR absPlaneX[6];
+	XMVECTOR absPlaneY[6];
+	XMVECTOR absPlaneZ[6];
+	for (uint32 plane = 0; plane < 6; plane++)
+	{
+		absPlaneX[plane] = XMVectorAbs(planes.x[plane]);
+		absPlaneY[plane] = XMVectorAbs(planes.y[plane]);
+		absPlaneZ[plane] = XMVectorAbs(planes.z[plane]);
+	}
+
+	// a box is out when its center is farther behind a plane than the corner closest to the plane side it faces
+	return Cull(boxes.Count(), threadCount, [&](uint32 index, uint32 laneCount)
+	{
+		const XMVECTOR x = LoadLanes(boxes.centerX.data() + index, laneCount);
+		const XMVECTOR y = LoadLanes(boxes.centerY.data() + index, laneCount);
+		const XMVECTOR z = LoadLanes(boxes.centerZ.data() + index, laneCount);
+		const XMVECTOR extentX = LoadLanes(boxes.extentX.data() + index, laneCount);
+		const XMVECTOR extentY = LoadLanes(boxes.extentY.data() + index, laneCount);
+		const XMVECTOR extentZ = LoadLanes(boxes.extentZ.data() + index, laneCount);
+
+		XMVECTOR visible = XMVectorTrueInt();
+		for (uint32 plane = 0; plane < 6; plane++)
+		{
+			XMVECTOR reach = XMVectorMultiply(extentX, absPlaneX[plane]);
+			reach = XMVectorMultiplyAdd(extentY, absPlaneY[plane], reach);
+			reach = XMVectorMultiplyAdd(extentZ, absPlaneZ[plane], reach);
+			visible = XMVectorAndInt(visible, XMVectorGreaterOrEqual(PlaneDistances(planes, plane, x, y, z), XMVectorNegate(reach)));
+		}
+		return visible;
+	}, visibleIndices);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <mesh/mesh_format.h>
+
+
+namespace xtest {
+namespace render {
+
+	// fewer objects are culled on the calling thread, starting threads would cost more than testing them
+	const uint32 kMinParallelCullingCount = 64 * 1024;
+
+
+	// the planes bounding the view volume, normalized and with the normal pointing inside
+	struct Frustum
+	{
+		DirectX::XMFLOAT4 planes[6];	// left, right, bottom, top, near, far
+	};
+
+	// the frustum of a view-projection matrix with the depth in [0, 1] like the ones of DirectXMath, in the space
+	// the matrix transforms from: pass view * projection to get it in world space
+	Frustum ExtractFrustum(DirectX::FXMMATRIX viewProjection);
+
+
+	// world space bounding spheres, a separate array for every component so that 4 objects load at once
+	struct CullingSpheres
+	{
+		std::vector<float> centerX;
+		std::vector<float> centerY;
+		std::vector<float> centerZ;
+		std::vector<float> radius;
+
+		// adds the bounding sphere of the bounds moved to world space, the radius grows with the largest scale of
+		// the world matrix; returns the index of the sphere
+		uint32 Add(const mesh::MeshBounds& bounds, DirectX::FXMMATRIX world);
+		void Set(uint32 index, const mesh::MeshBounds& bounds, DirectX::FXMMATRIX world);
+
+		// the last sphere takes the index of the removed one
+		void Remove(uint32 index);
+		uint32 Count() const;
+		void Clear();
+	};
+
+
+	// world space axis aligned boxes by center and half extents, like CullingSpheres
+	struct CullingBoxes
+	{
+		std::vector<float> centerX;
+		std::vector<float> centerY;
+		std::vector<float> centerZ;
+		std::vector<float> extentX;
+		std::vector<float> extentY;
+		std::vector<float> extentZ;
+
+		// adds the box around the bounding box of the bounds moved to world space; returns the index of the box
+		uint32 Add(const mesh::MeshBounds& bounds, DirectX::FXMMATRIX world);
+		uint32 Count() const;
+		void Clear();
+	};
+
+
+	/**
+	Tests the objects against the frustum 4 at a time and writes the indices of the ones that are at least partially
+	inside it, in increasing order. An object is culled only when it is entirely behind one of the planes: the objects
+	close to a corner of the frustum may be kept even if they are outside, they are never culled when visible.
+	@param visibleIndices	Receives the indices, it must have room for the indices of all the objects.
+	@param threadCount		The objects are split in blocks over this many threads, 0 means one per hardware thread.
+							Fewer objects than kMinParallelCullingCount are tested on the calling thread.
+	@return the number of visible objects.
+	*/
+	uint32 CullSpheres(const Frustum& frustum, const CullingSpheres& spheres, uint32* visibleIndices, uint32 threadCount = 0);
+	uint32 CullBoxes(const Frustum& frustum, const CullingBoxes& boxes, uint32* visibleIndices, uint32 threadCount = 0);
+
+} // render
+} // xtest
+
@@ -0,0 +1,62 @@
+#include "stdafx.h"
+#include "culling_benchmark.h"
+#include <math/math_utils.h>
+#include <time/time_point.h>
+#include <cfloat>
+#include <random>
+
+
+using namespace DirectX;
+using xtest::render::CullingBenchmarkResult;
+
+
+CullingBenchmarkResult xtest::render::RunCullingBenchmark(uint32 objectCount, uint32 threadCount, uint32 repeatCount)
+{
+	const XMMATRIX V = XMMatrixLookAtLH(XMVectorSet(0.f, 20.f, -60.f, 1.f), XMVectorZero(), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+	const XMMATRIX P = XMMatrixPerspectiveFovLH(math::ToRadians(45.f), 16.f / 9.f, 1.f, 1000.f);
+	const Frustum frustum = ExtractFrustum(XMMatrixMultiply(V, P));
+
+	// boxes from 0.5 to 5 units wide, rotated and scattered in a cube of 2000 units around the camera
+	std::mt19937 random(objectCount);
+	std::uniform_real_distribution<float> position(-1000.f, 1000.f);
+	std::uniform_real_distribution<float> extent(0.25f, 2.5f);
+	std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+
+	CullingSpheres spheres;
+	CullingBoxes boxes;
+	for (uint32 index = 0; index < objectCount; index++)
+	{
+		mesh::MeshBounds bounds;
+		const XMFLOAT3 halfExtent(extent(random), extent(random), extent(random));
+		bounds.boxMin = { -halfExtent.x, -halfExtent.y, -halfExtent.z };
+		bounds.boxMax = halfExtent;
+		bounds.sphereCenter = { 0.f, 0.f, 0.f };
+		bounds.sphereRadius = XMVectorGetX(XMVector3Length(XMLoadFloat3(&halfExtent)));
+
+		const XMMATRIX R = XMMatrixRotationRollPitchYaw(angle(random), angle(random), angle(random));
+		const XMMATRIX world = XMMatrixMultiply(R, XMMatrixTranslation(position(random), position(random), position(random)));
+		spheres.Add(bounds, world);
+		boxes.Add(bounds, world);
+	}
+
+	std::vector<uint32> visibleIndices(objectCount);
+	CullingBenchmarkResult result;
+	result.objectCount = objectCount;
+	result.sphereMillis = FLT_MAX;
+	result.boxMillis = FLT_MAX;
+	for (uint32 repeat = 0; repeat < std::max(repeatCount, 1u); repeat++)
+	{
+		const time::TimePoint sphereStart = time::TimePoint::Now();
+		result.visibleSphereCount = CullSpheres(frustum, spheres, visibleIndices.data(), threadCount);
+
+		const time::TimePoint boxStart = time::TimePoint::Now();
+		result.visibleBoxCount = CullBoxes(frustum, boxes, visibleIndices.data(), threadCount);
+
+		const time::TimePoint boxEnd = time::TimePoint::Now();
+		result.sphereMillis = std::min(result.sphereMillis, (boxStart - sphereStart).Millis());
+		result.boxMillis = std::min(result.boxMillis, (boxEnd - boxStart).Millis());
+	}
+
+	return result;
+}
+
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <render/culling.h>
+
+
+namespace xtest {
+namespace render {
+
+	// the counts and the best times of the spheres and of the boxes of the same objects
+	struct CullingBenchmarkResult
+	{
+		uint32 objectCount = 0;
+		uint32 visibleSphereCount = 0;
+		uint32 visibleBoxCount = 0;
+		float sphereMillis = 0.f;
+		float boxMillis = 0.f;
+	};
+
+
+	/**
+	Culls objects of random bounds scattered around the camera, a part of them in the frustum, with CullSpheres and
+	with CullBoxes. The objects come from a fixed seed, every count gets the same ones at every run.
+	@param threadCount	Passed to the culling, 0 means one per hardware thread.
+	@param repeatCount	The objects are culled this many times, the best time is kept.
+	*/
+	CullingBenchmarkResult RunCullingBenchmark(uint32 objectCount, uint32 threadCount = 0, uint32 repeatCount = 10);
+
+} // render
+} // xtest
+
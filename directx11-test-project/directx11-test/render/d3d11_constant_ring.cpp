@@ -0,0 +1,146 @@
+#include "stdafx.h"
+#include "d3d11_constant_ring.h"
+#include <thread>
+
+
+using Microsoft::WRL::ComPtr;
+using xtest::render::ConstantRingAllocator;
+using xtest::render::D3D11ConstantRing;
+
+
+D3D11ConstantRing::D3D11ConstantRing(ComPtr<ID3D11Device> d3dDevice, ComPtr<ID3D11DeviceContext> d3dContext, uint32 capacity, uint32 maxFramesInFlight)
+	: m_d3dContext(d3dContext)
+	, m_d3dBuffer()
+	, m_allocator(capacity)
+	, m_frameQueries(maxFramesInFlight)
+	, m_frameIndex(0)
+	, m_mappedData(nullptr)
+	, m_isMappedBefore(false)
+{
+	XTEST_ASSERT(d3dDevice && d3dContext);
+	XTEST_ASSERT(maxFramesInFlight > 0);
+
+	// mapping a dynamic constant buffer without discarding it and binding its ranges are both d3d11.1 options
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+	ZeroMemory(&options, sizeof(D3D11_FEATURE_DATA_D3D11_OPTIONS));
+	XTEST_D3D_CHECK(d3dDevice->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(D3D11_FEATURE_DATA_D3D11_OPTIONS)));
+	XTEST_ASSERT(options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer, L"constant buffer ranges not supported");
+
+	D3D11_BUFFER_DESC bufferDesc;
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = capacity;
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+	XTEST_D3D_CHECK(d3dDevice->CreateBuffer(&bufferDesc, nullptr, &m_d3dBuffer));
+
+	D3D11_QUERY_DESC queryDesc;
+	queryDesc.Query = D3D11_QUERY_EVENT;
+	queryDesc.MiscFlags = 0;
+	for (ComPtr<ID3D11Query>& query : m_frameQueries)
+	{
+		XTEST_D3D_CHECK(d3dDevice->CreateQuery(&queryDesc, &query));
+	}
+}
+
+
+ComPtr<ID3D11Buffer> D3D11ConstantRing::Buffer() const
+{
+	return m_d3dBuffer;
+}
+
+
+void D3D11ConstantRing::BeginFrame()
+{
+	XTEST_ASSERT(!m_mappedData, L"the previous frame is still mapped");
+
+	while (m_allocator.FramesInFlight() > 0)
+	{
+		const uint64 oldestFrame = m_allocator.OldestFrameInFlight();
+		const bool isTooManyInFlight = m_allocator.FramesInFlight() == m_frameQueries.size();
+		if (!IsFrameDone(oldestFrame, isTooManyInFlight))
+		{
+			break;
+		}
+		m_allocator.RetireFrames(oldestFrame);
+	}
+
+	m_allocator.BeginFrame(m_frameIndex);
+
+	// the first map must discard, after that the space in use is never written so nothing has to wait
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	ZeroMemory(&mappedResource, sizeof(D3D11_MAPPED_SUBRESOURCE));
+	const D3D11_MAP mapType = m_isMappedBefore ? D3D11_MAP_WRITE_NO_OVERWRITE : D3D11_MAP_WRITE_DISCARD;
+	XTEST_D3D_CHECK(m_d3dContext->Map(m_d3dBuffer.Get(), 0, mapType, 0, &mappedResource));
+	m_mappedData = static_cast<uint8*>(mappedResource.pData);
+	m_isMappedBefore = true;
+}
+
+
+void* D3D11ConstantRing::Allocate(uint32 size, uint32* offset)
+{
+	XTEST_ASSERT(m_mappedData, L"allocations are made between BeginFrame and Unmap");
+	XTEST_ASSERT(offset);
+
+	*offset = m_allocator.Allocate(size);
+	while (*offset == kInvalidConstantOffset)
+	{
+		// with no frame left to wait for, the current one alone has filled the ring
+		XTEST_ASSERT(m_allocator.FramesInFlight() > 0, L"a frame needs more than the %u bytes of the ring", m_allocator.Capacity());
+		if (m_allocator.FramesInFlight() == 0)
+		{
+			return nullptr;
+		}
+
+		const uint64 oldestFrame = m_allocator.OldestFrameInFlight();
+		IsFrameDone(oldestFrame, true);
+		m_allocator.RetireFrames(oldestFrame);
+		*offset = m_allocator.Allocate(size);
+	}
+
+	return m_mappedData + *offset;
+}
+
+
+void D3D11ConstantRing::Unmap()
+{
+	XTEST_ASSERT(m_mappedData, L"not mapped");
+
+	m_d3dContext->Unmap(m_d3dBuffer.Get(), 0);
+	m_mappedData = nullptr;
+}
+
+
+void D3D11ConstantRing::EndFrame()
+{
+	XTEST_ASSERT(!m_mappedData, L"the frame is still mapped");
+
+	m_d3dContext->End(m_frameQueries[m_frameIndex % m_frameQueries.size()].Get());
+	m_allocator.EndFrame();
+	m_frameIndex++;
+}
+
+
+const ConstantRingAllocator& D3D11ConstantRing::Allocator() const
+{
+	return m_allocator;
+}
+
+
+bool D3D11ConstantRing::IsFrameDone(uint64 frameIndex, bool wait)
+{
+	ID3D11Query* query = m_frameQueries[frameIndex % m_frameQueries.size()].Get();
+	if (!wait)
+	{
+		return m_d3dContext->GetData(query, nullptr, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+	}
+
+	// the commands are flushed while waiting, the gpu can't finish what it hasn't been given
+	while (m_d3dContext->GetData(query, nullptr, 0, 0) != S_OK)
+	{
+		std::this_thread::yield();
+	}
+	return true;
+}
+
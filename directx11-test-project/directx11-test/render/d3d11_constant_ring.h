@@ -0,0 +1,60 @@
+#pragma once
+
+#include <render/constant_ring_allocator.h>
+
+
+namespace xtest {
+namespace render {
+
+	/**
+	The constant data of every draw in one dynamic buffer, handed out by a ConstantRingAllocator. The buffer is
+	mapped once a frame without discarding it, so the data of the frames the gpu is still reading stays there;
+	an event query at the end of every frame tells when their space can be used again. The allocations are bound
+	as ranges of the buffer, which takes a d3d11.1 context.
+	*/
+	class D3D11ConstantRing
+	{
+	public:
+
+		D3D11ConstantRing(Microsoft::WRL::ComPtr<ID3D11Device> d3dDevice, Microsoft::WRL::ComPtr<ID3D11DeviceContext> d3dContext, uint32 capacity, uint32 maxFramesInFlight = 3);
+
+		D3D11ConstantRing(D3D11ConstantRing&&) = default;
+		D3D11ConstantRing(const D3D11ConstantRing&) = delete;
+		D3D11ConstantRing& operator=(D3D11ConstantRing&&) = default;
+		D3D11ConstantRing& operator=(const D3D11ConstantRing&) = delete;
+
+
+		Microsoft::WRL::ComPtr<ID3D11Buffer> Buffer() const;
+
+		// retires the frames the gpu is done with, waiting for the oldest one when too many are in flight, then
+		// maps the buffer
+		void BeginFrame();
+
+		// the returned memory is written until Unmap; waits for the gpu when the frames in flight hold the space.
+		// null, with an offset of kInvalidConstantOffset, when the frame needs more than the whole ring
+		void* Allocate(uint32 size, uint32* offset);
+		void Unmap();
+
+		// after the draws reading the data of the frame have been issued
+		void EndFrame();
+
+		const ConstantRingAllocator& Allocator() const;
+
+	private:
+
+		bool IsFrameDone(uint64 frameIndex, bool wait);
+
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_d3dContext;
+		Microsoft::WRL::ComPtr<ID3D11Buffer> m_d3dBuffer;
+		ConstantRingAllocator m_allocator;
+
+		// the query of a frame is at its index modulo the size
+		std::vector<Microsoft::WRL::ComPtr<ID3D11Query>> m_frameQueries;
+		uint64 m_frameIndex;
+		uint8* m_mappedData;
+		bool m_isMappedBefore;
+	};
+
+} // render
+} // xtest
+
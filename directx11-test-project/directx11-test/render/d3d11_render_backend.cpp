@@ -0,0 +1,136 @@
+#include "stdafx.h"
+#include "d3d11_render_backend.h"
+
+
+using Microsoft::WRL::ComPtr;
+using xtest::render::ConstantBufferBinding;
+using xtest::render::D3D11Pipeline;
+using xtest::render::D3D11RenderBackend;
+using xtest::render::ResourceHandle;
+using xtest::render::ShaderStage;
+
+
+namespace
+{
+	// the same resource always gets the same handle, so that packets binding it compare equal
+	template <typename Resource>
+	ResourceHandle FindOrAdd(const ComPtr<Resource>& resource, std::vector<ComPtr<Resource>>* resources)
+	{
+		const auto found = std::find(resources->begin() + 1, resources->end(), resource);
+		if (found != resources->end())
+		{
+			return ResourceHandle(found - resources->begin());
+		}
+
+		resources->push_back(resource);
+		return ResourceHandle(resources->size() - 1);
+	}
+}
+
+
+D3D11RenderBackend::D3D11RenderBackend(ComPtr<ID3D11DeviceContext> d3dContext)
+	: m_d3dContext(d3dContext)
+	, m_d3dContext1()
+	, m_pipelines(1)
+	, m_buffers(1)
+	, m_textures(1)
+{
+	XTEST_ASSERT(d3dContext);
+	XTEST_D3D_CHECK(m_d3dContext.As(&m_d3dContext1));
+}
+
+
+ResourceHandle D3D11RenderBackend::AddPipeline(const D3D11Pipeline& pipeline)
+{
+	m_pipelines.push_back(pipeline);
+	return ResourceHandle(m_pipelines.size() - 1);
+}
+
+
+ResourceHandle D3D11RenderBackend::AddBuffer(ComPtr<ID3D11Buffer> d3dBuffer)
+{
+	return FindOrAdd(d3dBuffer, &m_buffers);
+}
+
+
+ResourceHandle D3D11RenderBackend::AddTexture(ComPtr<ID3D11ShaderResourceView> d3dTextureView)
+{
+	return FindOrAdd(d3dTextureView, &m_textures);
+}
+
+
+void D3D11RenderBackend::SetPipeline(ResourceHandle pipeline)
+{
+	XTEST_ASSERT(pipeline < m_pipelines.size(), L"unknown pipeline %u", pipeline);
+	const D3D11Pipeline& d3dPipeline = m_pipelines[pipeline];
+
+	m_d3dContext->RSSetState(d3dPipeline.rasterizerState.Get());
+	m_d3dContext->IASetInputLayout(d3dPipeline.inputLayout.Get());
+	m_d3dContext->IASetPrimitiveTopology(d3dPipeline.topology);
+	m_d3dContext->VSSetShader(d3dPipeline.vertexShader.Get(), nullptr, 0);
+	m_d3dContext->PSSetShader(d3dPipeline.pixelShader.Get(), nullptr, 0);
+	m_d3dContext->PSSetSamplers(0, 1, d3dPipeline.sampler.GetAddressOf());
+}
+
+
+void D3D11RenderBackend::SetVertexBuffer(ResourceHandle buffer, uint32 stride)
+{
+	XTEST_ASSERT(buffer < m_buffers.size(), L"unknown buffer %u", buffer);
+
+	const UINT offset = 0;
+	m_d3dContext->IASetVertexBuffers(0, 1, m_buffers[buffer].GetAddressOf(), &stride, &offset);
+}
+
+
+void D3D11RenderBackend::SetIndexBuffer(ResourceHandle buffer)
+{
+	XTEST_ASSERT(buffer < m_buffers.size(), L"unknown buffer %u", buffer);
+	m_d3dContext->IASetIndexBuffer(m_buffers[buffer].Get(), DXGI_FORMAT_R32_UINT, 0);
+}
+
+
+void D3D11RenderBackend::SetConstantBuffer(ShaderStage stage, uint32 slot, const ConstantBufferBinding& binding)
+{
+	XTEST_ASSERT(binding.buffer < m_buffers.size(), L"unknown buffer %u", binding.buffer);
+	ID3D11Buffer* const* d3dBuffer = m_buffers[binding.buffer].GetAddressOf();
+
+	if (binding.size == 0)
+	{
+		if (stage == ShaderStage::vertex)
+		{
+			m_d3dContext->VSSetConstantBuffers(slot, 1, d3dBuffer);
+		}
+		else
+		{
+			m_d3dContext->PSSetConstantBuffers(slot, 1, d3dBuffer);
+		}
+		return;
+	}
+
+	// the range is in constants of 16 bytes, a multiple of 16 of them
+	XTEST_ASSERT(binding.offset % kConstantBufferAlignment == 0, L"constant buffer offset %u not aligned", binding.offset);
+	const UINT firstConstant = binding.offset / 16;
+	const UINT constantCount = ((binding.size + kConstantBufferAlignment - 1) / kConstantBufferAlignment) * (kConstantBufferAlignment / 16);
+
+	if (stage == ShaderStage::vertex)
+	{
+		m_d3dContext1->VSSetConstantBuffers1(slot, 1, d3dBuffer, &firstConstant, &constantCount);
+	}
+	else
+	{
+		m_d3dContext1->PSSetConstantBuffers1(slot, 1, d3dBuffer, &firstConstant, &constantCount);
+	}
+}
+
+
+void D3D11RenderBackend::SetTexture(uint32 slot, ResourceHandle texture)
+{
+	XTEST_ASSERT(texture < m_textures.size(), L"unknown texture %u", texture);
+	m_d3dContext->PSSetShaderResources(slot, 1, m_textures[texture].GetAddressOf());
+}
+
+
+void D3D11RenderBackend::DrawIndexed(uint32 indexCount, uint32 startIndex, int32 baseVertex)
+{
+	m_d3dContext->DrawIndexed(indexCount, startIndex, baseVertex);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <render/render_backend.h>
+
+
+namespace xtest {
+namespace render {
+
+	struct D3D11Pipeline
+	{
+		Microsoft::WRL::ComPtr<ID3D11VertexShader> vertexShader;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader> pixelShader;
+		Microsoft::WRL::ComPtr<ID3D11InputLayout> inputLayout;
+		Microsoft::WRL::ComPtr<ID3D11RasterizerState> rasterizerState;
+		Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler;	// bound to the first sampler slot of the pixel shader
+		D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+	};
+
+
+	// makes the calls on a d3d11 context, the resources are added once and then referred to by their handles;
+	// adding a resource again gives back its handle, a null resource gets a handle too and binding it unbinds the slot
+	class D3D11RenderBackend : public RenderBackend
+	{
+	public:
+
+		explicit D3D11RenderBackend(Microsoft::WRL::ComPtr<ID3D11DeviceContext> d3dContext);
+
+		D3D11RenderBackend(D3D11RenderBackend&&) = default;
+		D3D11RenderBackend(const D3D11RenderBackend&) = delete;
+		D3D11RenderBackend& operator=(D3D11RenderBackend&&) = default;
+		D3D11RenderBackend& operator=(const D3D11RenderBackend&) = delete;
+
+
+		ResourceHandle AddPipeline(const D3D11Pipeline& pipeline);
+		ResourceHandle AddBuffer(Microsoft::WRL::ComPtr<ID3D11Buffer> d3dBuffer);
+		ResourceHandle AddTexture(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> d3dTextureView);
+
+		virtual void SetPipeline(ResourceHandle pipeline) override;
+		virtual void SetVertexBuffer(ResourceHandle buffer, uint32 stride) override;
+		virtual void SetIndexBuffer(ResourceHandle buffer) override;
+		virtual void SetConstantBuffer(ShaderStage stage, uint32 slot, const ConstantBufferBinding& binding) override;
+		virtual void SetTexture(uint32 slot, ResourceHandle texture) override;
+		virtual void DrawIndexed(uint32 indexCount, uint32 startIndex, int32 baseVertex) override;
+
+	private:
+
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_d3dContext;
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext1> m_d3dContext1;	// binds the ranges of the constant buffers
+
+		// a handle is the index in its array, the first element stands for kNullResource
+		std::vector<D3D11Pipeline> m_pipelines;
+		std::vector<Microsoft::WRL::ComPtr<ID3D11Buffer>> m_buffers;
+		std::vector<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> m_textures;
+	};
+
+} // render
+} // xtest
+
@@ -0,0 +1,221 @@
+#include "stdafx.h"
+#include "draw_queue.h"
+
+
+using xtest::render::ConstantBufferBinding;
+using xtest::render::DrawPacket;
+using xtest::render::DrawQueue;
+using xtest::render::DrawQueueStatistics;
+using xtest::render::RenderBackend;
+using xtest::render::ResourceHandle;
+using xtest::render::ShaderStage;
+
+
+namespace
+{
+	const uint32 kRadixBits = 8;
+	const uint32 kRadixBucketCount = 1 << kRadixBits;
+	const uint32 kRadixPassCount = 64 / kRadixBits;
+
+
+	bool IsNull(ResourceHandle resource)
+	{
+		return resource == xtest::render::kNullResource;
+	}
+
+	bool IsNull(const ConstantBufferBinding& binding)
+	{
+		return binding.buffer == xtest::render::kNullResource;
+	}
+
+
+	// binds a resource only when it differs from the one the slot already has
+	template <typename Resource>
+	bool NeedsBind(const Resource& resource, Resource* boundResource, DrawQueueStatistics* statistics)
+	{
+		if (IsNull(resource))
+		{
+			return false;
+		}
+
+		if (resource == *boundResource)
+		{
+			statistics->elidedBindCount++;
+			return false;
+		}
+
+		*boundResource = resource;
+		statistics->bindCount++;
+		return true;
+	}
+}
+
+
+uint64 xtest::render::MakeSortKey(uint32 pass, ResourceHandle pipeline, uint32 textureSet, uint32 depthBucket)
+{
+	XTEST_ASSERT(pass < (1u << kSortKeyPassBits), L"pass %u out of the sort key", pass);
+	XTEST_ASSERT(pipeline < (1u << kSortKeyPipelineBits), L"pipeline %u out of the sort key", pipeline);
+	XTEST_ASSERT(textureSet < (1u << kSortKeyTextureSetBits), L"texture set %u out of the sort key", textureSet);
+	XTEST_ASSERT(depthBucket <= kMaxDepthBucket, L"depth bucket %u out of the sort key", depthBucket);
+
+	return (uint64(pass) << (kSortKeyPipelineBits + kSortKeyTextureSetBits + kSortKeyDepthBits))
+		| (uint64(pipeline) << (kSortKeyTextureSetBits + kSortKeyDepthBits))
+		| (uint64(textureSet) << kSortKeyDepthBits)
+		| uint64(depthBucket);
+}
+
+
+uint32 xtest::render::DepthBucket(float viewDepth, float nearZ, float farZ)
+{
+	XTEST_ASSERT(farZ > nearZ);
+
+	const float normalizedDepth = (viewDepth - nearZ) / (farZ - nearZ);
+	if (!(normalizedDepth > 0.f))
+	{
+		return 0;
+	}
+	if (normalizedDepth >= 1.f)
+	{
+		return kMaxDepthBucket;
+	}
+	return uint32(normalizedDepth * float(kMaxDepthBucket));
+}
+
+
+DrawQueue::DrawQueue()
+	: m_packets()
+	, m_items()
+	, m_sortBuffer()
+	, m_statistics()
+{}
+
+
+void DrawQueue::Add(uint64 sortKey, const DrawPacket& packet)
+{
+	m_items.push_back({ sortKey, uint32(m_packets.size()) });
+	m_packets.push_back(packet);
+}
+
+
+void DrawQueue::Clear()
+{
+	m_packets.clear();
+	m_items.clear();
+}
+
+
+uint32 DrawQueue::Count() const
+{
+	return uint32(m_items.size());
+}
+
+
+void DrawQueue::Sort()
+{
+	// least significant digit first, the histograms of all the digits are counted in a single read; a digit
+	// every key shares doesn't reorder anything and its pass is skipped
+	std::array<std::array<uint32, kRadixBucketCount>, kRadixPassCount> histograms = {};
+	for (const SortItem& item : m_items)
+	{
+		for (uint32 pass = 0; pass < kRadixPassCount; pass++)
+		{
+			histograms[pass][(item.key >> (pass * kRadixBits)) & (kRadixBucketCount - 1)]++;
+		}
+	}
+
+	m_sortBuffer.resize(m_items.size());
+	for (uint32 pass = 0; pass < kRadixPassCount; pass++)
+	{
+		std::array<uint32, kRadixBucketCount>& histogram = histograms[pass];
+		const uint32 shift = pass * kRadixBits;
+		if (histogram[(m_items.empty() ? 0 : m_items[0].key >> shift) & (kRadixBucketCount - 1)] == m_items.size())
+		{
+			continue;
+		}
+
+		// the counts become the first position of every bucket
+		uint32 offset = 0;
+		for (uint32& count : histogram)
+		{
+			const uint32 bucketCount = count;
+			count = offset;
+			offset += bucketCount;
+		}
+
+		for (const SortItem& item : m_items)
+		{
+			m_sortBuffer[histogram[(item.key >> shift) & (kRadixBucketCount - 1)]++] = item;
+		}
+		m_items.swap(m_sortBuffer);
+	}
+}
+
+
+void DrawQueue::Execute(RenderBackend* backend)
+{
+	XTEST_ASSERT(backend);
+
+	ResourceHandle boundPipeline = kNullResource;
+	ResourceHandle boundVertexBuffer = kNullResource;
+	uint32 boundVertexStride = 0;
+	ResourceHandle boundIndexBuffer = kNullResource;
+	std::array<ConstantBufferBinding, kConstantBufferSlotCount> boundVertexConstantBuffers = {};
+	std::array<ConstantBufferBinding, kConstantBufferSlotCount> boundPixelConstantBuffers = {};
+	std::array<ResourceHandle, kTextureSlotCount> boundTextures = {};
+
+	m_statistics = DrawQueueStatistics();
+	for (const SortItem& item : m_items)
+	{
+		const DrawPacket& packet = m_packets[item.packet];
+
+		if (NeedsBind(packet.pipeline, &boundPipeline, &m_statistics))
+		{
+			backend->SetPipeline(packet.pipeline);
+		}
+
+		// the same buffer with another stride is another binding
+		if (packet.vertexBuffer != kNullResource && packet.vertexStride != boundVertexStride)
+		{
+			boundVertexBuffer = kNullResource;
+			boundVertexStride = packet.vertexStride;
+		}
+		if (NeedsBind(packet.vertexBuffer, &boundVertexBuffer, &m_statistics))
+		{
+			backend->SetVertexBuffer(packet.vertexBuffer, packet.vertexStride);
+		}
+		if (NeedsBind(packet.indexBuffer, &boundIndexBuffer, &m_statistics))
+		{
+			backend->SetIndexBuffer(packet.indexBuffer);
+		}
+
+		for (uint32 slot = 0; slot < kConstantBufferSlotCount; slot++)
+		{
+			if (NeedsBind(packet.vertexConstantBuffers[slot], &boundVertexConstantBuffers[slot], &m_statistics))
+			{
+				backend->SetConstantBuffer(ShaderStage::vertex, slot, packet.vertexConstantBuffers[slot]);
+			}
+			if (NeedsBind(packet.pixelConstantBuffers[slot], &boundPixelConstantBuffers[slot], &m_statistics))
+			{
+				backend->SetConstantBuffer(ShaderStage::pixel, slot, packet.pixelConstantBuffers[slot]);
+			}
+		}
+
+		for (uint32 slot = 0; slot < kTextureSlotCount; slot++)
+		{
+			if (NeedsBind(packet.textures[slot], &boundTextures[slot], &m_statistics))
+			{
+				backend->SetTexture(slot, packet.textures[slot]);
+			}
+		}
+
+		backend->DrawIndexed(packet.indexCount, packet.startIndex, packet.baseVertex);
+		m_statistics.drawCount++;
+	}
+}
+
+
+const DrawQueueStatistics& DrawQueue::Statistics() const
+{
+	return m_statistics;
+}
+
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <render/render_backend.h>
+
+
+namespace xtest {
+namespace render {
+
+	// everything a draw binds and its arguments, slots without a resource are left as they are
+	struct DrawPacket
+	{
+		ResourceHandle pipeline = kNullResource;
+		ResourceHandle vertexBuffer = kNullResource;
+		uint32 vertexStride = 0;
+		ResourceHandle indexBuffer = kNullResource;
+		std::array<ConstantBufferBinding, kConstantBufferSlotCount> vertexConstantBuffers = {};
+		std::array<ConstantBufferBinding, kConstantBufferSlotCount> pixelConstantBuffers = {};
+		std::array<ResourceHandle, kTextureSlotCount> textures = {};
+
+		uint32 indexCount = 0;
+		uint32 startIndex = 0;
+		int32 baseVertex = 0;
+	};
+
+
+	// the fields of a sort key from the most significant bits down: the draws sort by pass first, then by
+	// pipeline, by texture set and last by depth
+	const uint32 kSortKeyPassBits = 4;
+	const uint32 kSortKeyPipelineBits = 12;
+	const uint32 kSortKeyTextureSetBits = 24;
+	const uint32 kSortKeyDepthBits = 24;
+
+	const uint32 kMaxDepthBucket = (1u << kSortKeyDepthBits) - 1;
+
+
+	// every value must fit its field
+	uint64 MakeSortKey(uint32 pass, ResourceHandle pipeline, uint32 textureSet, uint32 depthBucket);
+
+	// the view space depth mapped linearly from [nearZ, farZ] to [0, kMaxDepthBucket], so that the nearest draws
+	// come first; a pass drawn back to front uses kMaxDepthBucket minus the bucket instead
+	uint32 DepthBucket(float viewDepth, float nearZ, float farZ);
+
+
+	// what the submission of a frame bound and what it skipped
+	struct DrawQueueStatistics
+	{
+		uint32 drawCount = 0;
+		uint32 bindCount = 0;			// set calls made on the backend, a pipeline counts as one
+		uint32 elidedBindCount = 0;		// the ones skipped because the resource was already bound
+	};
+
+
+	/**
+	The draws of a frame with a sort key each. Sort orders them by key with a radix sort and Execute submits them
+	tracking what is bound, so that a packet binding the same resources as the one before only costs its draw.
+	Nothing is assumed to be bound when Execute starts.
+	*/
+	class DrawQueue
+	{
+	public:
+
+		DrawQueue();
+
+		void Add(uint64 sortKey, const DrawPacket& packet);
+		void Clear();
+		uint32 Count() const;
+
+		// stable: draws with the same key keep the order they were added in
+		void Sort();
+
+		void Execute(RenderBackend* backend);
+
+		const DrawQueueStatistics& Statistics() const;
+
+	private:
+
+		struct SortItem
+		{
+			uint64 key;
+			uint32 packet;
+		};
+
+		std::vector<DrawPacket> m_packets;
+		std::vector<SortItem> m_items;
+		std::vector<SortItem> m_sortBuffer;
+		DrawQueueStatistics m_statistics;
+	};
+
+} // render
+} // xtest
+
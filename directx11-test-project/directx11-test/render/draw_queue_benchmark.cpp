@@ -0,0 +1,95 @@
+#include "stdafx.h"
+#include "draw_queue_benchmark.h"
+#include <render/recording_backend.h>
+#include <time/time_point.h>
+#include <cfloat>
+#include <random>
+
+
+using xtest::render::DrawQueueBenchmarkResult;
+
+
+DrawQueueBenchmarkResult xtest::render::RunDrawQueueBenchmark(uint32 drawCount, uint32 repeatCount)
+{
+	// two passes, 64 pipelines, 512 texture sets of two textures and 2000 meshes, every draw with its own slice
+	// of a per object constant buffer and a per material one shared by the texture set
+	std::mt19937 random(drawCount);
+	std::uniform_int_distribution<uint32> pass(0, 1);
+	std::uniform_int_distribution<uint32> pipeline(1, 64);
+	std::uniform_int_distribution<uint32> textureSet(0, 511);
+	std::uniform_int_distribution<uint32> mesh(0, 1999);
+	std::uniform_int_distribution<uint32> depthBucket(0, kMaxDepthBucket);
+
+	std::vector<uint64> sortKeys;
+	std::vector<DrawPacket> packets;
+	for (uint32 index = 0; index < drawCount; index++)
+	{
+		const uint32 drawTextureSet = textureSet(random);
+		const uint32 drawMesh = mesh(random);
+
+		DrawPacket packet;
+		packet.pipeline = pipeline(random);
+		packet.vertexBuffer = 1000 + drawMesh;
+		packet.vertexStride = 48;
+		packet.indexBuffer = 3000 + drawMesh;
+		packet.vertexConstantBuffers[0] = { 5000, 256 * index, 256 };
+		packet.pixelConstantBuffers[1] = { 5001, 256 * drawTextureSet, 256 };
+		packet.textures[0] = 6000 + 2 * drawTextureSet;
+		packet.textures[1] = 6001 + 2 * drawTextureSet;
+		packet.indexCount = 3 * (1 + drawMesh % 500);
+
+		sortKeys.push_back(MakeSortKey(pass(random), packet.pipeline, drawTextureSet, depthBucket(random)));
+		packets.push_back(packet);
+	}
+
+	struct StableSortItem
+	{
+		uint64 key;
+		uint32 packet;
+	};
+
+	DrawQueue queue;
+	RecordingBackend backend(false);
+	std::vector<StableSortItem> stableSortItems;
+
+	DrawQueueBenchmarkResult result;
+	result.drawCount = drawCount;
+	result.sortMillis = FLT_MAX;
+	result.stableSortMillis = FLT_MAX;
+	result.executeMillis = FLT_MAX;
+	for (uint32 repeat = 0; repeat < std::max(repeatCount, 1u); repeat++)
+	{
+		queue.Clear();
+		stableSortItems.clear();
+		for (uint32 index = 0; index < drawCount; index++)
+		{
+			queue.Add(sortKeys[index], packets[index]);
+			stableSortItems.push_back({ sortKeys[index], index });
+		}
+
+		if (repeat == 0)
+		{
+			queue.Execute(&backend);
+			result.unsortedBindCount = queue.Statistics().bindCount;
+		}
+
+		const time::TimePoint sortStart = time::TimePoint::Now();
+		queue.Sort();
+
+		const time::TimePoint stableSortStart = time::TimePoint::Now();
+		std::stable_sort(stableSortItems.begin(), stableSortItems.end(), [](const StableSortItem& a, const StableSortItem& b) { return a.key < b.key; });
+
+		const time::TimePoint executeStart = time::TimePoint::Now();
+		backend.Reset();
+		queue.Execute(&backend);
+
+		const time::TimePoint executeEnd = time::TimePoint::Now();
+		result.sortMillis = std::min(result.sortMillis, (stableSortStart - sortStart).Millis());
+		result.stableSortMillis = std::min(result.stableSortMillis, (executeStart - stableSortStart).Millis());
+		result.executeMillis = std::min(result.executeMillis, (executeEnd - executeStart).Millis());
+	}
+
+	result.bindCount = queue.Statistics().bindCount;
+	result.elidedBindCount = queue.Statistics().elidedBindCount;
+	return result;
+}
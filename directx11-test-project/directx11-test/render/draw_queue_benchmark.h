@@ -0,0 +1,32 @@
+#pragma once
+
+#include <render/draw_queue.h>
+
+
+namespace xtest {
+namespace render {
+
+	// the best times of the radix sort, of std::stable_sort on the same keys and of the submission, with the binds
+	// of the sorted and of the unsorted draws
+	struct DrawQueueBenchmarkResult
+	{
+		uint32 drawCount = 0;
+		uint32 bindCount = 0;
+		uint32 elidedBindCount = 0;
+		uint32 unsortedBindCount = 0;	// the binds of the draws submitted in the order they were added
+		float sortMillis = 0.f;
+		float stableSortMillis = 0.f;
+		float executeMillis = 0.f;
+	};
+
+
+	/**
+	Sorts and submits random draws of a few pipelines, texture sets and meshes to a RecordingBackend that keeps no
+	commands, so that only the queue is timed. The draws come from a fixed seed, every count gets the same ones at
+	every run.
+	@param repeatCount	The draws are sorted and submitted this many times, the best time is kept.
+	*/
+	DrawQueueBenchmarkResult RunDrawQueueBenchmark(uint32 drawCount = 100000, uint32 repeatCount = 5);
+
+} // render
+} // xtest
@@ -0,0 +1,239 @@
+#include "stdafx.h"
+#include "object_transforms.h"
+#include <common/parallel_for.h>
+
+
+using namespace DirectX;
+using xtest::render::ObjectTransforms;
+using xtest::render::WorldTransforms;
+
+
+namespace
+{
+	// the matrices of a block are computed by the same thread, a multiple of 4 so that only the last block has a tail
+	const uint32 kTransformBlockSize = 4 * 1024;
+
+	// the elements of the identity, the missing lanes of the last 4 objects are filled with it so that their inverse
+	// is not a division by zero
+	const float kIdentityElements[12] = { 1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f };
+
+
+	// the elements of the view-projection matrix replicated in all the lanes
+	struct MatrixLanes
+	{
+		XMVECTOR m[4][4];
+
+		explicit MatrixLanes(FXMMATRIX matrix)
+		{
+			XMFLOAT4X4 elements;
+			XMStoreFloat4x4(&elements, matrix);
+			for (uint32 row = 0; row < 4; row++)
+			{
+				for (uint32 column = 0; column < 4; column++)
+				{
+					m[row][column] = XMVectorReplicate(elements.m[row][column]);
+				}
+			}
+		}
+	};
+
+
+	// the vectors hold one element of 4 objects, once transposed they are 4 elements of every object: writes them in
+	// the same row of the matrix of the 4 objects, which are an ObjectTransforms apart
+	void StoreLanes(FXMVECTOR x, FXMVECTOR y, FXMVECTOR z, GXMVECTOR w, XMFLOAT4X4* matrix, uint32 row)
+	{
+		const XMMATRIX lanes = XMMatrixTranspose(XMMATRIX(x, y, z, w));
+		uint8* destination = reinterpret_cast<uint8*>(matrix->m[row]);
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(destination), lanes.r[0]);
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(destination + sizeof(ObjectTransforms)), lanes.r[1]);
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(destination + 2 * sizeof(ObjectTransforms)), lanes.r[2]);
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(destination + 3 * sizeof(ObjectTransforms)), lanes.r[3]);
+	}
+
+
+	// x * u + y * v + z * w in every lane
+	XMVECTOR DotLanes(FXMVECTOR x, FXMVECTOR y, FXMVECTOR z, GXMVECTOR u, HXMVECTOR v, HXMVECTOR w)
+	{
+		XMVECTOR result = XMVectorMultiply(x, u);
+		result = XMVectorMultiplyAdd(y, v, result);
+		return XMVectorMultiplyAdd(z, w, result);
+	}
+
+
+	// the matrices of 4 objects, the elements of their world matrices are in a[row][column]
+	void ComputeLanes(const XMVECTOR (&a)[4][3], const MatrixLanes& viewProjection, ObjectTransforms* transforms)
+	{
+		const XMVECTOR zero = XMVectorZero();
+		const XMVECTOR one = XMVectorSplatOne();
+
+		// W, transposed: the rows are the columns
+		StoreLanes(a[0][0], a[1][0], a[2][0], a[3][0], &transforms->W, 0);
+		StoreLanes(a[0][1], a[1][1], a[2][1], a[3][1], &transforms->W, 1);
+		StoreLanes(a[0][2], a[1][2], a[2][2], a[3][2], &transforms->W, 2);
+		StoreLanes(zero, zero, zero, one, &transforms->W, 3);
+
+		// WVP, transposed: every column through the view-projection, the translation row takes its last row too
+		for (uint32 column = 0; column < 4; column++)
+		{
+			const XMVECTOR& vp0 = viewProjection.m[0][column];
+			const XMVECTOR& vp1 = viewProjection.m[1][column];
+			const XMVECTOR& vp2 = viewProjection.m[2][column];
+			StoreLanes(
+				DotLanes(a[0][0], a[0][1], a[0][2], vp0, vp1, vp2),
+				DotLanes(a[1][0], a[1][1], a[1][2], vp0, vp1, vp2),
+				DotLanes(a[2][0], a[2][1], a[2][2], vp0, vp1, vp2),
+				XMVectorAdd(DotLanes(a[3][0], a[3][1], a[3][2], vp0, vp1, vp2), viewProjection.m[3][column]),
+				&transforms->WVP,
+				column);
+		}
+
+		// the inverse of the 3x3 part is its adjugate over the determinant, the translation goes back through it
+		const XMVECTOR cofactor00 = XMVectorNegativeMultiplySubtract(a[1][2], a[2][1], XMVectorMultiply(a[1][1], a[2][2]));
+		const XMVECTOR cofactor01 = XMVectorNegativeMultiplySubtract(a[1][0], a[2][2], XMVectorMultiply(a[1][2], a[2][0]));
+		const XMVECTOR cofactor02 = XMVectorNegativeMultiplySubtract(a[1][1], a[2][0], XMVectorMultiply(a[1][0], a[2][1]));
+
+		const XMVECTOR inverseDeterminant = XMVectorReciprocal(DotLanes(a[0][0], a[0][1], a[0][2], cofactor00, cofactor01, cofactor02));
+
+		const XMVECTOR inverse00 = XMVectorMultiply(cofactor00, inverseDeterminant);
+		const XMVECTOR inverse10 = XMVectorMultiply(cofactor01, inverseDeterminant);
+		const XMVECTOR inverse20 = XMVectorMultiply(cofactor02, inverseDeterminant);
+		const XMVECTOR inverse01 = XMVectorMultiply(XMVectorNegativeMultiplySubtract(a[0][1], a[2][2], XMVectorMultiply(a[0][2], a[2][1])), inverseDeterminant);
+		const XMVECTOR inverse11 = XMVectorMultiply(XMVectorNegativeMultiplySubtract(a[0][2], a[2][0], XMVectorMultiply(a[0][0], a[2][2])), inverseDeterminant);
+		const XMVECTOR inverse21 = XMVectorMultiply(XMVectorNegativeMultiplySubtract(a[0][0], a[2][1], XMVectorMultiply(a[0][1], a[2][0])), inverseDeterminant);
+		const XMVECTOR inverse02 = XMVectorMultiply(XMVectorNegativeMultiplySubtract(a[0][2], a[1][1], XMVectorMultiply(a[0][1], a[1][2])), inverseDeterminant);
+		const XMVECTOR inverse12 = XMVectorMultiply(XMVectorNegativeMultiplySubtract(a[0][0], a[1][2], XMVectorMultiply(a[0][2], a[1][0])), inverseDeterminant);
+		const XMVECTOR inverse22 = XMVectorMultiply(XMVectorNegativeMultiplySubtract(a[0][1], a[1][0], XMVectorMultiply(a[0][0], a[1][1])), inverseDeterminant);
+
+		const XMVECTOR inverse30 = XMVectorNegate(DotLanes(a[3][0], a[3][1], a[3][2], inverse00, inverse10, inverse20));
+		const XMVECTOR inverse31 = XMVectorNegate(DotLanes(a[3][0], a[3][1], a[3][2], inverse01, inverse11, inverse21));
+		const XMVECTOR inverse32 = XMVectorNegate(DotLanes(a[3][0], a[3][1], a[3][2], inverse02, inverse12, inverse22));
+
+		StoreLanes(inverse00, inverse01, inverse02, zero, &transforms->W_inverseTraspose, 0);
+		StoreLanes(inverse10, inverse11, inverse12, zero, &transforms->W_inverseTraspose, 1);
+		StoreLanes(inverse20, inverse21, inverse22, zero, &transforms->W_inverseTraspose, 2);
+		StoreLanes(inverse30, inverse31, inverse32, one, &transforms->W_inverseTraspose, 3);
+	}
+
+
+	void ComputeRange(const WorldTransforms& worlds, const MatrixLanes& viewProjection, uint32 first, uint32 count, ObjectTransforms* transforms)
+	{
+		const uint32 end = first + count;
+		const uint32 groupEnd = first + (count & ~3u);
+
+		XMVECTOR a[4][3];
+		for (uint32 index = first; index < groupEnd; index += 4)
+		{
+			for (uint32 element = 0; element < 12; element++)
+			{
+				a[element / 3][element % 3] = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(worlds.elements[element].data() + index));
+			}
+			ComputeLanes(a, viewProjection, transforms + index);
+		}
+
+		// the last objects fill the missing lanes with the identity, only their own matrices are copied out
+		if (groupEnd < end)
+		{
+			const uint32 laneCount = end - groupEnd;
+			for (uint32 element = 0; element < 12; element++)
+			{
+				XMFLOAT4 lanes(kIdentityElements[element], kIdentityElements[element], kIdentityElements[element], kIdentityElements[element]);
+				std::copy(worlds.elements[element].data() + groupEnd, worlds.elements[element].data() + end, &lanes.x);
+				a[element / 3][element % 3] = XMLoadFloat4(&lanes);
+			}
+
+			ObjectTransforms lastTransforms[4];
+			ComputeLanes(a, viewProjection, lastTransforms);
+			std::copy(lastTransforms, lastTransforms + laneCount, transforms + groupEnd);
+		}
+	}
+}
+
+
+uint32 WorldTransforms::Add(FXMMATRIX world)
+{
+	for (std::vector<float>& element : elements)
+	{
+		element.push_back(0.f);
+	}
+	Set(Count() - 1, world);
+	return Count() - 1;
+}
+
+
+void WorldTransforms::Set(uint32 index, FXMMATRIX world)
+{
+	XTEST_ASSERT(index < Count(), L"world matrix %u out of range", index);
+
+	XMFLOAT4X4 w;
+	XMStoreFloat4x4(&w, world);
+	XTEST_ASSERT(w._14 == 0.f && w._24 == 0.f && w._34 == 0.f && w._44 == 1.f, L"world matrix %u not affine", index);
+
+	for (uint32 element = 0; element < 12; element++)
+	{
+		elements[element][index] = w.m[element / 3][element % 3];
+	}
+}
+
+
+XMMATRIX WorldTransforms::Get(uint32 index) const
+{
+	XTEST_ASSERT(index < Count(), L"world matrix %u out of range", index);
+
+	XMFLOAT4X4 w;
+	XMStoreFloat4x4(&w, XMMatrixIdentity());
+	for (uint32 element = 0; element < 12; element++)
+	{
+		w.m[element / 3][element % 3] = elements[element][index];
+	}
+	return XMLoadFloat4x4(&w);
+}
+
+
+void WorldTransforms::Remove(uint32 index)
+{
+	XTEST_ASSERT(index < Count(), L"world matrix %u out of range", index);
+
+	for (std::vector<float>& element : elements)
+	{
+		element[index] = element.back();
+		element.pop_back();
+	}
+}
+
+
+uint32 WorldTransforms::Count() const
+{
+	return uint32(elements[0].size());
+}
+
+
+void WorldTransforms::Clear()
+{
+	for (std::vector<float>& element : elements)
+	{
+		element.clear();
+	}
+}
+
+
+void xtest::render::ComputeObjectTransforms(const WorldTransforms& worlds, FXMMATRIX viewProjection, ObjectTransforms* transforms, uint32 threadCount)
+{
+	XTEST_ASSERT(transforms || worlds.Count() == 0);
+
+	const MatrixLanes viewProjectionLanes(viewProjection);
+	const uint32 count = worlds.Count();
+	if (count < kMinParallelTransformCount)
+	{
+		ComputeRange(worlds, viewProjectionLanes, 0, count, transforms);
+		return;
+	}
+
+	// every block writes only the matrices of its own objects
+	const uint32 blockCount = (count + kTransformBlockSize - 1) / kTransformBlockSize;
+	xtest::common::ParallelFor(blockCount, threadCount, [&](uint32 block)
+	{
+		const uint32 first = block * kTransformBlockSize;
+		ComputeRange(worlds, viewProjectionLanes, first, std::min(kTransformBlockSize, count - first), transforms);
+	});
+}
+
@@ -0,0 +1,51 @@
+#pragma once
+
+
+namespace xtest {
+namespace render {
+
+	// fewer objects are transformed on the calling thread, starting threads would cost more than computing them
+	const uint32 kMinParallelTransformCount = 16 * 1024;
+
+
+	// the matrices of an object laid out like the shaders take them: the constant buffers are read by column, so W
+	// and WVP are stored transposed while the inverse of W is stored as it is to be read as its transpose
+	struct ObjectTransforms
+	{
+		DirectX::XMFLOAT4X4 W;
+		DirectX::XMFLOAT4X4 W_inverseTraspose;
+		DirectX::XMFLOAT4X4 WVP;
+	};
+
+
+	// affine world matrices, a separate array for every element of the first three columns so that 4 objects load at
+	// once; the last column is always (0, 0, 0, 1). The objects sharing a world matrix can share its entry too
+	struct WorldTransforms
+	{
+		std::array<std::vector<float>, 12> elements;	// _11, _12, _13, _21, _22, _23, _31, _32, _33, _41, _42, _43
+
+		// returns the index of the matrix
+		uint32 Add(DirectX::FXMMATRIX world);
+		void Set(uint32 index, DirectX::FXMMATRIX world);
+		DirectX::XMMATRIX Get(uint32 index) const;
+
+		// the last matrix takes the index of the removed one
+		void Remove(uint32 index);
+		uint32 Count() const;
+		void Clear();
+	};
+
+
+	/**
+	Computes W, WVP and the inverse of W of all the world matrices 4 at a time. The inverse is the one of an affine
+	matrix, the inverse of the 3x3 part by its cofactors and the translation moved back through it, which takes a
+	fraction of the operations of a general 4x4 inverse.
+	@param transforms	Receives the matrices of every world matrix at the same index, it must have room for all of them.
+	@param threadCount	The matrices are split in blocks over this many threads, 0 means one per hardware thread.
+						Fewer matrices than kMinParallelTransformCount are computed on the calling thread.
+	*/
+	void ComputeObjectTransforms(const WorldTransforms& worlds, DirectX::FXMMATRIX viewProjection, ObjectTransforms* transforms, uint32 threadCount = 0);
+
+} // render
+} // xtest
+
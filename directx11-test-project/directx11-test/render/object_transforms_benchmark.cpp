@@ -0,0 +1,68 @@
+#include "stdafx.h"
+#include "object_transforms_benchmark.h"
+#include <math/math_utils.h>
+#include <time/time_point.h>
+#include <cfloat>
+#include <random>
+
+
+using namespace DirectX;
+using xtest::render::ObjectTransforms;
+using xtest::render::ObjectTransformsBenchmarkResult;
+
+
+ObjectTransformsBenchmarkResult xtest::render::RunObjectTransformsBenchmark(uint32 objectCount, uint32 repeatCount)
+{
+	const XMMATRIX V = XMMatrixLookAtLH(XMVectorSet(0.f, 20.f, -60.f, 1.f), XMVectorZero(), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+	const XMMATRIX P = XMMatrixPerspectiveFovLH(math::ToRadians(45.f), 16.f / 9.f, 1.f, 1000.f);
+	const XMMATRIX viewProjection = XMMatrixMultiply(V, P);
+
+	// scaled from 0.5 to 5 units, rotated and scattered in a cube of 2000 units
+	std::mt19937 random(objectCount);
+	std::uniform_real_distribution<float> position(-1000.f, 1000.f);
+	std::uniform_real_distribution<float> scale(0.5f, 5.f);
+	std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+
+	WorldTransforms worlds;
+	std::vector<XMFLOAT4X4> worldMatrices(objectCount);
+	for (uint32 index = 0; index < objectCount; index++)
+	{
+		const XMMATRIX S = XMMatrixScaling(scale(random), scale(random), scale(random));
+		const XMMATRIX R = XMMatrixRotationRollPitchYaw(angle(random), angle(random), angle(random));
+		const XMMATRIX world = XMMatrixMultiply(XMMatrixMultiply(S, R), XMMatrixTranslation(position(random), position(random), position(random)));
+		worlds.Add(world);
+		XMStoreFloat4x4(&worldMatrices[index], world);
+	}
+
+	std::vector<ObjectTransforms> transforms(objectCount);
+	ObjectTransformsBenchmarkResult result;
+	result.objectCount = objectCount;
+	result.perObjectMillis = FLT_MAX;
+	result.batchMillis = FLT_MAX;
+	result.parallelBatchMillis = FLT_MAX;
+	for (uint32 repeat = 0; repeat < std::max(repeatCount, 1u); repeat++)
+	{
+		// what the demo did for every object before the batch
+		const time::TimePoint perObjectStart = time::TimePoint::Now();
+		for (uint32 index = 0; index < objectCount; index++)
+		{
+			const XMMATRIX W = XMLoadFloat4x4(&worldMatrices[index]);
+			XMStoreFloat4x4(&transforms[index].W, XMMatrixTranspose(W));
+			XMStoreFloat4x4(&transforms[index].WVP, XMMatrixTranspose(XMMatrixMultiply(W, viewProjection)));
+			XMStoreFloat4x4(&transforms[index].W_inverseTraspose, XMMatrixInverse(nullptr, W));
+		}
+
+		const time::TimePoint batchStart = time::TimePoint::Now();
+		ComputeObjectTransforms(worlds, viewProjection, transforms.data(), 1);
+
+		const time::TimePoint parallelBatchStart = time::TimePoint::Now();
+		ComputeObjectTransforms(worlds, viewProjection, transforms.data());
+
+		const time::TimePoint parallelBatchEnd = time::TimePoint::Now();
+		result.perObjectMillis = std::min(result.perObjectMillis, (batchStart - perObjectStart).Millis());
+		result.batchMillis = std::min(result.batchMillis, (parallelBatchStart - batchStart).Millis());
+		result.parallelBatchMillis = std::min(result.parallelBatchMillis, (parallelBatchEnd - parallelBatchStart).Millis());
+	}
+
+	return result;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <render/object_transforms.h>
+
+
+namespace xtest {
+namespace render {
+
+	// the best times of the per object path ComputeObjectTransforms replaced, of the batch on the calling thread and
+	// of the batch spread over all the hardware threads
+	struct ObjectTransformsBenchmarkResult
+	{
+		uint32 objectCount = 0;
+		float perObjectMillis = 0.f;	// XMMatrixMultiply, XMMatrixInverse and XMMatrixTranspose one object at a time
+		float batchMillis = 0.f;
+		float parallelBatchMillis = 0.f;
+	};
+
+
+	/**
+	Computes W, WVP and the inverse of W of random scaled, rotated and translated world matrices with both paths.
+	The matrices come from a fixed seed, every count gets the same ones at every run.
+	@param repeatCount	The matrices are computed this many times, the best time is kept.
+	*/
+	ObjectTransformsBenchmarkResult RunObjectTransformsBenchmark(uint32 objectCount, uint32 repeatCount = 10);
+
+} // render
+} // xtest
@@ -0,0 +1,295 @@
+#include "stdafx.h"
+#include "occlusion_buffer.h"
+
+
+using namespace DirectX;
+using xtest::mesh::MeshBounds;
+using xtest::mesh::MeshData;
+using xtest::render::OcclusionBuffer;
+
+
+namespace
+{
+	// the coefficients of a function of the screen position, f = x * dx + y * dy + offset
+	struct ScreenPlane
+	{
+		float dx;
+		float dy;
+		float offset;
+	};
+
+
+	// positive on the inner side of the edge from a to b, when the triangle is clockwise on screen
+	ScreenPlane EdgeFunction(const XMFLOAT3& a, const XMFLOAT3& b)
+	{
+		return { a.y - b.y, b.x - a.x, (b.y - a.y) * a.x - (b.x - a.x) * a.y };
+	}
+
+
+	// the depth over the plane of the triangle, area is twice its signed screen area
+	ScreenPlane DepthFunction(const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c, float area)
+	{
+		const float dx = ((b.z - a.z) * (c.y - a.y) - (c.z - a.z) * (b.y - a.y)) / area;
+		const float dy = ((c.z - a.z) * (b.x - a.x) - (b.z - a.z) * (c.x - a.x)) / area;
+		return { dx, dy, a.z - dx * a.x - dy * a.y };
+	}
+
+
+	// the 4 values of the function along a row starting at the pixel centers px
+	XMVECTOR EvaluateRow(const ScreenPlane& plane, FXMVECTOR px, float py)
+	{
+		return XMVectorMultiplyAdd(XMVectorReplicate(plane.dx), px, XMVectorReplicate(plane.dy * py + plane.offset));
+	}
+}
+
+
+OcclusionBuffer::OcclusionBuffer(uint32 width, uint32 height)
+	: m_width(width)
+	, m_height(height)
+	, m_tileColumnCount(width / kTileWidth)
+	, m_depth(size_t(width) * height, 1.f)
+	, m_tileDepth(size_t(width / kTileWidth) * (height / kTileHeight), 1.f)
+	, m_clipPositions()
+	, m_isHierarchyCurrent(true)
+{
+	XTEST_ASSERT(width > 0 && height > 0 && width % kTileWidth == 0 && height % kTileHeight == 0,
+		L"an occlusion buffer of %u x %u pixels is not made of %u x %u tiles", width, height, kTileWidth, kTileHeight);
+}
+
+
+void OcclusionBuffer::Clear()
+{
+	std::fill(m_depth.begin(), m_depth.end(), 1.f);
+	std::fill(m_tileDepth.begin(), m_tileDepth.end(), 1.f);
+	m_isHierarchyCurrent = true;
+}
+
+
+uint32 OcclusionBuffer::RenderOccluder(const MeshData::Vertex* vertices, uint32 vertexCount, const uint32* indices, size_t indexCount, FXMMATRIX worldViewProjection)
+{
+	m_clipPositions.resize(vertexCount);
+	for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+	{
+		XMStoreFloat4(&m_clipPositions[vertexIndex], XMVector3Transform(XMLoadFloat3(&vertices[vertexIndex].position), worldViewProjection));
+	}
+
+	const float halfWidth = 0.5f * m_width;
+	const float halfHeight = 0.5f * m_height;
+	uint32 renderedTriangleCount = 0;
+	for (size_t index = 0; index + 2 < indexCount; index += 3)
+	{
+		XMFLOAT3 screenPositions[3];
+		bool isInFrontOfNearPlane = false;
+		for (uint32 corner = 0; corner < 3; corner++)
+		{
+			const XMFLOAT4& clip = m_clipPositions[indices[index + corner]];
+
+			// without clipping the triangle would be projected through the camera, dropping it is conservative
+			if (clip.z < 0.f)
+			{
+				isInFrontOfNearPlane = true;
+				break;
+			}
+
+			const float inverseW = 1.f / clip.w;
+			screenPositions[corner] = { (clip.x * inverseW + 1.f) * halfWidth, (1.f - clip.y * inverseW) * halfHeight, clip.z * inverseW };
+		}
+
+		if (!isInFrontOfNearPlane && RasterizeTriangle(screenPositions[0], screenPositions[1], screenPositions[2]))
+		{
+			renderedTriangleCount++;
+		}
+	}
+
+	m_isHierarchyCurrent = m_isHierarchyCurrent && renderedTriangleCount == 0;
+	return renderedTriangleCount;
+}
+
+
+bool OcclusionBuffer::RasterizeTriangle(const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c)
+{
+	// clockwise on screen, where y grows downwards, is a positive area; the comparison drops nans as well
+	const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	if (!(area > 0.f))
+	{
+		return false;
+	}
+
+	// the pixels whose center may be inside, clamped as floats since far vertices project far off screen
+	const float left = std::max(std::ceil(std::min({ a.x, b.x, c.x }) - 0.5f), 0.f);
+	const float right = std::min(std::floor(std::max({ a.x, b.x, c.x }) - 0.5f), float(m_width - 1));
+	const float top = std::max(std::ceil(std::min({ a.y, b.y, c.y }) - 0.5f), 0.f);
+	const float bottom = std::min(std::floor(std::max({ a.y, b.y, c.y }) - 0.5f), float(m_height - 1));
+	if (!(left <= right && top <= bottom))
+	{
+		return false;
+	}
+
+	// rows start at a multiple of 4 pixels so that the groups never cross the end of a row
+	const uint32 minX = uint32(left) & ~3u;
+	const uint32 maxX = uint32(right);
+	const uint32 minY = uint32(top);
+	const uint32 maxY = uint32(bottom);
+
+	const ScreenPlane edges[3] = { EdgeFunction(a, b), EdgeFunction(b, c), EdgeFunction(c, a) };
+	const ScreenPlane depth = DepthFunction(a, b, c, area);
+	const XMVECTOR laneOffsets = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+	const XMVECTOR groupStep = XMVectorReplicate(4.f);
+	const XMVECTOR zero = XMVectorZero();
+
+	for (uint32 y = minY; y <= maxY; y++)
+	{
+		const float py = float(y) + 0.5f;
+		float* row = &m_depth[size_t(y) * m_width];
+
+		XMVECTOR px = XMVectorAdd(XMVectorReplicate(float(minX)), laneOffsets);
+		for (uint32 x = minX; x <= maxX; x += 4)
+		{
+			// the pixel centers on the edges are inside, covering them twice doesn't matter for depth
+			XMVECTOR inside = XMVectorGreaterOrEqual(EvaluateRow(edges[0], px, py), zero);
+			inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(EvaluateRow(edges[1], px, py), zero));
+			inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(EvaluateRow(edges[2], px, py), zero));
+
+			if (!XMVector4EqualInt(inside, XMVectorFalseInt()))
+			{
+				XMFLOAT4* pixels = reinterpret_cast<XMFLOAT4*>(row + x);
+				const XMVECTOR stored = XMLoadFloat4(pixels);
+				XMStoreFloat4(pixels, XMVectorSelect(stored, XMVectorMin(stored, EvaluateRow(depth, px, py)), inside));
+			}
+
+			px = XMVectorAdd(px, groupStep);
+		}
+	}
+
+	return true;
+}
+
+
+void OcclusionBuffer::BuildHierarchy()
+{
+	const uint32 tileRowCount = m_height / kTileHeight;
+	for (uint32 tileRow = 0; tileRow < tileRowCount; tileRow++)
+	{
+		for (uint32 tileColumn = 0; tileColumn < m_tileColumnCount; tileColumn++)
+		{
+			XMVECTOR farthest = XMVectorZero();
+			for (uint32 y = tileRow * kTileHeight; y < (tileRow + 1) * kTileHeight; y++)
+			{
+				const float* row = &m_depth[size_t(y) * m_width + tileColumn * kTileWidth];
+				for (uint32 x = 0; x < kTileWidth; x += 4)
+				{
+					farthest = XMVectorMax(farthest, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(row + x)));
+				}
+			}
+
+			XMFLOAT4 lanes;
+			XMStoreFloat4(&lanes, farthest);
+			m_tileDepth[tileRow * m_tileColumnCount + tileColumn] = std::max(std::max(lanes.x, lanes.y), std::max(lanes.z, lanes.w));
+		}
+	}
+
+	m_isHierarchyCurrent = true;
+}
+
+
+bool OcclusionBuffer::IsOccluded(const MeshBounds& bounds, FXMMATRIX worldViewProjection) const
+{
+	XTEST_ASSERT(m_isHierarchyCurrent, L"occluders were rendered after the last BuildHierarchy");
+
+	// the screen rectangle and the nearest depth of the corners of the box
+	float minX = std::numeric_limits<float>::max();
+	float minY = std::numeric_limits<float>::max();
+	float maxX = -std::numeric_limits<float>::max();
+	float maxY = -std::numeric_limits<float>::max();
+	float nearestDepth = std::numeric_limits<float>::max();
+	for (uint32 corner = 0; corner < 8; corner++)
+	{
+		const XMVECTOR position = XMVectorSet(
+			corner & 1 ? bounds.boxMax.x : bounds.boxMin.x,
+			corner & 2 ? bounds.boxMax.y : bounds.boxMin.y,
+			corner & 4 ? bounds.boxMax.z : bounds.boxMin.z,
+			1.f);
+
+		XMFLOAT4 clip;
+		XMStoreFloat4(&clip, XMVector3Transform(position, worldViewProjection));
+
+		// a box crossing the near plane may cover any pixel
+		if (clip.z < 0.f)
+		{
+			return false;
+		}
+
+		const float inverseW = 1.f / clip.w;
+		const float x = (clip.x * inverseW + 1.f) * 0.5f * m_width;
+		const float y = (1.f - clip.y * inverseW) * 0.5f * m_height;
+		minX = std::min(minX, x);
+		minY = std::min(minY, y);
+		maxX = std::max(maxX, x);
+		maxY = std::max(maxY, y);
+		nearestDepth = std::min(nearestDepth, clip.z * inverseW);
+	}
+
+	// every pixel the rectangle touches, not only the ones whose center is inside it
+	const float left = std::max(std::floor(minX), 0.f);
+	const float right = std::min(std::floor(maxX), float(m_width - 1));
+	const float top = std::max(std::floor(minY), 0.f);
+	const float bottom = std::min(std::floor(maxY), float(m_height - 1));
+	if (!(left <= right && top <= bottom))
+	{
+		// off screen, that's for the frustum culling to say
+		return false;
+	}
+
+	return IsRectOccluded(uint32(left), uint32(top), uint32(right), uint32(bottom), nearestDepth);
+}
+
+
+bool OcclusionBuffer::IsRectOccluded(uint32 minX, uint32 minY, uint32 maxX, uint32 maxY, float depth) const
+{
+	for (uint32 tileRow = minY / kTileHeight; tileRow <= maxY / kTileHeight; tileRow++)
+	{
+		for (uint32 tileColumn = minX / kTileWidth; tileColumn <= maxX / kTileWidth; tileColumn++)
+		{
+			// all the tile is in front of the depth
+			if (m_tileDepth[tileRow * m_tileColumnCount + tileColumn] < depth)
+			{
+				continue;
+			}
+
+			const uint32 tileMinX = std::max(minX, tileColumn * kTileWidth);
+			const uint32 tileMaxX = std::min(maxX, tileColumn * kTileWidth + kTileWidth - 1);
+			const uint32 tileMinY = std::max(minY, tileRow * kTileHeight);
+			const uint32 tileMaxY = std::min(maxY, tileRow * kTileHeight + kTileHeight - 1);
+			for (uint32 y = tileMinY; y <= tileMaxY; y++)
+			{
+				const float* row = &m_depth[size_t(y) * m_width];
+				for (uint32 x = tileMinX; x <= tileMaxX; x++)
+				{
+					if (row[x] >= depth)
+					{
+						return false;
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+
+uint32 OcclusionBuffer::Width() const
+{
+	return m_width;
+}
+
+
+uint32 OcclusionBuffer::Height() const
+{
+	return m_height;
+}
+
+
+float OcclusionBuffer::DepthAt(uint32 x, uint32 y) const
+{
+	return m_depth[size_t(y) * m_width + x];
+}
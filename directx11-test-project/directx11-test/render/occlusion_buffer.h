@@ -0,0 +1,70 @@
+#pragma once
+
+#include <mesh/mesh_format.h>
+
+
+namespace xtest {
+namespace render {
+
+	/**
+	A low resolution depth buffer filled on the cpu with the triangles of a few large occluders, used to find the
+	objects hidden behind them before drawing anything. Rows are rasterized 4 pixels at a time, and the depth
+	is kept with the same convention as the gpu: 0 at the near plane, 1 at the far one.
+	Above the pixels every tile keeps its largest depth: an object entirely behind the depth of a tile is
+	hidden in all of it, so the pixels are looked at only in the tiles where the occluders leave gaps.
+	Everything is conservative: triangles crossing the near plane are not rasterized and objects crossing it
+	are never occluded, so the buffer can only miss occlusion, never hide a visible object.
+	*/
+	class OcclusionBuffer
+	{
+	public:
+
+		static const uint32 kTileWidth = 8;
+		static const uint32 kTileHeight = 8;
+
+		// the size must be a multiple of the tile size
+		OcclusionBuffer(uint32 width, uint32 height);
+
+		OcclusionBuffer(OcclusionBuffer&&) = default;
+		OcclusionBuffer(const OcclusionBuffer&) = delete;
+		OcclusionBuffer& operator=(OcclusionBuffer&&) = default;
+		OcclusionBuffer& operator=(const OcclusionBuffer&) = delete;
+
+
+		// every pixel back to the far plane
+		void Clear();
+
+		/**
+		Rasterizes the front faces of an occluder, clockwise like in the rasterizer state of the demos. Only closed
+		meshes or surfaces that can't be seen from behind should be occluders.
+		@return the number of triangles that covered the buffer.
+		*/
+		uint32 RenderOccluder(const mesh::MeshData::Vertex* vertices, uint32 vertexCount, const uint32* indices, size_t indexCount, DirectX::FXMMATRIX worldViewProjection);
+
+		// updates the depth of the tiles, call it after the last occluder and before the tests
+		void BuildHierarchy();
+
+		// true when the whole bounding box is behind the occluders rendered so far
+		bool IsOccluded(const mesh::MeshBounds& bounds, DirectX::FXMMATRIX worldViewProjection) const;
+
+		uint32 Width() const;
+		uint32 Height() const;
+		float DepthAt(uint32 x, uint32 y) const;
+
+	private:
+
+		bool RasterizeTriangle(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b, const DirectX::XMFLOAT3& c);
+		bool IsRectOccluded(uint32 minX, uint32 minY, uint32 maxX, uint32 maxY, float depth) const;
+
+		uint32 m_width;
+		uint32 m_height;
+		uint32 m_tileColumnCount;
+		std::vector<float> m_depth;
+		std::vector<float> m_tileDepth;
+		std::vector<DirectX::XMFLOAT4> m_clipPositions;
+		bool m_isHierarchyCurrent;
+	};
+
+} // render
+} // xtest
+
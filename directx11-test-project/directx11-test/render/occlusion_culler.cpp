@@ -0,0 +1,175 @@
+#include "stdafx.h"
+#include "occlusion_culler.h"
+#include <time/time_point.h>
+
+
+using namespace DirectX;
+using xtest::mesh::MeshBounds;
+using xtest::mesh::MeshData;
+using xtest::render::OcclusionBuffer;
+using xtest::render::OcclusionCuller;
+using xtest::render::OcclusionStatistics;
+using xtest::time::TimePoint;
+
+
+OcclusionCuller::OcclusionCuller(uint32 width, uint32 height)
+	: m_buffer(width, height)
+	, m_occluders()
+	, m_occludees()
+	, m_visibility()
+	, m_viewProjection()
+	, m_statistics()
+	, m_mutex()
+	, m_condition()
+	, m_isFrameStarted(false)
+	, m_isFrameDone(false)
+	, m_isQuitting(false)
+	, m_worker(&OcclusionCuller::RunWorker, this)
+{}
+
+
+OcclusionCuller::~OcclusionCuller()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isQuitting = true;
+	}
+	m_condition.notify_all();
+	m_worker.join();
+}
+
+
+void OcclusionCuller::AddOccluder(const MeshData::Vertex* vertices, uint32 vertexCount, const uint32* indices, size_t indexCount, FXMMATRIX world)
+{
+	XTEST_ASSERT(!m_isFrameStarted, L"occluders can't be added while the worker culls a frame");
+
+	Occluder occluder = { vertices, vertexCount, indices, indexCount };
+	XMStoreFloat4x4(&occluder.world, world);
+	m_occluders.push_back(occluder);
+}
+
+
+void OcclusionCuller::AddOccluder(const MeshData& meshData, FXMMATRIX world)
+{
+	AddOccluder(meshData.vertices.data(), uint32(meshData.vertices.size()), meshData.indices.data(), meshData.indices.size(), world);
+}
+
+
+uint32 OcclusionCuller::AddOccludee(const MeshBounds& bounds, FXMMATRIX world)
+{
+	XTEST_ASSERT(!m_isFrameStarted, L"objects can't be added while the worker culls a frame");
+
+	Occludee occludee;
+	occludee.bounds = bounds;
+	XMStoreFloat4x4(&occludee.world, world);
+	m_occludees.push_back(occludee);
+	return uint32(m_occludees.size() - 1);
+}
+
+
+void OcclusionCuller::Start(FXMMATRIX viewProjection)
+{
+	XTEST_ASSERT(!m_isFrameStarted, L"the previous frame was not waited for");
+
+	XMStoreFloat4x4(&m_viewProjection, viewProjection);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isFrameStarted = true;
+		m_isFrameDone = false;
+	}
+	m_condition.notify_all();
+}
+
+
+void OcclusionCuller::Wait()
+{
+	if (!m_isFrameStarted)
+	{
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait(lock, [this]() { return m_isFrameDone; });
+		m_isFrameStarted = false;
+	}
+
+	m_occluders.clear();
+	m_occludees.clear();
+}
+
+
+bool OcclusionCuller::IsVisible(uint32 occludee) const
+{
+	XTEST_ASSERT(!m_isFrameStarted, L"the visibility is known only after Wait");
+	return m_visibility[occludee];
+}
+
+
+const OcclusionStatistics& OcclusionCuller::Statistics() const
+{
+	XTEST_ASSERT(!m_isFrameStarted, L"the statistics are known only after Wait");
+	return m_statistics;
+}
+
+
+const OcclusionBuffer& OcclusionCuller::Buffer() const
+{
+	XTEST_ASSERT(!m_isFrameStarted, L"the buffer is in use by the worker");
+	return m_buffer;
+}
+
+
+void OcclusionCuller::RunWorker()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		m_condition.wait(lock, [this]() { return m_isQuitting || (m_isFrameStarted && !m_isFrameDone); });
+		if (m_isQuitting)
+		{
+			return;
+		}
+
+		// the calling thread doesn't touch the frame until m_isFrameDone
+		lock.unlock();
+		CullFrame();
+		lock.lock();
+
+		m_isFrameDone = true;
+		m_condition.notify_all();
+	}
+}
+
+
+void OcclusionCuller::CullFrame()
+{
+	const XMMATRIX viewProjection = XMLoadFloat4x4(&m_viewProjection);
+	OcclusionStatistics statistics;
+
+	const TimePoint startTime = TimePoint::Now();
+	m_buffer.Clear();
+	for (const Occluder& occluder : m_occluders)
+	{
+		const XMMATRIX worldViewProjection = XMMatrixMultiply(XMLoadFloat4x4(&occluder.world), viewProjection);
+		statistics.renderedTriangleCount += m_buffer.RenderOccluder(occluder.vertices, occluder.vertexCount, occluder.indices, occluder.indexCount, worldViewProjection);
+	}
+	m_buffer.BuildHierarchy();
+	statistics.occluderCount = uint32(m_occluders.size());
+
+	const TimePoint rasterizeEndTime = TimePoint::Now();
+	m_visibility.resize(m_occludees.size());
+	for (size_t occludeeIndex = 0; occludeeIndex < m_occludees.size(); occludeeIndex++)
+	{
+		const Occludee& occludee = m_occludees[occludeeIndex];
+		const XMMATRIX worldViewProjection = XMMatrixMultiply(XMLoadFloat4x4(&occludee.world), viewProjection);
+		m_visibility[occludeeIndex] = !m_buffer.IsOccluded(occludee.bounds, worldViewProjection);
+		statistics.visibleCount += m_visibility[occludeeIndex] ? 1 : 0;
+	}
+	statistics.testedCount = uint32(m_occludees.size());
+	statistics.culledCount = statistics.testedCount - statistics.visibleCount;
+
+	statistics.rasterizeTime = rasterizeEndTime - startTime;
+	statistics.testTime = TimePoint::Now() - rasterizeEndTime;
+	m_statistics = statistics;
+}
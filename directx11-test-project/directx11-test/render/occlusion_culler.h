@@ -0,0 +1,96 @@
+#pragma once
+
+#include <render/occlusion_buffer.h>
+#include <time/time_span.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+namespace xtest {
+namespace render {
+
+	// what the occlusion culling did in a frame
+	struct OcclusionStatistics
+	{
+		uint32 occluderCount = 0;
+		uint32 renderedTriangleCount = 0;	// occluder triangles that covered the buffer
+		uint32 testedCount = 0;
+		uint32 culledCount = 0;
+		uint32 visibleCount = 0;
+		time::TimeSpan rasterizeTime;
+		time::TimeSpan testTime;
+	};
+
+
+	/**
+	Runs an OcclusionBuffer on its own worker thread a frame at a time. The occluders and the objects to test are
+	added on the calling thread, Start hands them to the worker and Wait returns once the visibility of every
+	object is known, so the culling overlaps whatever the calling thread does in between.
+	The inputs are cleared by Wait, the results stay valid until the next Start.
+	*/
+	class OcclusionCuller
+	{
+	public:
+
+		OcclusionCuller(uint32 width, uint32 height);
+		~OcclusionCuller();
+
+		OcclusionCuller(OcclusionCuller&&) = delete;
+		OcclusionCuller(const OcclusionCuller&) = delete;
+		OcclusionCuller& operator=(OcclusionCuller&&) = delete;
+		OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+
+		// the vertices and indices are referenced, not copied: they must stay alive until Wait returns
+		void AddOccluder(const mesh::MeshData::Vertex* vertices, uint32 vertexCount, const uint32* indices, size_t indexCount, DirectX::FXMMATRIX world);
+		void AddOccluder(const mesh::MeshData& meshData, DirectX::FXMMATRIX world);
+
+		// returns the index to ask the visibility of the object with
+		uint32 AddOccludee(const mesh::MeshBounds& bounds, DirectX::FXMMATRIX world);
+
+		void Start(DirectX::FXMMATRIX viewProjection);
+		void Wait();
+
+		bool IsVisible(uint32 occludee) const;
+		const OcclusionStatistics& Statistics() const;
+		const OcclusionBuffer& Buffer() const;
+
+	private:
+
+		struct Occluder
+		{
+			const mesh::MeshData::Vertex* vertices;
+			uint32 vertexCount;
+			const uint32* indices;
+			size_t indexCount;
+			DirectX::XMFLOAT4X4 world;
+		};
+
+		struct Occludee
+		{
+			mesh::MeshBounds bounds;
+			DirectX::XMFLOAT4X4 world;
+		};
+
+		void RunWorker();
+		void CullFrame();
+
+		OcclusionBuffer m_buffer;
+		std::vector<Occluder> m_occluders;
+		std::vector<Occludee> m_occludees;
+		std::vector<bool> m_visibility;
+		DirectX::XMFLOAT4X4 m_viewProjection;
+		OcclusionStatistics m_statistics;
+
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_isFrameStarted;	// written by the calling thread only
+		bool m_isFrameDone;
+		bool m_isQuitting;
+		std::thread m_worker;
+	};
+
+} // render
+} // xtest
+
@@ -0,0 +1,114 @@
+#include "stdafx.h"
+#include "recording_backend.h"
+
+
+using xtest::render::ConstantBufferBinding;
+using xtest::render::RecordedCommand;
+using xtest::render::RecordingBackend;
+using xtest::render::ResourceHandle;
+using xtest::render::ShaderStage;
+
+
+bool RecordedCommand::operator==(const RecordedCommand& rhs) const
+{
+	return type == rhs.type && stage == rhs.stage && slot == rhs.slot && resource == rhs.resource
+		&& std::equal(std::begin(arguments), std::end(arguments), std::begin(rhs.arguments));
+}
+
+
+bool RecordedCommand::operator!=(const RecordedCommand& rhs) const
+{
+	return !(*this == rhs);
+}
+
+
+RecordingBackend::RecordingBackend(bool keepCommands)
+	: m_commands()
+	, m_commandCounts()
+	, m_submittedIndexCount(0)
+	, m_keepCommands(keepCommands)
+{}
+
+
+void RecordingBackend::SetPipeline(ResourceHandle pipeline)
+{
+	Record({ RecordedCommand::Type::set_pipeline, ShaderStage::vertex, 0, pipeline, { 0, 0, 0 } });
+}
+
+
+void RecordingBackend::SetVertexBuffer(ResourceHandle buffer, uint32 stride)
+{
+	Record({ RecordedCommand::Type::set_vertex_buffer, ShaderStage::vertex, 0, buffer, { stride, 0, 0 } });
+}
+
+
+void RecordingBackend::SetIndexBuffer(ResourceHandle buffer)
+{
+	Record({ RecordedCommand::Type::set_index_buffer, ShaderStage::vertex, 0, buffer, { 0, 0, 0 } });
+}
+
+
+void RecordingBackend::SetConstantBuffer(ShaderStage stage, uint32 slot, const ConstantBufferBinding& binding)
+{
+	Record({ RecordedCommand::Type::set_constant_buffer, stage, slot, binding.buffer, { binding.offset, binding.size, 0 } });
+}
+
+
+void RecordingBackend::SetTexture(uint32 slot, ResourceHandle texture)
+{
+	Record({ RecordedCommand::Type::set_texture, ShaderStage::pixel, slot, texture, { 0, 0, 0 } });
+}
+
+
+void RecordingBackend::DrawIndexed(uint32 indexCount, uint32 startIndex, int32 baseVertex)
+{
+	Record({ RecordedCommand::Type::draw_indexed, ShaderStage::vertex, 0, kNullResource, { indexCount, startIndex, uint32(baseVertex) } });
+	m_submittedIndexCount += indexCount;
+}
+
+
+void RecordingBackend::Reset()
+{
+	m_commands.clear();
+	m_commandCounts.fill(0);
+	m_submittedIndexCount = 0;
+}
+
+
+const std::vector<RecordedCommand>& RecordingBackend::Commands() const
+{
+	return m_commands;
+}
+
+
+uint32 RecordingBackend::CommandCount(RecordedCommand::Type type) const
+{
+	return m_commandCounts[size_t(type)];
+}
+
+
+uint32 RecordingBackend::CommandCount() const
+{
+	uint32 commandCount = 0;
+	for (uint32 count : m_commandCounts)
+	{
+		commandCount += count;
+	}
+	return commandCount;
+}
+
+
+uint64 RecordingBackend::SubmittedIndexCount() const
+{
+	return m_submittedIndexCount;
+}
+
+
+void RecordingBackend::Record(const RecordedCommand& command)
+{
+	m_commandCounts[size_t(command.type)]++;
+	if (m_keepCommands)
+	{
+		m_commands.push_back(command);
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <render/render_backend.h>
+
+
+namespace xtest {
+namespace render {
+
+	struct RecordedCommand
+	{
+		enum class Type : uint32
+		{
+			set_pipeline,
+			set_vertex_buffer,
+			set_index_buffer,
+			set_constant_buffer,
+			set_texture,
+			draw_indexed,
+			count
+		};
+
+		Type type;
+		ShaderStage stage;		// set_constant_buffer only
+		uint32 slot;			// set_constant_buffer and set_texture
+		ResourceHandle resource;
+		uint32 arguments[3];	// the stride of set_vertex_buffer, offset and size of set_constant_buffer, index count,
+								// start index and base vertex of draw_indexed
+
+		bool operator==(const RecordedCommand& rhs) const;
+		bool operator!=(const RecordedCommand& rhs) const;
+	};
+
+
+	/**
+	A backend without a gpu: it counts the calls it gets and keeps them in order, so that draw streams can be
+	compared against known ones and the submission code can be profiled on its own. Without keeping the commands
+	it is a null backend, only the counters change.
+	*/
+	class RecordingBackend : public RenderBackend
+	{
+	public:
+
+		explicit RecordingBackend(bool keepCommands = true);
+
+		virtual void SetPipeline(ResourceHandle pipeline) override;
+		virtual void SetVertexBuffer(ResourceHandle buffer, uint32 stride) override;
+		virtual void SetIndexBuffer(ResourceHandle buffer) override;
+		virtual void SetConstantBuffer(ShaderStage stage, uint32 slot, const ConstantBufferBinding& binding) override;
+		virtual void SetTexture(uint32 slot, ResourceHandle texture) override;
+		virtual void DrawIndexed(uint32 indexCount, uint32 startIndex, int32 baseVertex) override;
+
+		// forgets the commands and zeroes the counters, e.g. at the start of every frame
+		void Reset();
+
+		const std::vector<RecordedCommand>& Commands() const;
+		uint32 CommandCount(RecordedCommand::Type type) const;
+		uint32 CommandCount() const;
+		uint64 SubmittedIndexCount() const;
+
+	private:
+
+		void Record(const RecordedCommand& command);
+
+		std::vector<RecordedCommand> m_commands;
+		std::array<uint32, size_t(RecordedCommand::Type::count)> m_commandCounts;
+		uint64 m_submittedIndexCount;
+		bool m_keepCommands;
+	};
+
+} // render
+} // xtest
+
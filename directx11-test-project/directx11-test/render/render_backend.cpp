@@ -0,0 +1,18 @@
+#include "stdafx.h"
+#include "render_backend.h"
+
+
+using xtest::render::ConstantBufferBinding;
+
+
+bool ConstantBufferBinding::operator==(const ConstantBufferBinding& rhs) const
+{
+	return buffer == rhs.buffer && offset == rhs.offset && size == rhs.size;
+}
+
+
+bool ConstantBufferBinding::operator!=(const ConstantBufferBinding& rhs) const
+{
+	return !(*this == rhs);
+}
+
@@ -0,0 +1,64 @@
+#pragma once
+
+
+namespace xtest {
+namespace render {
+
+	// a resource of the backend: a buffer, a texture or a pipeline, what the value stands for is up to the backend
+	typedef uint32 ResourceHandle;
+
+	// in a draw packet, a slot with no resource keeps whatever was bound to it before
+	const ResourceHandle kNullResource = 0;
+
+	const uint32 kConstantBufferSlotCount = 4;
+	const uint32 kConstantBufferAlignment = 256;	// 16 constants of 16 bytes, the granularity of the offsets d3d11.1 binds
+	const uint32 kTextureSlotCount = 4;
+
+
+	// a whole constant buffer or a range of one, in bytes: with a size of 0 the whole buffer is bound, a range
+	// starts at a multiple of kConstantBufferAlignment
+	struct ConstantBufferBinding
+	{
+		ResourceHandle buffer = kNullResource;
+		uint32 offset = 0;
+		uint32 size = 0;
+
+		bool operator==(const ConstantBufferBinding& rhs) const;
+		bool operator!=(const ConstantBufferBinding& rhs) const;
+	};
+
+
+	enum class ShaderStage : uint32
+	{
+		vertex,
+		pixel
+	};
+
+
+	/**
+	What the draw submission needs from a graphics api, so that the same command lists can go to d3d11 or to a
+	headless backend that records them. The calls map one to one to the api calls the backend makes, the
+	backend doesn't skip redundant ones.
+	*/
+	class RenderBackend
+	{
+	public:
+
+		virtual ~RenderBackend() = default;
+
+		// shaders, input layout, rasterizer state, sampler and primitive topology all at once
+		virtual void SetPipeline(ResourceHandle pipeline) = 0;
+
+		virtual void SetVertexBuffer(ResourceHandle buffer, uint32 stride) = 0;
+		virtual void SetIndexBuffer(ResourceHandle buffer) = 0;
+		virtual void SetConstantBuffer(ShaderStage stage, uint32 slot, const ConstantBufferBinding& binding) = 0;
+
+		// the textures are read by the pixel shader only
+		virtual void SetTexture(uint32 slot, ResourceHandle texture) = 0;
+
+		virtual void DrawIndexed(uint32 indexCount, uint32 startIndex, int32 baseVertex) = 0;
+	};
+
+} // render
+} // xtest
+
@@ -0,0 +1,396 @@
+#include "stdafx.h"
+#include "scene.h"
+
+
+using namespace DirectX;
+using xtest::scene::HandleSlots;
+using xtest::scene::ObjectDesc;
+using xtest::scene::ObjectHandle;
+using xtest::scene::Scene;
+using xtest::scene::TransformHandle;
+
+
+namespace
+{
+	// the last value takes the place of the removed one, like the objects and the transforms of the scene
+	template<typename Value>
+	void RemoveValue(uint32 index, std::vector<Value>* values)
+	{
+		(*values)[index] = values->back();
+		values->pop_back();
+	}
+}
+
+
+bool ObjectHandle::operator==(const ObjectHandle& rhs) const
+{
+	return slot == rhs.slot && generation == rhs.generation;
+}
+
+
+bool ObjectHandle::operator!=(const ObjectHandle& rhs) const
+{
+	return !(*this == rhs);
+}
+
+
+bool TransformHandle::operator==(const TransformHandle& rhs) const
+{
+	return slot == rhs.slot && generation == rhs.generation;
+}
+
+
+bool TransformHandle::operator!=(const TransformHandle& rhs) const
+{
+	return !(*this == rhs);
+}
+
+
+HandleSlots::HandleSlots()
+	: m_indices()
+	, m_generations()
+	, m_freeSlots()
+{}
+
+
+void HandleSlots::Allocate(uint32 index, uint32* slot, uint32* generation)
+{
+	XTEST_ASSERT(slot && generation);
+
+	if (m_freeSlots.empty())
+	{
+		*slot = uint32(m_indices.size());
+		m_indices.push_back(0);
+		m_generations.push_back(0);
+	}
+	else
+	{
+		*slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	*generation = m_generations[*slot];
+	m_indices[*slot] = index;
+}
+
+
+void HandleSlots::Free(uint32 slot)
+{
+	m_generations[slot]++;
+	m_freeSlots.push_back(slot);
+}
+
+
+bool HandleSlots::Contains(uint32 slot, uint32 generation) const
+{
+	return slot < m_generations.size() && m_generations[slot] == generation;
+}
+
+
+uint32 HandleSlots::IndexOf(uint32 slot) const
+{
+	return m_indices[slot];
+}
+
+
+void HandleSlots::SetIndex(uint32 slot, uint32 index)
+{
+	m_indices[slot] = index;
+}
+
+
+Scene::Scene()
+	: m_transformHandles()
+	, m_worlds()
+	, m_transformUseCounts()
+	, m_isWorldChanged()
+	, m_isAnyWorldChanged(false)
+	, m_transformSlots()
+	, m_handles()
+	, m_transformIndices()
+	, m_bounds()
+	, m_spheres()
+	, m_meshes()
+	, m_materials()
+	, m_lodLevels()
+	, m_constantBuffers()
+	, m_objectSlots()
+	, m_transforms()
+	, m_visibleIndices()
+	, m_visibleCount(0)
+{}
+
+
+TransformHandle Scene::AddTransform(FXMMATRIX world)
+{
+	TransformHandle handle;
+	m_transformSlots.Allocate(TransformCount(), &handle.slot, &handle.generation);
+
+	m_transformHandles.push_back(handle);
+	m_worlds.Add(world);
+	m_transformUseCounts.push_back(0);
+	m_isWorldChanged.push_back(0);
+	return handle;
+}
+
+
+void Scene::RemoveTransform(TransformHandle handle)
+{
+	XTEST_ASSERT(Contains(handle), L"unknown transform in slot %u", handle.slot);
+
+	const uint32 index = m_transformSlots.IndexOf(handle.slot);
+	XTEST_ASSERT(m_transformUseCounts[index] == 0, L"the transform in slot %u is used by %u objects", handle.slot, m_transformUseCounts[index]);
+
+	// the last transform moves to the index of the removed one, its slot and the objects using it follow it. the
+	// objects are looked for in a pass over all of them, transforms are removed far less often than drawn
+	const uint32 lastIndex = TransformCount() - 1;
+	m_transformSlots.SetIndex(m_transformHandles.back().slot, index);
+	if (m_transformUseCounts[lastIndex] > 0)
+	{
+		std::replace(m_transformIndices.begin(), m_transformIndices.end(), lastIndex, index);
+	}
+
+	RemoveValue(index, &m_transformHandles);
+	m_worlds.Remove(index);
+	RemoveValue(index, &m_transformUseCounts);
+	RemoveValue(index, &m_isWorldChanged);
+	m_transformSlots.Free(handle.slot);
+
+	// the results of the frame refer to the old indices
+	m_transforms.clear();
+}
+
+
+bool Scene::Contains(TransformHandle handle) const
+{
+	return m_transformSlots.Contains(handle.slot, handle.generation);
+}
+
+
+uint32 Scene::IndexOf(TransformHandle handle) const
+{
+	XTEST_ASSERT(Contains(handle), L"unknown transform in slot %u", handle.slot);
+	return m_transformSlots.IndexOf(handle.slot);
+}
+
+
+uint32 Scene::TransformCount() const
+{
+	return m_worlds.Count();
+}
+
+
+void Scene::SetWorld(uint32 transformIndex, FXMMATRIX world)
+{
+	XTEST_ASSERT(transformIndex < TransformCount(), L"transform %u out of range", transformIndex);
+
+	m_worlds.Set(transformIndex, world);
+	m_isWorldChanged[transformIndex] = 1;
+	m_isAnyWorldChanged = true;
+}
+
+
+ObjectHandle Scene::Add(const ObjectDesc& desc)
+{
+	const uint32 transformIndex = IndexOf(desc.transform);
+
+	ObjectHandle handle;
+	m_objectSlots.Allocate(Count(), &handle.slot, &handle.generation);
+
+	m_handles.push_back(handle);
+	m_transformIndices.push_back(transformIndex);
+	m_bounds.push_back(desc.bounds);
+	m_spheres.Add(desc.bounds, m_worlds.Get(transformIndex));
+	m_meshes.push_back(desc.mesh);
+	m_materials.push_back(desc.material);
+	m_lodLevels.push_back(0);
+	m_constantBuffers.push_back(render::ConstantBufferBinding());
+	m_transformUseCounts[transformIndex]++;
+	return handle;
+}
+
+
+void Scene::Remove(ObjectHandle handle)
+{
+	XTEST_ASSERT(Contains(handle), L"unknown object in slot %u", handle.slot);
+
+	// the last object moves to the index of the removed one, its slot follows it
+	const uint32 index = m_objectSlots.IndexOf(handle.slot);
+	m_objectSlots.SetIndex(m_handles.back().slot, index);
+	m_transformUseCounts[m_transformIndices[index]]--;
+
+	RemoveValue(index, &m_handles);
+	RemoveValue(index, &m_transformIndices);
+	RemoveValue(index, &m_bounds);
+	m_spheres.Remove(index);
+	RemoveValue(index, &m_meshes);
+	RemoveValue(index, &m_materials);
+	RemoveValue(index, &m_lodLevels);
+	RemoveValue(index, &m_constantBuffers);
+	m_objectSlots.Free(handle.slot);
+
+	// the results of the frame refer to the old indices
+	m_visibleCount = 0;
+}
+
+
+bool Scene::Contains(ObjectHandle handle) const
+{
+	return m_objectSlots.Contains(handle.slot, handle.generation);
+}
+
+
+uint32 Scene::IndexOf(ObjectHandle handle) const
+{
+	XTEST_ASSERT(Contains(handle), L"unknown object in slot %u", handle.slot);
+	return m_objectSlots.IndexOf(handle.slot);
+}
+
+
+uint32 Scene::Count() const
+{
+	return uint32(m_handles.size());
+}
+
+
+void Scene::Clear()
+{
+	// the handles given so far stay invalid
+	for (const ObjectHandle& handle : m_handles)
+	{
+		m_objectSlots.Free(handle.slot);
+	}
+	for (const TransformHandle& handle : m_transformHandles)
+	{
+		m_transformSlots.Free(handle.slot);
+	}
+
+	m_transformHandles.clear();
+	m_worlds.Clear();
+	m_transformUseCounts.clear();
+	m_isWorldChanged.clear();
+	m_isAnyWorldChanged = false;
+
+	m_handles.clear();
+	m_transformIndices.clear();
+	m_bounds.clear();
+	m_spheres.Clear();
+	m_meshes.clear();
+	m_materials.clear();
+	m_lodLevels.clear();
+	m_constantBuffers.clear();
+
+	m_transforms.clear();
+	m_visibleCount = 0;
+}
+
+
+const xtest::render::WorldTransforms& Scene::Worlds() const
+{
+	return m_worlds;
+}
+
+
+const std::vector<ObjectHandle>& Scene::Handles() const
+{
+	return m_handles;
+}
+
+
+const std::vector<uint32>& Scene::TransformIndices() const
+{
+	return m_transformIndices;
+}
+
+
+const std::vector<xtest::mesh::MeshBounds>& Scene::Bounds() const
+{
+	return m_bounds;
+}
+
+
+const xtest::render::CullingSpheres& Scene::Spheres() const
+{
+	return m_spheres;
+}
+
+
+const std::vector<uint32>& Scene::Meshes() const
+{
+	return m_meshes;
+}
+
+
+const std::vector<uint32>& Scene::Materials() const
+{
+	return m_materials;
+}
+
+
+std::vector<uint32>& Scene::LodLevels()
+{
+	return m_lodLevels;
+}
+
+
+std::vector<xtest::render::ConstantBufferBinding>& Scene::ConstantBuffers()
+{
+	return m_constantBuffers;
+}
+
+
+void Scene::ComputeTransforms(FXMMATRIX viewProjection, uint32 threadCount)
+{
+	m_transforms.resize(TransformCount());
+	render::ComputeObjectTransforms(m_worlds, viewProjection, m_transforms.data(), threadCount);
+}
+
+
+const std::vector<xtest::render::ObjectTransforms>& Scene::Transforms() const
+{
+	return m_transforms;
+}
+
+
+uint32 Scene::Cull(const render::Frustum& frustum, uint32 threadCount)
+{
+	UpdateSpheres();
+
+	m_visibleIndices.resize(Count());
+	m_visibleCount = render::CullSpheres(frustum, m_spheres, m_visibleIndices.data(), threadCount);
+	return m_visibleCount;
+}
+
+
+const std::vector<uint32>& Scene::VisibleIndices() const
+{
+	return m_visibleIndices;
+}
+
+
+uint32 Scene::VisibleCount() const
+{
+	return m_visibleCount;
+}
+
+
+void Scene::UpdateSpheres()
+{
+	if (!m_isAnyWorldChanged)
+	{
+		return;
+	}
+
+	// one pass over the objects for all the transforms set since the last time
+	for (uint32 index = 0; index < Count(); index++)
+	{
+		const uint32 transformIndex = m_transformIndices[index];
+		if (m_isWorldChanged[transformIndex])
+		{
+			m_spheres.Set(index, m_bounds[index], m_worlds.Get(transformIndex));
+		}
+	}
+
+	std::fill(m_isWorldChanged.begin(), m_isWorldChanged.end(), uint8(0));
+	m_isAnyWorldChanged = false;
+}
+
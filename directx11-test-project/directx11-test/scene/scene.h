@@ -0,0 +1,177 @@
+#pragma once
+
+#include <mesh/mesh_format.h>
+#include <render/culling.h>
+#include <render/object_transforms.h>
+#include <render/render_backend.h>
+
+
+namespace xtest {
+namespace scene {
+
+	// names an object for as long as it is in the scene, unlike its index that changes when other objects are
+	// removed; a slot is reused by a later object with the next generation, so an old handle never finds it
+	struct ObjectHandle
+	{
+		uint32 slot = UINT32_MAX;
+		uint32 generation = 0;
+
+		bool operator==(const ObjectHandle& rhs) const;
+		bool operator!=(const ObjectHandle& rhs) const;
+	};
+
+
+	// names a world transform of the scene, like ObjectHandle does an object
+	struct TransformHandle
+	{
+		uint32 slot = UINT32_MAX;
+		uint32 generation = 0;
+
+		bool operator==(const TransformHandle& rhs) const;
+		bool operator!=(const TransformHandle& rhs) const;
+	};
+
+
+	struct ObjectDesc
+	{
+		TransformHandle transform;	// objects drawn with the same world matrix share one transform
+		mesh::MeshBounds bounds;	// in the space of the mesh
+		uint32 mesh = 0;			// the meshes and the materials are tables of the application, the scene keeps
+		uint32 material = 0;		// only the index in them
+	};
+
+
+	// the slots behind the handles of a dense array: the index every slot is at and the generation of the handles
+	// that find it
+	class HandleSlots
+	{
+	public:
+
+		HandleSlots();
+
+		HandleSlots(HandleSlots&&) = default;
+		HandleSlots(const HandleSlots&) = default;
+		HandleSlots& operator=(HandleSlots&&) = default;
+		HandleSlots& operator=(const HandleSlots&) = default;
+
+
+		// a slot for the element at the index, a free one if there is any
+		void Allocate(uint32 index, uint32* slot, uint32* generation);
+
+		// the handles of the slot don't find the next element given it
+		void Free(uint32 slot);
+
+		bool Contains(uint32 slot, uint32 generation) const;
+		uint32 IndexOf(uint32 slot) const;
+		void SetIndex(uint32 slot, uint32 index);
+
+	private:
+
+		std::vector<uint32> m_indices;
+		std::vector<uint32> m_generations;
+		std::vector<uint32> m_freeSlots;
+	};
+
+
+	/**
+	The objects of a scene as arrays indexed by object, one for every attribute, so that every step of a frame is a
+	loop over the few arrays it needs: the culling reads only the spheres, the submission only the visible indices
+	and the meshes, materials, transform indices and constant buffers at them. The world matrices are arrays of
+	their own, indexed by transform, and the objects drawn with the same one share it: its W, WVP and inverse are
+	computed once a frame for all of them. Removing an object or a transform moves the last one in its place, the
+	arrays stay dense and the handles keep finding what they name.
+	*/
+	class Scene
+	{
+	public:
+
+		Scene();
+
+		Scene(Scene&&) = default;
+		Scene(const Scene&) = delete;
+		Scene& operator=(Scene&&) = default;
+		Scene& operator=(const Scene&) = delete;
+
+
+		TransformHandle AddTransform(DirectX::FXMMATRIX world);
+
+		// no object may be using the transform
+		void RemoveTransform(TransformHandle handle);
+		bool Contains(TransformHandle handle) const;
+
+		// the index of the transform in the arrays, valid until a transform is removed
+		uint32 IndexOf(TransformHandle handle) const;
+		uint32 TransformCount() const;
+
+		// the spheres of the objects using the transform follow it at the next Cull
+		void SetWorld(uint32 transformIndex, DirectX::FXMMATRIX world);
+
+
+		ObjectHandle Add(const ObjectDesc& desc);
+		void Remove(ObjectHandle handle);
+		bool Contains(ObjectHandle handle) const;
+
+		// the index of the object in the arrays, valid until an object is removed
+		uint32 IndexOf(ObjectHandle handle) const;
+		uint32 Count() const;
+
+		// removes the objects and the transforms
+		void Clear();
+
+
+		// by transform
+		const render::WorldTransforms& Worlds() const;
+
+		// by object
+		const std::vector<ObjectHandle>& Handles() const;
+		const std::vector<uint32>& TransformIndices() const;
+		const std::vector<mesh::MeshBounds>& Bounds() const;
+		const render::CullingSpheres& Spheres() const;		// as of the last Cull
+		const std::vector<uint32>& Meshes() const;
+		const std::vector<uint32>& Materials() const;
+
+		// written by the application every frame: the levels selected for the objects with a lod mesh, and where
+		// the per object constants of the visible objects are
+		std::vector<uint32>& LodLevels();
+		std::vector<render::ConstantBufferBinding>& ConstantBuffers();
+
+
+		// W, WVP and the inverse of W of every transform, see render::ComputeObjectTransforms; the ones of an object
+		// are at its transform index
+		void ComputeTransforms(DirectX::FXMMATRIX viewProjection, uint32 threadCount = 0);
+		const std::vector<render::ObjectTransforms>& Transforms() const;
+
+		// the indices of the objects in the frustum in increasing order, see render::CullSpheres; returns how many
+		uint32 Cull(const render::Frustum& frustum, uint32 threadCount = 0);
+		const std::vector<uint32>& VisibleIndices() const;
+		uint32 VisibleCount() const;
+
+	private:
+
+		void UpdateSpheres();
+
+		std::vector<TransformHandle> m_transformHandles;
+		render::WorldTransforms m_worlds;
+		std::vector<uint32> m_transformUseCounts;
+		std::vector<uint8> m_isWorldChanged;
+		bool m_isAnyWorldChanged;
+		HandleSlots m_transformSlots;
+
+		std::vector<ObjectHandle> m_handles;
+		std::vector<uint32> m_transformIndices;
+		std::vector<mesh::MeshBounds> m_bounds;
+		render::CullingSpheres m_spheres;
+		std::vector<uint32> m_meshes;
+		std::vector<uint32> m_materials;
+		std::vector<uint32> m_lodLevels;
+		std::vector<render::ConstantBufferBinding> m_constantBuffers;
+		HandleSlots m_objectSlots;
+
+		std::vector<render::ObjectTransforms> m_transforms;
+		std::vector<uint32> m_visibleIndices;
+		uint32 m_visibleCount;
+	};
+
+} // scene
+} // xtest
+
@@ -0,0 +1,157 @@
+#include "stdafx.h"
+#include "scene_benchmark.h"
+#include <file/scene_reader.h>
+#include <math/math_utils.h>
+#include <render/constant_ring_allocator.h>
+#include <render/draw_queue.h>
+#include <render/recording_backend.h>
+#include <time/time_point.h>
+
+
+using namespace DirectX;
+using xtest::scene::Scene;
+using xtest::scene::SceneBenchmarkResult;
+using xtest::scene::SceneBenchmarkSettings;
+
+
+namespace
+{
+	// the draws of the stand-in meshes, a box
+	const uint32 kStandInIndexCount = 36;
+
+	// the buffer of the per object constants, a handle the buffers of the meshes never get
+	const xtest::render::ResourceHandle kConstantBuffer = UINT32_MAX;
+}
+
+
+SceneBenchmarkResult xtest::scene::RunSceneBenchmark(Scene* scene, const std::vector<render::DrawPacket>& meshPackets, const SceneBenchmarkSettings& settings)
+{
+	XTEST_ASSERT(scene);
+
+	const XMMATRIX V = XMMatrixLookAtLH(XMLoadFloat3(&settings.eyePosition), XMLoadFloat3(&settings.focusPosition), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+	const XMMATRIX P = XMMatrixPerspectiveFovLH(math::ToRadians(45.f), settings.aspectRatio, 1.f, 1000.f);
+	const XMMATRIX VP = XMMatrixMultiply(V, P);
+	const render::Frustum frustum = render::ExtractFrustum(VP);
+
+	// room for the constants of every object, the frames are retired as soon as they end
+	const uint32 constantSize = (sizeof(render::ObjectTransforms) + render::kConstantBufferAlignment - 1) & ~(render::kConstantBufferAlignment - 1);
+	render::ConstantRingAllocator constantAllocator(std::max(scene->Count(), 1u) * constantSize);
+	std::vector<uint8> constantData(constantAllocator.Capacity());
+
+	render::DrawQueue drawQueue;
+	render::RecordingBackend backend(false);
+
+	SceneBenchmarkResult result;
+	result.objectCount = scene->Count();
+	for (uint32 frame = 0; frame < settings.frameCount; frame++)
+	{
+		const time::TimePoint frameStart = time::TimePoint::Now();
+		scene->ComputeTransforms(VP, settings.threadCount);
+
+		const time::TimePoint cullStart = time::TimePoint::Now();
+		const uint32 visibleCount = scene->Cull(frustum, settings.threadCount);
+
+		const time::TimePoint submitStart = time::TimePoint::Now();
+		const std::vector<uint32>& visibleIndices = scene->VisibleIndices();
+		const std::vector<render::ObjectTransforms>& transforms = scene->Transforms();
+		const std::vector<uint32>& transformIndices = scene->TransformIndices();
+		const std::vector<uint32>& meshes = scene->Meshes();
+		const std::vector<uint32>& materials = scene->Materials();
+		const render::CullingSpheres& spheres = scene->Spheres();
+		std::vector<render::ConstantBufferBinding>& constantBuffers = scene->ConstantBuffers();
+
+		constantAllocator.BeginFrame(frame);
+		drawQueue.Clear();
+		backend.Reset();
+		for (uint32 visible = 0; visible < visibleCount; visible++)
+		{
+			const uint32 index = visibleIndices[visible];
+
+			render::ConstantBufferBinding& binding = constantBuffers[index];
+			binding.buffer = kConstantBuffer;
+			binding.offset = constantAllocator.Allocate(sizeof(render::ObjectTransforms));
+			binding.size = sizeof(render::ObjectTransforms);
+			std::memcpy(constantData.data() + binding.offset, &transforms[transformIndices[index]], sizeof(render::ObjectTransforms));
+
+			render::DrawPacket packet = meshPackets[meshes[index]];
+			packet.vertexConstantBuffers[0] = binding;
+			packet.pixelConstantBuffers[0] = binding;
+
+			const float viewDepth = XMVectorGetZ(XMVector3Transform(XMVectorSet(spheres.centerX[index], spheres.centerY[index], spheres.centerZ[index], 1.f), V));
+			drawQueue.Add(render::MakeSortKey(0, packet.pipeline, materials[index], render::DepthBucket(viewDepth, 1.f, 1000.f)), packet);
+		}
+		drawQueue.Sort();
+		drawQueue.Execute(&backend);
+		constantAllocator.EndFrame();
+		constantAllocator.RetireFrames(frame);
+
+		const time::TimePoint frameEnd = time::TimePoint::Now();
+		result.transformMillis += (cullStart - frameStart).Millis();
+		result.cullMillis += (submitStart - cullStart).Millis();
+		result.submitMillis += (frameEnd - submitStart).Millis();
+		result.frameMillis += (frameEnd - frameStart).Millis();
+		result.visibleCount = visibleCount;
+		result.drawCount = backend.CommandCount(render::RecordedCommand::Type::draw_indexed);
+	}
+
+	if (settings.frameCount > 0)
+	{
+		const float frameCount = float(settings.frameCount);
+		result.transformMillis /= frameCount;
+		result.cullMillis /= frameCount;
+		result.submitMillis /= frameCount;
+		result.frameMillis /= frameCount;
+	}
+	return result;
+}
+
+
+SceneBenchmarkResult xtest::scene::RunSceneBenchmark(const std::wstring& sceneFilePath, const SceneBenchmarkSettings& settings)
+{
+	file::SceneDesc sceneDesc;
+	if (!file::ReadScene(sceneFilePath, &sceneDesc))
+	{
+		return SceneBenchmarkResult();
+	}
+
+	mesh::MeshBounds standInBounds;
+	standInBounds.boxMin = { -1.f, -1.f, -1.f };
+	standInBounds.boxMax = { 1.f, 1.f, 1.f };
+	standInBounds.sphereCenter = { 0.f, 0.f, 0.f };
+	standInBounds.sphereRadius = 1.f;
+
+	// the names are numbered in the order they are found
+	std::map<std::string, uint32> meshIdByName;
+	std::map<std::string, uint32> materialIdByName;
+	std::vector<render::DrawPacket> meshPackets;
+	Scene scene;
+	std::vector<TransformHandle> transformHandles;
+	for (const file::SceneTransformDesc& transformDesc : sceneDesc.transforms)
+	{
+		transformHandles.push_back(scene.AddTransform(transformDesc.World()));
+	}
+
+	for (const file::SceneObjectDesc& objectDesc : sceneDesc.objects)
+	{
+		ObjectDesc desc;
+		desc.transform = transformHandles[objectDesc.transform];
+		desc.bounds = standInBounds;
+		desc.mesh = meshIdByName.emplace(objectDesc.mesh, uint32(meshIdByName.size())).first->second;
+		desc.material = materialIdByName.emplace(objectDesc.material, uint32(materialIdByName.size())).first->second;
+		scene.Add(desc);
+
+		if (desc.mesh == meshPackets.size())
+		{
+			render::DrawPacket packet;
+			packet.pipeline = 1;
+			packet.vertexBuffer = 2 * desc.mesh + 1;
+			packet.vertexStride = sizeof(mesh::MeshData::Vertex);
+			packet.indexBuffer = 2 * desc.mesh + 2;
+			packet.indexCount = kStandInIndexCount;
+			meshPackets.push_back(packet);
+		}
+	}
+
+	return RunSceneBenchmark(&scene, meshPackets, settings);
+}
+
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <scene/scene.h>
+#include <render/draw_queue.h>
+
+
+namespace xtest {
+namespace scene {
+
+	struct SceneBenchmarkSettings
+	{
+		uint32 frameCount = 100;
+		uint32 threadCount = 0;		// of the transforms and the culling, 0 means one per hardware thread
+
+		// the camera looks at the focus, with the projection of the textures demo
+		DirectX::XMFLOAT3 eyePosition = { 0.f, 20.f, -60.f };
+		DirectX::XMFLOAT3 focusPosition = { 0.f, 0.f, 0.f };
+		float aspectRatio = 16.f / 9.f;
+	};
+
+
+	// the counts of the last frame and the average times of a frame
+	struct SceneBenchmarkResult
+	{
+		uint32 objectCount = 0;
+		uint32 visibleCount = 0;
+		uint32 drawCount = 0;
+		float transformMillis = 0.f;
+		float cullMillis = 0.f;
+		float submitMillis = 0.f;	// the per object constants written, the draws queued, sorted and executed
+		float frameMillis = 0.f;
+	};
+
+
+	/**
+	Runs the cpu side of the frames of a scene without a device: the per object constants are written to memory
+	handed out by a ConstantRingAllocator and the draws go through a DrawQueue to a RecordingBackend that keeps no
+	commands, so the times are the ones of the scene loops and of the submission alone.
+	@param meshPackets	The buffers and the draw arguments of every mesh of the scene, by mesh index.
+	*/
+	SceneBenchmarkResult RunSceneBenchmark(Scene* scene, const std::vector<render::DrawPacket>& meshPackets, const SceneBenchmarkSettings& settings);
+
+	// the objects of a scene file with stand-in meshes: every mesh name gets bounds of radius 1 and buffers of its
+	// own, every material name a texture set
+	SceneBenchmarkResult RunSceneBenchmark(const std::wstring& sceneFilePath, const SceneBenchmarkSettings& settings);
+
+} // scene
+} // xtest
+
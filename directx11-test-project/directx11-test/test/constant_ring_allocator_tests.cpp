@@ -0,0 +1,226 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <render/constant_ring_allocator.h>
+#include <deque>
+#include <random>
+
+
+using xtest::render::ConstantRingAllocator;
+using xtest::render::kInvalidConstantOffset;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	struct AllocatedRange
+	{
+		uint32 begin;
+		uint32 end;
+	};
+
+
+	struct FrameRanges
+	{
+		uint64 frameIndex;
+		std::vector<AllocatedRange> ranges;
+	};
+
+
+	bool Overlaps(const AllocatedRange& a, const AllocatedRange& b)
+	{
+		return a.begin < b.end && b.begin < a.end;
+	}
+
+
+	void TestAlignment(UnitTestReport* report)
+	{
+		ConstantRingAllocator allocator(1024, 256);
+		allocator.BeginFrame(1);
+		XTEST_CHECK(report, allocator.Allocate(1) == 0);
+		XTEST_CHECK(report, allocator.Allocate(256) == 256);
+		XTEST_CHECK(report, allocator.Allocate(257) == 512);
+		XTEST_CHECK(report, allocator.UsedSize() == 1024);
+		XTEST_CHECK(report, allocator.Allocate(1) == kInvalidConstantOffset);
+		XTEST_CHECK(report, allocator.Allocate(0) == kInvalidConstantOffset);
+		allocator.EndFrame();
+		XTEST_CHECK(report, allocator.FramesInFlight() == 1);
+	}
+
+
+	void TestLargeAllocations(UnitTestReport* report)
+	{
+		// refused even with the ring empty, the sizes that overflow when rounded up too
+		ConstantRingAllocator allocator(1024, 256);
+		allocator.BeginFrame(1);
+		XTEST_CHECK(report, allocator.Allocate(1025) == kInvalidConstantOffset);
+		XTEST_CHECK(report, allocator.Allocate(UINT32_MAX) == kInvalidConstantOffset);
+		XTEST_CHECK(report, allocator.Allocate(UINT32_MAX - 300) == kInvalidConstantOffset);
+		XTEST_CHECK(report, allocator.UsedSize() == 0);
+		XTEST_CHECK(report, allocator.Allocate(1024) == 0);
+		allocator.EndFrame();
+	}
+
+
+	void TestFramesInFlight(UnitTestReport* report)
+	{
+		ConstantRingAllocator allocator(1024, 256);
+		allocator.BeginFrame(1);
+		XTEST_CHECK(report, allocator.Allocate(512) == 0);
+		allocator.EndFrame();
+		allocator.BeginFrame(2);
+		XTEST_CHECK(report, allocator.Allocate(256) == 512);
+		allocator.EndFrame();
+		XTEST_CHECK(report, allocator.FramesInFlight() == 2 && allocator.OldestFrameInFlight() == 1);
+
+		// the frame 3 space wraps around, the 256 left at the end are skipped and freed with it
+		allocator.RetireFrames(1);
+		XTEST_CHECK(report, allocator.UsedSize() == 256 && allocator.OldestFrameInFlight() == 2);
+		allocator.BeginFrame(3);
+		XTEST_CHECK(report, allocator.Allocate(512) == 0);
+		XTEST_CHECK(report, allocator.UsedSize() == 1024);
+		XTEST_CHECK(report, allocator.Allocate(1) == kInvalidConstantOffset);
+		allocator.EndFrame();
+
+		allocator.RetireFrames(2);
+		XTEST_CHECK(report, allocator.UsedSize() == 768);
+		allocator.RetireFrames(3);
+		XTEST_CHECK(report, allocator.UsedSize() == 0 && allocator.FramesInFlight() == 0);
+
+		// a retired index not reached yet keeps the frame
+		allocator.BeginFrame(5);
+		allocator.Allocate(256);
+		allocator.EndFrame();
+		allocator.RetireFrames(4);
+		XTEST_CHECK(report, allocator.FramesInFlight() == 1 && allocator.UsedSize() == 256);
+	}
+
+
+	void TestReset(UnitTestReport* report)
+	{
+		ConstantRingAllocator allocator(1024, 256);
+		allocator.BeginFrame(1);
+		allocator.Allocate(512);
+		allocator.EndFrame();
+		allocator.BeginFrame(2);
+		allocator.Allocate(256);
+		allocator.EndFrame();
+
+		allocator.Reset();
+		XTEST_CHECK(report, allocator.UsedSize() == 0 && allocator.FramesInFlight() == 0);
+		allocator.BeginFrame(3);
+		XTEST_CHECK(report, allocator.Allocate(1024) == 0);
+		allocator.EndFrame();
+	}
+
+
+	/**
+	Rings of random capacity and alignment through frames of random allocations, retired by a gpu lagging a random
+	number of frames behind and reset now and then. The space handed out must be aligned, inside the ring and apart
+	from the one of every frame not retired, and the ring may refuse an allocation only when something is in use.
+	*/
+	void FuzzAllocator(UnitTestReport* report)
+	{
+		std::mt19937 random(11);
+
+		uint32 misalignedCount = 0;
+		uint32 overlapCount = 0;
+		uint32 wrongRefusalCount = 0;
+		uint32 wrongUsedSizeCount = 0;
+		uint32 wrongFrameCount = 0;
+		uint32 allocationCount = 0;
+		for (uint32 ring = 0; ring < 2000; ring++)
+		{
+			const uint32 alignment = 16u << (random() % 7);
+			const uint32 capacity = alignment * (1 + random() % 64);
+			const uint32 lag = random() % 5;
+
+			ConstantRingAllocator allocator(capacity, alignment);
+			std::deque<FrameRanges> framesInFlight;
+			uint64 frameIndex = 1 + random() % 3;
+			for (uint32 frame = 0; frame < 200; frame++, frameIndex += 1 + random() % 2)
+			{
+				allocator.BeginFrame(frameIndex);
+				FrameRanges current = { frameIndex, {} };
+				const uint32 frameAllocationCount = random() % 6;
+				for (uint32 allocation = 0; allocation < frameAllocationCount; allocation++)
+				{
+					const uint32 size = random() % 3 == 0 ? alignment * (1 + random() % 4) : 1 + random() % (alignment * 3);
+					const uint32 alignedSize = (size + alignment - 1) / alignment * alignment;
+					const uint32 offset = allocator.Allocate(size);
+					if (offset == kInvalidConstantOffset)
+					{
+						const bool isEmpty = allocator.UsedSize() == 0 && allocator.FramesInFlight() == 0;
+						wrongRefusalCount += isEmpty && alignedSize <= capacity ? 1 : 0;
+						continue;
+					}
+
+					allocationCount++;
+					misalignedCount += offset % alignment != 0 || offset + alignedSize > capacity ? 1 : 0;
+
+					const AllocatedRange range = { offset, offset + alignedSize };
+					for (const FrameRanges& frameRanges : framesInFlight)
+					{
+						for (const AllocatedRange& other : frameRanges.ranges)
+						{
+							overlapCount += Overlaps(range, other) ? 1 : 0;
+						}
+					}
+					for (const AllocatedRange& other : current.ranges)
+					{
+						overlapCount += Overlaps(range, other) ? 1 : 0;
+					}
+					current.ranges.push_back(range);
+				}
+				allocator.EndFrame();
+				framesInFlight.push_back(current);
+
+				uint32 allocatedSize = 0;
+				for (const FrameRanges& frameRanges : framesInFlight)
+				{
+					for (const AllocatedRange& range : frameRanges.ranges)
+					{
+						allocatedSize += range.end - range.begin;
+					}
+				}
+				wrongUsedSizeCount += allocator.UsedSize() < allocatedSize || allocator.UsedSize() > capacity ? 1 : 0;
+				wrongFrameCount += allocator.FramesInFlight() != framesInFlight.size() ? 1 : 0;
+
+				// the gpu finishes the frames up to the lag, sometimes one less
+				if (framesInFlight.size() > lag)
+				{
+					const size_t retiredCount = framesInFlight.size() - lag - (lag > 0 && random() % 2 ? 1 : 0);
+					if (retiredCount > 0)
+					{
+						allocator.RetireFrames(framesInFlight[retiredCount - 1].frameIndex);
+						framesInFlight.erase(framesInFlight.begin(), framesInFlight.begin() + retiredCount);
+					}
+				}
+
+				if (random() % 97 == 0)
+				{
+					allocator.Reset();
+					framesInFlight.clear();
+				}
+				wrongUsedSizeCount += framesInFlight.empty() && allocator.UsedSize() != 0 ? 1 : 0;
+			}
+		}
+
+		XTEST_CHECK(report, allocationCount > 0);
+		XTEST_CHECK(report, misalignedCount == 0);
+		XTEST_CHECK(report, overlapCount == 0);
+		XTEST_CHECK(report, wrongRefusalCount == 0);
+		XTEST_CHECK(report, wrongUsedSizeCount == 0);
+		XTEST_CHECK(report, wrongFrameCount == 0);
+	}
+}
+
+
+void xtest::test::TestConstantRingAllocator(UnitTestReport* report)
+{
+	TestAlignment(report);
+	TestLargeAllocations(report);
+	TestFramesInFlight(report);
+	TestReset(report);
+	FuzzAllocator(report);
+}
+
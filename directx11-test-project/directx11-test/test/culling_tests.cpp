@@ -0,0 +1,275 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <render/culling.h>
+#include <random>
+
+
+using namespace DirectX;
+using xtest::mesh::MeshBounds;
+using xtest::render::CullingBoxes;
+using xtest::render::CullingSpheres;
+using xtest::render::Frustum;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	// fills the entries past the visible indices, the culling never writes them
+	const uint32 kGuardIndex = UINT32_MAX;
+
+
+	XMMATRIX TestViewProjection()
+	{
+		const XMMATRIX V = XMMatrixLookAtLH(XMVectorSet(0.f, 5.f, -20.f, 1.f), XMVectorZero(), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+		const XMMATRIX P = XMMatrixPerspectiveFovLH(1.f, 16.f / 9.f, 1.f, 200.f);
+		return XMMatrixMultiply(V, P);
+	}
+
+
+	bool IsInClipVolume(FXMVECTOR positionW, CXMMATRIX viewProjection)
+	{
+		XMFLOAT4 clip;
+		XMStoreFloat4(&clip, XMVector4Transform(positionW, viewProjection));
+		return clip.w > 0.f && -clip.w <= clip.x && clip.x <= clip.w && -clip.w <= clip.y && clip.y <= clip.w && 0.f <= clip.z && clip.z <= clip.w;
+	}
+
+
+	float PlaneDistance(const XMFLOAT4& plane, float x, float y, float z)
+	{
+		return plane.x * x + plane.y * y + plane.z * z + plane.w;
+	}
+
+
+	// boxes around the origin of their mesh, scaled, rotated and scattered in front of the camera and around it
+	struct TestObjects
+	{
+		std::vector<MeshBounds> bounds;
+		std::vector<XMFLOAT4X4> worlds;
+		CullingSpheres spheres;
+		CullingBoxes boxes;
+	};
+
+
+	TestObjects MakeTestObjects(uint32 count, uint32 seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> position(-150.f, 150.f);
+		std::uniform_real_distribution<float> size(0.1f, 8.f);
+
+		TestObjects objects;
+		for (uint32 index = 0; index < count; index++)
+		{
+			const XMFLOAT3 center(position(random) * 0.05f, position(random) * 0.05f, position(random) * 0.05f);
+			const XMFLOAT3 extent(size(random) * 0.5f, size(random) * 0.5f, size(random) * 0.5f);
+
+			MeshBounds bounds;
+			bounds.boxMin = { center.x - extent.x, center.y - extent.y, center.z - extent.z };
+			bounds.boxMax = { center.x + extent.x, center.y + extent.y, center.z + extent.z };
+			bounds.sphereCenter = center;
+			bounds.sphereRadius = std::sqrt(extent.x * extent.x + extent.y * extent.y + extent.z * extent.z);
+
+			const XMMATRIX S = XMMatrixScaling(size(random) * 0.3f + 0.2f, size(random) * 0.3f + 0.2f, 1.f);
+			const XMMATRIX R = XMMatrixRotationRollPitchYaw(position(random), position(random), position(random));
+			const XMMATRIX T = XMMatrixTranslation(position(random), position(random) * 0.3f, position(random) + 50.f);
+			const XMMATRIX world = XMMatrixMultiply(XMMatrixMultiply(S, R), T);
+
+			XMFLOAT4X4 worldElements;
+			XMStoreFloat4x4(&worldElements, world);
+			objects.bounds.push_back(bounds);
+			objects.worlds.push_back(worldElements);
+			objects.spheres.Add(bounds, world);
+			objects.boxes.Add(bounds, world);
+		}
+		return objects;
+	}
+
+
+	// the plane by plane test of one object at a time
+	std::vector<uint32> ReferenceVisibleSpheres(const Frustum& frustum, const CullingSpheres& spheres)
+	{
+		std::vector<uint32> visibleIndices;
+		for (uint32 index = 0; index < spheres.Count(); index++)
+		{
+			bool isVisible = true;
+			for (const XMFLOAT4& plane : frustum.planes)
+			{
+				isVisible = isVisible && PlaneDistance(plane, spheres.centerX[index], spheres.centerY[index], spheres.centerZ[index]) >= -spheres.radius[index];
+			}
+			if (isVisible)
+			{
+				visibleIndices.push_back(index);
+			}
+		}
+		return visibleIndices;
+	}
+
+
+	std::vector<uint32> ReferenceVisibleBoxes(const Frustum& frustum, const CullingBoxes& boxes)
+	{
+		std::vector<uint32> visibleIndices;
+		for (uint32 index = 0; index < boxes.Count(); index++)
+		{
+			bool isVisible = true;
+			for (const XMFLOAT4& plane : frustum.planes)
+			{
+				const float radius = boxes.extentX[index] * std::fabs(plane.x) + boxes.extentY[index] * std::fabs(plane.y) + boxes.extentZ[index] * std::fabs(plane.z);
+				isVisible = isVisible && PlaneDistance(plane, boxes.centerX[index], boxes.centerY[index], boxes.centerZ[index]) >= -radius;
+			}
+			if (isVisible)
+			{
+				visibleIndices.push_back(index);
+			}
+		}
+		return visibleIndices;
+	}
+
+
+	void TestFrustumPlanes(UnitTestReport* report)
+	{
+		const XMMATRIX viewProjection = TestViewProjection();
+		const Frustum frustum = xtest::render::ExtractFrustum(viewProjection);
+
+		// a point in the clip volume is on the inner side of every plane, one out of it is behind at least one
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> position(-150.f, 150.f);
+		uint32 mismatchCount = 0;
+		for (uint32 point = 0; point < 100000; point++)
+		{
+			const XMFLOAT3 p(position(random), position(random), position(random));
+			bool isInside = true;
+			bool isClearlyInside = true;
+			for (const XMFLOAT4& plane : frustum.planes)
+			{
+				isInside = isInside && PlaneDistance(plane, p.x, p.y, p.z) >= -1e-4f;
+				isClearlyInside = isClearlyInside && PlaneDistance(plane, p.x, p.y, p.z) >= 1e-4f;
+			}
+
+			const bool isInClipVolume = IsInClipVolume(XMVectorSet(p.x, p.y, p.z, 1.f), viewProjection);
+			mismatchCount += (isInClipVolume && !isInside) || (!isInClipVolume && isClearlyInside) ? 1 : 0;
+		}
+		XTEST_CHECK(report, mismatchCount == 0);
+
+		for (const XMFLOAT4& plane : frustum.planes)
+		{
+			XTEST_CHECK(report, std::fabs(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z - 1.f) < 1e-4f);
+		}
+	}
+
+
+	void TestAgainstReference(UnitTestReport* report)
+	{
+		const Frustum frustum = xtest::render::ExtractFrustum(TestViewProjection());
+
+		// the counts around the groups of 4, and one past kMinParallelCullingCount to cull in blocks
+		for (uint32 count : { 0u, 1u, 3u, 4u, 5u, 10007u, xtest::render::kMinParallelCullingCount + 5 })
+		{
+			const TestObjects objects = MakeTestObjects(count, count + 1);
+			const std::vector<uint32> referenceSpheres = ReferenceVisibleSpheres(frustum, objects.spheres);
+			const std::vector<uint32> referenceBoxes = ReferenceVisibleBoxes(frustum, objects.boxes);
+
+			for (uint32 threadCount : { 1u, 4u })
+			{
+				std::vector<uint32> visibleIndices(count + 1, kGuardIndex);
+				const uint32 visibleSphereCount = xtest::render::CullSpheres(frustum, objects.spheres, visibleIndices.data(), threadCount);
+				XTEST_CHECK(report, visibleSphereCount == referenceSpheres.size());
+				XTEST_CHECK(report, std::equal(referenceSpheres.begin(), referenceSpheres.end(), visibleIndices.begin()));
+				XTEST_CHECK(report, visibleIndices[count] == kGuardIndex);
+
+				std::fill(visibleIndices.begin(), visibleIndices.end(), kGuardIndex);
+				const uint32 visibleBoxCount = xtest::render::CullBoxes(frustum, objects.boxes, visibleIndices.data(), threadCount);
+				XTEST_CHECK(report, visibleBoxCount == referenceBoxes.size());
+				XTEST_CHECK(report, std::equal(referenceBoxes.begin(), referenceBoxes.end(), visibleIndices.begin()));
+				XTEST_CHECK(report, visibleIndices[count] == kGuardIndex);
+			}
+		}
+	}
+
+
+	void TestConservative(UnitTestReport* report)
+	{
+		const XMMATRIX viewProjection = TestViewProjection();
+		const Frustum frustum = xtest::render::ExtractFrustum(viewProjection);
+		const uint32 count = 10000;
+		const TestObjects objects = MakeTestObjects(count, 3);
+
+		std::vector<uint8> isSphereVisible(count, 0);
+		std::vector<uint8> isBoxVisible(count, 0);
+		std::vector<uint32> visibleIndices(count);
+		const uint32 visibleSphereCount = xtest::render::CullSpheres(frustum, objects.spheres, visibleIndices.data(), 1);
+		for (uint32 visible = 0; visible < visibleSphereCount; visible++)
+		{
+			isSphereVisible[visibleIndices[visible]] = 1;
+		}
+		const uint32 visibleBoxCount = xtest::render::CullBoxes(frustum, objects.boxes, visibleIndices.data(), 1);
+		for (uint32 visible = 0; visible < visibleBoxCount; visible++)
+		{
+			isBoxVisible[visibleIndices[visible]] = 1;
+		}
+
+		// an object with any of the 27 points of a 3x3x3 grid over its box in view is never culled
+		uint32 culledInViewCount = 0;
+		for (uint32 index = 0; index < count; index++)
+		{
+			const MeshBounds& bounds = objects.bounds[index];
+			const XMMATRIX world = XMLoadFloat4x4(&objects.worlds[index]);
+			for (uint32 point = 0; point < 27; point++)
+			{
+				const float u = float(point % 3) * 0.5f;
+				const float v = float(point / 3 % 3) * 0.5f;
+				const float w = float(point / 9) * 0.5f;
+				const XMVECTOR positionL = XMVectorSet(
+					bounds.boxMin.x + (bounds.boxMax.x - bounds.boxMin.x) * u,
+					bounds.boxMin.y + (bounds.boxMax.y - bounds.boxMin.y) * v,
+					bounds.boxMin.z + (bounds.boxMax.z - bounds.boxMin.z) * w,
+					1.f);
+
+				if (IsInClipVolume(XMVector3TransformCoord(positionL, world), viewProjection) && (!isSphereVisible[index] || !isBoxVisible[index]))
+				{
+					culledInViewCount++;
+					break;
+				}
+			}
+		}
+		XTEST_CHECK(report, culledInViewCount == 0);
+		XTEST_CHECK(report, visibleSphereCount > 0 && visibleSphereCount < count);
+	}
+
+
+	void TestSphereArrays(UnitTestReport* report)
+	{
+		MeshBounds bounds;
+		bounds.sphereCenter = { 1.f, 0.f, 0.f };
+		bounds.sphereRadius = 2.f;
+
+		// the radius grows with the largest scale, the center moves with the whole matrix
+		CullingSpheres spheres;
+		spheres.Add(bounds, XMMatrixMultiply(XMMatrixScaling(1.f, 3.f, 0.5f), XMMatrixTranslation(0.f, 0.f, 10.f)));
+		XTEST_CHECK(report, spheres.Count() == 1);
+		XTEST_CHECK(report, std::fabs(spheres.radius[0] - 6.f) < 1e-5f);
+		XTEST_CHECK(report, spheres.centerX[0] == 1.f && spheres.centerZ[0] == 10.f);
+
+		spheres.Add(bounds, XMMatrixTranslation(0.f, 20.f, 0.f));
+		spheres.Add(bounds, XMMatrixTranslation(0.f, 30.f, 0.f));
+		spheres.Set(1, bounds, XMMatrixTranslation(0.f, 25.f, 0.f));
+		XTEST_CHECK(report, spheres.centerY[1] == 25.f && spheres.radius[1] == 2.f);
+
+		// the last one takes the place of the removed one
+		spheres.Remove(0);
+		XTEST_CHECK(report, spheres.Count() == 2);
+		XTEST_CHECK(report, spheres.centerY[0] == 30.f && spheres.centerY[1] == 25.f);
+		spheres.Remove(1);
+		XTEST_CHECK(report, spheres.Count() == 1 && spheres.centerY[0] == 30.f);
+		spheres.Clear();
+		XTEST_CHECK(report, spheres.Count() == 0 && spheres.radius.empty());
+	}
+}
+
+
+void xtest::test::TestCulling(UnitTestReport* report)
+{
+	TestFrustumPlanes(report);
+	TestAgainstReference(report);
+	TestConservative(report);
+	TestSphereArrays(report);
+}
+
@@ -0,0 +1,264 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <render/draw_queue.h>
+#include <render/recording_backend.h>
+#include <numeric>
+#include <random>
+
+
+using xtest::render::ConstantBufferBinding;
+using xtest::render::DrawPacket;
+using xtest::render::DrawQueue;
+using xtest::render::DrawQueueStatistics;
+using xtest::render::RecordedCommand;
+using xtest::render::RecordingBackend;
+using xtest::render::ResourceHandle;
+using xtest::render::ShaderStage;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	typedef RecordedCommand::Type CommandType;
+
+
+	// what the recorded commands leave bound
+	struct BoundState
+	{
+		ResourceHandle pipeline = xtest::render::kNullResource;
+		ResourceHandle vertexBuffer = xtest::render::kNullResource;
+		uint32 vertexStride = 0;
+		ResourceHandle indexBuffer = xtest::render::kNullResource;
+		std::array<ConstantBufferBinding, xtest::render::kConstantBufferSlotCount> vertexConstantBuffers = {};
+		std::array<ConstantBufferBinding, xtest::render::kConstantBufferSlotCount> pixelConstantBuffers = {};
+		std::array<ResourceHandle, xtest::render::kTextureSlotCount> textures = {};
+	};
+
+
+	// every resource of the packet is the bound one, the slots it leaves empty can have anything
+	bool IsPacketBound(const DrawPacket& packet, const BoundState& state)
+	{
+		bool isBound = (packet.pipeline == xtest::render::kNullResource || packet.pipeline == state.pipeline)
+			&& (packet.vertexBuffer == xtest::render::kNullResource || (packet.vertexBuffer == state.vertexBuffer && packet.vertexStride == state.vertexStride))
+			&& (packet.indexBuffer == xtest::render::kNullResource || packet.indexBuffer == state.indexBuffer);
+		for (uint32 slot = 0; slot < xtest::render::kConstantBufferSlotCount; slot++)
+		{
+			isBound = isBound && (packet.vertexConstantBuffers[slot].buffer == xtest::render::kNullResource || packet.vertexConstantBuffers[slot] == state.vertexConstantBuffers[slot]);
+			isBound = isBound && (packet.pixelConstantBuffers[slot].buffer == xtest::render::kNullResource || packet.pixelConstantBuffers[slot] == state.pixelConstantBuffers[slot]);
+		}
+		for (uint32 slot = 0; slot < xtest::render::kTextureSlotCount; slot++)
+		{
+			isBound = isBound && (packet.textures[slot] == xtest::render::kNullResource || packet.textures[slot] == state.textures[slot]);
+		}
+		return isBound;
+	}
+
+
+	// replays the commands: the draws, identified by their start index, come in the expected order and each one
+	// finds the resources of its packet bound
+	bool ReplaysInOrder(const std::vector<RecordedCommand>& commands, const std::vector<DrawPacket>& packets, const std::vector<uint32>& expectedPacketOrder)
+	{
+		BoundState state;
+		size_t drawIndex = 0;
+		for (const RecordedCommand& command : commands)
+		{
+			switch (command.type)
+			{
+			case CommandType::set_pipeline:
+				state.pipeline = command.resource;
+				break;
+			case CommandType::set_vertex_buffer:
+				state.vertexBuffer = command.resource;
+				state.vertexStride = command.arguments[0];
+				break;
+			case CommandType::set_index_buffer:
+				state.indexBuffer = command.resource;
+				break;
+			case CommandType::set_constant_buffer:
+				(command.stage == ShaderStage::vertex ? state.vertexConstantBuffers : state.pixelConstantBuffers)[command.slot] = { command.resource, command.arguments[0], command.arguments[1] };
+				break;
+			case CommandType::set_texture:
+				state.textures[command.slot] = command.resource;
+				break;
+			case CommandType::draw_indexed:
+				if (drawIndex == expectedPacketOrder.size() || command.arguments[1] != expectedPacketOrder[drawIndex]
+					|| !IsPacketBound(packets[expectedPacketOrder[drawIndex]], state))
+				{
+					return false;
+				}
+				drawIndex++;
+				break;
+			default:
+				return false;
+			}
+		}
+		return drawIndex == expectedPacketOrder.size();
+	}
+
+
+	uint32 NonNullResourceCount(const DrawPacket& packet)
+	{
+		uint32 count = (packet.pipeline != xtest::render::kNullResource ? 1 : 0) + (packet.vertexBuffer != xtest::render::kNullResource ? 1 : 0)
+			+ (packet.indexBuffer != xtest::render::kNullResource ? 1 : 0);
+		for (uint32 slot = 0; slot < xtest::render::kConstantBufferSlotCount; slot++)
+		{
+			count += (packet.vertexConstantBuffers[slot].buffer != xtest::render::kNullResource ? 1 : 0) + (packet.pixelConstantBuffers[slot].buffer != xtest::render::kNullResource ? 1 : 0);
+		}
+		for (ResourceHandle texture : packet.textures)
+		{
+			count += texture != xtest::render::kNullResource ? 1 : 0;
+		}
+		return count;
+	}
+
+
+	// resources from small pools so that consecutive draws often share them, some slots empty; the start index
+	// tells the draws apart
+	DrawPacket RandomPacket(uint32 packetIndex, std::mt19937* random)
+	{
+		std::uniform_int_distribution<uint32> resource(0, 3);
+		DrawPacket packet;
+		packet.pipeline = 1 + resource(*random);
+		packet.vertexBuffer = 100 + resource(*random);
+		packet.vertexStride = resource(*random) == 0 ? 16 : 32;
+		packet.indexBuffer = resource(*random) == 0 ? xtest::render::kNullResource : 200 + resource(*random);
+		packet.vertexConstantBuffers[0] = { 300, 256 * resource(*random), 256 };
+		packet.pixelConstantBuffers[1] = resource(*random) == 0 ? ConstantBufferBinding() : ConstantBufferBinding{ 301, 0, 0 };
+		packet.textures[0] = 400 + resource(*random);
+		packet.textures[2] = resource(*random) < 2 ? xtest::render::kNullResource : 410 + resource(*random);
+		packet.indexCount = 3;
+		packet.startIndex = packetIndex;
+		return packet;
+	}
+
+
+	// keys whose bytes vary only where the mask has a bit, with few values so that many keys are equal
+	std::vector<uint64> RandomKeys(uint32 count, uint32 varyingByteMask, std::mt19937* random)
+	{
+		const uint64 constantBytes = 0x5a3c96e1f00f1234ull;
+		std::vector<uint64> keys;
+		for (uint32 index = 0; index < count; index++)
+		{
+			uint64 key = constantBytes;
+			for (uint32 byte = 0; byte < 8; byte++)
+			{
+				if (varyingByteMask & (1u << byte))
+				{
+					key = (key & ~(0xffull << (8 * byte))) | (uint64((*random)() % 5 * 61) << (8 * byte));
+				}
+			}
+			keys.push_back(key);
+		}
+		return keys;
+	}
+
+
+	void TestSortOrder(UnitTestReport* report)
+	{
+		// no byte varying, every pass is skipped and the order is the one of Add; a single one, at either end;
+		// an odd and an even number of passes; all of them
+		std::mt19937 random(22);
+		for (uint32 varyingByteMask : { 0x00u, 0x01u, 0x80u, 0x81u, 0x1cu, 0x5au, 0x7fu, 0xffu })
+		{
+			for (uint32 drawCount : { 0u, 1u, 2u, 1000u })
+			{
+				const std::vector<uint64> keys = RandomKeys(drawCount, varyingByteMask, &random);
+				std::vector<DrawPacket> packets;
+				DrawQueue queue;
+				for (uint32 index = 0; index < drawCount; index++)
+				{
+					packets.push_back(RandomPacket(index, &random));
+					queue.Add(keys[index], packets.back());
+				}
+				queue.Sort();
+
+				std::vector<uint32> expectedPacketOrder(drawCount);
+				std::iota(expectedPacketOrder.begin(), expectedPacketOrder.end(), 0);
+				std::stable_sort(expectedPacketOrder.begin(), expectedPacketOrder.end(), [&keys](uint32 a, uint32 b) { return keys[a] < keys[b]; });
+
+				RecordingBackend backend;
+				queue.Execute(&backend);
+				XTEST_CHECK(report, queue.Count() == drawCount && ReplaysInOrder(backend.Commands(), packets, expectedPacketOrder));
+
+				// sorting again changes nothing
+				queue.Sort();
+				backend.Reset();
+				queue.Execute(&backend);
+				XTEST_CHECK(report, ReplaysInOrder(backend.Commands(), packets, expectedPacketOrder));
+			}
+		}
+
+		// the keys of the fields sort the draws by pass, pipeline, texture set and depth
+		XTEST_CHECK(report, xtest::render::MakeSortKey(1, 0, 0, 0) > xtest::render::MakeSortKey(0, (1u << xtest::render::kSortKeyPipelineBits) - 1, 0, xtest::render::kMaxDepthBucket));
+		XTEST_CHECK(report, xtest::render::MakeSortKey(0, 2, 0, 0) > xtest::render::MakeSortKey(0, 1, (1u << xtest::render::kSortKeyTextureSetBits) - 1, 0));
+		XTEST_CHECK(report, xtest::render::MakeSortKey(0, 1, 2, 0) > xtest::render::MakeSortKey(0, 1, 1, xtest::render::kMaxDepthBucket));
+		XTEST_CHECK(report, xtest::render::DepthBucket(0.5f, 1.f, 100.f) == 0 && xtest::render::DepthBucket(200.f, 1.f, 100.f) == xtest::render::kMaxDepthBucket);
+		XTEST_CHECK(report, xtest::render::DepthBucket(10.f, 1.f, 100.f) < xtest::render::DepthBucket(20.f, 1.f, 100.f));
+	}
+
+
+	void TestElidedBinds(UnitTestReport* report)
+	{
+		DrawPacket packet;
+		packet.pipeline = 1;
+		packet.vertexBuffer = 2;
+		packet.vertexStride = 32;
+		packet.indexBuffer = 3;
+		packet.vertexConstantBuffers[0] = { 4, 0, 256 };
+		packet.textures[0] = 5;
+		packet.indexCount = 3;
+
+		// the same packet twice: the second one only draws
+		DrawQueue queue;
+		queue.Add(0, packet);
+		queue.Add(0, packet);
+
+		// the same vertex buffer with another stride is bound again, an empty slot is neither bound nor elided
+		DrawPacket otherStridePacket = packet;
+		otherStridePacket.vertexStride = 16;
+		otherStridePacket.textures[0] = xtest::render::kNullResource;
+		queue.Add(0, otherStridePacket);
+
+		RecordingBackend backend;
+		queue.Execute(&backend);
+		const DrawQueueStatistics statistics = queue.Statistics();
+		XTEST_CHECK(report, statistics.drawCount == 3);
+		XTEST_CHECK(report, statistics.bindCount == 6 && statistics.elidedBindCount == 8);
+		XTEST_CHECK(report, backend.CommandCount(CommandType::set_vertex_buffer) == 2 && backend.CommandCount(CommandType::set_texture) == 1);
+
+		// random streams sorted by pipeline and texture: every non empty slot of a packet is either bound or elided,
+		// and the binds are the commands the backend got
+		std::mt19937 random(7);
+		DrawQueue randomQueue;
+		uint32 resourceCount = 0;
+		for (uint32 index = 0; index < 5000; index++)
+		{
+			const DrawPacket randomPacket = RandomPacket(index, &random);
+			randomQueue.Add(xtest::render::MakeSortKey(0, randomPacket.pipeline, randomPacket.textures[0], random() % 1000), randomPacket);
+			resourceCount += NonNullResourceCount(randomPacket);
+		}
+		randomQueue.Sort();
+
+		backend.Reset();
+		randomQueue.Execute(&backend);
+		const DrawQueueStatistics randomStatistics = randomQueue.Statistics();
+		XTEST_CHECK(report, randomStatistics.drawCount == 5000 && backend.CommandCount(CommandType::draw_indexed) == 5000);
+		XTEST_CHECK(report, randomStatistics.bindCount == backend.CommandCount() - 5000);
+		XTEST_CHECK(report, randomStatistics.bindCount + randomStatistics.elidedBindCount == resourceCount);
+		XTEST_CHECK(report, randomStatistics.elidedBindCount > randomStatistics.bindCount);
+
+		// Clear empties the queue, the statistics stay the ones of the last Execute
+		randomQueue.Clear();
+		XTEST_CHECK(report, randomQueue.Count() == 0 && randomQueue.Statistics().drawCount == 5000);
+		backend.Reset();
+		randomQueue.Execute(&backend);
+		XTEST_CHECK(report, backend.CommandCount() == 0 && randomQueue.Statistics().drawCount == 0 && randomQueue.Statistics().bindCount == 0);
+	}
+}
+
+
+void xtest::test::TestDrawQueue(UnitTestReport* report)
+{
+	TestSortOrder(report);
+	TestElidedBinds(report);
+}
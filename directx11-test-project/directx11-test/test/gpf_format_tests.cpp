@@ -0,0 +1,322 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <file/gpf_format.h>
+#include <file/gpf_writer.h>
+#include <mesh/mesh_generator.h>
+#include <fstream>
+#include <iterator>
+
+
+using xtest::file::GPFFileHeader;
+using xtest::file::GPFIndexBlock;
+using xtest::file::GPFIndexEncoding;
+using xtest::file::GPFLayout;
+using xtest::file::GPFMeshHeader;
+using xtest::file::GPFSectionEntry;
+using xtest::file::GPFSectionType;
+using xtest::file::GPFWriter;
+using xtest::mesh::MeshData;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	// a box and a smaller one, the indices of both are local to their vertices
+	struct TestMeshes
+	{
+		std::vector<GPFMeshHeader> meshHeaders;
+		MeshData meshData;
+	};
+
+
+	TestMeshes MakeTestMeshes()
+	{
+		TestMeshes meshes;
+		for (const MeshData& box : { xtest::mesh::GenerateBox(1.f, 2.f, 3.f), xtest::mesh::GenerateBox(0.5f, 0.5f, 0.5f) })
+		{
+			GPFMeshHeader meshHeader;
+			meshHeader.vertexCount = uint32(box.vertices.size());
+			meshHeader.indexCount = uint32(box.indices.size());
+			meshHeader.vertexOffset = uint32(meshes.meshData.vertices.size());
+			meshHeader.indexOffset = uint32(meshes.meshData.indices.size());
+			meshes.meshHeaders.push_back(meshHeader);
+
+			meshes.meshData.vertices.insert(meshes.meshData.vertices.end(), box.vertices.begin(), box.vertices.end());
+			meshes.meshData.indices.insert(meshes.meshData.indices.end(), box.indices.begin(), box.indices.end());
+		}
+		return meshes;
+	}
+
+
+	// the writer only writes files, the bytes come back through a temporary one
+	std::string WriteToMemory(const GPFWriter& writer)
+	{
+		const std::wstring filePath(L"gpf_format_tests.gpf");
+		writer.WriteOnDisk(filePath);
+
+		std::string file;
+		{
+			std::ifstream fileStream(filePath.c_str(), std::ifstream::binary);
+			file.assign(std::istreambuf_iterator<char>(fileStream), std::istreambuf_iterator<char>());
+		}
+		DeleteFileW(filePath.c_str());
+		return file;
+	}
+
+
+	// the v1 layout: the mesh count, the mesh headers, the vertices and the indices back to back
+	std::string MakeV1File(const TestMeshes& meshes)
+	{
+		const int32 meshCount = int32(meshes.meshHeaders.size());
+		std::string file(reinterpret_cast<const char*>(&meshCount), sizeof(int32));
+		file.append(reinterpret_cast<const char*>(meshes.meshHeaders.data()), sizeof(GPFMeshHeader) * meshes.meshHeaders.size());
+		file.append(reinterpret_cast<const char*>(meshes.meshData.vertices.data()), sizeof(MeshData::Vertex) * meshes.meshData.vertices.size());
+		file.append(reinterpret_cast<const char*>(meshes.meshData.indices.data()), sizeof(uint32) * meshes.meshData.indices.size());
+		return file;
+	}
+
+
+	// a copy of a file in 8 bytes aligned memory, like a mapped or read one, to be broken before parsing it
+	class GPFBuffer
+	{
+	public:
+
+		explicit GPFBuffer(const std::string& file, uint64 byteSize = UINT64_MAX)
+			: m_words((file.size() + sizeof(uint64) - 1) / sizeof(uint64), 0)
+			, m_byteSize(std::min<uint64>(file.size(), byteSize))
+		{
+			std::memcpy(m_words.data(), file.data(), file.size());
+		}
+
+		bool Parse(GPFLayout* layout) const
+		{
+			return xtest::file::ParseGPFLayout(reinterpret_cast<const char*>(m_words.data()), m_byteSize, layout);
+		}
+
+		bool Parse() const
+		{
+			GPFLayout layout;
+			return Parse(&layout);
+		}
+
+		template <typename T>
+		T* At(uint64 byteOffset)
+		{
+			return reinterpret_cast<T*>(reinterpret_cast<char*>(m_words.data()) + byteOffset);
+		}
+
+		GPFFileHeader* FileHeader()
+		{
+			return At<GPFFileHeader>(0);
+		}
+
+		GPFSectionEntry* Section(GPFSectionType type)
+		{
+			GPFSectionEntry* sections = At<GPFSectionEntry>(FileHeader()->sectionTableOffset);
+			return std::find_if(sections, sections + FileHeader()->sectionCount, [type](const GPFSectionEntry& section) { return section.type == type; });
+		}
+
+	private:
+
+		std::vector<uint64> m_words;
+		uint64 m_byteSize;
+	};
+
+
+	void TestValidFiles(UnitTestReport* report, const std::string& v2File, const std::string& encodedFile, const std::string& v1File)
+	{
+		const TestMeshes meshes = MakeTestMeshes();
+		const uint32 vertexCount = uint32(meshes.meshData.vertices.size());
+		const uint32 indexCount = uint32(meshes.meshData.indices.size());
+
+		// the layouts point into the buffers
+		const GPFBuffer v2Buffer(v2File);
+		const GPFBuffer encodedBuffer(encodedFile);
+		const GPFBuffer v1Buffer(v1File);
+
+		GPFLayout layout;
+		XTEST_CHECK(report, v2Buffer.Parse(&layout));
+		XTEST_CHECK(report, layout.version == 2 && layout.meshCount == 2 && layout.vertexCount == vertexCount && layout.indexCount == indexCount);
+		XTEST_CHECK(report, layout.vertices && std::memcmp(layout.vertices, meshes.meshData.vertices.data(), sizeof(MeshData::Vertex) * vertexCount) == 0);
+		XTEST_CHECK(report, layout.indices && std::equal(meshes.meshData.indices.begin(), meshes.meshData.indices.end(), layout.indices));
+
+		XTEST_CHECK(report, encodedBuffer.Parse(&layout));
+		XTEST_CHECK(report, !layout.indices && layout.encodedIndices && layout.indexBlocks && layout.indexCount == indexCount);
+
+		XTEST_CHECK(report, v1Buffer.Parse(&layout));
+		XTEST_CHECK(report, layout.version == 1 && layout.meshCount == 2 && layout.vertexCount == vertexCount && layout.indexCount == indexCount);
+		XTEST_CHECK(report, std::equal(meshes.meshData.indices.begin(), meshes.meshData.indices.end(), layout.indices));
+
+		// an empty section can be anywhere in the file
+		GPFBuffer emptySectionBuffer(v2File);
+		GPFSectionEntry* boundsSection = emptySectionBuffer.Section(GPFSectionType::bounds);
+		boundsSection->offset = emptySectionBuffer.Section(GPFSectionType::vertices)->offset;
+		boundsSection->byteSize = 0;
+		boundsSection->type = GPFSectionType::first_extra;
+		XTEST_CHECK(report, emptySectionBuffer.Parse());
+	}
+
+
+	void TestTruncatedFiles(UnitTestReport* report, const std::string& v2File, const std::string& encodedFile, const std::string& v1File)
+	{
+		// every prefix of the files, the failures leave the layout empty
+		uint32 parsedCount = 0;
+		for (const std::string* file : { &v2File, &encodedFile, &v1File })
+		{
+			for (uint64 byteSize = 0; byteSize < file->size(); byteSize++)
+			{
+				GPFLayout layout;
+				const bool parsed = GPFBuffer(*file, byteSize).Parse(&layout);
+				parsedCount += parsed || layout.meshHeaders || layout.meshCount != 0 ? 1 : 0;
+			}
+		}
+		XTEST_CHECK(report, parsedCount == 0);
+
+		// a file header claiming more bytes than there are
+		GPFBuffer longerBuffer(v2File);
+		longerBuffer.FileHeader()->fileByteSize += xtest::file::kGPFSectionAlignment;
+		XTEST_CHECK(report, !longerBuffer.Parse());
+
+		// the last section past the end of the file, a section smaller than its elements
+		GPFBuffer pastEndBuffer(v2File);
+		pastEndBuffer.Section(GPFSectionType::bounds)->byteSize += xtest::file::kGPFSectionAlignment;
+		XTEST_CHECK(report, !pastEndBuffer.Parse());
+
+		GPFBuffer fewElementsBuffer(v2File);
+		fewElementsBuffer.Section(GPFSectionType::vertices)->elementCount++;
+		XTEST_CHECK(report, !fewElementsBuffer.Parse());
+	}
+
+
+	void TestMisalignedFiles(UnitTestReport* report, const std::string& v2File, const std::string& encodedFile)
+	{
+		GPFBuffer tableBuffer(v2File);
+		tableBuffer.FileHeader()->sectionTableOffset += 8;
+		XTEST_CHECK(report, !tableBuffer.Parse());
+
+		// still inside the file, but off the 64 bytes boundary
+		GPFBuffer sectionBuffer(v2File);
+		sectionBuffer.Section(GPFSectionType::mesh_headers)->offset += xtest::file::kGPFSectionTableAlignment;
+		XTEST_CHECK(report, !sectionBuffer.Parse());
+
+		// the lists of indices aligned to their size
+		GPFBuffer uint32BlockBuffer(encodedFile);
+		uint32BlockBuffer.At<GPFIndexBlock>(uint32BlockBuffer.Section(GPFSectionType::index_blocks)->offset)[0].byteOffset += 2;
+		XTEST_CHECK(report, !uint32BlockBuffer.Parse());
+
+		GPFBuffer uint16BlockBuffer(encodedFile);
+		uint16BlockBuffer.At<GPFIndexBlock>(uint16BlockBuffer.Section(GPFSectionType::index_blocks)->offset)[1].byteOffset += 1;
+		XTEST_CHECK(report, !uint16BlockBuffer.Parse());
+	}
+
+
+	void TestOverlappingFiles(UnitTestReport* report, const std::string& v2File)
+	{
+		// the section table over the file header
+		GPFBuffer tableBuffer(v2File);
+		tableBuffer.FileHeader()->sectionTableOffset = 0;
+		XTEST_CHECK(report, !tableBuffer.Parse());
+
+		// a section over the section table, which starts on a 64 bytes boundary right after the file header
+		GPFBuffer overTableBuffer(v2File);
+		overTableBuffer.Section(GPFSectionType::indices)->offset = overTableBuffer.FileHeader()->sectionTableOffset;
+		XTEST_CHECK(report, !overTableBuffer.Parse());
+
+		// two sections at the same offset, and a section running into the next one
+		GPFBuffer sameOffsetBuffer(v2File);
+		sameOffsetBuffer.Section(GPFSectionType::indices)->offset = sameOffsetBuffer.Section(GPFSectionType::vertices)->offset;
+		XTEST_CHECK(report, !sameOffsetBuffer.Parse());
+
+		GPFBuffer intoNextBuffer(v2File);
+		GPFSectionEntry* headerSection = intoNextBuffer.Section(GPFSectionType::mesh_headers);
+		headerSection->byteSize = intoNextBuffer.Section(GPFSectionType::vertices)->offset - headerSection->offset + 1;
+		XTEST_CHECK(report, !intoNextBuffer.Parse());
+	}
+
+
+	void TestWrappingFiles(UnitTestReport* report, const std::string& v2File, const std::string& encodedFile, const std::string& v1File)
+	{
+		// offsets and sizes whose sums wrap past 2^64 back inside the file
+		GPFBuffer sectionOffsetBuffer(v2File);
+		sectionOffsetBuffer.Section(GPFSectionType::vertices)->offset = UINT64_MAX - (xtest::file::kGPFSectionAlignment - 1);
+		sectionOffsetBuffer.Section(GPFSectionType::vertices)->byteSize = 2 * xtest::file::kGPFSectionAlignment;
+		XTEST_CHECK(report, !sectionOffsetBuffer.Parse());
+
+		GPFBuffer sectionSizeBuffer(v2File);
+		sectionSizeBuffer.Section(GPFSectionType::vertices)->byteSize = UINT64_MAX;
+		XTEST_CHECK(report, !sectionSizeBuffer.Parse());
+
+		GPFBuffer tableOffsetBuffer(v2File);
+		tableOffsetBuffer.FileHeader()->sectionTableOffset = UINT64_MAX - (xtest::file::kGPFSectionTableAlignment - 1);
+		XTEST_CHECK(report, !tableOffsetBuffer.Parse());
+
+		GPFBuffer sectionCountBuffer(v2File);
+		sectionCountBuffer.FileHeader()->sectionCount = UINT32_MAX;
+		XTEST_CHECK(report, !sectionCountBuffer.Parse());
+
+		GPFBuffer indexBlockBuffer(encodedFile);
+		GPFIndexBlock* indexBlock = indexBlockBuffer.At<GPFIndexBlock>(indexBlockBuffer.Section(GPFSectionType::index_blocks)->offset);
+		indexBlock->byteOffset = UINT64_MAX - 3;
+		indexBlock->byteSize = 8;
+		XTEST_CHECK(report, !indexBlockBuffer.Parse());
+
+		// the 32 bits ranges of the meshes
+		GPFBuffer meshOffsetBuffer(v2File);
+		GPFMeshHeader* meshHeader = meshOffsetBuffer.At<GPFMeshHeader>(meshOffsetBuffer.Section(GPFSectionType::mesh_headers)->offset);
+		meshHeader->vertexOffset = UINT32_MAX;
+		XTEST_CHECK(report, !meshOffsetBuffer.Parse());
+
+		GPFBuffer v1MeshOffsetBuffer(v1File);
+		v1MeshOffsetBuffer.At<GPFMeshHeader>(sizeof(int32))[1].indexOffset = UINT32_MAX - 1;
+		XTEST_CHECK(report, !v1MeshOffsetBuffer.Parse());
+
+		// counts whose totals don't fit 32 bits, a negative mesh count
+		GPFBuffer v1MeshCountBuffer(v1File);
+		v1MeshCountBuffer.At<GPFMeshHeader>(sizeof(int32))[0].vertexCount = UINT32_MAX;
+		XTEST_CHECK(report, !v1MeshCountBuffer.Parse());
+
+		GPFBuffer v1NegativeBuffer(v1File);
+		*v1NegativeBuffer.At<int32>(0) = -1;
+		XTEST_CHECK(report, !v1NegativeBuffer.Parse());
+	}
+}
+
+
+void xtest::test::TestGPFFormat(UnitTestReport* report)
+{
+	const TestMeshes meshes = MakeTestMeshes();
+
+	// with the bounds, so that an extra section can be moved around
+	GPFWriter writer(meshes.meshHeaders, meshes.meshData);
+	const std::vector<xtest::mesh::MeshBounds> bounds(meshes.meshHeaders.size());
+	writer.AddSection(GPFSectionType::bounds, bounds);
+	const std::string v2File = WriteToMemory(writer);
+
+	// the indices of the first mesh as a uint32 list, those of the second one as a uint16 list right after them
+	std::vector<uint8> encodedIndices(sizeof(uint32) * meshes.meshHeaders[0].indexCount);
+	std::memcpy(encodedIndices.data(), meshes.meshData.indices.data(), encodedIndices.size());
+	std::vector<GPFIndexBlock> indexBlocks(2);
+	indexBlocks[0].byteSize = encodedIndices.size();
+	indexBlocks[1].encoding = GPFIndexEncoding::uint16_list;
+	indexBlocks[1].byteOffset = encodedIndices.size();
+	indexBlocks[1].byteSize = sizeof(uint16) * meshes.meshHeaders[1].indexCount;
+	for (uint32 index = 0; index < meshes.meshHeaders[1].indexCount; index++)
+	{
+		const uint16 narrowIndex = uint16(meshes.meshData.indices[meshes.meshHeaders[1].indexOffset + index]);
+		encodedIndices.insert(encodedIndices.end(), reinterpret_cast<const uint8*>(&narrowIndex), reinterpret_cast<const uint8*>(&narrowIndex) + sizeof(uint16));
+	}
+
+	GPFWriter encodedWriter(meshes.meshHeaders, meshes.meshData);
+	encodedWriter.RemoveSection(GPFSectionType::indices);
+	encodedWriter.AddSection(GPFSectionType::encoded_indices, encodedIndices);
+	encodedWriter.AddSection(GPFSectionType::index_blocks, indexBlocks);
+	const std::string encodedFile = WriteToMemory(encodedWriter);
+
+	const std::string v1File = MakeV1File(meshes);
+
+	TestValidFiles(report, v2File, encodedFile, v1File);
+	TestTruncatedFiles(report, v2File, encodedFile, v1File);
+	TestMisalignedFiles(report, v2File, encodedFile);
+	TestOverlappingFiles(report, v2File);
+	TestWrappingFiles(report, v2File, encodedFile, v1File);
+}
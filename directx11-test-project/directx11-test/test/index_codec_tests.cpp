@@ -0,0 +1,255 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <file/gpf_indices.h>
+#include <mesh/index_codec.h>
+#include <random>
+
+
+using xtest::file::GPFEncodedIndices;
+using xtest::file::GPFIndexBlock;
+using xtest::file::GPFIndexEncoding;
+using xtest::file::GPFMeshHeader;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	// the codec can rotate a triangle, never change its winding
+	bool IsSameTriangleList(const std::vector<uint32>& indices, const std::vector<uint32>& decodedIndices)
+	{
+		if (indices.size() != decodedIndices.size())
+		{
+			return false;
+		}
+
+		for (size_t index = 0; index + 2 < indices.size(); index += 3)
+		{
+			bool isRotation = false;
+			for (size_t rotation = 0; rotation < 3; rotation++)
+			{
+				isRotation = isRotation || (decodedIndices[index] == indices[index + rotation]
+					&& decodedIndices[index + 1] == indices[index + (rotation + 1) % 3]
+					&& decodedIndices[index + 2] == indices[index + (rotation + 2) % 3]);
+			}
+			if (!isRotation)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	bool RoundTrips(const std::vector<uint32>& indices)
+	{
+		const std::vector<uint8> data = xtest::mesh::EncodeIndices(indices.data(), indices.size());
+		std::vector<uint32> decodedIndices(indices.size());
+		return xtest::mesh::DecodeIndices(data.data(), data.size(), decodedIndices.data(), decodedIndices.size())
+			&& IsSameTriangleList(indices, decodedIndices);
+	}
+
+
+	// the two triangles of every cell of a grid of columnCount x rowCount cells, row by row
+	std::vector<uint32> MakeGridIndices(uint32 columnCount, uint32 rowCount)
+	{
+		std::vector<uint32> indices;
+		for (uint32 row = 0; row < rowCount; row++)
+		{
+			for (uint32 column = 0; column < columnCount; column++)
+			{
+				const uint32 v0 = row * (columnCount + 1) + column;
+				const uint32 v1 = v0 + 1;
+				const uint32 v2 = v0 + columnCount + 1;
+				const uint32 v3 = v2 + 1;
+				indices.insert(indices.end(), { v0, v2, v1, v1, v2, v3 });
+			}
+		}
+		return indices;
+	}
+
+
+	void TestRoundTrip(UnitTestReport* report)
+	{
+		XTEST_CHECK(report, RoundTrips({}));
+		XTEST_CHECK(report, RoundTrips({ 0, 1, 2 }));
+		XTEST_CHECK(report, RoundTrips({ 7, 3, 1000000, UINT32_MAX - 1, 0, 5 }));
+
+		// the triangles of a grid share an edge with a recent one almost always, the stream is less than a
+		// quarter of the uint32 indices
+		const std::vector<uint32> gridIndices = MakeGridIndices(64, 64);
+		const std::vector<uint8> gridData = xtest::mesh::EncodeIndices(gridIndices.data(), gridIndices.size());
+		XTEST_CHECK(report, RoundTrips(gridIndices));
+		XTEST_CHECK(report, gridData.size() < gridIndices.size() * sizeof(uint32) / 4);
+
+		// random triangles over small and large vertex counts, and random triangles of a grid
+		std::mt19937 random(11);
+		for (uint32 vertexCount : { 3u, 17u, 1000u, 100000u, UINT32_MAX })
+		{
+			std::uniform_int_distribution<uint32> vertex(0, vertexCount - 1);
+			std::vector<uint32> indices(3 * 5000);
+			std::generate(indices.begin(), indices.end(), [&random, &vertex]() { return vertex(random); });
+			XTEST_CHECK(report, RoundTrips(indices));
+		}
+
+		std::vector<uint32> shuffledGridIndices;
+		std::vector<uint32> triangleOrder(gridIndices.size() / 3);
+		for (uint32 triangle = 0; triangle < triangleOrder.size(); triangle++)
+		{
+			triangleOrder[triangle] = triangle;
+		}
+		std::shuffle(triangleOrder.begin(), triangleOrder.end(), random);
+		for (uint32 triangle : triangleOrder)
+		{
+			shuffledGridIndices.insert(shuffledGridIndices.end(), gridIndices.begin() + 3 * triangle, gridIndices.begin() + 3 * triangle + 3);
+		}
+		XTEST_CHECK(report, RoundTrips(shuffledGridIndices));
+	}
+
+
+	void TestDegenerateTriangles(UnitTestReport* report)
+	{
+		// repeated vertices are rotated like any other, a triangle made of one vertex is kept as it is
+		XTEST_CHECK(report, RoundTrips({ 0, 0, 0 }));
+		XTEST_CHECK(report, RoundTrips({ 0, 0, 1, 1, 0, 0, 2, 2, 2 }));
+		XTEST_CHECK(report, RoundTrips({ 0, 1, 2, 2, 1, 1, 1, 2, 2, 5, 5, 5, 0, 1, 2 }));
+
+		std::vector<uint32> indices = MakeGridIndices(8, 8);
+		for (size_t index = 0; index + 2 < indices.size(); index += 9)
+		{
+			indices[index + 1] = indices[index];
+		}
+		XTEST_CHECK(report, RoundTrips(indices));
+	}
+
+
+	void TestMalformedStreams(UnitTestReport* report)
+	{
+		const std::vector<uint32> indices = MakeGridIndices(16, 16);
+		const std::vector<uint8> data = xtest::mesh::EncodeIndices(indices.data(), indices.size());
+		std::vector<uint32> decodedIndices(indices.size());
+
+		// every triangle takes at least a byte, a truncated stream never decodes
+		uint32 decodedPrefixCount = 0;
+		for (size_t byteSize = 0; byteSize < data.size(); byteSize++)
+		{
+			decodedPrefixCount += xtest::mesh::DecodeIndices(data.data(), byteSize, decodedIndices.data(), decodedIndices.size()) ? 1 : 0;
+		}
+		XTEST_CHECK(report, decodedPrefixCount == 0);
+
+		// extra bytes, a count that doesn't match the stream or is not a multiple of 3, another version
+		std::vector<uint8> longerData = data;
+		longerData.push_back(0);
+		XTEST_CHECK(report, !xtest::mesh::DecodeIndices(longerData.data(), longerData.size(), decodedIndices.data(), decodedIndices.size()));
+		XTEST_CHECK(report, !xtest::mesh::DecodeIndices(data.data(), data.size(), decodedIndices.data(), decodedIndices.size() - 3));
+		XTEST_CHECK(report, !xtest::mesh::DecodeIndices(data.data(), data.size(), decodedIndices.data(), decodedIndices.size() - 1));
+		std::vector<uint8> otherVersionData = data;
+		otherVersionData[0]++;
+		XTEST_CHECK(report, !xtest::mesh::DecodeIndices(otherVersionData.data(), otherVersionData.size(), decodedIndices.data(), decodedIndices.size()));
+
+		// a varint longer than 5 bytes, after a triangle with 3 explicit vertices
+		const std::vector<uint8> longVarint = { data[0], 0xff, 0xff, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00 };
+		XTEST_CHECK(report, !xtest::mesh::DecodeIndices(longVarint.data(), longVarint.size(), decodedIndices.data(), 3));
+
+		// any byte changed decodes to something else or fails, but never writes past the indices
+		std::mt19937 random(5);
+		std::uniform_int_distribution<size_t> position(1, data.size() - 1);
+		std::vector<uint32> guardedIndices(indices.size() + 1, UINT32_MAX - 7);
+		for (uint32 corruption = 0; corruption < 1000; corruption++)
+		{
+			std::vector<uint8> corruptData = data;
+			corruptData[position(random)] ^= uint8(1 + corruption % 255);
+			xtest::mesh::DecodeIndices(corruptData.data(), corruptData.size(), guardedIndices.data(), indices.size());
+		}
+		XTEST_CHECK(report, guardedIndices.back() == UINT32_MAX - 7);
+	}
+
+
+	GPFMeshHeader MakeMeshHeader(uint32 vertexCount, uint32 indexCount, uint32 indexOffset)
+	{
+		GPFMeshHeader meshHeader;
+		meshHeader.vertexCount = vertexCount;
+		meshHeader.indexCount = indexCount;
+		meshHeader.indexOffset = indexOffset;
+		return meshHeader;
+	}
+
+
+	void TestGPFNarrowing(UnitTestReport* report)
+	{
+		// the largest index of 16 bits is narrowed, a mesh with one more vertex keeps its uint32 indices
+		const std::vector<uint32> indices = { 0, 65535, 1, 65534, 65535, 0, 0, 65536, 1 };
+		const std::vector<GPFMeshHeader> meshHeaders = { MakeMeshHeader(65536, 6, 0), MakeMeshHeader(65537, 3, 6) };
+		for (bool compress : { false, true })
+		{
+			const GPFEncodedIndices encodedIndices = xtest::file::EncodeGPFIndices(meshHeaders, indices, compress);
+			XTEST_CHECK(report, encodedIndices.blocks.size() == 2);
+			XTEST_CHECK(report, encodedIndices.blocks[0].encoding == (compress ? GPFIndexEncoding::fifo_codec : GPFIndexEncoding::uint16_list));
+			XTEST_CHECK(report, encodedIndices.blocks[1].encoding == (compress ? GPFIndexEncoding::fifo_codec : GPFIndexEncoding::uint32_list));
+			XTEST_CHECK(report, compress || encodedIndices.blocks[0].byteSize == 6 * sizeof(uint16));
+			XTEST_CHECK(report, compress || encodedIndices.blocks[1].byteOffset % sizeof(uint32) == 0);
+
+			std::vector<uint32> decodedIndices(indices.size());
+			for (size_t mesh = 0; mesh < meshHeaders.size(); mesh++)
+			{
+				const GPFMeshHeader& meshHeader = meshHeaders[mesh];
+				XTEST_CHECK(report, xtest::file::DecodeGPFIndices(encodedIndices.data.data(), encodedIndices.blocks[mesh], meshHeader.indexCount,
+					meshHeader.vertexCount, decodedIndices.data() + meshHeader.indexOffset));
+			}
+			XTEST_CHECK(report, IsSameTriangleList(indices, decodedIndices));
+		}
+
+		std::vector<uint16> narrowIndices(3);
+		std::vector<uint32> wideIndices(3);
+		const uint32 boundaryIndices[] = { 0, 65534, 65535 };
+		xtest::mesh::NarrowIndices(boundaryIndices, 3, narrowIndices.data());
+		xtest::mesh::WidenIndices(narrowIndices.data(), 3, wideIndices.data());
+		XTEST_CHECK(report, std::equal(wideIndices.begin(), wideIndices.end(), boundaryIndices));
+	}
+
+
+	void TestGPFIndexRange(UnitTestReport* report)
+	{
+		// an index not less than the vertex count is refused, whatever the encoding
+		const std::vector<uint32> indices = { 0, 1, 2, 2, 1, 3 };
+		const std::vector<GPFMeshHeader> meshHeaders = { MakeMeshHeader(4, 6, 0) };
+		std::vector<uint32> decodedIndices(indices.size());
+		for (bool compress : { false, true })
+		{
+			const GPFEncodedIndices encodedIndices = xtest::file::EncodeGPFIndices(meshHeaders, indices, compress);
+			XTEST_CHECK(report, xtest::file::DecodeGPFIndices(encodedIndices.data.data(), encodedIndices.blocks[0], 6, 4, decodedIndices.data()));
+			XTEST_CHECK(report, !xtest::file::DecodeGPFIndices(encodedIndices.data.data(), encodedIndices.blocks[0], 6, 3, decodedIndices.data()));
+		}
+
+		GPFIndexBlock listBlock;
+		listBlock.encoding = GPFIndexEncoding::uint32_list;
+		listBlock.byteSize = indices.size() * sizeof(uint32);
+		const uint8* listData = reinterpret_cast<const uint8*>(indices.data());
+		XTEST_CHECK(report, xtest::file::DecodeGPFIndices(listData, listBlock, 6, 4, decodedIndices.data()));
+		XTEST_CHECK(report, !xtest::file::DecodeGPFIndices(listData, listBlock, 6, 3, decodedIndices.data()));
+		XTEST_CHECK(report, !xtest::file::DecodeGPFIndices(listData, listBlock, 3, 4, decodedIndices.data()));
+		listBlock.encoding = GPFIndexEncoding(7);
+		XTEST_CHECK(report, !xtest::file::DecodeGPFIndices(listData, listBlock, 6, 4, decodedIndices.data()));
+
+		// an edge code pointing at an empty slot of the edge fifo decodes to UINT32_MAX, the range check catches it
+		const uint8 emptyEdgeData[] = { xtest::mesh::EncodeIndices(nullptr, 0)[0], 0x00 };
+		XTEST_CHECK(report, xtest::mesh::DecodeIndices(emptyEdgeData, sizeof(emptyEdgeData), decodedIndices.data(), 3));
+		XTEST_CHECK(report, decodedIndices[0] == UINT32_MAX);
+
+		GPFIndexBlock codecBlock;
+		codecBlock.encoding = GPFIndexEncoding::fifo_codec;
+		codecBlock.byteSize = sizeof(emptyEdgeData);
+		XTEST_CHECK(report, !xtest::file::DecodeGPFIndices(emptyEdgeData, codecBlock, 3, 4, decodedIndices.data()));
+		XTEST_CHECK(report, xtest::file::AreGPFIndicesInRange(indices.data(), 6, 4));
+		XTEST_CHECK(report, !xtest::file::AreGPFIndicesInRange(indices.data(), 6, 3));
+	}
+}
+
+
+void xtest::test::TestIndexCodec(UnitTestReport* report)
+{
+	TestRoundTrip(report);
+	TestDegenerateTriangles(report);
+	TestMalformedStreams(report);
+	TestGPFNarrowing(report);
+	TestGPFIndexRange(report);
+}
@@ -0,0 +1,108 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <mesh/mesh_bounds.h>
+#include <mesh/mesh_generator.h>
+
+
+using xtest::mesh::MeshBounds;
+using xtest::mesh::MeshData;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	bool Equal(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+	{
+		return a.x == b.x && a.y == b.y && a.z == b.z;
+	}
+
+
+	bool Equal(const MeshBounds& bounds, const MeshBounds& otherBounds)
+	{
+		return Equal(bounds.boxMin, otherBounds.boxMin) && Equal(bounds.boxMax, otherBounds.boxMax)
+			&& Equal(bounds.sphereCenter, otherBounds.sphereCenter) && bounds.sphereRadius == otherBounds.sphereRadius;
+	}
+
+
+	bool Encloses(const MeshBounds& bounds, const MeshBounds& innerBounds)
+	{
+		const float centerDistance = std::sqrt(
+			(innerBounds.sphereCenter.x - bounds.sphereCenter.x) * (innerBounds.sphereCenter.x - bounds.sphereCenter.x) +
+			(innerBounds.sphereCenter.y - bounds.sphereCenter.y) * (innerBounds.sphereCenter.y - bounds.sphereCenter.y) +
+			(innerBounds.sphereCenter.z - bounds.sphereCenter.z) * (innerBounds.sphereCenter.z - bounds.sphereCenter.z));
+		return bounds.boxMin.x <= innerBounds.boxMin.x && bounds.boxMin.y <= innerBounds.boxMin.y && bounds.boxMin.z <= innerBounds.boxMin.z
+			&& bounds.boxMax.x >= innerBounds.boxMax.x && bounds.boxMax.y >= innerBounds.boxMax.y && bounds.boxMax.z >= innerBounds.boxMax.z
+			&& centerDistance + innerBounds.sphereRadius <= bounds.sphereRadius * (1.f + 1e-6f);
+	}
+
+
+	void TestBoxBounds(UnitTestReport* report)
+	{
+		// the corners of a 2 x 4 x 6 box are the farthest vertices from its center, sqrt(1 + 4 + 9) away
+		const MeshData box = xtest::mesh::GenerateBox(2.f, 4.f, 6.f);
+		XTEST_CHECK(report, Equal(box.bounds.boxMin, { -1.f, -2.f, -3.f }));
+		XTEST_CHECK(report, Equal(box.bounds.boxMax, { 1.f, 2.f, 3.f }));
+		XTEST_CHECK(report, Equal(box.bounds.sphereCenter, { 0.f, 0.f, 0.f }));
+		XTEST_CHECK(report, std::fabs(box.bounds.sphereRadius - std::sqrt(14.f)) <= 1e-6f);
+
+		// the same box moved away from the origin, its largest corner last: in the tail after the groups of 4 lanes
+		// or in the last group
+		MeshData movedBox = box;
+		for (MeshData::Vertex& vertex : movedBox.vertices)
+		{
+			vertex.position = { vertex.position.x + 10.f, vertex.position.y - 20.f, vertex.position.z + 30.f };
+		}
+		const MeshData::Vertex maxCorner = *std::find_if(movedBox.vertices.begin(), movedBox.vertices.end(), [](const MeshData::Vertex& vertex)
+		{
+			return vertex.position.x == 11.f && vertex.position.y == -18.f && vertex.position.z == 33.f;
+		});
+		for (uint32 vertexCount : { 1u, 5u, 6u, 7u, 8u })
+		{
+			std::vector<MeshData::Vertex> vertices(vertexCount - 1, movedBox.vertices[0]);
+			vertices.push_back(maxCorner);
+			const MeshBounds bounds = xtest::mesh::ComputeBounds(vertices.data(), vertexCount);
+			XTEST_CHECK(report, Equal(bounds.boxMax, maxCorner.position));
+		}
+
+		const MeshBounds movedBounds = xtest::mesh::ComputeBounds(movedBox);
+		XTEST_CHECK(report, Equal(movedBounds.boxMin, { 9.f, -22.f, 27.f }) && Equal(movedBounds.boxMax, { 11.f, -18.f, 33.f }));
+		XTEST_CHECK(report, Equal(movedBounds.sphereCenter, { 10.f, -20.f, 30.f }));
+		XTEST_CHECK(report, std::fabs(movedBounds.sphereRadius - std::sqrt(14.f)) <= 1e-5f);
+
+		XTEST_CHECK(report, Equal(xtest::mesh::ComputeBounds(nullptr, 0), MeshBounds()));
+	}
+
+
+	void TestMergeBounds(UnitTestReport* report)
+	{
+		const MeshData box = xtest::mesh::GenerateBox(2.f, 4.f, 6.f);
+		const MeshData sphere = xtest::mesh::GenerateSphere(1.5f, 16, 8, 1);
+		MeshData movedSphere = sphere;
+		for (MeshData::Vertex& vertex : movedSphere.vertices)
+		{
+			vertex.position.x += 8.f;
+		}
+		const MeshBounds meshBounds[] = { box.bounds, xtest::mesh::ComputeBounds(movedSphere) };
+
+		// a single mesh keeps its bounds, none give zero bounds
+		XTEST_CHECK(report, Equal(xtest::mesh::MergeBounds(meshBounds, 1), box.bounds));
+		XTEST_CHECK(report, Equal(xtest::mesh::MergeBounds(nullptr, 0), MeshBounds()));
+
+		// the merged box is the one of all the vertices, the sphere encloses both and the one of all the vertices
+		MeshData boxAndSphere = box;
+		boxAndSphere.vertices.insert(boxAndSphere.vertices.end(), movedSphere.vertices.begin(), movedSphere.vertices.end());
+		const MeshBounds allVerticesBounds = xtest::mesh::ComputeBounds(boxAndSphere);
+		const MeshBounds mergedBounds = xtest::mesh::MergeBounds(meshBounds, 2);
+		XTEST_CHECK(report, Equal(mergedBounds.boxMin, allVerticesBounds.boxMin) && Equal(mergedBounds.boxMax, allVerticesBounds.boxMax));
+		XTEST_CHECK(report, Equal(mergedBounds.sphereCenter, allVerticesBounds.sphereCenter));
+		XTEST_CHECK(report, Encloses(mergedBounds, meshBounds[0]) && Encloses(mergedBounds, meshBounds[1]));
+		XTEST_CHECK(report, mergedBounds.sphereRadius >= allVerticesBounds.sphereRadius);
+	}
+}
+
+
+void xtest::test::TestMeshBounds(UnitTestReport* report)
+{
+	TestBoxBounds(report);
+	TestMergeBounds(report);
+}
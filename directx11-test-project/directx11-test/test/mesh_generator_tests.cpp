@@ -0,0 +1,381 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <math/math_utils.h>
+#include <mesh/mesh_generator.h>
+#include <mesh/mesh_parametric.h>
+
+
+using xtest::mesh::MeshData;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	// the generator evaluates the angles with XMVectorSinCos, an approximation that is not correctly rounded, in
+	// float, whose rounding of the knot angles q * theta grows with q, and sums terms of different magnitude, like
+	// the knot center and its tube: the components close to zero are compared with an absolute epsilon relative
+	// to the size of the mesh, the others within a few ULPs
+	const unsigned int kMaxULPDistance = 16;
+	const float kAbsoluteEpsilon = 1e-5f;
+
+	const double kPi = 3.14159265358979323846;
+
+
+	struct Double3
+	{
+		double x;
+		double y;
+		double z;
+	};
+
+
+	Double3 operator+(const Double3& a, const Double3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+	Double3 operator-(const Double3& a, const Double3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	Double3 operator*(double s, const Double3& a) { return { s * a.x, s * a.y, s * a.z }; }
+	double Dot(const Double3& a, const Double3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	Double3 Cross(const Double3& a, const Double3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+	Double3 Normalize(const Double3& a) { return (1.0 / std::sqrt(Dot(a, a))) * a; }
+
+
+	// a vertex of the reference surfaces: the position, and the normal and tangent from their closed forms
+	struct ReferencePoint
+	{
+		Double3 position;
+		Double3 normal;
+		Double3 tangentU;
+	};
+
+
+	// the angles around u and v of the reference grid are the ones of the column and the row, the wrapped column
+	// and row take the angles of the first ones, the uvs are the ones of the grid
+	template <typename Evaluate>
+	MeshData MakeReferenceGrid(uint32 uSegments, uint32 vSegments, bool wrapU, bool wrapV, Evaluate evaluate)
+	{
+		MeshData mesh;
+		for (uint32 row = 0; row <= vSegments; row++)
+		{
+			for (uint32 column = 0; column <= uSegments; column++)
+			{
+				const double u = double(wrapU ? column % uSegments : column) / uSegments;
+				const double v = double(wrapV ? row % vSegments : row) / vSegments;
+				const ReferencePoint point = evaluate(u, v);
+
+				MeshData::Vertex vertex;
+				vertex.position = { float(point.position.x), float(point.position.y), float(point.position.z) };
+				vertex.normal = { float(point.normal.x), float(point.normal.y), float(point.normal.z) };
+				vertex.tangentU = { float(point.tangentU.x), float(point.tangentU.y), float(point.tangentU.z) };
+				vertex.uv = { float(column) / uSegments, float(row) / vSegments };
+				mesh.vertices.push_back(vertex);
+			}
+		}
+		return mesh;
+	}
+
+
+	// the two triangles of every cell, without the upper ones of the first row of cells and the lower ones of the
+	// last if their rows are collapsed
+	std::vector<uint32> MakeReferenceIndices(uint32 uSegments, uint32 vSegments, bool collapsedFirstRow, bool collapsedLastRow)
+	{
+		std::vector<uint32> indices;
+		for (uint32 cellRow = 0; cellRow < vSegments; cellRow++)
+		{
+			for (uint32 column = 0; column < uSegments; column++)
+			{
+				const uint32 i0 = cellRow * (uSegments + 1) + column;
+				const uint32 i2 = i0 + uSegments + 1;
+				if (!(collapsedFirstRow && cellRow == 0))
+				{
+					indices.insert(indices.end(), { i0, i0 + 1, i2 });
+				}
+				if (!(collapsedLastRow && cellRow == vSegments - 1))
+				{
+					indices.insert(indices.end(), { i2, i0 + 1, i2 + 1 });
+				}
+			}
+		}
+		return indices;
+	}
+
+
+	MeshData ReferenceSphere(float radius, uint32 sliceCount, uint32 stackCount)
+	{
+		MeshData mesh = MakeReferenceGrid(sliceCount, stackCount, true, false, [radius](double u, double v)
+		{
+			const double theta = 2.0 * kPi * u;
+			const double phi = kPi * v;
+			const Double3 normal = { std::cos(theta) * std::sin(phi), std::cos(phi), std::sin(theta) * std::sin(phi) };
+			return ReferencePoint{ double(radius) * normal, normal, { -std::sin(theta), 0.0, std::cos(theta) } };
+		});
+		mesh.indices = MakeReferenceIndices(sliceCount, stackCount, true, true);
+		return mesh;
+	}
+
+
+	MeshData ReferenceTorus(float maxRadius, float minRadius, uint32 detailsCount)
+	{
+		const double tubeRadius = (double(maxRadius) - minRadius) / 2.0;
+		const double ringRadius = minRadius + tubeRadius;
+		MeshData mesh = MakeReferenceGrid(detailsCount, detailsCount, true, true, [=](double u, double v)
+		{
+			const double phi = 2.0 * kPi * u;
+			const double theta = 2.0 * kPi * v;
+			const Double3 normal = { std::cos(phi) * std::cos(theta), std::sin(phi), std::cos(phi) * std::sin(theta) };
+			const Double3 center = { ringRadius * std::cos(theta), 0.0, ringRadius * std::sin(theta) };
+			const Double3 tangentU = { -std::sin(phi) * std::cos(theta), std::cos(phi), -std::sin(phi) * std::sin(theta) };
+			return ReferencePoint{ center + tubeRadius * normal, normal, tangentU };
+		});
+		mesh.indices = MakeReferenceIndices(detailsCount, detailsCount, false, false);
+		return mesh;
+	}
+
+
+	// the tube of radius c around the (p, q) knot on the torus of radius R and tube radius r, with the frame of the
+	// knot tangent and the direction away from the torus core circle
+	MeshData ReferenceTorusKnot(float r, float R, float c, uint32 detailsCount, uint32 q, uint32 p)
+	{
+		MeshData mesh = MakeReferenceGrid(detailsCount, detailsCount, true, true, [=](double u, double v)
+		{
+			const double phi = 2.0 * kPi * u;
+			const double theta = 2.0 * kPi * v;
+			const double distance = R + r * std::cos(q * theta);
+			const Double3 knot = { distance * std::cos(p * theta), distance * std::sin(p * theta), r * std::sin(q * theta) };
+			const Double3 tangent = Normalize({
+				-double(p) * distance * std::sin(p * theta) - double(q) * r * std::sin(q * theta) * std::cos(p * theta),
+				double(p) * distance * std::cos(p * theta) - double(q) * r * std::sin(q * theta) * std::sin(p * theta),
+				double(q) * r * std::cos(q * theta) });
+			const Double3 away = { std::cos(p * theta) * std::cos(q * theta), std::sin(p * theta) * std::cos(q * theta), std::sin(q * theta) };
+			const Double3 normal = Normalize(away - Dot(away, tangent) * tangent);
+			const Double3 binormal = Cross(tangent, normal);
+
+			const Double3 outwards = std::cos(phi) * normal + std::sin(phi) * binormal;
+			return ReferencePoint{ knot + double(c) * outwards, outwards, std::cos(phi) * binormal - std::sin(phi) * normal };
+		});
+		mesh.indices = MakeReferenceIndices(detailsCount, detailsCount, false, false);
+		return mesh;
+	}
+
+
+	bool EqualFloat3(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b, float absoluteEpsilon)
+	{
+		return xtest::math::EqualULPAndAbsoluteEpsilon(a.x, b.x, absoluteEpsilon, kMaxULPDistance)
+			&& xtest::math::EqualULPAndAbsoluteEpsilon(a.y, b.y, absoluteEpsilon, kMaxULPDistance)
+			&& xtest::math::EqualULPAndAbsoluteEpsilon(a.z, b.z, absoluteEpsilon, kMaxULPDistance);
+	}
+
+
+	// the same grid: the vertices within the ULP bound, the uvs and the indices exactly. meshSize is about the
+	// largest coordinate of the mesh, the knot frequency q, if any, scales the epsilons
+	bool MatchesReference(const MeshData& mesh, const MeshData& reference, float meshSize, float frequency = 1.f)
+	{
+		if (mesh.vertices.size() != reference.vertices.size() || mesh.indices != reference.indices)
+		{
+			return false;
+		}
+
+		for (size_t index = 0; index < mesh.vertices.size(); index++)
+		{
+			const MeshData::Vertex& vertex = mesh.vertices[index];
+			const MeshData::Vertex& referenceVertex = reference.vertices[index];
+			if (!EqualFloat3(vertex.position, referenceVertex.position, kAbsoluteEpsilon * meshSize * frequency)
+				|| !EqualFloat3(vertex.normal, referenceVertex.normal, kAbsoluteEpsilon * frequency)
+				|| !EqualFloat3(vertex.tangentU, referenceVertex.tangentU, kAbsoluteEpsilon * frequency)
+				|| vertex.uv.x != referenceVertex.uv.x
+				|| vertex.uv.y != referenceVertex.uv.y)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	// small grids of the generators frozen when they became parametric. the sphere rings and the torus vertices
+	// off the seams are the ones of the original GenerateSphere and GenerateTorus, whose torus tangents had the
+	// length of the tube radius, 1 here; the poles and the seams are the rows and the columns the parametric grid
+	// added. the knot has the orthonormal tube frame of TorusKnotSurface, the original one was not orthonormal
+	const float kFrozenEpsilon = 1e-5f;
+
+	// GenerateSphere(2, 4, 3)
+	const MeshData::Vertex kFrozenSphereVertices[] = {
+		{ { 0.0f, 2.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f } },
+		{ { 0.0f, 2.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.25f, 0.0f } },
+		{ { 0.0f, 2.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.5f, 0.0f } },
+		{ { 0.0f, 2.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.75f, 0.0f } },
+		{ { 0.0f, 2.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f } },
+		{ { 1.732051f, 1.0f, 0.0f }, { 0.866025f, 0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.333333f } },
+		{ { 0.0f, 1.0f, 1.732051f }, { 0.0f, 0.5f, 0.866025f }, { -1.0f, 0.0f, 0.0f }, { 0.25f, 0.333333f } },
+		{ { -1.732051f, 1.0f, 0.0f }, { -0.866025f, 0.5f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.5f, 0.333333f } },
+		{ { 0.0f, 1.0f, -1.732051f }, { 0.0f, 0.5f, -0.866025f }, { 1.0f, 0.0f, 0.0f }, { 0.75f, 0.333333f } },
+		{ { 1.732051f, 1.0f, 0.0f }, { 0.866025f, 0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.333333f } },
+		{ { 1.732051f, -1.0f, 0.0f }, { 0.866025f, -0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.666667f } },
+		{ { 0.0f, -1.0f, 1.732051f }, { 0.0f, -0.5f, 0.866025f }, { -1.0f, 0.0f, 0.0f }, { 0.25f, 0.666667f } },
+		{ { -1.732051f, -1.0f, 0.0f }, { -0.866025f, -0.5f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.5f, 0.666667f } },
+		{ { 0.0f, -1.0f, -1.732051f }, { 0.0f, -0.5f, -0.866025f }, { 1.0f, 0.0f, 0.0f }, { 0.75f, 0.666667f } },
+		{ { 1.732051f, -1.0f, 0.0f }, { 0.866025f, -0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.666667f } },
+		{ { 0.0f, -2.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f } },
+		{ { 0.0f, -2.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.25f, 1.0f } },
+		{ { 0.0f, -2.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.5f, 1.0f } },
+		{ { 0.0f, -2.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.75f, 1.0f } },
+		{ { 0.0f, -2.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f } }
+	};
+
+	const uint32 kFrozenSphereIndices[] = {
+		5, 1, 6, 6, 2, 7, 7, 3, 8, 8, 4, 9,
+		5, 6, 10, 10, 6, 11, 6, 7, 11, 11, 7, 12,
+		7, 8, 12, 12, 8, 13, 8, 9, 13, 13, 9, 14,
+		10, 11, 15, 11, 12, 16, 12, 13, 17, 13, 14, 18
+	};
+
+	// GenerateTorus(3, 1, 4)
+	const MeshData::Vertex kFrozenTorusVertices[] = {
+		{ { 3.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f } },
+		{ { 2.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.25f, 0.0f } },
+		{ { 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.5f, 0.0f } },
+		{ { 2.0f, -1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.75f, 0.0f } },
+		{ { 3.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f } },
+		{ { 0.0f, 0.0f, 3.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.25f } },
+		{ { 0.0f, 1.0f, 2.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.25f, 0.25f } },
+		{ { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f, 0.0f }, { 0.5f, 0.25f } },
+		{ { 0.0f, -1.0f, 2.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.75f, 0.25f } },
+		{ { 0.0f, 0.0f, 3.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.25f } },
+		{ { -3.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.5f } },
+		{ { -2.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.25f, 0.5f } },
+		{ { -1.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.5f, 0.5f } },
+		{ { -2.0f, -1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.75f, 0.5f } },
+		{ { -3.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.5f } },
+		{ { 0.0f, 0.0f, -3.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.75f } },
+		{ { 0.0f, 1.0f, -2.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.25f, 0.75f } },
+		{ { 0.0f, 0.0f, -1.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, -1.0f, 0.0f }, { 0.5f, 0.75f } },
+		{ { 0.0f, -1.0f, -2.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.75f, 0.75f } },
+		{ { 0.0f, 0.0f, -3.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.75f } },
+		{ { 3.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f } },
+		{ { 2.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.25f, 1.0f } },
+		{ { 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.5f, 1.0f } },
+		{ { 2.0f, -1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.75f, 1.0f } },
+		{ { 3.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f } }
+	};
+
+	// the torus and the knot share the grid
+	const uint32 kFrozenTorusIndices[] = {
+		0, 1, 5, 5, 1, 6, 1, 2, 6, 6, 2, 7,
+		2, 3, 7, 7, 3, 8, 3, 4, 8, 8, 4, 9,
+		5, 6, 10, 10, 6, 11, 6, 7, 11, 11, 7, 12,
+		7, 8, 12, 12, 8, 13, 8, 9, 13, 13, 9, 14,
+		10, 11, 15, 15, 11, 16, 11, 12, 16, 16, 12, 17,
+		12, 13, 17, 17, 13, 18, 13, 14, 18, 18, 14, 19,
+		15, 16, 20, 20, 16, 21, 16, 17, 21, 21, 17, 22,
+		17, 18, 22, 22, 18, 23, 18, 19, 23, 23, 19, 24
+	};
+
+	// GenerateTorusKnot(1, 3, 0.25, 4, 3, 2)
+	const MeshData::Vertex kFrozenTorusKnotVertices[] = {
+		{ { 4.25f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.351123f, -0.936329f }, { 0.0f, 0.0f } },
+		{ { 4.0f, 0.087781f, -0.234082f }, { 0.0f, 0.351123f, -0.936329f }, { -1.0f, 0.0f, 0.0f }, { 0.25f, 0.0f } },
+		{ { 3.75f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, -0.351123f, 0.936329f }, { 0.5f, 0.0f } },
+		{ { 4.0f, -0.087781f, 0.234082f }, { 0.0f, -0.351123f, 0.936329f }, { 1.0f, 0.0f, 0.0f }, { 0.75f, 0.0f } },
+		{ { 4.25f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.351123f, -0.936329f }, { 1.0f, 0.0f } },
+		{ { -3.0f, 0.0f, -1.25f }, { 0.0f, 0.0f, -1.0f }, { 0.894427f, -0.447213f, 0.0f }, { 0.0f, 0.25f } },
+		{ { -2.776393f, -0.111804f, -1.0f }, { 0.894427f, -0.447213f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.25f, 0.25f } },
+		{ { -3.0f, 0.0f, -0.75f }, { 0.0f, 0.0f, 1.0f }, { -0.894427f, 0.447213f, 0.0f }, { 0.5f, 0.25f } },
+		{ { -3.223607f, 0.111803f, -1.0f }, { -0.894427f, 0.447213f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.75f, 0.25f } },
+		{ { -3.0f, 0.0f, -1.25f }, { 0.0f, 0.0f, -1.0f }, { 0.894427f, -0.447213f, 0.0f }, { 1.0f, 0.25f } },
+		{ { 1.75f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 0.6f, 0.8f }, { 0.0f, 0.5f } },
+		{ { 2.0f, 0.15f, 0.2f }, { 0.0f, 0.6f, 0.8f }, { 1.0f, 0.0f, 0.0f }, { 0.25f, 0.5f } },
+		{ { 2.25f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, -0.6f, -0.8f }, { 0.5f, 0.5f } },
+		{ { 2.0f, -0.15f, -0.2f }, { 0.0f, -0.6f, -0.8f }, { -1.0f, 0.0f, 0.0f }, { 0.75f, 0.5f } },
+		{ { 1.75f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 0.6f, 0.8f }, { 1.0f, 0.5f } },
+		{ { -3.0f, 0.0f, 1.25f }, { 0.0f, 0.0f, 1.0f }, { -0.894427f, -0.447214f, 0.0f }, { 0.0f, 0.75f } },
+		{ { -3.223607f, -0.111804f, 1.0f }, { -0.894427f, -0.447214f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.25f, 0.75f } },
+		{ { -3.0f, 0.0f, 0.75f }, { 0.0f, 0.0f, -1.0f }, { 0.894427f, 0.447214f, 0.0f }, { 0.5f, 0.75f } },
+		{ { -2.776393f, 0.111803f, 1.0f }, { 0.894427f, 0.447214f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.75f, 0.75f } },
+		{ { -3.0f, 0.0f, 1.25f }, { 0.0f, 0.0f, 1.0f }, { -0.894427f, -0.447214f, 0.0f }, { 1.0f, 0.75f } },
+		{ { 4.25f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.351123f, -0.936329f }, { 0.0f, 1.0f } },
+		{ { 4.0f, 0.087781f, -0.234082f }, { 0.0f, 0.351123f, -0.936329f }, { -1.0f, 0.0f, 0.0f }, { 0.25f, 1.0f } },
+		{ { 3.75f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, -0.351123f, 0.936329f }, { 0.5f, 1.0f } },
+		{ { 4.0f, -0.087781f, 0.234082f }, { 0.0f, -0.351123f, 0.936329f }, { 1.0f, 0.0f, 0.0f }, { 0.75f, 1.0f } },
+		{ { 4.25f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.351123f, -0.936329f }, { 1.0f, 1.0f } }
+	};
+
+
+	// the vertices within kFrozenEpsilon, the uvs too, and the indices exactly
+	template <size_t vertexCount, size_t indexCount>
+	bool MatchesFrozen(const MeshData& mesh, const MeshData::Vertex (&vertices)[vertexCount], const uint32 (&indices)[indexCount])
+	{
+		if (mesh.vertices.size() != vertexCount || !std::equal(mesh.indices.begin(), mesh.indices.end(), std::begin(indices), std::end(indices)))
+		{
+			return false;
+		}
+
+		for (size_t index = 0; index < vertexCount; index++)
+		{
+			const MeshData::Vertex& vertex = mesh.vertices[index];
+			const MeshData::Vertex& frozenVertex = vertices[index];
+			if (!EqualFloat3(vertex.position, frozenVertex.position, kFrozenEpsilon)
+				|| !EqualFloat3(vertex.normal, frozenVertex.normal, kFrozenEpsilon)
+				|| !EqualFloat3(vertex.tangentU, frozenVertex.tangentU, kFrozenEpsilon)
+				|| !(std::fabs(vertex.uv.x - frozenVertex.uv.x) <= kFrozenEpsilon)
+				|| !(std::fabs(vertex.uv.y - frozenVertex.uv.y) <= kFrozenEpsilon))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	void TestFrozenGrids(UnitTestReport* report)
+	{
+		XTEST_CHECK(report, MatchesFrozen(xtest::mesh::GenerateSphere(2.f, 4, 3, 1), kFrozenSphereVertices, kFrozenSphereIndices));
+		XTEST_CHECK(report, MatchesFrozen(xtest::mesh::GenerateTorus(3.f, 1.f, 4, 1), kFrozenTorusVertices, kFrozenTorusIndices));
+		XTEST_CHECK(report, MatchesFrozen(xtest::mesh::GenerateTorusKnot(1.f, 3.f, 0.25f, 4, 3, 2, 1), kFrozenTorusKnotVertices, kFrozenTorusIndices));
+	}
+
+
+	void TestReferenceSurfaces(UnitTestReport* report)
+	{
+		// detail counts that are and aren't a multiple of the 4 lanes evaluated at once
+		for (uint32 detailsCount : { 4u, 7u, 32u, 101u })
+		{
+			XTEST_CHECK(report, MatchesReference(xtest::mesh::GenerateSphere(2.f, detailsCount, detailsCount / 2 + 2, 1), ReferenceSphere(2.f, detailsCount, detailsCount / 2 + 2), 2.f));
+			XTEST_CHECK(report, MatchesReference(xtest::mesh::GenerateTorus(3.f, 1.f, detailsCount, 1), ReferenceTorus(3.f, 1.f, detailsCount), 3.f));
+			XTEST_CHECK(report, MatchesReference(xtest::mesh::GenerateTorusKnot(1.f, 3.f, 0.25f, detailsCount, 3, 2, 1), ReferenceTorusKnot(1.f, 3.f, 0.25f, detailsCount, 3, 2), 4.25f, 3.f));
+		}
+
+		// the knot of the vertex codec benchmark, whose tube is thin compared to the knot
+		XTEST_CHECK(report, MatchesReference(xtest::mesh::GenerateTorusKnot(2.f, 10.f, 0.05f, 250, 20, 1, 1), ReferenceTorusKnot(2.f, 10.f, 0.05f, 250, 20, 1), 12.05f, 20.f));
+
+		// the poles collapse to a single point, the seams are cracks free
+		const MeshData sphere = xtest::mesh::GenerateSphere(1.f, 16, 8, 1);
+		XTEST_CHECK(report, std::all_of(sphere.vertices.begin(), sphere.vertices.begin() + 17, [&sphere](const MeshData::Vertex& vertex)
+		{
+			return vertex.position.x == sphere.vertices[0].position.x && vertex.position.y == 1.f && vertex.position.z == sphere.vertices[0].position.z;
+		}));
+		XTEST_CHECK(report, sphere.vertices[16].normal.x == sphere.vertices[0].normal.x && sphere.vertices[16].uv.x == 1.f);
+
+		const MeshData torus = xtest::mesh::GenerateTorus(3.f, 1.f, 8, 1);
+		XTEST_CHECK(report, torus.vertices[8 * 9].position.x == torus.vertices[0].position.x && torus.vertices[8 * 9].uv.y == 1.f);
+	}
+
+
+	void TestThreadCount(UnitTestReport* report)
+	{
+		// grids above kMinParallelParametricVertexCount, whose rows are spread over the threads
+		XTEST_CHECK(report, 300 * 300 > xtest::mesh::kMinParallelParametricVertexCount);
+
+		const MeshData sphere = xtest::mesh::GenerateSphere(1.f, 300, 300, 1);
+		const MeshData parallelSphere = xtest::mesh::GenerateSphere(1.f, 300, 300, 4);
+		XTEST_CHECK(report, sphere.vertices == parallelSphere.vertices && sphere.indices == parallelSphere.indices);
+
+		const MeshData torusKnot = xtest::mesh::GenerateTorusKnot(1.f, 3.f, 0.25f, 300, 3, 2, 1);
+		const MeshData parallelTorusKnot = xtest::mesh::GenerateTorusKnot(1.f, 3.f, 0.25f, 300, 3, 2, 4);
+		XTEST_CHECK(report, torusKnot.vertices == parallelTorusKnot.vertices && torusKnot.indices == parallelTorusKnot.indices);
+	}
+}
+
+
+void xtest::test::TestMeshGenerator(UnitTestReport* report)
+{
+	TestFrozenGrids(report);
+	TestReferenceSurfaces(report);
+	TestThreadCount(report);
+}
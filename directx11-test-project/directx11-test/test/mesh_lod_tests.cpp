@@ -0,0 +1,140 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <math/math_utils.h>
+#include <mesh/mesh_generator.h>
+#include <mesh/mesh_lod.h>
+
+
+using namespace DirectX;
+using xtest::mesh::LodSet;
+using xtest::mesh::LodStatistics;
+using xtest::mesh::LodView;
+using xtest::mesh::MeshData;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	// a unit sphere at 3 detail levels
+	LodSet MakeSphereLodSet()
+	{
+		std::vector<MeshData> levels;
+		levels.push_back(xtest::mesh::GenerateSphere(1.f, 40, 40, 1));
+		levels.push_back(xtest::mesh::GenerateSphere(1.f, 20, 20, 1));
+		levels.push_back(xtest::mesh::GenerateSphere(1.f, 10, 10, 1));
+		return xtest::mesh::BuildLodSet(std::move(levels));
+	}
+
+
+	// the projection of the textures demo, at 720 pixels
+	LodView MakeView(float cameraZ)
+	{
+		const XMMATRIX P = XMMatrixPerspectiveFovLH(xtest::math::ToRadians(45.f), 16.f / 9.f, 1.f, 1000.f);
+		return xtest::mesh::MakeLodView(XMFLOAT3(0.f, 0.f, cameraZ), P, 720.f);
+	}
+
+
+	void TestErrors(UnitTestReport* report)
+	{
+		XTEST_CHECK(report, xtest::mesh::EstimateTessellationError(xtest::mesh::GenerateBox(1.f, 2.f, 3.f)) == 0.f);
+
+		const LodSet lodSet = MakeSphereLodSet();
+		XTEST_CHECK(report, lodSet.levels.size() == 3);
+		XTEST_CHECK(report, lodSet.levels[0].error > 0.f && lodSet.levels[0].error < lodSet.levels[1].error);
+		XTEST_CHECK(report, lodSet.levels[1].error < lodSet.levels[2].error);
+
+		// the sagitta of the edges of 1/40 of a circle, the longest of the finest sphere
+		const float sagitta = 1.f - std::cos(XM_PI / 40.f);
+		XTEST_CHECK(report, lodSet.levels[0].error > 0.5f * sagitta && lodSet.levels[0].error < 2.f * sagitta);
+
+		XTEST_CHECK(report, std::fabs(lodSet.boundsRadius - 1.f) < 1e-3f);
+		XTEST_CHECK(report, XMVectorGetX(XMVector3Length(XMLoadFloat3(&lodSet.boundsCenter))) < 1e-3f);
+
+		// a finer mesh after a coarser one gets the error of the coarser one
+		std::vector<MeshData> levels;
+		levels.push_back(xtest::mesh::GenerateSphere(1.f, 10, 10, 1));
+		levels.push_back(xtest::mesh::GenerateSphere(1.f, 40, 40, 1));
+		const LodSet raisedLodSet = xtest::mesh::BuildLodSet(std::move(levels));
+		XTEST_CHECK(report, raisedLodSet.levels[1].error == raisedLodSet.levels[0].error);
+	}
+
+
+	void TestProjectedErrors(UnitTestReport* report)
+	{
+		const LodSet lodSet = MakeSphereLodSet();
+		const XMMATRIX world = XMMatrixIdentity();
+
+		XTEST_CHECK(report, std::isinf(xtest::mesh::ProjectLodError(lodSet, 0, world, MakeView(-0.5f))));
+		XTEST_CHECK(report, xtest::mesh::ProjectLodError(lodSet, 0, world, MakeView(-20.f)) < xtest::mesh::ProjectLodError(lodSet, 0, world, MakeView(-10.f)));
+		XTEST_CHECK(report, xtest::mesh::ProjectLodError(lodSet, 0, world, MakeView(-10.f)) < xtest::mesh::ProjectLodError(lodSet, 1, world, MakeView(-10.f)));
+
+		// twice as large at the same distance from the surface, twice the error
+		const float error = xtest::mesh::ProjectLodError(lodSet, 1, world, MakeView(-11.f));
+		const float scaledError = xtest::mesh::ProjectLodError(lodSet, 1, XMMatrixScaling(2.f, 2.f, 2.f), MakeView(-12.f));
+		XTEST_CHECK(report, std::fabs(scaledError - 2.f * error) < 1e-3f * error);
+
+		// a level without error is exact even from inside the bounds
+		const LodSet flatLodSet = xtest::mesh::BuildLodSet({ xtest::mesh::GenerateBox(1.f, 1.f, 1.f) });
+		XTEST_CHECK(report, xtest::mesh::ProjectLodError(flatLodSet, 0, world, MakeView(0.f)) == 0.f);
+	}
+
+
+	void TestSelection(UnitTestReport* report)
+	{
+		const LodSet lodSet = MakeSphereLodSet();
+		const XMMATRIX world = XMMatrixIdentity();
+
+		XTEST_CHECK(report, xtest::mesh::SelectLod(lodSet, world, MakeView(-0.5f), 2) == 0);
+		XTEST_CHECK(report, xtest::mesh::SelectLod(lodSet, world, MakeView(-10000.f), 0) == 2);
+
+		// moving away the level only gets coarser, and a coarser level than the finest is within the error
+		uint32 level = 0;
+		uint32 finerCount = 0;
+		uint32 tooCoarseCount = 0;
+		for (float distance = 1.5f; distance < 1000.f; distance *= 1.05f)
+		{
+			const uint32 selectedLevel = xtest::mesh::SelectLod(lodSet, world, MakeView(-distance), level);
+			finerCount += selectedLevel < level ? 1 : 0;
+			tooCoarseCount += selectedLevel > 0 && xtest::mesh::ProjectLodError(lodSet, selectedLevel, world, MakeView(-distance)) > 1.f ? 1 : 0;
+			level = selectedLevel;
+		}
+		XTEST_CHECK(report, finerCount == 0 && tooCoarseCount == 0 && level == 2);
+
+		// where level 1 projects to 7/8 of a pixel the level is kept: the finer one doesn't get coarser before
+		// 3/4 of a pixel, the coarser one doesn't get finer before a pixel
+		const float pixelsPerErrorUnit = MakeView(0.f).projectionScale;
+		const float distance = lodSet.boundsRadius + lodSet.levels[1].error * pixelsPerErrorUnit / 0.875f;
+		XTEST_CHECK(report, xtest::mesh::SelectLod(lodSet, world, MakeView(-distance), 0) == 0);
+		XTEST_CHECK(report, xtest::mesh::SelectLod(lodSet, world, MakeView(-distance), 1) == 1);
+
+		xtest::mesh::LodSelectionSettings settings;
+		settings.hysteresis = 0.f;
+		XTEST_CHECK(report, xtest::mesh::SelectLod(lodSet, world, MakeView(-distance), 0, settings) == 1);
+
+		// a current level out of the set starts from the coarsest
+		XTEST_CHECK(report, xtest::mesh::SelectLod(lodSet, world, MakeView(-10000.f), 7) == 2);
+	}
+
+
+	void TestStatistics(UnitTestReport* report)
+	{
+		const LodSet lodSet = MakeSphereLodSet();
+
+		LodStatistics statistics;
+		statistics.AddDraw(lodSet, 2);
+		statistics.AddDraw(lodSet, 0);
+		XTEST_CHECK(report, statistics.drawCount == 2);
+		XTEST_CHECK(report, statistics.submittedTriangleCount == (lodSet.levels[0].meshData.indices.size() + lodSet.levels[2].meshData.indices.size()) / 3);
+		XTEST_CHECK(report, statistics.finestTriangleCount == 2 * lodSet.levels[0].meshData.indices.size() / 3);
+	}
+}
+
+
+void xtest::test::TestMeshLod(UnitTestReport* report)
+{
+	TestErrors(report);
+	TestProjectedErrors(report);
+	TestSelection(report);
+	TestStatistics(report);
+}
+
@@ -0,0 +1,159 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <mesh/mesh_generator.h>
+#include <mesh/mesh_optimizer.h>
+#include <random>
+
+
+using xtest::mesh::MeshData;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	// the triangles sorted, each one with its own index order
+	std::vector<std::array<uint32, 3>> SortedTriangles(const std::vector<uint32>& indices)
+	{
+		std::vector<std::array<uint32, 3>> triangles;
+		for (size_t index = 0; index + 2 < indices.size(); index += 3)
+		{
+			triangles.push_back({ indices[index], indices[index + 1], indices[index + 2] });
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+
+	// the triangles of the mesh in a random order, which the grid order of the generators is far from
+	MeshData ShuffledTriangles(MeshData mesh, uint32 seed)
+	{
+		std::vector<std::array<uint32, 3>> triangles;
+		for (size_t index = 0; index + 2 < mesh.indices.size(); index += 3)
+		{
+			triangles.push_back({ mesh.indices[index], mesh.indices[index + 1], mesh.indices[index + 2] });
+		}
+		std::shuffle(triangles.begin(), triangles.end(), std::mt19937(seed));
+
+		mesh.indices.clear();
+		for (const std::array<uint32, 3>& triangle : triangles)
+		{
+			mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+		}
+		return mesh;
+	}
+
+
+	bool Equal(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+	{
+		return a.x == b.x && a.y == b.y && a.z == b.z;
+	}
+
+
+	// a sphere inside a larger one, the inner one drawn first: every pixel of the inner one is shaded twice
+	MeshData NestedSpheres()
+	{
+		MeshData mesh = xtest::mesh::GenerateSphere(1.f, 24, 12, 1);
+		const MeshData outerSphere = xtest::mesh::GenerateSphere(2.f, 24, 12, 1);
+		const uint32 vertexOffset = uint32(mesh.vertices.size());
+		mesh.vertices.insert(mesh.vertices.end(), outerSphere.vertices.begin(), outerSphere.vertices.end());
+		for (uint32 index : outerSphere.indices)
+		{
+			mesh.indices.push_back(vertexOffset + index);
+		}
+		return mesh;
+	}
+
+
+	void TestOptimizeVertexCache(UnitTestReport* report)
+	{
+		for (const MeshData& inputMesh : { xtest::mesh::GenerateSphere(1.f, 32, 16, 1), ShuffledTriangles(xtest::mesh::GenerateSphere(1.f, 32, 16, 1), 7) })
+		{
+			MeshData mesh = inputMesh;
+			xtest::mesh::OptimizeVertexCache(mesh);
+			XTEST_CHECK(report, SortedTriangles(mesh.indices) == SortedTriangles(inputMesh.indices));
+			XTEST_CHECK(report, xtest::mesh::AnalyzeVertexCache(mesh).acmr <= xtest::mesh::AnalyzeVertexCache(inputMesh).acmr);
+		}
+
+		// the random order misses the cache on almost every vertex, the optimized one gets close to the grid order
+		const MeshData shuffledSphere = ShuffledTriangles(xtest::mesh::GenerateSphere(1.f, 32, 16, 1), 7);
+		MeshData optimizedSphere = shuffledSphere;
+		xtest::mesh::OptimizeVertexCache(optimizedSphere);
+		XTEST_CHECK(report, xtest::mesh::AnalyzeVertexCache(shuffledSphere).acmr > 2.f);
+		XTEST_CHECK(report, xtest::mesh::AnalyzeVertexCache(optimizedSphere).acmr < 0.8f);
+	}
+
+
+	void TestOptimizeVertexFetch(UnitTestReport* report)
+	{
+		// a vertex no triangle uses, first in the buffer, goes at the end
+		MeshData inputMesh = ShuffledTriangles(xtest::mesh::GenerateTorus(3.f, 1.f, 16, 1), 3);
+		MeshData::Vertex unusedVertex = inputMesh.vertices[0];
+		unusedVertex.position = { 100.f, 100.f, 100.f };
+		inputMesh.vertices.insert(inputMesh.vertices.begin(), unusedVertex);
+		for (uint32& index : inputMesh.indices)
+		{
+			index++;
+		}
+
+		MeshData mesh = inputMesh;
+		xtest::mesh::OptimizeVertexFetch(mesh);
+		XTEST_CHECK(report, mesh.vertices.size() == inputMesh.vertices.size() && mesh.indices.size() == inputMesh.indices.size());
+
+		// every index that isn't a repeated vertex is the next one, and it points to the vertex it pointed to: the
+		// seam vertices of the torus share the position, not the uv
+		uint32 nextVertex = 0;
+		uint32 outOfOrderCount = 0;
+		uint32 movedVertexCount = 0;
+		for (size_t index = 0; index < mesh.indices.size(); index++)
+		{
+			if (mesh.indices[index] == nextVertex)
+			{
+				nextVertex++;
+			}
+			else if (mesh.indices[index] > nextVertex)
+			{
+				outOfOrderCount++;
+			}
+
+			const MeshData::Vertex& vertex = mesh.vertices[mesh.indices[index]];
+			const MeshData::Vertex& inputVertex = inputMesh.vertices[inputMesh.indices[index]];
+			movedVertexCount += Equal(vertex.position, inputVertex.position) && vertex.uv.x == inputVertex.uv.x && vertex.uv.y == inputVertex.uv.y ? 0 : 1;
+		}
+		XTEST_CHECK(report, outOfOrderCount == 0);
+		XTEST_CHECK(report, movedVertexCount == 0);
+		XTEST_CHECK(report, nextVertex == mesh.vertices.size() - 1 && Equal(mesh.vertices.back().position, unusedVertex.position));
+	}
+
+
+	void TestOptimizeOverdraw(UnitTestReport* report)
+	{
+		for (MeshData mesh : { NestedSpheres(), xtest::mesh::GenerateTorusKnot(1.f, 3.f, 0.6f, 64, 3, 2, 1) })
+		{
+			// the input of OptimizeOverdraw is a list already optimized for the vertex cache
+			xtest::mesh::OptimizeVertexCache(mesh);
+			const std::vector<uint32> cacheOptimizedIndices = mesh.indices;
+			const xtest::mesh::OverdrawStatistics overdrawBefore = xtest::mesh::AnalyzeOverdraw(mesh);
+
+			xtest::mesh::OptimizeOverdraw(mesh);
+			const xtest::mesh::OverdrawStatistics overdrawAfter = xtest::mesh::AnalyzeOverdraw(mesh);
+			XTEST_CHECK(report, SortedTriangles(mesh.indices) == SortedTriangles(cacheOptimizedIndices));
+			XTEST_CHECK(report, overdrawAfter.coveredPixelCount == overdrawBefore.coveredPixelCount);
+			XTEST_CHECK(report, overdrawAfter.overdraw <= overdrawBefore.overdraw);
+		}
+
+		// the outer sphere hides the inner one once it is drawn first
+		MeshData nestedSpheres = NestedSpheres();
+		XTEST_CHECK(report, xtest::mesh::AnalyzeOverdraw(nestedSpheres).overdraw > 1.2f);
+		xtest::mesh::OptimizeVertexCache(nestedSpheres);
+		xtest::mesh::OptimizeOverdraw(nestedSpheres);
+		XTEST_CHECK(report, xtest::mesh::AnalyzeOverdraw(nestedSpheres).overdraw < 1.05f);
+	}
+}
+
+
+void xtest::test::TestMeshOptimizer(UnitTestReport* report)
+{
+	TestOptimizeVertexCache(report);
+	TestOptimizeVertexFetch(report);
+	TestOptimizeOverdraw(report);
+}
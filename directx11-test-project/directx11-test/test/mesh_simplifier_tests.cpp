@@ -0,0 +1,216 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <mesh/mesh_generator.h>
+#include <mesh/mesh_simplifier.h>
+
+
+using namespace DirectX;
+using xtest::mesh::MeshData;
+using xtest::mesh::SimplifyResult;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	// indices within the vertices, no triangle with a repeated corner and every one facing the same side as the
+	// original surface around its first corner
+	bool AreTrianglesValid(const MeshData& mesh, const std::vector<uint32>& indices)
+	{
+		if (indices.size() % 3 != 0)
+		{
+			return false;
+		}
+
+		for (size_t index = 0; index < indices.size(); index += 3)
+		{
+			const uint32 a = indices[index];
+			const uint32 b = indices[index + 1];
+			const uint32 c = indices[index + 2];
+			if (a >= mesh.vertices.size() || b >= mesh.vertices.size() || c >= mesh.vertices.size() || a == b || b == c || c == a)
+			{
+				return false;
+			}
+
+			const XMVECTOR p0 = XMLoadFloat3(&mesh.vertices[a].position);
+			const XMVECTOR cross = XMVector3Cross(XMVectorSubtract(XMLoadFloat3(&mesh.vertices[b].position), p0), XMVectorSubtract(XMLoadFloat3(&mesh.vertices[c].position), p0));
+			if (XMVectorGetX(XMVector3Dot(cross, XMLoadFloat3(&mesh.vertices[a].normal))) <= 0.f)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	// the edges walked by a single triangle, with no triangle walking them back
+	std::vector<std::array<uint32, 2>> BorderEdges(const std::vector<uint32>& indices)
+	{
+		std::vector<std::array<uint32, 2>> edges;
+		for (size_t index = 0; index < indices.size(); index += 3)
+		{
+			for (uint32 corner = 0; corner < 3; corner++)
+			{
+				edges.push_back({ indices[index + corner], indices[index + (corner + 1) % 3] });
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+
+		std::vector<std::array<uint32, 2>> borderEdges;
+		for (const std::array<uint32, 2>& edge : edges)
+		{
+			if (!std::binary_search(edges.begin(), edges.end(), std::array<uint32, 2>{ edge[1], edge[0] }))
+			{
+				borderEdges.push_back(edge);
+			}
+		}
+		return borderEdges;
+	}
+
+
+	// every index replaced by the first vertex with the same position, the seams of a closed mesh then close
+	std::vector<uint32> ByPosition(const MeshData& mesh, std::vector<uint32> indices)
+	{
+		for (uint32& index : indices)
+		{
+			const XMFLOAT3& position = mesh.vertices[index].position;
+			for (uint32 vertex = 0; vertex < index; vertex++)
+			{
+				const XMFLOAT3& otherPosition = mesh.vertices[vertex].position;
+				if (otherPosition.x == position.x && otherPosition.y == position.y && otherPosition.z == position.z)
+				{
+					index = vertex;
+					break;
+				}
+			}
+		}
+		return indices;
+	}
+
+
+	/**
+	Every border edge of the simplified triangles follows a chain of border edges of the original ones, all in
+	its direction and on its line, and together they follow each original border edge exactly once: the borders
+	keep their shape, only their straight runs get fewer vertices.
+	*/
+	bool IsBorderKept(const MeshData& mesh, const std::vector<uint32>& simplifiedIndices)
+	{
+		const std::vector<std::array<uint32, 2>> borderEdges = BorderEdges(mesh.indices);
+		std::map<uint32, uint32> borderNext;
+		for (const std::array<uint32, 2>& edge : borderEdges)
+		{
+			if (!borderNext.emplace(edge[0], edge[1]).second)
+			{
+				return false;
+			}
+		}
+
+		size_t followedEdgeCount = 0;
+		for (const std::array<uint32, 2>& edge : BorderEdges(simplifiedIndices))
+		{
+			const XMVECTOR from = XMLoadFloat3(&mesh.vertices[edge[0]].position);
+			const XMVECTOR direction = XMVector3Normalize(XMVectorSubtract(XMLoadFloat3(&mesh.vertices[edge[1]].position), from));
+			for (uint32 vertex = edge[0]; vertex != edge[1]; followedEdgeCount++)
+			{
+				const auto next = borderNext.find(vertex);
+				if (next == borderNext.end() || followedEdgeCount == borderEdges.size())
+				{
+					return false;
+				}
+
+				const XMVECTOR step = XMVectorSubtract(XMLoadFloat3(&mesh.vertices[next->second].position), from);
+				const XMVECTOR offLine = XMVectorSubtract(step, XMVectorMultiply(direction, XMVector3Dot(step, direction)));
+				if (XMVectorGetX(XMVector3Dot(step, direction)) <= 0.f || XMVectorGetX(XMVector3Length(offLine)) > 1e-5f)
+				{
+					return false;
+				}
+				vertex = next->second;
+			}
+		}
+		return followedEdgeCount == borderEdges.size();
+	}
+
+
+	// the plane is flat and its uvs are linear, it collapses down to the target without any error
+	void TestPlane(UnitTestReport* report)
+	{
+		const MeshData plane = xtest::mesh::GeneratePlane(4.f, 2.f, 21, 41);
+		const size_t targetIndexCount = plane.indices.size() / 10;
+
+		const SimplifyResult result = xtest::mesh::Simplify(plane, targetIndexCount, 0.01f);
+		XTEST_CHECK(report, result.indices.size() <= targetIndexCount);
+		XTEST_CHECK(report, result.indices.size() + 6 >= targetIndexCount);
+		XTEST_CHECK(report, result.error <= 1e-3f);
+		XTEST_CHECK(report, AreTrianglesValid(plane, result.indices));
+		XTEST_CHECK(report, IsBorderKept(plane, result.indices));
+
+		// as far as it can go, the border still holds
+		const SimplifyResult smallest = xtest::mesh::Simplify(plane, 0, 0.01f);
+		XTEST_CHECK(report, smallest.indices.size() < result.indices.size());
+		XTEST_CHECK(report, AreTrianglesValid(plane, smallest.indices));
+		XTEST_CHECK(report, IsBorderKept(plane, smallest.indices));
+	}
+
+
+	// the sphere is curved, the error allowed decides how far it goes
+	void TestSphere(UnitTestReport* report)
+	{
+		const MeshData sphere = xtest::mesh::GenerateSphere(1.f, 48, 24);
+		const size_t targetIndexCount = sphere.indices.size() / 4;
+
+		const SimplifyResult loose = xtest::mesh::Simplify(sphere, targetIndexCount, 0.1f);
+		XTEST_CHECK(report, loose.indices.size() <= targetIndexCount);
+		XTEST_CHECK(report, loose.indices.size() + 6 >= targetIndexCount);
+		XTEST_CHECK(report, loose.error > 0.f && loose.error <= 0.1f);
+		XTEST_CHECK(report, AreTrianglesValid(sphere, loose.indices));
+		XTEST_CHECK(report, BorderEdges(ByPosition(sphere, loose.indices)).empty());
+
+		// a tighter error stops before the target
+		const float tightError = 0.002f;
+		const SimplifyResult tight = xtest::mesh::Simplify(sphere, targetIndexCount, tightError);
+		XTEST_CHECK(report, tight.indices.size() > targetIndexCount);
+		XTEST_CHECK(report, tight.indices.size() < sphere.indices.size());
+		XTEST_CHECK(report, tight.error <= tightError);
+		XTEST_CHECK(report, AreTrianglesValid(sphere, tight.indices));
+
+		// no error allowed, nothing but the degenerate triangles at the poles goes
+		const SimplifyResult exact = xtest::mesh::Simplify(sphere, targetIndexCount, 0.f);
+		XTEST_CHECK(report, exact.error == 0.f);
+		XTEST_CHECK(report, exact.indices.size() == sphere.indices.size());
+	}
+
+
+	// an inner border as well, around a square hole in the middle of the plane
+	void TestPlaneWithHole(UnitTestReport* report)
+	{
+		MeshData plane = xtest::mesh::GeneratePlane(2.f, 2.f, 21, 21);
+		std::vector<uint32> indices;
+		for (size_t index = 0; index < plane.indices.size(); index += 3)
+		{
+			bool nearCenter = false;
+			for (uint32 corner = 0; corner < 3; corner++)
+			{
+				const XMFLOAT3& position = plane.vertices[plane.indices[index + corner]].position;
+				nearCenter = nearCenter || (std::abs(position.x) < 0.25f && std::abs(position.z) < 0.25f);
+			}
+			if (!nearCenter)
+			{
+				indices.insert(indices.end(), plane.indices.begin() + index, plane.indices.begin() + index + 3);
+			}
+		}
+		plane.indices = indices;
+
+		const SimplifyResult result = xtest::mesh::Simplify(plane, 0, 0.01f);
+		XTEST_CHECK(report, result.indices.size() < plane.indices.size() / 4);
+		XTEST_CHECK(report, result.error <= 1e-3f);
+		XTEST_CHECK(report, AreTrianglesValid(plane, result.indices));
+		XTEST_CHECK(report, IsBorderKept(plane, result.indices));
+	}
+}
+
+
+void xtest::test::TestMeshSimplifier(UnitTestReport* report)
+{
+	TestPlane(report);
+	TestSphere(report);
+	TestPlaneWithHole(report);
+}
@@ -0,0 +1,166 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <mesh/mesh_generator.h>
+#include <mesh/mesh_optimizer.h>
+#include <mesh/meshlet.h>
+
+
+using xtest::mesh::Meshlet;
+using xtest::mesh::MeshletData;
+using xtest::mesh::MeshData;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	// the mesh triangles of every meshlet, through its local vertices, in meshlet order
+	std::vector<std::array<uint32, 3>> MeshletTriangles(const MeshletData& meshletData, size_t firstMeshlet)
+	{
+		std::vector<std::array<uint32, 3>> triangles;
+		for (size_t meshletIndex = firstMeshlet; meshletIndex < meshletData.meshlets.size(); meshletIndex++)
+		{
+			const Meshlet& meshlet = meshletData.meshlets[meshletIndex];
+			for (uint32 triangle = 0; triangle < meshlet.triangleCount; triangle++)
+			{
+				const uint8* localIndices = &meshletData.triangles[(meshlet.triangleOffset + triangle) * 3];
+				triangles.push_back({ meshletData.vertices[meshlet.vertexOffset + localIndices[0]],
+					meshletData.vertices[meshlet.vertexOffset + localIndices[1]],
+					meshletData.vertices[meshlet.vertexOffset + localIndices[2]] });
+			}
+		}
+		return triangles;
+	}
+
+
+	std::vector<std::array<uint32, 3>> SortedTriangles(const std::vector<uint32>& indices)
+	{
+		std::vector<std::array<uint32, 3>> triangles;
+		for (size_t index = 0; index + 2 < indices.size(); index += 3)
+		{
+			triangles.push_back({ indices[index], indices[index + 1], indices[index + 2] });
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+
+	// the limits and the ranges of every meshlet from firstMeshlet on: within the limits, not empty, right after
+	// the previous one, with distinct local vertices that its triangles all use and no local index past them
+	bool AreMeshletsValid(const MeshletData& meshletData, size_t firstMeshlet, uint32 maxVertexCount, uint32 maxTriangleCount)
+	{
+		if (meshletData.bounds.size() != meshletData.meshlets.size())
+		{
+			return false;
+		}
+
+		for (size_t meshletIndex = firstMeshlet; meshletIndex < meshletData.meshlets.size(); meshletIndex++)
+		{
+			const Meshlet& meshlet = meshletData.meshlets[meshletIndex];
+			if (meshlet.vertexCount == 0 || meshlet.vertexCount > maxVertexCount || meshlet.triangleCount == 0 || meshlet.triangleCount > maxTriangleCount)
+			{
+				return false;
+			}
+
+			const Meshlet* nextMeshlet = meshletIndex + 1 < meshletData.meshlets.size() ? &meshletData.meshlets[meshletIndex + 1] : nullptr;
+			const size_t vertexEnd = nextMeshlet ? nextMeshlet->vertexOffset : meshletData.vertices.size();
+			const size_t triangleEnd = nextMeshlet ? nextMeshlet->triangleOffset : meshletData.triangles.size() / 3;
+			if (meshlet.vertexOffset + meshlet.vertexCount != vertexEnd || meshlet.triangleOffset + meshlet.triangleCount != triangleEnd)
+			{
+				return false;
+			}
+
+			std::vector<uint32> meshletVertices(meshletData.vertices.begin() + meshlet.vertexOffset, meshletData.vertices.begin() + vertexEnd);
+			std::sort(meshletVertices.begin(), meshletVertices.end());
+			std::vector<bool> usedLocalVertices(meshlet.vertexCount);
+			for (uint32 corner = 0; corner < meshlet.triangleCount * 3; corner++)
+			{
+				const uint8 localIndex = meshletData.triangles[meshlet.triangleOffset * 3 + corner];
+				if (localIndex >= meshlet.vertexCount)
+				{
+					return false;
+				}
+				usedLocalVertices[localIndex] = true;
+			}
+			if (std::adjacent_find(meshletVertices.begin(), meshletVertices.end()) != meshletVertices.end()
+				|| std::find(usedLocalVertices.begin(), usedLocalVertices.end(), false) != usedLocalVertices.end())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	// the bounding sphere of every meshlet holds its vertices
+	bool AreMeshletVerticesBounded(const MeshletData& meshletData, const MeshData& mesh)
+	{
+		for (size_t meshletIndex = 0; meshletIndex < meshletData.meshlets.size(); meshletIndex++)
+		{
+			const Meshlet& meshlet = meshletData.meshlets[meshletIndex];
+			const xtest::mesh::MeshletBounds& bounds = meshletData.bounds[meshletIndex];
+			for (uint32 vertex = 0; vertex < meshlet.vertexCount; vertex++)
+			{
+				const DirectX::XMFLOAT3& position = mesh.vertices[meshletData.vertices[meshlet.vertexOffset + vertex]].position;
+				const float dx = position.x - bounds.center.x;
+				const float dy = position.y - bounds.center.y;
+				const float dz = position.z - bounds.center.z;
+				if (std::sqrt(dx * dx + dy * dy + dz * dz) > bounds.radius * (1.f + 1e-5f))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+
+	void TestMeshletLimits(UnitTestReport* report)
+	{
+		MeshData mesh = xtest::mesh::GenerateTorusKnot(1.f, 3.f, 0.25f, 40, 3, 2, 1);
+		xtest::mesh::OptimizeVertexCache(mesh);
+
+		// the default limits, the smallest ones, and the largest ones the byte local indices allow
+		const std::pair<uint32, uint32> limits[] = { { xtest::mesh::kDefaultMeshletVertexCount, xtest::mesh::kDefaultMeshletTriangleCount }, { 3, 1 }, { 16, 8 },
+			{ 10, 64 }, { xtest::mesh::kMaxMeshletVertexCount, xtest::mesh::kMaxMeshletTriangleCount } };
+		for (const std::pair<uint32, uint32>& limit : limits)
+		{
+			const MeshletData meshletData = xtest::mesh::BuildMeshlets(mesh, limit.first, limit.second);
+			XTEST_CHECK(report, AreMeshletsValid(meshletData, 0, limit.first, limit.second));
+
+			// every triangle in exactly one meshlet, in index order
+			std::vector<std::array<uint32, 3>> meshletTriangles = MeshletTriangles(meshletData, 0);
+			XTEST_CHECK(report, xtest::mesh::BuildMeshletIndices(meshletData) == mesh.indices);
+			std::sort(meshletTriangles.begin(), meshletTriangles.end());
+			XTEST_CHECK(report, meshletTriangles == SortedTriangles(mesh.indices));
+			XTEST_CHECK(report, AreMeshletVerticesBounded(meshletData, mesh));
+		}
+	}
+
+
+	void TestAppendedMeshlets(UnitTestReport* report)
+	{
+		MeshData sphere = xtest::mesh::GenerateSphere(1.f, 24, 12, 1);
+		MeshData torus = xtest::mesh::GenerateTorus(3.f, 1.f, 24, 1);
+		xtest::mesh::OptimizeVertexCache(sphere);
+		xtest::mesh::OptimizeVertexCache(torus);
+
+		// the meshlets of the torus follow the ones of the sphere, their vertices index the torus vertices
+		MeshletData meshletData = xtest::mesh::BuildMeshlets(sphere, 32, 40);
+		const size_t sphereMeshletCount = meshletData.meshlets.size();
+		xtest::mesh::BuildMeshlets(torus.vertices.data(), uint32(torus.vertices.size()), torus.indices.data(), torus.indices.size(), 32, 40, &meshletData);
+
+		XTEST_CHECK(report, sphereMeshletCount > 0 && meshletData.meshlets.size() > sphereMeshletCount);
+		XTEST_CHECK(report, AreMeshletsValid(meshletData, 0, 32, 40));
+
+		std::vector<std::array<uint32, 3>> torusTriangles = MeshletTriangles(meshletData, sphereMeshletCount);
+		std::sort(torusTriangles.begin(), torusTriangles.end());
+		XTEST_CHECK(report, torusTriangles == SortedTriangles(torus.indices));
+	}
+}
+
+
+void xtest::test::TestMeshlets(UnitTestReport* report)
+{
+	TestMeshletLimits(report);
+	TestAppendedMeshlets(report);
+}
@@ -0,0 +1,123 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <common/parallel_for.h>
+#include <file/obj_baker.h>
+#include <fstream>
+#include <iterator>
+
+
+using xtest::file::ObjBakeReport;
+using xtest::file::ObjBakeSettings;
+using xtest::file::ObjImporter;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	const std::wstring kObjFilePath(L"obj_baker_tests.obj");
+	const std::wstring kGPFFilePath(L"obj_baker_tests.gpf");
+
+
+	// grids of different sizes, bent so that their normals and tangents vary, the odd ones without normals
+	std::string MakeObj(uint32 shapeCount)
+	{
+		std::string obj;
+		char line[256];
+		uint32 vertexCount = 0;
+		for (uint32 shape = 0; shape < shapeCount; shape++)
+		{
+			std::snprintf(line, sizeof(line), "o shape_%u\n", shape);
+			obj += line;
+
+			const uint32 gridSize = 4 + 3 * shape;
+			for (uint32 row = 0; row <= gridSize; row++)
+			{
+				for (uint32 column = 0; column <= gridSize; column++)
+				{
+					const float x = float(column) / gridSize;
+					const float y = float(row) / gridSize;
+					std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f 0 1\n", x, y, shape + 0.3f * x * x, x, y, -0.6f * x);
+					obj += line;
+				}
+			}
+
+			const uint32 rowVertexCount = gridSize + 1;
+			for (uint32 row = 0; row < gridSize; row++)
+			{
+				for (uint32 column = 0; column < gridSize; column++)
+				{
+					const uint32 corner = vertexCount + row * rowVertexCount + column + 1;
+					const uint32 quad[4] = { corner, corner + 1, corner + rowVertexCount + 1, corner + rowVertexCount };
+					obj += "f";
+					for (uint32 quadCorner : quad)
+					{
+						std::snprintf(line, sizeof(line), shape % 2 == 0 ? " %u/%u/%u" : " %u/%u", quadCorner, quadCorner, quadCorner);
+						obj += line;
+					}
+					obj += "\n";
+				}
+			}
+			vertexCount += rowVertexCount * rowVertexCount;
+		}
+		return obj;
+	}
+
+
+	std::string BakeToMemory(const ObjBakeSettings& settings, ObjBakeReport* report)
+	{
+		*report = xtest::file::WriteGPFOnDiskFromObj(kObjFilePath, kGPFFilePath, settings);
+
+		std::string file;
+		{
+			std::ifstream fileStream(kGPFFilePath.c_str(), std::ifstream::binary);
+			file.assign(std::istreambuf_iterator<char>(fileStream), std::istreambuf_iterator<char>());
+		}
+		DeleteFileW(kGPFFilePath.c_str());
+		return file;
+	}
+
+
+	// the shapes are welded on more threads than there are shapes, the passes after the import keep all of them
+	void TestThreadCounts(const ObjBakeSettings& baseSettings, uint32 shapeCount, UnitTestReport* report)
+	{
+		ObjBakeSettings settings = baseSettings;
+		settings.threadCount = 1;
+		ObjBakeReport serialReport;
+		const std::string serialFile = BakeToMemory(settings, &serialReport);
+		XTEST_CHECK(report, serialReport.succeeded && serialReport.shapeCount == shapeCount && !serialFile.empty());
+		XTEST_CHECK(report, serialReport.threadCount == 1);
+
+		for (uint32 threadCount : { 2u, shapeCount + 2, 0u })
+		{
+			settings.threadCount = threadCount;
+			ObjBakeReport parallelReport;
+			XTEST_CHECK(report, BakeToMemory(settings, &parallelReport) == serialFile);
+			XTEST_CHECK(report, parallelReport.succeeded && parallelReport.threadCount == (threadCount == 0 ? xtest::common::HardwareThreadCount() : threadCount));
+		}
+	}
+}
+
+
+void xtest::test::TestObjBaker(UnitTestReport* report)
+{
+	const uint32 shapeCount = 6;
+	{
+		const std::string obj = MakeObj(shapeCount);
+		std::ofstream fileStream(kObjFilePath.c_str(), std::ofstream::binary);
+		fileStream.write(obj.data(), std::streamsize(obj.size()));
+	}
+
+	ObjBakeSettings settings;
+	settings.importer = ObjImporter::tinyobj;
+	TestThreadCounts(settings, shapeCount, report);
+
+	// every optional pass
+	settings.buildMeshlets = true;
+	settings.lodCount = 3;
+	settings.packVertices = true;
+	settings.compressVertices = true;
+	settings.compressIndices = true;
+	TestThreadCounts(settings, shapeCount, report);
+
+	DeleteFileW(kObjFilePath.c_str());
+}
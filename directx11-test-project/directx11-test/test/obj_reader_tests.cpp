@@ -0,0 +1,210 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <file/obj_reader.h>
+#include <fstream>
+
+
+using xtest::file::GPFMeshHeader;
+using xtest::file::ObjReadSettings;
+using xtest::mesh::MeshData;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	// what ReadObj produces
+	struct ObjResult
+	{
+		bool read = false;
+		std::vector<GPFMeshHeader> meshHeaders;
+		MeshData meshData;
+	};
+
+
+	bool operator==(const ObjResult& a, const ObjResult& b)
+	{
+		return a.read == b.read
+			&& a.meshHeaders.size() == b.meshHeaders.size()
+			&& std::equal(a.meshHeaders.begin(), a.meshHeaders.end(), b.meshHeaders.begin(), [](const GPFMeshHeader& meshHeader, const GPFMeshHeader& otherMeshHeader)
+			{
+				return std::memcmp(&meshHeader, &otherMeshHeader, sizeof(GPFMeshHeader)) == 0;
+			})
+			&& a.meshData.vertices == b.meshData.vertices
+			&& a.meshData.indices == b.meshData.indices;
+	}
+
+
+	ObjResult ReadObjFromMemory(const std::string& obj, uint32 threadCount)
+	{
+		ObjReadSettings settings;
+		settings.threadCount = threadCount;
+
+		ObjResult result;
+		result.read = xtest::file::ReadObj(obj.data(), obj.size(), settings, &result.meshHeaders, &result.meshData);
+		return result;
+	}
+
+
+	// the streaming reader only reads files, the obj goes through a temporary one
+	ObjResult ReadObjFromFile(const std::string& obj)
+	{
+		const std::wstring filePath(L"obj_reader_tests.obj");
+		{
+			std::ofstream fileStream(filePath.c_str(), std::ofstream::binary);
+			fileStream.write(obj.data(), std::streamsize(obj.size()));
+		}
+
+		ObjResult result;
+		result.read = xtest::file::ReadObj(filePath, ObjReadSettings(), &result.meshHeaders, &result.meshData);
+		DeleteFileW(filePath.c_str());
+		return result;
+	}
+
+
+	// the streaming, the serial and the parallel parsers give the same meshes
+	bool ReadersAgree(const std::string& obj, ObjResult* serialResult)
+	{
+		*serialResult = ReadObjFromMemory(obj, 1);
+		return ReadObjFromFile(obj) == *serialResult
+			&& ReadObjFromMemory(obj, 4) == *serialResult
+			&& ReadObjFromMemory(obj, 0) == *serialResult;
+	}
+
+
+	// a few MB of grids, more than a chunk of the streaming reader and several of the parallel one: the shapes
+	// are split by o and g records, cross the chunk boundaries and reference their vertices with absolute and
+	// relative indices, the usemtl records in the middle of a shape don't split it
+	std::string MakeLargeObj(uint32 shapeCount, uint32 gridSize)
+	{
+		std::string obj;
+		char line[256];
+		uint32 vertexCount = 0;
+		for (uint32 shape = 0; shape < shapeCount; shape++)
+		{
+			if (shape % 5 == 4)
+			{
+				// a shape without faces, dropped
+				std::snprintf(line, sizeof(line), "o empty_%u\n", shape);
+				obj += line;
+			}
+			std::snprintf(line, sizeof(line), shape % 3 == 2 ? "g group_%u\n" : "o shape_%u\n", shape);
+			obj += line;
+
+			for (uint32 row = 0; row <= gridSize; row++)
+			{
+				for (uint32 column = 0; column <= gridSize; column++)
+				{
+					// the rows of a grid are at the same height two by two, so the welding has work to do
+					std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn 0 0 1\n", column * 0.1f, (row / 2) * 0.1f, shape * 0.5f,
+						float(column) / gridSize, float(row / 2) / gridSize);
+					obj += line;
+				}
+			}
+
+			const uint32 rowVertexCount = gridSize + 1;
+			const uint32 gridVertexCount = rowVertexCount * rowVertexCount;
+			for (uint32 row = 0; row < gridSize; row++)
+			{
+				if (row % 8 == 0)
+				{
+					std::snprintf(line, sizeof(line), "usemtl material_%u\ns %u\n", row / 8, row % 2);
+					obj += line;
+				}
+				for (uint32 column = 0; column < gridSize; column++)
+				{
+					const uint32 corner = row * rowVertexCount + column;
+					const uint32 quad[4] = { corner, corner + 1, corner + rowVertexCount + 1, corner + rowVertexCount };
+					obj += "f";
+					for (uint32 quadCorner : quad)
+					{
+						// 1 based absolute indices on the even shapes, relative to the last vertex on the odd ones
+						const int64 index = shape % 2 == 0 ? int64(vertexCount + quadCorner + 1) : int64(quadCorner) - int64(gridVertexCount);
+						std::snprintf(line, sizeof(line), shape % 4 == 3 ? " %lld//%lld" : " %lld/%lld/%lld", (long long)index, (long long)index, (long long)index);
+						obj += line;
+					}
+					obj += "\n";
+				}
+			}
+			vertexCount += gridVertexCount;
+		}
+		return obj;
+	}
+
+
+	void TestSmallObj(UnitTestReport* report)
+	{
+		// a quad before any o record, an o record without faces, materials in the middle of a shape, faces
+		// without uvs or normals, a crlf line and a face of two corners that is skipped
+		const std::string obj =
+			"# comment\n"
+			"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+			"vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+			"vn 0 0 1\n"
+			"f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+			"o empty\n"
+			"o  quad \n"
+			"usemtl red\n"
+			"f -4/-4/-1 -3/-3/-1 -2/-2/-1\n"
+			"usemtl blue\n"
+			"f 1//1 3//1 4//1\n"
+			"g side\r\n"
+			"f 1 2 3\n"
+			"f 1 2\n";
+
+		ObjResult result;
+		XTEST_CHECK(report, ReadersAgree(obj, &result));
+		XTEST_CHECK(report, result.read && result.meshHeaders.size() == 3);
+		if (result.meshHeaders.size() != 3)
+		{
+			return;
+		}
+
+		XTEST_CHECK(report, std::string(result.meshHeaders[0].name).empty() && std::string(result.meshHeaders[1].name) == "quad" && std::string(result.meshHeaders[2].name) == "side");
+
+		// the quad is fan triangulated, the -4/-4/-1 corner of the second shape welds with the 1//1 one since the
+		// first uv is zero like a missing one
+		XTEST_CHECK(report, result.meshHeaders[0].vertexCount == 4 && result.meshHeaders[0].indexCount == 6);
+		XTEST_CHECK(report, result.meshHeaders[1].vertexCount == 5 && result.meshHeaders[1].indexCount == 6);
+		XTEST_CHECK(report, result.meshHeaders[2].vertexCount == 3 && result.meshHeaders[2].indexCount == 3);
+		XTEST_CHECK(report, result.meshHeaders[1].vertexOffset == 4 && result.meshHeaders[1].indexOffset == 6);
+		XTEST_CHECK(report, result.meshHeaders[2].vertexOffset == 9 && result.meshHeaders[2].indexOffset == 12);
+
+		const std::vector<uint32> expectedIndices = { 0, 1, 2, 0, 2, 3, 0, 1, 2, 0, 3, 4, 0, 1, 2 };
+		XTEST_CHECK(report, result.meshData.indices == expectedIndices);
+		XTEST_CHECK(report, result.meshData.vertices[10].normal.z == 0.f && result.meshData.vertices[10].position.x == 1.f);
+	}
+
+
+	void TestEmptyObj(UnitTestReport* report)
+	{
+		ObjResult result;
+		XTEST_CHECK(report, ReadersAgree("", &result));
+		XTEST_CHECK(report, result.read && result.meshHeaders.empty() && result.meshData.vertices.empty());
+
+		// only records without faces
+		XTEST_CHECK(report, ReadersAgree("o nothing\nv 1 2 3\nusemtl red\n", &result));
+		XTEST_CHECK(report, result.read && result.meshHeaders.empty() && result.meshData.vertices.empty());
+	}
+
+
+	void TestLargeObj(UnitTestReport* report)
+	{
+		const std::string obj = MakeLargeObj(40, 40);
+		XTEST_CHECK(report, obj.size() > 5 * 1024 * 1024);
+
+		ObjResult result;
+		XTEST_CHECK(report, ReadersAgree(obj, &result));
+
+		// the shapes without faces are dropped, about half of the grid vertices are welded away
+		XTEST_CHECK(report, result.read && result.meshHeaders.size() == 40);
+		XTEST_CHECK(report, result.meshHeaders.size() == 40 && result.meshHeaders[39].vertexCount == 41 * 21 && result.meshHeaders[39].indexCount == 40 * 40 * 6);
+	}
+}
+
+
+void xtest::test::TestObjReader(UnitTestReport* report)
+{
+	TestSmallObj(report);
+	TestEmptyObj(report);
+	TestLargeObj(report);
+}
@@ -0,0 +1,156 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <render/object_transforms.h>
+#include <random>
+
+
+using namespace DirectX;
+using xtest::render::ObjectTransforms;
+using xtest::render::WorldTransforms;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	XMMATRIX TestViewProjection()
+	{
+		const XMMATRIX V = XMMatrixLookAtLH(XMVectorSet(3.f, 5.f, -20.f, 1.f), XMVectorZero(), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+		const XMMATRIX P = XMMatrixPerspectiveFovLH(1.f, 16.f / 9.f, 1.f, 200.f);
+		return XMMatrixMultiply(V, P);
+	}
+
+
+	// scaled from 0.1 to 10 on every axis, mirrored on some, rotated and moved up to 100 units away
+	XMMATRIX RandomAffine(std::mt19937* random)
+	{
+		std::uniform_real_distribution<float> scale(0.1f, 10.f);
+		std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+		std::uniform_real_distribution<float> position(-100.f, 100.f);
+
+		const float mirror = (*random)() % 4 == 0 ? -1.f : 1.f;
+		const XMMATRIX S = XMMatrixScaling(mirror * scale(*random), scale(*random), scale(*random));
+		const XMMATRIX R = XMMatrixRotationRollPitchYaw(angle(*random), angle(*random), angle(*random));
+		const XMMATRIX T = XMMatrixTranslation(position(*random), position(*random), position(*random));
+		return XMMatrixMultiply(XMMatrixMultiply(S, R), T);
+	}
+
+
+	// every element within relativeEpsilon of the largest one of its row in the reference: the rows of a product
+	// or of an inverse have their own scale, the translation row is much larger than the others
+	bool NearlyEqual(FXMMATRIX matrix, CXMMATRIX reference, float relativeEpsilon)
+	{
+		XMFLOAT4X4 elements;
+		XMFLOAT4X4 expected;
+		XMStoreFloat4x4(&elements, matrix);
+		XMStoreFloat4x4(&expected, reference);
+		for (uint32 row = 0; row < 4; row++)
+		{
+			const float largestElement = std::max(std::max(std::fabs(expected.m[row][0]), std::fabs(expected.m[row][1])), std::max(std::fabs(expected.m[row][2]), std::fabs(expected.m[row][3])));
+			for (uint32 column = 0; column < 4; column++)
+			{
+				if (!(std::fabs(elements.m[row][column] - expected.m[row][column]) <= relativeEpsilon * largestElement))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+
+	bool BitwiseEqual(const XMFLOAT4X4& matrix, FXMMATRIX reference)
+	{
+		XMFLOAT4X4 expected;
+		XMStoreFloat4x4(&expected, reference);
+		return std::memcmp(&matrix, &expected, sizeof(XMFLOAT4X4)) == 0;
+	}
+
+
+	bool BitwiseEqual(const ObjectTransforms& transforms, const ObjectTransforms& otherTransforms)
+	{
+		return std::memcmp(&transforms, &otherTransforms, sizeof(ObjectTransforms)) == 0;
+	}
+
+
+	void TestAgainstReference(UnitTestReport* report)
+	{
+		const XMMATRIX viewProjection = TestViewProjection();
+
+		// the counts around the groups of 4, with every tail length, and one past kMinParallelTransformCount to
+		// compute them in blocks
+		std::mt19937 random(24);
+		for (uint32 count : { 0u, 1u, 2u, 3u, 4u, 5u, 37u, 1002u, xtest::render::kMinParallelTransformCount + 7 })
+		{
+			WorldTransforms worlds;
+			for (uint32 index = 0; index < count; index++)
+			{
+				worlds.Add(RandomAffine(&random));
+			}
+
+			// a guard past the last object, never written
+			ObjectTransforms guard;
+			std::memset(&guard, 0xcd, sizeof(ObjectTransforms));
+			std::vector<ObjectTransforms> transforms(count + 1, guard);
+			xtest::render::ComputeObjectTransforms(worlds, viewProjection, transforms.data(), 1);
+
+			// the old per object path: the transposes of W and of W * VP, the general inverse of W
+			uint32 worldMismatchCount = 0;
+			uint32 wvpMismatchCount = 0;
+			uint32 inverseMismatchCount = 0;
+			for (uint32 index = 0; index < count; index++)
+			{
+				const XMMATRIX W = worlds.Get(index);
+				worldMismatchCount += BitwiseEqual(transforms[index].W, XMMatrixTranspose(W)) ? 0 : 1;
+				wvpMismatchCount += NearlyEqual(XMMatrixTranspose(XMLoadFloat4x4(&transforms[index].WVP)), XMMatrixMultiply(W, viewProjection), 1e-5f) ? 0 : 1;
+				inverseMismatchCount += NearlyEqual(XMLoadFloat4x4(&transforms[index].W_inverseTraspose), XMMatrixInverse(nullptr, W), 1e-4f) ? 0 : 1;
+			}
+			XTEST_CHECK(report, worldMismatchCount == 0);
+			XTEST_CHECK(report, wvpMismatchCount == 0);
+			XTEST_CHECK(report, inverseMismatchCount == 0);
+			XTEST_CHECK(report, BitwiseEqual(transforms[count], guard));
+
+			// the blocks spread over the threads give the same bits
+			if (count > xtest::render::kMinParallelTransformCount)
+			{
+				std::vector<ObjectTransforms> parallelTransforms(count + 1, guard);
+				xtest::render::ComputeObjectTransforms(worlds, viewProjection, parallelTransforms.data(), 4);
+				XTEST_CHECK(report, std::equal(transforms.begin(), transforms.end(), parallelTransforms.begin(), [](const ObjectTransforms& a, const ObjectTransforms& b) { return BitwiseEqual(a, b); }));
+			}
+		}
+	}
+
+
+	void TestWorldTransforms(UnitTestReport* report)
+	{
+		std::mt19937 random(3);
+		const XMMATRIX first = RandomAffine(&random);
+		const XMMATRIX second = RandomAffine(&random);
+		const XMMATRIX third = RandomAffine(&random);
+
+		WorldTransforms worlds;
+		XTEST_CHECK(report, worlds.Add(first) == 0 && worlds.Add(second) == 1 && worlds.Add(third) == 2 && worlds.Count() == 3);
+
+		XMFLOAT4X4 stored;
+		XMStoreFloat4x4(&stored, worlds.Get(1));
+		XTEST_CHECK(report, BitwiseEqual(stored, second));
+
+		// the last matrix moves to the removed one
+		worlds.Remove(0);
+		XMStoreFloat4x4(&stored, worlds.Get(0));
+		XTEST_CHECK(report, worlds.Count() == 2 && BitwiseEqual(stored, third));
+
+		worlds.Set(1, first);
+		XMStoreFloat4x4(&stored, worlds.Get(1));
+		XTEST_CHECK(report, BitwiseEqual(stored, first));
+
+		worlds.Clear();
+		XTEST_CHECK(report, worlds.Count() == 0);
+	}
+}
+
+
+void xtest::test::TestObjectTransforms(UnitTestReport* report)
+{
+	TestAgainstReference(report);
+	TestWorldTransforms(report);
+}
@@ -0,0 +1,147 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <mesh/mesh_bounds.h>
+#include <mesh/mesh_generator.h>
+#include <render/occlusion_culler.h>
+
+
+using namespace DirectX;
+using xtest::mesh::MeshBounds;
+using xtest::mesh::MeshData;
+using xtest::render::OcclusionBuffer;
+using xtest::render::OcclusionCuller;
+using xtest::render::OcclusionStatistics;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	const uint32 kBufferWidth = 256;
+	const uint32 kBufferHeight = 128;
+
+
+	// looking along +z from z = -20, the wall is 20 x 20 in the plane z = 0
+	XMMATRIX TestViewProjection()
+	{
+		const XMMATRIX V = XMMatrixLookAtLH(XMVectorSet(0.f, 0.f, -20.f, 1.f), XMVectorZero(), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+		const XMMATRIX P = XMMatrixPerspectiveFovLH(1.f, 2.f, 1.f, 200.f);
+		return XMMatrixMultiply(V, P);
+	}
+
+
+	MeshData MakeWall()
+	{
+		return xtest::mesh::GenerateBox(20.f, 20.f, 1.f);
+	}
+
+
+	// the unit boxes tested against the wall
+	struct Occludees
+	{
+		MeshBounds bounds = xtest::mesh::ComputeBounds(xtest::mesh::GenerateBox(1.f, 1.f, 1.f));
+		XMMATRIX behind = XMMatrixTranslation(2.f, -3.f, 10.f);
+		XMMATRIX inFront = XMMatrixTranslation(2.f, -3.f, -10.f);
+		XMMATRIX aside = XMMatrixTranslation(25.f, 0.f, 10.f);			// behind the wall plane, but out of the wall
+		XMMATRIX acrossNearPlane = XMMatrixTranslation(0.f, 0.f, -19.f);	// the camera is inside it
+		XMMATRIX partlyHidden = XMMatrixTranslation(15.5f, 0.f, 10.f);	// across the wall edge on screen
+	};
+
+
+	void TestBuffer(UnitTestReport* report)
+	{
+		const XMMATRIX viewProjection = TestViewProjection();
+		const MeshData wall = MakeWall();
+		const Occludees occludees;
+
+		// nothing hides anything in an empty buffer
+		OcclusionBuffer buffer(kBufferWidth, kBufferHeight);
+		buffer.BuildHierarchy();
+		XTEST_CHECK(report, !buffer.IsOccluded(occludees.bounds, XMMatrixMultiply(occludees.behind, viewProjection)));
+
+		// the front faces of the wall cover the buffer, the back ones are culled
+		const uint32 renderedTriangleCount = buffer.RenderOccluder(wall.vertices.data(), uint32(wall.vertices.size()), wall.indices.data(), wall.indices.size(), viewProjection);
+		buffer.BuildHierarchy();
+		XTEST_CHECK(report, renderedTriangleCount > 0 && renderedTriangleCount <= wall.indices.size() / 6);
+		XTEST_CHECK(report, buffer.DepthAt(kBufferWidth / 2, kBufferHeight / 2) < 1.f && buffer.DepthAt(0, 0) == 1.f);
+
+		XTEST_CHECK(report, buffer.IsOccluded(occludees.bounds, XMMatrixMultiply(occludees.behind, viewProjection)));
+		XTEST_CHECK(report, !buffer.IsOccluded(occludees.bounds, XMMatrixMultiply(occludees.inFront, viewProjection)));
+		XTEST_CHECK(report, !buffer.IsOccluded(occludees.bounds, XMMatrixMultiply(occludees.aside, viewProjection)));
+		XTEST_CHECK(report, !buffer.IsOccluded(occludees.bounds, XMMatrixMultiply(occludees.acrossNearPlane, viewProjection)));
+		XTEST_CHECK(report, !buffer.IsOccluded(occludees.bounds, XMMatrixMultiply(occludees.partlyHidden, viewProjection)));
+
+		// the wall behind the boxes hides none of them
+		buffer.Clear();
+		buffer.RenderOccluder(wall.vertices.data(), uint32(wall.vertices.size()), wall.indices.data(), wall.indices.size(), XMMatrixMultiply(XMMatrixTranslation(0.f, 0.f, 30.f), viewProjection));
+		buffer.BuildHierarchy();
+		XTEST_CHECK(report, !buffer.IsOccluded(occludees.bounds, XMMatrixMultiply(occludees.behind, viewProjection)));
+		XTEST_CHECK(report, !buffer.IsOccluded(occludees.bounds, XMMatrixMultiply(occludees.inFront, viewProjection)));
+	}
+
+
+	void TestCuller(UnitTestReport* report)
+	{
+		const XMMATRIX viewProjection = TestViewProjection();
+		const MeshData wall = MakeWall();
+		const Occludees occludees;
+		OcclusionCuller culler(kBufferWidth, kBufferHeight);
+
+		// the wall in front of two of the boxes
+		culler.AddOccluder(wall, XMMatrixIdentity());
+		const uint32 behind = culler.AddOccludee(occludees.bounds, occludees.behind);
+		const uint32 inFront = culler.AddOccludee(occludees.bounds, occludees.inFront);
+		const uint32 aside = culler.AddOccludee(occludees.bounds, occludees.aside);
+		const uint32 alsoBehind = culler.AddOccludee(occludees.bounds, XMMatrixMultiply(occludees.behind, XMMatrixTranslation(-5.f, 5.f, 20.f)));
+		culler.Start(viewProjection);
+		culler.Wait();
+
+		XTEST_CHECK(report, !culler.IsVisible(behind) && culler.IsVisible(inFront) && culler.IsVisible(aside) && !culler.IsVisible(alsoBehind));
+		const OcclusionStatistics statistics = culler.Statistics();
+		XTEST_CHECK(report, statistics.occluderCount == 1 && statistics.renderedTriangleCount > 0);
+		XTEST_CHECK(report, statistics.testedCount == 4 && statistics.culledCount == 2 && statistics.visibleCount == 2);
+
+		// Wait cleared the inputs: a frame without occluders hides nothing, a wall behind the boxes neither
+		culler.AddOccludee(occludees.bounds, occludees.behind);
+		culler.Start(viewProjection);
+		culler.Wait();
+		XTEST_CHECK(report, culler.IsVisible(0));
+		XTEST_CHECK(report, culler.Statistics().occluderCount == 0 && culler.Statistics().testedCount == 1 && culler.Statistics().visibleCount == 1);
+
+		culler.AddOccluder(wall, XMMatrixTranslation(0.f, 0.f, 30.f));
+		culler.AddOccludee(occludees.bounds, occludees.behind);
+		culler.AddOccludee(occludees.bounds, occludees.inFront);
+		culler.Start(viewProjection);
+		culler.Wait();
+		XTEST_CHECK(report, culler.IsVisible(0) && culler.IsVisible(1));
+		XTEST_CHECK(report, culler.Statistics().culledCount == 0 && culler.Statistics().visibleCount == 2);
+	}
+
+
+	void TestWaitWithoutStart(UnitTestReport* report)
+	{
+		const Occludees occludees;
+		OcclusionCuller culler(kBufferWidth, kBufferHeight);
+
+		// returns at once and keeps the inputs for the next frame
+		culler.Wait();
+		culler.AddOccludee(occludees.bounds, occludees.behind);
+		culler.Wait();
+		XTEST_CHECK(report, culler.Statistics().testedCount == 0);
+
+		culler.Start(TestViewProjection());
+		culler.Wait();
+		XTEST_CHECK(report, culler.Statistics().testedCount == 1 && culler.IsVisible(0));
+
+		// a second Wait of the same frame changes nothing
+		culler.Wait();
+		XTEST_CHECK(report, culler.Statistics().testedCount == 1 && culler.IsVisible(0));
+	}
+}
+
+
+void xtest::test::TestOcclusion(UnitTestReport* report)
+{
+	TestBuffer(report);
+	TestCuller(report);
+	TestWaitWithoutStart(report);
+}
@@ -0,0 +1,157 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <mesh/mesh_generator.h>
+#include <mesh/packed_vertex.h>
+#include <cfloat>
+#include <random>
+
+
+using namespace DirectX;
+using xtest::mesh::MeshData;
+using xtest::mesh::PackedVertex;
+using xtest::mesh::PackedVertexError;
+using xtest::mesh::VertexQuantization;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	float Length(const XMFLOAT3& vector)
+	{
+		return XMVectorGetX(XMVector3Length(XMLoadFloat3(&vector)));
+	}
+
+
+	// the nearest unorm code is at most half a step away on every axis, the unpacked position is then rounded to
+	// a float once more, a couple of ulps of the largest coordinate of the bounds
+	float PositionErrorBound(const VertexQuantization& quantization)
+	{
+		const XMVECTOR offset = XMLoadFloat3(&quantization.positionOffset);
+		const XMVECTOR scale = XMLoadFloat3(&quantization.positionScale);
+		const XMVECTOR magnitude = XMVectorMax(XMVectorAbs(offset), XMVectorAbs(XMVectorAdd(offset, scale)));
+		const XMVECTOR axisBound = XMVectorAdd(XMVectorScale(scale, 0.5f / 65535.f), XMVectorScale(magnitude, 2.f * FLT_EPSILON));
+		return XMVectorGetX(XMVector3Length(axisBound));
+	}
+
+
+	// rounding the octahedral coordinates moves x and y by half a step and z by a step at most, a step being
+	// 2 / (2^bits - 1), and the best of the 4 codes is never worse than the rounded one. the octahedron point
+	// is at least 1 / sqrt(3) away from the origin, so the angle moves by at most sqrt(3) times that distance
+	float NormalErrorBound()
+	{
+		const float step = 2.f / float((1u << xtest::mesh::kPackedNormalBits) - 1);
+		return XMConvertToDegrees(std::sqrt(3.f) * std::sqrt(1.5f) * step) + 1e-3f;
+	}
+
+
+	// half an angle step, plus the tilt of the decoded normal the tangent is projected on
+	float TangentErrorBound()
+	{
+		return 180.f / float(1u << xtest::mesh::kPackedTangentBits) + NormalErrorBound() + 1e-3f;
+	}
+
+
+	// half floats keep 11 significant bits
+	float UVErrorBound(const MeshData& mesh)
+	{
+		float maxUV = 0.f;
+		for (const MeshData::Vertex& vertex : mesh.vertices)
+		{
+			maxUV = std::max(maxUV, std::max(std::abs(vertex.uv.x), std::abs(vertex.uv.y)));
+		}
+		return maxUV / 2048.f;
+	}
+
+
+	XMFLOAT3 RandomUnitVector(std::mt19937* random)
+	{
+		std::normal_distribution<float> component(0.f, 1.f);
+		XMFLOAT3 unitVector;
+		XMStoreFloat3(&unitVector, XMVector3Normalize(XMVectorSet(component(*random), component(*random), component(*random), 0.f)));
+		return unitVector;
+	}
+
+
+	// scattered far from the origin, with unit normals, tangents orthogonal to them and uvs beyond [0, 1]
+	MeshData RandomVertices(uint32 vertexCount, uint32 seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> position(-50.f, 150.f);
+		std::uniform_real_distribution<float> uv(-4.f, 4.f);
+
+		MeshData mesh;
+		mesh.vertices.resize(vertexCount);
+		for (MeshData::Vertex& vertex : mesh.vertices)
+		{
+			vertex.position = { position(random), position(random) * 0.01f, position(random) };
+			vertex.normal = RandomUnitVector(&random);
+
+			const XMFLOAT3 direction = RandomUnitVector(&random);
+			const XMVECTOR normal = XMLoadFloat3(&vertex.normal);
+			XMStoreFloat3(&vertex.tangentU, XMVector3Normalize(XMVector3Cross(normal, XMLoadFloat3(&direction))));
+			vertex.uv = { uv(random), uv(random) };
+		}
+		return mesh;
+	}
+
+
+	void TestRoundTrip(const MeshData& mesh, UnitTestReport* report)
+	{
+		VertexQuantization quantization;
+		const std::vector<PackedVertex> packedVertices = xtest::mesh::PackVertices(mesh, &quantization);
+		XTEST_CHECK(report, packedVertices.size() == mesh.vertices.size());
+
+		const PackedVertexError error = xtest::mesh::MeasurePackingError(mesh.vertices.data(), packedVertices.data(), uint32(mesh.vertices.size()), quantization);
+		XTEST_CHECK(report, error.maxPositionError <= PositionErrorBound(quantization));
+		XTEST_CHECK(report, error.maxNormalError <= NormalErrorBound());
+		XTEST_CHECK(report, error.maxTangentError <= TangentErrorBound());
+		XTEST_CHECK(report, error.maxUVError <= UVErrorBound(mesh));
+
+		std::vector<MeshData::Vertex> unpackedVertices(mesh.vertices.size());
+		xtest::mesh::UnpackVertices(packedVertices.data(), uint32(packedVertices.size()), quantization, unpackedVertices.data());
+
+		bool unitLength = true;
+		bool orthogonal = true;
+		for (const MeshData::Vertex& vertex : unpackedVertices)
+		{
+			unitLength = unitLength && std::abs(Length(vertex.normal) - 1.f) < 1e-5f && std::abs(Length(vertex.tangentU) - 1.f) < 1e-5f;
+			orthogonal = orthogonal && std::abs(XMVectorGetX(XMVector3Dot(XMLoadFloat3(&vertex.normal), XMLoadFloat3(&vertex.tangentU)))) < 1e-5f;
+		}
+		XTEST_CHECK(report, unitLength);
+		XTEST_CHECK(report, orthogonal);
+	}
+
+
+	// a flat axis has no quantization step, the coordinate comes back exactly
+	void TestFlatAxis(UnitTestReport* report)
+	{
+		MeshData plane = xtest::mesh::GeneratePlane(8.f, 4.f, 9, 17);
+		for (MeshData::Vertex& vertex : plane.vertices)
+		{
+			vertex.position.y = 2.5f;
+		}
+
+		VertexQuantization quantization;
+		const std::vector<PackedVertex> packedVertices = xtest::mesh::PackVertices(plane, &quantization);
+		XTEST_CHECK(report, quantization.positionScale.y == 0.f);
+
+		std::vector<MeshData::Vertex> unpackedVertices(plane.vertices.size());
+		xtest::mesh::UnpackVertices(packedVertices.data(), uint32(packedVertices.size()), quantization, unpackedVertices.data());
+
+		bool exactY = true;
+		for (const MeshData::Vertex& vertex : unpackedVertices)
+		{
+			exactY = exactY && vertex.position.y == 2.5f;
+		}
+		XTEST_CHECK(report, exactY);
+	}
+}
+
+
+void xtest::test::TestPackedVertex(UnitTestReport* report)
+{
+	TestRoundTrip(xtest::mesh::GenerateTorusKnot(1.f, 3.f, 0.25f, 128, 3, 2), report);
+	TestRoundTrip(xtest::mesh::GenerateSphere(2.f, 48, 24), report);
+	TestRoundTrip(RandomVertices(20000, 1234u), report);
+	TestFlatAxis(report);
+}
@@ -0,0 +1,159 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <render/draw_queue.h>
+#include <render/recording_backend.h>
+
+
+using xtest::render::ConstantBufferBinding;
+using xtest::render::DrawPacket;
+using xtest::render::DrawQueue;
+using xtest::render::RecordedCommand;
+using xtest::render::RecordingBackend;
+using xtest::render::ShaderStage;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	typedef RecordedCommand::Type CommandType;
+
+
+	RecordedCommand Command(CommandType type, uint32 resource, uint32 argument = 0, uint32 slot = 0, ShaderStage stage = ShaderStage::vertex)
+	{
+		return { type, stage, slot, resource, { argument, 0, 0 } };
+	}
+
+	RecordedCommand Draw(uint32 indexCount, uint32 startIndex, int32 baseVertex)
+	{
+		return { CommandType::draw_indexed, ShaderStage::vertex, 0, xtest::render::kNullResource, { indexCount, startIndex, uint32(baseVertex) } };
+	}
+
+
+	// a mesh of its own buffers drawn with a pipeline, a texture and a range of the per object constants
+	DrawPacket MeshPacket(uint32 pipeline, uint32 mesh, uint32 texture, uint32 constantOffset)
+	{
+		DrawPacket packet;
+		packet.pipeline = pipeline;
+		packet.vertexBuffer = 100 + mesh;
+		packet.vertexStride = 32;
+		packet.indexBuffer = 200 + mesh;
+		packet.vertexConstantBuffers[0] = { 300, constantOffset, 256 };
+		packet.textures[0] = texture;
+		packet.indexCount = 36 * mesh;
+		packet.startIndex = 0;
+		packet.baseVertex = 0;
+		return packet;
+	}
+
+
+	void TestCommands(UnitTestReport* report)
+	{
+		RecordingBackend backend;
+		ConstantBufferBinding binding;
+		binding.buffer = 7;
+		binding.offset = 512;
+		binding.size = 256;
+
+		backend.SetPipeline(1);
+		backend.SetVertexBuffer(2, 32);
+		backend.SetIndexBuffer(3);
+		backend.SetConstantBuffer(ShaderStage::pixel, 2, binding);
+		backend.SetTexture(1, 4);
+		backend.DrawIndexed(36, 6, -2);
+		backend.DrawIndexed(12, 0, 0);
+
+		const std::vector<RecordedCommand>& commands = backend.Commands();
+		XTEST_CHECK(report, commands.size() == 7 && backend.CommandCount() == 7);
+		XTEST_CHECK(report, commands[0] == Command(CommandType::set_pipeline, 1));
+		XTEST_CHECK(report, commands[1] == Command(CommandType::set_vertex_buffer, 2, 32));
+		XTEST_CHECK(report, commands[2] == Command(CommandType::set_index_buffer, 3));
+		XTEST_CHECK(report, commands[3].type == CommandType::set_constant_buffer && commands[3].stage == ShaderStage::pixel && commands[3].slot == 2);
+		XTEST_CHECK(report, commands[3].resource == 7 && commands[3].arguments[0] == 512 && commands[3].arguments[1] == 256);
+		XTEST_CHECK(report, commands[4].type == CommandType::set_texture && commands[4].slot == 1 && commands[4].resource == 4);
+		XTEST_CHECK(report, commands[5] == Draw(36, 6, -2));
+		XTEST_CHECK(report, commands[5] != Draw(36, 6, 2));
+
+		XTEST_CHECK(report, backend.CommandCount(CommandType::draw_indexed) == 2);
+		XTEST_CHECK(report, backend.CommandCount(CommandType::set_pipeline) == 1);
+		XTEST_CHECK(report, backend.SubmittedIndexCount() == 48);
+
+		backend.Reset();
+		XTEST_CHECK(report, backend.Commands().empty() && backend.CommandCount() == 0);
+		XTEST_CHECK(report, backend.CommandCount(CommandType::draw_indexed) == 0 && backend.SubmittedIndexCount() == 0);
+	}
+
+
+	void TestNullBackend(UnitTestReport* report)
+	{
+		// only the counters change
+		RecordingBackend backend(false);
+		backend.SetPipeline(1);
+		backend.DrawIndexed(36, 0, 0);
+		XTEST_CHECK(report, backend.Commands().empty());
+		XTEST_CHECK(report, backend.CommandCount() == 2 && backend.CommandCount(CommandType::draw_indexed) == 1);
+		XTEST_CHECK(report, backend.SubmittedIndexCount() == 36);
+	}
+
+
+	void TestDrawQueueStream(UnitTestReport* report)
+	{
+		// added out of order: sorted by pipeline, then by texture set, the two draws of mesh 1 keep their order
+		DrawQueue queue;
+		queue.Add(xtest::render::MakeSortKey(0, 2, 1, 0), MeshPacket(2, 1, 10, 0));
+		queue.Add(xtest::render::MakeSortKey(0, 1, 2, 0), MeshPacket(1, 2, 11, 256));
+		queue.Add(xtest::render::MakeSortKey(0, 1, 1, 5), MeshPacket(1, 1, 10, 512));
+		queue.Add(xtest::render::MakeSortKey(0, 1, 1, 5), MeshPacket(1, 1, 10, 768));
+		queue.Sort();
+
+		RecordingBackend backend;
+		queue.Execute(&backend);
+
+		const std::vector<RecordedCommand> expectedCommands = {
+			Command(CommandType::set_pipeline, 1),
+			Command(CommandType::set_vertex_buffer, 101, 32),
+			Command(CommandType::set_index_buffer, 201),
+			{ CommandType::set_constant_buffer, ShaderStage::vertex, 0, 300, { 512, 256, 0 } },
+			Command(CommandType::set_texture, 10, 0, 0, ShaderStage::pixel),
+			Draw(36, 0, 0),
+
+			// only the constants change
+			{ CommandType::set_constant_buffer, ShaderStage::vertex, 0, 300, { 768, 256, 0 } },
+			Draw(36, 0, 0),
+
+			Command(CommandType::set_vertex_buffer, 102, 32),
+			Command(CommandType::set_index_buffer, 202),
+			{ CommandType::set_constant_buffer, ShaderStage::vertex, 0, 300, { 256, 256, 0 } },
+			Command(CommandType::set_texture, 11, 0, 0, ShaderStage::pixel),
+			Draw(72, 0, 0),
+
+			Command(CommandType::set_pipeline, 2),
+			Command(CommandType::set_vertex_buffer, 101, 32),
+			Command(CommandType::set_index_buffer, 201),
+			{ CommandType::set_constant_buffer, ShaderStage::vertex, 0, 300, { 0, 256, 0 } },
+			Command(CommandType::set_texture, 10, 0, 0, ShaderStage::pixel),
+			Draw(36, 0, 0),
+		};
+		XTEST_CHECK(report, backend.Commands() == expectedCommands);
+		XTEST_CHECK(report, backend.CommandCount(CommandType::draw_indexed) == 4);
+		XTEST_CHECK(report, backend.SubmittedIndexCount() == 180);
+
+		// every draw binds or skips the 5 resources of its packet
+		XTEST_CHECK(report, queue.Statistics().drawCount == 4);
+		XTEST_CHECK(report, queue.Statistics().bindCount == backend.CommandCount() - 4);
+		XTEST_CHECK(report, queue.Statistics().bindCount + queue.Statistics().elidedBindCount == 20);
+
+		// nothing is assumed bound at the next execution
+		backend.Reset();
+		queue.Execute(&backend);
+		XTEST_CHECK(report, backend.Commands() == expectedCommands);
+	}
+}
+
+
+void xtest::test::TestRecordingBackend(UnitTestReport* report)
+{
+	TestCommands(report);
+	TestNullBackend(report);
+	TestDrawQueueStream(report);
+}
+
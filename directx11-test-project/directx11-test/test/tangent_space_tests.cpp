@@ -0,0 +1,157 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <mesh/mesh_generator.h>
+#include <mesh/tangent_space.h>
+
+
+using namespace DirectX;
+using xtest::mesh::MeshData;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	const uint32 kPlaneZDivisions = 11;
+	const uint32 kPlaneXDivisions = 21;
+
+
+	// the generated plane lies on y = 0 facing +y, u grows with x and v against z
+	MeshData PlaneWithoutTangents()
+	{
+		MeshData plane = xtest::mesh::GeneratePlane(4.f, 2.f, kPlaneZDivisions, kPlaneXDivisions);
+		for (MeshData::Vertex& vertex : plane.vertices)
+		{
+			vertex.tangentU = { 0.f, 0.f, 0.f };
+		}
+		return plane;
+	}
+
+
+	bool IsNear(const XMFLOAT3& a, const XMFLOAT3& b, float epsilon)
+	{
+		return std::abs(a.x - b.x) <= epsilon && std::abs(a.y - b.y) <= epsilon && std::abs(a.z - b.z) <= epsilon;
+	}
+
+
+	// unit normal and tangent, orthogonal to each other
+	bool AreOrthonormal(const MeshData& mesh)
+	{
+		for (const MeshData::Vertex& vertex : mesh.vertices)
+		{
+			const XMVECTOR normal = XMLoadFloat3(&vertex.normal);
+			const XMVECTOR tangent = XMLoadFloat3(&vertex.tangentU);
+			if (std::abs(XMVectorGetX(XMVector3Length(normal)) - 1.f) > 1e-5f || std::abs(XMVectorGetX(XMVector3Length(tangent)) - 1.f) > 1e-5f
+				|| std::abs(XMVectorGetX(XMVector3Dot(normal, tangent))) > 1e-5f)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	void TestPlaneTangents(UnitTestReport* report)
+	{
+		MeshData plane = PlaneWithoutTangents();
+		const size_t vertexCount = plane.vertices.size();
+
+		XTEST_CHECK(report, xtest::mesh::GenerateTangents(plane) == 0);
+		XTEST_CHECK(report, plane.vertices.size() == vertexCount);
+		XTEST_CHECK(report, AreOrthonormal(plane));
+
+		bool alongU = true;
+		for (const MeshData::Vertex& vertex : plane.vertices)
+		{
+			alongU = alongU && IsNear(vertex.tangentU, { 1.f, 0.f, 0.f }, 1e-5f);
+		}
+		XTEST_CHECK(report, alongU);
+	}
+
+
+	// uvs rotated on the plane by an angle, the tangent follows the direction of increasing u: (cos, 0, -sin)
+	void TestRotatedUV(UnitTestReport* report)
+	{
+		for (float angle : { 0.3f, 1.2f, 2.5f, -2.f })
+		{
+			const float cosAngle = std::cos(angle);
+			const float sinAngle = std::sin(angle);
+
+			MeshData plane = PlaneWithoutTangents();
+			for (MeshData::Vertex& vertex : plane.vertices)
+			{
+				vertex.uv = { cosAngle * vertex.position.x - sinAngle * vertex.position.z, -sinAngle * vertex.position.x - cosAngle * vertex.position.z };
+			}
+
+			XTEST_CHECK(report, xtest::mesh::GenerateTangents(plane) == 0);
+			XTEST_CHECK(report, AreOrthonormal(plane));
+
+			bool alongU = true;
+			for (const MeshData::Vertex& vertex : plane.vertices)
+			{
+				alongU = alongU && IsNear(vertex.tangentU, { cosAngle, 0.f, -sinAngle }, 1e-4f);
+			}
+			XTEST_CHECK(report, alongU);
+		}
+	}
+
+
+	// u mirrored around the middle column: its vertices are shared by triangles of both handedness and get split,
+	// then every triangle sees the tangent of its own side
+	void TestMirroredUV(UnitTestReport* report)
+	{
+		MeshData plane = PlaneWithoutTangents();
+		const int32 middleColumn = int32(kPlaneXDivisions / 2);
+		for (uint32 vertexIndex = 0; vertexIndex < plane.vertices.size(); vertexIndex++)
+		{
+			const int32 column = int32(vertexIndex % kPlaneXDivisions);
+			plane.vertices[vertexIndex].uv.x = float(std::abs(column - middleColumn)) / middleColumn;
+		}
+		const MeshData original = plane;
+
+		XTEST_CHECK(report, xtest::mesh::GenerateTangents(plane) == kPlaneZDivisions);
+		XTEST_CHECK(report, plane.vertices.size() == original.vertices.size() + kPlaneZDivisions);
+		XTEST_CHECK(report, plane.indices.size() == original.indices.size());
+		XTEST_CHECK(report, AreOrthonormal(plane));
+
+		// the copies are the vertices of the middle column, with the same attributes but the tangent
+		bool splitMiddle = plane.vertices.size() == original.vertices.size() + kPlaneZDivisions;
+		for (uint32 splitIndex = 0; splitMiddle && splitIndex < kPlaneZDivisions; splitIndex++)
+		{
+			const MeshData::Vertex& copy = plane.vertices[original.vertices.size() + splitIndex];
+			const MeshData::Vertex& source = original.vertices[splitIndex * kPlaneXDivisions + middleColumn];
+			splitMiddle = splitMiddle && IsNear(copy.position, source.position, 0.f) && IsNear(copy.normal, source.normal, 0.f)
+				&& copy.uv.x == source.uv.x && copy.uv.y == source.uv.y;
+		}
+		XTEST_CHECK(report, splitMiddle);
+
+		// same triangles through the same positions, the corners of each one agree with its side of the plane
+		bool sameTriangles = true;
+		bool alongU = true;
+		for (size_t index = 0; index < plane.indices.size(); index += 3)
+		{
+			float centerX = 0.f;
+			for (uint32 corner = 0; corner < 3; corner++)
+			{
+				const XMFLOAT3& position = plane.vertices[plane.indices[index + corner]].position;
+				sameTriangles = sameTriangles && IsNear(position, original.vertices[original.indices[index + corner]].position, 0.f);
+				centerX += position.x;
+			}
+
+			const XMFLOAT3 expectedTangent = { centerX > 0.f ? 1.f : -1.f, 0.f, 0.f };
+			for (uint32 corner = 0; corner < 3; corner++)
+			{
+				alongU = alongU && IsNear(plane.vertices[plane.indices[index + corner]].tangentU, expectedTangent, 1e-5f);
+			}
+		}
+		XTEST_CHECK(report, sameTriangles);
+		XTEST_CHECK(report, alongU);
+	}
+}
+
+
+void xtest::test::TestTangentSpace(UnitTestReport* report)
+{
+	TestPlaneTangents(report);
+	TestRotatedUV(report);
+	TestMirroredUV(report);
+}
@@ -0,0 +1,138 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+
+
+using xtest::test::UnitTestReport;
+
+
+UnitTestReport::UnitTestReport()
+	: m_suites()
+{}
+
+
+void UnitTestReport::BeginSuite(const std::string& name)
+{
+	m_suites.push_back(Suite{ name, 0, {} });
+}
+
+
+void UnitTestReport::Check(bool condition, const char* expression, const char* file, uint32 line)
+{
+	XTEST_ASSERT(!m_suites.empty(), L"checks are made within a suite");
+
+	Suite& suite = m_suites.back();
+	suite.checkCount++;
+	if (!condition)
+	{
+		std::ostringstream failure;
+		failure << file << "(" << line << "): " << expression;
+		suite.failures.push_back(failure.str());
+	}
+}
+
+
+uint32 UnitTestReport::CheckCount() const
+{
+	uint32 checkCount = 0;
+	for (const Suite& suite : m_suites)
+	{
+		checkCount += suite.checkCount;
+	}
+	return checkCount;
+}
+
+
+uint32 UnitTestReport::FailureCount() const
+{
+	uint32 failureCount = 0;
+	for (const Suite& suite : m_suites)
+	{
+		failureCount += uint32(suite.failures.size());
+	}
+	return failureCount;
+}
+
+
+std::string UnitTestReport::Summary() const
+{
+	std::ostringstream summary;
+	for (const Suite& suite : m_suites)
+	{
+		summary << suite.name << ": " << suite.checkCount << " checks, " << suite.failures.size() << " failed" << std::endl;
+		for (const std::string& failure : suite.failures)
+		{
+			summary << "\tfailed " << failure << std::endl;
+		}
+	}
+	summary << "total: " << CheckCount() << " checks, " << FailureCount() << " failed" << std::endl;
+	return summary.str();
+}
+
+
+UnitTestReport xtest::test::RunUnitTests()
+{
+	UnitTestReport report;
+
+	report.BeginSuite("culling");
+	TestCulling(&report);
+
+	report.BeginSuite("constant ring allocator");
+	TestConstantRingAllocator(&report);
+
+	report.BeginSuite("recording backend");
+	TestRecordingBackend(&report);
+
+	report.BeginSuite("mesh lod");
+	TestMeshLod(&report);
+
+	report.BeginSuite("index codec");
+	TestIndexCodec(&report);
+
+	report.BeginSuite("vertex codec");
+	TestVertexCodec(&report);
+
+	report.BeginSuite("mesh generator");
+	TestMeshGenerator(&report);
+
+	report.BeginSuite("vertex weld table");
+	TestVertexWeldTable(&report);
+
+	report.BeginSuite("obj reader");
+	TestObjReader(&report);
+
+	report.BeginSuite("occlusion");
+	TestOcclusion(&report);
+
+	report.BeginSuite("draw queue");
+	TestDrawQueue(&report);
+
+	report.BeginSuite("object transforms");
+	TestObjectTransforms(&report);
+
+	report.BeginSuite("gpf format");
+	TestGPFFormat(&report);
+
+	report.BeginSuite("mesh bounds");
+	TestMeshBounds(&report);
+
+	report.BeginSuite("mesh optimizer");
+	TestMeshOptimizer(&report);
+
+	report.BeginSuite("meshlets");
+	TestMeshlets(&report);
+
+	report.BeginSuite("packed vertex");
+	TestPackedVertex(&report);
+
+	report.BeginSuite("mesh simplifier");
+	TestMeshSimplifier(&report);
+
+	report.BeginSuite("tangent space");
+	TestTangentSpace(&report);
+
+	report.BeginSuite("obj baker");
+	TestObjBaker(&report);
+
+	return report;
+}
+
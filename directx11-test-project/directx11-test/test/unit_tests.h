@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+
+
+// checks a condition of a unit test, a failure is recorded in the report and the test goes on
+#ifndef XTEST_CHECK
+#	define XTEST_CHECK(report, condition) (report)->Check((condition), #condition, __FILE__, __LINE__)
+#endif
+
+
+namespace xtest {
+namespace test {
+
+	// the checks of a run of the unit tests by suite, the failed ones with the place they are at
+	class UnitTestReport
+	{
+	public:
+
+		UnitTestReport();
+
+		UnitTestReport(UnitTestReport&&) = default;
+		UnitTestReport(const UnitTestReport&) = default;
+		UnitTestReport& operator=(UnitTestReport&&) = default;
+		UnitTestReport& operator=(const UnitTestReport&) = default;
+
+
+		// the checks from here on belong to the suite
+		void BeginSuite(const std::string& name);
+		void Check(bool condition, const char* expression, const char* file, uint32 line);
+
+		uint32 CheckCount() const;
+		uint32 FailureCount() const;
+
+		// a line for every suite with its counts, followed by the failed checks
+		std::string Summary() const;
+
+	private:
+
+		struct Suite
+		{
+			std::string name;
+			uint32 checkCount;
+			std::vector<std::string> failures;
+		};
+
+		std::vector<Suite> m_suites;
+	};
+
+
+	/**
+	Tests of the modules that don't need a device, run headless with the -unit-tests option. Every suite checks its
+	module against a plain reference implementation or against properties that must hold for any input; the random
+	inputs come from fixed seeds, so a failure repeats at every run.
+	*/
+	UnitTestReport RunUnitTests();
+
+	// the suites, see RunUnitTests
+	void TestCulling(UnitTestReport* report);
+	void TestConstantRingAllocator(UnitTestReport* report);
+	void TestRecordingBackend(UnitTestReport* report);
+	void TestMeshLod(UnitTestReport* report);
+	void TestIndexCodec(UnitTestReport* report);
+	void TestVertexCodec(UnitTestReport* report);
+	void TestMeshGenerator(UnitTestReport* report);
+	void TestVertexWeldTable(UnitTestReport* report);
+	void TestObjReader(UnitTestReport* report);
+	void TestOcclusion(UnitTestReport* report);
+	void TestDrawQueue(UnitTestReport* report);
+	void TestObjectTransforms(UnitTestReport* report);
+	void TestGPFFormat(UnitTestReport* report);
+	void TestMeshBounds(UnitTestReport* report);
+	void TestMeshOptimizer(UnitTestReport* report);
+	void TestMeshlets(UnitTestReport* report);
+	void TestPackedVertex(UnitTestReport* report);
+	void TestMeshSimplifier(UnitTestReport* report);
+	void TestTangentSpace(UnitTestReport* report);
+	void TestObjBaker(UnitTestReport* report);
+
+} // test
+} // xtest
+
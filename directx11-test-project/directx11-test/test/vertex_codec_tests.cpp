@@ -0,0 +1,217 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <mesh/packed_vertex.h>
+#include <mesh/vertex_codec.h>
+#include <random>
+
+
+using xtest::mesh::kVertexCodecChunkVertexCount;
+using xtest::mesh::MeshData;
+using xtest::mesh::PackedVertex;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	// the stream header and the chunk table entry, see vertex_codec.cpp
+	const size_t kStreamHeaderByteSize = 16;
+	const size_t kChunkEntryByteSize = 16;
+
+
+	// neighbour vertices along a spiral, like a vertex buffer in first-use order
+	std::vector<MeshData::Vertex> MakeVertices(uint32 vertexCount)
+	{
+		std::vector<MeshData::Vertex> vertices(vertexCount);
+		for (uint32 index = 0; index < vertexCount; index++)
+		{
+			const float angle = float(index) * 0.01f;
+			vertices[index].position = { std::cos(angle) * 5.f, float(index) * 1e-3f, std::sin(angle) * 5.f };
+			vertices[index].normal = { std::cos(angle), 0.f, std::sin(angle) };
+			vertices[index].tangentU = { -std::sin(angle), 0.f, std::cos(angle) };
+			vertices[index].uv = { float(index % 256) / 256.f, 0.5f };
+		}
+		return vertices;
+	}
+
+
+	std::vector<PackedVertex> MakePackedVertices(uint32 vertexCount)
+	{
+		std::vector<PackedVertex> vertices(vertexCount);
+		for (uint32 index = 0; index < vertexCount; index++)
+		{
+			vertices[index].position[0] = uint16(index * 7);
+			vertices[index].position[1] = uint16(32768 + (index % 512) * 3);
+			vertices[index].position[2] = uint16(index / 3);
+			vertices[index].position[3] = 0;
+			vertices[index].normalTangent = (index % 2048) | (uint32(index / 8 % 2048) << 11) | (uint32(index % 1024) << 22);
+			vertices[index].uv[0] = uint16(0x3800 + index % 1024);
+			vertices[index].uv[1] = 0x3c00;
+		}
+		return vertices;
+	}
+
+
+	template<typename T>
+	bool RoundTrips(const std::vector<T>& vertices, uint32 threadCount)
+	{
+		const std::vector<uint8> data = xtest::mesh::EncodeVertices(vertices.data(), uint32(vertices.size()), sizeof(T));
+		std::vector<T> decodedVertices(vertices.size());
+		return xtest::mesh::DecodeVertices(data.data(), data.size(), decodedVertices.data(), uint32(vertices.size()), sizeof(T), threadCount)
+			&& (vertices.empty() || std::memcmp(vertices.data(), decodedVertices.data(), sizeof(T) * vertices.size()) == 0);
+	}
+
+
+	// a stream of vertexCount vertices of 4 bytes in a single chunk: the first plane is given, the other three are
+	// constant zeros
+	std::vector<uint8> MakeSinglePlaneStream(const std::vector<uint8>& plane, uint32 vertexCount)
+	{
+		const uint32 zero = 0;
+		std::vector<uint8> data = xtest::mesh::EncodeVertices(&zero, 1, sizeof(uint32));
+		data.resize(kStreamHeaderByteSize + kChunkEntryByteSize);
+		std::memcpy(data.data() + sizeof(uint32), &vertexCount, sizeof(uint32));
+
+		const uint64 chunkEntry[2] = { data.size(), plane.size() + 6 };
+		std::memcpy(data.data() + kStreamHeaderByteSize, chunkEntry, sizeof(chunkEntry));
+		data.insert(data.end(), plane.begin(), plane.end());
+		for (uint32 constantPlane = 0; constantPlane < 3; constantPlane++)
+		{
+			data.insert(data.end(), { 0, 0 });
+		}
+		return data;
+	}
+
+
+	// a huffman plane with the given code lengths, followed by the bit stream
+	std::vector<uint8> MakeHuffmanPlane(const std::map<uint8, uint8>& codeLengths, const std::vector<uint8>& bitStream)
+	{
+		std::vector<uint8> plane(1 + 128, 0);
+		plane[0] = 2;
+		for (const auto& symbolPairWithLength : codeLengths)
+		{
+			plane[1 + symbolPairWithLength.first / 2] |= uint8(symbolPairWithLength.second << (4 * (symbolPairWithLength.first % 2)));
+		}
+
+		const uint32 bitStreamByteSize = uint32(bitStream.size());
+		const uint8* sizeBytes = reinterpret_cast<const uint8*>(&bitStreamByteSize);
+		plane.insert(plane.end(), sizeBytes, sizeBytes + sizeof(uint32));
+		plane.insert(plane.end(), bitStream.begin(), bitStream.end());
+		return plane;
+	}
+
+
+	bool DecodesSinglePlane(const std::vector<uint8>& plane, uint32 vertexCount, std::vector<uint32>* words)
+	{
+		const std::vector<uint8> data = MakeSinglePlaneStream(plane, vertexCount);
+		words->assign(vertexCount, UINT32_MAX);
+		return xtest::mesh::DecodeVertices(data.data(), data.size(), words->data(), vertexCount, sizeof(uint32));
+	}
+
+
+	void TestRoundTrip(UnitTestReport* report)
+	{
+		// the counts around the chunk size, decoded on one and on 4 threads
+		for (uint32 vertexCount : { 0u, 1u, 2u, kVertexCodecChunkVertexCount - 1, kVertexCodecChunkVertexCount, kVertexCodecChunkVertexCount + 1, 2 * kVertexCodecChunkVertexCount + 3 })
+		{
+			for (uint32 threadCount : { 1u, 4u })
+			{
+				XTEST_CHECK(report, RoundTrips(MakeVertices(vertexCount), threadCount));
+				XTEST_CHECK(report, RoundTrips(MakePackedVertices(vertexCount), threadCount));
+			}
+		}
+
+		// noise doesn't compress, its planes are stored raw
+		std::mt19937 random(3);
+		std::vector<uint32> noise(4 * 5000);
+		std::generate(noise.begin(), noise.end(), [&random]() { return uint32(random()); });
+		XTEST_CHECK(report, RoundTrips(noise, 1));
+
+		// smooth vertices do, zero ones are a constant byte a plane
+		const std::vector<MeshData::Vertex> vertices = MakeVertices(4 * kVertexCodecChunkVertexCount);
+		const std::vector<uint8> data = xtest::mesh::EncodeVertices(vertices.data(), uint32(vertices.size()), sizeof(MeshData::Vertex));
+		XTEST_CHECK(report, data.size() < vertices.size() * sizeof(MeshData::Vertex) / 2);
+
+		const std::vector<uint32> zeroWords(1000, 0);
+		const std::vector<uint8> zeroData = xtest::mesh::EncodeVertices(zeroWords.data(), 1000, sizeof(uint32));
+		XTEST_CHECK(report, RoundTrips(zeroWords, 1));
+		XTEST_CHECK(report, zeroData.size() == kStreamHeaderByteSize + kChunkEntryByteSize + 4 * 2);
+	}
+
+
+	void TestMalformedStreams(UnitTestReport* report)
+	{
+		const std::vector<PackedVertex> vertices = MakePackedVertices(kVertexCodecChunkVertexCount + 100);
+		const uint32 vertexCount = uint32(vertices.size());
+		const std::vector<uint8> data = xtest::mesh::EncodeVertices(vertices.data(), vertexCount, sizeof(PackedVertex));
+		std::vector<PackedVertex> decodedVertices(vertices.size());
+
+		// every chunk must be read to its end, a truncated stream never decodes
+		uint32 decodedPrefixCount = 0;
+		for (size_t byteSize = 0; byteSize < data.size(); byteSize += 1 + byteSize / 64)
+		{
+			decodedPrefixCount += xtest::mesh::DecodeVertices(data.data(), byteSize, decodedVertices.data(), vertexCount, sizeof(PackedVertex)) ? 1 : 0;
+		}
+		XTEST_CHECK(report, decodedPrefixCount == 0);
+		XTEST_CHECK(report, !xtest::mesh::DecodeVertices(data.data(), data.size() - 1, decodedVertices.data(), vertexCount, sizeof(PackedVertex)));
+
+		// the count and the stride must be the encoded ones
+		XTEST_CHECK(report, xtest::mesh::DecodeVertices(data.data(), data.size(), decodedVertices.data(), vertexCount, sizeof(PackedVertex)));
+		XTEST_CHECK(report, !xtest::mesh::DecodeVertices(data.data(), data.size(), decodedVertices.data(), vertexCount - 1, sizeof(PackedVertex)));
+		XTEST_CHECK(report, !xtest::mesh::DecodeVertices(data.data(), data.size(), decodedVertices.data(), vertexCount / 2, 2 * sizeof(PackedVertex)));
+
+		// a chunk pointing past the end of the stream
+		std::vector<uint8> farChunkData = data;
+		const uint64 farOffset = data.size();
+		std::memcpy(farChunkData.data() + kStreamHeaderByteSize + kChunkEntryByteSize, &farOffset, sizeof(uint64));
+		XTEST_CHECK(report, !xtest::mesh::DecodeVertices(farChunkData.data(), farChunkData.size(), decodedVertices.data(), vertexCount, sizeof(PackedVertex)));
+
+		// any byte changed decodes to something else or fails, but never writes past the vertices
+		std::mt19937 random(9);
+		std::uniform_int_distribution<size_t> position(0, data.size() - 1);
+		std::vector<PackedVertex> guardedVertices(vertices.size() + 1);
+		guardedVertices.back().normalTangent = 0xdeadbeef;
+		for (uint32 corruption = 0; corruption < 200; corruption++)
+		{
+			std::vector<uint8> corruptData = data;
+			corruptData[position(random)] ^= uint8(1 + corruption % 255);
+			xtest::mesh::DecodeVertices(corruptData.data(), corruptData.size(), guardedVertices.data(), vertexCount, sizeof(PackedVertex), 4);
+		}
+		XTEST_CHECK(report, guardedVertices.back().normalTangent == 0xdeadbeef);
+	}
+
+
+	void TestHuffmanCodeLengths(UnitTestReport* report)
+	{
+		// two codes of a bit: the zero bits are the symbol 0, the one bits the symbol 1, zigzag decoded to -1
+		std::vector<uint32> words;
+		XTEST_CHECK(report, DecodesSinglePlane(MakeHuffmanPlane({ { 0, 1 }, { 1, 1 } }, { 0x02 }), 8, &words));
+		XTEST_CHECK(report, words[0] == 0 && words[1] == UINT32_MAX && words[7] == UINT32_MAX);
+
+		// an oversubscribed code
+		XTEST_CHECK(report, !DecodesSinglePlane(MakeHuffmanPlane({ { 0, 1 }, { 1, 1 }, { 2, 1 } }, { 0x00 }), 8, &words));
+		XTEST_CHECK(report, !DecodesSinglePlane(MakeHuffmanPlane({ { 0, 1 }, { 1, 2 }, { 2, 2 }, { 3, 2 } }, { 0x00 }), 8, &words));
+
+		// lengths longer than the decode table, even if they don't oversubscribe the code
+		for (uint8 length : { 13, 14, 15 })
+		{
+			XTEST_CHECK(report, !DecodesSinglePlane(MakeHuffmanPlane({ { 0, 1 }, { 1, length } }, { 0x00 }), 8, &words));
+		}
+		XTEST_CHECK(report, DecodesSinglePlane(MakeHuffmanPlane({ { 0, 1 }, { 1, 12 } }, { 0x00 }), 8, &words));
+
+		// a code that is not complete: the bits of a missing code fail the decode
+		XTEST_CHECK(report, DecodesSinglePlane(MakeHuffmanPlane({ { 0, 2 } }, { 0x00, 0x00 }), 8, &words));
+		XTEST_CHECK(report, !DecodesSinglePlane(MakeHuffmanPlane({ { 0, 2 } }, { 0xff, 0xff }), 8, &words));
+
+		// a bit stream longer than the plane
+		std::vector<uint8> longPlane = MakeHuffmanPlane({ { 0, 1 }, { 1, 1 } }, { 0x00 });
+		longPlane[1 + 128] = 0xff;
+		XTEST_CHECK(report, !DecodesSinglePlane(longPlane, 8, &words));
+	}
+}
+
+
+void xtest::test::TestVertexCodec(UnitTestReport* report)
+{
+	TestRoundTrip(report);
+	TestMalformedStreams(report);
+	TestHuffmanCodeLengths(report);
+}
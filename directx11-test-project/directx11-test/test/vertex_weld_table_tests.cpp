@@ -0,0 +1,175 @@
+#include "stdafx.h"
+#include "unit_tests.h"
+#include <mesh/vertex_weld_table.h>
+#include <random>
+#include <unordered_map>
+
+
+using xtest::mesh::MeshData;
+using xtest::mesh::VertexWeldTable;
+using xtest::test::UnitTestReport;
+
+
+namespace
+{
+	MeshData::Vertex MakeVertex(float x, float y, float z)
+	{
+		return { { x, y, z }, { 0.f, 1.f, 0.f }, { 1.f, 0.f, 0.f }, { 0.5f, 0.5f } };
+	}
+
+
+	struct VertexHash
+	{
+		size_t operator()(const MeshData::Vertex& vertex) const
+		{
+			return size_t(xtest::mesh::HashVertex(vertex));
+		}
+	};
+
+
+	// the corners of a mesh with many shared vertices, the zeros with both signs
+	std::vector<MeshData::Vertex> MakeCorners(uint32 cornerCount, uint32 distinctCount, std::mt19937* random)
+	{
+		std::vector<MeshData::Vertex> distinctVertices;
+		std::uniform_real_distribution<float> coordinate(-1.f, 1.f);
+		for (uint32 index = 0; index < distinctCount; index++)
+		{
+			distinctVertices.push_back(MakeVertex(coordinate(*random), coordinate(*random), index % 7 == 0 ? 0.f : coordinate(*random)));
+		}
+
+		std::vector<MeshData::Vertex> corners;
+		std::uniform_int_distribution<uint32> pick(0, distinctCount - 1);
+		for (uint32 index = 0; index < cornerCount; index++)
+		{
+			MeshData::Vertex corner = distinctVertices[pick(*random)];
+			if (index % 2 == 0 && corner.position.z == 0.f)
+			{
+				corner.position.z = -0.f;
+			}
+			corners.push_back(corner);
+		}
+		return corners;
+	}
+
+
+	void TestExactWelding(UnitTestReport* report)
+	{
+		// the same vertices and indices as the std::unordered_map dedup the table replaced, through a few grows
+		std::mt19937 random(4);
+		const std::vector<MeshData::Vertex> corners = MakeCorners(30000, 5000, &random);
+
+		std::vector<MeshData::Vertex> vertices;
+		std::vector<uint32> indices;
+		VertexWeldTable weldTable(&vertices, 0);
+		for (const MeshData::Vertex& corner : corners)
+		{
+			indices.push_back(weldTable.FindOrAdd(corner));
+		}
+
+		std::vector<MeshData::Vertex> mapVertices;
+		std::vector<uint32> mapIndices;
+		std::unordered_map<MeshData::Vertex, uint32, VertexHash> indexMapByVertex;
+		for (const MeshData::Vertex& corner : corners)
+		{
+			auto iter = indexMapByVertex.find(corner);
+			if (iter == indexMapByVertex.end())
+			{
+				iter = indexMapByVertex.emplace(corner, uint32(mapVertices.size())).first;
+				mapVertices.push_back(corner);
+			}
+			mapIndices.push_back(iter->second);
+		}
+
+		XTEST_CHECK(report, vertices == mapVertices && indices == mapIndices);
+		XTEST_CHECK(report, weldTable.VertexCount() == vertices.size() && vertices.size() <= 5000);
+
+		// +0.0 and -0.0 are the same vertex
+		XTEST_CHECK(report, xtest::mesh::HashVertex(MakeVertex(0.f, 1.f, 2.f)) == xtest::mesh::HashVertex(MakeVertex(-0.f, 1.f, 2.f)));
+		XTEST_CHECK(report, weldTable.FindOrAdd(MakeVertex(-0.f, 0.f, -0.f)) == weldTable.FindOrAdd(MakeVertex(0.f, -0.f, 0.f)));
+
+		// the nans never compare equal, they all weld together instead of adding a vertex each time
+		const float nan = std::numeric_limits<float>::quiet_NaN();
+		const float payloadNaN = std::numeric_limits<float>::signaling_NaN();
+		const uint32 nanIndex = weldTable.FindOrAdd(MakeVertex(nan, 1.f, 2.f));
+		XTEST_CHECK(report, nanIndex == weldTable.VertexCount() - 1);
+		XTEST_CHECK(report, weldTable.FindOrAdd(MakeVertex(nan, 1.f, 2.f)) == nanIndex);
+		XTEST_CHECK(report, weldTable.FindOrAdd(MakeVertex(-nan, 1.f, 2.f)) == nanIndex);
+		XTEST_CHECK(report, weldTable.FindOrAdd(MakeVertex(payloadNaN, 1.f, 2.f)) == nanIndex);
+		XTEST_CHECK(report, weldTable.FindOrAdd(MakeVertex(nan, 1.f, 3.f)) != nanIndex);
+		XTEST_CHECK(report, xtest::mesh::HashVertex(MakeVertex(nan, 1.f, 2.f)) == xtest::mesh::HashVertex(MakeVertex(-payloadNaN, 1.f, 2.f)));
+
+		// the indices of a table over a non empty array start from its size, the count is the one of its own vertices
+		std::vector<MeshData::Vertex> sharedVertices(10, MakeVertex(0.f, 0.f, 0.f));
+		VertexWeldTable sharedWeldTable(&sharedVertices, 4);
+		XTEST_CHECK(report, sharedWeldTable.FindOrAdd(MakeVertex(0.f, 0.f, 0.f)) == 10);
+		XTEST_CHECK(report, sharedWeldTable.FindOrAdd(MakeVertex(1.f, 0.f, 0.f)) == 11);
+		XTEST_CHECK(report, sharedWeldTable.FindOrAdd(MakeVertex(0.f, 0.f, 0.f)) == 10);
+		XTEST_CHECK(report, sharedWeldTable.VertexCount() == 2);
+	}
+
+
+	void TestEpsilonWelding(UnitTestReport* report)
+	{
+		std::vector<MeshData::Vertex> vertices;
+		VertexWeldTable weldTable(&vertices, 16, 0.01f);
+		XTEST_CHECK(report, weldTable.WeldEpsilon() == 0.01f);
+
+		// closer than half a step to the same grid point: merged into the first one inserted
+		const uint32 index = weldTable.FindOrAdd(MakeVertex(1.f, 2.f, 3.f));
+		XTEST_CHECK(report, weldTable.FindOrAdd(MakeVertex(1.003f, 1.998f, 3.f)) == index);
+		XTEST_CHECK(report, weldTable.FindOrAdd(MakeVertex(0.996f, 2.f, 3.004f)) == index);
+		XTEST_CHECK(report, vertices.size() == 1 && vertices[0].position.x == 1.f);
+
+		// a step or more apart, or differing in any attribute
+		XTEST_CHECK(report, weldTable.FindOrAdd(MakeVertex(1.01f, 2.f, 3.f)) != index);
+		XTEST_CHECK(report, weldTable.FindOrAdd(MakeVertex(1.f, 2.03f, 3.f)) != index);
+		MeshData::Vertex otherUV = MakeVertex(1.f, 2.f, 3.f);
+		otherUV.uv.y = 0.52f;
+		XTEST_CHECK(report, weldTable.FindOrAdd(otherUV) != index);
+		XTEST_CHECK(report, vertices.size() == 4);
+
+		// a negative epsilon is an exact table
+		std::vector<MeshData::Vertex> exactVertices;
+		VertexWeldTable exactWeldTable(&exactVertices, 0, -1.f);
+		XTEST_CHECK(report, exactWeldTable.WeldEpsilon() == 0.f);
+		XTEST_CHECK(report, exactWeldTable.FindOrAdd(MakeVertex(1.f, 2.f, 3.f)) != exactWeldTable.FindOrAdd(MakeVertex(1.f, 2.f, std::nextafter(3.f, 4.f))));
+	}
+
+
+	void TestGridOverflow(UnitTestReport* report)
+	{
+		// cells past the int32 range and nans, see GridCell: one vertex past each end and one for the nans
+		const float infinity = std::numeric_limits<float>::infinity();
+		const float nan = std::numeric_limits<float>::quiet_NaN();
+
+		std::vector<MeshData::Vertex> vertices;
+		VertexWeldTable weldTable(&vertices, 0, 1e-6f);
+		const uint32 positiveIndex = weldTable.FindOrAdd(MakeVertex(1e30f, 0.f, 0.f));
+		const uint32 negativeIndex = weldTable.FindOrAdd(MakeVertex(-1e30f, 0.f, 0.f));
+		const uint32 nanIndex = weldTable.FindOrAdd(MakeVertex(nan, 0.f, 0.f));
+		XTEST_CHECK(report, positiveIndex != negativeIndex && positiveIndex != nanIndex && negativeIndex != nanIndex);
+		XTEST_CHECK(report, weldTable.FindOrAdd(MakeVertex(infinity, 0.f, 0.f)) == positiveIndex);
+		XTEST_CHECK(report, weldTable.FindOrAdd(MakeVertex(-infinity, 0.f, 0.f)) == negativeIndex);
+		XTEST_CHECK(report, weldTable.FindOrAdd(MakeVertex(-nan, 0.f, 0.f)) == nanIndex);
+		XTEST_CHECK(report, vertices.size() == 3);
+
+		// the last float cells inside the range stay apart from them
+		std::vector<MeshData::Vertex> edgeVertices;
+		VertexWeldTable edgeWeldTable(&edgeVertices, 0, 1.f);
+		const uint32 edgeIndices[] = {
+			edgeWeldTable.FindOrAdd(MakeVertex(1e30f, 0.f, 0.f)),
+			edgeWeldTable.FindOrAdd(MakeVertex(-1e30f, 0.f, 0.f)),
+			edgeWeldTable.FindOrAdd(MakeVertex(nan, 0.f, 0.f)),
+			edgeWeldTable.FindOrAdd(MakeVertex(2147483520.f, 0.f, 0.f)),
+			edgeWeldTable.FindOrAdd(MakeVertex(-2147483648.f, 0.f, 0.f)) };
+		XTEST_CHECK(report, edgeVertices.size() == 5 && edgeIndices[4] == 4);
+	}
+}
+
+
+void xtest::test::TestVertexWeldTable(UnitTestReport* report)
+{
+	TestExactWelding(report);
+	TestEpsilonWelding(report);
+	TestGridOverflow(report);
+}